@@ -6,6 +6,7 @@ NFC := src/nfc
 HAL := src/hal
 UDRV := src/udrv
 HALIMPL := halimpl/bcm2079x
+UNITTEST_FILES := %_unittest.c %_unittest.cpp
 D_CFLAGS := -DANDROID -DBUILDCFG=1 \
     -Wno-deprecated-register \
     -Wno-unused-parameter \
@@ -32,9 +33,9 @@ LOCAL_C_INCLUDES := \
     $(LOCAL_PATH)/$(HALIMPL)/include
 LOCAL_SRC_FILES := \
     $(call all-c-files-under, $(NFA)/ce $(NFA)/dm $(NFA)/ee) \
-    $(call all-c-files-under, $(NFA)/hci $(NFA)/int $(NFA)/p2p $(NFA)/rw $(NFA)/sys) \
-    $(call all-c-files-under, $(NFC)/int $(NFC)/llcp $(NFC)/nci $(NFC)/ndef $(NFC)/nfc $(NFC)/tags) \
-    $(call all-c-files-under, src/adaptation) \
+    $(call all-c-files-under, $(NFA)/cho $(NFA)/hci $(NFA)/int $(NFA)/p2p $(NFA)/rw $(NFA)/snep $(NFA)/sys) \
+    $(filter-out $(UNITTEST_FILES), $(call all-c-files-under, $(NFC)/int $(NFC)/llcp $(NFC)/nci $(NFC)/ndef $(NFC)/nfc $(NFC)/tags)) \
+    $(filter-out $(UNITTEST_FILES), $(call all-c-files-under, src/adaptation)) \
     $(call all-cpp-files-under, src/adaptation) \
     $(call all-c-files-under, src/gki) \
     $(HALIMPL)/adaptation/android_logmsg.cpp \
@@ -64,9 +65,12 @@ endif
 
 LOCAL_MODULE := nfc_nci.$(HAL_SUFFIX)
 
-LOCAL_SRC_FILES := $(call all-c-files-under, $(HALIMPL)) \
-    $(call all-cpp-files-under, $(HALIMPL)) \
+LOCAL_SRC_FILES := $(filter-out $(UNITTEST_FILES), $(call all-c-files-under, $(HALIMPL))) \
+    $(filter-out $(UNITTEST_FILES), $(call all-cpp-files-under, $(HALIMPL))) \
     src/adaptation/CrcChecksum.cpp \
+    src/adaptation/Crc16.c \
+    src/adaptation/NciTraceRing.c \
+    src/adaptation/NfcMetrics.c \
     src//nfca_version.c
 LOCAL_SHARED_LIBRARIES := liblog libcutils libhardware_legacy
 LOCAL_C_INCLUDES := \
@@ -83,6 +87,116 @@ LOCAL_CFLAGS := $(D_CFLAGS) -DNFC_HAL_TARGET=TRUE -DNFC_RW_ONLY=TRUE
 include $(BUILD_SHARED_LIBRARY)
 
 
+######################################
+# Build host unit tests. Each test includes the source file it tests.
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := userial_linux_unittest
+LOCAL_MODULE_TAGS := tests
+LOCAL_SRC_FILES := $(HALIMPL)/adaptation/userial_linux_unittest.c \
+    src/adaptation/NfcMetrics.c
+LOCAL_STATIC_LIBRARIES := liblog
+LOCAL_LDLIBS := -lpthread -lrt
+LOCAL_C_INCLUDES := \
+    $(LOCAL_PATH)/$(HALIMPL)/adaptation \
+    $(LOCAL_PATH)/$(HALIMPL)/include \
+    $(LOCAL_PATH)/$(HALIMPL)/gki/ulinux \
+    $(LOCAL_PATH)/$(HALIMPL)/gki/common \
+    $(LOCAL_PATH)/$(HAL)/include \
+    $(LOCAL_PATH)/$(HAL)/int \
+    $(LOCAL_PATH)/src/include \
+    $(LOCAL_PATH)/$(NFC)/include \
+    $(LOCAL_PATH)/$(NFA)/include \
+    $(LOCAL_PATH)/$(UDRV)/include
+LOCAL_CFLAGS := $(D_CFLAGS) -DNFC_HAL_TARGET=TRUE -DNFC_RW_ONLY=TRUE
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := nfc_hal_prm_unittest
+LOCAL_MODULE_TAGS := tests
+LOCAL_SRC_FILES := $(HALIMPL)/hal/hal/nfc_hal_prm_unittest.c
+LOCAL_STATIC_LIBRARIES := liblog
+LOCAL_C_INCLUDES := \
+    $(LOCAL_PATH)/$(HALIMPL)/include \
+    $(LOCAL_PATH)/$(HALIMPL)/gki/ulinux \
+    $(LOCAL_PATH)/$(HALIMPL)/gki/common \
+    $(LOCAL_PATH)/$(HAL)/include \
+    $(LOCAL_PATH)/$(HAL)/int \
+    $(LOCAL_PATH)/src/include \
+    $(LOCAL_PATH)/$(NFC)/include \
+    $(LOCAL_PATH)/$(NFA)/include \
+    $(LOCAL_PATH)/$(UDRV)/include
+LOCAL_CFLAGS := $(D_CFLAGS) -DNFC_HAL_TARGET=TRUE -DNFC_RW_ONLY=TRUE
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := nfc_hal_nci_unittest
+LOCAL_MODULE_TAGS := tests
+LOCAL_SRC_FILES := $(HALIMPL)/hal/hal/nfc_hal_nci_unittest.c
+LOCAL_STATIC_LIBRARIES := liblog
+LOCAL_LDLIBS := -lrt
+LOCAL_C_INCLUDES := \
+    $(LOCAL_PATH)/$(HALIMPL)/include \
+    $(LOCAL_PATH)/$(HALIMPL)/gki/ulinux \
+    $(LOCAL_PATH)/$(HALIMPL)/gki/common \
+    $(LOCAL_PATH)/$(HAL)/include \
+    $(LOCAL_PATH)/$(HAL)/int \
+    $(LOCAL_PATH)/src/include \
+    $(LOCAL_PATH)/$(NFC)/include \
+    $(LOCAL_PATH)/$(NFA)/include \
+    $(LOCAL_PATH)/$(UDRV)/include
+LOCAL_CFLAGS := $(D_CFLAGS) -DNFC_HAL_TARGET=TRUE -DNFC_RW_ONLY=TRUE
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := ce_t3t_unittest
+LOCAL_MODULE_TAGS := tests
+LOCAL_SRC_FILES := $(NFC)/tags/ce_t3t_unittest.c
+LOCAL_STATIC_LIBRARIES := liblog
+LOCAL_LDLIBS := -lrt
+LOCAL_C_INCLUDES := \
+    $(LOCAL_PATH)/src/include \
+    $(LOCAL_PATH)/src/gki/ulinux \
+    $(LOCAL_PATH)/src/gki/common \
+    $(LOCAL_PATH)/$(NFA)/include \
+    $(LOCAL_PATH)/$(NFA)/int \
+    $(LOCAL_PATH)/$(NFC)/include \
+    $(LOCAL_PATH)/$(NFC)/int \
+    $(LOCAL_PATH)/src/hal/include \
+    $(LOCAL_PATH)/src/hal/int \
+    $(LOCAL_PATH)/$(HALIMPL)/include
+LOCAL_CFLAGS := $(D_CFLAGS)
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := rw_t1t_ndef_unittest
+LOCAL_MODULE_TAGS := tests
+LOCAL_SRC_FILES := $(NFC)/tags/rw_t1t_ndef_unittest.c \
+    $(NFC)/tags/tags_int.c
+LOCAL_STATIC_LIBRARIES := liblog
+LOCAL_C_INCLUDES := \
+    $(LOCAL_PATH)/src/include \
+    $(LOCAL_PATH)/src/gki/ulinux \
+    $(LOCAL_PATH)/src/gki/common \
+    $(LOCAL_PATH)/$(NFA)/include \
+    $(LOCAL_PATH)/$(NFA)/int \
+    $(LOCAL_PATH)/$(NFC)/include \
+    $(LOCAL_PATH)/$(NFC)/int \
+    $(LOCAL_PATH)/src/hal/include \
+    $(LOCAL_PATH)/src/hal/int \
+    $(LOCAL_PATH)/$(HALIMPL)/include
+LOCAL_CFLAGS := $(D_CFLAGS)
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := crc16_unittest
+LOCAL_MODULE_TAGS := tests
+LOCAL_SRC_FILES := src/adaptation/Crc16_unittest.c
+LOCAL_LDLIBS := -lpthread -lrt
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/src/include
+include $(BUILD_HOST_EXECUTABLE)
+
+
 ######################################
 include $(call all-makefiles-under,$(LOCAL_PATH))
 endif
@@ -123,6 +123,22 @@ int HaiInitializeLibrary (const bcm2079x_dev_t* device)
     // Initialize protocol logging level
     InitializeProtocolLogLevel ();
 
+    if ( GetNumValue ( NAME_NCI_TRACE_RING, &num, sizeof ( num ) ) && (num == 1) )
+    {
+        // keep NCI packets in memory, dump them on error
+        char dumpFile[256];
+        if ( !GetStrValue ( NAME_NFA_STORAGE, temp, sizeof ( temp ) ) )
+            strlcpy (temp, default_storage_location, sizeof ( temp ));
+        snprintf (dumpFile, sizeof ( dumpFile ), "%s/nci_trace_hal.bin", temp);
+        ProtoDispAdapterUseBinaryTrace (TRUE, dumpFile);
+    }
+
+    if ( GetNumValue ( NAME_DEFERRED_TRACE, &num, sizeof ( num ) ) && (num == 1) )
+    {
+        // format HAL traces only when they are drained, on error
+        LogMsgUseDeferredTrace (TRUE);
+    }
+
     tUSERIAL_OPEN_CFG cfg;
     struct tUART_CONFIG  uart;
 
@@ -232,6 +248,7 @@ int HaiTerminateLibrary ()
     gAndroidHalCallback = NULL;
     gAndroidHalDataCallback = NULL;
     GKI_shutdown ();
+    LogMsgUseDeferredTrace (FALSE);
     resetConfig ();
     retval = 0;
     ALOGD ("%s: exit %d", __FUNCTION__, retval);
@@ -387,6 +404,7 @@ int HaiPowerCycle (const bcm2079x_dev_t* device)
     ALOGD ("%s: enter", __FUNCTION__);
     int retval = EACCES;
 
+    ProtoDispAdapterDumpNciTrace ();
     HAL_NfcPowerCycle ();
     retval = 0;
     ALOGD ("%s: exit %d", __FUNCTION__, retval);
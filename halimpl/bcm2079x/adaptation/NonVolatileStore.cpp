@@ -29,6 +29,8 @@ extern "C"
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
 #include <string>
 
 
@@ -38,6 +40,8 @@ static const char* filename_prefix = "/halStorage.bin";
 static const std::string get_storage_location ();
 void delete_hal_non_volatile_store (bool forceDelete);
 void verify_hal_non_volatile_store ();
+bool read_hal_startup_state (UINT8 *p_buf, UINT16 nbytes);
+bool write_hal_startup_state (const UINT8 *p_buf, UINT16 nbytes);
 
 
 /*******************************************************************************
@@ -273,3 +277,95 @@ void verify_hal_non_volatile_store ()
     if (isValid == false)
         delete_hal_non_volatile_store (true);
 }
+
+
+/*******************************************************************************
+**
+** Function         read_hal_startup_state
+**
+** Description      Read the start-up state saved by write_hal_startup_state.
+**                  It is not part of the store checked and deleted above,
+**                  because it does not depend on the other blocks.
+**
+** Parameters       p_buf   - buffer to read the state into.
+**                  nbytes  - size of the state.
+**
+** Returns          true if the whole state was read and its checksum is good
+**
+*******************************************************************************/
+bool read_hal_startup_state (UINT8 *p_buf, UINT16 nbytes)
+{
+    std::string fn = get_storage_location();
+    char filename[256];
+    unsigned short checksum = 0;
+    bool isValid = false;
+
+    fn.append (filename_prefix);
+    if (fn.length() > 200)
+    {
+        ALOGE ("%s: filename too long", __FUNCTION__);
+        return false;
+    }
+    snprintf (filename, sizeof(filename), "%s%u", fn.c_str(), HAL_STARTUP_NV_BLOCK);
+
+    int fileStream = open (filename, O_RDONLY);
+    if (fileStream >= 0)
+    {
+        if (  (read (fileStream, &checksum, sizeof(checksum)) == sizeof(checksum))
+            &&(read (fileStream, p_buf, nbytes) == (ssize_t) nbytes)  )
+        {
+            isValid = (checksum == crcChecksumCompute (p_buf, nbytes));
+        }
+        close (fileStream);
+    }
+    ALOGD ("%s: %s", __FUNCTION__, isValid ? "valid" : "none");
+    return isValid;
+}
+
+
+/*******************************************************************************
+**
+** Function         write_hal_startup_state
+**
+** Description      Save the start-up state. It is written to a temporary file
+**                  renamed over the state file, so a crash while writing
+**                  leaves the previous state.
+**
+** Parameters       p_buf   - state.
+**                  nbytes  - size of the state.
+**
+** Returns          true if the state was written
+**
+*******************************************************************************/
+bool write_hal_startup_state (const UINT8 *p_buf, UINT16 nbytes)
+{
+    std::string fn = get_storage_location();
+    char filename[256];
+    char tmpFilename[256];
+    bool isWritten = false;
+
+    fn.append (filename_prefix);
+    if (fn.length() > 200)
+    {
+        ALOGE ("%s: filename too long", __FUNCTION__);
+        return false;
+    }
+    snprintf (filename, sizeof(filename), "%s%u", fn.c_str(), HAL_STARTUP_NV_BLOCK);
+    snprintf (tmpFilename, sizeof(tmpFilename), "%s.tmp", filename);
+
+    int fileStream = open (tmpFilename, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (fileStream >= 0)
+    {
+        unsigned short checksum = crcChecksumCompute (p_buf, nbytes);
+        isWritten = (write (fileStream, &checksum, sizeof(checksum)) == sizeof(checksum))
+                 && (write (fileStream, p_buf, nbytes) == (ssize_t) nbytes)
+                 && (fsync (fileStream) == 0);
+        isWritten = (close (fileStream) == 0) && isWritten
+                 && (rename (tmpFilename, filename) == 0);
+        if (!isWritten)
+            unlink (tmpFilename);
+    }
+    if (!isWritten)
+        ALOGE ("%s: fail to write, error = %d", __FUNCTION__, errno);
+    return isWritten;
+}
@@ -19,7 +19,14 @@
 #include "android_logmsg.h"
 #include "nfc_target.h"
 #include "buildcfg.h"
+#include "NciTraceRing.h"
 #include <cutils/log.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <time.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
 
 
 extern UINT32 ScrProtocolTraceFlag;
@@ -31,6 +38,34 @@ extern UINT32 ScrProtocolTraceFlag;
 static char log_line [MAX_LOGCAT_LINE];
 static const char* sTable = "0123456789abcdef";
 static BOOLEAN sIsUseRaw = FALSE;
+
+/* Deferred trace: LogMsg_0 .. LogMsg_6 only record the format string and the
+** raw parameters in a ring shared by all threads; the messages are formatted
+** when the ring is drained: on the next error trace, when the ring is half
+** full, or on LogMsgDrainDeferredTrace().
+** A message whose format has a %s is formatted at once, as the string may not
+** outlive the call. */
+#define DEFERRED_TRACE_SLOTS        256     /* must be a power of 2 */
+#define DEFERRED_TRACE_HIGH_WATER   (DEFERRED_TRACE_SLOTS / 2)
+#define DEFERRED_TRACE_FMT_CACHE    64      /* must be a power of 2 */
+#define DEFERRED_TRACE_MAX_PARAMS   6
+typedef struct
+{
+    volatile UINT32 seq;                /* message number + 1, 0 while the slot is written */
+    UINT32          trace_set_mask;
+    const char*     fmt_str;
+    UINT64          timestamp;          /* CLOCK_MONOTONIC, in microseconds */
+    UINT32          tid;
+    UINT32          param [DEFERRED_TRACE_MAX_PARAMS];
+} tDEFERRED_TRACE_SLOT;
+
+static BOOLEAN sDeferredTraceEnabled = FALSE;
+static tDEFERRED_TRACE_SLOT sDeferredTrace [DEFERRED_TRACE_SLOTS];
+static UINT32 sDeferredTraceHead = 0;       /* number of messages recorded */
+static UINT32 sDeferredTraceTail = 0;       /* number of messages drained, written under sDeferredTraceLock */
+static pthread_mutex_t sDeferredTraceLock = PTHREAD_MUTEX_INITIALIZER;
+static const char* sDeferredTraceFmt [DEFERRED_TRACE_FMT_CACHE];   /* formats known to have no %s */
+static __thread UINT32 sDeferredTraceTid = 0;
 static void ToHex (const UINT8* data, UINT16 len, char* hexString, UINT16 hexStringSize);
 static void dumpbin (const char* data, int size, UINT32 trace_layer, UINT32 trace_type);
 static inline void word2hex (const char* data, char** hex);
@@ -64,8 +99,45 @@ void ProtoDispAdapterUseRawOutput (BOOLEAN isUseRaw)
 }
 
 
+/*******************************************************************************
+**
+** Function:        ProtoDispAdapterUseBinaryTrace
+**
+** Description:     Enable or disable the binary NCI trace. When enabled, NCI
+**                  packets are kept in memory instead of being written to
+**                  logcat as hex, and ProtoDispAdapterDumpNciTrace() writes
+**                  them to dumpFile.
+**
+** Returns:         None.
+**
+*******************************************************************************/
+void ProtoDispAdapterUseBinaryTrace (BOOLEAN enable, const char* dumpFile)
+{
+    nciTraceRingEnable (enable, dumpFile);
+}
+
+
+/*******************************************************************************
+**
+** Function:        ProtoDispAdapterDumpNciTrace
+**
+** Description:     Write the NCI packets in the trace rings of all threads to
+**                  the dump file, for decoding with nci_trace_decode.
+**
+** Returns:         None.
+**
+*******************************************************************************/
+void ProtoDispAdapterDumpNciTrace ()
+{
+    nciTraceRingDump ();
+}
+
+
 void ProtoDispAdapterDisplayNciPacket (UINT8 *nciPacket, UINT16 nciPacketLen, BOOLEAN is_recv)
 {
+    if (nciTraceRingRecord (nciPacket, nciPacketLen, is_recv))
+        return;
+
     //Protocol decoder is not available, so decode NCI packet into hex numbers.
     if (!(ScrProtocolTraceFlag & SCR_PROTO_TRACE_NCI))
         return;
@@ -294,6 +366,203 @@ inline void byte2hex (const char* data, char** str)
     void DispNDEFMsg (UINT8 *pMsg, UINT32 MsgLen, BOOLEAN is_recv) {}
 
 
+/*******************************************************************************
+**
+** Function:        logMsgAndroidLevel
+**
+** Description:     Android log priority of a trace message.
+**
+** Returns:         ANDROID_LOG_ERROR for an error, ANDROID_LOG_INFO otherwise.
+**
+*******************************************************************************/
+static int logMsgAndroidLevel (UINT32 trace_set_mask)
+{
+    //lower 3 bits contain trace type
+    return ((trace_set_mask & 0x07) == TRACE_TYPE_ERROR) ? ANDROID_LOG_ERROR : ANDROID_LOG_INFO;
+}
+
+
+/*******************************************************************************
+**
+** Function:        deferredTraceCanDefer
+**
+** Description:     Check whether a message can be formatted later, i.e. its
+**                  format string has no %s conversion. Format strings that
+**                  can be deferred are cached by address.
+**
+** Returns:         TRUE if the message can be deferred.
+**
+*******************************************************************************/
+static BOOLEAN deferredTraceCanDefer (const char* fmt_str)
+{
+    const char** p_cache = &sDeferredTraceFmt [((uintptr_t) fmt_str >> 2) & (DEFERRED_TRACE_FMT_CACHE - 1)];
+    const char* p = fmt_str;
+
+    if (__atomic_load_n (p_cache, __ATOMIC_RELAXED) == fmt_str)
+        return TRUE;
+
+    while ((p = strchr (p, '%')) != NULL)
+    {
+        p += strspn (p + 1, "-+ #0123456789.*hlLqjzt") + 1;
+        if (*p == 's')
+            return FALSE;
+        if (*p == '\0')
+            break;
+        p++;
+    }
+    __atomic_store_n (p_cache, fmt_str, __ATOMIC_RELAXED);
+    return TRUE;
+}
+
+
+/*******************************************************************************
+**
+** Function:        deferredTraceDrainLocked
+**
+** Description:     Format and print the messages recorded since the last
+**                  drain, oldest first, at the priority they were traced
+**                  with, prefixed with the time they were traced and the
+**                  thread that traced them. Messages that were overwritten
+**                  before the drain are reported as lost.
+**                  The caller holds sDeferredTraceLock.
+**
+** Returns:         None.
+**
+*******************************************************************************/
+static void deferredTraceDrainLocked ()
+{
+    char buffer [BTE_LOG_BUF_SIZE];
+    tDEFERRED_TRACE_SLOT slot;
+    UINT32 head, tail = sDeferredTraceTail;
+    int len;
+
+    head = __atomic_load_n (&sDeferredTraceHead, __ATOMIC_ACQUIRE);
+    if (head - tail > DEFERRED_TRACE_SLOTS)
+    {
+        snprintf (buffer, sizeof (buffer), "%lu deferred trace messages lost",
+                  (unsigned long) (head - tail - DEFERRED_TRACE_SLOTS));
+        __android_log_write (ANDROID_LOG_WARN, LOGMSG_TAG_NAME, buffer);
+        tail = head - DEFERRED_TRACE_SLOTS;
+    }
+
+    for ( ; tail != head; tail++)
+    {
+        tDEFERRED_TRACE_SLOT* p_slot = &sDeferredTrace [tail & (DEFERRED_TRACE_SLOTS - 1)];
+        UINT32 seq = __atomic_load_n (&p_slot->seq, __ATOMIC_ACQUIRE);
+
+        /* skip the slot if it is still being written or was overwritten */
+        if (seq != tail + 1)
+            continue;
+        memcpy (&slot, p_slot, sizeof (slot));
+        __atomic_thread_fence (__ATOMIC_ACQUIRE);
+        if (__atomic_load_n (&p_slot->seq, __ATOMIC_RELAXED) != seq)
+            continue;
+
+        len = snprintf (buffer, sizeof (buffer), "[%lu.%06lu %lu] ", (unsigned long) (slot.timestamp / 1000000),
+                        (unsigned long) (slot.timestamp % 1000000), (unsigned long) slot.tid);
+        snprintf (buffer + len, BTE_LOG_MAX_SIZE - len, slot.fmt_str, slot.param[0], slot.param[1],
+                  slot.param[2], slot.param[3], slot.param[4], slot.param[5]);
+        __android_log_write (logMsgAndroidLevel (slot.trace_set_mask), LOGMSG_TAG_NAME, buffer);
+    }
+    __atomic_store_n (&sDeferredTraceTail, tail, __ATOMIC_RELAXED);
+}
+
+
+/*******************************************************************************
+**
+** Function:        deferredTraceRecord
+**
+** Description:     Record a message in the deferred trace ring. An error is
+**                  not deferred; the ring is drained before it is printed.
+**                  The ring is also drained once it is half full, unless
+**                  another thread is draining it, so that messages are not
+**                  lost when no error occurs for a long time.
+**
+** Returns:         TRUE if the message was recorded, FALSE if the caller
+**                  must print it now.
+**
+*******************************************************************************/
+static BOOLEAN deferredTraceRecord (UINT32 trace_set_mask, const char *fmt_str, UINT32 p1, UINT32 p2,
+                                    UINT32 p3, UINT32 p4, UINT32 p5, UINT32 p6)
+{
+    tDEFERRED_TRACE_SLOT* p_slot;
+    struct timespec ts;
+    UINT32 n;
+
+    if (TRACE_GET_TYPE (trace_set_mask) == TRACE_TYPE_ERROR)
+    {
+        LogMsgDrainDeferredTrace ();
+        return FALSE;
+    }
+    if (!deferredTraceCanDefer (fmt_str))
+        return FALSE;
+
+    if (sDeferredTraceTid == 0)
+        sDeferredTraceTid = (UINT32) syscall (SYS_gettid);
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+
+    n = __atomic_fetch_add (&sDeferredTraceHead, 1, __ATOMIC_RELAXED);
+    p_slot = &sDeferredTrace [n & (DEFERRED_TRACE_SLOTS - 1)];
+    __atomic_store_n (&p_slot->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence (__ATOMIC_RELEASE);
+    p_slot->trace_set_mask = trace_set_mask;
+    p_slot->fmt_str        = fmt_str;
+    p_slot->timestamp      = (UINT64) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    p_slot->tid            = sDeferredTraceTid;
+    p_slot->param[0]       = p1;
+    p_slot->param[1]       = p2;
+    p_slot->param[2]       = p3;
+    p_slot->param[3]       = p4;
+    p_slot->param[4]       = p5;
+    p_slot->param[5]       = p6;
+    __atomic_store_n (&p_slot->seq, n + 1, __ATOMIC_RELEASE);
+
+    if (  (n + 1 - __atomic_load_n (&sDeferredTraceTail, __ATOMIC_RELAXED) >= DEFERRED_TRACE_HIGH_WATER)
+        &&(pthread_mutex_trylock (&sDeferredTraceLock) == 0)  )
+    {
+        deferredTraceDrainLocked ();
+        pthread_mutex_unlock (&sDeferredTraceLock);
+    }
+    return TRUE;
+}
+
+
+/*******************************************************************************
+**
+** Function:        LogMsgUseDeferredTrace
+**
+** Description:     Enable or disable deferred formatting of trace messages.
+**                  Messages still in the ring are printed when disabled.
+**
+** Returns:         None.
+**
+*******************************************************************************/
+void LogMsgUseDeferredTrace (BOOLEAN enable)
+{
+    sDeferredTraceEnabled = enable;
+    if (!enable)
+        LogMsgDrainDeferredTrace ();
+}
+
+
+/*******************************************************************************
+**
+** Function:        LogMsgDrainDeferredTrace
+**
+** Description:     Format and print the messages recorded since the last
+**                  drain, see deferredTraceDrainLocked().
+**
+** Returns:         None.
+**
+*******************************************************************************/
+void LogMsgDrainDeferredTrace ()
+{
+    pthread_mutex_lock (&sDeferredTraceLock);
+    deferredTraceDrainLocked ();
+    pthread_mutex_unlock (&sDeferredTraceLock);
+}
+
+
 /*******************************************************************************
 **
 ** Function:        LogMsg
@@ -307,54 +576,64 @@ void LogMsg (UINT32 trace_set_mask, const char *fmt_str, ...)
 {
     static char buffer [BTE_LOG_BUF_SIZE];
     va_list ap;
-    UINT32 trace_type = trace_set_mask & 0x07; //lower 3 bits contain trace type
-    int android_log_type = ANDROID_LOG_INFO;
 
     va_start (ap, fmt_str);
     vsnprintf (buffer, BTE_LOG_MAX_SIZE, fmt_str, ap);
     va_end (ap);
-    if (trace_type == TRACE_TYPE_ERROR)
-        android_log_type = ANDROID_LOG_ERROR;
-    __android_log_write (android_log_type, LOGMSG_TAG_NAME, buffer);
+    __android_log_write (logMsgAndroidLevel (trace_set_mask), LOGMSG_TAG_NAME, buffer);
 }
 
 
 void LogMsg_0 (UINT32 maskTraceSet, const char *p_str)
 {
+    if (sDeferredTraceEnabled && deferredTraceRecord (maskTraceSet, p_str, 0, 0, 0, 0, 0, 0))
+        return;
     LogMsg (maskTraceSet, p_str);
 }
 
 
 void LogMsg_1 (UINT32 maskTraceSet, const char *fmt_str, UINT32 p1)
 {
+    if (sDeferredTraceEnabled && deferredTraceRecord (maskTraceSet, fmt_str, p1, 0, 0, 0, 0, 0))
+        return;
     LogMsg (maskTraceSet, fmt_str, p1);
 }
 
 
 void LogMsg_2 (UINT32 maskTraceSet, const char *fmt_str, UINT32 p1, UINT32 p2)
 {
+    if (sDeferredTraceEnabled && deferredTraceRecord (maskTraceSet, fmt_str, p1, p2, 0, 0, 0, 0))
+        return;
     LogMsg (maskTraceSet, fmt_str, p1, p2);
 }
 
 
 void LogMsg_3 (UINT32 maskTraceSet, const char *fmt_str, UINT32 p1, UINT32 p2, UINT32 p3)
 {
+    if (sDeferredTraceEnabled && deferredTraceRecord (maskTraceSet, fmt_str, p1, p2, p3, 0, 0, 0))
+        return;
     LogMsg (maskTraceSet, fmt_str, p1, p2, p3);
 }
 
 
 void LogMsg_4 (UINT32 maskTraceSet, const char *fmt_str, UINT32 p1, UINT32 p2, UINT32 p3, UINT32 p4)
 {
+    if (sDeferredTraceEnabled && deferredTraceRecord (maskTraceSet, fmt_str, p1, p2, p3, p4, 0, 0))
+        return;
     LogMsg (maskTraceSet, fmt_str, p1, p2, p3, p4);
 }
 
 void LogMsg_5 (UINT32 maskTraceSet, const char *fmt_str, UINT32 p1, UINT32 p2, UINT32 p3, UINT32 p4, UINT32 p5)
 {
+    if (sDeferredTraceEnabled && deferredTraceRecord (maskTraceSet, fmt_str, p1, p2, p3, p4, p5, 0))
+        return;
     LogMsg (maskTraceSet, fmt_str, p1, p2, p3, p4, p5);
 }
 
 
 void LogMsg_6 (UINT32 maskTraceSet, const char *fmt_str, UINT32 p1, UINT32 p2, UINT32 p3, UINT32 p4, UINT32 p5, UINT32 p6)
 {
+    if (sDeferredTraceEnabled && deferredTraceRecord (maskTraceSet, fmt_str, p1, p2, p3, p4, p5, p6))
+        return;
     LogMsg (maskTraceSet, fmt_str, p1, p2, p3, p4, p5, p6);
 }
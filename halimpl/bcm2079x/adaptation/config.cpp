@@ -17,10 +17,11 @@
  ******************************************************************************/
 #include "OverrideLog.h"
 #include "config.h"
+#include "ConfigIndex.h"
 #include <stdio.h>
 #include <string>
 #include <vector>
-#include <list>
+#include <algorithm>
 
 #define LOG_TAG "NfcNciHal"
 
@@ -63,10 +64,9 @@ public:
 private:
     CNfcConfig();
     bool    readConfig(const char* name, bool bResetContent);
-    void    moveFromList();
-    void    moveToList();
     void    add(const CNfcParam* pParam);
-    list<const CNfcParam*> m_list;
+    void    buildIndex();
+    vector<size_t> m_index;     // hash slot -> setting array index + 1, 0 if empty
     bool    mValidFile;
 
     unsigned long   state;
@@ -142,8 +142,8 @@ inline int getDigitValue(char c, int base)
 **
 ** Function:    CNfcConfig::readConfig()
 **
-** Description: read Config settings and parse them into a linked list
-**              move the element from linked list to a array at the end
+** Description: read Config settings into memory in one go, parse them into
+**              the setting array and index it by name at the end
 **
 ** Returns:     none
 **
@@ -184,16 +184,25 @@ bool CNfcConfig::readConfig(const char* name, bool bResetContent)
     ALOGD("%s Opened %s config %s\n", __func__, (bResetContent ? "base" : "optional"), name);
 
     mValidFile = true;
-    if (size() > 0)
-    {
-        if (bResetContent)
+    if (bResetContent)
         clean();
-        else
-            moveToList();
+
+    /* read the whole file at once and parse it from memory */
+    fseek(fd, 0, SEEK_END);
+    long fileLen = ftell(fd);
+    fseek(fd, 0, SEEK_SET);
+    string  content;
+    if (fileLen > 0)
+    {
+        content.resize(fileLen);
+        content.resize(fread(&content[0], 1, fileLen, fd));
     }
+    fclose(fd);
+    size_t  pos = 0;
 
-    while (!feof(fd) && fread(&c, 1, 1, fd) == 1)
+    while (pos < content.length())
     {
+        c = content[pos++];
         switch (state & 0xff)
         {
         case BEGIN_LINE:
@@ -330,9 +339,7 @@ bool CNfcConfig::readConfig(const char* name, bool bResetContent)
         }
     }
 
-    fclose(fd);
-
-    moveFromList();
+    buildIndex();
     return size() > 0;
 }
 
@@ -466,32 +473,14 @@ bool CNfcConfig::getValue(const char* name, unsigned short& rValue) const
 **
 ** Function:    CNfcConfig::find()
 **
-** Description: search if a setting exist in the setting array
+** Description: look up a setting by name in the hash index
 **
 ** Returns:     pointer to the setting object
 **
 *******************************************************************************/
 const CNfcParam* CNfcConfig::find(const char* p_name) const
 {
-    if (size() == 0)
-        return NULL;
-
-    for (const_iterator it = begin(), itEnd = end(); it != itEnd; ++it)
-    {
-        if (**it < p_name)
-            continue;
-        else if (**it == p_name)
-        {
-            if((*it)->str_len() > 0)
-                ALOGD("%s found %s=%s\n", __func__, p_name, (*it)->str_value());
-            else
-                ALOGD("%s found %s=(0x%lX)\n", __func__, p_name, (*it)->numValue());
-            return *it;
-        }
-        else
-            break;
-    }
-    return NULL;
+    return configFind<CNfcParam>(*this, m_index, p_name);
 }
 
 /*******************************************************************************
@@ -511,70 +500,37 @@ void CNfcConfig::clean()
     for (iterator it = begin(), itEnd = end(); it != itEnd; ++it)
         delete *it;
     clear();
+    m_index.clear();
 }
 
 /*******************************************************************************
 **
 ** Function:    CNfcConfig::Add()
 **
-** Description: add a setting object to the list
+** Description: add a setting object to the array, buildIndex() sorts it
 **
 ** Returns:     none
 **
 *******************************************************************************/
 void CNfcConfig::add(const CNfcParam* pParam)
 {
-    if (m_list.size() == 0)
-    {
-        m_list.push_back(pParam);
-        return;
-    }
-    for (list<const CNfcParam*>::iterator it = m_list.begin(), itEnd = m_list.end(); it != itEnd; ++it)
-    {
-        if (**it < pParam->c_str())
-            continue;
-        m_list.insert(it, pParam);
-        return;
-    }
-    m_list.push_back(pParam);
-}
-
-/*******************************************************************************
-**
-** Function:    CNfcConfig::moveFromList()
-**
-** Description: move the setting object from list to array
-**
-** Returns:     none
-**
-*******************************************************************************/
-void CNfcConfig::moveFromList()
-{
-    if (m_list.size() == 0)
-        return;
-
-    for (list<const CNfcParam*>::iterator it = m_list.begin(), itEnd = m_list.end(); it != itEnd; ++it)
-        push_back(*it);
-    m_list.clear();
+    push_back(pParam);
 }
 
 /*******************************************************************************
 **
-** Function:    CNfcConfig::moveToList()
+** Function:    CNfcConfig::buildIndex()
 **
-** Description: move the setting object from array to list
+** Description: sort the setting array by name, drop settings overridden by a
+**              later definition of the same name, and rebuild the hash
+**              index used by find()
 **
 ** Returns:     none
 **
 *******************************************************************************/
-void CNfcConfig::moveToList()
+void CNfcConfig::buildIndex()
 {
-    if (m_list.size() != 0)
-        m_list.clear();
-
-    for (iterator it = begin(), itEnd = end(); it != itEnd; ++it)
-        m_list.push_back(*it);
-    clear();
+    configBuildIndex<CNfcParam>(*this, m_index);
 }
 
 /*******************************************************************************
@@ -24,10 +24,18 @@ extern "C"
     #include "nfc_hal_post_reset.h"
 }
 #include <malloc.h>
+#include <string.h>
 #include <string>
+#include <vector>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <cutils/properties.h>
 #include "spdhelper.h"
 #include "StartupConfig.h"
+#include "Crc16.h"
 
 #define LOG_TAG "NfcNciHal"
 
@@ -38,8 +46,45 @@ extern "C"
 #define MAX_BUFFER      (512)
 static char sPrePatchFn[MAX_BUFFER+1];
 static char sPatchFn[MAX_BUFFER+1];
-static void * sPrmBuf = NULL;
-static void * sI2cFixPrmBuf = NULL;
+
+#define PATCHFILE_HDR_LEN       8   /* PRJID + MAJORVER + MINORVER + RFU + COUNT */
+#define PATCHFILE_DESC_LEN      8   /* POWER MODE + LEN + 5 RFU */
+
+/* Patch file mapped read-only in memory. It is checked once, and kept until
+** the file changes, so that a reinit does not read or check it again. */
+typedef struct
+{
+    char        fn[MAX_BUFFER+1];   /* file name, empty if nothing cached */
+    dev_t       dev;                /* file identity at the time it was checked */
+    ino_t       ino;
+    off_t       size;
+    time_t      mtime;
+    UINT8       *p_data;            /* mapped file, NULL if the file is bad */
+    UINT8       num_patches;
+    std::vector<UINT16> seg_offsets;    /* file offset of each segment, in file order */
+    UINT16      first_seg[NFC_HAL_PRM_MAX_PATCH_COUNT + 1]; /* index in seg_offsets of the first segment of each patch */
+} tPATCH_FILE;
+static tPATCH_FILE sPatchFile;
+static tPATCH_FILE sPrePatchFile;
+
+/* Post initialization steps NFCC rejected, saved for the next start up with
+** what they depend on: chip, patch in NVM, patch file and configuration. */
+#define STARTUP_STATE_VERSION   1
+typedef struct
+{
+    UINT8       version;
+    UINT8       patchHdr[6];        /* PRJID + MAJORVER + MINORVER of patch file */
+    UINT32      brcmHwId;
+    UINT16      nvmProjectId;
+    UINT16      nvmVerMajor;
+    UINT16      nvmVerMinor;
+    UINT16      configHash;
+    UINT32      rejectedMask;
+} tSTARTUP_STATE;
+static tSTARTUP_STATE sStartupState;
+static bool sStartupStateSaved = false;
+extern bool read_hal_startup_state (UINT8 *p_buf, UINT16 nbytes);
+extern bool write_hal_startup_state (const UINT8 *p_buf, UINT16 nbytes);
 
 #define CONFIG_MAX_LEN 256
 static UINT8 sConfig [CONFIG_MAX_LEN];
@@ -54,6 +99,7 @@ extern UINT8 *p_nfc_hal_dm_lptd_cfg; //defined in the HAL
 static UINT8 sDontSendLptd[] = { 0 };
 extern UINT8 *p_nfc_hal_pre_discover_cfg; //defined in the HAL
 extern UINT8 *p_nfc_hal_dm_xtal_params_cfg; //defined in HAL
+extern UINT8 *p_nfc_hal_dm_pll_325_cfg; //defined in HAL
 
 extern tSNOOZE_MODE_CONFIG gSnoozeModeCfg;
 extern tNFC_HAL_CFG *p_nfc_hal_cfg;
@@ -108,21 +154,291 @@ tNFC_POST_RESET_CB nfc_post_reset_cb =
 
 /*******************************************************************************
 **
-** Function         getFileLength
+** Function         checkPatchFile
+**
+** Description      Check the layout of a patch file in NCD format: header,
+**                  patch descriptors, then for each patch a sequence of
+**                  secure patch download commands that ends with the
+**                  signature. The patchram download relies on it.
+**
+** Returns          TRUE if the patch file can be downloaded
+**
+*******************************************************************************/
+static BOOLEAN checkPatchFile(tPATCH_FILE& pf, const UINT8 *p_data, size_t len)
+{
+    const UINT8 *p = p_data, *p_end = p_data + len, *p_patch_end, *p_seg_end;
+    UINT16 patch_len;
+    UINT8 num_patches, seg_len, oid, type = 0, xx;
+
+    pf.num_patches = 0;
+    pf.seg_offsets.clear();
+
+    /* The HAL keeps lengths and offsets in 16 bits */
+    if ((len < PATCHFILE_HDR_LEN) || (len > 0xFFFF))
+    {
+        ALOGE("%s %s: bad size (%u)", __FUNCTION__, pf.fn, (unsigned) len);
+        return FALSE;
+    }
+
+    num_patches = p[PATCHFILE_HDR_LEN - 1];
+    p += PATCHFILE_HDR_LEN;
+    if (  (num_patches > NFC_HAL_PRM_MAX_PATCH_COUNT)
+        ||((size_t) (p_end - p) < (size_t) num_patches * PATCHFILE_DESC_LEN)  )
+    {
+        ALOGE("%s %s: bad number of patches (%u)", __FUNCTION__, pf.fn, num_patches);
+        return FALSE;
+    }
+
+    /* Patch data follows the descriptors */
+    p_patch_end = p + num_patches * PATCHFILE_DESC_LEN;
+    for (xx = 0; xx < num_patches; xx++, p += PATCHFILE_DESC_LEN)
+    {
+        const UINT8 *p_seg = p_patch_end;
+
+        pf.first_seg[xx] = (UINT16) pf.seg_offsets.size();
+        patch_len = p[1] | (p[2] << 8);
+        if ((size_t) (p_end - p_seg) < patch_len)
+        {
+            ALOGE("%s %s: patch %u truncated", __FUNCTION__, pf.fn, xx);
+            return FALSE;
+        }
+        p_patch_end = p_seg + patch_len;
+
+        /* Each segment is HCIT + NCI header + type + payload */
+        while (p_seg < p_patch_end)
+        {
+            if ((p_patch_end - p_seg) < NCI_MSG_HDR_SIZE + 2)
+                break;
+            oid     = p_seg[2];
+            seg_len = p_seg[3];
+            type    = p_seg[4];
+            p_seg_end = p_seg + 1 + NCI_MSG_HDR_SIZE + seg_len;
+            if ((seg_len == 0) || (p_seg_end > p_patch_end) || (oid != NCI_MSG_SECURE_PATCH_DOWNLOAD))
+                break;
+
+            /* The header carries the chip version the patch is for */
+            if (  (type == NCI_SPD_TYPE_HEADER)
+                &&(  (seg_len < 1 + NCI_SPD_HEADER_OFFSET_CHIPVERLEN + 1 + NCI_SPD_HEADER_CHIPVER_LEN)
+                   ||(p_seg[5 + NCI_SPD_HEADER_OFFSET_CHIPVERLEN] > NCI_SPD_HEADER_CHIPVER_LEN)  )  )
+                break;
+
+            pf.seg_offsets.push_back((UINT16) (p_seg - p_data));
+            p_seg = p_seg_end;
+        }
+
+        if ((p_seg != p_patch_end) || (type != NCI_SPD_TYPE_SIGNATURE))
+        {
+            ALOGE("%s %s: patch %u: bad segment at offset %u", __FUNCTION__, pf.fn, xx, (unsigned) (p_seg - p_data));
+            return FALSE;
+        }
+    }
+
+    pf.first_seg[num_patches] = (UINT16) pf.seg_offsets.size();
+    pf.num_patches = num_patches;
+    return TRUE;
+}
+
+/*******************************************************************************
+**
+** Function         findPatchSegment
 **
-** Description      return the size of a file
+** Description      Find the segment of a checked patch file that holds a
+**                  file offset, from the segment index built by
+**                  checkPatchFile.
 **
-** Returns          file size in number of bytes
+** Returns          TRUE if found; *pPatch and *pSeg are the patch and the
+**                  segment number in that patch
 **
 *******************************************************************************/
-static long getFileLength(FILE* fp)
+static BOOLEAN findPatchSegment(const tPATCH_FILE& pf, UINT16 offset, UINT8 *pPatch, UINT16 *pSeg)
 {
-    long sz;
-    fseek(fp, 0L, SEEK_END);
-    sz = ftell(fp);
-    fseek(fp, 0L, SEEK_SET);
+    std::vector<UINT16>::const_iterator it;
+    UINT16 seg;
+    UINT8 xx;
+
+    /* last segment starting at or before offset */
+    it = std::upper_bound(pf.seg_offsets.begin(), pf.seg_offsets.end(), offset);
+    if (it == pf.seg_offsets.begin())
+        return FALSE;
+    seg = (UINT16) (it - pf.seg_offsets.begin() - 1);
 
-    return (sz > 0) ? sz : 0;
+    for (xx = 0; xx < pf.num_patches; xx++)
+    {
+        if (seg < pf.first_seg[xx + 1])
+        {
+            *pPatch = xx;
+            *pSeg   = seg - pf.first_seg[xx];
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/*******************************************************************************
+**
+** Function         mapPatchFile
+**
+** Description      Map a patch file read-only and check it. If the file has
+**                  not changed since the last call, the previous result is
+**                  used without reading the file again.
+**
+** Returns          patch file data, or NULL if the file is missing or bad
+**
+*******************************************************************************/
+static UINT8* mapPatchFile(tPATCH_FILE& pf, const char *pFilename, UINT32 *pLen)
+{
+    struct stat st;
+    void *p_map;
+    int fd;
+
+    if (stat(pFilename, &st) != 0)
+    {
+        ALOGE("%s Unable to open patchfile %s", __FUNCTION__, pFilename);
+        return NULL;
+    }
+
+    if (  (strcmp(pf.fn, pFilename) == 0)
+        &&(pf.dev == st.st_dev) && (pf.ino == st.st_ino)
+        &&(pf.size == st.st_size) && (pf.mtime == st.st_mtime)  )
+    {
+        ALOGD("%s %s unchanged (%s)", __FUNCTION__, pFilename, pf.p_data ? "valid" : "bad");
+        *pLen = (UINT32) pf.size;
+        return pf.p_data;
+    }
+
+    /* Drop the previous version; no download is using it at this point */
+    if (pf.p_data)
+        munmap(pf.p_data, pf.size);
+    pf.p_data = NULL;
+    pf.fn[0] = '\0';
+
+    if ((fd = open(pFilename, O_RDONLY)) < 0)
+    {
+        ALOGE("%s Unable to open patchfile %s", __FUNCTION__, pFilename);
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return NULL;
+    }
+    p_map = (st.st_size > 0) ? mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+
+    strncpy(pf.fn, pFilename, MAX_BUFFER);
+    pf.fn[MAX_BUFFER] = '\0';
+    pf.dev   = st.st_dev;
+    pf.ino   = st.st_ino;
+    pf.size  = st.st_size;
+    pf.mtime = st.st_mtime;
+
+    if (p_map == MAP_FAILED)
+    {
+        ALOGE("%s Unable to map patchfile %s (%ld bytes)", __FUNCTION__, pFilename, (long) st.st_size);
+        pf.fn[0] = '\0';
+        return NULL;
+    }
+
+    if (!checkPatchFile(pf, (UINT8*) p_map, st.st_size))
+    {
+        /* Remembered as bad until the file changes */
+        munmap(p_map, st.st_size);
+        return NULL;
+    }
+
+    ALOGD("%s %s: %u patches, %u segments", __FUNCTION__, pFilename, pf.num_patches, (unsigned) pf.seg_offsets.size());
+    pf.p_data = (UINT8*) p_map;
+    *pLen = (UINT32) pf.size;
+    return pf.p_data;
+}
+
+/*******************************************************************************
+**
+** Function         getStartupConfigHash
+**
+** Description      Compute a hash of what is sent to NFCC in post
+**                  initialization, see nfc_hal_dm_config_nfcc.
+**
+** Returns          hash
+**
+*******************************************************************************/
+static UINT16 getStartupConfigHash()
+{
+    const UINT8 fixed[] = { NFC_HAL_I93_FLAG_DATA_RATE, NFC_HAL_DM_MULTI_TECH_RESP };
+    UINT16 hash = crc16Arc(0, fixed, sizeof(fixed));
+
+    hash = crc16Arc(hash, p_nfc_hal_dm_lptd_cfg, p_nfc_hal_dm_lptd_cfg[0] + 1);
+    hash = crc16Arc(hash, p_nfc_hal_dm_start_up_cfg, p_nfc_hal_dm_start_up_cfg[0] + 1);
+    if (p_nfc_hal_dm_start_up_vsc_cfg)
+        hash = crc16Arc(hash, p_nfc_hal_dm_start_up_vsc_cfg, p_nfc_hal_dm_start_up_vsc_cfg[0] + 1);
+    if (p_nfc_hal_dm_pll_325_cfg)
+        hash = crc16Arc(hash, p_nfc_hal_dm_pll_325_cfg, NFC_HAL_PLL_325_SETCONFIG_PARAM_LEN);
+    return hash;
+}
+
+/*******************************************************************************
+**
+** Function         loadStartupState
+**
+** Description      Read the start-up state saved for this chip, patch and
+**                  configuration, and tell the HAL which post initialization
+**                  steps to skip.
+**
+** Returns          None
+**
+*******************************************************************************/
+static void loadStartupState(UINT32 chipid, const UINT8 *pPatch)
+{
+    tSTARTUP_STATE saved;
+
+    memset(&sStartupState, 0, sizeof(sStartupState));
+    sStartupState.version       = STARTUP_STATE_VERSION;
+    if (pPatch)
+        memcpy(sStartupState.patchHdr, pPatch, sizeof(sStartupState.patchHdr));
+    sStartupState.brcmHwId      = chipid;
+    sStartupState.nvmProjectId  = nfc_hal_cb.nvm_cb.project_id;
+    sStartupState.nvmVerMajor   = nfc_hal_cb.nvm_cb.ver_major;
+    sStartupState.nvmVerMinor   = nfc_hal_cb.nvm_cb.ver_minor;
+    sStartupState.configHash    = getStartupConfigHash();
+
+    memset(&saved, 0, sizeof(saved));
+    sStartupStateSaved = read_hal_startup_state((UINT8*) &saved, sizeof(saved));
+    saved.rejectedMask &= NFC_HAL_DM_STARTUP_SKIPPABLE;
+    sStartupState.rejectedMask = saved.rejectedMask;
+    if (sStartupStateSaved && (memcmp(&saved, &sStartupState, sizeof(saved)) != 0))
+    {
+        ALOGD("%s chip, patch or configuration changed", __FUNCTION__);
+        sStartupStateSaved = false;
+    }
+    if (!sStartupStateSaved)
+        sStartupState.rejectedMask = 0;
+
+    HAL_NfcSetStartupSkipMask(sStartupState.rejectedMask);
+}
+
+/*******************************************************************************
+**
+** Function         nfc_hal_post_init_result
+**
+** Description      Called by the NFC HAL at the end of post initialization.
+**                  Save the steps NFCC rejected if they changed.
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfc_hal_post_init_result (UINT32 rejected_mask)
+{
+    ALOGD("%s rejected=0x%08lx", __FUNCTION__, rejected_mask);
+
+    if (sStartupState.version != STARTUP_STATE_VERSION)
+        return;
+
+    rejected_mask &= NFC_HAL_DM_STARTUP_SKIPPABLE;
+    if (sStartupStateSaved && (rejected_mask == sStartupState.rejectedMask))
+        return;
+
+    sStartupState.rejectedMask = rejected_mask;
+    sStartupStateSaved = write_hal_startup_state((const UINT8*) &sStartupState, sizeof(sStartupState));
 }
 
 /*******************************************************************************
@@ -266,6 +582,18 @@ static void postDownloadPatchram(tHAL_NFC_STATUS status)
 void prmCallback(UINT8 event)
 {
     ALOGD("%s: event=0x%x", __FUNCTION__, event);
+
+    /* Tell which segment of the patch file the download stopped at */
+    if (  (event != NFC_HAL_PRM_CONTINUE_EVT) && (event != NFC_HAL_PRM_COMPLETE_EVT)
+        &&(sPatchFile.p_data != NULL) && (nfc_hal_cb.prm.p_cur_patch_data == sPatchFile.p_data)  )
+    {
+        UINT8 patch;
+        UINT16 seg;
+
+        if (findPatchSegment(sPatchFile, nfc_hal_cb.prm.cur_patch_offset, &patch, &seg))
+            ALOGE("%s: %s: stopped at patch %u, segment %u (offset %u)", __FUNCTION__, sPatchFile.fn, patch, seg, nfc_hal_cb.prm.cur_patch_offset);
+    }
+
     switch (event)
     {
     case NFC_HAL_PRM_CONTINUE_EVT:
@@ -413,78 +741,62 @@ static void StartPatchDownload(UINT32 chipid)
     readOptionalConfig("fime");     // Read optional FIME specific settings
     getNfaValues(chipid);                 // Get NFA configuration values into variables
 
+    {
+        unsigned long num = 0;
+        /* Patch segments sent without waiting for their responses (chip specific) */
+        if (GetNumValue(NAME_SPD_WINDOW, &num, sizeof(num)) && (num <= 0xFF))
+            HAL_NfcPrmSetSpdWindow((UINT8)num);
+    }
+
     findPatchramFile(FW_PATCH, sPatchFn, sizeof(sPatchFn));
     findPatchramFile(FW_PRE_PATCH, sPrePatchFn, sizeof(sPatchFn));
 
+    /* If an I2C fix patch file was specified, then tell the stack about it */
+    if (sPrePatchFn[0] != '\0')
     {
-        FILE *fd;
-        /* If an I2C fix patch file was specified, then tell the stack about it */
-        if (sPrePatchFn[0] != '\0')
-        {
-            if ((fd = fopen(sPrePatchFn, "rb")) != NULL)
-            {
-                UINT32 lenPrmBuffer = getFileLength(fd);
+        UINT32 lenPrmBuffer = 0;
+        UINT8 *pPrmBuffer = mapPatchFile(sPrePatchFile, sPrePatchFn, &lenPrmBuffer);
 
-                if ((sI2cFixPrmBuf = malloc(lenPrmBuffer)) != NULL)
-                {
-                    size_t actualLen = fread(sI2cFixPrmBuf, 1, lenPrmBuffer, fd);
-                    if (actualLen == lenPrmBuffer)
-                    {
-                        ALOGD("%s Setting I2C fix to %s (size: %lu)", __FUNCTION__, sPrePatchFn, lenPrmBuffer);
-                        HAL_NfcPrmSetI2cPatch((UINT8*)sI2cFixPrmBuf, (UINT16)lenPrmBuffer, 0);
-                    }
-                    else
-                        ALOGE("%s fail reading i2c fix; actual len=%u; expected len=%lu", __FUNCTION__, actualLen, lenPrmBuffer);
-                }
-                else
-                {
-                    ALOGE("%s Unable to get buffer to i2c fix (%lu bytes)", __FUNCTION__, lenPrmBuffer);
-                }
-
-                fclose(fd);
-            }
-            else
-            {
-                ALOGE("%s Unable to open i2c fix patchfile %s", __FUNCTION__, sPrePatchFn);
-            }
+        if (pPrmBuffer != NULL)
+        {
+            ALOGD("%s Setting I2C fix to %s (size: %lu)", __FUNCTION__, sPrePatchFn, lenPrmBuffer);
+            HAL_NfcPrmSetI2cPatch(pPrmBuffer, (UINT16)lenPrmBuffer, 0);
+        }
+        else
+        {
+            ALOGE("%s fail reading i2c fix %s", __FUNCTION__, sPrePatchFn);
+            /* A previous version may have been unmapped */
+            HAL_NfcPrmSetI2cPatch(NULL, 0, 0);
         }
     }
 
     {
-        FILE *fd;
+        UINT32 lenPrmBuffer = 0;
+        UINT8 *pPrmBuffer = NULL;
+
+        if (sPatchFn[0] != '\0')
+            pPrmBuffer = mapPatchFile(sPatchFile, sPatchFn, &lenPrmBuffer);
+
+        /* Known results of post initialization, before it may start */
+        loadStartupState(chipid, pPrmBuffer);
 
         /* If a patch file was specified, then download it now */
         if (sPatchFn[0] != '\0')
         {
             UINT32 bDownloadStarted = false;
 
-            /* open patchfile, read it into a buffer */
-            if ((fd = fopen(sPatchFn, "rb")) != NULL)
+            if (pPrmBuffer != NULL)
             {
-                UINT32 lenPrmBuffer = getFileLength(fd);
                 ALOGD("%s Downloading patchfile %s (size: %lu) format=%u", __FUNCTION__, sPatchFn, lenPrmBuffer, NFC_HAL_PRM_FORMAT_NCD);
-                if ((sPrmBuf = malloc(lenPrmBuffer)) != NULL)
+                if (!SpdHelper::isPatchBad(pPrmBuffer, lenPrmBuffer))
                 {
-                    size_t actualLen = fread(sPrmBuf, 1, lenPrmBuffer, fd);
-                    if (actualLen == lenPrmBuffer)
-                    {
-                        if (!SpdHelper::isPatchBad((UINT8*)sPrmBuf, lenPrmBuffer))
-                        {
-                            /* Download patch using static memeory mode */
-                            HAL_NfcPrmDownloadStart(NFC_HAL_PRM_FORMAT_NCD, 0, (UINT8*)sPrmBuf, lenPrmBuffer, 0, prmCallback);
-                            bDownloadStarted = true;
-                        }
-                    }
-                    else
-                        ALOGE("%s fail reading patchram", __FUNCTION__);
+                    /* Download patch straight from the mapped file */
+                    HAL_NfcPrmDownloadStart(NFC_HAL_PRM_FORMAT_NCD, 0, pPrmBuffer, lenPrmBuffer, 0, prmCallback);
+                    bDownloadStarted = true;
                 }
-                else
-                    ALOGE("%s Unable to buffer to hold patchram (%lu bytes)", __FUNCTION__, lenPrmBuffer);
-
-                fclose(fd);
             }
             else
-                ALOGE("%s Unable to open patchfile %s", __FUNCTION__, sPatchFn);
+                ALOGE("%s fail reading patchram %s", __FUNCTION__, sPatchFn);
 
             /* If the download never got started */
             if (!bDownloadStarted)
@@ -36,6 +36,7 @@
 #include "upio.h"
 #include "bcm2079x.h"
 #include "config.h"
+#include "NfcMetrics.h"
 
 #define HCISU_EVT                           EVENT_MASK(APPL_EVT_0)
 #define MAX_ERROR                           10
@@ -58,6 +59,16 @@ int isLowSpeedTransport = 0;
 int nfc_wake_delay = 0;
 int nfc_write_delay = 0;
 int gPowerOnDelay = 300;
+
+/* Write pacing modes (NFC_WRITE_PACING) */
+#define USERIAL_PACING_FIXED        0   /* at least 5 ms after each write */
+#define USERIAL_PACING_ADAPTIVE     1   /* gap from measured NFCC response */
+#define USERIAL_WRITE_RETRY_MAX     3   /* retries of a write refused by NFCC */
+
+static int nfc_write_pacing = USERIAL_PACING_FIXED;
+static int nfc_write_gap_min = 500;     /* microseconds */
+static int nfc_write_gap_max = 5000;    /* microseconds */
+static pthread_mutex_t write_pacing_mutex = PTHREAD_MUTEX_INITIALIZER;
 static int gPrePowerOffDelay = 0;    // default value
 static int gPostPowerOffDelay = 0;     // default value
 static pthread_mutex_t close_thread_mutex = PTHREAD_MUTEX_INITIALIZER;
@@ -183,6 +194,14 @@ typedef struct  {
     int         sock_power_control;
     int         client_device_address;
     struct timespec write_time;
+    struct timespec wake_time;      /* adaptive pacing: end of wake delay */
+    struct timespec last_write;     /* adaptive pacing: end of last write */
+    BOOLEAN     w4_rx;              /* nothing received since last write */
+    int         rsp_time;           /* smoothed time from write to receive (us) */
+    int         backoff;            /* extra gap after overruns (us) */
+    UINT32      num_writes;
+    UINT32      num_overruns;
+    UINT32      wait_time;          /* total time waited before writes (us) */
 } tLINUX_CB;
 
 static tLINUX_CB linux_cb;  /* case of multipel port support use array : [MAX_SERIAL_PORT] */
@@ -197,91 +216,25 @@ static BOOLEAN is_close_thread_is_waiting = FALSE;
 static int change_client_addr(int addr);
 
 int   perf_log_every_count = 0;
-typedef struct {
-    const char* label;
-    long    lapse;
-    long    bytes;
-    long    count;
-    long    overhead;
-} tPERF_DATA;
 
 /*******************************************************************************
 **
-** Function         perf_reset
+** Function         userial_metrics_update
 **
-** Description      reset performance measurement data
+** Description      record a transfer in the metrics registry, and log the
+**                  metric every perf_log_every_count transfers
 **
 ** Returns          none
 **
 *******************************************************************************/
-void perf_reset(tPERF_DATA* t)
+static void userial_metrics_update(UINT8 id, UINT32 start, int bytes)
 {
-    t->count =
-    t->bytes =
-    t->lapse = 0;
-}
+    UINT32 count = nfcMetricsRecord(id, nfcMetricsNow() - start, (UINT32)bytes);
 
-/*******************************************************************************
-**
-** Function         perf_log
-**
-** Description      produce a log entry of cvurrent performance data
-**
-** Returns          none
-**
-*******************************************************************************/
-void perf_log(tPERF_DATA* t)
-{
-    // round to nearest ms
-    // t->lapse += 500;
-    // t->lapse /= 1000;
-    if (t->lapse)
-    {
-        if (t->bytes)
-            ALOGD( "%s:%s, bytes=%ld, lapse=%ld (%d.%02d kbps) (bus data rate %d.%02d kbps) overhead %d(%d percent)\n",
-                    __func__,
-                    t->label, t->bytes, t->lapse,
-                    (int)(8 * t->bytes / t->lapse), (int)(800 * t->bytes / (t->lapse)) % 100,
-                    (int)(9 * (t->bytes + t->count * t->overhead) / t->lapse), (int)(900 * (t->bytes + t->count * t->overhead) / (t->lapse)) % 100,
-                    (int)(t->count * t->overhead), (int)(t->count * t->overhead * 100 / t->bytes)
-                    );
-        else
-            ALOGD( "%s:%s, lapse=%ld (average %ld)\n", __func__,
-                    t->label, t->lapse, (int)t->lapse / t->count
-                    );
-    }
-    perf_reset(t);
+    if (perf_log_every_count && ((count % perf_log_every_count) == 0))
+        nfcMetricsLog(id);
 }
 
-/*******************************************************************************
-**
-** Function         perf_update
-**
-** Description      update perforamnce measurement data
-**
-** Returns          none
-**
-*******************************************************************************/
-void perf_update(tPERF_DATA* t, long lapse, long bytes)
-{
-    if (!perf_log_every_count)
-        return;
-    // round to nearest ms
-    lapse += 500;
-    lapse /= 1000;
-    t->count++;
-    t->bytes += bytes;
-    t->lapse += lapse;
-    if (t->count == perf_log_every_count)
-        perf_log(t);
-}
-
-static tPERF_DATA   perf_poll = {"USERIAL_Poll", 0, 0, 0, 0};
-static tPERF_DATA   perf_read = {"USERIAL_Read", 0, 0, 0, 9};
-static tPERF_DATA   perf_write = {"USERIAL_Write", 0, 0, 0, 3};
-static tPERF_DATA   perf_poll_2_poll = {"USERIAL_Poll_to_Poll", 0, 0, 0, 0};
-static clock_t      _poll_t0 = 0;
-
 static UINT32 userial_baud_tbl[] =
 {
     300,        /* USERIAL_BAUD_300          0 */
@@ -347,6 +300,41 @@ static inline int isWake(int state)
         current_nfc_wake_state == asserted_state;
 }
 
+/*******************************************************************************
+**
+** Function           addTime
+**
+** Description        Set a time to now plus a delay
+**
+** Input Parameter    delay in microseconds
+**
+*******************************************************************************/
+static void addTime(struct timespec *p_time, long delay)
+{
+    clock_gettime(CLOCK_MONOTONIC, p_time);
+    p_time->tv_sec += delay / 1000000;
+    p_time->tv_nsec += (delay % 1000000) * 1000;
+    if (p_time->tv_nsec >= 1000*1000*1000)
+    {
+        p_time->tv_nsec -= 1000*1000*1000;
+        p_time->tv_sec++;
+    }
+}
+
+/*******************************************************************************
+**
+** Function           timeUntil
+**
+** Description        Time from a time to another
+**
+** Returns            microseconds, negative if p_to is before p_from
+**
+*******************************************************************************/
+static long timeUntil(const struct timespec *p_from, const struct timespec *p_to)
+{
+    return (p_to->tv_sec - p_from->tv_sec) * 1000000 + (p_to->tv_nsec - p_from->tv_nsec) / 1000;
+}
+
 /*******************************************************************************
 **
 ** Function           setWriteDelay
@@ -367,19 +355,138 @@ static void setWriteDelay(int delay)
         delay = 5;
     }
 
-    clock_gettime(CLOCK_MONOTONIC, &linux_cb.write_time);
-    if (delay > 1000)
+    addTime(&linux_cb.write_time, delay * 1000L);
+}
+
+/*******************************************************************************
+**
+** Function           setWakeDelay
+**
+** Description        Record a delay after NFC_WAKE is asserted. With adaptive
+**                    pacing, the wake delay is kept apart from the write gap
+**                    so that a response from NFCC does not shorten it.
+**
+** Input Parameter    delay in milliseconds
+**
+*******************************************************************************/
+static void setWakeDelay(int delay)
+{
+    if (nfc_write_pacing == USERIAL_PACING_FIXED)
+        setWriteDelay(delay);
+    else
     {
-        linux_cb.write_time.tv_sec += delay / 1000;
-        delay %= 1000;
+        pthread_mutex_lock(&write_pacing_mutex);
+        addTime(&linux_cb.wake_time, delay * 1000L);
+        pthread_mutex_unlock(&write_pacing_mutex);
     }
-    unsigned long write_delay = delay * 1000 * 1000;
-    linux_cb.write_time.tv_nsec += write_delay;
-    if (linux_cb.write_time.tv_nsec > 1000*1000*1000)
+}
+
+/*******************************************************************************
+**
+** Function           setWriteGap
+**
+** Description        Adaptive pacing: record the gap after a write. The gap is
+**                    the smoothed response time of NFCC plus the overrun
+**                    backoff, at least NFC_WRITE_DELAY per byte written, and
+**                    clamped to [NFC_WRITE_GAP_MIN, NFC_WRITE_GAP_MAX].
+**
+** Input Parameter    number of bytes written
+**
+*******************************************************************************/
+static void setWriteGap(int len)
+{
+    long gap;
+
+    pthread_mutex_lock(&write_pacing_mutex);
+    gap = linux_cb.rsp_time + linux_cb.backoff;
+    if (gap < (long) len * nfc_write_delay)
+        gap = (long) len * nfc_write_delay;
+    if (gap < nfc_write_gap_min)
+        gap = nfc_write_gap_min;
+    if (gap > nfc_write_gap_max)
+        gap = nfc_write_gap_max;
+
+    clock_gettime(CLOCK_MONOTONIC, &linux_cb.last_write);
+    addTime(&linux_cb.write_time, gap);
+    linux_cb.w4_rx = TRUE;
+    pthread_mutex_unlock(&write_pacing_mutex);
+}
+
+/*******************************************************************************
+**
+** Function           addWaitTime
+**
+** Description        Add to the total time waited before writes
+**
+** Input Parameter    time waited (us)
+**
+*******************************************************************************/
+static void addWaitTime(long wait)
+{
+    pthread_mutex_lock(&write_pacing_mutex);
+    linux_cb.wait_time += wait;
+    pthread_mutex_unlock(&write_pacing_mutex);
+}
+
+/*******************************************************************************
+**
+** Function           setWriteOverrun
+**
+** Description        Adaptive pacing: NFCC refused or only partially accepted
+**                    a write. Double the backoff, up to NFC_WRITE_GAP_MAX.
+**
+** Returns            time to wait before writing again (us)
+**
+*******************************************************************************/
+static int setWriteOverrun(void)
+{
+    int backoff;
+
+    pthread_mutex_lock(&write_pacing_mutex);
+    if (linux_cb.backoff == 0)
+        linux_cb.backoff = (nfc_write_gap_min > 0) ? nfc_write_gap_min : 1000;
+    else
+        linux_cb.backoff *= 2;
+    if (linux_cb.backoff > nfc_write_gap_max)
+        linux_cb.backoff = nfc_write_gap_max;
+    backoff = linux_cb.backoff;
+    linux_cb.num_overruns++;
+    pthread_mutex_unlock(&write_pacing_mutex);
+
+    return backoff;
+}
+
+/*******************************************************************************
+**
+** Function           setReadDone
+**
+** Description        Adaptive pacing: data has been received from NFCC. The
+**                    first data after a write measures the response time of
+**                    NFCC, and shows that NFCC is ready for the next write.
+**                    The overrun backoff is reduced by a quarter.
+**
+*******************************************************************************/
+static void setReadDone(void)
+{
+    struct timespec now;
+    long   rsp;
+
+    if (nfc_write_pacing == USERIAL_PACING_FIXED)
+        return;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    pthread_mutex_lock(&write_pacing_mutex);
+    if (linux_cb.w4_rx)
     {
-        linux_cb.write_time.tv_nsec -= 1000*1000*1000;
-        linux_cb.write_time.tv_sec++;
+        rsp = timeUntil(&linux_cb.last_write, &now);
+        if (rsp > nfc_write_gap_max)
+            rsp = nfc_write_gap_max;
+        /* moving average over about 4 writes */
+        linux_cb.rsp_time += (rsp - linux_cb.rsp_time) / 4;
+        linux_cb.backoff -= linux_cb.backoff / 4;
+        linux_cb.w4_rx = FALSE;
     }
+    pthread_mutex_unlock(&write_pacing_mutex);
 }
 
 /*******************************************************************************
@@ -402,6 +509,28 @@ static void doWriteDelay()
     clock_gettime(CLOCK_MONOTONIC, &now);
     long delay = 0;
 
+    if (nfc_write_pacing != USERIAL_PACING_FIXED)
+    {
+        pthread_mutex_lock(&write_pacing_mutex);
+        /* NFCC has answered the last write: only the minimum gap applies */
+        if (linux_cb.w4_rx)
+            delay = timeUntil(&now, &linux_cb.write_time);
+        else
+            delay = timeUntil(&now, &linux_cb.last_write) + nfc_write_gap_min;
+
+        if (delay < timeUntil(&now, &linux_cb.wake_time))
+            delay = timeUntil(&now, &linux_cb.wake_time);
+        pthread_mutex_unlock(&write_pacing_mutex);
+
+        if (delay > 0 && delay < 1000000)
+        {
+            ALOGD_IF((appl_trace_level>=BT_TRACE_LEVEL_DEBUG), "doWriteDelay() delay %ld us", delay);
+            usleep(delay);
+            addWaitTime(delay);
+        }
+        return;
+    }
+
     if (now.tv_sec > linux_cb.write_time.tv_sec)
         return;
     else if (now.tv_sec == linux_cb.write_time.tv_sec)
@@ -417,6 +546,7 @@ static void doWriteDelay()
     {
         ALOGD_IF((appl_trace_level>=BT_TRACE_LEVEL_DEBUG), "doWriteDelay() delay %ld ms", delay);
         GKI_delay(delay);
+        addWaitTime(delay * 1000);
     }
 }
 
@@ -619,7 +749,7 @@ int my_read(int fd, uchar *pbuf, int len)
     int ret = 0;
     int count = 0;
     int offset = 0;
-    clock_t t1, t2;
+    UINT32 t;
 
     if (!isLowSpeedTransport && _timeout != POLL_TIMEOUT)
         ALOGD_IF((appl_trace_level>=BT_TRACE_LEVEL_DEBUG), "%s: enter, pbuf=%lx, len = %d\n", __func__, (unsigned long)pbuf, len);
@@ -633,14 +763,9 @@ int my_read(int fd, uchar *pbuf, int len)
     create_signal_fds(&fds[1]);
     fds[1].events = POLLIN | POLLERR | POLLRDNORM;
     fds[1].revents = 0;
-    t1 = clock();
+    t = nfcMetricsNow();
     n = TEMP_FAILURE_RETRY(poll(fds, 2, _timeout));
-    t2 = clock();
-    perf_update(&perf_poll, t2 - t1, 0);
-    if (_poll_t0)
-        perf_update(&perf_poll_2_poll, t2 - _poll_t0, 0);
-
-    _poll_t0 = t2;
+    userial_metrics_update(NFC_METRIC_USERIAL_POLL, t, 0);
     /* See if there was an error */
     if (n < 0)
     {
@@ -661,10 +786,10 @@ int my_read(int fd, uchar *pbuf, int len)
     else
         count = 1;
     do {
-        t2 = clock();
+        t = nfcMetricsNow();
         ret = TEMP_FAILURE_RETRY(read(fd, pbuf+offset, (size_t)count));
         if (ret > 0)
-            perf_update(&perf_read, clock()-t2, ret);
+            userial_metrics_update(NFC_METRIC_USERIAL_READ, t, ret);
 
         if (ret <= 0 || !bSerialPortDevice || len < MIN_BUFSIZE)
             break;
@@ -799,6 +924,7 @@ UINT32 userial_read_thread(UINT32 arg)
             if (rx_length > sRxLength)
                 sRxLength = rx_length;
             p_buf->len = (UINT16)rx_length;
+            setReadDone();
             GKI_enqueue(&Userial_in_q, p_buf);
             if (!isLowSpeedTransport)
                 ALOGD_IF((appl_trace_level>=BT_TRACE_LEVEL_DEBUG), "userial_read_thread(): enqueued p_buf=%p, count=%d, length=%d\n",
@@ -985,6 +1111,14 @@ UDRV_API void USERIAL_Open(tUSERIAL_PORT port, tUSERIAL_OPEN_CFG *p_cfg, tUSERIA
         nfc_wake_delay = num;
     if ( GetNumValue ( NAME_NFC_WRITE_DELAY, &num, sizeof ( num ) ) )
         nfc_write_delay = num;
+    if ( GetNumValue ( NAME_NFC_WRITE_PACING, &num, sizeof ( num ) ) )
+        nfc_write_pacing = num;
+    if ( GetNumValue ( NAME_NFC_WRITE_GAP_MIN, &num, sizeof ( num ) ) )
+        nfc_write_gap_min = num;
+    if ( GetNumValue ( NAME_NFC_WRITE_GAP_MAX, &num, sizeof ( num ) ) )
+        nfc_write_gap_max = num;
+    if (nfc_write_gap_max < nfc_write_gap_min)
+        nfc_write_gap_max = nfc_write_gap_min;
     if ( GetNumValue ( NAME_PERF_MEASURE_FREQ, &num, sizeof ( num ) ) )
         perf_log_every_count = num;
     if ( GetNumValue ( NAME_POWER_ON_DELAY, &num, sizeof ( num ) ) )
@@ -998,10 +1132,21 @@ UDRV_API void USERIAL_Open(tUSERIAL_PORT port, tUSERIAL_OPEN_CFG *p_cfg, tUSERIA
     ALOGI("USERIAL_Open() device: %s port=%d, uart_port=%d WAKE_DELAY(%d) WRITE_DELAY(%d) POWER_ON_DELAY(%d) PRE_POWER_OFF_DELAY(%d) POST_POWER_OFF_DELAY(%d)",
             (char*)userial_dev, port, uart_port, nfc_wake_delay, nfc_write_delay, gPowerOnDelay, gPrePowerOffDelay,
             gPostPowerOffDelay);
+    ALOGI("USERIAL_Open() WRITE_PACING(%d) WRITE_GAP_MIN(%d us) WRITE_GAP_MAX(%d us)",
+            nfc_write_pacing, nfc_write_gap_min, nfc_write_gap_max);
+
+    /* until measured, assume NFCC takes the longest gap to respond */
+    pthread_mutex_lock(&write_pacing_mutex);
+    linux_cb.rsp_time     = nfc_write_gap_max;
+    linux_cb.backoff      = 0;
+    linux_cb.w4_rx        = FALSE;
+    linux_cb.num_writes   = 0;
+    linux_cb.num_overruns = 0;
+    linux_cb.wait_time    = 0;
+    pthread_mutex_unlock(&write_pacing_mutex);
 
     strcpy((char*)device_name, (char*)userial_dev);
     sRxLength = 0;
-    _poll_t0 = 0;
 
     if ((strncmp(userial_dev, ttyusb, sizeof(ttyusb)-1) == 0) ||
         (strncmp(userial_dev, devtty, sizeof(devtty)-1) == 0) )
@@ -1204,7 +1349,18 @@ UDRV_API UINT16  USERIAL_Read(tUSERIAL_PORT port, UINT8 *p_data, UINT16 len)
 
 UDRV_API void    USERIAL_ReadBuf(tUSERIAL_PORT port, BT_HDR **p_buf)
 {
+    /* what USERIAL_Read left of a buffer comes first */
+    if (pbuf_USERIAL_Read != NULL)
+    {
+        *p_buf = pbuf_USERIAL_Read;
+        pbuf_USERIAL_Read = NULL;
+    }
+    else
+        *p_buf = (BT_HDR *)GKI_dequeue(&Userial_in_q);
 
+#if (defined USERIAL_DEBUG) && (USERIAL_DEBUG == TRUE)
+    ALOGD( "%s: returned %p", __func__, *p_buf);
+#endif
 }
 
 /*******************************************************************************
@@ -1245,19 +1401,34 @@ UDRV_API UINT16  USERIAL_Write(tUSERIAL_PORT port, UINT8 *p_data, UINT16 len)
 {
     int ret = 0, total = 0;
     int i = 0;
-    clock_t t;
+    int retry = 0;
+    int backoff;
+    UINT32 t;
 
     ALOGD_IF((appl_trace_level>=BT_TRACE_LEVEL_DEBUG), "USERIAL_Write: (%d bytes)", len);
     pthread_mutex_lock(&close_thread_mutex);
 
     doWriteDelay();
-    t = clock();
+    t = nfcMetricsNow();
     while (len != 0 && linux_cb.sock != -1)
     {
         ret = TEMP_FAILURE_RETRY(write(linux_cb.sock, p_data + total, len));
         if (ret < 0)
         {
             ALOGE("USERIAL_Write len = %d, ret = %d, errno = %d", len, ret, errno);
+
+            /* NFCC did not take the data (I2C NAK, buffer full): back off and retry.
+             * EIO is not retried, NFCC may have got the data and would get it twice */
+            if (  (nfc_write_pacing != USERIAL_PACING_FIXED)
+                &&(retry++ < USERIAL_WRITE_RETRY_MAX)
+                &&((errno == EAGAIN) || (errno == ENXIO) || (errno == EREMOTEIO))  )
+            {
+                backoff = setWriteOverrun();
+                ALOGW("USERIAL_Write retry %d after %d us", retry, backoff);
+                usleep(backoff);
+                addWaitTime(backoff);
+                continue;
+            }
             break;
         }
         else
@@ -1267,11 +1438,25 @@ UDRV_API UINT16  USERIAL_Write(tUSERIAL_PORT port, UINT8 *p_data, UINT16 len)
 
         total += ret;
         len -= ret;
+
+        /* NFCC took part of the data: back off before writing the rest */
+        if ((len != 0) && (nfc_write_pacing != USERIAL_PACING_FIXED))
+        {
+            backoff = setWriteOverrun();
+            usleep(backoff);
+            addWaitTime(backoff);
+        }
     }
-    perf_update(&perf_write, clock() - t, total);
+    userial_metrics_update(NFC_METRIC_USERIAL_WRITE, t, total);
+    pthread_mutex_lock(&write_pacing_mutex);
+    linux_cb.num_writes++;
+    pthread_mutex_unlock(&write_pacing_mutex);
 
     /* register a delay for next write */
-    setWriteDelay(total * nfc_write_delay / 1000);
+    if (nfc_write_pacing == USERIAL_PACING_FIXED)
+        setWriteDelay(total * nfc_write_delay / 1000);
+    else
+        setWriteGap(total);
 
     pthread_mutex_unlock(&close_thread_mutex);
 
@@ -1442,6 +1627,11 @@ UDRV_API void    USERIAL_Close(tUSERIAL_PORT port)
     UINT32         delay = 100;
 
     ALOGD ("%s: enter; gPowerOffMode=%d", __FUNCTION__, gPowerOffMode);
+    pthread_mutex_lock(&write_pacing_mutex);
+    ALOGD ("%s: %lu writes, %lu overruns, waited %lu us, response time %d us", __FUNCTION__,
+            (unsigned long) linux_cb.num_writes, (unsigned long) linux_cb.num_overruns,
+            (unsigned long) linux_cb.wait_time, linux_cb.rsp_time);
+    pthread_mutex_unlock(&write_pacing_mutex);
 
     /* Do we need to put NFCC into certain mode before switching off?... */
     if (gPowerOffMode != POM_NORMAL)
@@ -1637,7 +1827,7 @@ UDRV_API void UPIO_Set(tUPIO_TYPE type, tUPIO pio, tUPIO_STATE new_state)
                     if (isWake(new_state) && nfc_wake_delay > 0 && new_state != current_nfc_wake_state)
                     {
                         ALOGD("%s: ioctl, old state=%d, insert delay for %d ms", __func__, current_nfc_wake_state, nfc_wake_delay);
-                        setWriteDelay(nfc_wake_delay);
+                        setWakeDelay(nfc_wake_delay);
                     }
                     current_nfc_wake_state = new_state;
                 }
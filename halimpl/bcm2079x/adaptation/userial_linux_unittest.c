@@ -0,0 +1,311 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2015 Broadcom Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  Host test of the userial write pacing against a simulated NFCC.
+ *
+ *  userial_linux.c is built into this file with write() replaced by a
+ *  simulated NFCC. The NFCC takes sim_proc_us to process each write, refuses
+ *  writes while busy with sim_errno, and answers each write by calling
+ *  setReadDone() as the read thread would.
+ *
+ *  Checks:
+ *  - fixed pacing keeps the 5 ms gap between back-to-back writes. The gap
+ *    is waited in whole ms, rounded down, so at least 4 ms is measured
+ *  - adaptive pacing is faster than fixed pacing and loses no write
+ *  - a write refused with EREMOTEIO (I2C NAK) is retried
+ *  - a write failed with EIO is not retried, so NFCC never gets it twice
+ *
+ ******************************************************************************/
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/ioctl.h>
+
+#ifndef TEMP_FAILURE_RETRY
+#define TEMP_FAILURE_RETRY(exp) (exp)
+#endif
+
+static ssize_t sim_write (int fd, const void *p_buf, size_t len);
+
+#define write(fd, p_buf, len)  sim_write (fd, p_buf, len)
+#include "userial_linux.c"
+#undef write
+
+/* Simulated NFCC */
+static long             sim_proc_us = 700;      /* time to process a write */
+static int              sim_errno = EREMOTEIO;  /* error when a write is refused */
+static struct timespec  sim_busy_until;
+static pthread_mutex_t  sim_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   sim_cond = PTHREAD_COND_INITIALIZER;
+static int              sim_pending;            /* writes not yet answered */
+static int              sim_rsp;                /* writes answered */
+static int              sim_writes;             /* writes taken */
+static int              sim_refused;            /* writes refused */
+
+static int              test_failures;
+
+/* 5 ms gap of fixed pacing, rounded down to the ms by doWriteDelay */
+#define TEST_FIXED_GAP_MIN  4000
+
+/* stubs of the symbols userial_linux.c needs from the rest of the HAL */
+UINT8  appl_trace_level;
+UINT32 ScrProtocolTraceFlag;
+void  GKI_delay (UINT32 timeout) { usleep (timeout * 1000); }
+UINT8 GKI_create_task (TASKPTR task_entry, UINT8 task_id, INT8 *taskname, UINT16 *stack, UINT16 stacksize, void *pCondVar, void *pMutex) { return GKI_SUCCESS; }
+void  GKI_exit_task (UINT8 task_id) {}
+UINT8 GKI_get_taskid (void) { return 0; }
+UINT8 GKI_send_event (UINT8 task_id, UINT16 event) { return GKI_SUCCESS; }
+void  GKI_freebuf (void *p_buf) {}
+void *GKI_getpoolbuf (UINT8 pool_id) { return NULL; }
+void *GKI_dequeue (BUFFER_Q *p_q) { return NULL; }
+void  GKI_enqueue (BUFFER_Q *p_q, void *p_buf) {}
+void  GKI_init_q (BUFFER_Q *p_q) {}
+int   GetStrValue (const char *name, char *p_value, unsigned long len) { return 0; }
+int   GetNumValue (const char *name, void *p_value, unsigned long len) { return 0; }
+
+#define TEST_CHECK(cond) \
+    do { if (!(cond)) { printf ("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); test_failures++; } } while (0)
+
+/*******************************************************************************
+**
+** Function         sim_write
+**
+** Description      write() of the simulated NFCC
+**
+*******************************************************************************/
+static ssize_t sim_write (int fd, const void *p_buf, size_t len)
+{
+    struct timespec now;
+
+    clock_gettime (CLOCK_MONOTONIC, &now);
+    pthread_mutex_lock (&sim_mutex);
+    if (timeUntil (&now, &sim_busy_until) > 0)
+    {
+        sim_refused++;
+        pthread_mutex_unlock (&sim_mutex);
+        errno = sim_errno;
+        return -1;
+    }
+    sim_busy_until = now;
+    addTime (&sim_busy_until, sim_proc_us);
+    sim_writes++;
+    sim_pending++;
+    pthread_cond_broadcast (&sim_cond);
+    pthread_mutex_unlock (&sim_mutex);
+
+    return len;
+}
+
+/*******************************************************************************
+**
+** Function         sim_responder
+**
+** Description      Answer each write once NFCC has processed it
+**
+*******************************************************************************/
+static void *sim_responder (void *p_arg)
+{
+    struct timespec now, until;
+    long            delay;
+
+    for (;;)
+    {
+        pthread_mutex_lock (&sim_mutex);
+        while (sim_pending == 0)
+            pthread_cond_wait (&sim_cond, &sim_mutex);
+        sim_pending--;
+        until = sim_busy_until;
+        pthread_mutex_unlock (&sim_mutex);
+
+        clock_gettime (CLOCK_MONOTONIC, &now);
+        delay = timeUntil (&now, &until);
+        if (delay > 0)
+            usleep (delay);
+        setReadDone ();
+
+        pthread_mutex_lock (&sim_mutex);
+        sim_rsp++;
+        pthread_cond_broadcast (&sim_cond);
+        pthread_mutex_unlock (&sim_mutex);
+    }
+    return NULL;
+}
+
+/*******************************************************************************
+**
+** Function         test_now_us
+**
+*******************************************************************************/
+static long test_now_us (void)
+{
+    struct timespec now;
+
+    clock_gettime (CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000L + now.tv_nsec / 1000;
+}
+
+/*******************************************************************************
+**
+** Function         test_reset
+**
+** Description      Reset userial and the simulated NFCC before a run
+**
+*******************************************************************************/
+static void test_reset (int pacing)
+{
+    usleep (20000);
+    nfc_write_pacing = pacing;
+    nfc_write_delay  = 0;
+    memset (&linux_cb, 0, sizeof (linux_cb));
+    linux_cb.sock     = 3;
+    linux_cb.rsp_time = nfc_write_gap_max;
+
+    pthread_mutex_lock (&sim_mutex);
+    sim_rsp = sim_writes = sim_refused = sim_pending = 0;
+    pthread_mutex_unlock (&sim_mutex);
+}
+
+/*******************************************************************************
+**
+** Function         test_exchanges
+**
+** Description      Send num commands, waiting for the answer to each one
+**
+** Returns          average time of an exchange (us)
+**
+*******************************************************************************/
+static long test_exchanges (int pacing, int num)
+{
+    UINT8   cmd[12] = {0};
+    long    start;
+    int     xx;
+
+    test_reset (pacing);
+    start = test_now_us ();
+    for (xx = 0; xx < num; xx++)
+    {
+        TEST_CHECK (USERIAL_Write (0, cmd, sizeof (cmd)) == sizeof (cmd));
+
+        pthread_mutex_lock (&sim_mutex);
+        while (sim_rsp <= xx)
+            pthread_cond_wait (&sim_cond, &sim_mutex);
+        pthread_mutex_unlock (&sim_mutex);
+    }
+    return (test_now_us () - start) / num;
+}
+
+/*******************************************************************************
+**
+** Function         test_burst
+**
+** Description      Send num commands back to back
+**
+** Returns          average time between writes (us)
+**
+*******************************************************************************/
+static long test_burst (int pacing, int num)
+{
+    UINT8   cmd[12] = {0};
+    long    start;
+    int     xx;
+
+    test_reset (pacing);
+    TEST_CHECK (USERIAL_Write (0, cmd, sizeof (cmd)) == sizeof (cmd));
+
+    /* time the gaps after the first write */
+    start = test_now_us ();
+    for (xx = 1; xx < num; xx++)
+    {
+        TEST_CHECK (USERIAL_Write (0, cmd, sizeof (cmd)) == sizeof (cmd));
+    }
+    TEST_CHECK (sim_writes == num);
+    return (test_now_us () - start) / (num - 1);
+}
+
+/*******************************************************************************
+**
+** Function         test_refused_write
+**
+** Description      A write refused with err is retried only if NFCC cannot
+**                  have got it
+**
+*******************************************************************************/
+static void test_refused_write (int err, BOOLEAN b_retried)
+{
+    UINT8   cmd[12] = {0};
+
+    test_reset (USERIAL_PACING_ADAPTIVE);
+    sim_errno = err;
+
+    /* NFCC is busy for longer than the first backoff */
+    clock_gettime (CLOCK_MONOTONIC, &sim_busy_until);
+    addTime (&sim_busy_until, nfc_write_gap_min * 2);
+
+    if (b_retried)
+    {
+        TEST_CHECK (USERIAL_Write (0, cmd, sizeof (cmd)) == sizeof (cmd));
+        TEST_CHECK (sim_refused > 0);
+    }
+    else
+    {
+        TEST_CHECK (USERIAL_Write (0, cmd, sizeof (cmd)) == 0);
+        TEST_CHECK (sim_refused == 1);
+    }
+    TEST_CHECK (sim_writes == (b_retried ? 1 : 0));
+    sim_errno = EREMOTEIO;
+}
+
+int main (void)
+{
+    pthread_t   responder;
+    long        fixed, adaptive;
+
+    pthread_create (&responder, NULL, sim_responder, NULL);
+
+    /* the default keeps the fixed 5 ms gap */
+    TEST_CHECK (nfc_write_pacing == USERIAL_PACING_FIXED);
+
+    fixed    = test_exchanges (USERIAL_PACING_FIXED, 100);
+    adaptive = test_exchanges (USERIAL_PACING_ADAPTIVE, 100);
+    printf ("NFCC %ld us, cmd/rsp exchange: fixed %ld us, adaptive %ld us\n", sim_proc_us, fixed, adaptive);
+    TEST_CHECK (fixed >= TEST_FIXED_GAP_MIN);
+    TEST_CHECK (adaptive < fixed);
+
+    fixed    = test_burst (USERIAL_PACING_FIXED, 50);
+    adaptive = test_burst (USERIAL_PACING_ADAPTIVE, 50);
+    printf ("NFCC %ld us, back-to-back writes: fixed %ld us, adaptive %ld us, %d refused\n",
+            sim_proc_us, fixed, adaptive, sim_refused);
+    TEST_CHECK (fixed >= TEST_FIXED_GAP_MIN);
+    TEST_CHECK (adaptive < fixed);
+
+    sim_proc_us = 3000;
+    fixed    = test_exchanges (USERIAL_PACING_FIXED, 50);
+    adaptive = test_exchanges (USERIAL_PACING_ADAPTIVE, 50);
+    printf ("NFCC %ld us, cmd/rsp exchange: fixed %ld us, adaptive %ld us\n", sim_proc_us, fixed, adaptive);
+    TEST_CHECK (adaptive < fixed);
+    sim_proc_us = 700;
+
+    test_refused_write (EREMOTEIO, TRUE);
+    test_refused_write (EIO, FALSE);
+
+    printf ("%s\n", test_failures ? "FAILED" : "PASSED");
+    return test_failures ? 1 : 0;
+}
@@ -27,6 +27,7 @@
 #include "nfc_hal_post_reset.h"
 #include "userial.h"
 #include "upio.h"
+#include "NfcMetrics.h"
 
 /*****************************************************************************
 ** Constants and types
@@ -37,6 +38,9 @@
 #define NFC_HAL_I93_AFI                     (0)
 #define NFC_HAL_I93_ENABLE_SMART_POLL       (1)
 
+/* Most parameter TLVs in one CORE_SET_CONFIG_CMD (payload length is 8 bits) */
+#define NFC_HAL_DM_MAX_CONFIG_TLV_SIZE      (255 - 1)
+
 static UINT8 nfc_hal_dm_i93_rw_cfg[NFC_HAL_I93_RW_CFG_LEN] =
 {
     NCI_PARAM_ID_I93_DATARATE,
@@ -197,8 +201,32 @@ void nfc_hal_dm_set_fw_fsm (BOOLEAN enable, tNFC_HAL_NCI_CBACK *p_cback)
 *******************************************************************************/
 void nfc_hal_dm_config_nfcc_cback (tNFC_HAL_NCI_EVT event, UINT16 data_len, UINT8 *p_data)
 {
+    UINT8 status = NCI_STATUS_OK;
+
+    /* Time the step(s) just completed and note if NFCC does not support them */
+    if (nfc_hal_cb.dev_cb.startup_step_time)
+    {
+        if ((p_data) && (data_len > NCI_MSG_HDR_SIZE))
+            status = p_data[NCI_MSG_HDR_SIZE];
+
+        HAL_TRACE_DEBUG3 ("nfc_hal_dm_config_nfcc_cback (): steps 0x%08x, status 0x%02x, %u us",
+                          nfc_hal_cb.dev_cb.startup_sent_mask, status,
+                          nfcMetricsNow () - nfc_hal_cb.dev_cb.startup_step_time);
+
+        if (  (status == NCI_STATUS_SYNTAX_ERROR)
+            ||(status == NCI_STATUS_UNKNOWN_GID)
+            ||(status == NCI_STATUS_UNKNOWN_OID)
+            ||(status == NCI_STATUS_INVALID_PARAM)  )
+        {
+            nfc_hal_cb.dev_cb.startup_rej_mask |= (nfc_hal_cb.dev_cb.startup_sent_mask & NFC_HAL_DM_STARTUP_SKIPPABLE);
+        }
+        nfc_hal_cb.dev_cb.startup_step_time = 0;
+        nfc_hal_cb.dev_cb.startup_sent_mask = 0;
+    }
+
     if (nfc_hal_cb.dev_cb.next_dm_config == NFC_HAL_DM_CONFIG_NONE)
     {
+        nfc_hal_post_init_result (nfc_hal_cb.dev_cb.startup_rej_mask);
         nfc_hal_hci_enable ();
     }
     else
@@ -207,6 +235,42 @@ void nfc_hal_dm_config_nfcc_cback (tNFC_HAL_NCI_EVT event, UINT16 data_len, UINT
     }
 }
 
+/*******************************************************************************
+**
+** Function         nfc_hal_dm_start_step
+**
+** Description      Note the post initialization step(s) about to be sent
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfc_hal_dm_start_step (UINT32 step_mask)
+{
+    nfc_hal_cb.dev_cb.startup_sent_mask = step_mask;
+    nfc_hal_cb.dev_cb.startup_step_time = nfcMetricsNow () | 1;
+}
+
+/*******************************************************************************
+**
+** Function         nfc_hal_dm_skip_step
+**
+** Description      Check if a post initialization step is known to be
+**                  rejected by NFCC. A skipped step stays in the rejected mask.
+**
+** Returns          TRUE if the step is to be skipped
+**
+*******************************************************************************/
+static BOOLEAN nfc_hal_dm_skip_step (UINT32 step)
+{
+    if (step & nfc_hal_cb.dev_cb.startup_skip_mask & NFC_HAL_DM_STARTUP_SKIPPABLE)
+    {
+        HAL_TRACE_DEBUG1 ("nfc_hal_dm_skip_step (): skip step 0x%08x", step);
+        nfc_hal_cb.dev_cb.startup_rej_mask |= step;
+        return TRUE;
+    }
+    return FALSE;
+}
+
 /*******************************************************************************
 **
 ** Function         nfc_hal_dm_send_startup_vsc
@@ -220,28 +284,42 @@ void nfc_hal_dm_send_startup_vsc (void)
 {
     UINT8  *p, *p_end;
     UINT16 len;
+    UINT32 step;
 
     HAL_TRACE_DEBUG0 ("nfc_hal_dm_send_startup_vsc ()");
 
     /* VSC must have NCI header at least */
-    if (nfc_hal_cb.dev_cb.next_startup_vsc + NCI_MSG_HDR_SIZE - 1 <= *p_nfc_hal_dm_start_up_vsc_cfg)
+    while (nfc_hal_cb.dev_cb.next_startup_vsc + NCI_MSG_HDR_SIZE - 1 <= *p_nfc_hal_dm_start_up_vsc_cfg)
     {
         p     = p_nfc_hal_dm_start_up_vsc_cfg + nfc_hal_cb.dev_cb.next_startup_vsc;
         len   = *(p + 2);
         p_end = p + NCI_MSG_HDR_SIZE - 1 + len;
 
-        if (p_end <= p_nfc_hal_dm_start_up_vsc_cfg + *p_nfc_hal_dm_start_up_vsc_cfg)
-        {
-            /* move to next VSC */
-            nfc_hal_cb.dev_cb.next_startup_vsc += NCI_MSG_HDR_SIZE + len;
+        if (p_end > p_nfc_hal_dm_start_up_vsc_cfg + *p_nfc_hal_dm_start_up_vsc_cfg)
+            break;
 
-            /* if this is last VSC */
-            if (p_end == p_nfc_hal_dm_start_up_vsc_cfg + *p_nfc_hal_dm_start_up_vsc_cfg)
-                nfc_hal_cb.dev_cb.next_dm_config = NFC_HAL_DM_CONFIG_NONE;
+        /* move to next VSC */
+        nfc_hal_cb.dev_cb.next_startup_vsc += NCI_MSG_HDR_SIZE + len;
+        step = NFC_HAL_DM_STARTUP_VSC_STEP (nfc_hal_cb.dev_cb.startup_vsc_idx);
+        nfc_hal_cb.dev_cb.startup_vsc_idx++;
 
-            nfc_hal_dm_send_nci_cmd (p, (UINT16)(NCI_MSG_HDR_SIZE + len), nfc_hal_dm_config_nfcc_cback);
-            return;
+        /* if this is last VSC */
+        if (p_end == p_nfc_hal_dm_start_up_vsc_cfg + *p_nfc_hal_dm_start_up_vsc_cfg)
+            nfc_hal_cb.dev_cb.next_dm_config = NFC_HAL_DM_CONFIG_NONE;
+
+        if (nfc_hal_dm_skip_step (step))
+        {
+            if (nfc_hal_cb.dev_cb.next_dm_config == NFC_HAL_DM_CONFIG_NONE)
+            {
+                nfc_hal_dm_config_nfcc_cback (0, 0, NULL);
+                return;
+            }
+            continue;
         }
+
+        nfc_hal_dm_start_step (step);
+        nfc_hal_dm_send_nci_cmd (p, (UINT16)(NCI_MSG_HDR_SIZE + len), nfc_hal_dm_config_nfcc_cback);
+        return;
     }
 
     HAL_TRACE_ERROR0 ("nfc_hal_dm_send_startup_vsc (): Bad start-up VSC");
@@ -252,95 +330,140 @@ void nfc_hal_dm_send_startup_vsc (void)
 
 /*******************************************************************************
 **
-** Function         nfc_hal_dm_config_nfcc
+** Function         nfc_hal_dm_get_config_tlvs
 **
-** Description      Send VS config before NFA start-up
+** Description      Get the parameters set by a set config item of post
+**                  initialization
 **
-** Returns          void
+** Returns          length of parameter TLVs, 0 if the item is not configured
 **
 *******************************************************************************/
-void nfc_hal_dm_config_nfcc (void)
+static UINT8 nfc_hal_dm_get_config_tlvs (tNFC_HAL_DM_CONFIG config, UINT8 **pp_tlvs)
 {
-    HAL_TRACE_DEBUG1 ("nfc_hal_dm_config_nfcc (): next_dm_config = %d", nfc_hal_cb.dev_cb.next_dm_config);
-
-    if ((p_nfc_hal_dm_lptd_cfg[0]) && (nfc_hal_cb.dev_cb.next_dm_config <= NFC_HAL_DM_CONFIG_LPTD))
+    switch (config)
     {
-        nfc_hal_cb.dev_cb.next_dm_config = NFC_HAL_DM_CONFIG_PLL_325;
+    case NFC_HAL_DM_CONFIG_LPTD:
+        *pp_tlvs = &p_nfc_hal_dm_lptd_cfg[1];
+        return p_nfc_hal_dm_lptd_cfg[0];
 
-        if (nfc_hal_dm_set_config (p_nfc_hal_dm_lptd_cfg[0],
-                                   &p_nfc_hal_dm_lptd_cfg[1],
-                                   nfc_hal_dm_config_nfcc_cback) == HAL_NFC_STATUS_OK)
-        {
-            return;
-        }
-        else
-        {
-            NFC_HAL_SET_INIT_STATE (NFC_HAL_INIT_STATE_IDLE);
-            nfc_hal_cb.p_stack_cback (HAL_NFC_POST_INIT_CPLT_EVT, HAL_NFC_STATUS_FAILED);
-            return;
-        }
+    case NFC_HAL_DM_CONFIG_PLL_325:
+        *pp_tlvs = p_nfc_hal_dm_pll_325_cfg;
+        return (p_nfc_hal_dm_pll_325_cfg ? NFC_HAL_PLL_325_SETCONFIG_PARAM_LEN : 0);
+
+    case NFC_HAL_DM_CONFIG_START_UP:
+        *pp_tlvs = &p_nfc_hal_dm_start_up_cfg[1];
+        return p_nfc_hal_dm_start_up_cfg[0];
+
+#if (NFC_HAL_I93_FLAG_DATA_RATE == NFC_HAL_I93_FLAG_DATA_RATE_HIGH)
+    case NFC_HAL_DM_CONFIG_I93_DATA_RATE:
+        *pp_tlvs = nfc_hal_dm_i93_rw_cfg;
+        return NFC_HAL_I93_RW_CFG_LEN;
+#endif
+
+    default:
+        return 0;
     }
+}
 
-    if ((p_nfc_hal_dm_pll_325_cfg) && (nfc_hal_cb.dev_cb.next_dm_config <= NFC_HAL_DM_CONFIG_PLL_325))
-    {
-        nfc_hal_cb.dev_cb.next_dm_config = NFC_HAL_DM_CONFIG_START_UP;
+/*******************************************************************************
+**
+** Function         nfc_hal_dm_tlvs_overlap
+**
+** Description      Check if two lists of parameter TLVs set the same parameter
+**
+** Returns          TRUE if a parameter is in both lists
+**
+*******************************************************************************/
+static BOOLEAN nfc_hal_dm_tlvs_overlap (UINT8 *p_tlvs1, UINT8 size1, UINT8 *p_tlvs2, UINT8 size2)
+{
+    UINT8 *p1, *p2;
 
-        if (nfc_hal_dm_set_config (NFC_HAL_PLL_325_SETCONFIG_PARAM_LEN,
-                                   p_nfc_hal_dm_pll_325_cfg,
-                                   nfc_hal_dm_config_nfcc_cback) == HAL_NFC_STATUS_OK)
-        {
-            return;
-        }
-        else
+    for (p1 = p_tlvs1; p1 + 1 < p_tlvs1 + size1; p1 += 2 + p1[1])
+    {
+        for (p2 = p_tlvs2; p2 + 1 < p_tlvs2 + size2; p2 += 2 + p2[1])
         {
-            NFC_HAL_SET_INIT_STATE (NFC_HAL_INIT_STATE_IDLE);
-            nfc_hal_cb.p_stack_cback (HAL_NFC_POST_INIT_CPLT_EVT, HAL_NFC_STATUS_FAILED);
-            return;
+            if (*p1 == *p2)
+                return TRUE;
         }
     }
+    return FALSE;
+}
+
+/*******************************************************************************
+**
+** Function         nfc_hal_dm_config_nfcc
+**
+** Description      Send VS config before NFA start-up
+**
+**                  The set config items have no order between them unless
+**                  they set the same parameter, so as many as fit are sent in
+**                  one CORE_SET_CONFIG_CMD; NCI allows only one command at a
+**                  time. FW FSM and start-up VSCs are sent one by one, in
+**                  order, after them. Those NFCC rejected on the previous
+**                  start-up are skipped (see HAL_NfcSetStartupSkipMask).
+**
+** Returns          void
+**
+*******************************************************************************/
+void nfc_hal_dm_config_nfcc (void)
+{
+    UINT8  tlvs[NFC_HAL_DM_MAX_CONFIG_TLV_SIZE], *p_tlvs, *p_first = NULL;
+    UINT8  len, tlv_size = 0;
+    UINT32 steps = 0;
 
-    if ((p_nfc_hal_dm_start_up_cfg[0]) && (nfc_hal_cb.dev_cb.next_dm_config <= NFC_HAL_DM_CONFIG_START_UP))
+    HAL_TRACE_DEBUG1 ("nfc_hal_dm_config_nfcc (): next_dm_config = %d", nfc_hal_cb.dev_cb.next_dm_config);
+
+    while (nfc_hal_cb.dev_cb.next_dm_config < NFC_HAL_DM_CONFIG_FW_FSM)
     {
-        nfc_hal_cb.dev_cb.next_dm_config = NFC_HAL_DM_CONFIG_I93_DATA_RATE;
-        if (nfc_hal_dm_set_config (p_nfc_hal_dm_start_up_cfg[0],
-                                   &p_nfc_hal_dm_start_up_cfg[1],
-                                   nfc_hal_dm_config_nfcc_cback) == HAL_NFC_STATUS_OK)
+        if ((len = nfc_hal_dm_get_config_tlvs (nfc_hal_cb.dev_cb.next_dm_config, &p_tlvs)) != 0)
         {
-            return;
-        }
-        else
-        {
-            NFC_HAL_SET_INIT_STATE (NFC_HAL_INIT_STATE_IDLE);
-            nfc_hal_cb.p_stack_cback (HAL_NFC_POST_INIT_CPLT_EVT, HAL_NFC_STATUS_FAILED);
-            return;
+            if (p_first == NULL)
+            {
+                /* first item is sent even if it is too big to add another one */
+                p_first  = p_tlvs;
+                tlv_size = len;
+            }
+            else if (  (tlv_size + len > NFC_HAL_DM_MAX_CONFIG_TLV_SIZE)
+                     ||(nfc_hal_dm_tlvs_overlap ((p_first != tlvs) ? p_first : tlvs, tlv_size, p_tlvs, len))  )
+            {
+                break;
+            }
+            else
+            {
+                if (p_first != tlvs)
+                {
+                    memcpy (tlvs, p_first, tlv_size);
+                    p_first = tlvs;
+                }
+                memcpy (tlvs + tlv_size, p_tlvs, len);
+                tlv_size += len;
+            }
+            steps |= NFC_HAL_DM_STARTUP_STEP (nfc_hal_cb.dev_cb.next_dm_config);
         }
+        nfc_hal_cb.dev_cb.next_dm_config++;
     }
 
-#if (NFC_HAL_I93_FLAG_DATA_RATE == NFC_HAL_I93_FLAG_DATA_RATE_HIGH)
-    if (nfc_hal_cb.dev_cb.next_dm_config  <= NFC_HAL_DM_CONFIG_I93_DATA_RATE)
+    if (tlv_size)
     {
-        nfc_hal_cb.dev_cb.next_dm_config = NFC_HAL_DM_CONFIG_FW_FSM;
-        if (nfc_hal_dm_set_config (NFC_HAL_I93_RW_CFG_LEN,
-                                   nfc_hal_dm_i93_rw_cfg,
-                                   nfc_hal_dm_config_nfcc_cback) == HAL_NFC_STATUS_OK)
-        {
-            return;
-        }
-        else
+        nfc_hal_dm_start_step (steps);
+        if (nfc_hal_dm_set_config (tlv_size, p_first, nfc_hal_dm_config_nfcc_cback) != HAL_NFC_STATUS_OK)
         {
             NFC_HAL_SET_INIT_STATE (NFC_HAL_INIT_STATE_IDLE);
             nfc_hal_cb.p_stack_cback (HAL_NFC_POST_INIT_CPLT_EVT, HAL_NFC_STATUS_FAILED);
-            return;
         }
+        return;
     }
-#endif
 
     /* FW FSM is disabled as default in NFCC */
     if (nfc_hal_cb.dev_cb.next_dm_config <= NFC_HAL_DM_CONFIG_FW_FSM)
     {
         nfc_hal_cb.dev_cb.next_dm_config = NFC_HAL_DM_CONFIG_START_UP_VSC;
-        nfc_hal_dm_set_fw_fsm (NFC_HAL_DM_MULTI_TECH_RESP, nfc_hal_dm_config_nfcc_cback);
-        return;
+        if (!nfc_hal_dm_skip_step (NFC_HAL_DM_STARTUP_STEP (NFC_HAL_DM_CONFIG_FW_FSM)))
+        {
+            nfc_hal_dm_start_step (NFC_HAL_DM_STARTUP_STEP (NFC_HAL_DM_CONFIG_FW_FSM));
+            nfc_hal_dm_set_fw_fsm (NFC_HAL_DM_MULTI_TECH_RESP, nfc_hal_dm_config_nfcc_cback);
+            return;
+        }
     }
 
     if (nfc_hal_cb.dev_cb.next_dm_config <= NFC_HAL_DM_CONFIG_START_UP_VSC)
@@ -1229,6 +1352,30 @@ void nfc_hal_dm_init (void)
 
 }
 
+/*******************************************************************************
+**
+** Function         nfc_hal_dm_set_init_state
+**
+** Description      Set the state of initializing NFCC, and trace how long the
+**                  previous state lasted to profile start up
+**
+** Returns          void
+**
+*******************************************************************************/
+void nfc_hal_dm_set_init_state (tNFC_HAL_INIT_STATE state)
+{
+    UINT32 now = nfcMetricsNow ();
+
+#if (NFC_HAL_DEBUG == TRUE)
+    HAL_TRACE_DEBUG4 ("init state: %d->%d(%s) after %u us",
+                      nfc_hal_cb.dev_cb.initializing_state, state, nfc_hal_init_state_str[state],
+                      now - nfc_hal_cb.dev_cb.init_state_time);
+#endif
+
+    nfc_hal_cb.dev_cb.initializing_state = state;
+    nfc_hal_cb.dev_cb.init_state_time    = now;
+}
+
 /*******************************************************************************
 **
 ** Function         HAL_NfcDevInitDone
@@ -1284,6 +1431,24 @@ tHAL_NFC_STATUS HAL_NfcReInit (void)
     return status;
 }
 
+/*******************************************************************************
+**
+** Function         HAL_NfcSetStartupSkipMask
+**
+** Description      Set the post initialization steps to skip, because NFCC
+**                  rejected them before with the same chip, patch and
+**                  configuration.
+**
+** Returns          none
+**
+*******************************************************************************/
+void HAL_NfcSetStartupSkipMask (UINT32 skip_mask)
+{
+    HAL_TRACE_DEBUG1 ("HAL_NfcSetStartupSkipMask () 0x%08x", skip_mask);
+
+    nfc_hal_cb.dev_cb.startup_skip_mask = skip_mask;
+}
+
 /*******************************************************************************
 **
 ** Function         nfc_hal_dm_set_snooze_mode_cback
@@ -66,6 +66,7 @@ const char * const nfc_hal_init_state_str[] =
     "W4_POST_INIT",     /* Waiting for complete of post init     */
     "W4_CONTROL",       /* Waiting for control release           */
     "W4_PREDISC",       /* Waiting for complete of prediscover   */
+    "W4_NFCC_OFF",      /* Waiting for NFCC to turn OFF          */
     "CLOSING"           /* Shutting down                         */
 };
 #endif
@@ -85,6 +86,7 @@ void nfc_hal_main_init (void)
     memset (&nfc_hal_cb, 0, sizeof (tNFC_HAL_CB));
 
     nfc_hal_cb.ncit_cb.nci_ctrl_size   = NFC_HAL_NCI_INIT_CTRL_PAYLOAD_SIZE;
+    nfc_hal_cb.prm_spd_window          = NFC_HAL_PRM_SPD_WINDOW;
     nfc_hal_cb.trace_level             = NFC_HAL_INITIAL_TRACE_LEVEL;
     nfc_hal_cb.timer.p_cback           = nfc_hal_main_timeout_cback;
 }
@@ -626,7 +628,9 @@ static void nfc_hal_main_send_message (NFC_HDR *p_msg)
 UINT32 nfc_hal_main_task (UINT32 param)
 {
     UINT16   event;
-    UINT8    byte;
+    UINT16   used;
+    BOOLEAN  msg_received;
+    BT_HDR   *p_span;
     UINT8    num_interfaces;
     UINT8    *p;
     NFC_HDR  *p_msg;
@@ -699,6 +703,8 @@ UINT32 nfc_hal_main_task (UINT32 param)
                     /* start post initialization */
                     nfc_hal_cb.dev_cb.next_dm_config = NFC_HAL_DM_CONFIG_LPTD;
                     nfc_hal_cb.dev_cb.next_startup_vsc = 1;
+                    nfc_hal_cb.dev_cb.startup_vsc_idx  = 0;
+                    nfc_hal_cb.dev_cb.startup_rej_mask = 0;
 
                     nfc_hal_dm_config_nfcc ();
                     break;
@@ -734,31 +740,41 @@ UINT32 nfc_hal_main_task (UINT32 param)
         {
             while (TRUE)
             {
-                /* Read one byte to see if there is anything waiting to be read */
-                if (USERIAL_Read (USERIAL_NFC_PORT, &byte, 1) == 0)
+                /* Take all data the serial port has received so far */
+                USERIAL_ReadBuf (USERIAL_NFC_PORT, &p_span);
+                if (p_span == NULL)
                 {
                     break;
                 }
 
-                if (nfc_hal_nci_receive_msg (byte))
+                while (p_span->len > 0)
                 {
-                    /* complete of receiving NCI message */
-                    nfc_hal_nci_assemble_nci_msg ();
-                    if (nfc_hal_cb.ncit_cb.p_rcv_msg)
+                    used = nfc_hal_nci_receive_span ((UINT8 *) (p_span + 1) + p_span->offset,
+                                                     p_span->len, &msg_received);
+                    p_span->offset += used;
+                    p_span->len    -= used;
+
+                    if (msg_received)
                     {
-                        if (nfc_hal_nci_preproc_rx_nci_msg (nfc_hal_cb.ncit_cb.p_rcv_msg))
-                        {
-                            /* Send NCI message to the stack */
-                            nfc_hal_send_nci_msg_to_nfc_task (nfc_hal_cb.ncit_cb.p_rcv_msg);
-                        }
-                        else
+                        /* complete of receiving NCI message */
+                        nfc_hal_nci_assemble_nci_msg ();
+                        if (nfc_hal_cb.ncit_cb.p_rcv_msg)
                         {
-                            if (nfc_hal_cb.ncit_cb.p_rcv_msg)
-                                GKI_freebuf(nfc_hal_cb.ncit_cb.p_rcv_msg);
+                            if (nfc_hal_nci_preproc_rx_nci_msg (nfc_hal_cb.ncit_cb.p_rcv_msg))
+                            {
+                                /* Send NCI message to the stack */
+                                nfc_hal_send_nci_msg_to_nfc_task (nfc_hal_cb.ncit_cb.p_rcv_msg);
+                            }
+                            else
+                            {
+                                if (nfc_hal_cb.ncit_cb.p_rcv_msg)
+                                    GKI_freebuf(nfc_hal_cb.ncit_cb.p_rcv_msg);
+                            }
+                            nfc_hal_cb.ncit_cb.p_rcv_msg = NULL;
                         }
-                        nfc_hal_cb.ncit_cb.p_rcv_msg = NULL;
                     }
                 }
+                GKI_freebuf (p_span);
             } /* while (TRUE) */
         }
 
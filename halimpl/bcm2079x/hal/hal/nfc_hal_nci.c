@@ -513,6 +513,156 @@ BOOLEAN nfc_hal_nci_receive_msg (UINT8 byte)
     return (msg_received);
 }
 
+/*****************************************************************************
+**
+** Function         nfc_hal_nci_rcv_frame
+**
+** Description
+**      Start a new received message from a frame that is entirely in the
+**      receive span. The frame (without packet type) is copied in one go.
+**      If check_len is TRUE, a frame too long for the buffer is dropped.
+**
+*****************************************************************************/
+static void nfc_hal_nci_rcv_frame (tNFC_HAL_NCIT_CB *p_cb, UINT8 *p_data, UINT16 frame_len,
+                                   BOOLEAN check_len)
+{
+    if ((p_cb->p_rcv_msg = (NFC_HDR *) GKI_getpoolbuf (NFC_HAL_NCI_POOL_ID)) == NULL)
+    {
+        HAL_TRACE_ERROR0 ("Unable to allocate buffer for incoming NCI message.");
+        return;
+    }
+
+    if ((check_len) && (sizeof (NFC_HDR) + frame_len > GKI_get_buf_size (p_cb->p_rcv_msg)))
+    {
+        /* Message cannot fit into buffer */
+        GKI_freebuf (p_cb->p_rcv_msg);
+        p_cb->p_rcv_msg = NULL;
+
+        HAL_TRACE_ERROR0 ("Invalid length for incoming BT HCI message.");
+        return;
+    }
+
+    p_cb->p_rcv_msg->len    = frame_len;
+    p_cb->p_rcv_msg->event  = 0;
+    p_cb->p_rcv_msg->offset = 0;
+    memcpy ((UINT8 *) (p_cb->p_rcv_msg + 1), p_data, frame_len);
+}
+
+/*****************************************************************************
+**
+** Function         nfc_hal_nci_rcv_bt_msg_done
+**
+** Description
+**      Process a BT message whose last byte has been received.
+**
+*****************************************************************************/
+static void nfc_hal_nci_rcv_bt_msg_done (tNFC_HAL_NCIT_CB *p_cb)
+{
+#if (NFC_HAL_TRACE_PROTOCOL == TRUE)
+    if (p_cb->p_rcv_msg)
+    {
+        /* Display protocol trace message */
+        DispHciEvt (p_cb->p_rcv_msg);
+    }
+#endif
+    nfc_hal_nci_proc_rx_bt_msg ();
+}
+
+/*****************************************************************************
+**
+** Function         nfc_hal_nci_receive_span
+**
+** Description
+**      Handle a span of data received from the serial port.
+**
+**      Frames that are entirely in the span are copied into a message buffer
+**      in one go. The payload of a frame started by a previous span is copied
+**      in one go as well. Only the packet type and header of a frame that is
+**      cut by the end of the span go through nfc_hal_nci_receive_msg byte by
+**      byte. BT messages are processed here.
+**
+**      Parsing stops after an entire NCI message, which is left in
+**      nfc_hal_cb.ncit_cb.p_rcv_msg and *p_msg_received is set to TRUE.
+**
+** Returns          Number of bytes of the span that have been used.
+**
+*****************************************************************************/
+UINT16 nfc_hal_nci_receive_span (UINT8 *p_data, UINT16 len, BOOLEAN *p_msg_received)
+{
+    tNFC_HAL_NCIT_CB *p_cb = &(nfc_hal_cb.ncit_cb);
+    UINT8   *p = p_data, *p_end = p_data + len;
+    UINT16  frame_len;
+
+    *p_msg_received = FALSE;
+
+    while (p < p_end)
+    {
+        if (  (p_cb->rcv_state == NFC_HAL_RCV_NCI_PAYLOAD_ST)
+            ||(p_cb->rcv_state == NFC_HAL_RCV_BT_PAYLOAD_ST)  )
+        {
+            /* Rest of the payload of a frame started by a previous span */
+            frame_len = (UINT16) (p_end - p);
+            if (frame_len > p_cb->rcv_len)
+                frame_len = p_cb->rcv_len;
+
+            if (p_cb->p_rcv_msg)
+            {
+                memcpy ((UINT8 *) (p_cb->p_rcv_msg + 1) + p_cb->p_rcv_msg->offset + p_cb->p_rcv_msg->len,
+                        p, frame_len);
+                p_cb->p_rcv_msg->len += frame_len;
+            }
+            p            += frame_len;
+            p_cb->rcv_len -= frame_len;
+
+            if (p_cb->rcv_len == 0)
+            {
+                if (p_cb->rcv_state == NFC_HAL_RCV_NCI_PAYLOAD_ST)
+                {
+                    p_cb->rcv_state = NFC_HAL_RCV_IDLE_ST;
+                    *p_msg_received = TRUE;
+                    break;
+                }
+                p_cb->rcv_state = NFC_HAL_RCV_IDLE_ST;
+                nfc_hal_nci_rcv_bt_msg_done (p_cb);
+            }
+        }
+        else if (  (p_cb->rcv_state == NFC_HAL_RCV_IDLE_ST)
+                 &&(*p == HCIT_TYPE_NFC)
+                 &&(p_end - p > NCI_MSG_HDR_SIZE)
+                 &&(p_end - p > NCI_MSG_HDR_SIZE + p[NCI_MSG_HDR_SIZE])  )
+        {
+            /* Entire NCI message: packet type, header, payload */
+            frame_len = NCI_MSG_HDR_SIZE + p[NCI_MSG_HDR_SIZE];
+            nfc_hal_nci_rcv_frame (p_cb, p + 1, frame_len, FALSE);
+            p += 1 + frame_len;
+            *p_msg_received = TRUE;
+            break;
+        }
+        else if (  (p_cb->rcv_state == NFC_HAL_RCV_IDLE_ST)
+                 &&(*p == HCIT_TYPE_EVENT)
+                 &&(p_end - p > HCIE_PREAMBLE_SIZE)
+                 &&(p_end - p > HCIE_PREAMBLE_SIZE + p[HCIE_PREAMBLE_SIZE])  )
+        {
+            /* Entire BT message: packet type, preamble, parameters */
+            frame_len = HCIE_PREAMBLE_SIZE + p[HCIE_PREAMBLE_SIZE];
+            nfc_hal_nci_rcv_frame (p_cb, p + 1, frame_len, TRUE);
+            p += 1 + frame_len;
+            nfc_hal_nci_rcv_bt_msg_done (p_cb);
+        }
+        else
+        {
+            /* Frame cut by the end of the span, or unknown packet type */
+            if (nfc_hal_nci_receive_msg (*p++))
+            {
+                *p_msg_received = TRUE;
+                break;
+            }
+        }
+    }
+
+    return ((UINT16) (p - p_data));
+}
+
 /*******************************************************************************
 **
 ** Function         nfc_hal_nci_preproc_rx_nci_msg
@@ -840,6 +990,10 @@ void nfc_hal_nci_cmd_timeout_cback (void *p_tle)
 
     nfc_hal_cb.ncit_cb.nci_wait_rsp = NFC_HAL_WAIT_RSP_NONE;
 
+#ifdef DUMP_NCI_TRACE
+    DUMP_NCI_TRACE ();
+#endif
+
     if (p_tlent->event == NFC_HAL_TTYPE_NCI_WAIT_RSP)
     {
         if (nfc_hal_cb.dev_cb.initializing_state <= NFC_HAL_INIT_STATE_W4_PATCH_INFO)
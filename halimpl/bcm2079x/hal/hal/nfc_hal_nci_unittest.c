@@ -0,0 +1,438 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2015 Broadcom Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  Host test and benchmark of the NCI receive parser.
+ *
+ *  nfc_hal_nci.c is built into this file. A stream of NCI and BT messages
+ *  read from NFCC is cut into chunks, as the serial port hands them to the
+ *  HAL, and replayed through nfc_hal_nci_receive_msg() one byte at a time
+ *  and through nfc_hal_nci_receive_span() one chunk at a time.
+ *
+ *  The stream starts with the messages NFCC sends while the HAL starts it
+ *  up, followed by TEST_NUM_FRAMES pseudo-random NCI messages, BT events
+ *  and stray bytes. If a trace file written by nciTraceRingDump() is given
+ *  on the command line, the NCI messages received in it are replayed
+ *  instead.
+ *
+ *  Checks, for chunks of up to 8 and of up to 700 bytes:
+ *  - both parsers pass up the same NCI and BT messages, in the same order
+ *  - every GKI buffer taken is freed
+ *
+ *  Reports the time each parser takes for the whole stream.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "nfc_hal_nci.c"
+#include "nci_trace_file.h"
+
+#define TEST_NUM_FRAMES         20000
+#define TEST_MAX_STREAM         (1024 * 1024 * 2)
+#define TEST_MAX_CHUNKS         (TEST_MAX_STREAM)
+#define TEST_MAX_LOG            (TEST_MAX_STREAM * 2)
+#define TEST_POOL_BUF_SIZE      300
+#define TEST_STRAY_BYTE         0x55
+
+typedef struct
+{
+    UINT16      size;
+    UINT16      pad[3];
+} tTEST_BUF_HDR;
+
+static int      test_failures;
+
+static UINT8    test_stream[TEST_MAX_STREAM];
+static UINT32   test_stream_len;
+static UINT16   test_chunk_len[TEST_MAX_CHUNKS];
+static UINT32   test_num_chunks;
+static UINT32   test_read_pos;          /* next byte USERIAL_Read() returns */
+static UINT32   test_read_end;          /* end of the chunk read from the port */
+
+/* messages passed up by a parser: type, length, message */
+static UINT8    test_log[TEST_MAX_LOG];
+static UINT32   test_log_len;
+static UINT8    test_ref_log[TEST_MAX_LOG];
+static UINT32   test_ref_log_len;
+static UINT32   test_num_msgs;
+static int      test_bufs;              /* GKI buffers not freed */
+
+/* Messages from NFCC when the HAL starts it up: CORE_RESET_NTF,
+** the BT command complete events of HCI_RESET and of the baud rate VSC,
+** CORE_RESET_RSP, CORE_INIT_RSP and GET_CONFIG_RSP */
+static const UINT8 test_startup[] =
+{
+    0x10, 0x60, 0x00, 0x02, 0x00, 0x01,
+    0x04, 0x0E, 0x04, 0x01, 0x03, 0x0C, 0x00,
+    0x04, 0x0E, 0x04, 0x01, 0x18, 0xFC, 0x00,
+    0x10, 0x40, 0x00, 0x03, 0x00, 0x10, 0x01,
+    0x10, 0x40, 0x01, 0x17, 0x00, 0x03, 0x0E, 0x02, 0x00, 0x08, 0x00, 0x01, 0x02, 0x03, 0x80,
+    0x81, 0x82, 0x83, 0x02, 0xD0, 0x02, 0xFF, 0x02, 0x00, 0x04, 0x88, 0x00,
+    0x10, 0x40, 0x03, 0x06, 0x00, 0x01, 0x02, 0x01, 0x00, 0x00,
+};
+
+#define TEST_CHECK(cond) \
+    do { if (!(cond)) { printf ("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); test_failures++; } } while (0)
+
+/*******************************************************************************
+**
+** Function         test_log_msg
+**
+** Description      Record a message passed up by the parser
+**
+*******************************************************************************/
+static void test_log_msg (UINT8 type, NFC_HDR *p_msg)
+{
+    test_log[test_log_len++] = type;
+    if (p_msg == NULL)
+    {
+        test_log[test_log_len++] = 0xFF;
+        return;
+    }
+    test_log[test_log_len++] = (UINT8) p_msg->len;
+    memcpy (test_log + test_log_len, (UINT8 *) (p_msg + 1) + p_msg->offset, p_msg->len);
+    test_log_len += p_msg->len;
+    test_num_msgs++;
+}
+
+/* stubs of the symbols nfc_hal_nci.c needs from the rest of the HAL */
+tNFC_HAL_CB     nfc_hal_cb;
+unsigned char   appl_trace_level;
+const char * const nfc_hal_init_state_str[NFC_HAL_INIT_STATE_CLOSING + 1];
+void   *GKI_getpoolbuf (UINT8 pool_id)
+{
+    tTEST_BUF_HDR *p_hdr = (tTEST_BUF_HDR *) malloc (sizeof (tTEST_BUF_HDR) + TEST_POOL_BUF_SIZE);
+
+    p_hdr->size = TEST_POOL_BUF_SIZE;
+    test_bufs++;
+    return (p_hdr + 1);
+}
+UINT16  GKI_get_buf_size (void *p_buf) { return ((tTEST_BUF_HDR *) p_buf - 1)->size; }
+void    GKI_freebuf (void *p_buf) { test_bufs--; free ((tTEST_BUF_HDR *) p_buf - 1); }
+void    LogMsg (UINT32 trace_set_mask, const char *fmt_str, ...) {}
+void    DispHciEvt (BT_HDR *p_buf) { test_log_msg ('B', p_buf); }
+void    ProtoDispAdapterDisplayNciPacket (UINT8 *p_data, UINT16 len, BOOLEAN is_recv) {}
+void    ProtoDispAdapterDumpNciTrace (void) {}
+UINT16  USERIAL_Read (tUSERIAL_PORT port, UINT8 *p_data, UINT16 len)
+{
+    if (len > test_read_end - test_read_pos)
+        len = (UINT16) (test_read_end - test_read_pos);
+    memcpy (p_data, test_stream + test_read_pos, len);
+    test_read_pos += len;
+    return len;
+}
+UINT16  USERIAL_Write (tUSERIAL_PORT port, UINT8 *p_data, UINT16 len) { return len; }
+BOOLEAN nfc_hal_dm_power_mode_execute (tNFC_HAL_LP_EVT event) { return TRUE; }
+void    nfc_hal_dm_set_init_state (tNFC_HAL_INIT_STATE state) {}
+void    nfc_hal_dm_proc_msg_during_exit (NFC_HDR *p_msg) {}
+void    nfc_hal_dm_proc_msg_during_init (NFC_HDR *p_msg) {}
+void    nfc_hal_hci_handle_hci_netwk_info (UINT8 *p_data) {}
+void    nfc_hal_hci_handle_hcp_pkt_from_hc (UINT8 *p_data) {}
+void    nfc_hal_main_close (void) {}
+void    nfc_hal_main_pre_init_done (tHAL_NFC_STATUS status) {}
+void    nfc_hal_main_stop_quick_timer (TIMER_LIST_ENT *p_tle) {}
+void    nfc_hal_prm_process_timeout (void *p_tle) {}
+
+/*******************************************************************************
+**
+** Function         test_now_ns
+**
+*******************************************************************************/
+static long long test_now_ns (void)
+{
+    struct timespec now;
+
+    clock_gettime (CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/*******************************************************************************
+**
+** Function         test_add
+**
+** Description      Add a message to the stream: packet type, header and
+**                  payload of len bytes
+**
+*******************************************************************************/
+static void test_add (UINT8 type, const UINT8 *p_hdr, UINT8 hdr_len, const UINT8 *p_data, UINT8 len)
+{
+    if (test_stream_len + 1 + hdr_len + len > TEST_MAX_STREAM)
+        return;
+
+    test_stream[test_stream_len++] = type;
+    memcpy (test_stream + test_stream_len, p_hdr, hdr_len);
+    test_stream_len += hdr_len;
+    memcpy (test_stream + test_stream_len, p_data, len);
+    test_stream_len += len;
+}
+
+/*******************************************************************************
+**
+** Function         test_build_random
+**
+** Description      Startup messages followed by pseudo-random NCI messages,
+**                  BT events and stray bytes
+**
+*******************************************************************************/
+static void test_build_random (void)
+{
+    UINT8   hdr[3], data[255];
+    int     xx, yy, kind;
+
+    memcpy (test_stream, test_startup, sizeof (test_startup));
+    test_stream_len = sizeof (test_startup);
+
+    for (xx = 0; xx < TEST_NUM_FRAMES; xx++)
+    {
+        kind = rand () % 20;
+        if (kind < 15)
+        {
+            /* NCI message, mostly short with some long data packets */
+            hdr[0] = (rand () % 4 == 0) ? 0x00 : 0x60;
+            hdr[1] = (UINT8) (rand () & 0x3F);
+            hdr[2] = (UINT8) ((rand () % 4 == 0) ? rand () % 256 : rand () % 16);
+            for (yy = 0; yy < hdr[2]; yy++)
+                data[yy] = (UINT8) rand ();
+            test_add (HCIT_TYPE_NFC, hdr, NCI_MSG_HDR_SIZE, data, hdr[2]);
+        }
+        else if (kind < 19)
+        {
+            /* BT command complete event */
+            hdr[0] = 0x0E;
+            hdr[1] = (UINT8) (rand () % ((kind == 18) ? 255 : 40));
+            for (yy = 0; yy < hdr[1]; yy++)
+                data[yy] = (UINT8) rand ();
+            test_add (HCIT_TYPE_EVENT, hdr, HCIE_PREAMBLE_SIZE, data, hdr[1]);
+        }
+        else if (test_stream_len < TEST_MAX_STREAM)
+        {
+            test_stream[test_stream_len++] = TEST_STRAY_BYTE;
+        }
+    }
+}
+
+/*******************************************************************************
+**
+** Function         test_build_from_trace
+**
+** Description      The NCI messages received in a trace dump
+**
+** Returns          TRUE if the file could be read
+**
+*******************************************************************************/
+static BOOLEAN test_build_from_trace (const char *p_name)
+{
+    FILE                *p_file = fopen (p_name, "rb");
+    tNCI_TRACE_FILE_HDR hdr;
+    tNCI_TRACE_FILE_REC rec;
+    UINT8               data[NCI_MSG_HDR_SIZE + 255];
+    uint32_t            xx;
+
+    if (p_file == NULL)
+        return FALSE;
+
+    if (  (fread (&hdr, sizeof (hdr), 1, p_file) != 1)
+        ||(memcmp (hdr.magic, NCI_TRACE_FILE_MAGIC, NCI_TRACE_FILE_MAGIC_LEN) != 0)  )
+    {
+        fclose (p_file);
+        return FALSE;
+    }
+
+    test_stream_len = 0;
+    for (xx = 0; xx < hdr.num_records; xx++)
+    {
+        if (  (fread (&rec, sizeof (rec), 1, p_file) != 1)
+            ||(rec.len > sizeof (data))
+            ||(fread (data, 1, rec.len, p_file) != rec.len)  )
+            break;
+
+        if (  (rec.is_recv)
+            &&(rec.len >= NCI_MSG_HDR_SIZE)
+            &&(rec.len == NCI_MSG_HDR_SIZE + data[NCI_MSG_HDR_SIZE - 1])  )
+        {
+            test_add (HCIT_TYPE_NFC, data, NCI_MSG_HDR_SIZE, data + NCI_MSG_HDR_SIZE,
+                      (UINT8) (rec.len - NCI_MSG_HDR_SIZE));
+        }
+    }
+    fclose (p_file);
+    return TRUE;
+}
+
+/*******************************************************************************
+**
+** Function         test_cut
+**
+** Description      Cut the stream into chunks of 1 to max_chunk bytes
+**
+*******************************************************************************/
+static void test_cut (UINT16 max_chunk)
+{
+    UINT32 pos = 0;
+    UINT16 len;
+
+    test_num_chunks = 0;
+    while (pos < test_stream_len)
+    {
+        len = (UINT16) (1 + rand () % max_chunk);
+        if (len > test_stream_len - pos)
+            len = (UINT16) (test_stream_len - pos);
+        test_chunk_len[test_num_chunks++] = len;
+        pos += len;
+    }
+}
+
+/*******************************************************************************
+**
+** Function         test_nci_done
+**
+** Description      Take the NCI message the parser has received
+**
+*******************************************************************************/
+static void test_nci_done (void)
+{
+    test_log_msg ('N', nfc_hal_cb.ncit_cb.p_rcv_msg);
+    if (nfc_hal_cb.ncit_cb.p_rcv_msg)
+        GKI_freebuf (nfc_hal_cb.ncit_cb.p_rcv_msg);
+    nfc_hal_cb.ncit_cb.p_rcv_msg = NULL;
+}
+
+/*******************************************************************************
+**
+** Function         test_reset
+**
+*******************************************************************************/
+static void test_reset (void)
+{
+    memset (&nfc_hal_cb, 0, sizeof (nfc_hal_cb));
+    nfc_hal_cb.dev_cb.initializing_state = NFC_HAL_INIT_STATE_IDLE;
+    test_log_len  = 0;
+    test_num_msgs = 0;
+}
+
+/*******************************************************************************
+**
+** Function         test_run_bytewise
+**
+** Description      Read each chunk from the serial port one byte at a time and
+**                  pass it to nfc_hal_nci_receive_msg(), as the HAL did before.
+**                  The parser reads the rest of a payload from the port itself
+**
+*******************************************************************************/
+static long long test_run_bytewise (void)
+{
+    long long start;
+    UINT8     byte;
+    UINT32    xx;
+
+    test_reset ();
+    test_read_pos = test_read_end = 0;
+    start = test_now_ns ();
+    for (xx = 0; xx < test_num_chunks; xx++)
+    {
+        test_read_end += test_chunk_len[xx];
+        while (USERIAL_Read (USERIAL_NFC_PORT, &byte, 1) != 0)
+        {
+            if (nfc_hal_nci_receive_msg (byte))
+                test_nci_done ();
+        }
+    }
+    return test_now_ns () - start;
+}
+
+/*******************************************************************************
+**
+** Function         test_run_span
+**
+** Description      Pass each chunk to nfc_hal_nci_receive_span()
+**
+*******************************************************************************/
+static long long test_run_span (void)
+{
+    long long start;
+    UINT8     *p = test_stream;
+    UINT16    len, used;
+    BOOLEAN   msg_received;
+    UINT32    xx;
+
+    test_reset ();
+    start = test_now_ns ();
+    for (xx = 0; xx < test_num_chunks; xx++)
+    {
+        len = test_chunk_len[xx];
+        while (len > 0)
+        {
+            used = nfc_hal_nci_receive_span (p, len, &msg_received);
+            p   += used;
+            len -= used;
+            if (msg_received)
+                test_nci_done ();
+        }
+    }
+    return test_now_ns () - start;
+}
+
+int main (int argc, char **argv)
+{
+    static const UINT16 max_chunks[] = {8, 700};
+    long long byte_ns, span_ns;
+    UINT32    num_msgs;
+    int       xx;
+
+    srand (1);
+    if (argc > 1)
+    {
+        if (!test_build_from_trace (argv[1]))
+        {
+            printf ("cannot read trace %s\n", argv[1]);
+            return 1;
+        }
+    }
+    else
+    {
+        test_build_random ();
+    }
+
+    printf ("%lu bytes\n", (unsigned long) test_stream_len);
+
+    for (xx = 0; xx < (int) (sizeof (max_chunks) / sizeof (max_chunks[0])); xx++)
+    {
+        test_cut (max_chunks[xx]);
+
+        byte_ns = test_run_bytewise ();
+        TEST_CHECK (test_bufs == 0);
+        memcpy (test_ref_log, test_log, test_log_len);
+        test_ref_log_len = test_log_len;
+        num_msgs         = test_num_msgs;
+
+        span_ns = test_run_span ();
+        TEST_CHECK (test_bufs == 0);
+        TEST_CHECK (test_num_msgs == num_msgs);
+        TEST_CHECK (test_log_len == test_ref_log_len);
+        TEST_CHECK (memcmp (test_log, test_ref_log, test_ref_log_len) == 0);
+
+        printf ("  chunks of up to %3u bytes, %lu messages: receive_msg %lld us, receive_span %lld us\n",
+                max_chunks[xx], (unsigned long) num_msgs, byte_ns / 1000, span_ns / 1000);
+    }
+
+    printf ("%s\n", test_failures ? "FAILED" : "PASSED");
+    return test_failures ? 1 : 0;
+}
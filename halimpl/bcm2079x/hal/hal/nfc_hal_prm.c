@@ -31,9 +31,11 @@
 #define NFC_HAL_PRM_FLAGS_I2C_FIX_REQUIRED  0x08    /* PreI2C patch required */
 #define NFC_HAL_PRM_FLAGS_BCM20791B3        0x10    /* B3 Patch (no RESET_NTF after patch download) */
 #define NFC_HAL_PRM_FLAGS_RM_RF             0x20    /* Erase Personality data */
+#define NFC_HAL_PRM_FLAGS_SPD_RESTART       0x40    /* Restart patch in stop-and-wait after error */
 
 /* Secure patch download definitions */
 #define NFC_HAL_PRM_NCD_PATCHFILE_HDR_LEN  7       /* PRJID + MAJORVER + MINORVER + COUNT */
+#define NFC_HAL_PRM_SPD_TYPE_NONE          0xFF    /* segment is not a SECURE_PATCH_DOWNLOAD command */
 
 /* Enumeration of power modes IDs */
 #define NFC_HAL_PRM_SPD_POWER_MODE_LPM     0
@@ -67,6 +69,7 @@ const tNFC_HAL_PRM_RM_RF nfc_hal_prm_rm_rf_20795a1 [] =
     {0,         0}
 };
 static BOOLEAN nfc_hal_prm_nvm_rw_cmd(void);
+static void nfc_hal_prm_spd_wait_rsp (void);
 
 /*****************************************************************************
 ** Extern variable from nfc_hal_dm_cfg.c
@@ -86,6 +89,12 @@ void nfc_hal_prm_spd_handle_download_complete (UINT8 event)
 {
     nfc_hal_cb.prm.state = NFC_HAL_PRM_ST_IDLE;
 
+    if (nfc_hal_cb.prm.p_spd_next)
+    {
+        GKI_freebuf (nfc_hal_cb.prm.p_spd_next);
+        nfc_hal_cb.prm.p_spd_next = NULL;
+    }
+
     /* Notify application now */
     if (nfc_hal_cb.prm.p_cback)
         (nfc_hal_cb.prm.p_cback) (event);
@@ -93,15 +102,19 @@ void nfc_hal_prm_spd_handle_download_complete (UINT8 event)
 
 /*******************************************************************************
 **
-** Function         nfc_hal_prm_spd_send_next_segment
+** Function         nfc_hal_prm_spd_build_segment
 **
-** Description      Send next patch segment (for secure patch download)
+** Description      Build the next patch segment into an NCI command
+**                  (for secure patch download)
 **
-** Returns          void
+**                  p_type: SPD type of the segment
+**
+** Returns          the command, or NULL if download is aborted
 **
 *******************************************************************************/
-void nfc_hal_prm_spd_send_next_segment (void)
+static NFC_HDR *nfc_hal_prm_spd_build_segment (UINT8 *p_type)
 {
+    NFC_HDR *p_buf;
     UINT8   *p_src;
     UINT16  len, offset = nfc_hal_cb.prm.cur_patch_offset;
     UINT8   hcit, oid, hdr0, type;
@@ -114,7 +127,7 @@ void nfc_hal_prm_spd_send_next_segment (void)
     {
         HAL_TRACE_ERROR0 ("Unexpected end of patch.");
         nfc_hal_prm_spd_handle_download_complete (NFC_HAL_PRM_ABORT_INVALID_PATCH_EVT);
-        return;
+        return NULL;
     }
 
     /* Parse NCI command header */
@@ -125,20 +138,9 @@ void nfc_hal_prm_spd_send_next_segment (void)
     STREAM_TO_UINT8 (len,  p_src);
     STREAM_TO_UINT8 (type, p_src);
 
-
-    /* Update number of bytes comsumed */
-    nfc_hal_cb.prm.cur_patch_offset += (len + patch_hdr_size);
-    nfc_hal_cb.prm.cur_patch_len_remaining -=  (len + patch_hdr_size);
-
-    /* Check if sending signature byte */
-    if (  (oid == NCI_MSG_SECURE_PATCH_DOWNLOAD )
-        &&(type == NCI_SPD_TYPE_SIGNATURE)  )
-    {
-        nfc_hal_cb.prm.flags |= NFC_HAL_PRM_FLAGS_SIGNATURE_SENT;
-    }
     /* Check for header */
-    else if (  (oid == NCI_MSG_SECURE_PATCH_DOWNLOAD )
-             &&(type == NCI_SPD_TYPE_HEADER)  )
+    if (  (oid == NCI_MSG_SECURE_PATCH_DOWNLOAD )
+        &&(type == NCI_SPD_TYPE_HEADER)  )
     {
         /* Check if patch is for BCM20791B3 */
         p_src += NCI_SPD_HEADER_OFFSET_CHIPVERLEN;
@@ -147,7 +149,7 @@ void nfc_hal_prm_spd_send_next_segment (void)
         {
             HAL_TRACE_ERROR0 ("Unexpected chip ver.");
             nfc_hal_prm_spd_handle_download_complete (NFC_HAL_PRM_ABORT_INVALID_PATCH_EVT);
-            return;
+            return NULL;
         }
         STREAM_TO_ARRAY (chipverstr, p_src, NCI_SPD_HEADER_CHIPVER_LEN);
 
@@ -163,9 +165,150 @@ void nfc_hal_prm_spd_send_next_segment (void)
         }
     }
 
-    /* Send the command (not including HCIT here) */
-    nfc_hal_dm_send_nci_cmd ((UINT8*) (nfc_hal_cb.prm.p_cur_patch_data + offset + 1), (UINT8) (len + NCI_MSG_HDR_SIZE),
-                             nfc_hal_prm_nci_command_complete_cback);
+    if ((p_buf = (NFC_HDR *) GKI_getpoolbuf (NFC_HAL_NCI_POOL_ID)) == NULL)
+    {
+        HAL_TRACE_ERROR0 ("No buffer for patch segment.");
+        nfc_hal_prm_spd_handle_download_complete (NFC_HAL_PRM_ABORT_EVT);
+        return NULL;
+    }
+
+    /* Copy the command (not including HCIT here) */
+    p_buf->offset = NFC_HAL_NCI_MSG_OFFSET_SIZE;
+    p_buf->event  = NFC_HAL_EVT_TO_NFC_NCI;
+    p_buf->len    = len + NCI_MSG_HDR_SIZE;
+    memcpy ((UINT8 *) (p_buf + 1) + p_buf->offset, nfc_hal_cb.prm.p_cur_patch_data + offset + 1, p_buf->len);
+
+    *p_type = (oid == NCI_MSG_SECURE_PATCH_DOWNLOAD) ? type : NFC_HAL_PRM_SPD_TYPE_NONE;
+
+    /* Update number of bytes comsumed */
+    nfc_hal_cb.prm.cur_patch_offset += (len + patch_hdr_size);
+    nfc_hal_cb.prm.cur_patch_len_remaining -=  (len + patch_hdr_size);
+
+    return p_buf;
+}
+
+/*******************************************************************************
+**
+** Function         nfc_hal_prm_spd_wait_rsp
+**
+** Description      Wait for the response to a patch segment in flight
+**                  (for secure patch download)
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfc_hal_prm_spd_wait_rsp (void)
+{
+    nfc_hal_cb.ncit_cb.nci_wait_rsp = NFC_HAL_WAIT_RSP_VSC;
+    nfc_hal_cb.ncit_cb.p_vsc_cback  = (void *) nfc_hal_prm_nci_command_complete_cback;
+
+    /* start NFC command-timeout timer */
+    nfc_hal_main_start_quick_timer (&nfc_hal_cb.ncit_cb.nci_wait_rsp_timer, (UINT16)(NFC_HAL_TTYPE_NCI_WAIT_RSP),
+                                    ((UINT32) NFC_HAL_CMD_TOUT) * QUICK_TIMER_TICKS_PER_SEC / 1000);
+}
+
+/*******************************************************************************
+**
+** Function         nfc_hal_prm_spd_send_next_segment
+**
+** Description      Send next patch segments (for secure patch download)
+**
+**                  If the patch is in a buffer, up to spd_window segments
+**                  are sent without waiting for their responses, and the
+**                  next segment is built while NFCC processes the others.
+**                  The header and signature segments are always sent alone.
+**                  All segments have the same NCI header, so the saved
+**                  header matches the response to any of them.
+**                  Nothing is sent while a segment is held in p_pend_cmd
+**                  for NFCC to leave low power mode; it would be replaced.
+**
+** Returns          void
+**
+*******************************************************************************/
+void nfc_hal_prm_spd_send_next_segment (void)
+{
+    NFC_HDR *p_buf;
+    UINT8   *ps;
+    UINT8   type;
+
+    while (nfc_hal_cb.ncit_cb.p_pend_cmd == NULL)
+    {
+        /* Use the segment built while waiting, if any */
+        if ((p_buf = nfc_hal_cb.prm.p_spd_next) != NULL)
+        {
+            type = nfc_hal_cb.prm.spd_next_type;
+            nfc_hal_cb.prm.p_spd_next = NULL;
+        }
+        else if ((p_buf = nfc_hal_prm_spd_build_segment (&type)) == NULL)
+        {
+            return;
+        }
+
+        /* Header and signature wait until no segment is in flight */
+        if (  (nfc_hal_cb.prm.spd_in_flight)
+            &&((type == NCI_SPD_TYPE_HEADER) || (type == NCI_SPD_TYPE_SIGNATURE))  )
+        {
+            nfc_hal_cb.prm.p_spd_next    = p_buf;
+            nfc_hal_cb.prm.spd_next_type = type;
+            return;
+        }
+
+        /* Check if sending signature byte */
+        if (type == NCI_SPD_TYPE_SIGNATURE)
+            nfc_hal_cb.prm.flags |= NFC_HAL_PRM_FLAGS_SIGNATURE_SENT;
+
+        /* save the message header to double check the response */
+        ps = (UINT8 *) (p_buf + 1) + p_buf->offset;
+        memcpy (nfc_hal_cb.ncit_cb.last_hdr, ps, NFC_HAL_SAVED_HDR_SIZE);
+        memcpy (nfc_hal_cb.ncit_cb.last_cmd, ps + NCI_MSG_HDR_SIZE, NFC_HAL_SAVED_CMD_SIZE);
+
+        nfc_hal_cb.prm.spd_in_flight++;
+        nfc_hal_prm_spd_wait_rsp ();
+        nfc_hal_nci_send_cmd (p_buf);
+
+        /* Nothing follows the signature; without a buffer, segments come one at a time */
+        if (  (type == NCI_SPD_TYPE_SIGNATURE)
+            ||(!(nfc_hal_cb.prm.flags & NFC_HAL_PRM_FLAGS_USE_PATCHRAM_BUF))  )
+            return;
+
+        /* Build the next segment while NFCC processes this one */
+        nfc_hal_cb.prm.p_spd_next = nfc_hal_prm_spd_build_segment (&nfc_hal_cb.prm.spd_next_type);
+        if (nfc_hal_cb.prm.p_spd_next == NULL)
+            return;
+
+        if (  (nfc_hal_cb.prm.spd_in_flight >= nfc_hal_cb.prm.spd_window)
+            ||(type == NCI_SPD_TYPE_HEADER)  )
+            return;
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfc_hal_prm_spd_restart_patch
+**
+** Description      Download the current patch again from its header, one
+**                  segment at a time (for secure patch download)
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfc_hal_prm_spd_restart_patch (void)
+{
+    HAL_TRACE_DEBUG0 ("Restarting patch download in stop-and-wait mode.");
+
+    nfc_hal_cb.prm.flags &= ~(NFC_HAL_PRM_FLAGS_SPD_RESTART | NFC_HAL_PRM_FLAGS_SIGNATURE_SENT);
+    nfc_hal_cb.prm.spd_window = 1;
+
+    if (nfc_hal_cb.prm.p_spd_next)
+    {
+        GKI_freebuf (nfc_hal_cb.prm.p_spd_next);
+        nfc_hal_cb.prm.p_spd_next = NULL;
+    }
+
+    nfc_hal_cb.prm.cur_patch_len_remaining += (nfc_hal_cb.prm.cur_patch_offset - nfc_hal_cb.prm.spd_patch_start);
+    nfc_hal_cb.prm.cur_patch_offset = nfc_hal_cb.prm.spd_patch_start;
+
+    nfc_hal_prm_spd_send_next_segment ();
 }
 
 /*******************************************************************************
@@ -225,6 +368,7 @@ void nfc_hal_prm_spd_handle_next_patch_start (void)
     /* Begin downloading patch */
     HAL_TRACE_DEBUG1 ("Downloading patch for power_mode %i.", nfc_hal_cb.prm.spd_patch_desc[nfc_hal_cb.prm.spd_cur_patch_idx].power_mode);
     nfc_hal_cb.prm.state = NFC_HAL_PRM_ST_SPD_DOWNLOADING;
+    nfc_hal_cb.prm.spd_patch_start = nfc_hal_cb.prm.cur_patch_offset;
     nfc_hal_prm_spd_send_next_segment ();
 }
 
@@ -295,6 +439,7 @@ void nfc_hal_prm_spd_download_i2c_fix (void)
         nfc_hal_cb.prm.cur_patch_offset += (UINT16) (p - p_start);              /* Bytes of patchfile transmitted/processed so far */
 
         /* Begin sending patch to the NFCC */
+        nfc_hal_cb.prm.spd_patch_start = nfc_hal_cb.prm.cur_patch_offset;
         nfc_hal_prm_spd_send_next_segment ();
     }
     else
@@ -679,6 +824,9 @@ void nfc_hal_prm_nci_command_complete_cback (tNFC_HAL_NCI_EVT event, UINT16 data
         STREAM_TO_UINT8 (status, p);
         STREAM_TO_UINT8 (u8, p);
 
+        if (nfc_hal_cb.prm.spd_in_flight)
+            nfc_hal_cb.prm.spd_in_flight--;
+
         if (status != NCI_STATUS_OK)
         {
 #if (NFC_HAL_TRACE_VERBOSE == TRUE)
@@ -687,8 +835,28 @@ void nfc_hal_prm_nci_command_complete_cback (tNFC_HAL_NCI_EVT event, UINT16 data
             HAL_TRACE_ERROR1 ("Patch download failed, reason code=0x%X", status);
 #endif
 
-            /* Notify application */
-            nfc_hal_prm_spd_handle_download_complete (NFC_HAL_PRM_ABORT_INVALID_PATCH_EVT);
+            if (nfc_hal_cb.prm.spd_window > 1)
+            {
+                /* Segments may have been sent too fast; retry the patch in stop-and-wait */
+                HAL_TRACE_WARNING0 ("Falling back to stop-and-wait patch download");
+                nfc_hal_cb.prm.spd_window = 1;
+                nfc_hal_cb.prm.flags |= NFC_HAL_PRM_FLAGS_SPD_RESTART;
+            }
+            else if (!(nfc_hal_cb.prm.flags & NFC_HAL_PRM_FLAGS_SPD_RESTART))
+            {
+                /* Notify application */
+                nfc_hal_prm_spd_handle_download_complete (NFC_HAL_PRM_ABORT_INVALID_PATCH_EVT);
+                return;
+            }
+        }
+
+        if (nfc_hal_cb.prm.flags & NFC_HAL_PRM_FLAGS_SPD_RESTART)
+        {
+            /* Drain the segments still in flight before restarting the patch */
+            if (nfc_hal_cb.prm.spd_in_flight)
+                nfc_hal_prm_spd_wait_rsp ();
+            else
+                nfc_hal_prm_spd_restart_patch ();
             return;
         }
 
@@ -706,6 +874,12 @@ void nfc_hal_prm_nci_command_complete_cback (tNFC_HAL_NCI_EVT event, UINT16 data
         {
             /* If patch is in a buffer, get next patch from buffer */
             nfc_hal_prm_spd_send_next_segment ();
+
+            /* Keep waiting for segments in flight if none was sent */
+            if (  (nfc_hal_cb.prm.spd_in_flight)
+                &&(nfc_hal_cb.ncit_cb.nci_wait_rsp == NFC_HAL_WAIT_RSP_NONE)
+                &&(nfc_hal_cb.prm.state == NFC_HAL_PRM_ST_SPD_DOWNLOADING)  )
+                nfc_hal_prm_spd_wait_rsp ();
         }
         else
         {
@@ -1024,10 +1198,16 @@ BOOLEAN HAL_NfcPrmDownloadStart (tNFC_HAL_PRM_FORMAT format_type,
         nfc_hal_cb.prm.cur_patch_len_remaining = (UINT16) patchram_len;
         nfc_hal_cb.prm.flags |= NFC_HAL_PRM_FLAGS_USE_PATCHRAM_BUF;
 
+        /* Segments can only be sent ahead when the patch is in a buffer */
+        nfc_hal_cb.prm.spd_window = nfc_hal_cb.prm_spd_window;
+
         if (patchram_len == 0)
             return FALSE;
     }
 
+    if (nfc_hal_cb.prm.spd_window == 0)
+        nfc_hal_cb.prm.spd_window   = 1;
+
     nfc_hal_cb.prm.p_cback          = p_cback;
     nfc_hal_cb.prm.dest_ram         = dest_address;
     nfc_hal_cb.prm.format           = format_type;
@@ -1193,3 +1373,40 @@ tHAL_NFC_STATUS HAL_NfcPrmSetSpdNciCmdPayloadSize (UINT8 max_payload_size)
         return (HAL_NFC_STATUS_OK);
     }
 }
+
+/*******************************************************************************
+**
+** Function         HAL_NfcPrmSetSpdWindow
+**
+** Description      Set the number of segments that may be sent to NFCC
+**                  without waiting for their responses during secure patch
+**                  download. Only used when the patch is given in a buffer.
+**
+**                  This API must be called before calling HAL_NfcPrmDownloadStart.
+**                  If the API is not called, then PRM will use
+**                  NFC_HAL_PRM_SPD_WINDOW.
+**
+**                  If NFCC rejects a segment, the patch is downloaded again
+**                  one segment at a time.
+**
+**                  Valid window range: 1 (stop-and-wait) to NFC_HAL_PRM_SPD_MAX_WINDOW.
+**
+** Returns          HAL_NFC_STATUS_OK if successful
+**                  HAL_NFC_STATUS_FAILED otherwise
+**
+**
+*******************************************************************************/
+tHAL_NFC_STATUS HAL_NfcPrmSetSpdWindow (UINT8 window)
+{
+    if ((window == 0) || (window > NFC_HAL_PRM_SPD_MAX_WINDOW))
+    {
+        HAL_TRACE_ERROR2 ("HAL_NfcPrmSetSpdWindow: invalid window (%i). Must be between 1 and %i", window, NFC_HAL_PRM_SPD_MAX_WINDOW);
+        return (HAL_NFC_STATUS_FAILED);
+    }
+    else
+    {
+        HAL_TRACE_API1 ("HAL_NfcPrmSetSpdWindow: segments in flight during download: %i", window);
+        nfc_hal_cb.prm_spd_window = window;
+        return (HAL_NFC_STATUS_OK);
+    }
+}
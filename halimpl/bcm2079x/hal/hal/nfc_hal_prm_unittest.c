@@ -0,0 +1,359 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2015 Broadcom Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  Host test and benchmark of the windowed secure patch download against a
+ *  simulated NFCC.
+ *
+ *  nfc_hal_prm.c is built into this file. nfc_hal_nci_send_cmd() hands each
+ *  patch segment to a simulated link and NFCC, in simulated time: a byte
+ *  takes sim_byte_us on the link, NFCC takes sim_proc_us per segment and
+ *  queues at most sim_queue segments, and the host takes sim_host_us to
+ *  handle a response. A segment that arrives at a full queue is rejected.
+ *  The responses are passed to the VSC callback in time order.
+ *
+ *  Checks, for every run:
+ *  - the download reaches the authentication stage, no response is lost
+ *  - after the last header, NFCC took every segment once and in order
+ *  - every GKI buffer taken is freed
+ *  and that
+ *  - a window of 2 is faster than stop-and-wait on each link
+ *  - segments rejected in windowed mode make PRM download the patch again
+ *    in stop-and-wait mode
+ *  - a segment held in p_pend_cmd for low power mode is not replaced by
+ *    the next one
+ *
+ *  Reports the simulated download time of a 162 segment patch for windows
+ *  1, 2, 4 and 8 on UART, I2C and SPI, and with a slow NFCC that queues 2
+ *  segments.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nfc_hal_prm.c"
+#include "nfc_brcm_defs.h"
+
+#define TEST_NUM_SRAM_SEGS      160
+#define TEST_SRAM_SEG_LEN       0xF0
+#define TEST_MAX_EVENTS         1024
+#define TEST_CHIP_VER           "20795A1"
+#define TEST_LP_WAKE_US         1000    /* time for NFCC to leave low power mode */
+
+typedef struct
+{
+    const char  *p_name;
+    double      byte_us;                /* time of a byte on the link */
+} tTEST_LINK;
+
+typedef struct
+{
+    double      t;                      /* time the host gets the response */
+    UINT8       status;
+} tTEST_EVT;
+
+static int          test_failures;
+
+/* Simulated link and NFCC, times in microseconds */
+static double       sim_byte_us;
+static double       sim_proc_us;
+static double       sim_host_us;
+static int          sim_queue;          /* segments NFCC can queue */
+static double       sim_now;
+static double       sim_tx_free;        /* link is free from then on */
+static double       sim_proc_free;      /* NFCC is free from then on */
+static double       sim_done[TEST_MAX_EVENTS];  /* time NFCC is done with each segment taken */
+static int          sim_num_done;
+static tTEST_EVT    sim_evt[TEST_MAX_EVENTS];   /* responses in time order */
+static int          sim_num_evt;
+static int          sim_rejects;
+static int          sim_lost;           /* responses with no VSC callback waiting */
+static int          sim_next_seq;       /* next SRAM segment NFCC expects */
+static BOOLEAN      sim_out_of_order;
+static int          sim_bufs;           /* GKI buffers not freed */
+static int          sim_park_seq;       /* hold this segment in p_pend_cmd, -1 for none */
+static double       sim_wake;           /* time the held segment is sent */
+
+static UINT8        test_patch[TEST_NUM_SRAM_SEGS * (TEST_SRAM_SEG_LEN + 4) + 256];
+static UINT16       test_patch_len;
+static UINT8        test_last_evt;
+
+#define TEST_CHECK(cond) \
+    do { if (!(cond)) { printf ("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); test_failures++; } } while (0)
+
+/* stubs of the symbols nfc_hal_prm.c needs from the rest of the HAL */
+tNFC_HAL_CB     nfc_hal_cb;
+tNFC_HAL_CFG    *p_nfc_hal_cfg;
+void   *GKI_getpoolbuf (UINT8 pool_id) { sim_bufs++; return malloc (GKI_MAX_BUF_SIZE); }
+void   *GKI_getbuf (UINT16 size) { sim_bufs++; return malloc (size); }
+void    GKI_freebuf (void *p_buf) { sim_bufs--; free (p_buf); }
+void    LogMsg (UINT32 trace_set_mask, const char *fmt_str, ...) {}
+void    nfc_hal_main_start_quick_timer (TIMER_LIST_ENT *p_tle, UINT16 type, UINT32 timeout) {}
+void    nfc_hal_main_stop_quick_timer (TIMER_LIST_ENT *p_tle) {}
+void    nfc_hal_dm_send_nci_cmd (const UINT8 *p_data, UINT16 len, tNFC_HAL_NCI_CBACK *p_cback) {}
+
+/*******************************************************************************
+**
+** Function         sim_transmit
+**
+** Description      Pass a segment over the link to NFCC, queue its response
+**
+*******************************************************************************/
+static void sim_transmit (NFC_HDR *p_buf)
+{
+    UINT8   *p = (UINT8 *) (p_buf + 1) + p_buf->offset;
+    double  tx_end = ((sim_now > sim_tx_free) ? sim_now : sim_tx_free) + (p_buf->len + 1) * sim_byte_us;
+    int     queued = 0, xx;
+    tTEST_EVT evt;
+
+    sim_tx_free = tx_end;
+    for (xx = 0; xx < sim_num_done; xx++)
+    {
+        if (sim_done[xx] > tx_end)
+            queued++;
+    }
+
+    if (queued >= sim_queue)
+    {
+        evt.status = NCI_STATUS_FAILED;
+        evt.t      = tx_end + 7 * sim_byte_us + sim_host_us;
+        sim_rejects++;
+    }
+    else
+    {
+        /* header starts the patch again; SRAM segments carry their number */
+        if (p[NCI_MSG_HDR_SIZE] == NCI_SPD_TYPE_HEADER)
+        {
+            sim_next_seq     = 0;
+            sim_out_of_order = FALSE;
+        }
+        else if (p[NCI_MSG_HDR_SIZE] == NCI_SPD_TYPE_SRAM)
+        {
+            if (p[NCI_MSG_HDR_SIZE + 1] + (p[NCI_MSG_HDR_SIZE + 2] << 8) != sim_next_seq)
+                sim_out_of_order = TRUE;
+            sim_next_seq++;
+        }
+
+        sim_proc_free = ((tx_end > sim_proc_free) ? tx_end : sim_proc_free) + sim_proc_us;
+        sim_done[sim_num_done++] = sim_proc_free;
+        evt.status = NCI_STATUS_OK;
+        evt.t      = sim_proc_free + 7 * sim_byte_us + sim_host_us;
+    }
+
+    for (xx = sim_num_evt++; (xx > 0) && (sim_evt[xx - 1].t > evt.t); xx--)
+        sim_evt[xx] = sim_evt[xx - 1];
+    sim_evt[xx] = evt;
+
+    GKI_freebuf (p_buf);
+}
+
+/*******************************************************************************
+**
+** Function         nfc_hal_nci_send_cmd
+**
+** Description      Send a segment to the simulated NFCC, or hold it in
+**                  p_pend_cmd as low power mode does; NFCC goes to low power
+**                  mode when segment sim_park_seq is sent, and any segment
+**                  sent before it wakes up replaces the one held
+**
+*******************************************************************************/
+void nfc_hal_nci_send_cmd (NFC_HDR *p_buf)
+{
+    UINT8 *p = (UINT8 *) (p_buf + 1) + p_buf->offset;
+
+    if (  (p[NCI_MSG_HDR_SIZE] == NCI_SPD_TYPE_SRAM)
+        &&(p[NCI_MSG_HDR_SIZE + 1] + (p[NCI_MSG_HDR_SIZE + 2] << 8) == sim_park_seq)  )
+    {
+        sim_park_seq = -1;
+        sim_wake     = sim_now + TEST_LP_WAKE_US;
+    }
+    else if (nfc_hal_cb.ncit_cb.p_pend_cmd == NULL)
+    {
+        sim_transmit (p_buf);
+        return;
+    }
+    nfc_hal_cb.ncit_cb.p_pend_cmd = p_buf;
+}
+
+/*******************************************************************************
+**
+** Function         test_add_segment
+**
+** Description      Add a SECURE_PATCH_DOWNLOAD command to the patch
+**
+*******************************************************************************/
+static void test_add_segment (UINT8 type, UINT8 len, UINT16 seq)
+{
+    UINT8 *p = test_patch + test_patch_len;
+    UINT8 xx;
+
+    /* patchram.cpp keeps the HCIT byte before each command */
+    UINT8_TO_STREAM (p, HCIT_TYPE_NFC);
+    NCI_MSG_BLD_HDR0 (p, NCI_MT_CMD, NCI_GID_PROP);
+    NCI_MSG_BLD_HDR1 (p, NCI_MSG_SECURE_PATCH_DOWNLOAD);
+    UINT8_TO_STREAM (p, len);
+    UINT8_TO_STREAM (p, type);
+    for (xx = 1; xx < len; xx++)
+        p[xx - 1] = xx;
+    p[0] = (UINT8) seq;
+    p[1] = (UINT8) (seq >> 8);
+
+    if (type == NCI_SPD_TYPE_HEADER)
+    {
+        p[NCI_SPD_HEADER_OFFSET_CHIPVERLEN] = sizeof (TEST_CHIP_VER) - 1;
+        memcpy (p + NCI_SPD_HEADER_OFFSET_CHIPVERLEN + 1, TEST_CHIP_VER, sizeof (TEST_CHIP_VER) - 1);
+    }
+    test_patch_len += 1 + NCI_MSG_HDR_SIZE + len;
+}
+
+static void test_prm_cback (UINT8 event)
+{
+    test_last_evt = event;
+}
+
+/*******************************************************************************
+**
+** Function         test_run
+**
+** Description      Download the patch with a window, return the time taken
+**
+*******************************************************************************/
+static double test_run (UINT8 window, int queue, int park_seq)
+{
+    static tNFC_HAL_CFG cfg;
+    UINT8   rsp[NCI_MSG_HDR_SIZE + 2];
+    UINT8   *p = rsp;
+    tNFC_HAL_NCI_CBACK *p_cback;
+    NFC_HDR *p_buf;
+
+    NCI_MSG_BLD_HDR0 (p, NCI_MT_RSP, NCI_GID_PROP);
+    NCI_MSG_BLD_HDR1 (p, NCI_MSG_SECURE_PATCH_DOWNLOAD);
+    UINT8_TO_STREAM (p, 2);
+
+    p_nfc_hal_cfg = &cfg;
+    memset (&nfc_hal_cb, 0, sizeof (nfc_hal_cb));
+    memcpy (nfc_hal_cb.nvm_cb.chip_ver, TEST_CHIP_VER, sizeof (TEST_CHIP_VER) - 1);
+    nfc_hal_cb.prm.flags                   = NFC_HAL_PRM_FLAGS_USE_PATCHRAM_BUF;
+    nfc_hal_cb.prm.p_cur_patch_data        = test_patch;
+    nfc_hal_cb.prm.cur_patch_len_remaining = test_patch_len;
+    nfc_hal_cb.prm.spd_patch_desc[0].len   = test_patch_len;
+    nfc_hal_cb.prm.spd_patch_count         = 1;
+    nfc_hal_cb.prm.spd_patch_needed_mask   = 1;
+    nfc_hal_cb.prm.p_cback                 = test_prm_cback;
+    nfc_hal_cb.prm.spd_window              = window;
+
+    sim_queue    = queue;
+    sim_park_seq = park_seq;
+    sim_now = sim_tx_free = sim_proc_free = 0;
+    sim_num_done = sim_num_evt = sim_rejects = sim_lost = sim_next_seq = sim_bufs = 0;
+    sim_out_of_order = FALSE;
+    test_last_evt = 0;
+
+    nfc_hal_prm_spd_handle_next_patch_start ();
+
+    for (;;)
+    {
+        /* NFCC leaves low power mode, the held segment goes out */
+        if (  ((p_buf = nfc_hal_cb.ncit_cb.p_pend_cmd) != NULL)
+            &&((sim_num_evt == 0) || (sim_wake <= sim_evt[0].t))  )
+        {
+            sim_now = sim_wake;
+            nfc_hal_cb.ncit_cb.p_pend_cmd = NULL;
+            sim_transmit (p_buf);
+            continue;
+        }
+        if (sim_num_evt == 0)
+            break;
+
+        sim_now = sim_evt[0].t;
+        rsp[NCI_MSG_HDR_SIZE] = sim_evt[0].status;
+        memmove (sim_evt, sim_evt + 1, --sim_num_evt * sizeof (tTEST_EVT));
+
+        if (nfc_hal_cb.ncit_cb.nci_wait_rsp != NFC_HAL_WAIT_RSP_VSC)
+        {
+            sim_lost++;
+            continue;
+        }
+        nfc_hal_cb.ncit_cb.nci_wait_rsp = NFC_HAL_WAIT_RSP_NONE;
+        p_cback = (tNFC_HAL_NCI_CBACK *) nfc_hal_cb.ncit_cb.p_vsc_cback;
+        nfc_hal_cb.ncit_cb.p_vsc_cback = NULL;
+        (*p_cback) (NFC_VS_SEC_PATCH_DOWNLOAD_EVT, sizeof (rsp), rsp);
+    }
+
+    TEST_CHECK (nfc_hal_cb.prm.state == NFC_HAL_PRM_ST_SPD_AUTHENTICATING);
+    TEST_CHECK (test_last_evt == 0);
+    TEST_CHECK (sim_lost == 0);
+    TEST_CHECK (sim_next_seq == TEST_NUM_SRAM_SEGS);
+    TEST_CHECK (!sim_out_of_order);
+    TEST_CHECK (sim_bufs == 0);
+    return sim_now / 1000;
+}
+
+int main (void)
+{
+    static const tTEST_LINK links[] =
+    {
+        {"UART 115200", 86.8},
+        {"I2C 400k",    22.5},
+        {"SPI 4M",       2.0},
+    };
+    double  ms[4];
+    int     xx, yy, rejects;
+
+    test_add_segment (NCI_SPD_TYPE_HEADER, 0x40, 0);
+    for (xx = 0; xx < TEST_NUM_SRAM_SEGS; xx++)
+        test_add_segment (NCI_SPD_TYPE_SRAM, TEST_SRAM_SEG_LEN, (UINT16) xx);
+    test_add_segment (NCI_SPD_TYPE_SIGNATURE, 0x48, 0);
+
+    printf ("patch of %u bytes, %d segments, simulated download time:\n", test_patch_len, TEST_NUM_SRAM_SEGS + 2);
+
+    /* NFCC takes 0.4 ms per segment, host takes 0.3 ms per response */
+    sim_proc_us = 400;
+    sim_host_us = 300;
+    for (xx = 0; xx < (int) (sizeof (links) / sizeof (links[0])); xx++)
+    {
+        sim_byte_us = links[xx].byte_us;
+        for (yy = 0; yy < 4; yy++)
+            ms[yy] = test_run ((UINT8) (1 << yy), 8, -1);
+        printf ("%-12s window 1: %5.0f ms, 2: %5.0f ms, 4: %5.0f ms, 8: %5.0f ms\n",
+                links[xx].p_name, ms[0], ms[1], ms[2], ms[3]);
+        TEST_CHECK (ms[1] < ms[0]);
+    }
+
+    /* slow NFCC that queues 2 segments: rejects, then stop-and-wait */
+    sim_byte_us = 2.0;
+    sim_proc_us = 1500;
+    ms[0] = test_run (1, 2, -1);
+    TEST_CHECK (sim_rejects == 0);
+    ms[1] = test_run (8, 2, -1);
+    rejects = sim_rejects;
+    TEST_CHECK (rejects > 0);
+    TEST_CHECK (nfc_hal_cb.prm.spd_window == 1);
+    printf ("SPI 4M, NFCC queues 2: window 1: %.0f ms, window 8: %.0f ms (%d rejected, fell back to stop-and-wait)\n",
+            ms[0], ms[1], rejects);
+
+    /* a segment held for low power mode while others are in flight */
+    sim_proc_us = 400;
+    test_run (4, 8, 20);
+    TEST_CHECK (sim_park_seq == -1);
+
+    printf ("%s\n", test_failures ? "FAILED" : "PASSED");
+    return test_failures ? 1 : 0;
+}
@@ -32,8 +32,12 @@ extern "C"
 #define DISP_NCI    ProtoDispAdapterDisplayNciPacket
 void ProtoDispAdapterDisplayNciPacket (UINT8* nciPacket, UINT16 nciPacketLen, BOOLEAN is_recv);
 void ProtoDispAdapterUseRawOutput (BOOLEAN isUseRaw);
+void ProtoDispAdapterUseBinaryTrace (BOOLEAN enable, const char* dumpFile);
+void ProtoDispAdapterDumpNciTrace ();
 void ScrLog (UINT32 trace_set_mask, const char* fmt_str, ...);
 void LogMsg (UINT32 trace_set_mask, const char *fmt_str, ...);
+void LogMsgUseDeferredTrace (BOOLEAN enable);
+void LogMsgDrainDeferredTrace ();
 void LogMsg_0 (UINT32 trace_set_mask, const char *p_str);
 void LogMsg_1 (UINT32 trace_set_mask, const char *fmt_str, UINT32 p1);
 void LogMsg_2 (UINT32 trace_set_mask, const char *fmt_str, UINT32 p1, UINT32 p2);
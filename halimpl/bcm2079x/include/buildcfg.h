@@ -33,6 +33,8 @@ extern UINT8 *scru_dump_hex (UINT8 *p, char *p_title, UINT32 len, UINT32 trace_l
 void DispNci (UINT8 *p, UINT16 len, BOOLEAN is_recv);
 void ProtoDispAdapterDisplayNciPacket (UINT8* nciPacket, UINT16 nciPacketLen, BOOLEAN is_recv);
 #define DISP_NCI    ProtoDispAdapterDisplayNciPacket
+void ProtoDispAdapterDumpNciTrace ();
+#define DUMP_NCI_TRACE ProtoDispAdapterDumpNciTrace
 #define LOGMSG_TAG_NAME "NfcNciHal"
 
 
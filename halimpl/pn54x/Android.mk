@@ -60,7 +60,9 @@ LOCAL_PATH := $(call my-dir)
 include $(CLEAR_VARS)
 LOCAL_MODULE := nfc_nci.$(HAL_SUFFIX)
 LOCAL_MODULE_RELATIVE_PATH := hw
-LOCAL_SRC_FILES := $(call all-subdir-c-files)  $(call all-subdir-cpp-files)
+LOCAL_SRC_FILES := $(call all-subdir-c-files)  $(filter-out %_unittest.cpp, $(call all-subdir-cpp-files))
+LOCAL_SRC_FILES += ../../src/adaptation/Crc16.c
+LOCAL_SRC_FILES += ../../src/adaptation/NciTraceRing.c
 LOCAL_SHARED_LIBRARIES := liblog libcutils libhardware_legacy libdl libhardware
 
 LOCAL_CFLAGS := $(D_CFLAGS)
@@ -72,7 +74,8 @@ LOCAL_C_INCLUDES += \
     $(LOCAL_PATH)/hal \
     $(LOCAL_PATH)/log \
     $(LOCAL_PATH)/tml \
-    $(LOCAL_PATH)/self-test
+    $(LOCAL_PATH)/self-test \
+    $(LOCAL_PATH)/../../src/include
 
 LOCAL_CFLAGS += -DANDROID \
         -DNXP_UICC_ENABLE -DNXP_HW_SELF_TEST
@@ -80,3 +83,22 @@ LOCAL_CFLAGS += -DNFC_NXP_HFO_SETTINGS=FALSE
 #LOCAL_CFLAGS += -DFELICA_CLT_ENABLE
 
 include $(BUILD_SHARED_LIBRARY)
+
+
+######################################
+# Build host unit tests. Each test includes the source file it tests.
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := phNxpConfig_unittest
+LOCAL_MODULE_TAGS := tests
+LOCAL_SRC_FILES := utils/phNxpConfig_unittest.cpp
+LOCAL_STATIC_LIBRARIES := liblog
+LOCAL_LDLIBS := -lrt
+LOCAL_C_INCLUDES += \
+    $(LOCAL_PATH)/utils \
+    $(LOCAL_PATH)/inc \
+    $(LOCAL_PATH)/common \
+    $(LOCAL_PATH)/log \
+    $(LOCAL_PATH)/../../src/include
+LOCAL_CFLAGS := $(D_CFLAGS)
+include $(BUILD_HOST_EXECUTABLE)
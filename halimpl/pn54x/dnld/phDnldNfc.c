@@ -24,8 +24,38 @@
 #include <phTmlNfc.h>
 #include <phNxpLog.h>
 #include <dlfcn.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cutils/properties.h>
 #include <phNxpConfig.h>
 
+#if(NFC_NXP_CHIP_TYPE == PN548C2)
+#define PHDNLDNFC_DEFAULT_FW_PATH   "/system/vendor/firmware/libpn548ad_fw.so"
+#elif(NFC_NXP_CHIP_TYPE == PN551)
+#define PHDNLDNFC_DEFAULT_FW_PATH   "/system/vendor/firmware/libpn551_fw.so"
+#else
+#define PHDNLDNFC_DEFAULT_FW_PATH   "/system/vendor/firmware/libpn547_fw.so"
+#endif
+
+/* Version of the FW library last loaded, so that it is not loaded again
+ * only to be compared with the version of NFCC. The build fingerprint is
+ * part of the key as system images may keep file times across updates. */
+#define PHDNLDNFC_IMG_VER_PATH      "/data/nfc/libnfc-nxpFwImgVer.bin"
+#define PHDNLDNFC_IMG_VER_TMP_PATH  PHDNLDNFC_IMG_VER_PATH ".tmp"
+#define PHDNLDNFC_IMG_VER_MAGIC     (0x4E465756U)   /* "NFWV" */
+
+typedef struct phDnldNfc_ImgVer
+{
+    uint32_t dwMagic;
+    char     aBuildId[PROPERTY_VALUE_MAX];  /* ro.build.fingerprint */
+    char     aPathName[256];      /* FW library path */
+    uint64_t dwSize;              /* size of the FW library */
+    int64_t  dwMTime;             /* modification time of the FW library */
+    uint64_t dwIno;               /* inode of the FW library */
+    uint16_t wFwVer;              /* FW version of the image */
+}phDnldNfc_ImgVer_t;
+
 static void *pFwLibHandle; /* Global firmware lib handle used in this file only */
 uint16_t wMwVer = 0; /* Middleware version no */
 uint16_t wFwVer = 0; /* Firmware version no */
@@ -944,6 +974,119 @@ NFCSTATUS phDnldNfc_InitImgInfo(void)
 }
 
 
+/*******************************************************************************
+**
+** Function         phDnldNfc_InitImgVer
+**
+** Description      Gets the FW version of the image without loading the FW
+**                  library if it is unchanged since the last time it was
+**                  loaded. Otherwise same as phDnldNfc_InitImgInfo.
+**                  Image info is not available after this call, the download
+**                  sequence loads it with phDnldNfc_InitImgInfo.
+**
+** Parameters       None
+**
+** Returns          NFC status
+**
+*******************************************************************************/
+NFCSTATUS phDnldNfc_InitImgVer(void)
+{
+    NFCSTATUS wStatus;
+    phDnldNfc_ImgVer_t tImgVer;
+    phDnldNfc_ImgVer_t tCurrImgVer;
+    struct stat tStat;
+    char fwFileName[256];
+    FILE *pFile;
+    size_t wLen = 0;
+    int wPathLen;
+    bool_t bWritten = FALSE;
+
+#if(NFC_NXP_CHIP_TYPE != PN547C2)
+    if (gRecFWDwnld == TRUE)
+    {
+        return phDnldNfc_InitImgInfo();
+    }
+#endif
+
+    memset(&tCurrImgVer, 0, sizeof(tCurrImgVer));
+    tCurrImgVer.dwMagic = PHDNLDNFC_IMG_VER_MAGIC;
+    property_get("ro.build.fingerprint", tCurrImgVer.aBuildId, "");
+
+    /* same path as phDnldNfc_InitImgInfo */
+    if (GetNxpStrValue(NAME_NXP_FW_NAME, fwFileName, sizeof (fwFileName)) == TRUE)
+    {
+        wPathLen = snprintf(tCurrImgVer.aPathName, sizeof(tCurrImgVer.aPathName), "%s%s",
+                FW_DLL_ROOT_DIR, fwFileName);
+    }
+    else
+    {
+        wPathLen = snprintf(tCurrImgVer.aPathName, sizeof(tCurrImgVer.aPathName), "%s",
+                PHDNLDNFC_DEFAULT_FW_PATH);
+    }
+
+    /* a truncated path would stat another file, do not cache the version */
+    if ((wPathLen < 0) || ((size_t)wPathLen >= sizeof(tCurrImgVer.aPathName)))
+    {
+        NXPLOG_FWDNLD_W("FW path too long, image version not cached");
+        return phDnldNfc_InitImgInfo();
+    }
+
+    if (stat(tCurrImgVer.aPathName, &tStat) != 0)
+    {
+        return phDnldNfc_InitImgInfo();
+    }
+    tCurrImgVer.dwSize = (uint64_t)tStat.st_size;
+    tCurrImgVer.dwMTime = (int64_t)tStat.st_mtime;
+    tCurrImgVer.dwIno = (uint64_t)tStat.st_ino;
+
+    if ((pFile = fopen(PHDNLDNFC_IMG_VER_PATH, "rb")) != NULL)
+    {
+        wLen = fread(&tImgVer, 1, sizeof(tImgVer), pFile);
+        fclose(pFile);
+    }
+
+    if ((wLen == sizeof(tImgVer)) && (tImgVer.wFwVer != 0))
+    {
+        tCurrImgVer.wFwVer = tImgVer.wFwVer;
+        if (memcmp(&tImgVer, &tCurrImgVer, sizeof(tImgVer)) == 0)
+        {
+            wMwVer = (((uint16_t)(NXP_MW_VERSION_MAJ) << 8U) | (NXP_MW_VERSION_MIN));
+            wFwVer = tImgVer.wFwVer;
+            NXPLOG_FWDNLD_D("FW image unchanged, version 0x%x", wFwVer);
+            return NFCSTATUS_SUCCESS;
+        }
+    }
+
+    wStatus = phDnldNfc_InitImgInfo();
+    if (wStatus == NFCSTATUS_SUCCESS)
+    {
+        tCurrImgVer.wFwVer = wFwVer;
+
+        /* write a temp file and rename it, a reader never sees a partial record */
+        if ((pFile = fopen(PHDNLDNFC_IMG_VER_TMP_PATH, "wb")) != NULL)
+        {
+            if ((fwrite(&tCurrImgVer, 1, sizeof(tCurrImgVer), pFile) == sizeof(tCurrImgVer)) &&
+                (fflush(pFile) == 0) && (fsync(fileno(pFile)) == 0))
+            {
+                bWritten = TRUE;
+            }
+            if ((fclose(pFile) != 0) ||
+                (bWritten == FALSE) ||
+                (rename(PHDNLDNFC_IMG_VER_TMP_PATH, PHDNLDNFC_IMG_VER_PATH) != 0))
+            {
+                bWritten = FALSE;
+                unlink(PHDNLDNFC_IMG_VER_TMP_PATH);
+            }
+        }
+        if (bWritten == FALSE)
+        {
+            NXPLOG_FWDNLD_W("Unable to write %s", PHDNLDNFC_IMG_VER_PATH);
+        }
+    }
+
+    return wStatus;
+}
+
 /*******************************************************************************
 **
 ** Function         phDnldNfc_LoadRecInfo
@@ -1111,13 +1254,7 @@ NFCSTATUS phDnldNfc_LoadFW(const char* pathName, uint8_t **pImgInfo, uint16_t* p
     void* pImageInfoLen = NULL;
     if(pathName == NULL)
     {
-#if(NFC_NXP_CHIP_TYPE == PN548C2)
-        pathName = "/system/vendor/firmware/libpn548ad_fw.so";
-#elif(NFC_NXP_CHIP_TYPE == PN551)
-        pathName = "/system/vendor/firmware/libpn551_fw.so";
-#else
-        pathName = "/system/vendor/firmware/libpn547_fw.so";
-#endif
+        pathName = PHDNLDNFC_DEFAULT_FW_PATH;
     }
 
     /* check if the handle is not NULL then free the library */
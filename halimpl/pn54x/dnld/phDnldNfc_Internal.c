@@ -79,9 +79,12 @@ static void phDnldNfc_ProcessSeqState(void *pContext, phTmlNfc_TransactInfo_t *p
 static void phDnldNfc_ProcessRWSeqState(void *pContext, phTmlNfc_TransactInfo_t *pInfo);
 static NFCSTATUS phDnldNfc_ProcessFrame(void *pContext, phTmlNfc_TransactInfo_t *pInfo);
 static NFCSTATUS phDnldNfc_ProcessRecvInfo(void *pContext, phTmlNfc_TransactInfo_t *pInfo);
-static NFCSTATUS phDnldNfc_BuildFramePkt(pphDnldNfc_DlContext_t pDlContext);
-static NFCSTATUS phDnldNfc_CreateFramePld(pphDnldNfc_DlContext_t pDlContext);
+static NFCSTATUS phDnldNfc_BuildFramePkt(pphDnldNfc_DlContext_t pDlContext, pphDnldNfc_FrameInfo_t pFrameInfo);
+static NFCSTATUS phDnldNfc_CreateFramePld(pphDnldNfc_DlContext_t pDlContext, pphDnldNfc_FrameInfo_t pFrameInfo);
 static NFCSTATUS phDnldNfc_SetupResendTimer(pphDnldNfc_DlContext_t pDlContext);
+static bool_t phDnldNfc_PredictWrRsp(pphDnldNfc_RWInfo_t pRWInfo);
+static bool_t phDnldNfc_CmpRWInfo(pphDnldNfc_RWInfo_t pRWInfo1, pphDnldNfc_RWInfo_t pRWInfo2);
+static void phDnldNfc_PrebuildWrFrame(pphDnldNfc_DlContext_t pDlContext);
 static NFCSTATUS phDnldNfc_UpdateRsp(pphDnldNfc_DlContext_t   pDlContext, phTmlNfc_TransactInfo_t  *pInfo, uint16_t wPldLen);
 static void phDnldNfc_RspTimeOutCb(uint32_t TimerId, void *pContext);
 static void phDnldNfc_ResendTimeOutCb(uint32_t TimerId, void *pContext);
@@ -236,7 +239,7 @@ static void phDnldNfc_ProcessSeqState(void *pContext, phTmlNfc_TransactInfo_t *p
             }
             case phDnldNfc_StateSend:
             {
-                wStatus = phDnldNfc_BuildFramePkt(pDlCtxt);
+                wStatus = phDnldNfc_BuildFramePkt(pDlCtxt, &(pDlCtxt->tCmdRspFrameInfo));
 
                 if(NFCSTATUS_SUCCESS == wStatus)
                 {
@@ -374,6 +377,7 @@ static void phDnldNfc_ProcessRWSeqState(void *pContext, phTmlNfc_TransactInfo_t
     NFCSTATUS wStatus = NFCSTATUS_SUCCESS;
     NFCSTATUS wIntStatus = wStatus;
     uint32_t TimerId;
+    pphDnldNfc_FrameInfo_t pFrameInfo;
     pphDnldNfc_DlContext_t pDlCtxt = (pphDnldNfc_DlContext_t)pContext;
 
     if(NULL == pDlCtxt)
@@ -404,13 +408,20 @@ static void phDnldNfc_ProcessRWSeqState(void *pContext, phTmlNfc_TransactInfo_t
                         (pDlCtxt->TimerInfo.wTimerExpStatus) = 0;
                     }
                 }
+                (pDlCtxt->bPipeLineFrameReady) = FALSE;
+                (pDlCtxt->wNumWrFrames) = 0;
+                (pDlCtxt->wNumPipeLineFrames) = 0;
                 pDlCtxt->tCurrState = phDnldNfc_StateSend;
             }
             case phDnldNfc_StateSend:
             {
+                /* the response is read into tCmdRspFrameInfo, the last frame sent
+                   is kept in tWrFrameInfo for a resend after MEM_BSY */
+                pFrameInfo = &(pDlCtxt->tWrFrameInfo[pDlCtxt->bWrFrameIdx]);
+
                 if(FALSE == pDlCtxt->bResendLastFrame)
                 {
-                    wStatus = phDnldNfc_BuildFramePkt(pDlCtxt);
+                    wStatus = phDnldNfc_BuildFramePkt(pDlCtxt, pFrameInfo);
                 }
                 else
                 {
@@ -421,8 +432,8 @@ static void phDnldNfc_ProcessRWSeqState(void *pContext, phTmlNfc_TransactInfo_t
                 {
                     pDlCtxt->tCurrState = phDnldNfc_StateRecv;
 
-                    wStatus = phTmlNfc_Write((pDlCtxt->tCmdRspFrameInfo.aFrameBuff),
-                        (uint16_t)(pDlCtxt->tCmdRspFrameInfo.dwSendlength),
+                    wStatus = phTmlNfc_Write((pFrameInfo->aFrameBuff),
+                        (uint16_t)(pFrameInfo->dwSendlength),
                                     (pphTmlNfc_TransactCompletionCb_t)&phDnldNfc_ProcessRWSeqState,
                                     pDlCtxt);
                 }
@@ -462,6 +473,9 @@ static void phDnldNfc_ProcessRWSeqState(void *pContext, phTmlNfc_TransactInfo_t
 
                     /* set read status to pDlCtxt->wCmdSendStatus to enable callback */
                     pDlCtxt->wCmdSendStatus = wStatus;
+
+                    /* build the next write frame while NFCC processes this one */
+                    phDnldNfc_PrebuildWrFrame(pDlCtxt);
                     break;
                 }
                 else
@@ -519,13 +533,30 @@ static void phDnldNfc_ProcessRWSeqState(void *pContext, phTmlNfc_TransactInfo_t
                          NXPLOG_FWDNLD_W("Tml read abort failed!");
                     }
 
-                    wStatus = phDnldNfc_BuildFramePkt(pDlCtxt);
+                    /* the next frame goes into the buffer the last one was not sent from */
+                    (pDlCtxt->bWrFrameIdx) ^= 1;
+                    pFrameInfo = &(pDlCtxt->tWrFrameInfo[pDlCtxt->bWrFrameIdx]);
+
+                    if((TRUE == (pDlCtxt->bPipeLineFrameReady)) &&
+                        (TRUE == phDnldNfc_CmpRWInfo(&(pDlCtxt->tRWInfo), &(pDlCtxt->tPipeLineRWInfo))))
+                    {
+                        /* response is the expected one, the next frame is built already */
+                        (pDlCtxt->tRWInfo) = (pDlCtxt->tPipeLineNextRWInfo);
+                        (pDlCtxt->wNumPipeLineFrames)++;
+                        wStatus = NFCSTATUS_SUCCESS;
+                    }
+                    else
+                    {
+                        wStatus = phDnldNfc_BuildFramePkt(pDlCtxt, pFrameInfo);
+                    }
+                    (pDlCtxt->bPipeLineFrameReady) = FALSE;
+                    (pDlCtxt->wNumWrFrames)++;
 
                     if(NFCSTATUS_SUCCESS == wStatus)
                     {
                         pDlCtxt->tCurrState = phDnldNfc_StateRecv;
-                        wStatus = phTmlNfc_Write((pDlCtxt->tCmdRspFrameInfo.aFrameBuff),
-                            (uint16_t)(pDlCtxt->tCmdRspFrameInfo.dwSendlength),
+                        wStatus = phTmlNfc_Write((pFrameInfo->aFrameBuff),
+                            (uint16_t)(pFrameInfo->dwSendlength),
                                         (pphTmlNfc_TransactCompletionCb_t)&phDnldNfc_ProcessRWSeqState,
                                         pDlCtxt);
 
@@ -548,10 +579,17 @@ static void phDnldNfc_ProcessRWSeqState(void *pContext, phTmlNfc_TransactInfo_t
                          NXPLOG_FWDNLD_W("Tml read abort failed!");
                     }
 
+                    if(phDnldNfc_FTWrite == (pDlCtxt->FrameInp.Type))
+                    {
+                        NXPLOG_FWDNLD_D("Write frames sent - %d, built ahead - %d",
+                            (pDlCtxt->wNumWrFrames),(pDlCtxt->wNumPipeLineFrames));
+                    }
+
                     pDlCtxt->tCurrEvent = phDnldNfc_EventInvalid;
                     pDlCtxt->tDnldInProgress = phDnldNfc_TransitionIdle;
                     pDlCtxt->tCurrState = phDnldNfc_StateInit;
                     pDlCtxt->bResendLastFrame = FALSE;
+                    (pDlCtxt->bPipeLineFrameReady) = FALSE;
 
                     /* Delete the timer & reset timer primitives in context */
                     (void)phOsalNfc_Timer_Delete(pDlCtxt->TimerInfo.dwRspTimerId);
@@ -578,6 +616,140 @@ static void phDnldNfc_ProcessRWSeqState(void *pContext, phTmlNfc_TransactInfo_t
     return;
 }
 
+/*******************************************************************************
+**
+** Function         phDnldNfc_PredictWrRsp
+**
+** Description      Applies to pRWInfo the update phDnldNfc_UpdateRsp does on
+**                  a successful response to the write frame in flight
+**
+** Parameters       pRWInfo - Read/Write info to update
+**
+** Returns          TRUE if more write frames are to be sent after this one
+**
+*******************************************************************************/
+static bool_t phDnldNfc_PredictWrRsp(pphDnldNfc_RWInfo_t pRWInfo)
+{
+    uint16_t wLen = (pRWInfo->wBytesToSendRecv);
+
+    if(TRUE == (pRWInfo->bFramesSegmented))
+    {
+        if(FALSE == (pRWInfo->bFirstChunkResp))
+        {
+            /* PHDNLDNFC_FIRST_FRAGFRAME_RESP expected */
+            if((pRWInfo->wRemBytes) < (wLen + PHDNLDNFC_FRAME_HDR_LEN))
+            {
+                return FALSE;
+            }
+            (pRWInfo->bFirstChunkResp) = TRUE;
+            (pRWInfo->wRemBytes) -= (wLen + PHDNLDNFC_FRAME_HDR_LEN);
+        }
+        else
+        {
+            /* PHDNLDNFC_NEXT_FRAGFRAME_RESP expected */
+            if((pRWInfo->wRemBytes) < wLen)
+            {
+                return FALSE;
+            }
+            (pRWInfo->wRemBytes) -= wLen;
+        }
+        (pRWInfo->wRemChunkBytes) -= wLen;
+    }
+    else
+    {
+        /* PH_DL_STATUS_OK expected */
+        if((pRWInfo->wRemBytes) < wLen)
+        {
+            return FALSE;
+        }
+        if(TRUE == (pRWInfo->bFirstChunkResp))
+        {
+            (pRWInfo->wRemChunkBytes) -= wLen;
+            (pRWInfo->bFirstChunkResp) = FALSE;
+        }
+        (pRWInfo->wRemBytes) -= wLen;
+    }
+    (pRWInfo->wOffset) += wLen;
+    (pRWInfo->bFirstWrReq) = FALSE;
+
+    return (0 != (pRWInfo->wRemBytes)) ? TRUE : FALSE;
+}
+
+/*******************************************************************************
+**
+** Function         phDnldNfc_CmpRWInfo
+**
+** Description      Compares two Read/Write info
+**
+** Parameters       pRWInfo1 - Read/Write info
+**                  pRWInfo2 - Read/Write info
+**
+** Returns          TRUE if equal
+**
+*******************************************************************************/
+static bool_t phDnldNfc_CmpRWInfo(pphDnldNfc_RWInfo_t pRWInfo1, pphDnldNfc_RWInfo_t pRWInfo2)
+{
+    return (((pRWInfo1->dwAddr) == (pRWInfo2->dwAddr)) &&
+            ((pRWInfo1->wOffset) == (pRWInfo2->wOffset)) &&
+            ((pRWInfo1->wRemBytes) == (pRWInfo2->wRemBytes)) &&
+            ((pRWInfo1->wRemChunkBytes) == (pRWInfo2->wRemChunkBytes)) &&
+            ((pRWInfo1->wRWPldSize) == (pRWInfo2->wRWPldSize)) &&
+            ((pRWInfo1->wBytesToSendRecv) == (pRWInfo2->wBytesToSendRecv)) &&
+            ((pRWInfo1->wBytesRead) == (pRWInfo2->wBytesRead)) &&
+            ((pRWInfo1->bFramesSegmented) == (pRWInfo2->bFramesSegmented)) &&
+            ((pRWInfo1->bFirstWrReq) == (pRWInfo2->bFirstWrReq)) &&
+            ((pRWInfo1->bFirstChunkResp) == (pRWInfo2->bFirstChunkResp))) ? TRUE : FALSE;
+}
+
+/*******************************************************************************
+**
+** Function         phDnldNfc_PrebuildWrFrame
+**
+** Description      Builds the next write frame into the tWrFrameInfo buffer the
+**                  current one was not sent from, while NFCC processes the
+**                  current one, assuming it succeeds. The frame is then sent
+**                  from there, and the current one stays intact for a resend.
+**                  The frame is used only if tRWInfo after the response is
+**                  the one it was built for, otherwise it is built again.
+**
+** Parameters       pDlContext - pointer to the download context structure
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phDnldNfc_PrebuildWrFrame(pphDnldNfc_DlContext_t pDlContext)
+{
+    NFCSTATUS wStatus;
+    phDnldNfc_RWInfo_t tCurrRWInfo;
+
+    (pDlContext->bPipeLineFrameReady) = FALSE;
+
+    if(phDnldNfc_FTWrite != (pDlContext->FrameInp.Type))
+    {
+        return;
+    }
+
+    tCurrRWInfo = (pDlContext->tRWInfo);
+    (pDlContext->tPipeLineRWInfo) = tCurrRWInfo;
+
+    if(TRUE == phDnldNfc_PredictWrRsp(&(pDlContext->tPipeLineRWInfo)))
+    {
+        /* phDnldNfc_BuildFramePkt works on tRWInfo, restore it afterwards */
+        (pDlContext->tRWInfo) = (pDlContext->tPipeLineRWInfo);
+        wStatus = phDnldNfc_BuildFramePkt(pDlContext,
+            &(pDlContext->tWrFrameInfo[(pDlContext->bWrFrameIdx) ^ 1]));
+        (pDlContext->tPipeLineNextRWInfo) = (pDlContext->tRWInfo);
+        (pDlContext->tRWInfo) = tCurrRWInfo;
+
+        if(NFCSTATUS_SUCCESS == wStatus)
+        {
+            (pDlContext->bPipeLineFrameReady) = TRUE;
+        }
+    }
+
+    return;
+}
+
 /*******************************************************************************
 **
 ** Function         phDnldNfc_BuildFramePkt
@@ -585,18 +757,19 @@ static void phDnldNfc_ProcessRWSeqState(void *pContext, phTmlNfc_TransactInfo_t
 ** Description      Forms the frame packet
 **
 ** Parameters       pDlContext - pointer to the download context structure
+**                  pFrameInfo - frame buffer to build the frame into
 **
 ** Returns          NFC status
 **
 *******************************************************************************/
-static NFCSTATUS phDnldNfc_BuildFramePkt(pphDnldNfc_DlContext_t pDlContext)
+static NFCSTATUS phDnldNfc_BuildFramePkt(pphDnldNfc_DlContext_t pDlContext, pphDnldNfc_FrameInfo_t pFrameInfo)
 {
     NFCSTATUS wStatus = NFCSTATUS_SUCCESS;
     uint16_t wFrameLen = 0;
     uint16_t wCrcVal;
     uint8_t *pFrameByte;
 
-    if(NULL == pDlContext)
+    if((NULL == pDlContext) || (NULL == pFrameInfo))
     {
         NXPLOG_FWDNLD_E("Invalid Input Parameter!!");
         wStatus = PHNFCSTVAL(CID_NFC_DNLD,NFCSTATUS_INVALID_PARAMETER);
@@ -660,13 +833,13 @@ static NFCSTATUS phDnldNfc_BuildFramePkt(pphDnldNfc_DlContext_t pDlContext)
 
         if(NFCSTATUS_SUCCESS == wStatus)
         {
-            wStatus = phDnldNfc_CreateFramePld(pDlContext);
+            wStatus = phDnldNfc_CreateFramePld(pDlContext, pFrameInfo);
         }
 
         if(NFCSTATUS_SUCCESS == wStatus)
         {
             wFrameLen = 0;
-            wFrameLen  = (pDlContext->tCmdRspFrameInfo.dwSendlength);
+            wFrameLen  = (pFrameInfo->dwSendlength);
 
             if(phDnldNfc_FTRaw != (pDlContext->FrameInp.Type))
             {
@@ -674,11 +847,11 @@ static NFCSTATUS phDnldNfc_BuildFramePkt(pphDnldNfc_DlContext_t pDlContext)
                 {
                     pFrameByte = (uint8_t *)&wFrameLen;
 
-                    pDlContext->tCmdRspFrameInfo.aFrameBuff[PHDNLDNFC_FRAME_HDR_OFFSET] = pFrameByte[1];
-                    pDlContext->tCmdRspFrameInfo.aFrameBuff[PHDNLDNFC_FRAME_HDR_OFFSET + 1] = pFrameByte[0];
+                    pFrameInfo->aFrameBuff[PHDNLDNFC_FRAME_HDR_OFFSET] = pFrameByte[1];
+                    pFrameInfo->aFrameBuff[PHDNLDNFC_FRAME_HDR_OFFSET + 1] = pFrameByte[0];
 
                     NXPLOG_FWDNLD_D("Inserting FrameId ..");
-                    pDlContext->tCmdRspFrameInfo.aFrameBuff[PHDNLDNFC_FRAMEID_OFFSET] =
+                    pFrameInfo->aFrameBuff[PHDNLDNFC_FRAMEID_OFFSET] =
                         (pDlContext->tCmdId);
 
                     wFrameLen += PHDNLDNFC_FRAME_HDR_LEN;
@@ -695,8 +868,8 @@ static NFCSTATUS phDnldNfc_BuildFramePkt(pphDnldNfc_DlContext_t pDlContext)
 
                         pFrameByte = (uint8_t *)&wFrameLen;
 
-                        pDlContext->tCmdRspFrameInfo.aFrameBuff[PHDNLDNFC_FRAME_HDR_OFFSET] = pFrameByte[1];
-                        pDlContext->tCmdRspFrameInfo.aFrameBuff[PHDNLDNFC_FRAME_HDR_OFFSET + 1] = pFrameByte[0];
+                        pFrameInfo->aFrameBuff[PHDNLDNFC_FRAME_HDR_OFFSET] = pFrameByte[1];
+                        pFrameInfo->aFrameBuff[PHDNLDNFC_FRAME_HDR_OFFSET + 1] = pFrameByte[0];
 
                         /* To ensure we have no frag bit set for crc calculation */
                         wFrameLen = PHDNLDNFC_CLR_HDR_FRAGBIT(wFrameLen);
@@ -710,18 +883,18 @@ static NFCSTATUS phDnldNfc_BuildFramePkt(pphDnldNfc_DlContext_t pDlContext)
                     return NFCSTATUS_FAILED;
                 }
                 /* calculate CRC16 */
-                wCrcVal = phDnldNfc_CalcCrc16((pDlContext->tCmdRspFrameInfo.aFrameBuff),wFrameLen);
+                wCrcVal = phDnldNfc_CalcCrc16((pFrameInfo->aFrameBuff),wFrameLen);
 
                 pFrameByte = (uint8_t *)&wCrcVal;
 
                 /* Insert the computed Crc value */
-                pDlContext->tCmdRspFrameInfo.aFrameBuff[wFrameLen] = pFrameByte[1];
-                pDlContext->tCmdRspFrameInfo.aFrameBuff[wFrameLen+ 1] = pFrameByte[0];
+                pFrameInfo->aFrameBuff[wFrameLen] = pFrameByte[1];
+                pFrameInfo->aFrameBuff[wFrameLen+ 1] = pFrameByte[0];
 
                 wFrameLen += PHDNLDNFC_FRAME_CRC_LEN;
             }
 
-            (pDlContext->tCmdRspFrameInfo.dwSendlength) = wFrameLen;
+            (pFrameInfo->dwSendlength) = wFrameLen;
             NXPLOG_FWDNLD_D("Frame created successfully");
         }
         else
@@ -741,45 +914,46 @@ static NFCSTATUS phDnldNfc_BuildFramePkt(pphDnldNfc_DlContext_t pDlContext)
 ** Description      Forms the frame payload
 **
 ** Parameters       pDlContext - pointer to the download context structure
+**                  pFrameInfo - frame buffer to build the frame into
 **
 ** Returns          NFC status
 **
 *******************************************************************************/
-static NFCSTATUS phDnldNfc_CreateFramePld(pphDnldNfc_DlContext_t pDlContext)
+static NFCSTATUS phDnldNfc_CreateFramePld(pphDnldNfc_DlContext_t pDlContext, pphDnldNfc_FrameInfo_t pFrameInfo)
 {
     NFCSTATUS wStatus = NFCSTATUS_SUCCESS;
     uint16_t wBuffIdx = 0;
     uint16_t wChkIntgVal = 0;
     uint16_t wFrameLen = 0;
 
-    if(NULL == pDlContext)
+    if((NULL == pDlContext) || (NULL == pFrameInfo))
     {
         NXPLOG_FWDNLD_E("Invalid Input Parameter!!");
         wStatus = PHNFCSTVAL(CID_NFC_DNLD,NFCSTATUS_INVALID_PARAMETER);
     }
     else
     {
-        memset((pDlContext->tCmdRspFrameInfo.aFrameBuff),0,PHDNLDNFC_CMDRESP_MAX_BUFF_SIZE);
-        (pDlContext->tCmdRspFrameInfo.dwSendlength) = 0;
+        memset((pFrameInfo->aFrameBuff),0,PHDNLDNFC_CMDRESP_MAX_BUFF_SIZE);
+        (pFrameInfo->dwSendlength) = 0;
 
         if(phDnldNfc_FTNone == (pDlContext->FrameInp.Type))
         {
-            (pDlContext->tCmdRspFrameInfo.dwSendlength) += PHDNLDNFC_MIN_PLD_LEN;
+            (pFrameInfo->dwSendlength) += PHDNLDNFC_MIN_PLD_LEN;
         }
         else if(phDnldNfc_ChkIntg == (pDlContext->FrameInp.Type))
         {
-            (pDlContext->tCmdRspFrameInfo.dwSendlength) += PHDNLDNFC_MIN_PLD_LEN;
+            (pFrameInfo->dwSendlength) += PHDNLDNFC_MIN_PLD_LEN;
 
             wChkIntgVal = PHDNLDNFC_USERDATA_EEPROM_OFFSET;
-            memcpy(&(pDlContext->tCmdRspFrameInfo.aFrameBuff[PHDNLDNFC_FRAME_RDDATA_OFFSET]),
+            memcpy(&(pFrameInfo->aFrameBuff[PHDNLDNFC_FRAME_RDDATA_OFFSET]),
                         &wChkIntgVal,sizeof(wChkIntgVal));
 
             wChkIntgVal = PHDNLDNFC_USERDATA_EEPROM_LEN;
-            memcpy(&(pDlContext->tCmdRspFrameInfo.aFrameBuff[PHDNLDNFC_FRAME_RDDATA_OFFSET +
+            memcpy(&(pFrameInfo->aFrameBuff[PHDNLDNFC_FRAME_RDDATA_OFFSET +
                 PHDNLDNFC_USERDATA_EEPROM_OFFSIZE]),&wChkIntgVal,sizeof(wChkIntgVal));
 
-            (pDlContext->tCmdRspFrameInfo.dwSendlength) += PHDNLDNFC_USERDATA_EEPROM_LENSIZE;
-            (pDlContext->tCmdRspFrameInfo.dwSendlength) += PHDNLDNFC_USERDATA_EEPROM_OFFSIZE;
+            (pFrameInfo->dwSendlength) += PHDNLDNFC_USERDATA_EEPROM_LENSIZE;
+            (pFrameInfo->dwSendlength) += PHDNLDNFC_USERDATA_EEPROM_OFFSIZE;
         }
         else if(phDnldNfc_FTWrite == (pDlContext->FrameInp.Type))
         {
@@ -814,7 +988,7 @@ static NFCSTATUS phDnldNfc_CreateFramePld(pphDnldNfc_DlContext_t pDlContext)
                     (pDlContext->tRWInfo.bFramesSegmented) = FALSE;
                 }
 
-                memcpy(&(pDlContext->tCmdRspFrameInfo.aFrameBuff[PHDNLDNFC_FRAMEID_OFFSET]),
+                memcpy(&(pFrameInfo->aFrameBuff[PHDNLDNFC_FRAMEID_OFFSET]),
                         &(pDlContext->tUserData.pBuff[wBuffIdx]),(pDlContext->tRWInfo.wBytesToSendRecv));
             }
             else
@@ -822,10 +996,10 @@ static NFCSTATUS phDnldNfc_CreateFramePld(pphDnldNfc_DlContext_t pDlContext)
                 (pDlContext->tRWInfo.wRWPldSize) = 0;
                 (pDlContext->tRWInfo.wBytesToSendRecv) = (wFrameLen + PHDNLDNFC_FRAME_HDR_LEN);
 
-                memcpy(&(pDlContext->tCmdRspFrameInfo.aFrameBuff[0]),
+                memcpy(&(pFrameInfo->aFrameBuff[0]),
                     &(pDlContext->tUserData.pBuff[wBuffIdx]),(pDlContext->tRWInfo.wBytesToSendRecv));
             }
-            (pDlContext->tCmdRspFrameInfo.dwSendlength) += (pDlContext->tRWInfo.wBytesToSendRecv);
+            (pFrameInfo->dwSendlength) += (pDlContext->tRWInfo.wBytesToSendRecv);
         }
         else if(phDnldNfc_FTRead == (pDlContext->FrameInp.Type))
         {
@@ -836,35 +1010,35 @@ static NFCSTATUS phDnldNfc_CreateFramePld(pphDnldNfc_DlContext_t pDlContext)
             wBuffIdx = (PHDNLDNFC_PLD_OFFSET + ((sizeof(pDlContext->tRWInfo.wBytesToSendRecv))
                         % PHDNLDNFC_MIN_PLD_LEN) - 1);
 
-            memcpy(&(pDlContext->tCmdRspFrameInfo.aFrameBuff[wBuffIdx]),
+            memcpy(&(pFrameInfo->aFrameBuff[wBuffIdx]),
                 &(pDlContext->tRWInfo.wBytesToSendRecv),(sizeof(pDlContext->tRWInfo.wBytesToSendRecv)));
 
             wBuffIdx += sizeof(pDlContext->tRWInfo.wBytesToSendRecv);
 
-            memcpy(&(pDlContext->tCmdRspFrameInfo.aFrameBuff[wBuffIdx]),
+            memcpy(&(pFrameInfo->aFrameBuff[wBuffIdx]),
                 &(pDlContext->tRWInfo.dwAddr),sizeof(pDlContext->tRWInfo.dwAddr));
 
-            (pDlContext->tCmdRspFrameInfo.dwSendlength) += (PHDNLDNFC_MIN_PLD_LEN +
+            (pFrameInfo->dwSendlength) += (PHDNLDNFC_MIN_PLD_LEN +
                 (sizeof(pDlContext->tRWInfo.dwAddr)));
         }
         else if(phDnldNfc_FTLog == (pDlContext->FrameInp.Type))
         {
-            (pDlContext->tCmdRspFrameInfo.dwSendlength) += PHDNLDNFC_MIN_PLD_LEN;
+            (pFrameInfo->dwSendlength) += PHDNLDNFC_MIN_PLD_LEN;
 
             wBuffIdx = (PHDNLDNFC_MIN_PLD_LEN + PHDNLDNFC_FRAME_HDR_LEN);
 
-            memcpy(&(pDlContext->tCmdRspFrameInfo.aFrameBuff[wBuffIdx]),
+            memcpy(&(pFrameInfo->aFrameBuff[wBuffIdx]),
                 (pDlContext->tUserData.pBuff),(pDlContext->tUserData.wLen));
 
-            (pDlContext->tCmdRspFrameInfo.dwSendlength) += (pDlContext->tUserData.wLen);
+            (pFrameInfo->dwSendlength) += (pDlContext->tUserData.wLen);
         }
         else if(phDnldNfc_FTForce == (pDlContext->FrameInp.Type))
         {
-            (pDlContext->tCmdRspFrameInfo.dwSendlength) += PHDNLDNFC_MIN_PLD_LEN;
+            (pFrameInfo->dwSendlength) += PHDNLDNFC_MIN_PLD_LEN;
 
             wBuffIdx = PHDNLDNFC_PLD_OFFSET;
 
-            memcpy(&(pDlContext->tCmdRspFrameInfo.aFrameBuff[wBuffIdx]),
+            memcpy(&(pFrameInfo->aFrameBuff[wBuffIdx]),
                 (pDlContext->tUserData.pBuff),(pDlContext->tUserData.wLen));
         }
         else if(phDnldNfc_FTRaw == (pDlContext->FrameInp.Type))
@@ -876,10 +1050,10 @@ static NFCSTATUS phDnldNfc_CreateFramePld(pphDnldNfc_DlContext_t pDlContext)
             }
             else
             {
-                memcpy(&(pDlContext->tCmdRspFrameInfo.aFrameBuff[wBuffIdx]),
+                memcpy(&(pFrameInfo->aFrameBuff[wBuffIdx]),
                     (pDlContext->tUserData.pBuff),(pDlContext->tUserData.wLen));
 
-                (pDlContext->tCmdRspFrameInfo.dwSendlength) += (pDlContext->tUserData.wLen);
+                (pFrameInfo->dwSendlength) += (pDlContext->tUserData.wLen);
             }
         }
         else
@@ -164,8 +164,14 @@ typedef struct phDnldNfc_DlContext
     void*                   UserCtxt  ;            /* Pointer to upper layer context */
     phDnldNfc_Buff_t        tUserData;             /* Data buffer provided by caller */
     phDnldNfc_Buff_t        tRspBuffInfo;          /* Buffer to store payload field of the received response*/
-    phDnldNfc_FrameInfo_t   tCmdRspFrameInfo;      /* Buffer to hold the cmd/resp frame except pipeline write */
-    phDnldNfc_FrameInfo_t   tPipeLineWrFrameInfo;  /* Buffer to hold the pipelined write frame */
+    phDnldNfc_FrameInfo_t   tCmdRspFrameInfo;      /* Buffer to hold the cmd/resp frame except read/write sequence cmds */
+    phDnldNfc_FrameInfo_t   tWrFrameInfo[2];       /* Read/write sequence cmd frames, one sent and one built ahead */
+    uint8_t                 bWrFrameIdx;           /* Index in tWrFrameInfo of the last frame sent */
+    bool_t                  bPipeLineFrameReady;   /* Flag to indicate the next write frame is built in the other tWrFrameInfo */
+    phDnldNfc_RWInfo_t      tPipeLineRWInfo;       /* Read/Write info the pipelined write frame was built for */
+    phDnldNfc_RWInfo_t      tPipeLineNextRWInfo;   /* Read/Write info once the pipelined write frame is built */
+    uint16_t                wNumWrFrames;          /* Number of write frames sent after the first one */
+    uint16_t                wNumPipeLineFrames;    /* Number of them which were built while the previous was in flight */
     NFCSTATUS  wCmdSendStatus;                     /* Holds the status of cmd request made to cmd handler */
     phDnldNfc_CmdId_t       tCmdId;                /* Cmd Id of the currently processed cmd */
     phDnldNfc_FrameInput_t  FrameInp;              /* input value required for current cmd in process */
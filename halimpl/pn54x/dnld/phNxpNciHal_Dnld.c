@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <time.h>
 #include <phTmlNfc.h>
 #include <phDnldNfc.h>
 #include <phNxpNciHal_Dnld.h>
@@ -163,6 +164,8 @@ static void phNxpNciHal_fw_dnld_recover_cb(void* pContext, NFCSTATUS status,
 
 static NFCSTATUS phNxpNciHal_fw_seq_handler(NFCSTATUS (*seq_handler[])(void* pContext, NFCSTATUS status, void* pInfo));
 
+static uint32_t phNxpNciHal_fw_elapsed_ms(struct timespec *pStart);
+
 /* Array of pointers to start fw download seq */
 static NFCSTATUS (*phNxpNciHal_dwnld_seqhandler[])(
         void* pContext, NFCSTATUS status, void* pInfo) = {
@@ -1599,6 +1602,25 @@ clean_and_return:
 
 }
 
+/*******************************************************************************
+**
+** Function         phNxpNciHal_fw_elapsed_ms
+**
+** Description      Time elapsed since pStart, used to report the time spent
+**                  in each phase of the download
+**
+** Returns          milliseconds
+**
+*******************************************************************************/
+static uint32_t phNxpNciHal_fw_elapsed_ms(struct timespec *pStart)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t) ((now.tv_sec - pStart->tv_sec) * 1000 +
+            (now.tv_nsec - pStart->tv_nsec) / 1000000);
+}
+
 /*******************************************************************************
 **
 ** Function         phNxpNciHal_fw_seq_handler
@@ -1614,6 +1636,7 @@ static NFCSTATUS phNxpNciHal_fw_seq_handler(NFCSTATUS (*seq_handler[])(void* pCo
     int16_t seq_counter = 0;
     phDnldNfc_Buff_t pInfo;
     NFCSTATUS status = NFCSTATUS_FAILED;
+    struct timespec tStart;
 
     status = phTmlNfc_ReadAbort();
     if(NFCSTATUS_SUCCESS != status)
@@ -1625,7 +1648,10 @@ static NFCSTATUS phNxpNciHal_fw_seq_handler(NFCSTATUS (*seq_handler[])(void* pCo
     while(seq_handler[seq_counter] != NULL )
     {
         status = NFCSTATUS_FAILED;
+        clock_gettime(CLOCK_MONOTONIC, &tStart);
         status = (seq_handler[seq_counter])(pContext, status, &pInfo );
+        NXPLOG_FWDNLD_D("FW download step %d took %u ms", seq_counter,
+                phNxpNciHal_fw_elapsed_ms(&tStart));
         if(NFCSTATUS_SUCCESS != status)
         {
             NXPLOG_FWDNLD_E(" phNxpNciHal_fw_seq_handler : FAILED");
@@ -1861,6 +1887,9 @@ NFCSTATUS phNxpNciHal_fw_download_seq(uint8_t bClkSrcVal, uint8_t bClkFreqVal)
     NFCSTATUS status = NFCSTATUS_FAILED;
     phDnldNfc_Buff_t pInfo;
     char *pContext = "FW-Download";
+    struct timespec tStart;
+
+    clock_gettime(CLOCK_MONOTONIC, &tStart);
 
     /* reset the global flags */
     gphNxpNciHal_fw_IoctlCtx.IoctlCode = NFC_FW_DOWNLOAD;
@@ -1880,7 +1909,8 @@ NFCSTATUS phNxpNciHal_fw_download_seq(uint8_t bClkSrcVal, uint8_t bClkFreqVal)
     /* Get firmware version */
     if (NFCSTATUS_SUCCESS == phDnldNfc_InitImgInfo())
     {
-        NXPLOG_FWDNLD_D("phDnldNfc_InitImgInfo:SUCCESS");
+        NXPLOG_FWDNLD_D("phDnldNfc_InitImgInfo:SUCCESS, image loaded in %u ms",
+                phNxpNciHal_fw_elapsed_ms(&tStart));
 #if(NFC_NXP_CHIP_TYPE != PN547C2)
         if (gRecFWDwnld == TRUE)
         {
@@ -1899,6 +1929,7 @@ NFCSTATUS phNxpNciHal_fw_download_seq(uint8_t bClkSrcVal, uint8_t bClkFreqVal)
 
     /* Chage to normal mode */
     status = phNxpNciHal_fw_dnld_complete(pContext, status, &pInfo);
+    NXPLOG_FWDNLD_D("FW download sequence took %u ms", phNxpNciHal_fw_elapsed_ms(&tStart));
     /*if (NFCSTATUS_SUCCESS == status)
     {
         NXPLOG_FWDNLD_D(" phNxpNciHal_fw_dnld_complete : SUCCESS");
@@ -26,10 +26,14 @@
 #include <phNxpConfig.h>
 #include <phNxpNciHal_NfcDepSWPrio.h>
 #include <phNxpNciHal_Kovio.h>
+#include <phNxpNciHal_ConfigCache.h>
+#include <NciTraceRing.h>
 /*********************** Global Variables *************************************/
 #define PN547C2_CLOCK_SETTING
 #undef  PN547C2_FACTORY_RESET_DEBUG
 #define CORE_RES_STATUS_BYTE 3
+/* Binary NCI trace dump, see NXP_NCI_TRACE_RING in libnfc-nxp.conf */
+#define NXP_NCI_TRACE_DUMP_FILE "/data/nfc/nci_trace_hal.bin"
 
 /* Processing of ISO 15693 EOF */
 extern uint8_t icode_send_eof;
@@ -456,10 +460,17 @@ int phNxpNciHal_open(nfc_stack_callback_t *p_cback, nfc_stack_data_callback_t *p
 
     int init_retry_cnt= 0;
     int8_t ret_val = 0x00;
+    unsigned long num = 0;
 
     /* initialize trace level */
     phNxpLog_InitializeLogLevel();
 
+    /* keep NCI packets in memory, dump them on error */
+    if (GetNxpNumValue(NAME_NXP_NCI_TRACE_RING, &num, sizeof(num)) && (num == 1))
+    {
+        nciTraceRingEnable(1, NXP_NCI_TRACE_DUMP_FILE);
+    }
+
     /*Create the timer for extns write response*/
     timeoutTimerId = phOsalNfc_Timer_Create();
 
@@ -596,7 +607,7 @@ init_retry:
     }
     phNxpNciHal_enable_i2c_fragmentation();
     /*Get FW version from device*/
-    status = phDnldNfc_InitImgInfo();
+    status = phDnldNfc_InitImgVer();
     NXPLOG_NCIHAL_D ("FW version for FW file = 0x%x", wFwVer);
     NXPLOG_NCIHAL_D ("FW version from device = 0x%x", wFwVerRsp);
     if ((wFwVerRsp & 0x0000FFFF) == wFwVer)
@@ -791,6 +802,9 @@ int phNxpNciHal_write(uint16_t data_len, const uint8_t *p_data)
         }
     }
 
+    /* Settings of the config cache may be changed by libnfc-nci */
+    phNxpNciHal_cfg_cache_check_cmd(nxpncihal_ctrl.cmd_len, nxpncihal_ctrl.p_cmd_data);
+
     /* Check for NXP ext before sending write */
     status = phNxpNciHal_write_ext(&nxpncihal_ctrl.cmd_len,
             nxpncihal_ctrl.p_cmd_data, &nxpncihal_ctrl.rsp_len,
@@ -1044,6 +1058,30 @@ void read_retry()
         /* TODO: Not sure how to handle this ? */
     }
 }
+/******************************************************************************
+ * Function         phNxpNciHal_get_cfg_array
+ *
+ * Description      This function copies a byte array setting of the core init
+ *                  config snapshot into p_buffer, to be sent to NFCC.
+ *
+ * Returns          Length of the setting, 0 if not set or longer than bufflen.
+ *
+ ******************************************************************************/
+static long phNxpNciHal_get_cfg_array(const tNXP_CORE_INIT_CONFIG *p_cfg, int id,
+        uint8_t *p_buffer, long bufflen)
+{
+    const tNXP_CFG_ARRAY *p_array = &p_cfg->array[id];
+
+    if (p_array->len > bufflen)
+    {
+        NXPLOG_NCIHAL_E("Config setting %d is %ld bytes, longer than %ld", id, p_array->len, bufflen);
+        return 0;
+    }
+    if (p_array->len > 0)
+        memcpy(p_buffer, p_array->p_value, p_array->len);
+    return p_array->len;
+}
+
 /******************************************************************************
  * Function         phNxpNciHal_core_initialized
  *
@@ -1070,7 +1108,7 @@ int phNxpNciHal_core_initialized(uint8_t* p_core_init_rsp_params)
     uint8_t *buffer = NULL;
     long bufflen = 260;
     long retlen = 0;
-    int isfound;
+    const tNXP_CORE_INIT_CONFIG *p_cfg;
     /* Temp fix to re-apply the proper clock setting */
     int temp_fix = 1;
     unsigned long num = 0;
@@ -1091,6 +1129,8 @@ int phNxpNciHal_core_initialized(uint8_t* p_core_init_rsp_params)
     {
 retry_core_init:
         config_access = FALSE;
+        /* settings may have been partly applied */
+        phNxpNciHal_cfg_cache_invalidate();
         if(buffer != NULL)
         {
             free(buffer);
@@ -1140,16 +1180,17 @@ retry_core_init:
     }
 // recovery --end
 
+    phNxpNciHal_cfg_cache_begin(wFwVerRsp, (fw_download_success == 1));
 
     buffer = (uint8_t*) malloc(bufflen*sizeof(uint8_t));
     if(NULL == buffer)
     {
         return NFCSTATUS_FAILED;
     }
+    p_cfg = GetNxpCoreInitConfig();
     config_access = TRUE;
     retlen = 0;
-    isfound = GetNxpByteArrayValue(NAME_NXP_ACT_PROP_EXTN, (char *) buffer,
-            bufflen, &retlen);
+    retlen = phNxpNciHal_get_cfg_array(p_cfg, NXP_CFG_ACT_PROP_EXTN, buffer, bufflen);
     if (retlen > 0) {
         /* NXP ACT Proprietary Ext */
         status = phNxpNciHal_send_ext_cmd(retlen, buffer);
@@ -1221,8 +1262,7 @@ retry_core_init:
     phNxpNciHal_check_factory_reset();
     retlen = 0;
     config_access = TRUE;
-    isfound = GetNxpByteArrayValue(NAME_NXP_NFC_PROFILE_EXTN, (char *) buffer,
-            bufflen, &retlen);
+    retlen = phNxpNciHal_get_cfg_array(p_cfg, NXP_CFG_NFC_PROFILE_EXTN, buffer, bufflen);
     if (retlen > 0) {
         /* NXP ACT Proprietary Ext */
         status = phNxpNciHal_send_ext_cmd(retlen, buffer);
@@ -1233,7 +1273,9 @@ retry_core_init:
         }
     }
 
-    if(isNxpConfigModified() || (fw_download_success == 1))
+    /* Settings kept in NFCC EEPROM: with a warm cache, only the ones not
+     * applied by the last enable are sent */
+    if(isNxpConfigModified() || (fw_download_success == 1) || !phNxpNciHal_cfg_cache_is_warm())
     {
 
         retlen = 0;
@@ -1241,42 +1283,45 @@ retry_core_init:
 
 #if(NFC_NXP_CHIP_TYPE != PN547C2)
         NXPLOG_NCIHAL_D ("Performing TVDD Settings");
-        isfound = GetNxpNumValue(NAME_NXP_EXT_TVDD_CFG, &num, sizeof(num));
-        if (isfound > 0) {
+        if (NXP_CFG_IS_SET(p_cfg, NXP_CFG_EXT_TVDD_CFG)) {
+            num = p_cfg->ext_tvdd_cfg;
             if(num == 1) {
-                isfound = GetNxpByteArrayValue(NAME_NXP_EXT_TVDD_CFG_1, (char *) buffer,
-                        bufflen, &retlen);
-                if (retlen > 0) {
+                retlen = phNxpNciHal_get_cfg_array(p_cfg, NXP_CFG_EXT_TVDD_CFG_1, buffer, bufflen);
+                if ((retlen > 0) &&
+                    !phNxpNciHal_cfg_cache_lookup(NXP_CFG_CACHE_TVDD_CFG, retlen, buffer)) {
                     status = phNxpNciHal_send_ext_cmd(retlen, buffer);
                     if (status != NFCSTATUS_SUCCESS) {
                         NXPLOG_NCIHAL_E("EXT TVDD CFG 1 Settings failed");
                         retry_core_init_cnt++;
                         goto retry_core_init;
                     }
+                    phNxpNciHal_cfg_cache_update(NXP_CFG_CACHE_TVDD_CFG, retlen, buffer);
                 }
             }
             else if(num == 2) {
-                isfound = GetNxpByteArrayValue(NAME_NXP_EXT_TVDD_CFG_2, (char *) buffer,
-                        bufflen, &retlen);
-                    if (retlen > 0) {
+                retlen = phNxpNciHal_get_cfg_array(p_cfg, NXP_CFG_EXT_TVDD_CFG_2, buffer, bufflen);
+                    if ((retlen > 0) &&
+                    !phNxpNciHal_cfg_cache_lookup(NXP_CFG_CACHE_TVDD_CFG, retlen, buffer)) {
                     status = phNxpNciHal_send_ext_cmd(retlen, buffer);
                     if (status != NFCSTATUS_SUCCESS) {
                         NXPLOG_NCIHAL_E("EXT TVDD CFG 2 Settings failed");
                         retry_core_init_cnt++;
                         goto retry_core_init;
                     }
+                    phNxpNciHal_cfg_cache_update(NXP_CFG_CACHE_TVDD_CFG, retlen, buffer);
                 }
             }
             else if(num == 3) {
-                isfound = GetNxpByteArrayValue(NAME_NXP_EXT_TVDD_CFG_3, (char *) buffer,
-                        bufflen, &retlen);
-                    if (retlen > 0) {
+                retlen = phNxpNciHal_get_cfg_array(p_cfg, NXP_CFG_EXT_TVDD_CFG_3, buffer, bufflen);
+                    if ((retlen > 0) &&
+                    !phNxpNciHal_cfg_cache_lookup(NXP_CFG_CACHE_TVDD_CFG, retlen, buffer)) {
                     status = phNxpNciHal_send_ext_cmd(retlen, buffer);
                     if (status != NFCSTATUS_SUCCESS) {
                         NXPLOG_NCIHAL_E("EXT TVDD CFG 3 Settings failed");
                         retry_core_init_cnt++;
                         goto retry_core_init;
                     }
+                    phNxpNciHal_cfg_cache_update(NXP_CFG_CACHE_TVDD_CFG, retlen, buffer);
                 }
             }
             else {
@@ -1290,9 +1335,9 @@ retry_core_init:
         config_access = FALSE;
 #endif
         NXPLOG_NCIHAL_D ("Performing RF Settings BLK 1");
-        isfound = GetNxpByteArrayValue(NAME_NXP_RF_CONF_BLK_1, (char *) buffer,
-                bufflen, &retlen);
-        if (retlen > 0) {
+        retlen = phNxpNciHal_get_cfg_array(p_cfg, NXP_CFG_RF_CONF_BLK_1, buffer, bufflen);
+        if ((retlen > 0) &&
+            !phNxpNciHal_cfg_cache_lookup(NXP_CFG_CACHE_RF_CONF_BLK_1, retlen, buffer)) {
             status = phNxpNciHal_send_ext_cmd(retlen, buffer);
 #if(NFC_NXP_CHIP_TYPE != PN547C2)
             if (status == NFCSTATUS_SUCCESS)
@@ -1313,13 +1358,15 @@ retry_core_init:
                 retry_core_init_cnt++;
                 goto retry_core_init;
             }
+            if (status == NFCSTATUS_SUCCESS)
+                phNxpNciHal_cfg_cache_update(NXP_CFG_CACHE_RF_CONF_BLK_1, retlen, buffer);
         }
         retlen = 0;
 
         NXPLOG_NCIHAL_D ("Performing RF Settings BLK 2");
-        isfound = GetNxpByteArrayValue(NAME_NXP_RF_CONF_BLK_2, (char *) buffer,
-                bufflen, &retlen);
-        if (retlen > 0) {
+        retlen = phNxpNciHal_get_cfg_array(p_cfg, NXP_CFG_RF_CONF_BLK_2, buffer, bufflen);
+        if ((retlen > 0) &&
+            !phNxpNciHal_cfg_cache_lookup(NXP_CFG_CACHE_RF_CONF_BLK_2, retlen, buffer)) {
             status = phNxpNciHal_send_ext_cmd(retlen, buffer);
 #if(NFC_NXP_CHIP_TYPE != PN547C2)
             if (status == NFCSTATUS_SUCCESS)
@@ -1340,13 +1387,15 @@ retry_core_init:
                 retry_core_init_cnt++;
                 goto retry_core_init;
             }
+            if (status == NFCSTATUS_SUCCESS)
+                phNxpNciHal_cfg_cache_update(NXP_CFG_CACHE_RF_CONF_BLK_2, retlen, buffer);
         }
         retlen = 0;
 
         NXPLOG_NCIHAL_D ("Performing RF Settings BLK 3");
-        isfound = GetNxpByteArrayValue(NAME_NXP_RF_CONF_BLK_3, (char *) buffer,
-                bufflen, &retlen);
-        if (retlen > 0) {
+        retlen = phNxpNciHal_get_cfg_array(p_cfg, NXP_CFG_RF_CONF_BLK_3, buffer, bufflen);
+        if ((retlen > 0) &&
+            !phNxpNciHal_cfg_cache_lookup(NXP_CFG_CACHE_RF_CONF_BLK_3, retlen, buffer)) {
             status = phNxpNciHal_send_ext_cmd(retlen, buffer);
 #if(NFC_NXP_CHIP_TYPE != PN547C2)
             if (status == NFCSTATUS_SUCCESS)
@@ -1367,13 +1416,15 @@ retry_core_init:
                 retry_core_init_cnt++;
                 goto retry_core_init;
             }
+            if (status == NFCSTATUS_SUCCESS)
+                phNxpNciHal_cfg_cache_update(NXP_CFG_CACHE_RF_CONF_BLK_3, retlen, buffer);
         }
         retlen = 0;
 
         NXPLOG_NCIHAL_D ("Performing RF Settings BLK 4");
-        isfound = GetNxpByteArrayValue(NAME_NXP_RF_CONF_BLK_4, (char *) buffer,
-                bufflen, &retlen);
-        if (retlen > 0) {
+        retlen = phNxpNciHal_get_cfg_array(p_cfg, NXP_CFG_RF_CONF_BLK_4, buffer, bufflen);
+        if ((retlen > 0) &&
+            !phNxpNciHal_cfg_cache_lookup(NXP_CFG_CACHE_RF_CONF_BLK_4, retlen, buffer)) {
             status = phNxpNciHal_send_ext_cmd(retlen, buffer);
 #if(NFC_NXP_CHIP_TYPE != PN547C2)
             if (status == NFCSTATUS_SUCCESS)
@@ -1394,13 +1445,15 @@ retry_core_init:
                 retry_core_init_cnt++;
                 goto retry_core_init;
             }
+            if (status == NFCSTATUS_SUCCESS)
+                phNxpNciHal_cfg_cache_update(NXP_CFG_CACHE_RF_CONF_BLK_4, retlen, buffer);
         }
         retlen = 0;
 
         NXPLOG_NCIHAL_D ("Performing RF Settings BLK 5");
-        isfound = GetNxpByteArrayValue(NAME_NXP_RF_CONF_BLK_5, (char *) buffer,
-                bufflen, &retlen);
-        if (retlen > 0) {
+        retlen = phNxpNciHal_get_cfg_array(p_cfg, NXP_CFG_RF_CONF_BLK_5, buffer, bufflen);
+        if ((retlen > 0) &&
+            !phNxpNciHal_cfg_cache_lookup(NXP_CFG_CACHE_RF_CONF_BLK_5, retlen, buffer)) {
             status = phNxpNciHal_send_ext_cmd(retlen, buffer);
 #if(NFC_NXP_CHIP_TYPE != PN547C2)
             if (status == NFCSTATUS_SUCCESS)
@@ -1421,13 +1474,15 @@ retry_core_init:
                 retry_core_init_cnt++;
                 goto retry_core_init;
             }
+            if (status == NFCSTATUS_SUCCESS)
+                phNxpNciHal_cfg_cache_update(NXP_CFG_CACHE_RF_CONF_BLK_5, retlen, buffer);
         }
         retlen = 0;
 
         NXPLOG_NCIHAL_D ("Performing RF Settings BLK 6");
-        isfound = GetNxpByteArrayValue(NAME_NXP_RF_CONF_BLK_6, (char *) buffer,
-                bufflen, &retlen);
-        if (retlen > 0) {
+        retlen = phNxpNciHal_get_cfg_array(p_cfg, NXP_CFG_RF_CONF_BLK_6, buffer, bufflen);
+        if ((retlen > 0) &&
+            !phNxpNciHal_cfg_cache_lookup(NXP_CFG_CACHE_RF_CONF_BLK_6, retlen, buffer)) {
             status = phNxpNciHal_send_ext_cmd(retlen, buffer);
 #if(NFC_NXP_CHIP_TYPE != PN547C2)
             if (status == NFCSTATUS_SUCCESS)
@@ -1448,15 +1503,17 @@ retry_core_init:
                 retry_core_init_cnt++;
                 goto retry_core_init;
             }
+            if (status == NFCSTATUS_SUCCESS)
+                phNxpNciHal_cfg_cache_update(NXP_CFG_CACHE_RF_CONF_BLK_6, retlen, buffer);
         }
         retlen = 0;
 #if(NFC_NXP_CHIP_TYPE != PN547C2)
         config_access = TRUE;
 #endif
         NXPLOG_NCIHAL_D ("Performing NAME_NXP_CORE_CONF_EXTN Settings");
-        isfound = GetNxpByteArrayValue(NAME_NXP_CORE_CONF_EXTN,
-                (char *) buffer, bufflen, &retlen);
-        if (retlen > 0) {
+        retlen = phNxpNciHal_get_cfg_array(p_cfg, NXP_CFG_CORE_CONF_EXTN, buffer, bufflen);
+        if ((retlen > 0) &&
+            !phNxpNciHal_cfg_cache_lookup(NXP_CFG_CACHE_CORE_CONF_EXTN, retlen, buffer)) {
             /* NXP ACT Proprietary Ext */
             status = phNxpNciHal_send_ext_cmd(retlen, buffer);
             if (status != NFCSTATUS_SUCCESS) {
@@ -1464,13 +1521,14 @@ retry_core_init:
                 retry_core_init_cnt++;
                 goto retry_core_init;
             }
+            phNxpNciHal_cfg_cache_update(NXP_CFG_CACHE_CORE_CONF_EXTN, retlen, buffer);
         }
 
         retlen = 0;
 
-        isfound = GetNxpByteArrayValue(NAME_NXP_CORE_MFCKEY_SETTING,
-                (char *) buffer, bufflen, &retlen);
-        if (retlen > 0) {
+        retlen = phNxpNciHal_get_cfg_array(p_cfg, NXP_CFG_CORE_MFCKEY_SETTING, buffer, bufflen);
+        if ((retlen > 0) &&
+            !phNxpNciHal_cfg_cache_lookup(NXP_CFG_CACHE_CORE_MFCKEY, retlen, buffer)) {
             /* NXP ACT Proprietary Ext */
             status = phNxpNciHal_send_ext_cmd(retlen, buffer);
             if (status != NFCSTATUS_SUCCESS) {
@@ -1478,15 +1536,16 @@ retry_core_init:
                 retry_core_init_cnt++;
                 goto retry_core_init;
             }
+            phNxpNciHal_cfg_cache_update(NXP_CFG_CACHE_CORE_MFCKEY, retlen, buffer);
         }
 
         retlen = 0;
 #if(NFC_NXP_CHIP_TYPE != PN547C2)
         config_access = FALSE;
 #endif
-        isfound = GetNxpByteArrayValue(NAME_NXP_CORE_RF_FIELD,
-                (char *) buffer, bufflen, &retlen);
-        if (retlen > 0) {
+        retlen = phNxpNciHal_get_cfg_array(p_cfg, NXP_CFG_CORE_RF_FIELD, buffer, bufflen);
+        if ((retlen > 0) &&
+            !phNxpNciHal_cfg_cache_lookup(NXP_CFG_CACHE_CORE_RF_FIELD, retlen, buffer)) {
             /* NXP ACT Proprietary Ext */
             status = phNxpNciHal_send_ext_cmd(retlen, buffer);
 #if(NFC_NXP_CHIP_TYPE != PN547C2)
@@ -1508,6 +1567,8 @@ retry_core_init:
                 retry_core_init_cnt++;
                 goto retry_core_init;
             }
+            if (status == NFCSTATUS_SUCCESS)
+                phNxpNciHal_cfg_cache_update(NXP_CFG_CACHE_CORE_RF_FIELD, retlen, buffer);
         }
 #if(NFC_NXP_CHIP_TYPE != PN547C2)
         config_access = TRUE;
@@ -1516,8 +1577,9 @@ retry_core_init:
         retlen = 0;
 #if(NFC_NXP_CHIP_TYPE != PN547C2)
         /* NXP SWP switch timeout Setting*/
-        if(GetNxpNumValue(NAME_NXP_SWP_SWITCH_TIMEOUT, (void *)&retlen, sizeof(retlen)))
+        if(NXP_CFG_IS_SET(p_cfg, NXP_CFG_SWP_SWITCH_TIMEOUT))
         {
+            retlen = (long) p_cfg->swp_switch_timeout;
             //Check the permissible range [0 - 60]
             if(0 <= retlen && retlen <= 60)
             {
@@ -1534,13 +1596,19 @@ retry_core_init:
                     swp_switch_timeout_cmd[8]= ((timeoutHx & 0xFF00) >> 8);
                 }
 
-                status = phNxpNciHal_send_ext_cmd (sizeof(swp_switch_timeout_cmd),
-                                                          swp_switch_timeout_cmd);
-                if (status != NFCSTATUS_SUCCESS)
+                if (!phNxpNciHal_cfg_cache_lookup(NXP_CFG_CACHE_SWP_SWITCH_TIMEOUT,
+                        sizeof(swp_switch_timeout_cmd), swp_switch_timeout_cmd))
                 {
-                    NXPLOG_NCIHAL_E ("SWP switch timeout Setting Failed");
-                    retry_core_init_cnt++;
-                    goto retry_core_init;
+                    status = phNxpNciHal_send_ext_cmd (sizeof(swp_switch_timeout_cmd),
+                                                              swp_switch_timeout_cmd);
+                    if (status != NFCSTATUS_SUCCESS)
+                    {
+                        NXPLOG_NCIHAL_E ("SWP switch timeout Setting Failed");
+                        retry_core_init_cnt++;
+                        goto retry_core_init;
+                    }
+                    phNxpNciHal_cfg_cache_update(NXP_CFG_CACHE_SWP_SWITCH_TIMEOUT,
+                            sizeof(swp_switch_timeout_cmd), swp_switch_timeout_cmd);
                 }
             }
             else
@@ -1567,7 +1635,7 @@ retry_core_init:
 
     retlen = 0;
 
-    isfound = GetNxpByteArrayValue(NAME_NXP_CORE_STANDBY, (char *) buffer,bufflen, &retlen);
+    retlen = phNxpNciHal_get_cfg_array(p_cfg, NXP_CFG_CORE_STANDBY, buffer, bufflen);
     if (retlen > 0) {
         /* NXP ACT Proprietary Ext */
         status = phNxpNciHal_send_ext_cmd(retlen, buffer);
@@ -1579,7 +1647,7 @@ retry_core_init:
     }
     retlen = 0;
 
-    isfound =  GetNxpByteArrayValue(NAME_NXP_CORE_CONF,(char *)buffer,bufflen,&retlen);
+    retlen = phNxpNciHal_get_cfg_array(p_cfg, NXP_CFG_CORE_CONF, buffer, bufflen);
     if(retlen > 0)
     {
         /* NXP ACT Proprietary Ext */
@@ -1609,57 +1677,83 @@ retry_core_init:
     retlen = 0;
 
     /* SWP FULL PWR MODE SETTING ON */
-    if(GetNxpNumValue(NAME_NXP_SWP_FULL_PWR_ON, (void *)&retlen, sizeof(retlen)))
+    if(NXP_CFG_IS_SET(p_cfg, NXP_CFG_SWP_FULL_PWR_ON))
     {
+        retlen = (long) p_cfg->swp_full_pwr_on;
         if(1 == retlen)
         {
-            status = phNxpNciHal_send_ext_cmd (sizeof(swp_full_pwr_mode_on_cmd),
-                                                      swp_full_pwr_mode_on_cmd);
-            if (status != NFCSTATUS_SUCCESS)
+            if (!phNxpNciHal_cfg_cache_lookup(NXP_CFG_CACHE_SWP_FULL_PWR,
+                    sizeof(swp_full_pwr_mode_on_cmd), swp_full_pwr_mode_on_cmd))
             {
-               NXPLOG_NCIHAL_E("SWP FULL PWR MODE SETTING ON CMD FAILED");
-                retry_core_init_cnt++;
-                goto retry_core_init;
+                status = phNxpNciHal_send_ext_cmd (sizeof(swp_full_pwr_mode_on_cmd),
+                                                          swp_full_pwr_mode_on_cmd);
+                if (status != NFCSTATUS_SUCCESS)
+                {
+                   NXPLOG_NCIHAL_E("SWP FULL PWR MODE SETTING ON CMD FAILED");
+                    retry_core_init_cnt++;
+                    goto retry_core_init;
+                }
+                phNxpNciHal_cfg_cache_update(NXP_CFG_CACHE_SWP_FULL_PWR,
+                        sizeof(swp_full_pwr_mode_on_cmd), swp_full_pwr_mode_on_cmd);
             }
         }
         else
         {
             swp_full_pwr_mode_on_cmd[7]=0x00;
-            status = phNxpNciHal_send_ext_cmd (sizeof(swp_full_pwr_mode_on_cmd),
-                                                      swp_full_pwr_mode_on_cmd);
-            if (status != NFCSTATUS_SUCCESS)
+            if (!phNxpNciHal_cfg_cache_lookup(NXP_CFG_CACHE_SWP_FULL_PWR,
+                    sizeof(swp_full_pwr_mode_on_cmd), swp_full_pwr_mode_on_cmd))
             {
-                NXPLOG_NCIHAL_E("SWP FULL PWR MODE SETTING OFF CMD FAILED");
-                retry_core_init_cnt++;
-                goto retry_core_init;
+                status = phNxpNciHal_send_ext_cmd (sizeof(swp_full_pwr_mode_on_cmd),
+                                                          swp_full_pwr_mode_on_cmd);
+                if (status != NFCSTATUS_SUCCESS)
+                {
+                    NXPLOG_NCIHAL_E("SWP FULL PWR MODE SETTING OFF CMD FAILED");
+                    retry_core_init_cnt++;
+                    goto retry_core_init;
+                }
+                phNxpNciHal_cfg_cache_update(NXP_CFG_CACHE_SWP_FULL_PWR,
+                        sizeof(swp_full_pwr_mode_on_cmd), swp_full_pwr_mode_on_cmd);
             }
         }
     }
 
     /* Android L AID Matching Platform Setting*/
-    if(GetNxpNumValue(NAME_AID_MATCHING_PLATFORM, (void *)&retlen, sizeof(retlen)))
+    if(NXP_CFG_IS_SET(p_cfg, NXP_CFG_AID_MATCHING_PLATFORM))
     {
+        retlen = (long) p_cfg->aid_matching_platform;
         if(1 == retlen)
         {
-            status = phNxpNciHal_send_ext_cmd (sizeof(android_l_aid_matching_mode_on_cmd),
-                    android_l_aid_matching_mode_on_cmd);
-            if (status != NFCSTATUS_SUCCESS)
+            if (!phNxpNciHal_cfg_cache_lookup(NXP_CFG_CACHE_AID_MATCHING,
+                    sizeof(android_l_aid_matching_mode_on_cmd), android_l_aid_matching_mode_on_cmd))
             {
-               NXPLOG_NCIHAL_E("Android L AID Matching Platform Setting Failed");
-                retry_core_init_cnt++;
-                goto retry_core_init;
+                status = phNxpNciHal_send_ext_cmd (sizeof(android_l_aid_matching_mode_on_cmd),
+                        android_l_aid_matching_mode_on_cmd);
+                if (status != NFCSTATUS_SUCCESS)
+                {
+                   NXPLOG_NCIHAL_E("Android L AID Matching Platform Setting Failed");
+                    retry_core_init_cnt++;
+                    goto retry_core_init;
+                }
+                phNxpNciHal_cfg_cache_update(NXP_CFG_CACHE_AID_MATCHING,
+                        sizeof(android_l_aid_matching_mode_on_cmd), android_l_aid_matching_mode_on_cmd);
             }
         }
         else if (2 == retlen)
         {
             android_l_aid_matching_mode_on_cmd[7]=0x00;
-            status = phNxpNciHal_send_ext_cmd (sizeof(android_l_aid_matching_mode_on_cmd),
-                    android_l_aid_matching_mode_on_cmd);
-            if (status != NFCSTATUS_SUCCESS)
+            if (!phNxpNciHal_cfg_cache_lookup(NXP_CFG_CACHE_AID_MATCHING,
+                    sizeof(android_l_aid_matching_mode_on_cmd), android_l_aid_matching_mode_on_cmd))
             {
-                NXPLOG_NCIHAL_E("Android L AID Matching Platform Setting Failed");
-                retry_core_init_cnt++;
-                goto retry_core_init;
+                status = phNxpNciHal_send_ext_cmd (sizeof(android_l_aid_matching_mode_on_cmd),
+                        android_l_aid_matching_mode_on_cmd);
+                if (status != NFCSTATUS_SUCCESS)
+                {
+                    NXPLOG_NCIHAL_E("Android L AID Matching Platform Setting Failed");
+                    retry_core_init_cnt++;
+                    goto retry_core_init;
+                }
+                phNxpNciHal_cfg_cache_update(NXP_CFG_CACHE_AID_MATCHING,
+                        sizeof(android_l_aid_matching_mode_on_cmd), android_l_aid_matching_mode_on_cmd);
             }
         }
     }
@@ -1788,6 +1882,7 @@ retry_core_init:
     }
 
     retry_core_init_cnt = 0;
+    phNxpNciHal_cfg_cache_end(status);
 
     if(buffer)
     {
@@ -2183,6 +2278,8 @@ int phNxpNciHal_power_cycle(void)
 
     NFCSTATUS status = NFCSTATUS_FAILED;
 
+    nciTraceRingDump();
+
     status = phTmlNfc_IoCtl(phTmlNfc_e_ResetDevice);
 
     if(NFCSTATUS_SUCCESS == status)
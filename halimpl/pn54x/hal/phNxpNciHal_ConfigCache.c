@@ -0,0 +1,330 @@
+/*
+ * Copyright (C) 2015 NXP Semiconductors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <phNxpNciHal_ConfigCache.h>
+#include <phNxpLog.h>
+
+#define NXP_CFG_CACHE_MAGIC         0x4E434643  /* "NCFC" */
+#define NXP_CFG_CACHE_VERSION       1
+
+/* Content of NXP_CFG_CACHE_PATH */
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t num_entries;
+    uint32_t fw_version;                    /* FW version the settings were applied to */
+    uint32_t hash[NXP_CFG_CACHE_MAX];       /* hash of the last command applied, 0 if none */
+    uint32_t last_cold_ms;                  /* last time to ready without the cache */
+    uint32_t last_warm_ms;                  /* last time to ready with the cache */
+    uint32_t check;                         /* hash of the fields above */
+} phNxpNciHal_CfgCacheFile_t;
+
+/* Cache control block */
+typedef struct
+{
+    phNxpNciHal_CfgCacheFile_t  file;
+    bool_t                      warm;       /* settings of the last enable are known */
+    uint16_t                    num_sent;
+    uint16_t                    num_skipped;
+    struct timespec             start;
+} phNxpNciHal_CfgCache_t;
+
+static phNxpNciHal_CfgCache_t cfg_cache;
+
+/******************************************************************************
+ * Function         phNxpNciHal_cfg_cache_hash
+ *
+ * Description      This function computes FNV-1a hash of a command.
+ *
+ * Returns          hash value, never 0.
+ *
+ ******************************************************************************/
+static uint32_t phNxpNciHal_cfg_cache_hash(uint16_t len, const uint8_t *p_data)
+{
+    uint32_t hash = 2166136261U;
+
+    while (len--)
+    {
+        hash ^= *p_data++;
+        hash *= 16777619U;
+    }
+    return (hash ? hash : 1);
+}
+
+/******************************************************************************
+ * Function         phNxpNciHal_cfg_cache_check_value
+ *
+ * Description      This function computes the integrity check of cache file.
+ *
+ * Returns          hash value.
+ *
+ ******************************************************************************/
+static uint32_t phNxpNciHal_cfg_cache_check_value(phNxpNciHal_CfgCacheFile_t *p_file)
+{
+    return phNxpNciHal_cfg_cache_hash(offsetof(phNxpNciHal_CfgCacheFile_t, check),
+            (const uint8_t *) p_file);
+}
+
+/******************************************************************************
+ * Function         phNxpNciHal_cfg_cache_elapsed_ms
+ *
+ * Description      This function returns time elapsed since
+ *                  phNxpNciHal_cfg_cache_begin.
+ *
+ * Returns          milliseconds.
+ *
+ ******************************************************************************/
+static uint32_t phNxpNciHal_cfg_cache_elapsed_ms(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t) ((now.tv_sec - cfg_cache.start.tv_sec) * 1000 +
+            (now.tv_nsec - cfg_cache.start.tv_nsec) / 1000000);
+}
+
+/******************************************************************************
+ * Function         phNxpNciHal_cfg_cache_begin
+ *
+ * Description      This function loads the settings applied by the last
+ *                  enable. They are dropped if FW is not the same or if
+ *                  force is set (e.g. FW has just been downloaded).
+ *
+ * Returns          void.
+ *
+ ******************************************************************************/
+void phNxpNciHal_cfg_cache_begin(uint32_t fw_version, bool_t force)
+{
+    phNxpNciHal_CfgCacheFile_t *p_file = &cfg_cache.file;
+    FILE *fd;
+    size_t rd = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &cfg_cache.start);
+    cfg_cache.num_sent = 0;
+    cfg_cache.num_skipped = 0;
+
+    if ((fd = fopen(NXP_CFG_CACHE_PATH, "rb")) != NULL)
+    {
+        rd = fread(p_file, 1, sizeof(phNxpNciHal_CfgCacheFile_t), fd);
+        fclose(fd);
+    }
+
+    if ((rd != sizeof(phNxpNciHal_CfgCacheFile_t)) ||
+        (p_file->magic != NXP_CFG_CACHE_MAGIC) ||
+        (p_file->version != NXP_CFG_CACHE_VERSION) ||
+        (p_file->num_entries != NXP_CFG_CACHE_MAX) ||
+        (p_file->check != phNxpNciHal_cfg_cache_check_value(p_file)))
+    {
+        memset(p_file, 0, sizeof(phNxpNciHal_CfgCacheFile_t));
+        p_file->magic = NXP_CFG_CACHE_MAGIC;
+        p_file->version = NXP_CFG_CACHE_VERSION;
+        p_file->num_entries = NXP_CFG_CACHE_MAX;
+        cfg_cache.warm = FALSE;
+    }
+    else if (force || (p_file->fw_version != fw_version))
+    {
+        NXPLOG_NCIHAL_D("Config cache: dropped (FW 0x%x -> 0x%x, force=%d)",
+                p_file->fw_version, fw_version, force);
+        memset(p_file->hash, 0, sizeof(p_file->hash));
+        cfg_cache.warm = FALSE;
+    }
+    else
+    {
+        cfg_cache.warm = TRUE;
+    }
+
+    p_file->fw_version = fw_version;
+}
+
+/******************************************************************************
+ * Function         phNxpNciHal_cfg_cache_is_warm
+ *
+ * Description      This function checks if settings applied by the last
+ *                  enable are known.
+ *
+ * Returns          TRUE if warm start.
+ *
+ ******************************************************************************/
+bool_t phNxpNciHal_cfg_cache_is_warm(void)
+{
+    return cfg_cache.warm;
+}
+
+/******************************************************************************
+ * Function         phNxpNciHal_cfg_cache_lookup
+ *
+ * Description      This function checks if the same command has been applied
+ *                  to NFCC by the last enable.
+ *
+ * Returns          TRUE if command does not need to be sent.
+ *
+ ******************************************************************************/
+bool_t phNxpNciHal_cfg_cache_lookup(phNxpNciHal_CfgCacheId_t id, uint16_t len, uint8_t *p_cmd)
+{
+    if ((cfg_cache.warm) &&
+        (cfg_cache.file.hash[id] == phNxpNciHal_cfg_cache_hash(len, p_cmd)))
+    {
+        cfg_cache.num_skipped++;
+        return TRUE;
+    }
+    return FALSE;
+}
+
+/******************************************************************************
+ * Function         phNxpNciHal_cfg_cache_update
+ *
+ * Description      This function records a command that has been applied
+ *                  successfully to NFCC.
+ *
+ * Returns          void.
+ *
+ ******************************************************************************/
+void phNxpNciHal_cfg_cache_update(phNxpNciHal_CfgCacheId_t id, uint16_t len, uint8_t *p_cmd)
+{
+    cfg_cache.file.hash[id] = phNxpNciHal_cfg_cache_hash(len, p_cmd);
+    cfg_cache.num_sent++;
+}
+
+/******************************************************************************
+ * Function         phNxpNciHal_cfg_cache_store
+ *
+ * Description      This function writes the cache file. The file is written
+ *                  under a temporary name first so that a power loss does
+ *                  not leave a partial file behind.
+ *
+ * Returns          void.
+ *
+ ******************************************************************************/
+static void phNxpNciHal_cfg_cache_store(void)
+{
+    static const char tmp_path[] = NXP_CFG_CACHE_PATH ".tmp";
+    phNxpNciHal_CfgCacheFile_t *p_file = &cfg_cache.file;
+    FILE *fd;
+    size_t wr;
+
+    p_file->check = phNxpNciHal_cfg_cache_check_value(p_file);
+
+    if ((fd = fopen(tmp_path, "wb")) == NULL)
+    {
+        NXPLOG_NCIHAL_E("Config cache: cannot open %s", tmp_path);
+        return;
+    }
+    wr = fwrite(p_file, 1, sizeof(phNxpNciHal_CfgCacheFile_t), fd);
+    fflush(fd);
+    fsync(fileno(fd));
+    fclose(fd);
+
+    if ((wr != sizeof(phNxpNciHal_CfgCacheFile_t)) ||
+        (rename(tmp_path, NXP_CFG_CACHE_PATH) != 0))
+    {
+        NXPLOG_NCIHAL_E("Config cache: cannot write %s", NXP_CFG_CACHE_PATH);
+        unlink(tmp_path);
+    }
+}
+
+/******************************************************************************
+ * Function         phNxpNciHal_cfg_cache_end
+ *
+ * Description      This function is called when proprietary settings of
+ *                  phNxpNciHal_core_initialized are complete. It saves the
+ *                  cache and reports the time to ready of this enable.
+ *
+ * Returns          void.
+ *
+ ******************************************************************************/
+void phNxpNciHal_cfg_cache_end(NFCSTATUS status)
+{
+    uint32_t elapsed = phNxpNciHal_cfg_cache_elapsed_ms();
+
+    if (status != NFCSTATUS_SUCCESS)
+    {
+        phNxpNciHal_cfg_cache_invalidate();
+        return;
+    }
+
+    if (cfg_cache.warm)
+        cfg_cache.file.last_warm_ms = elapsed;
+    else
+        cfg_cache.file.last_cold_ms = elapsed;
+
+    NXPLOG_NCIHAL_D("Config cache: %s start ready in %u ms, %d settings sent, %d skipped "
+            "(last cold %u ms, last warm %u ms)",
+            cfg_cache.warm ? "warm" : "cold", elapsed, cfg_cache.num_sent,
+            cfg_cache.num_skipped, cfg_cache.file.last_cold_ms,
+            cfg_cache.file.last_warm_ms);
+
+    phNxpNciHal_cfg_cache_store();
+}
+
+/******************************************************************************
+ * Function         phNxpNciHal_cfg_cache_invalidate
+ *
+ * Description      This function forgets the settings applied to NFCC, so
+ *                  that the next enable sends all of them.
+ *
+ * Returns          void.
+ *
+ ******************************************************************************/
+void phNxpNciHal_cfg_cache_invalidate(void)
+{
+    memset(cfg_cache.file.hash, 0, sizeof(cfg_cache.file.hash));
+    cfg_cache.warm = FALSE;
+    unlink(NXP_CFG_CACHE_PATH);
+}
+
+/******************************************************************************
+ * Function         phNxpNciHal_cfg_cache_check_cmd
+ *
+ * Description      This function checks a command from libnfc-nci. A
+ *                  CORE_SET_CONFIG of proprietary parameters may overwrite
+ *                  cached settings, so the cache is invalidated. The poll
+ *                  profile (A0 44) is not cached and is switched at runtime.
+ *
+ * Returns          void.
+ *
+ ******************************************************************************/
+void phNxpNciHal_cfg_cache_check_cmd(uint16_t len, const uint8_t *p_cmd)
+{
+    uint16_t pos = 4;
+    uint8_t num;
+
+    if ((len < 4) || (p_cmd[0] != 0x20) || (p_cmd[1] != 0x02))
+        return;
+
+    for (num = p_cmd[3]; (num > 0) && (pos + 1 < len); num--)
+    {
+        if (p_cmd[pos] == 0xA0)
+        {
+            if ((pos + 2 >= len) || (p_cmd[pos + 1] != 0x44))
+            {
+                NXPLOG_NCIHAL_D("Config cache: proprietary setting 0x%x changed",
+                        p_cmd[pos + 1]);
+                phNxpNciHal_cfg_cache_invalidate();
+                return;
+            }
+            pos += 3 + p_cmd[pos + 2];
+        }
+        else
+        {
+            pos += 2 + p_cmd[pos + 1];
+        }
+    }
+}
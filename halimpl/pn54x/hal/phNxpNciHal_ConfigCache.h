@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2015 NXP Semiconductors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _PHNXPNCIHAL_CONFIGCACHE_H_
+#define _PHNXPNCIHAL_CONFIGCACHE_H_
+
+#include <phNxpNciHal.h>
+#include <string.h>
+
+/* Cache of the proprietary settings PN54X keeps in EEPROM, so that
+ * phNxpNciHal_core_initialized only sends the ones that changed since the
+ * last enable. The cache is valid for one FW version only. */
+#define NXP_CFG_CACHE_PATH          "/data/nfc/libnfc-nxpConfigCache.bin"
+
+typedef enum
+{
+    NXP_CFG_CACHE_TVDD_CFG,
+    NXP_CFG_CACHE_RF_CONF_BLK_1,
+    NXP_CFG_CACHE_RF_CONF_BLK_2,
+    NXP_CFG_CACHE_RF_CONF_BLK_3,
+    NXP_CFG_CACHE_RF_CONF_BLK_4,
+    NXP_CFG_CACHE_RF_CONF_BLK_5,
+    NXP_CFG_CACHE_RF_CONF_BLK_6,
+    NXP_CFG_CACHE_CORE_CONF_EXTN,
+    NXP_CFG_CACHE_CORE_MFCKEY,
+    NXP_CFG_CACHE_CORE_RF_FIELD,
+    NXP_CFG_CACHE_SWP_SWITCH_TIMEOUT,
+    NXP_CFG_CACHE_SWP_FULL_PWR,
+    NXP_CFG_CACHE_AID_MATCHING,
+    NXP_CFG_CACHE_MAX
+} phNxpNciHal_CfgCacheId_t;
+
+extern void phNxpNciHal_cfg_cache_begin(uint32_t fw_version, bool_t force);
+extern bool_t phNxpNciHal_cfg_cache_is_warm(void);
+extern bool_t phNxpNciHal_cfg_cache_lookup(phNxpNciHal_CfgCacheId_t id, uint16_t len, uint8_t *p_cmd);
+extern void phNxpNciHal_cfg_cache_update(phNxpNciHal_CfgCacheId_t id, uint16_t len, uint8_t *p_cmd);
+extern void phNxpNciHal_cfg_cache_end(NFCSTATUS status);
+extern void phNxpNciHal_cfg_cache_invalidate(void);
+extern void phNxpNciHal_cfg_cache_check_cmd(uint16_t len, const uint8_t *p_cmd);
+
+#endif /* _PHNXPNCIHAL_CONFIGCACHE_H_ */
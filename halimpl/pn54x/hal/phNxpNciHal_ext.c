@@ -22,6 +22,7 @@
 #include <phNxpNciHal_Kovio.h>
 #include <phNxpLog.h>
 #include <phNxpConfig.h>
+#include <NciTraceRing.h>
 
 #define HAL_EXTNS_WRITE_RSP_TIMEOUT   (1000)                /* Timeout value to wait for response from PN548AD */
 
@@ -1017,6 +1018,7 @@ static void hal_extns_write_rsp_timeout_cb(uint32_t timerId, void *pContext)
     UNUSED(timerId);
     UNUSED(pContext);
     NXPLOG_NCIHAL_E("hal_extns_write_rsp_timeout_cb - write timeout!!!");
+    nciTraceRingDump();
     nxpncihal_ctrl.ext_cb_data.status = NFCSTATUS_FAILED;
     usleep(1);
     SEM_POST(&(nxpncihal_ctrl.ext_cb_data));
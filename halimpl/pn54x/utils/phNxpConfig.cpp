@@ -38,11 +38,12 @@
 
 #include <string>
 #include <vector>
-#include <list>
+#include <algorithm>
 #include <stdio.h>
 #include <sys/stat.h>
 
 #include <phNxpConfig.h>
+#include <ConfigIndex.h>
 #include <phNxpLog.h>
 
 #if GENERIC_TARGET
@@ -51,7 +52,9 @@ const char alternative_config_path[] = "/data/nfc/";
 const char alternative_config_path[] = "";
 #endif
 
-#if 1
+#if defined(NXP_CONFIG_TEST_PATH)
+const char transport_config_path[] = NXP_CONFIG_TEST_PATH;  /* host unit test */
+#elif 1
 const char transport_config_path[] = "/etc/";
 #else
 const char transport_config_path[] = "res/";
@@ -99,10 +102,9 @@ public:
 private:
     CNfcConfig();
     bool    readConfig(const char* name, bool bResetContent);
-    void    moveFromList();
-    void    moveToList();
     void    add(const CNfcParam* pParam);
-    list<const CNfcParam*> m_list;
+    void    buildIndex();
+    vector<size_t> m_index;     // hash slot -> setting array index + 1, 0 if empty
     bool    mValidFile;
     unsigned long m_timeStamp;
 
@@ -113,6 +115,11 @@ private:
     inline void Reset(unsigned long f) {state &= ~f;}
 };
 
+/* snapshot of GetNxpCoreInitConfig(), it points into the setting array and
+** is parsed again once the array changes */
+static tNXP_CORE_INIT_CONFIG sCoreInitCfg;
+static bool sCoreInitCfgValid = false;
+
 /*******************************************************************************
 **
 ** Function:    isPrintable()
@@ -179,8 +186,8 @@ inline int getDigitValue(char c, int base)
 **
 ** Function:    CNfcConfig::readConfig()
 **
-** Description: read Config settings and parse them into a linked list
-**              move the element from linked list to a array at the end
+** Description: read Config settings into memory in one go, parse them into
+**              the setting array and index it by name at the end
 **
 ** Returns:     1, if there are any config data, 0 otherwise
 **
@@ -223,16 +230,25 @@ bool CNfcConfig::readConfig(const char* name, bool bResetContent)
     m_timeStamp = (unsigned long)buf.st_mtime;
 
     mValidFile = true;
-    if (size() > 0)
-    {
-        if (bResetContent)
+    if (bResetContent)
         clean();
-        else
-            moveToList();
+
+    /* read the whole file at once and parse it from memory */
+    fseek(fd, 0, SEEK_END);
+    long fileLen = ftell(fd);
+    fseek(fd, 0, SEEK_SET);
+    string  content;
+    if (fileLen > 0)
+    {
+        content.resize(fileLen);
+        content.resize(fread(&content[0], 1, fileLen, fd));
     }
+    fclose(fd);
+    size_t  pos = 0;
 
-    while (!feof(fd) && fread(&c, 1, 1, fd) == 1)
+    while (pos < content.length())
     {
+        c = content[pos++];
         switch (state & 0xff)
         {
         case BEGIN_LINE:
@@ -391,9 +407,7 @@ bool CNfcConfig::readConfig(const char* name, bool bResetContent)
         }
     }
 
-    fclose(fd);
-
-    moveFromList();
+    buildIndex();
     return size() > 0;
 }
 
@@ -561,38 +575,14 @@ bool CNfcConfig::getValue(const char* name, unsigned short& rValue) const
 **
 ** Function:    CNfcConfig::find()
 **
-** Description: search if a setting exist in the setting array
+** Description: look up a setting by name in the hash index
 **
 ** Returns:     pointer to the setting object
 **
 *******************************************************************************/
 const CNfcParam* CNfcConfig::find(const char* p_name) const
 {
-    if (size() == 0)
-        return NULL;
-
-    for (const_iterator it = begin(), itEnd = end(); it != itEnd; ++it)
-    {
-        if (**it < p_name)
-        {
-            continue;
-        }
-        else if (**it == p_name)
-        {
-            if((*it)->str_len() > 0)
-            {
-                NXPLOG_EXTNS_D("%s found %s=%s\n", __func__, p_name, (*it)->str_value());
-            }
-            else
-            {
-                NXPLOG_EXTNS_D("%s found %s=(0x%lx)\n", __func__, p_name, (*it)->numValue());
-            }
-            return *it;
-        }
-        else
-            break;
-    }
-    return NULL;
+    return configFind<CNfcParam>(*this, m_index, p_name);
 }
 
 /*******************************************************************************
@@ -606,76 +596,45 @@ const CNfcParam* CNfcConfig::find(const char* p_name) const
 *******************************************************************************/
 void CNfcConfig::clean()
 {
+    sCoreInitCfgValid = false;
     if (size() == 0)
         return;
 
     for (iterator it = begin(), itEnd = end(); it != itEnd; ++it)
         delete *it;
     clear();
+    m_index.clear();
 }
 
 /*******************************************************************************
 **
 ** Function:    CNfcConfig::Add()
 **
-** Description: add a setting object to the list
+** Description: add a setting object to the array, buildIndex() sorts it
 **
 ** Returns:     none
 **
 *******************************************************************************/
 void CNfcConfig::add(const CNfcParam* pParam)
 {
-    if (m_list.size() == 0)
-    {
-        m_list.push_back(pParam);
-        return;
-    }
-    for (list<const CNfcParam*>::iterator it = m_list.begin(), itEnd = m_list.end(); it != itEnd; ++it)
-    {
-        if (**it < pParam->c_str())
-            continue;
-        m_list.insert(it, pParam);
-        return;
-    }
-    m_list.push_back(pParam);
+    push_back(pParam);
 }
 
 /*******************************************************************************
 **
-** Function:    CNfcConfig::moveFromList()
+** Function:    CNfcConfig::buildIndex()
 **
-** Description: move the setting object from list to array
+** Description: sort the setting array by name, drop settings overridden by a
+**              later definition of the same name, and rebuild the hash
+**              index used by find()
 **
 ** Returns:     none
 **
 *******************************************************************************/
-void CNfcConfig::moveFromList()
+void CNfcConfig::buildIndex()
 {
-    if (m_list.size() == 0)
-        return;
-
-    for (list<const CNfcParam*>::iterator it = m_list.begin(), itEnd = m_list.end(); it != itEnd; ++it)
-        push_back(*it);
-    m_list.clear();
-}
-
-/*******************************************************************************
-**
-** Function:    CNfcConfig::moveToList()
-**
-** Description: move the setting object from array to list
-**
-** Returns:     none
-**
-*******************************************************************************/
-void CNfcConfig::moveToList()
-{
-    if (m_list.size() != 0)
-        m_list.clear();
-
-    for (iterator it = begin(), itEnd = end(); it != itEnd; ++it)
-        m_list.push_back(*it);
-    clear();
+    sCoreInitCfgValid = false;
+    configBuildIndex<CNfcParam>(*this, m_index);
 }
 
 #if 0
@@ -954,6 +913,81 @@ extern "C" int GetNxpNumValue(const char* name, void* pValue, unsigned long len)
     return true;
 }
 
+/* names of the settings of tNXP_CORE_INIT_CONFIG, in NXP_CFG_xxx order */
+static const char* const sCoreInitCfgNames[NXP_CFG_NUM_SETTINGS] =
+{
+    NAME_NXP_ACT_PROP_EXTN,
+    NAME_NXP_NFC_PROFILE_EXTN,
+    NAME_NXP_EXT_TVDD_CFG_1,
+    NAME_NXP_EXT_TVDD_CFG_2,
+    NAME_NXP_EXT_TVDD_CFG_3,
+    NAME_NXP_RF_CONF_BLK_1,
+    NAME_NXP_RF_CONF_BLK_2,
+    NAME_NXP_RF_CONF_BLK_3,
+    NAME_NXP_RF_CONF_BLK_4,
+    NAME_NXP_RF_CONF_BLK_5,
+    NAME_NXP_RF_CONF_BLK_6,
+    NAME_NXP_CORE_CONF_EXTN,
+    NAME_NXP_CORE_MFCKEY_SETTING,
+    NAME_NXP_CORE_RF_FIELD,
+    NAME_NXP_CORE_STANDBY,
+    NAME_NXP_CORE_CONF,
+    NAME_NXP_EXT_TVDD_CFG,
+    NAME_NXP_SWP_SWITCH_TIMEOUT,
+    NAME_NXP_SWP_FULL_PWR_ON,
+    NAME_AID_MATCHING_PLATFORM,
+};
+
+/*******************************************************************************
+**
+** Function:    GetNxpCoreInitConfig
+**
+** Description: API function for getting the settings applied on core init,
+**              they are parsed once per config load. The byte arrays point
+**              into the parsed config and stay valid until resetNxpConfig().
+**
+** Returns:     pointer to the snapshot
+**
+*******************************************************************************/
+extern "C" const tNXP_CORE_INIT_CONFIG* GetNxpCoreInitConfig()
+{
+    CNfcConfig& rConfig = CNfcConfig::GetInstance();
+    unsigned long v;
+
+    if (sCoreInitCfgValid)
+        return &sCoreInitCfg;
+
+    memset(&sCoreInitCfg, 0, sizeof(sCoreInitCfg));
+    for (int i = 0; i < NXP_CFG_NUM_SETTINGS; ++i)
+    {
+        const CNfcParam* pParam = rConfig.find(sCoreInitCfgNames[i]);
+
+        if (pParam == NULL)
+            continue;
+        if (i < NXP_CFG_NUM_ARRAYS)
+        {
+            if (pParam->str_len() == 0)
+                continue;
+            sCoreInitCfg.array[i].p_value = (const unsigned char*)pParam->str_value();
+            sCoreInitCfg.array[i].len     = pParam->str_len();
+        }
+        else
+        {
+            GetNxpNumValue(sCoreInitCfgNames[i], &v, sizeof(v));
+            switch (i)
+            {
+            case NXP_CFG_EXT_TVDD_CFG:          sCoreInitCfg.ext_tvdd_cfg = v; break;
+            case NXP_CFG_SWP_SWITCH_TIMEOUT:    sCoreInitCfg.swp_switch_timeout = v; break;
+            case NXP_CFG_SWP_FULL_PWR_ON:       sCoreInitCfg.swp_full_pwr_on = v; break;
+            case NXP_CFG_AID_MATCHING_PLATFORM: sCoreInitCfg.aid_matching_platform = v; break;
+            }
+        }
+        sCoreInitCfg.present |= 1UL << i;
+    }
+    sCoreInitCfgValid = true;
+    return &sCoreInitCfg;
+}
+
 /*******************************************************************************
 **
 ** Function:    resetConfig
@@ -61,6 +61,7 @@ int updateNxpConfigTimestamp();
 #define NAME_NXPLOG_NCIR_LOGLEVEL    "NXPLOG_NCIR_LOGLEVEL"
 #define NAME_NXPLOG_FWDNLD_LOGLEVEL  "NXPLOG_FWDNLD_LOGLEVEL"
 #define NAME_NXPLOG_TML_LOGLEVEL     "NXPLOG_TML_LOGLEVEL"
+#define NAME_NXP_NCI_TRACE_RING      "NXP_NCI_TRACE_RING"
 
 #define NAME_MIFARE_READER_ENABLE    "MIFARE_READER_ENABLE"
 #define NAME_FW_STORAGE              "FW_STORAGE"
@@ -94,6 +95,66 @@ int updateNxpConfigTimestamp();
 #define NAME_NXP_I2C_FRAGMENTATION_ENABLED "NXP_I2C_FRAGMENTATION_ENABLED"
 #define NAME_AID_MATCHING_PLATFORM "AID_MATCHING_PLATFORM"
 
+/* Settings phNxpNciHal_core_initialized() applies on each core init;
+** GetNxpCoreInitConfig() parses them once per config load */
+enum
+{
+    /* byte arrays, in tNXP_CORE_INIT_CONFIG.array */
+    NXP_CFG_ACT_PROP_EXTN,
+    NXP_CFG_NFC_PROFILE_EXTN,
+    NXP_CFG_EXT_TVDD_CFG_1,
+    NXP_CFG_EXT_TVDD_CFG_2,
+    NXP_CFG_EXT_TVDD_CFG_3,
+    NXP_CFG_RF_CONF_BLK_1,
+    NXP_CFG_RF_CONF_BLK_2,
+    NXP_CFG_RF_CONF_BLK_3,
+    NXP_CFG_RF_CONF_BLK_4,
+    NXP_CFG_RF_CONF_BLK_5,
+    NXP_CFG_RF_CONF_BLK_6,
+    NXP_CFG_CORE_CONF_EXTN,
+    NXP_CFG_CORE_MFCKEY_SETTING,
+    NXP_CFG_CORE_RF_FIELD,
+    NXP_CFG_CORE_STANDBY,
+    NXP_CFG_CORE_CONF,
+    NXP_CFG_NUM_ARRAYS,
+
+    /* numerical values */
+    NXP_CFG_EXT_TVDD_CFG = NXP_CFG_NUM_ARRAYS,
+    NXP_CFG_SWP_SWITCH_TIMEOUT,
+    NXP_CFG_SWP_FULL_PWR_ON,
+    NXP_CFG_AID_MATCHING_PLATFORM,
+    NXP_CFG_NUM_SETTINGS
+};
+
+typedef struct
+{
+    const unsigned char*    p_value;    /* value in the parsed config file, NULL if not set */
+    long                    len;
+} tNXP_CFG_ARRAY;
+
+typedef struct
+{
+    unsigned long   present;                /* bit (1 << NXP_CFG_xxx) set if the setting is in the config file */
+    tNXP_CFG_ARRAY  array[NXP_CFG_NUM_ARRAYS];
+    unsigned long   ext_tvdd_cfg;
+    unsigned long   swp_switch_timeout;
+    unsigned long   swp_full_pwr_on;
+    unsigned long   aid_matching_platform;
+} tNXP_CORE_INIT_CONFIG;
+
+#define NXP_CFG_IS_SET(p, id)       (((p)->present & (1UL << (id))) != 0)
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+const tNXP_CORE_INIT_CONFIG* GetNxpCoreInitConfig(void);
+
+#ifdef __cplusplus
+};
+#endif
+
 
 /* default configuration */
 #define default_storage_location "/data/nfc"
@@ -0,0 +1,219 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2015 NXP Semiconductors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  Host test and startup benchmark of the libnfc-nxp.conf parser.
+ *
+ *  phNxpConfig.cpp is built into this file with the config directory moved
+ *  to TEST_CONFIG_DIR. An example libnfc-nxp.conf (argv[1], by default the
+ *  PN547C2 example of this tree) is copied there with one setting defined
+ *  again at the end of the file.
+ *
+ *  Checks:
+ *  - every setting of the file is found, a missing one is not
+ *  - the last definition of a setting is the one kept
+ *  - the core init snapshot matches GetNxpByteArrayValue()
+ *
+ *  Reports the time to load the file, and the time to look up every setting
+ *  once through the hash index and through a linear scan of the settings,
+ *  as find() did before the index.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define TEST_CONFIG_DIR         "/tmp/phNxpConfig_unittest/"
+#define NXP_CONFIG_TEST_PATH    TEST_CONFIG_DIR
+#include "phNxpConfig.cpp"
+
+#define TEST_DEFAULT_CONF       "halimpl/pn54x/libnfc-nxp-PN547C2_example.conf"
+#define TEST_OVERRIDE_NAME      "NXPLOG_NCIHAL_LOGLEVEL"
+#define TEST_OVERRIDE_VALUE     0x5A
+#define TEST_LOADS              200
+#define TEST_LOOKUP_ROUNDS      2000
+
+static int test_failures;
+
+#define TEST_CHECK(cond) \
+    do { if (!(cond)) { printf ("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); test_failures++; } } while (0)
+
+/*******************************************************************************
+**
+** Function:    test_now_us()
+**
+*******************************************************************************/
+static long test_now_us()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000L + now.tv_nsec / 1000;
+}
+
+/*******************************************************************************
+**
+** Function:    test_copy_conf()
+**
+** Description: copy the example file to the test config directory and define
+**              TEST_OVERRIDE_NAME again at its end
+**
+** Returns:     names of the settings defined in the file
+**
+*******************************************************************************/
+static vector<string> test_copy_conf(const char* p_src)
+{
+    vector<string> names;
+    char    line[1024];
+    FILE*   in = fopen(p_src, "r");
+    FILE*   out;
+
+    mkdir(TEST_CONFIG_DIR, 0700);
+    out = fopen(TEST_CONFIG_DIR config_name, "w");
+    if (in == NULL || out == NULL)
+    {
+        printf("FAIL cannot copy %s to %s\n", p_src, TEST_CONFIG_DIR config_name);
+        test_failures++;
+        if (in)
+            fclose(in);
+        if (out)
+            fclose(out);
+        return names;
+    }
+
+    while (fgets(line, sizeof(line), in))
+    {
+        fputs(line, out);
+
+        size_t len = strspn(line, "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789_");
+        if (len > 0 && line[len] == '=')
+            names.push_back(string(line, len));
+    }
+    fprintf(out, "\n%s=0x%02X\n", TEST_OVERRIDE_NAME, TEST_OVERRIDE_VALUE);
+    fclose(in);
+    fclose(out);
+    return names;
+}
+
+/*******************************************************************************
+**
+** Function:    test_linear_find()
+**
+** Description: look up a setting by scanning the setting array
+**
+*******************************************************************************/
+static const CNfcParam* test_linear_find(const CNfcConfig& rConfig, const char* p_name)
+{
+    for (CNfcConfig::const_iterator it = rConfig.begin(), itEnd = rConfig.end(); it != itEnd; ++it)
+    {
+        if (**it == p_name)
+            return *it;
+    }
+    return NULL;
+}
+
+int main(int argc, char** argv)
+{
+    vector<string>  names = test_copy_conf(argc > 1 ? argv[1] : TEST_DEFAULT_CONF);
+    unsigned long   num = 0;
+    long            start, load_us, hash_us, linear_us;
+    size_t          found = 0;
+    int             xx;
+
+    if (names.empty())
+    {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    /* load */
+    start = test_now_us();
+    for (xx = 0; xx < TEST_LOADS; xx++)
+    {
+        resetNxpConfig();
+        CNfcConfig::GetInstance();
+    }
+    load_us = (test_now_us() - start) / TEST_LOADS;
+
+    CNfcConfig& rConfig = CNfcConfig::GetInstance();
+
+    /* every setting is found, through the index and by scanning */
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        const CNfcParam* pParam = rConfig.find(names[i].c_str());
+        TEST_CHECK(pParam != NULL);
+        TEST_CHECK(pParam == test_linear_find(rConfig, names[i].c_str()));
+        if (pParam)
+            found++;
+    }
+    TEST_CHECK(rConfig.find("NXP_NOT_A_SETTING") == NULL);
+    TEST_CHECK(rConfig.find("") == NULL);
+
+    /* the last definition is kept, only once */
+    TEST_CHECK(GetNxpNumValue(TEST_OVERRIDE_NAME, &num, sizeof(num)));
+    TEST_CHECK(num == TEST_OVERRIDE_VALUE);
+    for (size_t i = 1; i < rConfig.size(); i++)
+        TEST_CHECK(*rConfig[i - 1] != *rConfig[i]);
+
+    /* core init snapshot */
+    const tNXP_CORE_INIT_CONFIG* p_cfg = GetNxpCoreInitConfig();
+    TEST_CHECK(p_cfg != NULL);
+    if (p_cfg)
+    {
+        for (size_t i = 0; i < sizeof(sCoreInitCfgNames) / sizeof(sCoreInitCfgNames[0]); i++)
+        {
+            char    buffer[256];
+            long    len = 0;
+
+            if (!GetNxpByteArrayValue(sCoreInitCfgNames[i], buffer, sizeof(buffer), &len))
+                len = 0;
+            if (i < NXP_CFG_NUM_ARRAYS)
+            {
+                TEST_CHECK((long) p_cfg->array[i].len == len);
+                TEST_CHECK(len == 0 || memcmp(p_cfg->array[i].p_value, buffer, len) == 0);
+            }
+        }
+    }
+
+    /* look up every setting of the file */
+    start = test_now_us();
+    for (xx = 0; xx < TEST_LOOKUP_ROUNDS; xx++)
+        for (size_t i = 0; i < names.size(); i++)
+            found += (rConfig.find(names[i].c_str()) != NULL);
+    hash_us = test_now_us() - start;
+
+    start = test_now_us();
+    for (xx = 0; xx < TEST_LOOKUP_ROUNDS; xx++)
+        for (size_t i = 0; i < names.size(); i++)
+            found += (test_linear_find(rConfig, names[i].c_str()) != NULL);
+    linear_us = test_now_us() - start;
+
+    printf("%zu settings, load %ld us, lookup of all settings: index %ld ns, linear %ld ns (%zu)\n",
+           rConfig.size(), load_us,
+           hash_us * 1000 / TEST_LOOKUP_ROUNDS, linear_us * 1000 / TEST_LOOKUP_ROUNDS, found);
+    TEST_CHECK(hash_us < linear_us);
+
+    remove(TEST_CONFIG_DIR config_name);
+    rmdir(TEST_CONFIG_DIR);
+
+    printf("%s\n", test_failures ? "FAILED" : "PASSED");
+    return test_failures ? 1 : 0;
+}
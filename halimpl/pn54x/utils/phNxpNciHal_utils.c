@@ -21,6 +21,7 @@
 #include <phNxpLog.h>
 #include <phNxpNciHal.h>
 #include <phNxpNciHal_utils.h>
+#include <NciTraceRing.h>
 
 #if(NFC_NXP_CHIP_TYPE == PN548C2)
 extern uint8_t discovery_cmd[50];
@@ -477,18 +478,51 @@ void phNxpNciHal_releaseall_cb_data(void)
 void phNxpNciHal_print_packet(const char *pString, const uint8_t *p_data,
         uint16_t len)
 {
-    uint32_t i, j;
-    char print_buffer[len * 3 + 1];
+    static const char hex[] = "0123456789ABCDEF";
+    uint32_t i;
+    uint8_t log_level;
+
+    if( 0 == memcmp(pString,"SEND",0x04))
+    {
+        /* Keep the packet in the binary trace instead, if it is enabled */
+        if (nciTraceRingRecord(p_data, len, 0))
+        {
+            return;
+        }
+        log_level = gLog_level.ncix_log_level;
+    }
+    else if( 0 == memcmp(pString,"RECV",0x04))
+    {
+        if (nciTraceRingRecord(p_data, len, 1))
+        {
+            return;
+        }
+        log_level = gLog_level.ncir_log_level;
+    }
+    else
+    {
+        return;
+    }
+
+    /* Do not format the packet if it is not going to be logged */
+    if (log_level < NXPLOG_LOG_DEBUG_LOGLEVEL)
+    {
+        return;
+    }
+
+    char print_buffer[len * 2 + 1];
 
-    memset (print_buffer, 0, sizeof(print_buffer));
     for (i = 0; i < len; i++) {
-        snprintf(&print_buffer[i * 2], 3, "%02X", p_data[i]);
+        print_buffer[i * 2]     = hex[p_data[i] >> 4];
+        print_buffer[i * 2 + 1] = hex[p_data[i] & 0x0F];
     }
+    print_buffer[len * 2] = '\0';
+
     if( 0 == memcmp(pString,"SEND",0x04))
     {
         NXPLOG_NCIX_D("len = %3d > %s", len, print_buffer);
     }
-    else if( 0 == memcmp(pString,"RECV",0x04))
+    else
     {
         NXPLOG_NCIR_D("len = %3d > %s", len, print_buffer);
     }
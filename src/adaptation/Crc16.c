@@ -0,0 +1,144 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2015 Broadcom Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+#include <pthread.h>
+#include "Crc16.h"
+
+#define CRC16_ARC_POLY          0xA001  /* 0x8005 reflected */
+#define CRC16_CCITT_POLY        0x1021
+#define CRC16_SLICES            8
+
+/* crc16_xxx_tab[0] is the usual byte table; crc16_xxx_tab[k][b] is the CRC
+ * of byte b followed by k zero bytes. */
+static uint16_t crc16_arc_tab[CRC16_SLICES][256];
+static uint16_t crc16_ccitt_tab[CRC16_SLICES][256];
+static pthread_once_t crc16_once = PTHREAD_ONCE_INIT;
+
+
+/*******************************************************************************
+**
+** Function         crc16InitTables
+**
+** Description      Build the slice-by-8 tables.
+**
+** Returns          None
+**
+*******************************************************************************/
+static void crc16InitTables (void)
+{
+    uint16_t arc, ccitt;
+    int xx, yy;
+
+    for (xx = 0; xx < 256; xx++)
+    {
+        arc   = (uint16_t) xx;
+        ccitt = (uint16_t) (xx << 8);
+        for (yy = 0; yy < 8; yy++)
+        {
+            arc   = (arc & 0x0001) ? ((arc >> 1) ^ CRC16_ARC_POLY) : (arc >> 1);
+            ccitt = (ccitt & 0x8000) ? ((ccitt << 1) ^ CRC16_CCITT_POLY) : (ccitt << 1);
+        }
+        crc16_arc_tab[0][xx]   = arc;
+        crc16_ccitt_tab[0][xx] = ccitt;
+    }
+
+    for (yy = 1; yy < CRC16_SLICES; yy++)
+    {
+        for (xx = 0; xx < 256; xx++)
+        {
+            arc   = crc16_arc_tab[yy - 1][xx];
+            ccitt = crc16_ccitt_tab[yy - 1][xx];
+            crc16_arc_tab[yy][xx]   = (arc >> 8) ^ crc16_arc_tab[0][arc & 0xFF];
+            crc16_ccitt_tab[yy][xx] = (uint16_t) (ccitt << 8) ^ crc16_ccitt_tab[0][ccitt >> 8];
+        }
+    }
+}
+
+
+/*******************************************************************************
+**
+** Function         crc16Arc
+**
+** Description      Compute CRC-16/ARC (reflected polynomial 0xA001) over a
+**                  buffer. Initial value of a new computation is 0.
+**                  crc: CRC of the preceding data.
+**                  buffer: data.
+**                  bufferLen: length of data.
+**
+** Returns          2-byte CRC.
+**
+*******************************************************************************/
+uint16_t crc16Arc (uint16_t crc, const uint8_t *buffer, size_t bufferLen)
+{
+    const uint8_t *p = buffer;
+
+    pthread_once (&crc16_once, crc16InitTables);
+
+    while (bufferLen >= CRC16_SLICES)
+    {
+        crc = crc16_arc_tab[7][(p[0] ^ crc) & 0xFF] ^
+              crc16_arc_tab[6][(p[1] ^ (crc >> 8)) & 0xFF] ^
+              crc16_arc_tab[5][p[2]] ^ crc16_arc_tab[4][p[3]] ^
+              crc16_arc_tab[3][p[4]] ^ crc16_arc_tab[2][p[5]] ^
+              crc16_arc_tab[1][p[6]] ^ crc16_arc_tab[0][p[7]];
+        p += CRC16_SLICES;
+        bufferLen -= CRC16_SLICES;
+    }
+
+    while (bufferLen--)
+        crc = (crc >> 8) ^ crc16_arc_tab[0][(crc ^ *p++) & 0xFF];
+
+    return crc;
+}
+
+
+/*******************************************************************************
+**
+** Function         crc16Ccitt
+**
+** Description      Compute CRC-16/CCITT (polynomial 0x1021, not reflected)
+**                  over a buffer. Initial value is 0xFFFF for the PN54X
+**                  download protocol.
+**                  crc: CRC of the preceding data.
+**                  buffer: data.
+**                  bufferLen: length of data.
+**
+** Returns          2-byte CRC.
+**
+*******************************************************************************/
+uint16_t crc16Ccitt (uint16_t crc, const uint8_t *buffer, size_t bufferLen)
+{
+    const uint8_t *p = buffer;
+
+    pthread_once (&crc16_once, crc16InitTables);
+
+    while (bufferLen >= CRC16_SLICES)
+    {
+        crc = crc16_ccitt_tab[7][p[0] ^ (crc >> 8)] ^
+              crc16_ccitt_tab[6][p[1] ^ (crc & 0xFF)] ^
+              crc16_ccitt_tab[5][p[2]] ^ crc16_ccitt_tab[4][p[3]] ^
+              crc16_ccitt_tab[3][p[4]] ^ crc16_ccitt_tab[2][p[5]] ^
+              crc16_ccitt_tab[1][p[6]] ^ crc16_ccitt_tab[0][p[7]];
+        p += CRC16_SLICES;
+        bufferLen -= CRC16_SLICES;
+    }
+
+    while (bufferLen--)
+        crc = (uint16_t) (crc << 8) ^ crc16_ccitt_tab[0][(crc >> 8) ^ *p++];
+
+    return crc;
+}
@@ -0,0 +1,192 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2015 Broadcom Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  Host test and microbenchmark of the slice-by-8 CRC-16 kernels.
+ *
+ *  Crc16.c is built into this file so that its byte table can be used for
+ *  the bytewise reference.
+ *
+ *  Checks:
+ *  - the check values of CRC-16/ARC and CRC-16/CCITT-FALSE over "123456789"
+ *  - crc16Arc() and crc16Ccitt() match a bit by bit and a bytewise CRC for
+ *    every length up to TEST_MAX_LEN, at every alignment mod 8
+ *  - a buffer processed in pieces gives the CRC of the whole buffer
+ *
+ *  Reports the time to compute the CRC of a TEST_BENCH_LEN byte buffer with
+ *  slice-by-8 and with the byte table, as the CRCs were computed before.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "Crc16.c"
+
+#define TEST_MAX_LEN        300
+#define TEST_BENCH_LEN      4096
+#define TEST_BENCH_ROUNDS   20000
+
+static int test_failures;
+
+#define TEST_CHECK(cond) \
+    do { if (!(cond)) { printf ("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); test_failures++; } } while (0)
+
+/*******************************************************************************
+**
+** Function         test_now_ns
+**
+*******************************************************************************/
+static long long test_now_ns (void)
+{
+    struct timespec now;
+
+    clock_gettime (CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/*******************************************************************************
+**
+** Function         test_arc_bitwise
+**
+** Description      CRC-16/ARC, one bit at a time
+**
+*******************************************************************************/
+static uint16_t test_arc_bitwise (uint16_t crc, const uint8_t *p, size_t len)
+{
+    int xx;
+
+    while (len--)
+    {
+        crc ^= *p++;
+        for (xx = 0; xx < 8; xx++)
+            crc = (crc & 0x0001) ? ((crc >> 1) ^ CRC16_ARC_POLY) : (crc >> 1);
+    }
+    return crc;
+}
+
+/*******************************************************************************
+**
+** Function         test_ccitt_bitwise
+**
+** Description      CRC-16/CCITT, one bit at a time
+**
+*******************************************************************************/
+static uint16_t test_ccitt_bitwise (uint16_t crc, const uint8_t *p, size_t len)
+{
+    int xx;
+
+    while (len--)
+    {
+        crc ^= (uint16_t) (*p++ << 8);
+        for (xx = 0; xx < 8; xx++)
+            crc = (crc & 0x8000) ? (uint16_t) ((crc << 1) ^ CRC16_CCITT_POLY) : (uint16_t) (crc << 1);
+    }
+    return crc;
+}
+
+/*******************************************************************************
+**
+** Function         test_arc_bytewise
+**
+** Description      CRC-16/ARC, one byte at a time with the byte table
+**
+*******************************************************************************/
+static uint16_t test_arc_bytewise (uint16_t crc, const uint8_t *p, size_t len)
+{
+    pthread_once (&crc16_once, crc16InitTables);
+
+    while (len--)
+        crc = (crc >> 8) ^ crc16_arc_tab[0][(crc ^ *p++) & 0xFF];
+    return crc;
+}
+
+/*******************************************************************************
+**
+** Function         test_ccitt_bytewise
+**
+** Description      CRC-16/CCITT, one byte at a time with the byte table
+**
+*******************************************************************************/
+static uint16_t test_ccitt_bytewise (uint16_t crc, const uint8_t *p, size_t len)
+{
+    pthread_once (&crc16_once, crc16InitTables);
+
+    while (len--)
+        crc = (uint16_t) (crc << 8) ^ crc16_ccitt_tab[0][(crc >> 8) ^ *p++];
+    return crc;
+}
+
+int main (void)
+{
+    static uint8_t buf[TEST_BENCH_LEN + CRC16_SLICES];
+    const uint8_t *p_check = (const uint8_t *) "123456789";
+    long long start, slice_ns, byte_ns;
+    unsigned  sum = 0;
+    size_t    len, off, split;
+    int       xx;
+
+    for (xx = 0; xx < (int) sizeof (buf); xx++)
+        buf[xx] = (uint8_t) (xx * 131 + (xx >> 3));
+
+    /* check values */
+    TEST_CHECK (crc16Arc (0, p_check, 9) == 0xBB3D);
+    TEST_CHECK (crc16Ccitt (0xFFFF, p_check, 9) == 0x29B1);
+
+    /* every length at every alignment */
+    for (off = 0; off < CRC16_SLICES; off++)
+    {
+        for (len = 0; len <= TEST_MAX_LEN; len++)
+        {
+            uint16_t arc   = test_arc_bitwise (0, buf + off, len);
+            uint16_t ccitt = test_ccitt_bitwise (0xFFFF, buf + off, len);
+
+            TEST_CHECK (crc16Arc (0, buf + off, len) == arc);
+            TEST_CHECK (test_arc_bytewise (0, buf + off, len) == arc);
+            TEST_CHECK (crc16Ccitt (0xFFFF, buf + off, len) == ccitt);
+            TEST_CHECK (test_ccitt_bytewise (0xFFFF, buf + off, len) == ccitt);
+        }
+    }
+
+    /* in pieces */
+    for (split = 0; split <= TEST_MAX_LEN; split += 7)
+    {
+        TEST_CHECK (crc16Arc (crc16Arc (0, buf, split), buf + split, TEST_MAX_LEN - split) ==
+                    crc16Arc (0, buf, TEST_MAX_LEN));
+        TEST_CHECK (crc16Ccitt (crc16Ccitt (0xFFFF, buf, split), buf + split, TEST_MAX_LEN - split) ==
+                    crc16Ccitt (0xFFFF, buf, TEST_MAX_LEN));
+    }
+
+    /* time both kernels */
+    start = test_now_ns ();
+    for (xx = 0; xx < TEST_BENCH_ROUNDS; xx++)
+        sum += crc16Arc (0, buf, TEST_BENCH_LEN) + crc16Ccitt (0xFFFF, buf, TEST_BENCH_LEN);
+    slice_ns = (test_now_ns () - start) / TEST_BENCH_ROUNDS;
+
+    start = test_now_ns ();
+    for (xx = 0; xx < TEST_BENCH_ROUNDS; xx++)
+        sum += test_arc_bytewise (0, buf, TEST_BENCH_LEN) + test_ccitt_bytewise (0xFFFF, buf, TEST_BENCH_LEN);
+    byte_ns = (test_now_ns () - start) / TEST_BENCH_ROUNDS;
+
+    printf ("ARC + CCITT of %d bytes: slice-by-8 %lld ns, bytewise %lld ns (%u)\n",
+            TEST_BENCH_LEN, slice_ns, byte_ns, sum);
+
+    printf ("%s\n", test_failures ? "FAILED" : "PASSED");
+    return test_failures ? 1 : 0;
+}
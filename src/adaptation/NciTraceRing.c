@@ -0,0 +1,244 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2015 Broadcom Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+#define LOG_TAG "NciTrace"
+
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <cutils/log.h>
+#include "NciTraceRing.h"
+#include "nci_trace_file.h"
+
+/* Only the owner writes to its ring, so tracing a packet takes no lock; a
+** dump reads all rings and skips slots being overwritten. */
+#define NCI_TRACE_MAX_PACKET_SIZE   259
+#define NCI_TRACE_RING_SLOTS        64      /* must be a power of 2 */
+#define NCI_TRACE_FILE_NAME_LEN     256
+typedef struct
+{
+    volatile uint32_t seq;              /* packet number + 1, 0 while the slot is written */
+    uint64_t        timestamp;          /* CLOCK_MONOTONIC, in microseconds */
+    uint32_t        tid;
+    uint16_t        len;
+    uint8_t         is_recv;
+    uint8_t         data [NCI_TRACE_MAX_PACKET_SIZE];
+} tNCI_TRACE_SLOT;
+
+typedef struct tNCI_TRACE_RING
+{
+    struct tNCI_TRACE_RING* p_next;     /* list of all rings, rings are never freed */
+    volatile uint32_t in_use;           /* ring is owned by a live thread */
+    uint32_t        tid;                /* owner of the ring */
+    uint32_t        count;              /* number of packets traced */
+    tNCI_TRACE_SLOT slot [NCI_TRACE_RING_SLOTS];
+} tNCI_TRACE_RING;
+
+static int nci_trace_enabled = 0;
+static char nci_trace_file [NCI_TRACE_FILE_NAME_LEN];
+static tNCI_TRACE_RING* nci_trace_rings = NULL;
+static __thread tNCI_TRACE_RING* nci_trace_ring = NULL;
+static pthread_key_t nci_trace_key;
+static pthread_once_t nci_trace_once = PTHREAD_ONCE_INIT;
+
+
+/*******************************************************************************
+**
+** Function         nciTraceReleaseRing
+**
+** Description      Thread exit handler; give the ring of the thread back so
+**                  another thread can reuse it. Its packets stay in the ring
+**                  until they are overwritten.
+**
+** Returns          None.
+**
+*******************************************************************************/
+static void nciTraceReleaseRing (void *p)
+{
+    __atomic_store_n (&((tNCI_TRACE_RING *) p)->in_use, 0, __ATOMIC_RELEASE);
+}
+
+
+static void nciTraceCreateKey (void)
+{
+    pthread_key_create (&nci_trace_key, nciTraceReleaseRing);
+}
+
+
+/*******************************************************************************
+**
+** Function         nciTraceGetRing
+**
+** Description      Get the ring of the calling thread. Reuse a ring released
+**                  by a thread that has exited, or allocate a new one.
+**
+** Returns          Ring of the calling thread, NULL if out of memory.
+**
+*******************************************************************************/
+static tNCI_TRACE_RING *nciTraceGetRing (void)
+{
+    tNCI_TRACE_RING *p_ring;
+    uint32_t unused = 0;
+
+    pthread_once (&nci_trace_once, nciTraceCreateKey);
+
+    for (p_ring = __atomic_load_n (&nci_trace_rings, __ATOMIC_ACQUIRE); p_ring != NULL; p_ring = p_ring->p_next)
+    {
+        if (__atomic_compare_exchange_n (&p_ring->in_use, &unused, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            break;
+        unused = 0;
+    }
+
+    if (p_ring == NULL)
+    {
+        if ((p_ring = (tNCI_TRACE_RING *) calloc (1, sizeof (tNCI_TRACE_RING))) == NULL)
+            return NULL;
+        p_ring->in_use = 1;
+        p_ring->p_next = __atomic_load_n (&nci_trace_rings, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n (&nci_trace_rings, &p_ring->p_next, p_ring, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+            ;
+    }
+
+    p_ring->tid = (uint32_t) syscall (__NR_gettid);
+    pthread_setspecific (nci_trace_key, p_ring);
+    return p_ring;
+}
+
+
+/*******************************************************************************
+**
+** Function         nciTraceRingEnable
+**
+** Description      Enable or disable the binary NCI trace.
+**
+** Returns          None.
+**
+*******************************************************************************/
+void nciTraceRingEnable (int enable, const char *dumpFile)
+{
+    if (dumpFile)
+        strlcpy (nci_trace_file, dumpFile, sizeof (nci_trace_file));
+    nci_trace_enabled = enable;
+}
+
+
+/*******************************************************************************
+**
+** Function         nciTraceRingRecord
+**
+** Description      Copy an NCI packet into the ring of the calling thread:
+**                  one timestamp read and one memcpy.
+**
+** Returns          1 if the packet was traced, 0 if the trace is disabled.
+**
+*******************************************************************************/
+int nciTraceRingRecord (const uint8_t *nciPacket, uint16_t nciPacketLen, int is_recv)
+{
+    tNCI_TRACE_RING *p_ring = nci_trace_ring;
+    tNCI_TRACE_SLOT *p_slot;
+    struct timespec ts;
+
+    if (!nci_trace_enabled)
+        return 0;
+
+    if (p_ring == NULL && (p_ring = nci_trace_ring = nciTraceGetRing ()) == NULL)
+        return 1;
+
+    if (nciPacketLen > NCI_TRACE_MAX_PACKET_SIZE)
+        nciPacketLen = NCI_TRACE_MAX_PACKET_SIZE;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+
+    p_slot = &p_ring->slot [p_ring->count & (NCI_TRACE_RING_SLOTS - 1)];
+    __atomic_store_n (&p_slot->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence (__ATOMIC_RELEASE);
+    p_slot->timestamp = (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    p_slot->tid       = p_ring->tid;
+    p_slot->len       = nciPacketLen;
+    p_slot->is_recv   = is_recv ? 1 : 0;
+    memcpy (p_slot->data, nciPacket, nciPacketLen);
+    __atomic_store_n (&p_slot->seq, ++p_ring->count, __ATOMIC_RELEASE);
+    return 1;
+}
+
+
+/*******************************************************************************
+**
+** Function         nciTraceRingDump
+**
+** Description      Write the NCI packets in the rings of all threads to the
+**                  dump file, for decoding with nci_trace_decode.
+**
+** Returns          None.
+**
+*******************************************************************************/
+void nciTraceRingDump (void)
+{
+    tNCI_TRACE_FILE_HDR hdr;
+    tNCI_TRACE_FILE_REC rec;
+    tNCI_TRACE_SLOT     slot;
+    tNCI_TRACE_RING     *p_ring;
+    int fd, i;
+
+    if (!nci_trace_enabled || nci_trace_file[0] == '\0')
+        return;
+
+    if ((fd = open (nci_trace_file, O_WRONLY | O_CREAT | O_TRUNC, 0660)) < 0)
+    {
+        ALOGE ("%s: fail to open %s", __FUNCTION__, nci_trace_file);
+        return;
+    }
+
+    memset (&hdr, 0, sizeof (hdr));
+    memcpy (hdr.magic, NCI_TRACE_FILE_MAGIC, NCI_TRACE_FILE_MAGIC_LEN);
+    hdr.version = NCI_TRACE_FILE_VERSION;
+    write (fd, &hdr, sizeof (hdr));
+
+    memset (&rec, 0, sizeof (rec));
+    for (p_ring = __atomic_load_n (&nci_trace_rings, __ATOMIC_ACQUIRE); p_ring != NULL; p_ring = p_ring->p_next)
+    {
+        for (i = 0; i < NCI_TRACE_RING_SLOTS; i++)
+        {
+            uint32_t seq = __atomic_load_n (&p_ring->slot[i].seq, __ATOMIC_ACQUIRE);
+            if (seq == 0)
+                continue;
+            memcpy (&slot, &p_ring->slot[i], sizeof (slot));
+            __atomic_thread_fence (__ATOMIC_ACQUIRE);
+            /* skip the slot if its owner started to overwrite it */
+            if (__atomic_load_n (&p_ring->slot[i].seq, __ATOMIC_RELAXED) != seq)
+                continue;
+
+            rec.timestamp = slot.timestamp;
+            rec.tid       = slot.tid;
+            rec.len       = slot.len;
+            rec.is_recv   = slot.is_recv;
+            write (fd, &rec, sizeof (rec));
+            write (fd, slot.data, slot.len);
+            hdr.num_records++;
+        }
+    }
+
+    /* fill in the number of records */
+    lseek (fd, 0, SEEK_SET);
+    write (fd, &hdr, sizeof (hdr));
+    close (fd);
+    ALOGD ("%s: %u NCI packets written to %s", __FUNCTION__, hdr.num_records, nci_trace_file);
+}
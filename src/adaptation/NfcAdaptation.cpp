@@ -26,6 +26,7 @@ extern "C"
 }
 #include "config.h"
 #include "android_logmsg.h"
+#include "NfcMetrics.h"
 
 #define LOG_TAG "NfcAdaptation"
 
@@ -49,15 +50,20 @@ char nci_hal_module[64];
 
 static UINT8 nfa_dm_cfg[sizeof ( tNFA_DM_CFG ) ];
 static UINT8 nfa_proprietary_cfg[sizeof ( tNFA_PROPRIETARY_CFG )];
+static tNFA_DM_DISC_FREQ_CFG nfa_dm_rf_disc_freq_cfg;
 extern tNFA_DM_CFG *p_nfa_dm_cfg;
 extern tNFA_PROPRIETARY_CFG *p_nfa_proprietary_cfg;
 extern UINT8 nfa_ee_max_ee_cfg;
+extern UINT8 ce_t4t_max_reg_aid_cfg;
 extern const UINT8  nfca_version_string [];
 extern const UINT8  nfa_version_string [];
 static UINT8 deviceHostWhiteList [NFA_HCI_MAX_HOST_IN_NETWORK];
 static tNFA_HCI_CFG jni_nfa_hci_cfg;
 extern tNFA_HCI_CFG *p_nfa_hci_cfg;
 extern BOOLEAN nfa_poll_bail_out_mode;
+extern BOOLEAN nfa_dm_disc_adaptive;
+extern UINT16 nfa_dm_disc_duration_cfg;
+extern tNFA_DM_DISC_FREQ_CFG *p_nfa_dm_rf_disc_freq_cfg;
 
 /*******************************************************************************
 **
@@ -119,50 +125,83 @@ void NfcAdaptation::Initialize ()
     const char* func = "NfcAdaptation::Initialize";
     ALOGD("%s: enter", func);
     ALOGE("%s: ver=%s nfa=%s", func, nfca_version_string, nfa_version_string);
-    unsigned long num;
+    const tSTACK_CONFIG* cfg = GetStackConfig ();
 
-    if ( GetNumValue ( NAME_USE_RAW_NCI_TRACE, &num, sizeof ( num ) ) )
+    if (cfg->use_raw_nci_trace == 1)
     {
-        if (num == 1)
-        {
-            // display protocol traces in raw format
-            ProtoDispAdapterUseRawOutput (TRUE);
-            ALOGD("%s: logging protocol in raw format", func);
-        }
+        // display protocol traces in raw format
+        ProtoDispAdapterUseRawOutput (TRUE);
+        ALOGD("%s: logging protocol in raw format", func);
     }
-    if ( !GetStrValue ( NAME_NFA_STORAGE, bcm_nfc_location, sizeof ( bcm_nfc_location ) ) )
+    strlcpy (bcm_nfc_location, cfg->nfa_storage, sizeof(bcm_nfc_location));
+
+    initializeProtocolLogLevel ();
+
+    if (cfg->nci_trace_ring == 1)
     {
-        strlcpy (bcm_nfc_location, "/data/nfc", sizeof(bcm_nfc_location));
+        // keep NCI packets in memory, dump them on error
+        char dumpFile[sizeof(bcm_nfc_location) + 32];
+        snprintf (dumpFile, sizeof(dumpFile), "%s/nci_trace_stack.bin", bcm_nfc_location);
+        ProtoDispAdapterUseBinaryTrace (TRUE, dumpFile);
     }
 
-    initializeProtocolLogLevel ();
+    if (cfg->deferred_trace == 1)
+    {
+        // format stack traces only when they are drained, on error
+        LogMsgUseDeferredTrace (TRUE);
+    }
 
-    if ( GetStrValue ( NAME_NFA_DM_CFG, (char*)nfa_dm_cfg, sizeof ( nfa_dm_cfg ) ) )
+    if (cfg->nfa_dm_cfg_len)
+    {
+        memcpy (nfa_dm_cfg, cfg->nfa_dm_cfg, (cfg->nfa_dm_cfg_len < sizeof(nfa_dm_cfg)) ? cfg->nfa_dm_cfg_len : sizeof(nfa_dm_cfg));
         p_nfa_dm_cfg = ( tNFA_DM_CFG * ) &nfa_dm_cfg[0];
+    }
 
-    if ( GetNumValue ( NAME_NFA_MAX_EE_SUPPORTED, &num, sizeof ( num ) ) )
+    if ( STACK_CFG_IS_SET (cfg, STACK_CFG_NFA_MAX_EE_SUPPORTED) )
     {
-        nfa_ee_max_ee_cfg = num;
+        nfa_ee_max_ee_cfg = cfg->nfa_max_ee_supported;
         ALOGD("%s: Overriding NFA_EE_MAX_EE_SUPPORTED to use %d", func, nfa_ee_max_ee_cfg);
     }
-    if ( GetNumValue ( NAME_NFA_POLL_BAIL_OUT_MODE, &num, sizeof ( num ) ) )
+    if ( STACK_CFG_IS_SET (cfg, STACK_CFG_CE_T4T_MAX_REG_AID) )
     {
-        nfa_poll_bail_out_mode = num;
+        ce_t4t_max_reg_aid_cfg = cfg->ce_t4t_max_reg_aid;
+        ALOGD("%s: Overriding CE_T4T_MAX_REG_AID to use %d", func, ce_t4t_max_reg_aid_cfg);
+    }
+    if ( STACK_CFG_IS_SET (cfg, STACK_CFG_NFA_POLL_BAIL_OUT_MODE) )
+    {
+        nfa_poll_bail_out_mode = cfg->nfa_poll_bail_out_mode;
         ALOGD("%s: Overriding NFA_POLL_BAIL_OUT_MODE to use %d", func, nfa_poll_bail_out_mode);
     }
+    if (cfg->nfa_dm_disc_adaptive == 1)
+    {
+        nfa_dm_disc_adaptive = TRUE;
+        ALOGD("%s: adaptive RF discovery enabled", func);
+    }
+    if ( STACK_CFG_IS_SET (cfg, STACK_CFG_NFA_DM_DISC_DURATION_POLL) )
+    {
+        nfa_dm_disc_duration_cfg = cfg->nfa_dm_disc_duration_poll;
+        ALOGD("%s: Overriding NFA_DM_DISC_DURATION_POLL to use %d", func, nfa_dm_disc_duration_cfg);
+    }
+    if (cfg->poll_frequency_len == sizeof(nfa_dm_rf_disc_freq_cfg))
+    {
+        memcpy (&nfa_dm_rf_disc_freq_cfg, cfg->poll_frequency, sizeof(nfa_dm_rf_disc_freq_cfg));
+        p_nfa_dm_rf_disc_freq_cfg = &nfa_dm_rf_disc_freq_cfg;
+    }
 
-    if ( GetStrValue ( NAME_NFA_PROPRIETARY_CFG, (char*)nfa_proprietary_cfg, sizeof ( tNFA_PROPRIETARY_CFG ) ) )
+    if (cfg->nfa_proprietary_cfg_len)
     {
+        memcpy (nfa_proprietary_cfg, cfg->nfa_proprietary_cfg, (cfg->nfa_proprietary_cfg_len < sizeof(nfa_proprietary_cfg)) ? cfg->nfa_proprietary_cfg_len : sizeof(nfa_proprietary_cfg));
         p_nfa_proprietary_cfg = (tNFA_PROPRIETARY_CFG*) &nfa_proprietary_cfg[0];
     }
 
     //configure device host whitelist of HCI host ID's; see specification ETSI TS 102 622 V11.1.10
     //(2012-10), section 6.1.3.1
-    num = GetStrValue ( NAME_DEVICE_HOST_WHITE_LIST, (char*) deviceHostWhiteList, sizeof ( deviceHostWhiteList ) );
-    if (num)
+    if (cfg->device_host_white_list_len)
     {
+        UINT8 num = (cfg->device_host_white_list_len < sizeof(deviceHostWhiteList)) ? cfg->device_host_white_list_len : sizeof(deviceHostWhiteList);
+        memcpy (deviceHostWhiteList, cfg->device_host_white_list, num);
         memmove (&jni_nfa_hci_cfg, p_nfa_hci_cfg, sizeof(jni_nfa_hci_cfg));
-        jni_nfa_hci_cfg.num_whitelist_host = (UINT8) num; //number of HCI host ID's in the whitelist
+        jni_nfa_hci_cfg.num_whitelist_host = num; //number of HCI host ID's in the whitelist
         jni_nfa_hci_cfg.p_whitelist = deviceHostWhiteList; //array of HCI host ID's
         p_nfa_hci_cfg = &jni_nfa_hci_cfg;
     }
@@ -170,8 +209,7 @@ void NfcAdaptation::Initialize ()
     initializeGlobalAppLogLevel ();
 
     verify_stack_non_volatile_store ();
-    if ( GetNumValue ( NAME_PRESERVE_STORAGE, (char*)&num, sizeof ( num ) ) &&
-            (num == 1) )
+    if (cfg->preserve_storage == 1)
         ALOGD ("%s: preserve stack NV store", __FUNCTION__);
     else
     {
@@ -210,6 +248,7 @@ void NfcAdaptation::Finalize()
 
     ALOGD ("%s: enter", func);
     GKI_shutdown ();
+    LogMsgUseDeferredTrace (FALSE);
 
     resetConfig();
 
@@ -310,11 +349,10 @@ void NfcAdaptation::InitializeHalDeviceContext ()
     const char* func = "NfcAdaptation::InitializeHalDeviceContext";
     ALOGD ("%s: enter", func);
     int ret = 0; //0 means success
-    if ( !GetStrValue ( NAME_NCI_HAL_MODULE, nci_hal_module, sizeof ( nci_hal_module) ) )
-    {
+    const tSTACK_CONFIG* cfg = GetStackConfig ();
+    if ( !STACK_CFG_IS_SET (cfg, STACK_CFG_NCI_HAL_MODULE) )
         ALOGE("No HAL module specified in config, falling back to BCM2079x");
-        strlcpy (nci_hal_module, "nfc_nci.bcm2079x", sizeof(nci_hal_module));
-    }
+    strlcpy (nci_hal_module, cfg->nci_hal_module, sizeof(nci_hal_module));
     const hw_module_t* hw_module = NULL;
 
     mHalEntryFuncs.initialize = HalInitialize;
@@ -444,6 +482,9 @@ void NfcAdaptation::HalDeviceContextDataCallback (uint16_t data_len, uint8_t* p_
 {
     const char* func = "NfcAdaptation::HalDeviceContextDataCallback";
     ALOGD ("%s: len=%u", func, data_len);
+#if (NFC_METRICS_INCLUDED == TRUE)
+    nfcMetricsCount (NFC_METRIC_HAL_READ, data_len);
+#endif
     if (mHalDataCallback)
         mHalDataCallback (data_len, p_data);
 }
@@ -463,7 +504,13 @@ void NfcAdaptation::HalWrite (UINT16 data_len, UINT8* p_data)
     ALOGD ("%s", func);
     if (mHalDeviceContext)
     {
+#if (NFC_METRICS_INCLUDED == TRUE)
+        UINT32 start = nfcMetricsNow ();
+        mHalDeviceContext->write (mHalDeviceContext, data_len, p_data);
+        nfcMetricsRecord (NFC_METRIC_HAL_WRITE, nfcMetricsNow () - start, data_len);
+#else
         mHalDeviceContext->write (mHalDeviceContext, data_len, p_data);
+#endif
     }
 }
 
@@ -0,0 +1,423 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2015 Broadcom Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+#include "OverrideLog.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "NfcMetrics.h"
+
+#define NFC_METRICS_SUB_BITS    3       /* 8 buckets per power of two */
+#define NFC_METRICS_SUB_COUNT   (1 << NFC_METRICS_SUB_BITS)
+#define NFC_METRICS_MAX_KEYS    32      /* operations tracked by nfcMetricsStart */
+
+/* One metric */
+typedef struct
+{
+    UINT32  count;
+    UINT32  max_us;
+    UINT64  bytes;
+    UINT64  total_us;
+    UINT32  buckets[NFC_METRICS_BUCKETS];
+} tNFC_METRIC;
+
+/* Start time of an operation */
+typedef struct
+{
+    const void  *p_key;
+    UINT32      start;
+} tNFC_METRIC_KEY;
+
+static tNFC_METRIC      nfc_metrics[NFC_METRIC_MAX];
+static tNFC_METRIC_KEY  nfc_metric_keys[NFC_METRICS_MAX_KEYS];
+
+static const char * const nfc_metric_names[NFC_METRIC_MAX] =
+{
+    "hal_write",
+    "hal_read",
+    "nci_cmd_rsp",
+    "data_credit_wait",
+    "llcp_pdu_tx",
+    "llcp_pdu_rx",
+    "nfa_msg",
+    "userial_write",
+    "userial_read",
+    "userial_poll"
+};
+
+
+/*******************************************************************************
+**
+** Function         nfcMetricsBucket
+**
+** Description      Find the histogram bucket of a latency.
+**
+** Returns          Bucket index.
+**
+*******************************************************************************/
+static UINT32 nfcMetricsBucket (UINT32 latency_us)
+{
+    UINT32 shift;
+
+    if (latency_us < NFC_METRICS_SUB_COUNT)
+        return latency_us;
+
+    shift = 31 - __builtin_clz ((unsigned int) latency_us) - NFC_METRICS_SUB_BITS;
+    return ((shift + 1) << NFC_METRICS_SUB_BITS) + ((latency_us >> shift) & (NFC_METRICS_SUB_COUNT - 1));
+}
+
+
+/*******************************************************************************
+**
+** Function         nfcMetricsBucketValue
+**
+** Description      Find the highest latency of a histogram bucket.
+**
+** Returns          Latency in microseconds.
+**
+*******************************************************************************/
+static UINT32 nfcMetricsBucketValue (UINT32 bucket)
+{
+    UINT32 shift, low;
+
+    if (bucket < NFC_METRICS_SUB_COUNT)
+        return bucket;
+
+    shift = (bucket >> NFC_METRICS_SUB_BITS) - 1;
+    low   = (NFC_METRICS_SUB_COUNT + (bucket & (NFC_METRICS_SUB_COUNT - 1))) << shift;
+    return low + ((1U << shift) - 1);
+}
+
+
+/*******************************************************************************
+**
+** Function         nfcMetricsNow
+**
+** Description      Get a timestamp for latencies. It wraps around every 71
+**                  minutes; the difference of two timestamps is still right
+**                  if they are less than that apart.
+**
+** Returns          Monotonic time in microseconds.
+**
+*******************************************************************************/
+UINT32 nfcMetricsNow (void)
+{
+    struct timespec now;
+
+    clock_gettime (CLOCK_MONOTONIC, &now);
+    return (UINT32) now.tv_sec * 1000000 + (UINT32) (now.tv_nsec / 1000);
+}
+
+
+/*******************************************************************************
+**
+** Function         nfcMetricsRecord
+**
+** Description      Record an event with its latency.
+**                  id: metric.
+**                  latency_us: latency of event.
+**                  bytes: bytes carried by event.
+**
+** Returns          Number of events of the metric, this one included.
+**
+*******************************************************************************/
+UINT32 nfcMetricsRecord (UINT8 id, UINT32 latency_us, UINT32 bytes)
+{
+    tNFC_METRIC *p_metric;
+    UINT32      max_us;
+
+    if (id >= NFC_METRIC_MAX)
+        return 0;
+    p_metric = &nfc_metrics[id];
+
+    __atomic_fetch_add (&p_metric->buckets[nfcMetricsBucket (latency_us)], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add (&p_metric->total_us, latency_us, __ATOMIC_RELAXED);
+    if (bytes)
+        __atomic_fetch_add (&p_metric->bytes, bytes, __ATOMIC_RELAXED);
+
+    max_us = __atomic_load_n (&p_metric->max_us, __ATOMIC_RELAXED);
+    while (  (latency_us > max_us)
+           &&(!__atomic_compare_exchange_n (&p_metric->max_us, &max_us, latency_us, TRUE,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))  )
+        ;
+
+    return __atomic_add_fetch (&p_metric->count, 1, __ATOMIC_RELAXED);
+}
+
+
+/*******************************************************************************
+**
+** Function         nfcMetricsCount
+**
+** Description      Record an event without latency.
+**                  id: metric.
+**                  bytes: bytes carried by event.
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfcMetricsCount (UINT8 id, UINT32 bytes)
+{
+    if (id >= NFC_METRIC_MAX)
+        return;
+
+    if (bytes)
+        __atomic_fetch_add (&nfc_metrics[id].bytes, bytes, __ATOMIC_RELAXED);
+    __atomic_fetch_add (&nfc_metrics[id].count, 1, __ATOMIC_RELAXED);
+}
+
+
+/*******************************************************************************
+**
+** Function         nfcMetricsStart
+**
+** Description      Note the start time of an operation identified by a key.
+**                  p_key: operation.
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfcMetricsStart (const void *p_key)
+{
+    tNFC_METRIC_KEY *p_slot = &nfc_metric_keys[((size_t) p_key >> 4) % NFC_METRICS_MAX_KEYS];
+
+    /* time first, so that a matching key always comes with its time */
+    __atomic_store_n (&p_slot->p_key, NULL, __ATOMIC_RELAXED);
+    __atomic_store_n (&p_slot->start, nfcMetricsNow (), __ATOMIC_RELAXED);
+    __atomic_store_n (&p_slot->p_key, p_key, __ATOMIC_RELEASE);
+}
+
+
+/*******************************************************************************
+**
+** Function         nfcMetricsStop
+**
+** Description      Record the latency of an operation noted by
+**                  nfcMetricsStart.
+**                  id: metric.
+**                  p_key: operation.
+**                  bytes: bytes carried by operation.
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfcMetricsStop (UINT8 id, const void *p_key, UINT32 bytes)
+{
+    tNFC_METRIC_KEY *p_slot = &nfc_metric_keys[((size_t) p_key >> 4) % NFC_METRICS_MAX_KEYS];
+    const void      *p_expected = p_key;
+    UINT32          start;
+
+    if (p_key == NULL)
+        return;
+
+    start = __atomic_load_n (&p_slot->start, __ATOMIC_ACQUIRE);
+    if (__atomic_compare_exchange_n (&p_slot->p_key, &p_expected, NULL, FALSE,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+    {
+        nfcMetricsRecord (id, nfcMetricsNow () - start, bytes);
+    }
+}
+
+
+/*******************************************************************************
+**
+** Function         nfcMetricsPercentile
+**
+** Description      Find a percentile from a histogram.
+**                  buckets: copy of histogram.
+**                  count: number of events in histogram.
+**                  per_mille: percentile in 1/1000.
+**                  max_us: highest latency recorded.
+**
+** Returns          Latency in microseconds.
+**
+*******************************************************************************/
+static UINT32 nfcMetricsPercentile (const UINT32 *buckets, UINT32 count, UINT32 per_mille,
+                                    UINT32 max_us)
+{
+    UINT32 value;
+    UINT64 rank = ((UINT64) count * per_mille + 999) / 1000;
+    UINT64 seen = 0;
+    UINT32 xx;
+
+    for (xx = 0; xx < NFC_METRICS_BUCKETS; xx++)
+    {
+        seen += buckets[xx];
+        if ((seen >= rank) && (seen > 0))
+        {
+            /* top of the bucket, but not above what was recorded */
+            value = nfcMetricsBucketValue (xx);
+            return (value < max_us) ? value : max_us;
+        }
+    }
+    return 0;
+}
+
+
+/*******************************************************************************
+**
+** Function         nfcMetricsSnapshot
+**
+** Description      Read all metrics.
+**                  p_snap: array of NFC_METRIC_MAX entries.
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfcMetricsSnapshot (tNFC_METRIC_SNAPSHOT *p_snap)
+{
+    UINT32 buckets[NFC_METRICS_BUCKETS];
+    UINT32 total;
+    int    id, xx;
+
+    for (id = 0; id < NFC_METRIC_MAX; id++, p_snap++)
+    {
+        tNFC_METRIC *p_metric = &nfc_metrics[id];
+
+        memset (p_snap, 0, sizeof (tNFC_METRIC_SNAPSHOT));
+        p_snap->name     = nfc_metric_names[id];
+        p_snap->count    = __atomic_load_n (&p_metric->count, __ATOMIC_RELAXED);
+        p_snap->bytes    = __atomic_load_n (&p_metric->bytes, __ATOMIC_RELAXED);
+        p_snap->total_us = __atomic_load_n (&p_metric->total_us, __ATOMIC_RELAXED);
+        p_snap->max_us   = __atomic_load_n (&p_metric->max_us, __ATOMIC_RELAXED);
+
+        /* percentiles over the histogram as copied */
+        total = 0;
+        for (xx = 0; xx < NFC_METRICS_BUCKETS; xx++)
+        {
+            buckets[xx] = __atomic_load_n (&p_metric->buckets[xx], __ATOMIC_RELAXED);
+            total += buckets[xx];
+        }
+        p_snap->samples = total;
+        if (total)
+        {
+            p_snap->p50_us  = nfcMetricsPercentile (buckets, total, 500, p_snap->max_us);
+            p_snap->p90_us  = nfcMetricsPercentile (buckets, total, 900, p_snap->max_us);
+            p_snap->p99_us  = nfcMetricsPercentile (buckets, total, 990, p_snap->max_us);
+            p_snap->p999_us = nfcMetricsPercentile (buckets, total, 999, p_snap->max_us);
+        }
+    }
+}
+
+
+/*******************************************************************************
+**
+** Function         nfcMetricsFormat
+**
+** Description      Format a metric as one line of text.
+**
+** Returns          Length of text.
+**
+*******************************************************************************/
+static int nfcMetricsFormat (const tNFC_METRIC_SNAPSHOT *p_snap, char *p_buf, size_t size)
+{
+    int len;
+
+    len = snprintf (p_buf, size, "%-18s count=%u bytes=%llu", p_snap->name, (unsigned) p_snap->count,
+                    (unsigned long long) p_snap->bytes);
+    if (p_snap->samples)
+    {
+        len += snprintf (p_buf + len, (len < (int) size) ? size - len : 0,
+                         " avg=%lluus p50=%uus p90=%uus p99=%uus p99.9=%uus max=%uus",
+                         (unsigned long long) (p_snap->total_us / p_snap->samples),
+                         (unsigned) p_snap->p50_us, (unsigned) p_snap->p90_us,
+                         (unsigned) p_snap->p99_us, (unsigned) p_snap->p999_us,
+                         (unsigned) p_snap->max_us);
+    }
+    return (len < (int) size) ? len : (int) size - 1;
+}
+
+
+/*******************************************************************************
+**
+** Function         nfcMetricsDump
+**
+** Description      Write one line of text per metric that has events.
+**                  fd: file descriptor.
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfcMetricsDump (int fd)
+{
+    tNFC_METRIC_SNAPSHOT snap[NFC_METRIC_MAX];
+    char   line[256];
+    int    id, len;
+
+    nfcMetricsSnapshot (snap);
+    for (id = 0; id < NFC_METRIC_MAX; id++)
+    {
+        if (snap[id].count == 0)
+            continue;
+        len = nfcMetricsFormat (&snap[id], line, sizeof (line) - 1);
+        line[len++] = '\n';
+        if (write (fd, line, len) < 0)
+            break;
+    }
+}
+
+
+/*******************************************************************************
+**
+** Function         nfcMetricsLog
+**
+** Description      Write a metric to the debug log.
+**                  id: metric.
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfcMetricsLog (UINT8 id)
+{
+    tNFC_METRIC_SNAPSHOT snap[NFC_METRIC_MAX];
+    char   line[256];
+
+    if (id >= NFC_METRIC_MAX)
+        return;
+
+    nfcMetricsSnapshot (snap);
+    nfcMetricsFormat (&snap[id], line, sizeof (line));
+    ALOGD ("%s: %s", __FUNCTION__, line);
+}
+
+
+/*******************************************************************************
+**
+** Function         nfcMetricsReset
+**
+** Description      Clear all metrics.
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfcMetricsReset (void)
+{
+    int id, xx;
+
+    for (id = 0; id < NFC_METRIC_MAX; id++)
+    {
+        tNFC_METRIC *p_metric = &nfc_metrics[id];
+
+        __atomic_store_n (&p_metric->count, 0, __ATOMIC_RELAXED);
+        __atomic_store_n (&p_metric->max_us, 0, __ATOMIC_RELAXED);
+        __atomic_store_n (&p_metric->bytes, 0, __ATOMIC_RELAXED);
+        __atomic_store_n (&p_metric->total_us, 0, __ATOMIC_RELAXED);
+        for (xx = 0; xx < NFC_METRICS_BUCKETS; xx++)
+            __atomic_store_n (&p_metric->buckets[xx], 0, __ATOMIC_RELAXED);
+    }
+}
@@ -0,0 +1,583 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2015 Broadcom Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+#include "OverrideLog.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <malloc.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "CrcChecksum.h"
+#include "NvJournal.h"
+
+#define NV_JOURNAL_MAGIC        0x4A564E42  /* "BNVJ" */
+#define NV_JOURNAL_VERSION      1
+#define NV_JOURNAL_MAX_FILES    8
+
+/* File header */
+typedef struct
+{
+    UINT32  magic;
+    UINT16  version;
+    UINT16  checksum;           /* checksum of magic and version */
+} tNV_JOURNAL_HDR;
+
+/* Record header, followed by len bytes of data */
+typedef struct
+{
+    UINT16  checksum;           /* checksum of offset, len and data */
+    UINT16  offset;             /* offset of data in the block */
+    UINT16  len;                /* length of data, never 0 */
+} tNV_JOURNAL_REC;
+
+/* Content of a block file */
+typedef struct
+{
+    char    filename[256];
+    BOOLEAN loaded;             /* file has been read */
+    BOOLEAN compact;            /* file must be rewritten on next write */
+    UINT16  size;               /* size of block */
+    UINT8   *p_data;            /* content of block */
+    off_t   file_len;           /* length of the valid part of the file */
+    UINT16  num_records;        /* records in the file */
+} tNV_JOURNAL_FILE;
+
+static tNV_JOURNAL_FILE nv_journal_files[NV_JOURNAL_MAX_FILES];
+
+
+/*******************************************************************************
+**
+** Function         nvJournalFind
+**
+** Description      Find the entry of a block file, or allocate one.
+**                  filename: file name.
+**
+** Returns          Entry, or NULL if table is full.
+**
+*******************************************************************************/
+static tNV_JOURNAL_FILE* nvJournalFind (const char* filename)
+{
+    tNV_JOURNAL_FILE *p_free = NULL;
+    int xx;
+
+    for (xx = 0; xx < NV_JOURNAL_MAX_FILES; xx++)
+    {
+        if (nv_journal_files[xx].filename[0] == 0)
+        {
+            if (p_free == NULL)
+                p_free = &nv_journal_files[xx];
+        }
+        else if (strcmp (nv_journal_files[xx].filename, filename) == 0)
+            return &nv_journal_files[xx];
+    }
+
+    if (p_free)
+        strlcpy (p_free->filename, filename, sizeof(p_free->filename));
+    else
+        ALOGE ("%s: no entry for %s", __FUNCTION__, filename);
+    return p_free;
+}
+
+
+/*******************************************************************************
+**
+** Function         nvJournalHdrChecksum
+**
+** Description      Compute the checksum of a file header.
+**
+** Returns          2-byte checksum.
+**
+*******************************************************************************/
+static UINT16 nvJournalHdrChecksum (const tNV_JOURNAL_HDR* p_hdr)
+{
+    return crcChecksumCompute ((const unsigned char*) p_hdr,
+                               sizeof(p_hdr->magic) + sizeof(p_hdr->version));
+}
+
+
+/*******************************************************************************
+**
+** Function         nvJournalRecChecksum
+**
+** Description      Compute the checksum of a record. The record header and
+**                  its data must be contiguous; records in a file are not
+**                  aligned, so the record is passed as bytes.
+**                  p_rec: start of record header.
+**                  len: length of record data.
+**
+** Returns          2-byte checksum.
+**
+*******************************************************************************/
+static UINT16 nvJournalRecChecksum (const UINT8* p_rec, UINT16 len)
+{
+    return crcChecksumCompute (p_rec + offsetof(tNV_JOURNAL_REC, offset),
+                               sizeof(tNV_JOURNAL_REC) - offsetof(tNV_JOURNAL_REC, offset) + len);
+}
+
+
+/*******************************************************************************
+**
+** Function         nvJournalSetSize
+**
+** Description      Set the size of a block.
+**
+** Returns          True if successful.
+**
+*******************************************************************************/
+static BOOLEAN nvJournalSetSize (tNV_JOURNAL_FILE* p_file, UINT16 size)
+{
+    UINT8 *p_data;
+
+    if (size != p_file->size)
+    {
+        if ((p_data = (UINT8*) realloc (p_file->p_data, size)) == NULL)
+            return FALSE;
+        p_file->p_data = p_data;
+        p_file->size = size;
+    }
+    return TRUE;
+}
+
+
+/*******************************************************************************
+**
+** Function         nvJournalParse
+**
+** Description      Replay the records of a file into the block. Replay stops
+**                  at the first record that is torn or corrupt.
+**                  p_buf: content of file.
+**                  len: length of file.
+**
+** Returns          True if the block could be rebuilt.
+**
+*******************************************************************************/
+static BOOLEAN nvJournalParse (tNV_JOURNAL_FILE* p_file, UINT8* p_buf, off_t len)
+{
+    tNV_JOURNAL_HDR *p_hdr = (tNV_JOURNAL_HDR*) p_buf;
+    tNV_JOURNAL_REC rec;
+    off_t pos;
+    UINT16 checksum;
+
+    if ((len >= (off_t) sizeof(tNV_JOURNAL_HDR)) &&
+        (p_hdr->magic == NV_JOURNAL_MAGIC) &&
+        (p_hdr->version == NV_JOURNAL_VERSION) &&
+        (p_hdr->checksum == nvJournalHdrChecksum (p_hdr)))
+    {
+        p_file->num_records = 0;
+        pos = sizeof(tNV_JOURNAL_HDR);
+
+        while (pos + (off_t) sizeof(tNV_JOURNAL_REC) <= len)
+        {
+            memcpy (&rec, p_buf + pos, sizeof(rec));
+            if (  (rec.len == 0)
+                ||(pos + (off_t) (sizeof(tNV_JOURNAL_REC) + rec.len) > len)
+                ||(rec.checksum != nvJournalRecChecksum (p_buf + pos, rec.len))  )
+                break;
+
+            if (p_file->num_records == 0)
+            {
+                /* first record is the whole block */
+                if ((rec.offset != 0) || (!nvJournalSetSize (p_file, rec.len)))
+                    break;
+            }
+            else if (rec.offset + rec.len > p_file->size)
+                break;
+
+            memcpy (p_file->p_data + rec.offset, p_buf + pos + sizeof(tNV_JOURNAL_REC), rec.len);
+            p_file->num_records++;
+            pos += sizeof(tNV_JOURNAL_REC) + rec.len;
+        }
+
+        if (p_file->num_records == 0)
+        {
+            ALOGE ("%s: no valid record", __FUNCTION__);
+            return FALSE;
+        }
+        if (pos != len)
+        {
+            ALOGE ("%s: dropped %ld bytes after record %u", __FUNCTION__,
+                   (long) (len - pos), p_file->num_records);
+            p_file->compact = TRUE;
+        }
+        p_file->file_len = pos;
+        return TRUE;
+    }
+
+    /* former format: checksum followed by the block */
+    if (len > (off_t) sizeof(checksum))
+    {
+        memcpy (&checksum, p_buf, sizeof(checksum));
+        len -= sizeof(checksum);
+        if (  (len <= 0xFFFF)
+            &&(checksum == crcChecksumCompute (p_buf + sizeof(checksum), (int) len))
+            &&(nvJournalSetSize (p_file, (UINT16) len))  )
+        {
+            memcpy (p_file->p_data, p_buf + sizeof(checksum), len);
+            p_file->num_records = 1;
+            p_file->compact = TRUE;
+            return TRUE;
+        }
+    }
+    ALOGE ("%s: checksum mismatch", __FUNCTION__);
+    return FALSE;
+}
+
+
+/*******************************************************************************
+**
+** Function         nvJournalLoad
+**
+** Description      Read a block file if not done yet.
+**
+** Returns          True if block is known (it may be empty if file does not
+**                  exist), False if file is corrupt.
+**
+*******************************************************************************/
+static BOOLEAN nvJournalLoad (tNV_JOURNAL_FILE* p_file)
+{
+    struct stat st;
+    UINT8 *p_buf;
+    ssize_t actualRead;
+    BOOLEAN isGood = FALSE;
+    int fileStream;
+
+    if (p_file->loaded)
+        return TRUE;
+
+    p_file->size = 0;
+    p_file->file_len = 0;
+    p_file->num_records = 0;
+    p_file->compact = TRUE;
+
+    fileStream = open (p_file->filename, O_RDONLY);
+    if (fileStream < 0)
+    {
+        /* nothing stored yet */
+        p_file->loaded = TRUE;
+        return TRUE;
+    }
+
+    if ((fstat (fileStream, &st) == 0) && (st.st_size > 0) &&
+        ((p_buf = (UINT8*) malloc (st.st_size)) != NULL))
+    {
+        actualRead = read (fileStream, p_buf, st.st_size);
+        if (actualRead == st.st_size)
+        {
+            p_file->compact = FALSE;
+            isGood = nvJournalParse (p_file, p_buf, st.st_size);
+            ALOGD ("%s: %s: size=%u; records=%u", __FUNCTION__, p_file->filename,
+                   p_file->size, p_file->num_records);
+        }
+        free (p_buf);
+    }
+    close (fileStream);
+
+    p_file->loaded = isGood;
+    return isGood;
+}
+
+
+/*******************************************************************************
+**
+** Function         nvJournalSyncDir
+**
+** Description      Flush the directory of a file, so that a rename is on
+**                  storage.
+**
+** Returns          None
+**
+*******************************************************************************/
+static void nvJournalSyncDir (const char* filename)
+{
+    char dirname[256];
+    char *p;
+    int dirStream;
+
+    strlcpy (dirname, filename, sizeof(dirname));
+    if ((p = strrchr (dirname, '/')) == NULL)
+        return;
+    *p = 0;
+
+    dirStream = open ((dirname[0] != 0) ? dirname : "/", O_RDONLY);
+    if (dirStream >= 0)
+    {
+        fsync (dirStream);
+        close (dirStream);
+    }
+}
+
+
+/*******************************************************************************
+**
+** Function         nvJournalCompact
+**
+** Description      Write the whole block into a new file and replace the
+**                  block file with it.
+**
+** Returns          True if successful.
+**
+*******************************************************************************/
+static BOOLEAN nvJournalCompact (tNV_JOURNAL_FILE* p_file, const UINT8* buffer, UINT16 bufferLen)
+{
+    char tmpname[sizeof(p_file->filename) + 4];
+    tNV_JOURNAL_HDR *p_hdr;
+    tNV_JOURNAL_REC *p_rec;
+    UINT8 *p_buf;
+    size_t len = sizeof(tNV_JOURNAL_HDR) + sizeof(tNV_JOURNAL_REC) + bufferLen;
+    ssize_t actualWritten = -1;
+    int fileStream;
+
+    if (bufferLen == 0)
+        return FALSE;
+
+    if ((p_buf = (UINT8*) malloc (len)) == NULL)
+        return FALSE;
+
+    p_hdr = (tNV_JOURNAL_HDR*) p_buf;
+    p_hdr->magic    = NV_JOURNAL_MAGIC;
+    p_hdr->version  = NV_JOURNAL_VERSION;
+    p_hdr->checksum = nvJournalHdrChecksum (p_hdr);
+
+    p_rec = (tNV_JOURNAL_REC*) (p_buf + sizeof(tNV_JOURNAL_HDR));
+    p_rec->offset = 0;
+    p_rec->len    = bufferLen;
+    memcpy (p_rec + 1, buffer, bufferLen);
+    p_rec->checksum = nvJournalRecChecksum ((const UINT8*) p_rec, p_rec->len);
+
+    snprintf (tmpname, sizeof(tmpname), "%s.tmp", p_file->filename);
+    fileStream = open (tmpname, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (fileStream >= 0)
+    {
+        actualWritten = write (fileStream, p_buf, len);
+        if ((actualWritten == (ssize_t) len) && (fsync (fileStream) != 0))
+            actualWritten = -1;
+        close (fileStream);
+    }
+    free (p_buf);
+
+    if ((actualWritten != (ssize_t) len) || (rename (tmpname, p_file->filename) != 0))
+    {
+        ALOGE ("%s: fail to write %s, error = %d", __FUNCTION__, tmpname, errno);
+        remove (tmpname);
+        return FALSE;
+    }
+    nvJournalSyncDir (p_file->filename);
+
+    if (!nvJournalSetSize (p_file, bufferLen))
+    {
+        /* file is good, but content can't be kept: reload it on next access */
+        p_file->loaded = FALSE;
+        return TRUE;
+    }
+    memcpy (p_file->p_data, buffer, bufferLen);
+    p_file->file_len    = len;
+    p_file->num_records = 1;
+    p_file->compact     = FALSE;
+    return TRUE;
+}
+
+
+/*******************************************************************************
+**
+** Function         nvJournalAppend
+**
+** Description      Append a record with the bytes that changed in the block.
+**
+** Returns          True if successful.
+**
+*******************************************************************************/
+static BOOLEAN nvJournalAppend (tNV_JOURNAL_FILE* p_file, const UINT8* buffer, UINT16 first, UINT16 last)
+{
+    tNV_JOURNAL_REC *p_rec;
+    size_t len = sizeof(tNV_JOURNAL_REC) + (last - first + 1);
+    ssize_t actualWritten = -1;
+    int fileStream;
+
+    if ((p_rec = (tNV_JOURNAL_REC*) malloc (len)) == NULL)
+        return FALSE;
+
+    p_rec->offset = first;
+    p_rec->len    = last - first + 1;
+    memcpy (p_rec + 1, buffer + first, p_rec->len);
+    p_rec->checksum = nvJournalRecChecksum ((const UINT8*) p_rec, p_rec->len);
+
+    fileStream = open (p_file->filename, O_WRONLY);
+    if (fileStream >= 0)
+    {
+        if (lseek (fileStream, p_file->file_len, SEEK_SET) == p_file->file_len)
+            actualWritten = write (fileStream, p_rec, len);
+        if ((actualWritten == (ssize_t) len) && (fdatasync (fileStream) != 0))
+            actualWritten = -1;
+        close (fileStream);
+    }
+    free (p_rec);
+
+    if (actualWritten != (ssize_t) len)
+    {
+        ALOGE ("%s: fail to write, error = %d", __FUNCTION__, errno);
+        /* a partial record may be in the file */
+        p_file->compact = TRUE;
+        return FALSE;
+    }
+
+    memcpy (p_file->p_data + first, buffer + first, last - first + 1);
+    p_file->file_len += len;
+    p_file->num_records++;
+    return TRUE;
+}
+
+
+/*******************************************************************************
+**
+** Function         nvJournalRead
+**
+** Description      Read a block. The records are checked on the first read
+**                  of the block; later reads are served from memory.
+**                  filename: file name.
+**                  buffer: buffer to read into.
+**                  bufferLen: size of buffer.
+**
+** Returns          Number of bytes read, or -1 if file is missing or corrupt.
+**
+*******************************************************************************/
+int nvJournalRead (const char* filename, UINT8* buffer, UINT16 bufferLen)
+{
+    tNV_JOURNAL_FILE *p_file = nvJournalFind (filename);
+    UINT16 len;
+
+    if (p_file == NULL)
+        return -1;
+
+    if (!nvJournalLoad (p_file))
+    {
+        ALOGE ("%s: %s is corrupt", __FUNCTION__, filename);
+        nvJournalDelete (filename);
+        return -1;
+    }
+    if (p_file->size == 0)
+        return -1;
+
+    len = (p_file->size < bufferLen) ? p_file->size : bufferLen;
+    memcpy (buffer, p_file->p_data, len);
+    return len;
+}
+
+
+/*******************************************************************************
+**
+** Function         nvJournalWrite
+**
+** Description      Write a block. Only the bytes that differ from the last
+**                  content of the block are written to the file.
+**                  filename: file name.
+**                  buffer: data of the block.
+**                  bufferLen: length of data.
+**
+** Returns          True if data is on storage.
+**
+*******************************************************************************/
+BOOLEAN nvJournalWrite (const char* filename, const UINT8* buffer, UINT16 bufferLen)
+{
+    tNV_JOURNAL_FILE *p_file = nvJournalFind (filename);
+    UINT16 first, last;
+
+    if (p_file == NULL)
+        return FALSE;
+
+    if (  (!nvJournalLoad (p_file))
+        ||(p_file->compact)
+        ||(p_file->size != bufferLen)
+        ||(p_file->num_records >= NV_JOURNAL_MAX_RECORDS)  )
+    {
+        ALOGD ("%s: %s: rewrite %u bytes", __FUNCTION__, filename, bufferLen);
+        return nvJournalCompact (p_file, buffer, bufferLen);
+    }
+
+    for (first = 0; (first < bufferLen) && (buffer[first] == p_file->p_data[first]); first++)
+        ;
+    if (first == bufferLen)
+    {
+        ALOGD ("%s: %s: unchanged", __FUNCTION__, filename);
+        return TRUE;
+    }
+    for (last = bufferLen - 1; buffer[last] == p_file->p_data[last]; last--)
+        ;
+
+    ALOGD ("%s: %s: append bytes %u-%u", __FUNCTION__, filename, first, last);
+    return nvJournalAppend (p_file, buffer, first, last);
+}
+
+
+/*******************************************************************************
+**
+** Function         nvJournalVerify
+**
+** Description      Check that a block file is in a known format. Only the
+**                  header is read; records are checked by nvJournalRead.
+**                  Files of the former format are checked entirely.
+**                  filename: file name.
+**
+** Returns          True if file is good or does not exist.
+**
+*******************************************************************************/
+BOOLEAN nvJournalVerify (const char* filename)
+{
+    tNV_JOURNAL_HDR hdr;
+    ssize_t actualRead;
+    int fileStream = open (filename, O_RDONLY);
+
+    if (fileStream < 0)
+        return TRUE; //assume file does not exist
+
+    actualRead = read (fileStream, &hdr, sizeof(hdr));
+    close (fileStream);
+
+    if (  (actualRead == sizeof(hdr))
+        &&(hdr.magic == NV_JOURNAL_MAGIC)
+        &&(hdr.version == NV_JOURNAL_VERSION)
+        &&(hdr.checksum == nvJournalHdrChecksum (&hdr))  )
+        return TRUE;
+
+    return crcChecksumVerifyIntegrity (filename);
+}
+
+
+/*******************************************************************************
+**
+** Function         nvJournalDelete
+**
+** Description      Delete a block file and forget its content.
+**                  filename: file name.
+**
+** Returns          None
+**
+*******************************************************************************/
+void nvJournalDelete (const char* filename)
+{
+    tNV_JOURNAL_FILE *p_file = nvJournalFind (filename);
+
+    remove (filename);
+    if (p_file)
+    {
+        free (p_file->p_data);
+        memset (p_file, 0, sizeof(tNV_JOURNAL_FILE));
+    }
+}
@@ -52,9 +52,9 @@ unsigned char initializeGlobalAppLogLevel ()
     unsigned long num = 0;
     char valueStr [PROPERTY_VALUE_MAX] = {0};
 
-    num = 1;
-    if (GetNumValue (NAME_APPL_TRACE_LEVEL, &num, sizeof(num)))
-        appl_trace_level = (unsigned char) num;
+    const tSTACK_CONFIG* cfg = GetStackConfig ();
+    if (STACK_CFG_IS_SET (cfg, STACK_CFG_APPL_TRACE_LEVEL))
+        appl_trace_level = cfg->appl_trace_level;
 
     int len = property_get ("nfc.app_log_level", valueStr, "");
     if (len > 0)
@@ -79,11 +79,11 @@ unsigned char initializeGlobalAppLogLevel ()
 }
 
 UINT32 initializeProtocolLogLevel () {
-    UINT32 num = 0;
     char valueStr [PROPERTY_VALUE_MAX] = {0};
 
-    if ( GetNumValue ( NAME_PROTOCOL_TRACE_LEVEL, &num, sizeof ( num ) ) )
-        ScrProtocolTraceFlag = num;
+    const tSTACK_CONFIG* cfg = GetStackConfig ();
+    if ( STACK_CFG_IS_SET (cfg, STACK_CFG_PROTOCOL_TRACE_LEVEL) )
+        ScrProtocolTraceFlag = cfg->protocol_trace_level;
 
     int len = property_get ("nfc.enable_protocol_log", valueStr, "");
     if (len > 0)
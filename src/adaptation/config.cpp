@@ -17,10 +17,13 @@
  ******************************************************************************/
 #include "OverrideLog.h"
 #include "config.h"
+#include "ConfigIndex.h"
 #include <stdio.h>
+#include <stddef.h>
+#include <pthread.h>
 #include <string>
 #include <vector>
-#include <list>
+#include <algorithm>
 
 #define LOG_TAG "NfcAdaptation"
 
@@ -53,6 +56,7 @@ class CNfcConfig : public vector<const CNfcParam*>
 public:
     virtual ~CNfcConfig();
     static CNfcConfig& GetInstance();
+    static CNfcConfig* Load();
     friend void readOptionalConfig(const char* optional);
 
     bool    getValue(const char* name, char* pValue, size_t& len) const;
@@ -63,10 +67,9 @@ public:
 private:
     CNfcConfig();
     bool    readConfig(const char* name, bool bResetContent);
-    void    moveFromList();
-    void    moveToList();
     void    add(const CNfcParam* pParam);
-    list<const CNfcParam*> m_list;
+    void    buildIndex();
+    vector<size_t> m_index;     // hash slot -> setting array index + 1, 0 if empty
     bool    mValidFile;
 
     unsigned long   state;
@@ -142,8 +145,8 @@ inline int getDigitValue(char c, int base)
 **
 ** Function:    CNfcConfig::readConfig()
 **
-** Description: read Config settings and parse them into a linked list
-**              move the element from linked list to a array at the end
+** Description: read Config settings into memory in one go, parse them into
+**              the setting array and index it by name at the end
 **
 ** Returns:     none
 **
@@ -184,17 +187,27 @@ bool CNfcConfig::readConfig(const char* name, bool bResetContent)
     ALOGD("%s Opened %s config %s\n", __func__, (bResetContent ? "base" : "optional"), name);
 
     mValidFile = true;
-    if (size() > 0)
-    {
-        if (bResetContent)
+    if (bResetContent)
         clean();
-        else
-            moveToList();
+
+    /* read the whole file at once and parse it from memory */
+    fseek(fd, 0, SEEK_END);
+    long fileLen = ftell(fd);
+    fseek(fd, 0, SEEK_SET);
+    string  content;
+    if (fileLen > 0)
+    {
+        content.resize(fileLen);
+        content.resize(fread(&content[0], 1, fileLen, fd));
     }
+    fclose(fd);
+    size_t  pos = 0;
 
     for (;;)
     {
-        if (feof(fd) || fread(&c, 1, 1, fd) != 1)
+        if (pos < content.length())
+            c = content[pos++];
+        else
         {
             if (state == BEGIN_LINE)
                 break;
@@ -203,6 +216,7 @@ bool CNfcConfig::readConfig(const char* name, bool bResetContent)
             // probably does not end with a newline, so the parser has
             // not processed current line, simulate a newline in the file
             c = '\n';
+            pos++;
         }
 
         switch (state & 0xff)
@@ -340,13 +354,11 @@ bool CNfcConfig::readConfig(const char* name, bool bResetContent)
             break;
         }
 
-        if (feof(fd))
+        if (pos > content.length())
             break;
     }
 
-    fclose(fd);
-
-    moveFromList();
+    buildIndex();
     return size() > 0;
 }
 
@@ -481,32 +493,14 @@ bool CNfcConfig::getValue(const char* name, unsigned short& rValue) const
 **
 ** Function:    CNfcConfig::find()
 **
-** Description: search if a setting exist in the setting array
+** Description: look up a setting by name in the hash index
 **
 ** Returns:     pointer to the setting object
 **
 *******************************************************************************/
 const CNfcParam* CNfcConfig::find(const char* p_name) const
 {
-    if (size() == 0)
-        return NULL;
-
-    for (const_iterator it = begin(), itEnd = end(); it != itEnd; ++it)
-    {
-        if (**it < p_name)
-            continue;
-        else if (**it == p_name)
-        {
-            if((*it)->str_len() > 0)
-                ALOGD("%s found %s=%s\n", __func__, p_name, (*it)->str_value());
-            else
-                ALOGD("%s found %s=(0x%lX)\n", __func__, p_name, (*it)->numValue());
-            return *it;
-        }
-        else
-            break;
-    }
-    return NULL;
+    return configFind<CNfcParam>(*this, m_index, p_name);
 }
 
 /*******************************************************************************
@@ -526,70 +520,37 @@ void CNfcConfig::clean()
     for (iterator it = begin(), itEnd = end(); it != itEnd; ++it)
         delete *it;
     clear();
+    m_index.clear();
 }
 
 /*******************************************************************************
 **
 ** Function:    CNfcConfig::Add()
 **
-** Description: add a setting object to the list
+** Description: add a setting object to the array, buildIndex() sorts it
 **
 ** Returns:     none
 **
 *******************************************************************************/
 void CNfcConfig::add(const CNfcParam* pParam)
 {
-    if (m_list.size() == 0)
-    {
-        m_list.push_back(pParam);
-        return;
-    }
-    for (list<const CNfcParam*>::iterator it = m_list.begin(), itEnd = m_list.end(); it != itEnd; ++it)
-    {
-        if (**it < pParam->c_str())
-            continue;
-        m_list.insert(it, pParam);
-        return;
-    }
-    m_list.push_back(pParam);
-}
-
-/*******************************************************************************
-**
-** Function:    CNfcConfig::moveFromList()
-**
-** Description: move the setting object from list to array
-**
-** Returns:     none
-**
-*******************************************************************************/
-void CNfcConfig::moveFromList()
-{
-    if (m_list.size() == 0)
-        return;
-
-    for (list<const CNfcParam*>::iterator it = m_list.begin(), itEnd = m_list.end(); it != itEnd; ++it)
-        push_back(*it);
-    m_list.clear();
+    push_back(pParam);
 }
 
 /*******************************************************************************
 **
-** Function:    CNfcConfig::moveToList()
+** Function:    CNfcConfig::buildIndex()
 **
-** Description: move the setting object from array to list
+** Description: sort the setting array by name, drop settings overridden by a
+**              later definition of the same name, and rebuild the hash
+**              index used by find()
 **
 ** Returns:     none
 **
 *******************************************************************************/
-void CNfcConfig::moveToList()
+void CNfcConfig::buildIndex()
 {
-    if (m_list.size() != 0)
-        m_list.clear();
-
-    for (iterator it = begin(), itEnd = end(); it != itEnd; ++it)
-        m_list.push_back(*it);
-    clear();
+    configBuildIndex<CNfcParam>(*this, m_index);
 }
 
 /*******************************************************************************
@@ -668,6 +629,31 @@ extern "C" int GetStrValue(const char* name, char* pValue, unsigned long l)
     return b ? len : 0;
 }
 
+/*******************************************************************************
+**
+** Function:    paramNumValue
+**
+** Description: numerical value of a setting, a string of up to 3 bytes is
+**              read as a big endian number
+**
+** Returns:     value
+**
+*******************************************************************************/
+static unsigned long paramNumValue(const CNfcParam* pParam)
+{
+    unsigned long v = pParam->numValue();
+    if (v == 0 && pParam->str_len() > 0 && pParam->str_len() < 4)
+    {
+        const unsigned char* p = (const unsigned char*)pParam->str_value();
+        for (size_t i = 0 ; i < pParam->str_len(); ++i)
+        {
+            v *= 256;
+            v += *p++;
+        }
+    }
+    return v;
+}
+
 /*******************************************************************************
 **
 ** Function:    GetNumValue
@@ -687,16 +673,7 @@ extern "C" int GetNumValue(const char* name, void* pValue, unsigned long len)
 
     if (pParam == NULL)
         return false;
-    unsigned long v = pParam->numValue();
-    if (v == 0 && pParam->str_len() > 0 && pParam->str_len() < 4)
-    {
-        const unsigned char* p = (const unsigned char*)pParam->str_value();
-        for (size_t i = 0 ; i < pParam->str_len(); ++i)
-        {
-            v *= 256;
-            v += *p++;
-        }
-    }
+    unsigned long v = paramNumValue(pParam);
     switch (len)
     {
     case sizeof(unsigned long):
@@ -714,11 +691,269 @@ extern "C" int GetNumValue(const char* name, void* pValue, unsigned long len)
     return true;
 }
 
+/* registry of the settings parsed into tSTACK_CONFIG */
+enum
+{
+    STACK_CFG_TYPE_NUM,                 /* numerical value, range checked */
+    STACK_CFG_TYPE_STR,                 /* NUL terminated string */
+    STACK_CFG_TYPE_ARRAY                /* byte array, length stored in len_offset */
+};
+
+typedef struct
+{
+    unsigned char   id;                 /* STACK_CFG_xxx */
+    unsigned char   type;               /* STACK_CFG_TYPE_xxx */
+    const char*     name;
+    size_t          offset;             /* field in tSTACK_CONFIG */
+    size_t          size;               /* size of the field */
+    size_t          len_offset;         /* length field of an array */
+    unsigned long   def;                /* default of a numerical value */
+    const char*     def_str;            /* default of a string */
+    unsigned long   min;
+    unsigned long   max;
+} tSTACK_CFG_ENTRY;
+
+#define STACK_CFG_FIELD(f)              offsetof(tSTACK_CONFIG, f), sizeof(((tSTACK_CONFIG*)0)->f)
+#define STACK_CFG_NUM(id, f, d, lo, hi) {id, STACK_CFG_TYPE_NUM, NAME_##id, STACK_CFG_FIELD(f), 0, d, NULL, lo, hi}
+#define STACK_CFG_STR(id, f, d)         {id, STACK_CFG_TYPE_STR, NAME_##id, STACK_CFG_FIELD(f), 0, 0, d, 0, 0}
+#define STACK_CFG_ARRAY(id, f)          {id, STACK_CFG_TYPE_ARRAY, NAME_##id, STACK_CFG_FIELD(f), offsetof(tSTACK_CONFIG, f##_len), 0, NULL, 0, 0}
+
+/* map the STACK_CFG_xxx ids onto the existing NAME_xxx setting names */
+#define NAME_STACK_CFG_USE_RAW_NCI_TRACE        NAME_USE_RAW_NCI_TRACE
+#define NAME_STACK_CFG_APPL_TRACE_LEVEL         NAME_APPL_TRACE_LEVEL
+#define NAME_STACK_CFG_PROTOCOL_TRACE_LEVEL     NAME_PROTOCOL_TRACE_LEVEL
+#define NAME_STACK_CFG_NFA_STORAGE              NAME_NFA_STORAGE
+#define NAME_STACK_CFG_NFA_DM_CFG               NAME_NFA_DM_CFG
+#define NAME_STACK_CFG_NFA_MAX_EE_SUPPORTED     NAME_NFA_MAX_EE_SUPPORTED
+#define NAME_STACK_CFG_CE_T4T_MAX_REG_AID       NAME_CE_T4T_MAX_REG_AID
+#define NAME_STACK_CFG_NFA_POLL_BAIL_OUT_MODE   NAME_NFA_POLL_BAIL_OUT_MODE
+#define NAME_STACK_CFG_NFA_PROPRIETARY_CFG      NAME_NFA_PROPRIETARY_CFG
+#define NAME_STACK_CFG_DEVICE_HOST_WHITE_LIST   NAME_DEVICE_HOST_WHITE_LIST
+#define NAME_STACK_CFG_PRESERVE_STORAGE         NAME_PRESERVE_STORAGE
+#define NAME_STACK_CFG_NCI_HAL_MODULE           NAME_NCI_HAL_MODULE
+#define NAME_STACK_CFG_NCI_TRACE_RING           NAME_NCI_TRACE_RING
+#define NAME_STACK_CFG_DEFERRED_TRACE           NAME_DEFERRED_TRACE
+#define NAME_STACK_CFG_NFA_DM_DISC_ADAPTIVE     NAME_NFA_DM_DISC_ADAPTIVE
+#define NAME_STACK_CFG_NFA_DM_DISC_DURATION_POLL NAME_NFA_DM_DISC_DURATION_POLL
+#define NAME_STACK_CFG_PRESENCE_CHECK_ALGORITHM NAME_PRESENCE_CHECK_ALGORITHM
+#define NAME_STACK_CFG_POLL_FREQUENCY           NAME_POLL_FREQUENCY
+
+static const tSTACK_CFG_ENTRY sStackCfgTable[] =
+{
+    STACK_CFG_NUM   (STACK_CFG_USE_RAW_NCI_TRACE,       use_raw_nci_trace,      0, 0, 1),
+    STACK_CFG_NUM   (STACK_CFG_APPL_TRACE_LEVEL,        appl_trace_level,       1, 0, 0xFF),
+    STACK_CFG_NUM   (STACK_CFG_PROTOCOL_TRACE_LEVEL,    protocol_trace_level,   0, 0, 0xFFFFFFFF),
+    STACK_CFG_STR   (STACK_CFG_NFA_STORAGE,             nfa_storage,            default_storage_location),
+    STACK_CFG_ARRAY (STACK_CFG_NFA_DM_CFG,              nfa_dm_cfg),
+    STACK_CFG_NUM   (STACK_CFG_NFA_MAX_EE_SUPPORTED,    nfa_max_ee_supported,   0, 0, 0xFF),
+    STACK_CFG_NUM   (STACK_CFG_CE_T4T_MAX_REG_AID,      ce_t4t_max_reg_aid,     0, 1, 0xFD),    /* CE_T4T_MAX_REG_AID_LIMIT */
+    STACK_CFG_NUM   (STACK_CFG_NFA_POLL_BAIL_OUT_MODE,  nfa_poll_bail_out_mode, 0, 0, 1),
+    STACK_CFG_ARRAY (STACK_CFG_NFA_PROPRIETARY_CFG,     nfa_proprietary_cfg),
+    STACK_CFG_ARRAY (STACK_CFG_DEVICE_HOST_WHITE_LIST,  device_host_white_list),
+    STACK_CFG_NUM   (STACK_CFG_PRESERVE_STORAGE,        preserve_storage,       0, 0, 1),
+    STACK_CFG_STR   (STACK_CFG_NCI_HAL_MODULE,          nci_hal_module,         "nfc_nci.bcm2079x"),
+    STACK_CFG_NUM   (STACK_CFG_NCI_TRACE_RING,          nci_trace_ring,         0, 0, 1),
+    STACK_CFG_NUM   (STACK_CFG_DEFERRED_TRACE,          deferred_trace,         0, 0, 1),
+    STACK_CFG_NUM   (STACK_CFG_NFA_DM_DISC_ADAPTIVE,    nfa_dm_disc_adaptive,   0, 0, 1),
+    STACK_CFG_NUM   (STACK_CFG_NFA_DM_DISC_DURATION_POLL, nfa_dm_disc_duration_poll, 500, 0, 0xFFFF), /* NFA_DM_DISC_DURATION_POLL */
+    STACK_CFG_NUM   (STACK_CFG_PRESENCE_CHECK_ALGORITHM, presence_check_algorithm, 1, 0, 4),      /* NFA_RW_PRES_CHK_xxx */
+    STACK_CFG_ARRAY (STACK_CFG_POLL_FREQUENCY,          poll_frequency),
+};
+
+/* a reload parses the config files into a setting array of its own, fills a
+** new snapshot from it and then publishes it; the settings read through
+** GetStrValue() and GetNumValue() are not touched. Published snapshots are
+** never rewritten, the oldest is freed once STACK_CFG_MAX_SNAPSHOTS are kept,
+** so readers must not keep the pointer across reloads */
+#define STACK_CFG_MAX_SNAPSHOTS         4
+static vector<tSTACK_CONFIG*>   sStackCfgSnapshots;
+static tSTACK_CONFIG*           sStackCfg = NULL;
+static vector<string>           sOptionalConfigs;   /* read by readOptionalConfig(), in order */
+static pthread_mutex_t          sStackCfgLock = PTHREAD_MUTEX_INITIALIZER;
+
+/*******************************************************************************
+**
+** Function:    CNfcConfig::Load()
+**
+** Description: read the config file and the optional config files read so
+**              far into a new setting array, the singleton is not touched;
+**              called with sStackCfgLock held
+**
+** Returns:     new setting array, to be cleaned and deleted by the caller
+**
+*******************************************************************************/
+CNfcConfig* CNfcConfig::Load()
+{
+    CNfcConfig* pConfig = new CNfcConfig;
+    string strPath;
+
+    strPath.assign(transport_config_path);
+    strPath += config_name;
+    pConfig->readConfig(strPath.c_str(), true);
+
+    for (size_t i = 0; i < sOptionalConfigs.size(); ++i)
+    {
+        strPath.assign(transport_config_path);
+        strPath += extra_config_base;
+        strPath += sOptionalConfigs[i];
+        strPath += extra_config_ext;
+        pConfig->readConfig(strPath.c_str(), false);
+    }
+    return pConfig;
+}
+
+/*******************************************************************************
+**
+** Function:    fillStackConfig()
+**
+** Description: parse the settings of the registry into a snapshot, settings
+**              that are missing, out of range or too long for their field
+**              get their default value
+**
+** Returns:     none
+**
+*******************************************************************************/
+static void fillStackConfig(tSTACK_CONFIG* pCfg, const CNfcConfig& rConfig)
+{
+    memset(pCfg, 0, sizeof(tSTACK_CONFIG));
+
+    for (size_t i = 0; i < sizeof(sStackCfgTable) / sizeof(sStackCfgTable[0]); ++i)
+    {
+        const tSTACK_CFG_ENTRY* pEntry = &sStackCfgTable[i];
+        unsigned char* pField = (unsigned char*)pCfg + pEntry->offset;
+        const CNfcParam* pParam = rConfig.find(pEntry->name);
+        unsigned long v = pEntry->def;
+        size_t len = pEntry->size;
+
+        /* a string needs room for its NUL */
+        if (pEntry->type != STACK_CFG_TYPE_NUM && pParam != NULL
+            && pParam->str_len() + (pEntry->type == STACK_CFG_TYPE_STR ? 1 : 0) > pEntry->size)
+        {
+            ALOGE("%s: %s is %u bytes, longer than %u, ignored\n", __func__, pEntry->name,
+                  (unsigned)pParam->str_len(), (unsigned)pEntry->size);
+            pParam = NULL;
+        }
+
+        switch (pEntry->type)
+        {
+        case STACK_CFG_TYPE_NUM:
+            if (pParam != NULL)
+            {
+                v = paramNumValue(pParam);
+                if (v < pEntry->min || v > pEntry->max)
+                {
+                    ALOGE("%s: %s=0x%lX out of range, using 0x%lX\n", __func__, pEntry->name, v, pEntry->def);
+                    v = pEntry->def;
+                }
+                else
+                    pCfg->present |= 1UL << pEntry->id;
+            }
+            if (pEntry->size == sizeof(unsigned char))
+                *pField = (unsigned char)v;
+            else if (pEntry->size == sizeof(unsigned short))
+                *(unsigned short*)pField = (unsigned short)v;
+            else
+                *(unsigned long*)pField = v;
+            break;
+        case STACK_CFG_TYPE_STR:
+            if (pParam != NULL && rConfig.getValue(pEntry->name, (char*)pField, len))
+                pCfg->present |= 1UL << pEntry->id;
+            else
+                strlcpy((char*)pField, pEntry->def_str, pEntry->size);
+            pField[pEntry->size - 1] = '\0';
+            break;
+        case STACK_CFG_TYPE_ARRAY:
+            if (pParam == NULL || !rConfig.getValue(pEntry->name, (char*)pField, len))
+                len = 0;
+            if (len > 0)
+                pCfg->present |= 1UL << pEntry->id;
+            *((unsigned char*)pCfg + pEntry->len_offset) = (unsigned char)len;
+            break;
+        }
+    }
+}
+
+/*******************************************************************************
+**
+** Function:    loadStackConfig()
+**
+** Description: parse a new snapshot of the stack settings and publish it;
+**              the first snapshot is filled from the settings already read,
+**              a reload reads the config files again
+**
+** Returns:     the new snapshot
+**
+*******************************************************************************/
+static const tSTACK_CONFIG* loadStackConfig(bool bReload)
+{
+    tSTACK_CONFIG* pCfg;
+
+    pthread_mutex_lock(&sStackCfgLock);
+    pCfg = __atomic_load_n(&sStackCfg, __ATOMIC_ACQUIRE);
+    if (bReload || pCfg == NULL)
+    {
+        pCfg = new tSTACK_CONFIG;
+        if (bReload)
+        {
+            CNfcConfig* pConfig = CNfcConfig::Load();
+            fillStackConfig(pCfg, *pConfig);
+            pConfig->clean();
+            delete pConfig;
+        }
+        else
+            fillStackConfig(pCfg, CNfcConfig::GetInstance());
+
+        sStackCfgSnapshots.push_back(pCfg);
+        __atomic_store_n(&sStackCfg, pCfg, __ATOMIC_RELEASE);
+        if (sStackCfgSnapshots.size() > STACK_CFG_MAX_SNAPSHOTS)
+        {
+            delete sStackCfgSnapshots.front();
+            sStackCfgSnapshots.erase(sStackCfgSnapshots.begin());
+        }
+    }
+    pthread_mutex_unlock(&sStackCfgLock);
+    return pCfg;
+}
+
+/*******************************************************************************
+**
+** Function:    GetStackConfig
+**
+** Description: API function for getting the parsed stack settings, the config
+**              file is parsed on first use only
+**
+** Returns:     pointer to the current snapshot
+**
+*******************************************************************************/
+extern "C" const tSTACK_CONFIG* GetStackConfig()
+{
+    const tSTACK_CONFIG* pCfg = __atomic_load_n(&sStackCfg, __ATOMIC_ACQUIRE);
+
+    return pCfg ? pCfg : loadStackConfig(false);
+}
+
+/*******************************************************************************
+**
+** Function:    ReloadStackConfig
+**
+** Description: API function for re-reading the config files and swapping in
+**              a new snapshot of the stack settings; previous snapshots stay
+**              unchanged, the oldest is freed once STACK_CFG_MAX_SNAPSHOTS
+**              are kept
+**
+** Returns:     pointer to the new snapshot
+**
+*******************************************************************************/
+extern "C" const tSTACK_CONFIG* ReloadStackConfig()
+{
+    return loadStackConfig(true);
+}
+
 /*******************************************************************************
 **
 ** Function:    resetConfig
 **
-** Description: reset settings array
+** Description: reset settings array and free the stack settings snapshots
 **
 ** Returns:     none
 **
@@ -727,7 +962,13 @@ extern void resetConfig()
 {
     CNfcConfig& rConfig = CNfcConfig::GetInstance();
 
+    pthread_mutex_lock(&sStackCfgLock);
     rConfig.clean();
+    __atomic_store_n(&sStackCfg, (tSTACK_CONFIG*)NULL, __ATOMIC_RELEASE);
+    for (size_t i = 0; i < sStackCfgSnapshots.size(); ++i)
+        delete sStackCfgSnapshots[i];
+    sStackCfgSnapshots.clear();
+    pthread_mutex_unlock(&sStackCfgLock);
 }
 
 /*******************************************************************************
@@ -747,5 +988,10 @@ void readOptionalConfig(const char* extra)
     strPath += extra;
     strPath += extra_config_ext;
     CNfcConfig::GetInstance().readConfig(strPath.c_str(), false);
+
+    pthread_mutex_lock(&sStackCfgLock);
+    if (std::find(sOptionalConfigs.begin(), sOptionalConfigs.end(), extra) == sOptionalConfigs.end())
+        sOptionalConfigs.push_back(extra);
+    pthread_mutex_unlock(&sStackCfgLock);
 }
 
@@ -27,7 +27,7 @@
 #include "nfc_hal_target.h"
 #include "nfc_hal_nv_co.h"
 #include "nfa_nv_ci.h"
-#include "CrcChecksum.h"
+#include "NvJournal.h"
 extern char bcm_nfc_location[];
 static const char* sNfaStorageBin = "/nfaStorage.bin";
 
@@ -100,27 +100,15 @@ extern void nfa_nv_co_read(UINT8 *pBuffer, UINT16 nbytes, UINT8 block)
     sprintf (filename, "%s%u", filename2, block);
 
     ALOGD ("%s: buffer len=%u; file=%s", __FUNCTION__, nbytes, filename);
-    int fileStream = open (filename, O_RDONLY);
-    if (fileStream >= 0)
+    int actualReadData = nvJournalRead (filename, pBuffer, nbytes);
+    if (actualReadData > 0)
     {
-        unsigned short checksum = 0;
-        size_t actualReadCrc = read (fileStream, &checksum, sizeof(checksum));
-        size_t actualReadData = read (fileStream, pBuffer, nbytes);
-        close (fileStream);
-        if (actualReadData > 0)
-        {
-            ALOGD ("%s: data size=%zu", __FUNCTION__, actualReadData);
-            nfa_nv_ci_read (actualReadData, NFA_NV_CO_OK, block);
-        }
-        else
-        {
-            ALOGE ("%s: fail to read", __FUNCTION__);
-            nfa_nv_ci_read (0, NFA_NV_CO_FAIL, block);
-        }
+        ALOGD ("%s: data size=%d", __FUNCTION__, actualReadData);
+        nfa_nv_ci_read (actualReadData, NFA_NV_CO_OK, block);
     }
     else
     {
-        ALOGD ("%s: fail to open", __FUNCTION__);
+        ALOGD ("%s: fail to read", __FUNCTION__);
         nfa_nv_ci_read (0, NFA_NV_CO_FAIL, block);
     }
 }
@@ -159,29 +147,13 @@ extern void nfa_nv_co_write(const UINT8 *pBuffer, UINT16 nbytes, UINT8 block)
     sprintf (filename, "%s%u", filename2, block);
     ALOGD ("%s: bytes=%u; file=%s", __FUNCTION__, nbytes, filename);
 
-    int fileStream = 0;
-
-    fileStream = open (filename, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
-    if (fileStream >= 0)
+    if (nvJournalWrite (filename, pBuffer, nbytes))
     {
-        unsigned short checksum = crcChecksumCompute (pBuffer, nbytes);
-        size_t actualWrittenCrc = write (fileStream, &checksum, sizeof(checksum));
-        size_t actualWrittenData = write (fileStream, pBuffer, nbytes);
-        ALOGD ("%s: %zu bytes written", __FUNCTION__, actualWrittenData);
-        if ((actualWrittenData == nbytes) && (actualWrittenCrc == sizeof(checksum)))
-        {
-            nfa_nv_ci_write (NFA_NV_CO_OK);
-        }
-        else
-        {
-            ALOGE ("%s: fail to write", __FUNCTION__);
-            nfa_nv_ci_write (NFA_NV_CO_FAIL);
-        }
-        close (fileStream);
+        nfa_nv_ci_write (NFA_NV_CO_OK);
     }
     else
     {
-        ALOGE ("%s: fail to open, error = %d", __FUNCTION__, errno);
+        ALOGE ("%s: fail to write", __FUNCTION__);
         nfa_nv_ci_write (NFA_NV_CO_FAIL);
     }
 }
@@ -218,15 +190,15 @@ void delete_stack_non_volatile_store (BOOLEAN forceDelete)
         return;
     }
     sprintf (filename, "%s%u", filename2, DH_NV_BLOCK);
-    remove (filename);
+    nvJournalDelete (filename);
     sprintf (filename, "%s%u", filename2, HC_F3_NV_BLOCK);
-    remove (filename);
+    nvJournalDelete (filename);
     sprintf (filename, "%s%u", filename2, HC_F4_NV_BLOCK);
-    remove (filename);
+    nvJournalDelete (filename);
     sprintf (filename, "%s%u", filename2, HC_F2_NV_BLOCK);
-    remove (filename);
+    nvJournalDelete (filename);
     sprintf (filename, "%s%u", filename2, HC_F5_NV_BLOCK);
-    remove (filename);
+    nvJournalDelete (filename);
 }
 
 /*******************************************************************************
@@ -257,19 +229,19 @@ void verify_stack_non_volatile_store ()
     }
 
     sprintf (filename, "%s%u", filename2, DH_NV_BLOCK);
-    if (crcChecksumVerifyIntegrity (filename))
+    if (nvJournalVerify (filename))
     {
         sprintf (filename, "%s%u", filename2, HC_F3_NV_BLOCK);
-        if (crcChecksumVerifyIntegrity (filename))
+        if (nvJournalVerify (filename))
         {
             sprintf (filename, "%s%u", filename2, HC_F4_NV_BLOCK);
-            if (crcChecksumVerifyIntegrity (filename))
+            if (nvJournalVerify (filename))
             {
                 sprintf (filename, "%s%u", filename2, HC_F2_NV_BLOCK);
-                if (crcChecksumVerifyIntegrity (filename))
+                if (nvJournalVerify (filename))
                 {
                     sprintf (filename, "%s%u", filename2, HC_F5_NV_BLOCK);
-                    if (crcChecksumVerifyIntegrity (filename))
+                    if (nvJournalVerify (filename))
                         isValid = TRUE;
                 }
             }
@@ -409,6 +409,7 @@ typedef UINT8 tNCI_DISCOVERY_TYPE;
 #define NCI_ROUTE_TAG_TECH              0x00        /* Technology based routing  */
 #define NCI_ROUTE_TAG_PROTO             0x01        /* Protocol based routing  */
 #define NCI_ROUTE_TAG_AID               0x02        /* AID routing */
+#define NCI_ROUTE_QUAL_AID_PREFIX       0x10        /* AID routing matches the AID as a prefix */
 
 #define NCI_ROUTE_PWR_STATE_ON          0x01        /* The device is on */
 #define NCI_ROUTE_PWR_STATE_SWITCH_OFF  0x02        /* The device is switched off */
@@ -98,6 +98,17 @@
 #define NFC_HAL_PRM_MIN_NCI_CMD_PAYLOAD_SIZE    (32)
 #endif
 
+/* Default number of SPD patch segments in flight (1 is stop-and-wait). */
+/* Can be changed with HAL_NfcPrmSetSpdWindow                              */
+#ifndef NFC_HAL_PRM_SPD_WINDOW
+#define NFC_HAL_PRM_SPD_WINDOW                  (1)
+#endif
+
+/* Max number of SPD patch segments in flight */
+#ifndef NFC_HAL_PRM_SPD_MAX_WINDOW
+#define NFC_HAL_PRM_SPD_MAX_WINDOW              (8)
+#endif
+
 /* amount of time to wait for authenticating/committing patch to NVM */
 #ifndef NFC_HAL_PRM_COMMIT_DELAY
 #define NFC_HAL_PRM_COMMIT_DELAY                (30000)
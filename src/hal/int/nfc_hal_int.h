@@ -198,10 +198,8 @@ typedef UINT8 tNFC_HAL_LP_EVT;
 
 #if (NFC_HAL_DEBUG == TRUE)
 extern const char * const nfc_hal_init_state_str[];
-#define NFC_HAL_SET_INIT_STATE(state)  HAL_TRACE_DEBUG3 ("init state: %d->%d(%s)", nfc_hal_cb.dev_cb.initializing_state, state, nfc_hal_init_state_str[state]); nfc_hal_cb.dev_cb.initializing_state = state;
-#else
-#define NFC_HAL_SET_INIT_STATE(state)  nfc_hal_cb.dev_cb.initializing_state = state;
 #endif
+#define NFC_HAL_SET_INIT_STATE(state)  nfc_hal_dm_set_init_state (state);
 
 
 /* NFC HAL - NFCC initializing state */
@@ -235,6 +233,16 @@ enum
 };
 typedef UINT8 tNFC_HAL_DM_CONFIG;
 
+/* Post initialization steps in a mask: one bit per config item, then one
+** bit per start-up VSC (those after NFC_HAL_DM_STARTUP_MAX_VSC have no bit) */
+#define NFC_HAL_DM_STARTUP_MAX_VSC          (32 - NFC_HAL_DM_CONFIG_START_UP_VSC)
+#define NFC_HAL_DM_STARTUP_STEP(config)     ((UINT32) 1 << (config))
+#define NFC_HAL_DM_STARTUP_VSC_STEP(idx)    (((idx) < NFC_HAL_DM_STARTUP_MAX_VSC) ? NFC_HAL_DM_STARTUP_STEP (NFC_HAL_DM_CONFIG_START_UP_VSC + (idx)) : 0)
+
+/* Steps that can be skipped when NFCC is known to reject them. Set config
+** items are never skipped: NFCC sets the valid parameters of a rejected set. */
+#define NFC_HAL_DM_STARTUP_SKIPPABLE        (~(NFC_HAL_DM_STARTUP_STEP (NFC_HAL_DM_CONFIG_FW_FSM) - 1))
+
 /* callback function prototype */
 typedef struct
 {
@@ -326,6 +334,13 @@ typedef struct
 
     tNFC_HAL_PRM_PATCHDESC spd_patch_desc[NFC_HAL_PRM_MAX_PATCH_COUNT];
 
+    /* Windowed download (patch in a buffer only) */
+    UINT8               spd_window;             /* max segments in flight                  */
+    UINT8               spd_in_flight;          /* segments sent, waiting for response     */
+    UINT8               spd_next_type;          /* SPD type of p_spd_next                  */
+    NFC_HDR            *p_spd_next;             /* next segment, built while waiting       */
+    UINT16              spd_patch_start;        /* offset of current patch, for restart    */
+
     /* I2C-patch */
     UINT8               *p_spd_patch;           /* pointer to spd patch             */
     UINT16              spd_patch_len_remaining;/* patch length                     */
@@ -382,6 +397,12 @@ typedef struct
     UINT32                  brcm_hw_id;             /* BRCM NFCC HW ID                          */
     tNFC_HAL_DM_CONFIG      next_dm_config;         /* next config in post initialization       */
     UINT8                   next_startup_vsc;       /* next start-up VSC offset in post init    */
+    UINT8                   startup_vsc_idx;        /* index of next start-up VSC               */
+    UINT32                  startup_sent_mask;      /* post init steps waiting for response     */
+    UINT32                  startup_rej_mask;       /* post init steps rejected by NFCC         */
+    UINT32                  startup_skip_mask;      /* post init steps to skip                  */
+    UINT32                  startup_step_time;      /* time last post init step was sent (us)   */
+    UINT32                  init_state_time;        /* time initializing_state was set (us)     */
 
     tNFC_HAL_POWER_MODE     power_mode;             /* NFCC power mode                          */
     UINT8                   snooze_mode;            /* current snooze mode                      */
@@ -440,6 +461,7 @@ typedef struct
     UINT8                   pre_discover_done;  /* TRUE, when the prediscover config is complete */
     tNFC_HAL_FLAGS          hal_flags;
     UINT8                   pre_set_mem_idx;
+    UINT8                   prm_spd_window;     /* SPD segments in flight (HAL_NfcPrmSetSpdWindow) */
 
     UINT8                   max_rf_credits;     /* NFC Max RF data credits */
     UINT8                   max_ee;             /* NFC Max number of NFCEE supported by NFCC */
@@ -471,6 +493,7 @@ void   nfc_hal_send_nci_msg_to_nfc_task (NFC_HDR * p_msg);
 
 /* nfc_hal_nci.c */
 BOOLEAN nfc_hal_nci_receive_msg (UINT8 byte);
+UINT16  nfc_hal_nci_receive_span (UINT8 *p_data, UINT16 len, BOOLEAN *p_msg_received);
 BOOLEAN nfc_hal_nci_preproc_rx_nci_msg (NFC_HDR *p_msg);
 NFC_HDR* nfc_hal_nci_postproc_rx_nci_msg (void);
 void    nfc_hal_nci_assemble_nci_msg (void);
@@ -480,6 +503,7 @@ void    nfc_hal_nci_cmd_timeout_cback (void *p_tle);
 
 /* nfc_hal_dm.c */
 void nfc_hal_dm_init (void);
+void nfc_hal_dm_set_init_state (tNFC_HAL_INIT_STATE state);
 void nfc_hal_dm_set_xtal_freq_index (void);
 void nfc_hal_dm_set_power_level_zero (void);
 void nfc_hal_dm_send_get_build_info_cmd (void);
@@ -266,6 +266,47 @@ void HAL_NfcPrmSetI2cPatch (UINT8 *p_i2c_patchfile_buf,
 *******************************************************************************/
 tHAL_NFC_STATUS HAL_NfcPrmSetSpdNciCmdPayloadSize (UINT8 max_payload_size);
 
+/*******************************************************************************
+**
+** Function         HAL_NfcPrmSetSpdWindow
+**
+** Description      Set the number of segments that may be sent to NFCC
+**                  without waiting for their responses during secure patch
+**                  download. Only used when the patch is given in a buffer.
+**
+**                  This API must be called before calling HAL_NfcPrmDownloadStart.
+**                  If the API is not called, then PRM will use
+**                  NFC_HAL_PRM_SPD_WINDOW.
+**
+**                  If NFCC rejects a segment, the patch is downloaded again
+**                  one segment at a time.
+**
+**                  Valid window range: 1 (stop-and-wait) to NFC_HAL_PRM_SPD_MAX_WINDOW.
+**
+** Returns          HAL_NFC_STATUS_OK if successful
+**                  HAL_NFC_STATUS_FAILED otherwise
+**
+**
+*******************************************************************************/
+tHAL_NFC_STATUS HAL_NfcPrmSetSpdWindow (UINT8 window);
+
+/*******************************************************************************
+**
+** Function         HAL_NfcSetStartupSkipMask
+**
+** Description      Set the post initialization steps to skip, because NFCC
+**                  rejected them before with the same chip, patch and
+**                  configuration. See NFC_HAL_DM_STARTUP_STEP.
+**
+**                  This API is called by nfc_hal_post_reset_init (); the mask
+**                  applies to the following post initialization only. Only
+**                  the steps in NFC_HAL_DM_STARTUP_SKIPPABLE are skipped.
+**
+** Returns          none
+**
+*******************************************************************************/
+void HAL_NfcSetStartupSkipMask (UINT32 skip_mask);
+
 /*******************************************************************************
 **
 ** Function         HAL_NfcSetMaxRfDataCredits
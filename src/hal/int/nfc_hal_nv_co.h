@@ -58,6 +58,7 @@ typedef UINT8 tNFC_HAL_NV_CO_STATUS;
 #define  HC_F4_NV_BLOCK         0x03
 #define  HC_F2_NV_BLOCK         0x04
 #define  HC_F5_NV_BLOCK         0x05
+#define  HAL_STARTUP_NV_BLOCK   0x06    /* start-up state of the HAL adaptation */
 
 /*****************************************************************************
 **  Function Declarations
@@ -71,4 +71,13 @@ extern tNFC_POST_RESET_CB nfc_post_reset_cb;
 */
 void nfc_hal_post_reset_init (UINT32 brcm_hw_id, UINT8 nvm_type);
 
+/*
+** Post initialization result handler
+**
+** This function is called when the NFCC configuration after CORE_INIT is done,
+** with the mask of steps NFCC rejected (skipped steps included). It may be
+** saved and given back with HAL_NfcSetStartupSkipMask() on the next start up.
+*/
+void nfc_hal_post_init_result (UINT32 rejected_mask);
+
 #endif  /* NFC_HAL_POST_RESET_H */
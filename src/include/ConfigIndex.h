@@ -0,0 +1,142 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2015 Broadcom Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  Hash index of config file settings, shared by the config parsers of the
+ *  stack and the HALs. Each parser keeps its own setting class, derived from
+ *  std::string holding the setting name, so the index is written as
+ *  templates over that class.
+ *
+ ******************************************************************************/
+#pragma once
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+
+/*******************************************************************************
+**
+** Function:    configHashName()
+**
+** Description: FNV-1a hash of a setting name
+**
+** Returns:     hash value
+**
+*******************************************************************************/
+inline unsigned long configHashName(const char* p_name)
+{
+    unsigned long h = 2166136261UL;
+
+    while (*p_name)
+    {
+        h ^= (unsigned char) *p_name++;
+        h *= 16777619UL;
+    }
+    return h;
+}
+
+/*******************************************************************************
+**
+** Function:    configParamLess()
+**
+** Description: order setting objects by name
+**
+** Returns:     true if the name of pA sorts before the name of pB
+**
+*******************************************************************************/
+template <class T>
+bool configParamLess(const T* pA, const T* pB)
+{
+    return *pA < *pB;
+}
+
+/*******************************************************************************
+**
+** Function:    configBuildIndex()
+**
+** Description: sort the setting array by name, drop settings overridden by a
+**              later definition of the same name, and rebuild the hash
+**              index used by configFind()
+**              params: setting array, owns the setting objects.
+**              index: hash slot -> setting array index + 1, 0 if empty.
+**
+** Returns:     none
+**
+*******************************************************************************/
+template <class T>
+void configBuildIndex(std::vector<const T*>& params, std::vector<size_t>& index)
+{
+    size_t n = 0;
+    size_t mask;
+
+    index.clear();
+    if (params.size() == 0)
+        return;
+
+    // stable sort keeps definitions of the same name in file order, the last
+    // one read (e.g. from an optional config) is the one that is kept
+    std::stable_sort(params.begin(), params.end(), configParamLess<T>);
+    for (size_t i = 0; i < params.size(); ++i)
+    {
+        if (i + 1 < params.size() && *params[i] == *params[i + 1])
+            delete params[i];
+        else
+            params[n++] = params[i];
+    }
+    params.resize(n);
+
+    // open addressing table, at most half full
+    for (mask = 16; mask < 2 * n; mask <<= 1)
+        ;
+    index.assign(mask--, 0);
+    for (size_t i = 0; i < n; ++i)
+    {
+        size_t slot = configHashName(params[i]->c_str()) & mask;
+        while (index[slot] != 0)
+            slot = (slot + 1) & mask;
+        index[slot] = i + 1;
+    }
+}
+
+/*******************************************************************************
+**
+** Function:    configFind()
+**
+** Description: search for a setting by name in the index built by
+**              configBuildIndex()
+**
+** Returns:     pointer to the setting object, NULL if not found
+**
+*******************************************************************************/
+template <class T>
+const T* configFind(const std::vector<const T*>& params, const std::vector<size_t>& index, const char* p_name)
+{
+    if (index.empty())
+        return NULL;
+
+    size_t mask = index.size() - 1;
+    for (size_t slot = configHashName(p_name) & mask; index[slot] != 0; slot = (slot + 1) & mask)
+    {
+        const T* pParam = params[index[slot] - 1];
+        if (*pParam == p_name)
+            return pParam;
+    }
+    return NULL;
+}
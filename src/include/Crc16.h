@@ -0,0 +1,72 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2015 Broadcom Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  CRC-16 kernels shared by the stack and the HALs. Both variants process
+ *  eight bytes per step with slice-by-8 tables (built on first use), and
+ *  take the running CRC so that a buffer can be processed in pieces.
+ *  Only fixed-width types are used so that the HALs can include this file.
+ *
+ ******************************************************************************/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*******************************************************************************
+**
+** Function         crc16Arc
+**
+** Description      Compute CRC-16/ARC (reflected polynomial 0xA001) over a
+**                  buffer. Initial value of a new computation is 0.
+**                  crc: CRC of the preceding data.
+**                  buffer: data.
+**                  bufferLen: length of data.
+**
+** Returns          2-byte CRC.
+**
+*******************************************************************************/
+uint16_t crc16Arc (uint16_t crc, const uint8_t *buffer, size_t bufferLen);
+
+
+/*******************************************************************************
+**
+** Function         crc16Ccitt
+**
+** Description      Compute CRC-16/CCITT (polynomial 0x1021, not reflected)
+**                  over a buffer. Initial value is 0xFFFF for the PN54X
+**                  download protocol.
+**                  crc: CRC of the preceding data.
+**                  buffer: data.
+**                  bufferLen: length of data.
+**
+** Returns          2-byte CRC.
+**
+*******************************************************************************/
+uint16_t crc16Ccitt (uint16_t crc, const uint8_t *buffer, size_t bufferLen);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,83 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2015 Broadcom Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  Binary NCI trace shared by the stack and the HALs. Every thread that
+ *  traces NCI packets owns a ring of its most recent packets; a dump writes
+ *  all rings to a file in the layout of nci_trace_file.h, for decoding with
+ *  tools/nci_trace/nci_trace_decode.
+ *  Only fixed-width types are used so that the HALs can include this file.
+ *
+ ******************************************************************************/
+#pragma once
+
+#include <stdint.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*******************************************************************************
+**
+** Function         nciTraceRingEnable
+**
+** Description      Enable or disable the binary NCI trace.
+**                  enable: nonzero to keep NCI packets in the rings.
+**                  dumpFile: file written by nciTraceRingDump(), or NULL to
+**                  keep the current one.
+**
+** Returns          None.
+**
+*******************************************************************************/
+void nciTraceRingEnable (int enable, const char *dumpFile);
+
+
+/*******************************************************************************
+**
+** Function         nciTraceRingRecord
+**
+** Description      Copy an NCI packet into the ring of the calling thread,
+**                  if the binary NCI trace is enabled. Takes no lock.
+**                  nciPacket: NCI packet.
+**                  nciPacketLen: length of the packet.
+**                  is_recv: nonzero if received from NFCC.
+**
+** Returns          1 if the packet was traced, 0 if the trace is disabled.
+**
+*******************************************************************************/
+int nciTraceRingRecord (const uint8_t *nciPacket, uint16_t nciPacketLen, int is_recv);
+
+
+/*******************************************************************************
+**
+** Function         nciTraceRingDump
+**
+** Description      Write the NCI packets in the rings of all threads to the
+**                  dump file. Does nothing if the trace is disabled.
+**
+** Returns          None.
+**
+*******************************************************************************/
+void nciTraceRingDump (void);
+
+
+#ifdef __cplusplus
+}
+#endif
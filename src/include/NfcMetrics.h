@@ -0,0 +1,205 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2015 Broadcom Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  Latency and throughput metrics.
+ *
+ *  Each metric counts events and bytes, and keeps a histogram of latencies
+ *  in microseconds. Buckets are log-linear: 8 buckets per power of two, so
+ *  a percentile read from the histogram is within 12.5% of the real value.
+ *  Recording only uses atomic adds, so any thread can record without a
+ *  lock. A snapshot can be taken or dumped at any time, for example from
+ *  the dump() of the NFC service; it is not atomic across metrics.
+ *
+ *  libnfc-nci and the bcm2079x HAL each have their own registry.
+ *
+ ******************************************************************************/
+#pragma once
+#include "data_types.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Metric identifiers */
+enum
+{
+    NFC_METRIC_HAL_WRITE,           /* stack: time in HAL write                 */
+    NFC_METRIC_HAL_READ,            /* stack: data received from HAL            */
+    NFC_METRIC_NCI_CMD_RSP,         /* stack: NCI command sent to response      */
+    NFC_METRIC_DATA_CREDIT_WAIT,    /* stack: data waiting for NFCC credit      */
+    NFC_METRIC_LLCP_PDU_TX,         /* stack: LLCP PDU sent, time since last rx */
+    NFC_METRIC_LLCP_PDU_RX,         /* stack: LLCP PDU received                 */
+    NFC_METRIC_NFA_MSG,             /* stack: NFA API message sent to handled   */
+    NFC_METRIC_USERIAL_WRITE,       /* HAL: time in write() to NFCC             */
+    NFC_METRIC_USERIAL_READ,        /* HAL: time in read() from NFCC            */
+    NFC_METRIC_USERIAL_POLL,        /* HAL: time waiting for data from NFCC     */
+    NFC_METRIC_MAX
+};
+
+#define NFC_METRICS_BUCKETS     240     /* covers 0 .. 2^32 us */
+
+/* Snapshot of one metric */
+typedef struct
+{
+    const char  *name;
+    UINT32      count;
+    UINT64      bytes;
+    UINT32      samples;                /* events recorded with latency */
+    UINT64      total_us;               /* sum of latencies */
+    UINT32      max_us;
+    UINT32      p50_us;
+    UINT32      p90_us;
+    UINT32      p99_us;
+    UINT32      p999_us;
+} tNFC_METRIC_SNAPSHOT;
+
+
+/*******************************************************************************
+**
+** Function         nfcMetricsNow
+**
+** Description      Get a timestamp for latencies. It wraps around every 71
+**                  minutes; the difference of two timestamps is still right
+**                  if they are less than that apart.
+**
+** Returns          Monotonic time in microseconds.
+**
+*******************************************************************************/
+UINT32 nfcMetricsNow (void);
+
+
+/*******************************************************************************
+**
+** Function         nfcMetricsRecord
+**
+** Description      Record an event with its latency.
+**                  id: metric.
+**                  latency_us: latency of event.
+**                  bytes: bytes carried by event.
+**
+** Returns          Number of events of the metric, this one included.
+**
+*******************************************************************************/
+UINT32 nfcMetricsRecord (UINT8 id, UINT32 latency_us, UINT32 bytes);
+
+
+/*******************************************************************************
+**
+** Function         nfcMetricsCount
+**
+** Description      Record an event without latency.
+**                  id: metric.
+**                  bytes: bytes carried by event.
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfcMetricsCount (UINT8 id, UINT32 bytes);
+
+
+/*******************************************************************************
+**
+** Function         nfcMetricsStart
+**
+** Description      Note the start time of an operation identified by a key,
+**                  typically the message that carries it. Up to 32 keys are
+**                  tracked at once; a start may replace another one, whose
+**                  latency is then not recorded.
+**                  p_key: operation.
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfcMetricsStart (const void *p_key);
+
+
+/*******************************************************************************
+**
+** Function         nfcMetricsStop
+**
+** Description      Record the latency of an operation noted by
+**                  nfcMetricsStart. Nothing is recorded if its start time is
+**                  not known.
+**                  id: metric.
+**                  p_key: operation.
+**                  bytes: bytes carried by operation.
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfcMetricsStop (UINT8 id, const void *p_key, UINT32 bytes);
+
+
+/*******************************************************************************
+**
+** Function         nfcMetricsSnapshot
+**
+** Description      Read all metrics.
+**                  p_snap: array of NFC_METRIC_MAX entries.
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfcMetricsSnapshot (tNFC_METRIC_SNAPSHOT *p_snap);
+
+
+/*******************************************************************************
+**
+** Function         nfcMetricsDump
+**
+** Description      Write one line of text per metric that has events.
+**                  fd: file descriptor.
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfcMetricsDump (int fd);
+
+
+/*******************************************************************************
+**
+** Function         nfcMetricsLog
+**
+** Description      Write a metric to the debug log.
+**                  id: metric.
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfcMetricsLog (UINT8 id);
+
+
+/*******************************************************************************
+**
+** Function         nfcMetricsReset
+**
+** Description      Clear all metrics. Events recorded at the same time may
+**                  be partly cleared.
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfcMetricsReset (void);
+
+
+#ifdef __cplusplus
+}
+#endif
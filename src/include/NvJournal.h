@@ -0,0 +1,107 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2015 Broadcom Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  Journaled storage of the stack's non-volatile blocks.
+ *
+ *  Each block file holds a header followed by records. The first record is
+ *  the whole block; each following record replaces one byte range of it. A
+ *  write appends a record covering only the bytes that changed. After
+ *  NV_JOURNAL_MAX_RECORDS records the file is compacted into a new file that
+ *  replaces the old one by rename. Every record has its own checksum, so a
+ *  record torn by a crash is dropped and the block reads as it was before
+ *  that write.
+ *
+ ******************************************************************************/
+#pragma once
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Number of records after which a block file is compacted */
+#ifndef NV_JOURNAL_MAX_RECORDS
+#define NV_JOURNAL_MAX_RECORDS      32
+#endif
+
+
+/*******************************************************************************
+**
+** Function         nvJournalRead
+**
+** Description      Read a block. The records are checked on the first read
+**                  of the block; later reads are served from memory.
+**                  filename: file name.
+**                  buffer: buffer to read into.
+**                  bufferLen: size of buffer.
+**
+** Returns          Number of bytes read, or -1 if file is missing or corrupt.
+**
+*******************************************************************************/
+int nvJournalRead (const char* filename, UINT8* buffer, UINT16 bufferLen);
+
+
+/*******************************************************************************
+**
+** Function         nvJournalWrite
+**
+** Description      Write a block. Only the bytes that differ from the last
+**                  content of the block are written to the file.
+**                  filename: file name.
+**                  buffer: data of the block.
+**                  bufferLen: length of data.
+**
+** Returns          True if data is on storage.
+**
+*******************************************************************************/
+BOOLEAN nvJournalWrite (const char* filename, const UINT8* buffer, UINT16 bufferLen);
+
+
+/*******************************************************************************
+**
+** Function         nvJournalVerify
+**
+** Description      Check that a block file is in a known format. Only the
+**                  header is read; records are checked by nvJournalRead.
+**                  Files of the former format are checked entirely.
+**                  filename: file name.
+**
+** Returns          True if file is good or does not exist.
+**
+*******************************************************************************/
+BOOLEAN nvJournalVerify (const char* filename);
+
+
+/*******************************************************************************
+**
+** Function         nvJournalDelete
+**
+** Description      Delete a block file and forget its content.
+**                  filename: file name.
+**
+** Returns          None
+**
+*******************************************************************************/
+void nvJournalDelete (const char* filename);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -244,6 +244,14 @@ EXPORT_API extern void BTTRC_StackTrace6(tBTTRC_LAYER_ID layer_id,
 #define BT_TRACE_PROTOCOL   TRUE  /* Android requires TRUE */
 #endif
 
+/* Highest trace level compiled into the stack. Trace messages of a more
+** verbose type are removed at compile time, together with the run-time check
+** of the layer trace level that guards them. Errors are compiled out only if
+** this is BT_TRACE_LEVEL_NONE. */
+#ifndef BT_TRACE_COMPILE_LEVEL
+#define BT_TRACE_COMPILE_LEVEL  BT_TRACE_LEVEL_DEBUG
+#endif
+
 /******************************************************************************
 **
 ** Trace Levels
@@ -586,25 +594,29 @@ EXPORT_API extern void BTTRC_StackTrace6(tBTTRC_LAYER_ID layer_id,
 
 #if (BT_USE_TRACES == TRUE)
 
-#define BT_TRACE_0(l,t,m)                           LogMsg_0((TRACE_CTRL_GENERAL | (l) | TRACE_ORG_STACK | (t)),(m))
-#define BT_TRACE_1(l,t,m,p1)                        LogMsg_1(TRACE_CTRL_GENERAL | (l) | TRACE_ORG_STACK | (t),(m),(UINT32)(p1))
-#define BT_TRACE_2(l,t,m,p1,p2)                     LogMsg_2(TRACE_CTRL_GENERAL | (l) | TRACE_ORG_STACK | (t),(m),(UINT32)(p1),   \
-                                                        (UINT32)(p2))
-#define BT_TRACE_3(l,t,m,p1,p2,p3)                  LogMsg_3(TRACE_CTRL_GENERAL | (l) | TRACE_ORG_STACK | (t),(m),(UINT32)(p1),   \
-                                                        (UINT32)(p2),(UINT32)(p3))
-#define BT_TRACE_4(l,t,m,p1,p2,p3,p4)               LogMsg_4(TRACE_CTRL_GENERAL | (l) | TRACE_ORG_STACK | (t),(m),(UINT32)(p1),   \
-                                                        (UINT32)(p2),(UINT32)(p3),(UINT32)(p4))
-#define BT_TRACE_5(l,t,m,p1,p2,p3,p4,p5)            LogMsg_5(TRACE_CTRL_GENERAL | (l) | TRACE_ORG_STACK | (t),(m),(UINT32)(p1),   \
+/* TRUE if trace type t is compiled in. Only the stack trace types
+** (TRACE_TYPE_ERROR .. TRACE_TYPE_DEBUG) are subject to BT_TRACE_COMPILE_LEVEL. */
+#define BT_TRACE_TYPE_COMPILED(t)   (((t) > TRACE_TYPE_STACK_ONLY_MAX) || ((t) < BT_TRACE_COMPILE_LEVEL))
+
+#define BT_TRACE_0(l,t,m)                           (BT_TRACE_TYPE_COMPILED(t) ? LogMsg_0((TRACE_CTRL_GENERAL | (l) | TRACE_ORG_STACK | (t)),(m)) : (void) 0)
+#define BT_TRACE_1(l,t,m,p1)                        (BT_TRACE_TYPE_COMPILED(t) ? LogMsg_1(TRACE_CTRL_GENERAL | (l) | TRACE_ORG_STACK | (t),(m),(UINT32)(p1)) : (void) 0)
+#define BT_TRACE_2(l,t,m,p1,p2)                     (BT_TRACE_TYPE_COMPILED(t) ? LogMsg_2(TRACE_CTRL_GENERAL | (l) | TRACE_ORG_STACK | (t),(m),(UINT32)(p1),   \
+                                                        (UINT32)(p2)) : (void) 0)
+#define BT_TRACE_3(l,t,m,p1,p2,p3)                  (BT_TRACE_TYPE_COMPILED(t) ? LogMsg_3(TRACE_CTRL_GENERAL | (l) | TRACE_ORG_STACK | (t),(m),(UINT32)(p1),   \
+                                                        (UINT32)(p2),(UINT32)(p3)) : (void) 0)
+#define BT_TRACE_4(l,t,m,p1,p2,p3,p4)               (BT_TRACE_TYPE_COMPILED(t) ? LogMsg_4(TRACE_CTRL_GENERAL | (l) | TRACE_ORG_STACK | (t),(m),(UINT32)(p1),   \
+                                                        (UINT32)(p2),(UINT32)(p3),(UINT32)(p4)) : (void) 0)
+#define BT_TRACE_5(l,t,m,p1,p2,p3,p4,p5)            (BT_TRACE_TYPE_COMPILED(t) ? LogMsg_5(TRACE_CTRL_GENERAL | (l) | TRACE_ORG_STACK | (t),(m),(UINT32)(p1),   \
                                                         (UINT32)(p2),(UINT32)(p3),(UINT32)(p4), \
-                                                        (UINT32)(p5))
-#define BT_TRACE_6(l,t,m,p1,p2,p3,p4,p5,p6)         LogMsg_6(TRACE_CTRL_GENERAL | (l) | TRACE_ORG_STACK | (t),(m),(UINT32)(p1),   \
+                                                        (UINT32)(p5)) : (void) 0)
+#define BT_TRACE_6(l,t,m,p1,p2,p3,p4,p5,p6)         (BT_TRACE_TYPE_COMPILED(t) ? LogMsg_6(TRACE_CTRL_GENERAL | (l) | TRACE_ORG_STACK | (t),(m),(UINT32)(p1),   \
                                                         (UINT32)(p2),(UINT32)(p3),(UINT32)(p4), \
-                                                        (UINT32)(p5),(UINT32)(p6))
+                                                        (UINT32)(p5),(UINT32)(p6)) : (void) 0)
 
-#define BT_ERROR_TRACE_0(l,m)                     LogMsg_0(TRACE_CTRL_GENERAL | (l) | TRACE_ORG_STACK | TRACE_TYPE_ERROR,(m))
-#define BT_ERROR_TRACE_1(l,m,p1)                  LogMsg_1(TRACE_CTRL_GENERAL | (l) | TRACE_ORG_STACK | TRACE_TYPE_ERROR,(m),(UINT32)(p1))
-#define BT_ERROR_TRACE_2(l,m,p1,p2)               LogMsg_2(TRACE_CTRL_GENERAL | (l) | TRACE_ORG_STACK | TRACE_TYPE_ERROR,(m),(UINT32)(p1),(UINT32)(p2))
-#define BT_ERROR_TRACE_3(l,m,p1,p2,p3)            LogMsg_3(TRACE_CTRL_GENERAL | (l) | TRACE_ORG_STACK | TRACE_TYPE_ERROR,(m),(UINT32)(p1),(UINT32)(p2),(UINT32)(p3))
+#define BT_ERROR_TRACE_0(l,m)                     BT_TRACE_0(l,TRACE_TYPE_ERROR,m)
+#define BT_ERROR_TRACE_1(l,m,p1)                  BT_TRACE_1(l,TRACE_TYPE_ERROR,m,p1)
+#define BT_ERROR_TRACE_2(l,m,p1,p2)               BT_TRACE_2(l,TRACE_TYPE_ERROR,m,p1,p2)
+#define BT_ERROR_TRACE_3(l,m,p1,p2,p3)            BT_TRACE_3(l,TRACE_TYPE_ERROR,m,p1,p2,p3)
 
 /* Define tracing for the HCI unit
 */
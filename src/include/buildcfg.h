@@ -85,6 +85,8 @@ extern void downloadFirmwarePatchFile (UINT32 brcm_hw_id);
 
 void ProtoDispAdapterDisplayNciPacket (UINT8* nciPacket, UINT16 nciPacketLen, BOOLEAN is_recv);
 #define DISP_NCI ProtoDispAdapterDisplayNciPacket
+void ProtoDispAdapterDumpNciTrace ();
+#define DUMP_NCI_TRACE ProtoDispAdapterDumpNciTrace
 #define LOGMSG_TAG_NAME "BrcmNfcNfa"
 
 #ifndef _TIMEB
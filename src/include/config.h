@@ -54,6 +54,9 @@ int GetNumValue(const char* name, void* p_value, unsigned long len);
 #define NAME_LOW_SPEED_TRANSPORT        "LOW_SPEED_TRANSPORT"
 #define NAME_NFC_WAKE_DELAY             "NFC_WAKE_DELAY"
 #define NAME_NFC_WRITE_DELAY            "NFC_WRITE_DELAY"
+#define NAME_NFC_WRITE_PACING           "NFC_WRITE_PACING"
+#define NAME_NFC_WRITE_GAP_MIN          "NFC_WRITE_GAP_MIN"
+#define NAME_NFC_WRITE_GAP_MAX          "NFC_WRITE_GAP_MAX"
 #define NAME_PERF_MEASURE_FREQ          "REPORT_PERFORMANCE_MEASURE"
 #define NAME_READ_MULTI_PACKETS         "READ_MULTIPLE_PACKETS"
 #define NAME_POWER_ON_DELAY             "POWER_ON_DELAY"
@@ -69,10 +72,12 @@ int GetNumValue(const char* name, void* p_value, unsigned long len);
 #define NAME_NFA_DM_DISC_DURATION_POLL  "NFA_DM_DISC_DURATION_POLL"
 #define NAME_SPD_DEBUG                  "SPD_DEBUG"
 #define NAME_SPD_MAXRETRYCOUNT          "SPD_MAX_RETRY_COUNT"
+#define NAME_SPD_WINDOW                 "SPD_WINDOW"
 #define NAME_SPI_NEGOTIATION            "SPI_NEGOTIATION"
 #define NAME_AID_FOR_EMPTY_SELECT       "AID_FOR_EMPTY_SELECT"
 #define NAME_PRESERVE_STORAGE           "PRESERVE_STORAGE"
 #define NAME_NFA_MAX_EE_SUPPORTED       "NFA_MAX_EE_SUPPORTED"
+#define NAME_CE_T4T_MAX_REG_AID         "CE_T4T_MAX_REG_AID"
 #define NAME_NFCC_ENABLE_TIMEOUT        "NFCC_ENABLE_TIMEOUT"
 #define NAME_NFA_DM_PRE_DISCOVERY_CFG   "NFA_DM_PRE_DISCOVERY_CFG"
 #define NAME_POLL_FREQUENCY             "POLL_FREQUENCY"
@@ -91,6 +96,9 @@ int GetNumValue(const char* name, void* p_value, unsigned long len);
 #define NAME_NFA_POLL_BAIL_OUT_MODE     "NFA_POLL_BAIL_OUT_MODE"
 #define NAME_NFA_PROPRIETARY_CFG        "NFA_PROPRIETARY_CFG"
 #define NAME_ISO_DEP_MAX_TRANSCEIVE "ISO_DEP_MAX_TRANSCEIVE"
+#define NAME_NCI_TRACE_RING             "NCI_TRACE_RING"
+#define NAME_DEFERRED_TRACE             "DEFERRED_TRACE"
+#define NAME_NFA_DM_DISC_ADAPTIVE       "NFA_DM_DISC_ADAPTIVE"
 
 #define                     LPTD_PARAM_LEN (40)
 
@@ -109,6 +117,77 @@ extern struct tUART_CONFIG  uartConfig;
 #define MAX_CHIPID_LEN  (16)
 void    readOptionalConfig(const char* option);
 
+/* Settings the stack reads from libnfc-brcm.conf; GetStackConfig() returns
+** them parsed into a tSTACK_CONFIG snapshot so callers read fields directly */
+enum
+{
+    STACK_CFG_USE_RAW_NCI_TRACE,
+    STACK_CFG_APPL_TRACE_LEVEL,
+    STACK_CFG_PROTOCOL_TRACE_LEVEL,
+    STACK_CFG_NFA_STORAGE,
+    STACK_CFG_NFA_DM_CFG,
+    STACK_CFG_NFA_MAX_EE_SUPPORTED,
+    STACK_CFG_CE_T4T_MAX_REG_AID,
+    STACK_CFG_NFA_POLL_BAIL_OUT_MODE,
+    STACK_CFG_NFA_PROPRIETARY_CFG,
+    STACK_CFG_DEVICE_HOST_WHITE_LIST,
+    STACK_CFG_PRESERVE_STORAGE,
+    STACK_CFG_NCI_HAL_MODULE,
+    STACK_CFG_NCI_TRACE_RING,
+    STACK_CFG_DEFERRED_TRACE,
+    STACK_CFG_NFA_DM_DISC_ADAPTIVE,
+    STACK_CFG_NFA_DM_DISC_DURATION_POLL,
+    STACK_CFG_PRESENCE_CHECK_ALGORITHM,
+    STACK_CFG_POLL_FREQUENCY,
+    STACK_CFG_NUM_SETTINGS
+};
+
+/* longer values are rejected, the setting keeps its default */
+#define STACK_CFG_MAX_ARRAY_LEN     (32)
+#define STACK_CFG_MAX_STR_LEN       (120)
+#define STACK_CFG_POLL_FREQ_LEN     (8)     /* sizeof (tNFA_DM_DISC_FREQ_CFG) */
+
+typedef struct
+{
+    unsigned long   present;                /* bit (1 << STACK_CFG_xxx) set if the setting is in the config file */
+    unsigned char   use_raw_nci_trace;
+    unsigned char   appl_trace_level;
+    unsigned long   protocol_trace_level;
+    unsigned char   nfa_max_ee_supported;
+    unsigned char   ce_t4t_max_reg_aid;
+    unsigned char   nfa_poll_bail_out_mode;
+    unsigned char   preserve_storage;
+    unsigned char   nci_trace_ring;
+    unsigned char   deferred_trace;
+    unsigned char   nfa_dm_disc_adaptive;
+    unsigned short  nfa_dm_disc_duration_poll;
+    unsigned char   presence_check_algorithm;
+    unsigned char   poll_frequency_len;
+    unsigned char   poll_frequency[STACK_CFG_POLL_FREQ_LEN];
+    unsigned char   nfa_dm_cfg_len;
+    unsigned char   nfa_dm_cfg[STACK_CFG_MAX_ARRAY_LEN];
+    unsigned char   nfa_proprietary_cfg_len;
+    unsigned char   nfa_proprietary_cfg[STACK_CFG_MAX_ARRAY_LEN];
+    unsigned char   device_host_white_list_len;
+    unsigned char   device_host_white_list[STACK_CFG_MAX_ARRAY_LEN];
+    char            nfa_storage[STACK_CFG_MAX_STR_LEN];
+    char            nci_hal_module[STACK_CFG_MAX_STR_LEN];
+} tSTACK_CONFIG;
+
+#define STACK_CFG_IS_SET(p, id)     (((p)->present & (1UL << (id))) != 0)
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+const tSTACK_CONFIG* GetStackConfig(void);
+const tSTACK_CONFIG* ReloadStackConfig(void);
+
+#ifdef __cplusplus
+};
+#endif
+
 /* Snooze mode configuration structure */
 typedef struct
 {
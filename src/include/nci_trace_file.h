@@ -0,0 +1,51 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2015 Broadcom Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ * Layout of the binary NCI trace dump written by nciTraceRingDump()
+ * and read by tools/nci_trace/nci_trace_decode.
+ *
+ * The file starts with a tNCI_TRACE_FILE_HDR, followed by num_records
+ * records. Each record is a tNCI_TRACE_FILE_REC followed by len bytes of
+ * the raw NCI packet. All fields are in host byte order.
+ ******************************************************************************/
+#ifndef NCI_TRACE_FILE_H
+#define NCI_TRACE_FILE_H
+
+#include <stdint.h>
+
+#define NCI_TRACE_FILE_MAGIC        "NCITRACE"
+#define NCI_TRACE_FILE_MAGIC_LEN    8
+#define NCI_TRACE_FILE_VERSION      1
+
+typedef struct
+{
+    char        magic[NCI_TRACE_FILE_MAGIC_LEN];
+    uint32_t    version;
+    uint32_t    num_records;
+} tNCI_TRACE_FILE_HDR;
+
+typedef struct
+{
+    uint64_t    timestamp;          /* CLOCK_MONOTONIC, in microseconds */
+    uint32_t    tid;                /* thread that traced the packet */
+    uint16_t    len;                /* length of the NCI packet */
+    uint8_t     is_recv;            /* 1 if received from NFCC, 0 if sent */
+    uint8_t     reserved;
+} tNCI_TRACE_FILE_REC;
+
+#endif /* NCI_TRACE_FILE_H */
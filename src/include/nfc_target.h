@@ -198,6 +198,11 @@
 #define NFC_DYNAMIC_MEMORY              FALSE
 #endif
 
+/* Define to TRUE to record latency/throughput metrics (see NfcMetrics.h) */
+#ifndef NFC_METRICS_INCLUDED
+#define NFC_METRICS_INCLUDED            TRUE
+#endif
+
 /* Timeout for receiving response to NCI command */
 #ifndef NFC_CMD_CMPL_TIMEOUT
 #define NFC_CMD_CMPL_TIMEOUT        2
@@ -550,6 +555,27 @@
 #define NFA_DM_DISC_DURATION_POLL               500  /* Android requires 500 */
 #endif
 
+/* Adaptive RF discovery: activations seen before the poll schedule is adapted */
+#ifndef NFA_DM_DISC_SCHED_MIN_SAMPLES
+#define NFA_DM_DISC_SCHED_MIN_SAMPLES           8
+#endif
+
+/* Adaptive RF discovery: activation history is halved after this many activations */
+#ifndef NFA_DM_DISC_SCHED_WINDOW
+#define NFA_DM_DISC_SCHED_WINDOW                64
+#endif
+
+/* Adaptive RF discovery: a technology that did not activate recently is still
+** polled every NFA_DM_DISC_SCHED_MAX_FREQ discovery periods */
+#ifndef NFA_DM_DISC_SCHED_MAX_FREQ
+#define NFA_DM_DISC_SCHED_MAX_FREQ              3
+#endif
+
+/* Adaptive RF discovery: shortest total duration when no listen mode is configured */
+#ifndef NFA_DM_DISC_SCHED_MIN_DURATION
+#define NFA_DM_DISC_SCHED_MIN_DURATION          300
+#endif
+
 /* Automatic NDEF detection (when not in exclusive RF mode) */
 #ifndef NFA_DM_AUTO_DETECT_NDEF
 #define NFA_DM_AUTO_DETECT_NDEF      FALSE  /* !!!!! NFC-Android needs FALSE */
@@ -590,14 +616,20 @@
 #define NFA_NDEF_MAX_HANDLERS       8
 #endif
 
-/* Maximum number of listen entries configured/registered with NFA_CeConfigureUiccListenTech, */
-/* NFA_CeRegisterFelicaSystemCodeOnDH, or NFA_CeRegisterT4tAidOnDH                            */
+/* Maximum number of listen entries configured/registered with NFA_CeConfigureUiccListenTech */
+/* or NFA_CeRegisterFelicaSystemCodeOnDH                                                     */
 #ifndef NFA_CE_LISTEN_INFO_MAX
 #define NFA_CE_LISTEN_INFO_MAX        5
 #endif
 
+/* Maximum number of AIDs registered with NFA_CeRegisterAidOnDH or NFA_CeRegisterAidPrefixOnDH */
+/* (also limited by CE_T4T_MAX_REG_AID)                                                       */
+#ifndef NFA_CE_AID_LISTEN_INFO_MAX
+#define NFA_CE_AID_LISTEN_INFO_MAX    32
+#endif
+
 #ifndef NFA_CHO_INCLUDED
-#define NFA_CHO_INCLUDED            FALSE /* Anddroid must use FALSE to exclude CHO */
+#define NFA_CHO_INCLUDED            TRUE  /* Connection Handover in NFA */
 #endif
 
 /* MIU for CHO              */
@@ -630,7 +662,7 @@
 #endif
 
 #ifndef NFA_SNEP_INCLUDED
-#define NFA_SNEP_INCLUDED               FALSE /* Android must use FALSE to exclude SNEP */
+#define NFA_SNEP_INCLUDED               TRUE  /* SNEP server/client in NFA */
 #endif
 
 /* Max acceptable length */
@@ -673,6 +705,23 @@
 #define NFA_EE_MAX_CBACKS           (3)
 #endif
 
+/* Set to TRUE to plan the AID routing when the registered AID entries exceed
+ * the Listen Mode Routing Table of NFCC. The AID entries that do not fit are
+ * folded into prefix entries or left to the default route (NFA_EE_ROUT_PLAN_EVT) */
+#ifndef NFA_EE_ROUT_PLANNER_INCLUDED
+#define NFA_EE_ROUT_PLANNER_INCLUDED    TRUE
+#endif
+
+/* Set to TRUE if NFCC supports prefix matching of AID routing entries */
+#ifndef NFA_EE_AID_PREFIX_ROUTING
+#define NFA_EE_AID_PREFIX_ROUTING       FALSE
+#endif
+
+/* The shortest prefix the routing planner may fold AIDs into (5 = RID length) */
+#ifndef NFA_EE_AID_MIN_PREFIX_LEN
+#define NFA_EE_AID_MIN_PREFIX_LEN       (5)
+#endif
+
 #ifndef NFA_DTA_INCLUDED
 #define NFA_DTA_INCLUDED            TRUE
 #endif
@@ -218,6 +218,17 @@ void nfa_ce_handle_t4t_aid_evt (tCE_EVENT event, tCE_DATA *p_ce_data)
             conn_evt.ce_data.handle = NFA_HANDLE_GROUP_CE | ((tNFA_HANDLE)p_cb->idx_cur_active);
             conn_evt.ce_data.p_data = (UINT8 *) (p_ce_data->raw_frame.p_data + 1) + p_ce_data->raw_frame.p_data->offset;
             conn_evt.ce_data.len    = p_ce_data->raw_frame.p_data->len;
+#if ((NFC_NFCEE_INCLUDED == TRUE) && (NFA_EE_ROUT_PLANNER_INCLUDED == TRUE))
+            /* count SELECT by name for the AIDs routed to DH (CLA INS P1 P2 Lc AID) */
+            if (  (conn_evt.ce_data.len >= 5 + NFA_MIN_AID_LEN)
+                &&(conn_evt.ce_data.p_data[1] == T4T_CMD_INS_SELECT)
+                &&(conn_evt.ce_data.p_data[2] == T4T_CMD_P1_SELECT_BY_NAME)
+                &&(conn_evt.ce_data.p_data[4] <= NFA_MAX_AID_LEN)
+                &&(conn_evt.ce_data.len >= 5 + conn_evt.ce_data.p_data[4])  )
+            {
+                nfa_ee_aid_hit (conn_evt.ce_data.p_data[4], &conn_evt.ce_data.p_data[5]);
+            }
+#endif
             (*p_cb->p_active_conn_cback) (NFA_CE_DATA_EVT, &conn_evt);
         }
         else
@@ -367,7 +378,7 @@ tNFA_STATUS nfa_ce_start_listening (void)
     tNFA_DM_DISC_TECH_PROTO_MASK listen_mask;
     tNFA_CE_CB    *p_cb = &nfa_ce_cb;
     tNFA_HANDLE   disc_handle;
-    UINT8         listen_info_idx;
+    UINT8         listen_info_idx, i;
 
     /*************************************************************************/
     /* Construct protocol preference list to listen for */
@@ -422,9 +433,25 @@ tNFA_STATUS nfa_ce_start_listening (void)
             }
             else if (p_cb->listen_info[listen_info_idx].flags & NFA_CE_LISTEN_INFO_T4T_AID)
             {
-                disc_handle = nfa_dm_add_rf_discover (nfa_ce_cb.isodep_disc_mask,
-                                                       NFA_DM_DISC_HOST_ID_DH,
-                                                       nfa_ce_discovery_cback);
+                /* All T4T AID entries share one RF discovery entry */
+                disc_handle = NFA_HANDLE_INVALID;
+                for (i = NFA_CE_LISTEN_INFO_IDX_AID; i < NFA_CE_LISTEN_INFO_NUM; i++)
+                {
+                    if (  (p_cb->listen_info[i].flags & NFA_CE_LISTEN_INFO_IN_USE)
+                        &&(p_cb->listen_info[i].flags & NFA_CE_LISTEN_INFO_T4T_AID)
+                        &&(p_cb->listen_info[i].rf_disc_handle != NFA_HANDLE_INVALID)  )
+                    {
+                        disc_handle = p_cb->listen_info[i].rf_disc_handle;
+                        break;
+                    }
+                }
+
+                if (disc_handle == NFA_HANDLE_INVALID)
+                {
+                    disc_handle = nfa_dm_add_rf_discover (nfa_ce_cb.isodep_disc_mask,
+                                                          NFA_DM_DISC_HOST_ID_DH,
+                                                          nfa_ce_discovery_cback);
+                }
 
                 if (disc_handle == NFA_HANDLE_INVALID)
                     return (NFA_STATUS_FAILED);
@@ -500,7 +527,7 @@ BOOLEAN nfa_ce_restart_listen_check (void)
     UINT8 listen_info_idx;
 
     /* Check if any active entries in listen_info table */
-    for (listen_info_idx=0; listen_info_idx<NFA_CE_LISTEN_INFO_MAX; listen_info_idx++)
+    for (listen_info_idx=0; listen_info_idx<NFA_CE_LISTEN_INFO_NUM; listen_info_idx++)
     {
         if (p_cb->listen_info[listen_info_idx].flags & NFA_CE_LISTEN_INFO_IN_USE)
             break;
@@ -595,11 +622,7 @@ void nfa_ce_remove_listen_info_entry (UINT8 listen_info_idx, BOOLEAN notify_app)
         CE_T4tDeregisterAID (p_cb->listen_info[listen_info_idx].t4t_aid_handle);
     }
 
-    if (p_cb->listen_info[listen_info_idx].rf_disc_handle != NFA_HANDLE_INVALID )
-    {
-        nfa_dm_delete_rf_discover (p_cb->listen_info[listen_info_idx].rf_disc_handle);
-        p_cb->listen_info[listen_info_idx].rf_disc_handle = NFA_HANDLE_INVALID;
-    }
+    nfa_ce_delete_rf_discover (listen_info_idx);
 
     /* Remove entry from listen_info table */
     p_cb->listen_info[listen_info_idx].flags = 0;
@@ -624,6 +647,40 @@ void nfa_ce_free_scratch_buf (void)
     }
 }
 
+/*******************************************************************************
+**
+** Function         nfa_ce_delete_rf_discover
+**
+** Description      Release the RF discovery entry of a listen_info entry. The
+**                  entry is deleted from DM when no other listen_info entry
+**                  shares it.
+**
+** Returns          nothing
+**
+*******************************************************************************/
+void nfa_ce_delete_rf_discover (UINT8 listen_info_idx)
+{
+    tNFA_CE_CB *p_cb = &nfa_ce_cb;
+    tNFA_HANDLE disc_handle = p_cb->listen_info[listen_info_idx].rf_disc_handle;
+    UINT8 xx;
+
+    if (disc_handle == NFA_HANDLE_INVALID)
+        return;
+
+    p_cb->listen_info[listen_info_idx].rf_disc_handle = NFA_HANDLE_INVALID;
+
+    for (xx = 0; xx < NFA_CE_LISTEN_INFO_NUM; xx++)
+    {
+        if (  (p_cb->listen_info[xx].flags & NFA_CE_LISTEN_INFO_IN_USE)
+            &&(p_cb->listen_info[xx].rf_disc_handle == disc_handle)  )
+        {
+            return;
+        }
+    }
+
+    nfa_dm_delete_rf_discover (disc_handle);
+}
+
 /*******************************************************************************
 **
 ** Function         nfa_ce_realloc_scratch_buffer
@@ -1166,15 +1223,26 @@ BOOLEAN nfa_ce_api_reg_listen (tNFA_CE_MSG *p_ce_msg)
 {
     tNFA_CE_CB *p_cb = &nfa_ce_cb;
     tNFA_CONN_EVT_DATA conn_evt;
-    UINT8 i;
+    UINT8 i, first, last;
     UINT8 listen_info_idx = NFA_CE_LISTEN_INFO_IDX_INVALID;
 
     NFA_TRACE_DEBUG1 ("Registering UICC/Felica/Type-4 tag listener. Type=%i", p_ce_msg->reg_listen.listen_type);
 
+    /* T4T AIDs have their own entries, others skip over entry 0 (reserved for local NDEF tag) */
+    if (p_ce_msg->reg_listen.listen_type == NFA_CE_REG_TYPE_ISO_DEP)
+    {
+        first = NFA_CE_LISTEN_INFO_IDX_AID;
+        last  = NFA_CE_LISTEN_INFO_NUM;
+    }
+    else
+    {
+        first = 1;
+        last  = NFA_CE_LISTEN_INFO_MAX;
+    }
+
     /* Look for available entry in listen_info table                                        */
     /* - If registering UICC listen, make sure there isn't another entry for the ee_handle  */
-    /* - Skip over entry 0 (reserved for local NDEF tag)                                    */
-    for (i=1; i<NFA_CE_LISTEN_INFO_MAX; i++)
+    for (i=first; i<last; i++)
     {
         if (  (p_ce_msg->reg_listen.listen_type == NFA_CE_REG_TYPE_UICC)
             &&(p_cb->listen_info[i].flags & NFA_CE_LISTEN_INFO_IN_USE)
@@ -1198,7 +1266,7 @@ BOOLEAN nfa_ce_api_reg_listen (tNFA_CE_MSG *p_ce_msg)
     /* Add new entry to listen_info table */
     if (listen_info_idx == NFA_CE_LISTEN_INFO_IDX_INVALID)
     {
-        NFA_TRACE_ERROR1 ("Maximum listen callbacks exceeded (%i)", NFA_CE_LISTEN_INFO_MAX);
+        NFA_TRACE_ERROR1 ("Maximum listen callbacks exceeded (%i)", last - first);
 
         if (p_ce_msg->reg_listen.listen_type == NFA_CE_REG_TYPE_UICC)
         {
@@ -1234,9 +1302,15 @@ BOOLEAN nfa_ce_api_reg_listen (tNFA_CE_MSG *p_ce_msg)
             p_cb->listen_info[listen_info_idx].p_conn_cback =p_ce_msg->reg_listen.p_conn_cback;
 
             /* Register this AID with CE_T4T */
-            if ((p_cb->listen_info[listen_info_idx].t4t_aid_handle = CE_T4tRegisterAID (p_ce_msg->reg_listen.aid_len,
-                                                                                        p_ce_msg->reg_listen.aid,
-                                                                                        nfa_ce_handle_t4t_aid_evt)) == CE_T4T_AID_HANDLE_INVALID)
+            if (p_ce_msg->reg_listen.aid_prefix)
+                p_cb->listen_info[listen_info_idx].t4t_aid_handle = CE_T4tRegisterPrefixAID (p_ce_msg->reg_listen.aid_len,
+                                                                                             p_ce_msg->reg_listen.aid,
+                                                                                             nfa_ce_handle_t4t_aid_evt);
+            else
+                p_cb->listen_info[listen_info_idx].t4t_aid_handle = CE_T4tRegisterAID (p_ce_msg->reg_listen.aid_len,
+                                                                                       p_ce_msg->reg_listen.aid,
+                                                                                       nfa_ce_handle_t4t_aid_evt);
+            if (p_cb->listen_info[listen_info_idx].t4t_aid_handle == CE_T4T_AID_HANDLE_INVALID)
             {
                 NFA_TRACE_ERROR0 ("Unable to register AID");
                 p_cb->listen_info[listen_info_idx].flags = 0;
@@ -1334,11 +1408,7 @@ BOOLEAN nfa_ce_api_dereg_listen (tNFA_CE_MSG *p_ce_msg)
                 else
                 {
                     /* Stop listening */
-                    if (p_cb->listen_info[listen_info_idx].rf_disc_handle != NFA_HANDLE_INVALID)
-                    {
-                        nfa_dm_delete_rf_discover (p_cb->listen_info[listen_info_idx].rf_disc_handle);
-                        p_cb->listen_info[listen_info_idx].rf_disc_handle = NFA_HANDLE_INVALID;
-                    }
+                    nfa_ce_delete_rf_discover (listen_info_idx);
 
                     /* Remove entry and notify application */
                     nfa_ce_remove_listen_info_entry (listen_info_idx, TRUE);
@@ -1364,7 +1434,7 @@ BOOLEAN nfa_ce_api_dereg_listen (tNFA_CE_MSG *p_ce_msg)
             nfa_ce_cb.idx_wild_card     = NFA_CE_LISTEN_INFO_IDX_INVALID;
         }
 
-        if (  (listen_info_idx < NFA_CE_LISTEN_INFO_MAX)
+        if (  (listen_info_idx < NFA_CE_LISTEN_INFO_NUM)
             &&(p_cb->listen_info[listen_info_idx].flags & NFA_CE_LISTEN_INFO_IN_USE))
         {
             /* virtual secure element is in not idle state */
@@ -1378,11 +1448,7 @@ BOOLEAN nfa_ce_api_dereg_listen (tNFA_CE_MSG *p_ce_msg)
             else
             {
                 /* Stop listening */
-                if (p_cb->listen_info[listen_info_idx].rf_disc_handle != NFA_HANDLE_INVALID)
-                {
-                    nfa_dm_delete_rf_discover (p_cb->listen_info[listen_info_idx].rf_disc_handle);
-                    p_cb->listen_info[listen_info_idx].rf_disc_handle = NFA_HANDLE_INVALID;
-                }
+                nfa_ce_delete_rf_discover (listen_info_idx);
 
                 /* Remove entry and notify application */
                 nfa_ce_remove_listen_info_entry (listen_info_idx, TRUE);
@@ -302,35 +302,25 @@ tNFA_STATUS NFA_CeDeregisterFelicaSystemCodeOnDH (tNFA_HANDLE handle)
 
 /*******************************************************************************
 **
-** Function         NFA_CeRegisterAidOnDH
-**
-** Description      Register listening callback for the specified ISODEP AID
-**
-**                  The NFA_CE_REGISTERED_EVT reports the status of the
-**                  operation.
-**
-**                  If no AID is specified (aid_len=0), then p_conn_cback will
-**                  will get notifications for any AIDs routed to the DH. This
-**                  over-rides callbacks registered for specific AIDs.
+** Function         nfa_ce_api_register_aid
 **
-** Note:            If RF discovery is started, NFA_StopRfDiscovery()/NFA_RF_DISCOVERY_STOPPED_EVT
-**                  should happen before calling this function
+** Description      Send NFA_CE_API_REG_LISTEN_EVT for an ISODEP AID or AID
+**                  prefix
 **
 ** Returns:
 **                  NFA_STATUS_OK, if command accepted
 **                  NFA_STATUS_FAILED: otherwise
 **
 *******************************************************************************/
-tNFA_STATUS NFA_CeRegisterAidOnDH (UINT8 aid[NFC_MAX_AID_LEN],
-                                         UINT8           aid_len,
-                                         tNFA_CONN_CBACK *p_conn_cback)
+static tNFA_STATUS nfa_ce_api_register_aid (UINT8           *p_aid,
+                                            UINT8           aid_len,
+                                            BOOLEAN         aid_prefix,
+                                            tNFA_CONN_CBACK *p_conn_cback)
 {
     tNFA_CE_MSG *p_msg;
 
-    NFA_TRACE_API0 ("NFA_CeRegisterAidOnDH ()");
-
     /* Validate parameters */
-    if (p_conn_cback==NULL)
+    if ((p_conn_cback==NULL) || (aid_len > NFC_MAX_AID_LEN))
         return (NFA_STATUS_INVALID_PARAM);
 
     if ((p_msg = (tNFA_CE_MSG *) GKI_getbuf ((UINT16) sizeof(tNFA_CE_MSG))) != NULL)
@@ -340,8 +330,9 @@ tNFA_STATUS NFA_CeRegisterAidOnDH (UINT8 aid[NFC_MAX_AID_LEN],
         p_msg->reg_listen.listen_type = NFA_CE_REG_TYPE_ISO_DEP;
 
         /* Listen info */
-        memcpy (p_msg->reg_listen.aid, aid, aid_len);
+        memcpy (p_msg->reg_listen.aid, p_aid, aid_len);
         p_msg->reg_listen.aid_len = aid_len;
+        p_msg->reg_listen.aid_prefix = aid_prefix;
 
         nfa_sys_sendmsg (p_msg);
 
@@ -351,6 +342,70 @@ tNFA_STATUS NFA_CeRegisterAidOnDH (UINT8 aid[NFC_MAX_AID_LEN],
     return (NFA_STATUS_FAILED);
 }
 
+/*******************************************************************************
+**
+** Function         NFA_CeRegisterAidOnDH
+**
+** Description      Register listening callback for the specified ISODEP AID
+**
+**                  The NFA_CE_REGISTERED_EVT reports the status of the
+**                  operation.
+**
+**                  If no AID is specified (aid_len=0), then p_conn_cback will
+**                  will get notifications for any AIDs routed to the DH. This
+**                  over-rides callbacks registered for specific AIDs.
+**
+** Note:            If RF discovery is started, NFA_StopRfDiscovery()/NFA_RF_DISCOVERY_STOPPED_EVT
+**                  should happen before calling this function
+**
+** Returns:
+**                  NFA_STATUS_OK, if command accepted
+**                  NFA_STATUS_FAILED: otherwise
+**
+*******************************************************************************/
+tNFA_STATUS NFA_CeRegisterAidOnDH (UINT8 aid[NFC_MAX_AID_LEN],
+                                         UINT8           aid_len,
+                                         tNFA_CONN_CBACK *p_conn_cback)
+{
+    NFA_TRACE_API0 ("NFA_CeRegisterAidOnDH ()");
+
+    return (nfa_ce_api_register_aid (aid, aid_len, FALSE, p_conn_cback));
+}
+
+/*******************************************************************************
+**
+** Function         NFA_CeRegisterAidPrefixOnDH
+**
+** Description      Register listening callback for the ISODEP AIDs starting
+**                  with the specified prefix
+**
+**                  The NFA_CE_REGISTERED_EVT reports the status of the
+**                  operation.
+**
+**                  An AID registered with NFA_CeRegisterAidOnDH or a longer
+**                  prefix has priority. The registration is removed with
+**                  NFA_CeDeregisterAidOnDH.
+**
+** Note:            If RF discovery is started, NFA_StopRfDiscovery()/NFA_RF_DISCOVERY_STOPPED_EVT
+**                  should happen before calling this function
+**
+** Returns:
+**                  NFA_STATUS_OK, if command accepted
+**                  NFA_STATUS_FAILED: otherwise
+**
+*******************************************************************************/
+tNFA_STATUS NFA_CeRegisterAidPrefixOnDH (UINT8           aid[NFC_MAX_AID_LEN],
+                                         UINT8           aid_len,
+                                         tNFA_CONN_CBACK *p_conn_cback)
+{
+    NFA_TRACE_API1 ("NFA_CeRegisterAidPrefixOnDH (): aid_len:%d", aid_len);
+
+    if (aid_len == 0)
+        return (NFA_STATUS_INVALID_PARAM);
+
+    return (nfa_ce_api_register_aid (aid, aid_len, TRUE, p_conn_cback));
+}
+
 /*******************************************************************************
 **
 ** Function         NFA_CeDeregisterAidOnDH
@@ -28,6 +28,7 @@
 #include "nfa_ce_int.h"
 #include "nfa_dm_int.h"
 #include "nfa_sys_int.h"
+#include "ce_api.h"
 
 /* NFA_CE control block */
 tNFA_CE_CB nfa_ce_cb;
@@ -112,13 +113,18 @@ void nfa_ce_sys_disable (void)
     /* Free scratch buf if any */
     nfa_ce_free_scratch_buf ();
 
-    /* Delete discovery handles */
-    for (xx = 0, p_info = nfa_ce_cb.listen_info; xx < NFA_CE_LISTEN_INFO_MAX; xx++, p_info++)
+    /* Delete discovery handles and deregister AIDs from CE_T4T */
+    for (xx = 0, p_info = nfa_ce_cb.listen_info; xx < NFA_CE_LISTEN_INFO_NUM; xx++, p_info++)
     {
-        if ((p_info->flags & NFA_CE_LISTEN_INFO_IN_USE) && (p_info->rf_disc_handle != NFA_HANDLE_INVALID))
+        if (p_info->flags & NFA_CE_LISTEN_INFO_IN_USE)
         {
-            nfa_dm_delete_rf_discover (p_info->rf_disc_handle);
-            p_info->rf_disc_handle = NFA_HANDLE_INVALID;
+            nfa_ce_delete_rf_discover (xx);
+
+            if (p_info->flags & NFA_CE_LISTEN_INFO_T4T_AID)
+            {
+                CE_T4tDeregisterAID (p_info->t4t_aid_handle);
+                p_info->flags = 0;
+            }
         }
     }
 
@@ -152,11 +158,9 @@ static void nfa_ce_proc_nfcc_power_mode (UINT8 nfcc_power_mode)
         for (listen_info_idx=0; listen_info_idx<NFA_CE_LISTEN_INFO_IDX_INVALID; listen_info_idx++)
         {
             /* add RF discovery to DM only if it is not added yet */
-            if (  (p_cb->listen_info[listen_info_idx].flags & NFA_CE_LISTEN_INFO_IN_USE)
-                &&(p_cb->listen_info[listen_info_idx].rf_disc_handle != NFA_HANDLE_INVALID))
+            if (p_cb->listen_info[listen_info_idx].flags & NFA_CE_LISTEN_INFO_IN_USE)
             {
-                nfa_dm_delete_rf_discover (p_cb->listen_info[listen_info_idx].rf_disc_handle);
-                p_cb->listen_info[listen_info_idx].rf_disc_handle = NFA_HANDLE_INVALID;
+                nfa_ce_delete_rf_discover (listen_info_idx);
             }
         }
     }
@@ -0,0 +1,441 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2015 Broadcom Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  NFA interface for Connection Handover
+ *
+ ******************************************************************************/
+#include <string.h>
+#include "nfc_api.h"
+#include "nfa_sys.h"
+#include "nfa_sys_int.h"
+#include "llcp_defs.h"
+#include "llcp_api.h"
+#include "ndef_utils.h"
+#include "nfa_cho_api.h"
+#include "nfa_cho_int.h"
+
+#if (defined (NFA_CHO_INCLUDED) && (NFA_CHO_INCLUDED==TRUE))
+
+/*****************************************************************************
+**  Local functions
+*****************************************************************************/
+
+/*******************************************************************************
+**
+** Function         nfa_cho_check_ac_info
+**
+** Description      Check Alternative Carrier information and NDEF message
+**                  given by application
+**
+** Returns          TRUE if valid
+**
+*******************************************************************************/
+static BOOLEAN nfa_cho_check_ac_info (UINT8             num_ac_info,
+                                      tNFA_CHO_AC_INFO *p_ac_info,
+                                      UINT8            *p_ndef,
+                                      UINT32            ndef_len)
+{
+    UINT8 xx;
+
+    if (  (num_ac_info > NFA_CHO_MAX_AC_INFO)
+        ||((num_ac_info > 0) && (p_ac_info == NULL))  )
+    {
+        CHO_TRACE_ERROR1 ("nfa_cho_check_ac_info (): Invalid num_ac_info (%d)", num_ac_info);
+        return FALSE;
+    }
+
+    for (xx = 0; xx < num_ac_info; xx++)
+    {
+        if (p_ac_info[xx].num_aux_data > NFA_CHO_MAX_AUX_DATA_COUNT)
+        {
+            CHO_TRACE_ERROR1 ("nfa_cho_check_ac_info (): Too many aux data (%d)",
+                              p_ac_info[xx].num_aux_data);
+            return FALSE;
+        }
+    }
+
+    if (  (ndef_len > 0)
+        &&((p_ndef == NULL) || (NDEF_MsgValidate (p_ndef, ndef_len, FALSE) != NDEF_OK))  )
+    {
+        CHO_TRACE_ERROR0 ("nfa_cho_check_ac_info (): Invalid NDEF message");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*******************************************************************************
+**
+** Function         NFA_ChoRegister
+**
+** Description      This function is called to register callback function to receive
+**                  connection handover events.
+**
+**                  On this registration, "urn:nfc:sn:handover" server will be
+**                  registered on LLCP if enable_server is TRUE.
+**
+**                  The result of the registration is reported with NFA_CHO_REG_EVT.
+**
+** Note:            If RF discovery is started, NFA_StopRfDiscovery()/NFA_RF_DISCOVERY_STOPPED_EVT
+**                  should happen before calling this function
+**
+** Returns          NFA_STATUS_OK if successfully initiated
+**                  NFA_STATUS_FAILED otherwise
+**
+*******************************************************************************/
+tNFA_STATUS NFA_ChoRegister (BOOLEAN        enable_server,
+                             tNFA_CHO_CBACK *p_cback)
+{
+    tNFA_CHO_API_REG *p_msg;
+
+    CHO_TRACE_API1 ("NFA_ChoRegister (): enable_server=%d", enable_server);
+
+    if (p_cback == NULL)
+    {
+        CHO_TRACE_ERROR0 ("NFA_ChoRegister (): p_cback is NULL");
+        return (NFA_STATUS_INVALID_PARAM);
+    }
+
+    if ((p_msg = (tNFA_CHO_API_REG *) GKI_getbuf (sizeof (tNFA_CHO_API_REG))) != NULL)
+    {
+        p_msg->hdr.event     = NFA_CHO_API_REG_EVT;
+        p_msg->enable_server = enable_server;
+        p_msg->p_cback       = p_cback;
+
+        nfa_sys_sendmsg (p_msg);
+
+        return (NFA_STATUS_OK);
+    }
+
+    return (NFA_STATUS_FAILED);
+}
+
+/*******************************************************************************
+**
+** Function         NFA_ChoDeregister
+**
+** Description      This function is called to deregister callback function from NFA
+**                  Connection Handover Application.
+**
+**                  If this is the valid deregistration, NFA Connection Handover
+**                  Application will close the service with "urn:nfc:sn:handover"
+**                  on LLCP and deregister NDEF type handler if any.
+**
+** Note:            If RF discovery is started, NFA_StopRfDiscovery()/NFA_RF_DISCOVERY_STOPPED_EVT
+**                  should happen before calling this function
+**
+** Returns          NFA_STATUS_OK if successfully initiated
+**                  NFA_STATUS_FAILED otherwise
+**
+*******************************************************************************/
+tNFA_STATUS NFA_ChoDeregister (void)
+{
+    tNFA_CHO_API_DEREG *p_msg;
+
+    CHO_TRACE_API0 ("NFA_ChoDeregister ()");
+
+    if ((p_msg = (tNFA_CHO_API_DEREG *) GKI_getbuf (sizeof (tNFA_CHO_API_DEREG))) != NULL)
+    {
+        p_msg->event = NFA_CHO_API_DEREG_EVT;
+
+        nfa_sys_sendmsg (p_msg);
+
+        return (NFA_STATUS_OK);
+    }
+
+    return (NFA_STATUS_FAILED);
+}
+
+/*******************************************************************************
+**
+** Function         NFA_ChoConnect
+**
+** Description      This function is called to create data link connection to
+**                  Connection Handover server on peer device.
+**
+**                  It must be called after receiving NFA_CHO_ACTIVATED_EVT.
+**                  NFA_CHO_CONNECTED_EVT will be returned if successful.
+**                  Otherwise, NFA_CHO_DISCONNECTED_EVT will be returned.
+**
+** Returns          NFA_STATUS_OK if successfully initiated
+**                  NFA_STATUS_FAILED otherwise
+**
+*******************************************************************************/
+tNFA_STATUS NFA_ChoConnect (void)
+{
+    tNFA_CHO_API_CONNECT *p_msg;
+
+    CHO_TRACE_API0 ("NFA_ChoConnect ()");
+
+    if ((p_msg = (tNFA_CHO_API_CONNECT *) GKI_getbuf (sizeof (tNFA_CHO_API_CONNECT))) != NULL)
+    {
+        p_msg->event = NFA_CHO_API_CONNECT_EVT;
+
+        nfa_sys_sendmsg (p_msg);
+
+        return (NFA_STATUS_OK);
+    }
+
+    return (NFA_STATUS_FAILED);
+}
+
+/*******************************************************************************
+**
+** Function         NFA_ChoDisconnect
+**
+** Description      This function is called to disconnect data link connection with
+**                  Connection Handover server on peer device.
+**
+**                  NFA_CHO_DISCONNECTED_EVT will be returned.
+**
+** Returns          NFA_STATUS_OK if successfully initiated
+**                  NFA_STATUS_FAILED otherwise
+**
+*******************************************************************************/
+tNFA_STATUS NFA_ChoDisconnect (void)
+{
+    tNFA_CHO_API_DISCONNECT *p_msg;
+
+    CHO_TRACE_API0 ("NFA_ChoDisconnect ()");
+
+    if ((p_msg = (tNFA_CHO_API_DISCONNECT *) GKI_getbuf (sizeof (tNFA_CHO_API_DISCONNECT))) != NULL)
+    {
+        p_msg->event = NFA_CHO_API_DISCONNECT_EVT;
+
+        nfa_sys_sendmsg (p_msg);
+
+        return (NFA_STATUS_OK);
+    }
+
+    return (NFA_STATUS_FAILED);
+}
+
+/*******************************************************************************
+**
+** Function         NFA_ChoSendHr
+**
+** Description      This function is called to send Handover Request Message with
+**                  Handover Carrier records or Alternative Carrier records.
+**
+**                  It must be called after receiving NFA_CHO_CONNECTED_EVT.
+**
+**                  NDEF may include one or more Handover Carrier records or Alternative
+**                  Carrier records with auxiliary data.
+**                  The records in NDEF must be matched with tNFA_CHO_AC_INFO in order.
+**                  Payload ID must be unique and Payload ID length must be less than
+**                  or equal to NFA_CHO_MAX_REF_NAME_LEN.
+**
+**                  The alternative carrier information of Handover Select record
+**                  will be sent to application by NFA_CHO_SELECT_EVT. Application
+**                  may receive NFA_CHO_REQUEST_EVT because of handover collision.
+**
+** Returns          NFA_STATUS_OK if successfully initiated
+**                  NFA_STATUS_FAILED otherwise
+**
+*******************************************************************************/
+tNFA_STATUS NFA_ChoSendHr (UINT8             num_ac_info,
+                           tNFA_CHO_AC_INFO *p_ac_info,
+                           UINT8            *p_ndef,
+                           UINT32            ndef_len)
+{
+    tNFA_CHO_API_SEND_HR *p_msg;
+    UINT16               size;
+
+    CHO_TRACE_API1 ("NFA_ChoSendHr (): num_ac_info=%d", num_ac_info);
+
+    if (!nfa_cho_check_ac_info (num_ac_info, p_ac_info, p_ndef, ndef_len))
+    {
+        return (NFA_STATUS_INVALID_PARAM);
+    }
+
+    size = (UINT16) (sizeof (tNFA_CHO_API_SEND_HR) + num_ac_info * sizeof (tNFA_CHO_AC_INFO));
+
+    if (ndef_len > (UINT32) (GKI_MAX_BUF_SIZE - size))
+    {
+        CHO_TRACE_ERROR1 ("NFA_ChoSendHr (): NDEF message is too long (%d)", ndef_len);
+        return (NFA_STATUS_INVALID_PARAM);
+    }
+
+    if ((p_msg = (tNFA_CHO_API_SEND_HR *) GKI_getbuf ((UINT16) (size + ndef_len))) != NULL)
+    {
+        p_msg->hdr.event     = NFA_CHO_API_SEND_HR_EVT;
+        p_msg->num_ac_info   = num_ac_info;
+        p_msg->p_ac_info     = (tNFA_CHO_AC_INFO *) (p_msg + 1);
+        p_msg->p_ndef        = (UINT8 *) (p_msg->p_ac_info + num_ac_info);
+        p_msg->max_ndef_size = ndef_len;
+        p_msg->cur_ndef_size = ndef_len;
+
+        if (num_ac_info > 0)
+            memcpy (p_msg->p_ac_info, p_ac_info, num_ac_info * sizeof (tNFA_CHO_AC_INFO));
+        if (ndef_len > 0)
+            memcpy (p_msg->p_ndef, p_ndef, ndef_len);
+
+        nfa_sys_sendmsg (p_msg);
+
+        return (NFA_STATUS_OK);
+    }
+
+    return (NFA_STATUS_FAILED);
+}
+
+/*******************************************************************************
+**
+** Function         NFA_ChoSendHs
+**
+** Description      This function is called to send Handover Select message with
+**                  Alternative Carrier records as response to Handover Request
+**                  message.
+**
+**                  NDEF may include one or more Alternative Carrier records with
+**                  auxiliary data.
+**                  The records in NDEF must be matched with tNFA_CHO_AC_INFO in order.
+**                  Payload ID must be unique and Payload ID length must be less than
+**                  or equal to NFA_CHO_MAX_REF_NAME_LEN.
+**
+** Returns          NFA_STATUS_OK if successfully initiated
+**                  NFA_STATUS_FAILED otherwise
+**
+*******************************************************************************/
+tNFA_STATUS NFA_ChoSendHs (UINT8             num_ac_info,
+                           tNFA_CHO_AC_INFO *p_ac_info,
+                           UINT8            *p_ndef,
+                           UINT32            ndef_len)
+{
+    tNFA_CHO_API_SEND_HS *p_msg;
+    UINT16               size;
+
+    CHO_TRACE_API1 ("NFA_ChoSendHs (): num_ac_info=%d", num_ac_info);
+
+    if (!nfa_cho_check_ac_info (num_ac_info, p_ac_info, p_ndef, ndef_len))
+    {
+        return (NFA_STATUS_INVALID_PARAM);
+    }
+
+    size = (UINT16) (sizeof (tNFA_CHO_API_SEND_HS) + num_ac_info * sizeof (tNFA_CHO_AC_INFO));
+
+    if (ndef_len > (UINT32) (GKI_MAX_BUF_SIZE - size))
+    {
+        CHO_TRACE_ERROR1 ("NFA_ChoSendHs (): NDEF message is too long (%d)", ndef_len);
+        return (NFA_STATUS_INVALID_PARAM);
+    }
+
+    if ((p_msg = (tNFA_CHO_API_SEND_HS *) GKI_getbuf ((UINT16) (size + ndef_len))) != NULL)
+    {
+        p_msg->hdr.event     = NFA_CHO_API_SEND_HS_EVT;
+        p_msg->num_ac_info   = num_ac_info;
+        p_msg->p_ac_info     = (tNFA_CHO_AC_INFO *) (p_msg + 1);
+        p_msg->p_ndef        = (UINT8 *) (p_msg->p_ac_info + num_ac_info);
+        p_msg->max_ndef_size = ndef_len;
+        p_msg->cur_ndef_size = ndef_len;
+
+        if (num_ac_info > 0)
+            memcpy (p_msg->p_ac_info, p_ac_info, num_ac_info * sizeof (tNFA_CHO_AC_INFO));
+        if (ndef_len > 0)
+            memcpy (p_msg->p_ndef, p_ndef, ndef_len);
+
+        nfa_sys_sendmsg (p_msg);
+
+        return (NFA_STATUS_OK);
+    }
+
+    return (NFA_STATUS_FAILED);
+}
+
+/*******************************************************************************
+**
+** Function         NFA_ChoSendSelectError
+**
+** Description      This function is called to send Error record to indicate failure
+**                  to process the most recently received Handover Request message.
+**
+**                  error_reason : NFA_CHO_ERROR_TEMP_MEM
+**                                 NFA_CHO_ERROR_PERM_MEM
+**                                 NFA_CHO_ERROR_CARRIER
+**
+** Returns          NFA_STATUS_OK if successfully initiated
+**                  NFA_STATUS_FAILED otherwise
+**
+*******************************************************************************/
+tNFA_STATUS NFA_ChoSendSelectError (UINT8  error_reason,
+                                    UINT32 error_data)
+{
+    tNFA_CHO_API_SEL_ERR *p_msg;
+
+    CHO_TRACE_API2 ("NFA_ChoSendSelectError (): error_reason=0x%x, error_data=0x%x",
+                     error_reason, error_data);
+
+    if (  (error_reason < NFA_CHO_ERROR_TEMP_MEM)
+        ||(error_reason > NFA_CHO_ERROR_CARRIER)  )
+    {
+        CHO_TRACE_ERROR1 ("NFA_ChoSendSelectError (): Invalid error_reason (0x%x)", error_reason);
+        return (NFA_STATUS_INVALID_PARAM);
+    }
+
+    if ((p_msg = (tNFA_CHO_API_SEL_ERR *) GKI_getbuf (sizeof (tNFA_CHO_API_SEL_ERR))) != NULL)
+    {
+        p_msg->hdr.event    = NFA_CHO_API_SEL_ERR_EVT;
+        p_msg->error_reason = error_reason;
+        p_msg->error_data   = error_data;
+
+        nfa_sys_sendmsg (p_msg);
+
+        return (NFA_STATUS_OK);
+    }
+
+    return (NFA_STATUS_FAILED);
+}
+
+/*******************************************************************************
+**
+** Function         NFA_ChoSetTraceLevel
+**
+** Description      This function sets the trace level for CHO.  If called with
+**                  a value of 0xFF, it simply returns the current trace level.
+**
+** Returns          The new or current trace level
+**
+*******************************************************************************/
+UINT8 NFA_ChoSetTraceLevel (UINT8 new_level)
+{
+    if (new_level != 0xFF)
+        nfa_cho_cb.trace_level = new_level;
+
+    return (nfa_cho_cb.trace_level);
+}
+
+#if (defined (NFA_CHO_TEST_INCLUDED) && (NFA_CHO_TEST_INCLUDED == TRUE))
+/*******************************************************************************
+**
+** Function         NFA_ChoSetTestParam
+**
+** Description      This function is called to set test parameters.
+**
+*******************************************************************************/
+void NFA_ChoSetTestParam (UINT8  test_enable,
+                          UINT8  test_version,
+                          UINT16 test_random_number)
+{
+    nfa_cho_cb.test_enabled       = test_enable;
+    nfa_cho_cb.test_version       = test_version;
+    nfa_cho_cb.test_random_number = test_random_number;
+}
+#endif
+
+#endif /* (defined (NFA_CHO_INCLUDED) && (NFA_CHO_INCLUDED==TRUE)) */
@@ -0,0 +1,137 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2015 Broadcom Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  This is the main implementation file for the NFA Connection Handover.
+ *
+ ******************************************************************************/
+#include <string.h>
+#include "nfc_api.h"
+#include "nfa_sys.h"
+#include "nfa_sys_int.h"
+#include "llcp_api.h"
+#include "llcp_defs.h"
+#include "nfa_cho_api.h"
+#include "nfa_cho_int.h"
+
+#if (defined (NFA_CHO_INCLUDED) && (NFA_CHO_INCLUDED==TRUE))
+
+/*****************************************************************************
+**  Global Variables
+*****************************************************************************/
+
+/* system manager control block definition */
+#if NFA_DYNAMIC_MEMORY == FALSE
+tNFA_CHO_CB nfa_cho_cb;
+#endif
+
+/*****************************************************************************
+**  Static Functions
+*****************************************************************************/
+
+/* event handler function type */
+static BOOLEAN nfa_cho_evt_hdlr (BT_HDR *p_msg);
+
+/* disable function type */
+static void nfa_cho_sys_disable (void);
+
+/*****************************************************************************
+**  Constants
+*****************************************************************************/
+static const tNFA_SYS_REG nfa_cho_sys_reg =
+{
+    NULL,
+    nfa_cho_evt_hdlr,
+    nfa_cho_sys_disable,
+    NULL
+};
+
+/*******************************************************************************
+**
+** Function         nfa_cho_init
+**
+** Description      Initialize NFA Connection Handover
+**
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfa_cho_init (void)
+{
+    CHO_TRACE_DEBUG0 ("nfa_cho_init ()");
+
+    /* initialize control block */
+    memset (&nfa_cho_cb, 0, sizeof (tNFA_CHO_CB));
+    nfa_cho_cb.trace_level = APPL_INITIAL_TRACE_LEVEL;
+    nfa_cho_cb.state       = NFA_CHO_ST_DISABLED;
+
+    nfa_cho_cb.server_sap  = LLCP_INVALID_SAP;
+    nfa_cho_cb.client_sap  = LLCP_INVALID_SAP;
+
+    nfa_cho_cb.hs_ndef_type_handle   = NFA_HANDLE_INVALID;
+    nfa_cho_cb.bt_ndef_type_handle   = NFA_HANDLE_INVALID;
+    nfa_cho_cb.wifi_ndef_type_handle = NFA_HANDLE_INVALID;
+
+    /* register message handler on NFA SYS */
+    nfa_sys_register (NFA_ID_CHO, &nfa_cho_sys_reg);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_sys_disable
+**
+** Description      Clean up CHO sub-system and deregister from NFA SYS
+**
+**
+** Returns          None
+**
+*******************************************************************************/
+static void nfa_cho_sys_disable (void)
+{
+    CHO_TRACE_DEBUG0 ("nfa_cho_sys_disable ()");
+
+    if (nfa_cho_cb.state != NFA_CHO_ST_DISABLED)
+    {
+        nfa_cho_proc_api_dereg ();
+    }
+
+    /* deregister message handler on NFA SYS */
+    nfa_sys_deregister (NFA_ID_CHO);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_evt_hdlr
+**
+** Description      Processing event for NFA CHO
+**
+**
+** Returns          TRUE if p_msg needs to be deallocated
+**
+*******************************************************************************/
+static BOOLEAN nfa_cho_evt_hdlr (BT_HDR *p_hdr)
+{
+    CHO_TRACE_DEBUG1 ("nfa_cho_evt_hdlr (): Event 0x%04x", p_hdr->event);
+
+    nfa_cho_sm_execute (p_hdr->event, (tNFA_CHO_INT_EVENT_DATA *) p_hdr);
+
+    return TRUE;
+}
+
+#endif /* (defined (NFA_CHO_INCLUDED) && (NFA_CHO_INCLUDED==TRUE)) */
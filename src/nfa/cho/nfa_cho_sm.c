@@ -0,0 +1,965 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2015 Broadcom Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  This is the state implementation file for the NFA Connection Handover.
+ *
+ *  If both devices create data link connection at the same time, the one
+ *  from peer is kept as collision connection until Handover Request messages
+ *  are exchanged and the roles are resolved with random numbers.
+ *
+ ******************************************************************************/
+#include <string.h>
+#include "nfc_api.h"
+#include "nfa_sys.h"
+#include "nfa_sys_int.h"
+#include "llcp_api.h"
+#include "llcp_defs.h"
+#include "nfa_cho_api.h"
+#include "nfa_cho_int.h"
+
+#if (defined (NFA_CHO_INCLUDED) && (NFA_CHO_INCLUDED==TRUE))
+
+/*****************************************************************************
+**  Static Functions
+*****************************************************************************/
+static void nfa_cho_sm_disabled (tNFA_CHO_INT_EVT event, tNFA_CHO_INT_EVENT_DATA *p_data);
+static void nfa_cho_sm_idle (tNFA_CHO_INT_EVT event, tNFA_CHO_INT_EVENT_DATA *p_data);
+static void nfa_cho_sm_w4_cc (tNFA_CHO_INT_EVT event, tNFA_CHO_INT_EVENT_DATA *p_data);
+static void nfa_cho_sm_connected (tNFA_CHO_INT_EVT event, tNFA_CHO_INT_EVENT_DATA *p_data);
+
+#if (BT_TRACE_VERBOSE == TRUE)
+static char *nfa_cho_state_code (tNFA_CHO_STATE state_code);
+static char *nfa_cho_evt_code (tNFA_CHO_INT_EVT evt_code);
+#endif
+
+/*******************************************************************************
+**
+** Function         nfa_cho_sm_llcp_cback
+**
+** Description      Processing event from LLCP
+**
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfa_cho_sm_llcp_cback (tLLCP_SAP_CBACK_DATA *p_data)
+{
+    tNFA_CHO_INT_EVT event;
+
+    switch (p_data->hdr.event)
+    {
+    case LLCP_SAP_EVT_DATA_IND:
+        event = NFA_CHO_RX_HANDOVER_MSG_EVT;
+        break;
+
+    case LLCP_SAP_EVT_CONNECT_IND:
+        event = NFA_CHO_LLCP_CONNECT_IND_EVT;
+        break;
+
+    case LLCP_SAP_EVT_CONNECT_RESP:
+        event = NFA_CHO_LLCP_CONNECT_RESP_EVT;
+        break;
+
+    case LLCP_SAP_EVT_DISCONNECT_IND:
+        event = NFA_CHO_LLCP_DISCONNECT_IND_EVT;
+        break;
+
+    case LLCP_SAP_EVT_DISCONNECT_RESP:
+        event = NFA_CHO_LLCP_DISCONNECT_RESP_EVT;
+        break;
+
+    case LLCP_SAP_EVT_CONGEST:
+        event = NFA_CHO_LLCP_CONGEST_EVT;
+        break;
+
+    case LLCP_SAP_EVT_LINK_STATUS:
+        event = NFA_CHO_LLCP_LINK_STATUS_EVT;
+        break;
+
+    default:
+        CHO_TRACE_DEBUG1 ("nfa_cho_sm_llcp_cback (): Ignore LLCP event:0x%02X", p_data->hdr.event);
+        return;
+    }
+
+    nfa_cho_sm_execute (event, (tNFA_CHO_INT_EVENT_DATA *) p_data);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_sm_is_main_link
+**
+** Description      Check if SAPs are for the connection in use
+**
+**
+** Returns          TRUE if matched
+**
+*******************************************************************************/
+static BOOLEAN nfa_cho_sm_is_main_link (UINT8 local_sap, UINT8 remote_sap)
+{
+    return ((local_sap == nfa_cho_cb.local_sap) && (remote_sap == nfa_cho_cb.remote_sap));
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_sm_is_collision_link
+**
+** Description      Check if SAPs are for the collision connection
+**
+**
+** Returns          TRUE if matched
+**
+*******************************************************************************/
+static BOOLEAN nfa_cho_sm_is_collision_link (UINT8 local_sap, UINT8 remote_sap)
+{
+    return (  (nfa_cho_cb.flags & NFA_CHO_FLAGS_CONN_COLLISION)
+            &&(local_sap == nfa_cho_cb.collision_local_sap)
+            &&(remote_sap == nfa_cho_cb.collision_remote_sap)  );
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_sm_accept_conn
+**
+** Description      Accept connection request from peer
+**
+**
+** Returns          TRUE if accepted
+**
+*******************************************************************************/
+static BOOLEAN nfa_cho_sm_accept_conn (tLLCP_SAP_CONNECT_IND *p_connect_ind)
+{
+    tLLCP_CONNECTION_PARAMS params;
+
+    params.miu   = NFA_CHO_MIU;
+    params.rw    = NFA_CHO_RW;
+    params.sn[0] = 0;
+
+    if (LLCP_ConnectCfm (p_connect_ind->local_sap, p_connect_ind->remote_sap, &params) != LLCP_STATUS_SUCCESS)
+    {
+        CHO_TRACE_ERROR0 ("nfa_cho_sm_accept_conn (): LLCP_ConnectCfm () failed");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_sm_proc_collision_conn_ind
+**
+** Description      Keep connection from peer as collision connection while
+**                  local connection is pending or not used yet
+**
+** Returns          None
+**
+*******************************************************************************/
+static void nfa_cho_sm_proc_collision_conn_ind (tLLCP_SAP_CONNECT_IND *p_connect_ind)
+{
+    if (  (!(nfa_cho_cb.flags & NFA_CHO_FLAGS_CONN_COLLISION))
+        &&(nfa_cho_cb.local_sap == nfa_cho_cb.client_sap)  )
+    {
+        if (nfa_cho_sm_accept_conn (p_connect_ind))
+        {
+            CHO_TRACE_DEBUG0 ("nfa_cho_sm_proc_collision_conn_ind (): Connection collision");
+
+            nfa_cho_cb.flags               |= NFA_CHO_FLAGS_CONN_COLLISION;
+            nfa_cho_cb.collision_local_sap  = p_connect_ind->local_sap;
+            nfa_cho_cb.collision_remote_sap = p_connect_ind->remote_sap;
+            nfa_cho_cb.collision_remote_miu = p_connect_ind->miu;
+            nfa_cho_cb.collision_congested  = FALSE;
+            nfa_cho_cb.collision_rx_ndef_cur_size = 0;
+        }
+    }
+    else
+    {
+        LLCP_ConnectReject (p_connect_ind->local_sap, p_connect_ind->remote_sap,
+                            LLCP_SAP_DM_REASON_TEMP_REJECT_THIS);
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_sm_use_collision_link
+**
+** Description      Use collision connection for handover as selector.
+**                  Its rx buffer becomes the one of the connection in use.
+**
+** Returns          None
+**
+*******************************************************************************/
+static void nfa_cho_sm_use_collision_link (void)
+{
+    UINT8  *p_msg    = nfa_cho_cb.p_rx_ndef_msg;
+    UINT32  buf_size = nfa_cho_cb.rx_ndef_buf_size;
+
+    CHO_TRACE_DEBUG0 ("nfa_cho_sm_use_collision_link ()");
+
+    nfa_cho_cb.p_rx_ndef_msg              = nfa_cho_cb.p_collision_rx_ndef_msg;
+    nfa_cho_cb.rx_ndef_buf_size           = nfa_cho_cb.collision_rx_ndef_buf_size;
+    nfa_cho_cb.rx_ndef_cur_size           = nfa_cho_cb.collision_rx_ndef_cur_size;
+    nfa_cho_cb.p_collision_rx_ndef_msg    = p_msg;
+    nfa_cho_cb.collision_rx_ndef_buf_size = buf_size;
+    nfa_cho_cb.collision_rx_ndef_cur_size = 0;
+
+    nfa_cho_cb.local_sap  = nfa_cho_cb.collision_local_sap;
+    nfa_cho_cb.remote_sap = nfa_cho_cb.collision_remote_sap;
+    nfa_cho_cb.remote_miu = nfa_cho_cb.collision_remote_miu;
+    nfa_cho_cb.congested  = nfa_cho_cb.collision_congested;
+    nfa_cho_cb.flags     &= ~NFA_CHO_FLAGS_CONN_COLLISION;
+
+    nfa_cho_cb.state      = NFA_CHO_ST_CONNECTED;
+    nfa_cho_cb.substate   = NFA_CHO_SUBSTATE_W4_REMOTE_HR;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_sm_proc_link_status
+**
+** Description      Notify application of LLCP link activation/deactivation
+**
+**
+** Returns          None
+**
+*******************************************************************************/
+static void nfa_cho_sm_proc_link_status (tLLCP_SAP_LINK_STATUS *p_link_status)
+{
+    tNFA_CHO_EVT_DATA evt_data;
+
+    /* all of registered SAPs are notified, use the one for client */
+    if (p_link_status->local_sap != nfa_cho_cb.client_sap)
+        return;
+
+    if (p_link_status->is_activated)
+    {
+        nfa_cho_cb.flags |= NFA_CHO_FLAGS_LLCP_ACTIVATED;
+
+        evt_data.activated.is_initiator = p_link_status->is_initiator;
+        nfa_cho_cb.p_cback (NFA_CHO_ACTIVATED_EVT, &evt_data);
+    }
+    else
+    {
+        nfa_cho_cb.flags &= ~NFA_CHO_FLAGS_LLCP_ACTIVATED;
+
+        if (  (nfa_cho_cb.state == NFA_CHO_ST_W4_CC)
+            ||(nfa_cho_cb.state == NFA_CHO_ST_CONNECTED)  )
+        {
+            nfa_cho_process_disconnection (NFA_CHO_DISC_REASON_LINK_DEACTIVATED);
+        }
+
+        evt_data.status = NFA_STATUS_OK;
+        nfa_cho_cb.p_cback (NFA_CHO_DEACTIVATED_EVT, &evt_data);
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_sm_proc_rx_ho_msg
+**
+** Description      Reassemble and process handover message on data link
+**                  connection in use
+**
+** Returns          None
+**
+*******************************************************************************/
+static void nfa_cho_sm_proc_rx_ho_msg (UINT8 local_sap, UINT8 remote_sap)
+{
+    tNFA_CHO_RX_NDEF_STATUS rx_status;
+    tNFA_CHO_MSG_TYPE       msg_type;
+
+    if (  (nfa_cho_cb.substate != NFA_CHO_SUBSTATE_W4_REMOTE_HR)
+        &&(nfa_cho_cb.substate != NFA_CHO_SUBSTATE_W4_REMOTE_HS)  )
+    {
+        CHO_TRACE_ERROR1 ("nfa_cho_sm_proc_rx_ho_msg (): Unexpected data in substate:%d",
+                          nfa_cho_cb.substate);
+        LLCP_FlushDataLinkRxData (local_sap, remote_sap);
+        return;
+    }
+
+    rx_status = nfa_cho_reassemble_ho_msg (local_sap, remote_sap);
+
+    if (rx_status == NFA_CHO_RX_NDEF_COMPLETE)
+    {
+        msg_type = nfa_cho_get_msg_type (nfa_cho_cb.rx_ndef_cur_size, nfa_cho_cb.p_rx_ndef_msg);
+
+        if (  (nfa_cho_cb.substate == NFA_CHO_SUBSTATE_W4_REMOTE_HR)
+            &&(msg_type == NFA_CHO_MSG_HR)  )
+        {
+            nfa_cho_cb.substate = NFA_CHO_SUBSTATE_W4_LOCAL_HS;
+            nfa_cho_proc_hr (nfa_cho_cb.rx_ndef_cur_size, nfa_cho_cb.p_rx_ndef_msg);
+            nfa_cho_cb.rx_ndef_cur_size = 0;
+        }
+        else if (  (nfa_cho_cb.substate == NFA_CHO_SUBSTATE_W4_REMOTE_HS)
+                 &&(msg_type == NFA_CHO_MSG_HS)  )
+        {
+            nfa_cho_cb.substate = NFA_CHO_SUBSTATE_W4_LOCAL_HR;
+            nfa_cho_proc_hs (nfa_cho_cb.rx_ndef_cur_size, nfa_cho_cb.p_rx_ndef_msg);
+            nfa_cho_cb.rx_ndef_cur_size = 0;
+        }
+        else
+        {
+            CHO_TRACE_ERROR1 ("nfa_cho_sm_proc_rx_ho_msg (): Unexpected message type:%d", msg_type);
+            nfa_cho_process_disconnection (NFA_CHO_DISC_REASON_UNKNOWN_MSG);
+        }
+    }
+    else if (rx_status == NFA_CHO_RX_NDEF_TEMP_MEM)
+    {
+        /* ask requester to try again later */
+        if (  (nfa_cho_cb.substate != NFA_CHO_SUBSTATE_W4_REMOTE_HR)
+            ||(nfa_cho_send_hs_error (NFA_CHO_ERROR_TEMP_MEM, NFA_CHO_TIMEOUT_FOR_RETRY) != NFA_STATUS_OK)  )
+        {
+            nfa_cho_process_disconnection (NFA_CHO_DISC_REASON_INTERNAL_ERROR);
+        }
+    }
+    else if (rx_status == NFA_CHO_RX_NDEF_INVALID)
+    {
+        nfa_cho_process_disconnection (NFA_CHO_DISC_REASON_INVALID_MSG);
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_sm_proc_rx_collision_msg
+**
+** Description      Process Handover Request on collision connection.
+**                  If local Hr is not sent yet, local device becomes selector.
+**                  Otherwise, roles are resolved by random numbers in Hr.
+**
+** Returns          None
+**
+*******************************************************************************/
+static void nfa_cho_sm_proc_rx_collision_msg (UINT8 local_sap, UINT8 remote_sap)
+{
+    tNFA_CHO_RX_NDEF_STATUS rx_status;
+    tNFA_CHO_ROLE_TYPE      role;
+    tNFA_CHO_EVT_DATA       evt_data;
+
+    if (nfa_cho_cb.substate == NFA_CHO_SUBSTATE_W4_LOCAL_HR)
+    {
+        /* peer is requesting first, close local connection */
+        LLCP_DisconnectReq (nfa_cho_cb.local_sap, nfa_cho_cb.remote_sap, TRUE);
+
+        nfa_cho_sm_use_collision_link ();
+
+        evt_data.connected.initial_role = NFA_CHO_ROLE_SELECTOR;
+        nfa_cho_cb.p_cback (NFA_CHO_CONNECTED_EVT, &evt_data);
+
+        nfa_cho_sm_proc_rx_ho_msg (local_sap, remote_sap);
+        return;
+    }
+    else if (nfa_cho_cb.substate != NFA_CHO_SUBSTATE_W4_REMOTE_HS)
+    {
+        LLCP_FlushDataLinkRxData (local_sap, remote_sap);
+        return;
+    }
+
+    rx_status = nfa_cho_reassemble_ho_msg (local_sap, remote_sap);
+
+    if (rx_status == NFA_CHO_RX_NDEF_INCOMPLTE)
+        return;
+
+    if (  (rx_status == NFA_CHO_RX_NDEF_COMPLETE)
+        &&(nfa_cho_get_msg_type (nfa_cho_cb.collision_rx_ndef_cur_size,
+                                 nfa_cho_cb.p_collision_rx_ndef_msg) == NFA_CHO_MSG_HR)  )
+    {
+        role = nfa_cho_get_local_device_role (nfa_cho_cb.collision_rx_ndef_cur_size,
+                                              nfa_cho_cb.p_collision_rx_ndef_msg);
+    }
+    else
+    {
+        CHO_TRACE_ERROR0 ("nfa_cho_sm_proc_rx_collision_msg (): No valid Hr on collision connection");
+        role = NFA_CHO_ROLE_REQUESTER;
+    }
+
+    CHO_TRACE_DEBUG1 ("nfa_cho_sm_proc_rx_collision_msg (): role:%d", role);
+
+    if (role == NFA_CHO_ROLE_SELECTOR)
+    {
+        /* respond to Hr from peer on collision connection, Hr is now in rx buffer in use */
+        LLCP_DisconnectReq (nfa_cho_cb.local_sap, nfa_cho_cb.remote_sap, TRUE);
+
+        nfa_cho_sm_use_collision_link ();
+        nfa_cho_cb.substate = NFA_CHO_SUBSTATE_W4_LOCAL_HS;
+
+        nfa_cho_proc_hr (nfa_cho_cb.rx_ndef_cur_size, nfa_cho_cb.p_rx_ndef_msg);
+        nfa_cho_cb.rx_ndef_cur_size = 0;
+        return;
+    }
+
+    nfa_cho_cb.collision_rx_ndef_cur_size = 0;
+
+    if (role == NFA_CHO_ROLE_REQUESTER)
+    {
+        /* peer will respond to local Hr */
+        LLCP_DisconnectReq (local_sap, remote_sap, TRUE);
+        nfa_cho_cb.flags &= ~NFA_CHO_FLAGS_CONN_COLLISION;
+    }
+    else
+    {
+        /* same random number, send Hr again with new one */
+        nfa_cho_cb.tx_ndef_sent_size = 0;
+
+        if (  (nfa_cho_update_random_number (nfa_cho_cb.p_tx_ndef_msg) != NFA_STATUS_OK)
+            ||(nfa_cho_send_handover_msg () != NFA_STATUS_OK)  )
+        {
+            nfa_cho_process_disconnection (NFA_CHO_DISC_REASON_INTERNAL_ERROR);
+            return;
+        }
+    }
+
+    nfa_sys_start_timer (&nfa_cho_cb.timer, NFA_CHO_TIMEOUT_EVT, NFA_CHO_TIMEOUT_FOR_HS);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_sm_disabled
+**
+** Description      Process event in disabled state
+**
+**
+** Returns          None
+**
+*******************************************************************************/
+static void nfa_cho_sm_disabled (tNFA_CHO_INT_EVT event, tNFA_CHO_INT_EVENT_DATA *p_data)
+{
+    tNFA_CHO_EVT_DATA evt_data;
+
+    switch (event)
+    {
+    case NFA_CHO_API_REG_EVT:
+        evt_data.status = nfa_cho_proc_api_reg (p_data);
+
+        if (evt_data.status == NFA_STATUS_OK)
+        {
+            nfa_cho_cb.state = NFA_CHO_ST_IDLE;
+        }
+        p_data->api_reg.p_cback (NFA_CHO_REG_EVT, &evt_data);
+        break;
+
+    case NFA_CHO_NDEF_TYPE_HANDLER_EVT:
+        nfa_cho_proc_ndef_type_handler_evt (p_data);
+        break;
+
+    default:
+        CHO_TRACE_ERROR0 ("nfa_cho_sm_disabled (): Unhandled event");
+        break;
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_sm_idle
+**
+** Description      Process event in idle state
+**
+**
+** Returns          None
+**
+*******************************************************************************/
+static void nfa_cho_sm_idle (tNFA_CHO_INT_EVT event, tNFA_CHO_INT_EVENT_DATA *p_data)
+{
+    tNFA_CHO_EVT_DATA evt_data;
+
+    switch (event)
+    {
+    case NFA_CHO_API_REG_EVT:
+        evt_data.status = NFA_STATUS_FAILED;
+        p_data->api_reg.p_cback (NFA_CHO_REG_EVT, &evt_data);
+        break;
+
+    case NFA_CHO_API_DEREG_EVT:
+        nfa_cho_proc_api_dereg ();
+        break;
+
+    case NFA_CHO_API_CONNECT_EVT:
+        if (  (nfa_cho_cb.flags & NFA_CHO_FLAGS_LLCP_ACTIVATED)
+            &&(nfa_cho_create_connection () == NFA_STATUS_OK)  )
+        {
+            nfa_cho_cb.state = NFA_CHO_ST_W4_CC;
+        }
+        else
+        {
+            evt_data.disconnected.reason = NFA_CHO_DISC_REASON_CONNECTION_FAIL;
+            nfa_cho_cb.p_cback (NFA_CHO_DISCONNECTED_EVT, &evt_data);
+        }
+        break;
+
+    case NFA_CHO_API_SEND_HR_EVT:
+    case NFA_CHO_API_SEND_HS_EVT:
+    case NFA_CHO_API_SEL_ERR_EVT:
+        nfa_cho_notify_tx_fail_evt (NFA_STATUS_FAILED);
+        break;
+
+    case NFA_CHO_RX_HANDOVER_MSG_EVT:
+        LLCP_FlushDataLinkRxData (p_data->llcp_cback_data.data_ind.local_sap,
+                                  p_data->llcp_cback_data.data_ind.remote_sap);
+        break;
+
+    case NFA_CHO_LLCP_CONNECT_IND_EVT:
+        if (nfa_cho_sm_accept_conn (&p_data->llcp_cback_data.connect_ind))
+        {
+            nfa_cho_cb.local_sap  = p_data->llcp_cback_data.connect_ind.local_sap;
+            nfa_cho_cb.remote_sap = p_data->llcp_cback_data.connect_ind.remote_sap;
+            nfa_cho_cb.remote_miu = p_data->llcp_cback_data.connect_ind.miu;
+            nfa_cho_cb.congested  = FALSE;
+
+            nfa_cho_cb.state      = NFA_CHO_ST_CONNECTED;
+            nfa_cho_cb.substate   = NFA_CHO_SUBSTATE_W4_REMOTE_HR;
+
+            evt_data.connected.initial_role = NFA_CHO_ROLE_SELECTOR;
+            nfa_cho_cb.p_cback (NFA_CHO_CONNECTED_EVT, &evt_data);
+        }
+        break;
+
+    case NFA_CHO_LLCP_CONNECT_RESP_EVT:
+        /* connection was cancelled by application while waiting */
+        LLCP_DisconnectReq (p_data->llcp_cback_data.connect_resp.local_sap,
+                            p_data->llcp_cback_data.connect_resp.remote_sap, TRUE);
+        break;
+
+    case NFA_CHO_LLCP_LINK_STATUS_EVT:
+        nfa_cho_sm_proc_link_status (&p_data->llcp_cback_data.link_status);
+        break;
+
+    case NFA_CHO_NDEF_TYPE_HANDLER_EVT:
+        nfa_cho_proc_ndef_type_handler_evt (p_data);
+        break;
+
+    default:
+        CHO_TRACE_DEBUG0 ("nfa_cho_sm_idle (): Ignore event");
+        break;
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_sm_w4_cc
+**
+** Description      Process event in waiting for connection confirm state
+**
+**
+** Returns          None
+**
+*******************************************************************************/
+static void nfa_cho_sm_w4_cc (tNFA_CHO_INT_EVT event, tNFA_CHO_INT_EVENT_DATA *p_data)
+{
+    tNFA_CHO_EVT_DATA evt_data;
+    tLLCP_SAP_CBACK_DATA *p_llcp = &p_data->llcp_cback_data;
+
+    switch (event)
+    {
+    case NFA_CHO_API_REG_EVT:
+        evt_data.status = NFA_STATUS_FAILED;
+        p_data->api_reg.p_cback (NFA_CHO_REG_EVT, &evt_data);
+        break;
+
+    case NFA_CHO_API_DEREG_EVT:
+        nfa_cho_proc_api_dereg ();
+        break;
+
+    case NFA_CHO_API_CONNECT_EVT:
+        evt_data.disconnected.reason = NFA_CHO_DISC_REASON_ALEADY_CONNECTED;
+        nfa_cho_cb.p_cback (NFA_CHO_DISCONNECTED_EVT, &evt_data);
+        break;
+
+    case NFA_CHO_API_DISCONNECT_EVT:
+        /* pending connection is closed when confirmed in idle state */
+        nfa_cho_process_disconnection (NFA_CHO_DISC_REASON_API_REQUEST);
+        break;
+
+    case NFA_CHO_API_SEND_HR_EVT:
+    case NFA_CHO_API_SEND_HS_EVT:
+    case NFA_CHO_API_SEL_ERR_EVT:
+        nfa_cho_notify_tx_fail_evt (NFA_STATUS_FAILED);
+        break;
+
+    case NFA_CHO_RX_HANDOVER_MSG_EVT:
+        if (nfa_cho_sm_is_collision_link (p_llcp->data_ind.local_sap, p_llcp->data_ind.remote_sap))
+        {
+            /* peer is requesting first, local connection is closed when confirmed */
+            nfa_cho_sm_use_collision_link ();
+
+            evt_data.connected.initial_role = NFA_CHO_ROLE_SELECTOR;
+            nfa_cho_cb.p_cback (NFA_CHO_CONNECTED_EVT, &evt_data);
+
+            nfa_cho_sm_proc_rx_ho_msg (p_llcp->data_ind.local_sap, p_llcp->data_ind.remote_sap);
+        }
+        else
+        {
+            LLCP_FlushDataLinkRxData (p_llcp->data_ind.local_sap, p_llcp->data_ind.remote_sap);
+        }
+        break;
+
+    case NFA_CHO_LLCP_CONNECT_IND_EVT:
+        nfa_cho_sm_proc_collision_conn_ind (&p_llcp->connect_ind);
+        break;
+
+    case NFA_CHO_LLCP_CONNECT_RESP_EVT:
+        nfa_cho_cb.local_sap  = p_llcp->connect_resp.local_sap;
+        nfa_cho_cb.remote_sap = p_llcp->connect_resp.remote_sap;
+        nfa_cho_cb.remote_miu = p_llcp->connect_resp.miu;
+        nfa_cho_cb.congested  = FALSE;
+
+        nfa_cho_cb.state      = NFA_CHO_ST_CONNECTED;
+        nfa_cho_cb.substate   = NFA_CHO_SUBSTATE_W4_LOCAL_HR;
+
+        evt_data.connected.initial_role = NFA_CHO_ROLE_REQUESTER;
+        nfa_cho_cb.p_cback (NFA_CHO_CONNECTED_EVT, &evt_data);
+        break;
+
+    case NFA_CHO_LLCP_DISCONNECT_RESP_EVT:
+        if (p_llcp->disconnect_resp.local_sap == nfa_cho_cb.client_sap)
+        {
+            if (nfa_cho_cb.flags & NFA_CHO_FLAGS_CONN_COLLISION)
+            {
+                /* connection is rejected but peer has connected */
+                nfa_cho_sm_use_collision_link ();
+
+                evt_data.connected.initial_role = NFA_CHO_ROLE_SELECTOR;
+                nfa_cho_cb.p_cback (NFA_CHO_CONNECTED_EVT, &evt_data);
+            }
+            else
+            {
+                nfa_cho_process_disconnection (NFA_CHO_DISC_REASON_CONNECTION_FAIL);
+            }
+        }
+        else if (nfa_cho_sm_is_collision_link (p_llcp->disconnect_resp.local_sap, p_llcp->disconnect_resp.remote_sap))
+        {
+            nfa_cho_cb.flags &= ~NFA_CHO_FLAGS_CONN_COLLISION;
+        }
+        break;
+
+    case NFA_CHO_LLCP_DISCONNECT_IND_EVT:
+        if (nfa_cho_sm_is_collision_link (p_llcp->disconnect_ind.local_sap, p_llcp->disconnect_ind.remote_sap))
+        {
+            nfa_cho_cb.flags &= ~NFA_CHO_FLAGS_CONN_COLLISION;
+        }
+        break;
+
+    case NFA_CHO_LLCP_CONGEST_EVT:
+        if (nfa_cho_sm_is_collision_link (p_llcp->congest.local_sap, p_llcp->congest.remote_sap))
+        {
+            nfa_cho_cb.collision_congested = p_llcp->congest.is_congested;
+        }
+        break;
+
+    case NFA_CHO_LLCP_LINK_STATUS_EVT:
+        nfa_cho_sm_proc_link_status (&p_llcp->link_status);
+        break;
+
+    case NFA_CHO_NDEF_TYPE_HANDLER_EVT:
+        nfa_cho_proc_ndef_type_handler_evt (p_data);
+        break;
+
+    default:
+        CHO_TRACE_DEBUG0 ("nfa_cho_sm_w4_cc (): Ignore event");
+        break;
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_sm_connected
+**
+** Description      Process event in connected state
+**
+**
+** Returns          None
+**
+*******************************************************************************/
+static void nfa_cho_sm_connected (tNFA_CHO_INT_EVT event, tNFA_CHO_INT_EVENT_DATA *p_data)
+{
+    tNFA_CHO_EVT_DATA evt_data;
+    tNFA_STATUS       status;
+    tLLCP_SAP_CBACK_DATA *p_llcp = &p_data->llcp_cback_data;
+
+    switch (event)
+    {
+    case NFA_CHO_API_REG_EVT:
+        evt_data.status = NFA_STATUS_FAILED;
+        p_data->api_reg.p_cback (NFA_CHO_REG_EVT, &evt_data);
+        break;
+
+    case NFA_CHO_API_DEREG_EVT:
+        nfa_cho_proc_api_dereg ();
+        break;
+
+    case NFA_CHO_API_CONNECT_EVT:
+        evt_data.disconnected.reason = NFA_CHO_DISC_REASON_ALEADY_CONNECTED;
+        nfa_cho_cb.p_cback (NFA_CHO_DISCONNECTED_EVT, &evt_data);
+        break;
+
+    case NFA_CHO_API_DISCONNECT_EVT:
+        nfa_cho_process_disconnection (NFA_CHO_DISC_REASON_API_REQUEST);
+        break;
+
+    case NFA_CHO_API_SEND_HR_EVT:
+        if (nfa_cho_cb.substate == NFA_CHO_SUBSTATE_W4_LOCAL_HR)
+        {
+            status = nfa_cho_send_hr (&p_data->api_send_hr);
+
+            if (status == NFA_STATUS_OK)
+            {
+                nfa_cho_cb.substate = NFA_CHO_SUBSTATE_W4_REMOTE_HS;
+                nfa_sys_start_timer (&nfa_cho_cb.timer, NFA_CHO_TIMEOUT_EVT, NFA_CHO_TIMEOUT_FOR_HS);
+            }
+        }
+        else
+        {
+            status = NFA_STATUS_FAILED;
+        }
+
+        if (status != NFA_STATUS_OK)
+            nfa_cho_notify_tx_fail_evt (status);
+        break;
+
+    case NFA_CHO_API_SEND_HS_EVT:
+    case NFA_CHO_API_SEL_ERR_EVT:
+        if (nfa_cho_cb.substate == NFA_CHO_SUBSTATE_W4_LOCAL_HS)
+        {
+            if (event == NFA_CHO_API_SEND_HS_EVT)
+            {
+                status = nfa_cho_send_hs (&p_data->api_send_hs);
+            }
+            else
+            {
+                status = nfa_cho_send_hs_error (p_data->api_sel_err.error_reason,
+                                                p_data->api_sel_err.error_data);
+            }
+
+            if (status == NFA_STATUS_OK)
+                nfa_cho_cb.substate = NFA_CHO_SUBSTATE_W4_REMOTE_HR;
+        }
+        else
+        {
+            status = NFA_STATUS_FAILED;
+        }
+
+        if (status != NFA_STATUS_OK)
+            nfa_cho_notify_tx_fail_evt (status);
+        break;
+
+    case NFA_CHO_RX_HANDOVER_MSG_EVT:
+        if (nfa_cho_sm_is_main_link (p_llcp->data_ind.local_sap, p_llcp->data_ind.remote_sap))
+        {
+            nfa_cho_sm_proc_rx_ho_msg (p_llcp->data_ind.local_sap, p_llcp->data_ind.remote_sap);
+        }
+        else if (nfa_cho_sm_is_collision_link (p_llcp->data_ind.local_sap, p_llcp->data_ind.remote_sap))
+        {
+            nfa_cho_sm_proc_rx_collision_msg (p_llcp->data_ind.local_sap, p_llcp->data_ind.remote_sap);
+        }
+        else
+        {
+            LLCP_FlushDataLinkRxData (p_llcp->data_ind.local_sap, p_llcp->data_ind.remote_sap);
+        }
+        break;
+
+    case NFA_CHO_LLCP_CONNECT_IND_EVT:
+        nfa_cho_sm_proc_collision_conn_ind (&p_llcp->connect_ind);
+        break;
+
+    case NFA_CHO_LLCP_CONNECT_RESP_EVT:
+        /* local connection confirmed after collision connection has been used */
+        LLCP_DisconnectReq (p_llcp->connect_resp.local_sap, p_llcp->connect_resp.remote_sap, TRUE);
+        break;
+
+    case NFA_CHO_LLCP_DISCONNECT_IND_EVT:
+        if (nfa_cho_sm_is_main_link (p_llcp->disconnect_ind.local_sap, p_llcp->disconnect_ind.remote_sap))
+        {
+            nfa_cho_process_disconnection (NFA_CHO_DISC_REASON_PEER_REQUEST);
+        }
+        else if (nfa_cho_sm_is_collision_link (p_llcp->disconnect_ind.local_sap, p_llcp->disconnect_ind.remote_sap))
+        {
+            nfa_cho_cb.flags &= ~NFA_CHO_FLAGS_CONN_COLLISION;
+        }
+        break;
+
+    case NFA_CHO_LLCP_DISCONNECT_RESP_EVT:
+        if (nfa_cho_sm_is_main_link (p_llcp->disconnect_resp.local_sap, p_llcp->disconnect_resp.remote_sap))
+        {
+            nfa_cho_process_disconnection (NFA_CHO_DISC_REASON_CONNECTION_FAIL);
+        }
+        else if (nfa_cho_sm_is_collision_link (p_llcp->disconnect_resp.local_sap, p_llcp->disconnect_resp.remote_sap))
+        {
+            nfa_cho_cb.flags &= ~NFA_CHO_FLAGS_CONN_COLLISION;
+        }
+        break;
+
+    case NFA_CHO_LLCP_CONGEST_EVT:
+        if (nfa_cho_sm_is_main_link (p_llcp->congest.local_sap, p_llcp->congest.remote_sap))
+        {
+            nfa_cho_cb.congested = p_llcp->congest.is_congested;
+
+            /* resume sending the rest of handover message */
+            if (  (!nfa_cho_cb.congested)
+                &&(nfa_cho_cb.tx_ndef_sent_size < nfa_cho_cb.tx_ndef_cur_size)  )
+            {
+                if ((status = nfa_cho_send_handover_msg ()) != NFA_STATUS_OK)
+                    nfa_cho_notify_tx_fail_evt (status);
+            }
+        }
+        else if (nfa_cho_sm_is_collision_link (p_llcp->congest.local_sap, p_llcp->congest.remote_sap))
+        {
+            nfa_cho_cb.collision_congested = p_llcp->congest.is_congested;
+        }
+        break;
+
+    case NFA_CHO_LLCP_LINK_STATUS_EVT:
+        nfa_cho_sm_proc_link_status (&p_llcp->link_status);
+        break;
+
+    case NFA_CHO_NDEF_TYPE_HANDLER_EVT:
+        nfa_cho_proc_ndef_type_handler_evt (p_data);
+        break;
+
+    case NFA_CHO_TIMEOUT_EVT:
+        nfa_cho_process_disconnection (NFA_CHO_DISC_REASON_TIMEOUT);
+        break;
+
+    default:
+        CHO_TRACE_DEBUG0 ("nfa_cho_sm_connected (): Ignore event");
+        break;
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_sm_execute
+**
+** Description      Process event in state machine
+**
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfa_cho_sm_execute (tNFA_CHO_INT_EVT event, tNFA_CHO_INT_EVENT_DATA *p_evt_data)
+{
+#if (BT_TRACE_VERBOSE == TRUE)
+    CHO_TRACE_DEBUG3 ("nfa_cho_sm_execute (): State[%s], Event[%s], Substate:%d",
+                      nfa_cho_state_code (nfa_cho_cb.state),
+                      nfa_cho_evt_code (event),
+                      nfa_cho_cb.substate);
+#else
+    CHO_TRACE_DEBUG3 ("nfa_cho_sm_execute (): State[%d], Event[0x%04x], Substate:%d",
+                      nfa_cho_cb.state, event, nfa_cho_cb.substate);
+#endif
+
+    switch (nfa_cho_cb.state)
+    {
+    case NFA_CHO_ST_DISABLED:
+        nfa_cho_sm_disabled (event, p_evt_data);
+        break;
+
+    case NFA_CHO_ST_IDLE:
+        nfa_cho_sm_idle (event, p_evt_data);
+        break;
+
+    case NFA_CHO_ST_W4_CC:
+        nfa_cho_sm_w4_cc (event, p_evt_data);
+        break;
+
+    case NFA_CHO_ST_CONNECTED:
+        nfa_cho_sm_connected (event, p_evt_data);
+        break;
+
+    default:
+        CHO_TRACE_ERROR1 ("nfa_cho_sm_execute (): Unknown state:%d", nfa_cho_cb.state);
+        break;
+    }
+}
+
+#if (BT_TRACE_VERBOSE == TRUE)
+/*******************************************************************************
+**
+** Function         nfa_cho_state_code
+**
+** Description
+**
+** Returns          string of state
+**
+*******************************************************************************/
+static char *nfa_cho_state_code (tNFA_CHO_STATE state_code)
+{
+    switch (state_code)
+    {
+    case NFA_CHO_ST_DISABLED:
+        return "DISABLED";
+    case NFA_CHO_ST_IDLE:
+        return "IDLE";
+    case NFA_CHO_ST_W4_CC:
+        return "W4_CC";
+    case NFA_CHO_ST_CONNECTED:
+        return "CONNECTED";
+    default:
+        return "Unknown state";
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_evt_code
+**
+** Description
+**
+** Returns          string of event
+**
+*******************************************************************************/
+static char *nfa_cho_evt_code (tNFA_CHO_INT_EVT evt_code)
+{
+    switch (evt_code)
+    {
+    case NFA_CHO_API_REG_EVT:
+        return "API_REG";
+    case NFA_CHO_API_DEREG_EVT:
+        return "API_DEREG";
+    case NFA_CHO_API_CONNECT_EVT:
+        return "API_CONNECT";
+    case NFA_CHO_API_DISCONNECT_EVT:
+        return "API_DISCONNECT";
+    case NFA_CHO_API_SEND_HR_EVT:
+        return "API_SEND_HR";
+    case NFA_CHO_API_SEND_HS_EVT:
+        return "API_SEND_HS";
+    case NFA_CHO_API_SEL_ERR_EVT:
+        return "API_SEL_ERR";
+    case NFA_CHO_RX_HANDOVER_MSG_EVT:
+        return "RX_HANDOVER_MSG";
+    case NFA_CHO_LLCP_CONNECT_IND_EVT:
+        return "LLCP_CONNECT_IND";
+    case NFA_CHO_LLCP_CONNECT_RESP_EVT:
+        return "LLCP_CONNECT_RESP";
+    case NFA_CHO_LLCP_DISCONNECT_IND_EVT:
+        return "LLCP_DISCONNECT_IND";
+    case NFA_CHO_LLCP_DISCONNECT_RESP_EVT:
+        return "LLCP_DISCONNECT_RESP";
+    case NFA_CHO_LLCP_CONGEST_EVT:
+        return "LLCP_CONGEST";
+    case NFA_CHO_LLCP_LINK_STATUS_EVT:
+        return "LLCP_LINK_STATUS";
+    case NFA_CHO_NDEF_TYPE_HANDLER_EVT:
+        return "NDEF_TYPE_HANDLER";
+    case NFA_CHO_TIMEOUT_EVT:
+        return "TIMEOUT";
+    default:
+        return "Unknown event";
+    }
+}
+#endif  /* Debug Functions */
+
+#endif /* (defined (NFA_CHO_INCLUDED) && (NFA_CHO_INCLUDED==TRUE)) */
@@ -0,0 +1,1358 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2015 Broadcom Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  This is the utility functions for the NFA Connection Handover.
+ *
+ *  Handover Request/Select messages are built from the carrier configuration
+ *  records given by the application, segmented by the MIU of the data link
+ *  and reassembled on reception. Static handover messages read from a tag
+ *  are received through the NDEF type handlers of NFA DM.
+ *
+ ******************************************************************************/
+#include <string.h>
+#include "nfc_api.h"
+#include "nfa_sys.h"
+#include "nfa_sys_int.h"
+#include "llcp_api.h"
+#include "llcp_defs.h"
+#include "nfa_p2p_int.h"
+#include "nfa_mem_co.h"
+#include "nfa_cho_api.h"
+#include "nfa_cho_int.h"
+
+#if (defined (NFA_CHO_INCLUDED) && (NFA_CHO_INCLUDED==TRUE))
+
+/*****************************************************************************
+**  Constants
+*****************************************************************************/
+#define NFA_CHO_SERVICE_NAME    "urn:nfc:sn:handover"
+
+/* maximum size of "ac" record; header (5), CPS (1), carrier data reference (1 + n), */
+/* auxiliary data reference count (1) and auxiliary data references (1 + n each)   */
+#define NFA_CHO_AC_REC_MAX_SIZE         (5 + 3 + NFA_CHO_MAX_REF_NAME_LEN \
+                                         + NFA_CHO_MAX_AUX_DATA_COUNT * (1 + NFA_CHO_MAX_REF_NAME_LEN))
+
+/* maximum size of message embedded in Hr/Hs; "cr" (7) or "err" (11) and "ac" records */
+#define NFA_CHO_EMBEDDED_MSG_MAX_SIZE   (11 + NFA_CHO_MAX_AC_INFO * NFA_CHO_AC_REC_MAX_SIZE)
+
+/* maximum size of Hr/Hs record without embedded message; header (8) and version (1) */
+#define NFA_CHO_HO_REC_MAX_HDR_SIZE     9
+
+static UINT8 hr_rec_type[HR_REC_TYPE_LEN]   = { 0x48, 0x72 };       /* "Hr"  */
+static UINT8 hs_rec_type[HS_REC_TYPE_LEN]   = { 0x48, 0x73 };       /* "Hs"  */
+static UINT8 cr_rec_type[CR_REC_TYPE_LEN]   = { 0x63, 0x72 };       /* "cr"  */
+static UINT8 ac_rec_type[AC_REC_TYPE_LEN]   = { 0x61, 0x63 };       /* "ac"  */
+static UINT8 err_rec_type[ERR_REC_TYPE_LEN] = { 0x65, 0x72, 0x72 }; /* "err" */
+static UINT8 *p_bt_oob_rec_type   = (UINT8 *) "application/vnd.bluetooth.ep.oob";
+static UINT8 *p_wifi_wsc_rec_type = (UINT8 *) "application/vnd.wfa.wsc";
+
+/*****************************************************************************
+**  Static Functions
+*****************************************************************************/
+static void nfa_cho_ndef_type_cback (tNFA_NDEF_EVT event, tNFA_NDEF_EVT_DATA *p_data);
+
+/*******************************************************************************
+**
+** Function         nfa_cho_ndef_type_cback
+**
+** Description      Callback function from NDEF type handlers of NFA DM.
+**                  It is called in NFA task, so event is processed directly.
+**
+** Returns          None
+**
+*******************************************************************************/
+static void nfa_cho_ndef_type_cback (tNFA_NDEF_EVT event, tNFA_NDEF_EVT_DATA *p_data)
+{
+    tNFA_CHO_INT_EVENT_DATA evt_data;
+
+    CHO_TRACE_DEBUG1 ("nfa_cho_ndef_type_cback () event:%d", event);
+
+    evt_data.ndef_type_hdlr.event = event;
+    evt_data.ndef_type_hdlr.data  = *p_data;
+
+    nfa_cho_sm_execute (NFA_CHO_NDEF_TYPE_HANDLER_EVT, &evt_data);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_proc_ndef_type_handler_evt
+**
+** Description      Process events from NDEF type handlers for static handover
+**
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfa_cho_proc_ndef_type_handler_evt (tNFA_CHO_INT_EVENT_DATA *p_evt_data)
+{
+    tNFA_NDEF_EVT_DATA *p_data = &p_evt_data->ndef_type_hdlr.data;
+    tNFA_CHO_MSG_TYPE   msg_type;
+    tNFA_HANDLE         handle;
+
+    if (p_evt_data->ndef_type_hdlr.event == NFA_NDEF_REGISTER_EVT)
+    {
+        if (p_data->ndef_reg.status != NFA_STATUS_OK)
+        {
+            CHO_TRACE_ERROR0 ("Failed to register NDEF type handler");
+            return;
+        }
+
+        handle = p_data->ndef_reg.ndef_type_handle;
+
+        /* handlers are registered in order of Hs, BT OOB and WiFi */
+        if (nfa_cho_cb.state == NFA_CHO_ST_DISABLED)
+        {
+            /* deregistered before registration of handler is completed */
+            NFA_DeregisterNDefTypeHandler (handle);
+        }
+        else if (nfa_cho_cb.hs_ndef_type_handle == NFA_HANDLE_INVALID)
+        {
+            nfa_cho_cb.hs_ndef_type_handle = handle;
+        }
+        else if (nfa_cho_cb.bt_ndef_type_handle == NFA_HANDLE_INVALID)
+        {
+            nfa_cho_cb.bt_ndef_type_handle = handle;
+        }
+        else if (nfa_cho_cb.wifi_ndef_type_handle == NFA_HANDLE_INVALID)
+        {
+            nfa_cho_cb.wifi_ndef_type_handle = handle;
+        }
+        else
+        {
+            NFA_DeregisterNDefTypeHandler (handle);
+        }
+    }
+    else if (  (p_evt_data->ndef_type_hdlr.event == NFA_NDEF_DATA_EVT)
+             &&(nfa_cho_cb.state != NFA_CHO_ST_DISABLED)
+             &&(p_data->ndef_data.len)  )
+    {
+        /*
+        ** Handlers get whole NDEF message, so only the handler of the first
+        ** record reports it. Hs message may include BT OOB or WiFi record.
+        */
+        handle   = p_data->ndef_data.ndef_type_handle;
+        msg_type = nfa_cho_get_msg_type (p_data->ndef_data.len, p_data->ndef_data.p_data);
+
+        if (  (handle == nfa_cho_cb.hs_ndef_type_handle)
+            &&(msg_type == NFA_CHO_MSG_HS)  )
+        {
+            nfa_cho_proc_hs (p_data->ndef_data.len, p_data->ndef_data.p_data);
+        }
+        else if (  ((handle == nfa_cho_cb.bt_ndef_type_handle) && (msg_type == NFA_CHO_MSG_BT_OOB))
+                 ||((handle == nfa_cho_cb.wifi_ndef_type_handle) && (msg_type == NFA_CHO_MSG_WIFI))  )
+        {
+            nfa_cho_proc_simplified_format (p_data->ndef_data.len, p_data->ndef_data.p_data);
+        }
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_proc_api_reg
+**
+** Description      Register handover server and client on LLCP, and NDEF
+**                  type handlers for static handover
+**
+**
+** Returns          NFA_STATUS_OK if success
+**
+*******************************************************************************/
+tNFA_STATUS nfa_cho_proc_api_reg (tNFA_CHO_INT_EVENT_DATA *p_evt_data)
+{
+    CHO_TRACE_DEBUG1 ("nfa_cho_proc_api_reg (): enable_server:%d",
+                      p_evt_data->api_reg.enable_server);
+
+    nfa_cho_cb.flags = 0;
+
+    if (p_evt_data->api_reg.enable_server)
+    {
+        nfa_cho_cb.server_sap = LLCP_RegisterServer (LLCP_INVALID_SAP,
+                                                     LLCP_LINK_TYPE_DATA_LINK_CONNECTION,
+                                                     NFA_CHO_SERVICE_NAME,
+                                                     nfa_cho_sm_llcp_cback);
+
+        if (nfa_cho_cb.server_sap == LLCP_INVALID_SAP)
+        {
+            CHO_TRACE_ERROR0 ("Failed to register handover server");
+            return NFA_STATUS_FAILED;
+        }
+    }
+    else
+    {
+        nfa_cho_cb.flags |= NFA_CHO_FLAGS_CLIENT_ONLY;
+    }
+
+    nfa_cho_cb.client_sap = LLCP_RegisterClient (LLCP_LINK_TYPE_DATA_LINK_CONNECTION,
+                                                 nfa_cho_sm_llcp_cback);
+
+    if (nfa_cho_cb.client_sap == LLCP_INVALID_SAP)
+    {
+        CHO_TRACE_ERROR0 ("Failed to register handover client");
+
+        if (nfa_cho_cb.server_sap != LLCP_INVALID_SAP)
+        {
+            LLCP_Deregister (nfa_cho_cb.server_sap);
+            nfa_cho_cb.server_sap = LLCP_INVALID_SAP;
+        }
+        return NFA_STATUS_FAILED;
+    }
+
+    /* handover server is found by SDP, no need to update WKS */
+    if (nfa_cho_cb.server_sap != LLCP_INVALID_SAP)
+    {
+        nfa_p2p_enable_listening (NFA_ID_CHO, FALSE);
+    }
+
+    /* NFA_NDEF_REGISTER_EVT is returned in this order */
+    NFA_RegisterNDefTypeHandler (TRUE, NDEF_TNF_WKT, hs_rec_type, HS_REC_TYPE_LEN,
+                                 nfa_cho_ndef_type_cback);
+    NFA_RegisterNDefTypeHandler (TRUE, NDEF_TNF_MEDIA, p_bt_oob_rec_type, BT_OOB_REC_TYPE_LEN,
+                                 nfa_cho_ndef_type_cback);
+    NFA_RegisterNDefTypeHandler (TRUE, NDEF_TNF_MEDIA, p_wifi_wsc_rec_type, WIFI_WSC_REC_TYPE_LEN,
+                                 nfa_cho_ndef_type_cback);
+
+    nfa_cho_cb.p_cback = p_evt_data->api_reg.p_cback;
+
+    return NFA_STATUS_OK;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_free_ndef_buffers
+**
+** Description      Free tx/rx buffers of handover message
+**
+**
+** Returns          None
+**
+*******************************************************************************/
+static void nfa_cho_free_ndef_buffers (void)
+{
+    if (nfa_cho_cb.p_tx_ndef_msg)
+    {
+        nfa_mem_co_free (nfa_cho_cb.p_tx_ndef_msg);
+        nfa_cho_cb.p_tx_ndef_msg = NULL;
+    }
+    nfa_cho_cb.tx_ndef_cur_size  = 0;
+    nfa_cho_cb.tx_ndef_sent_size = 0;
+
+    if (nfa_cho_cb.p_rx_ndef_msg)
+    {
+        nfa_mem_co_free (nfa_cho_cb.p_rx_ndef_msg);
+        nfa_cho_cb.p_rx_ndef_msg = NULL;
+    }
+    nfa_cho_cb.rx_ndef_buf_size = 0;
+    nfa_cho_cb.rx_ndef_cur_size = 0;
+
+    if (nfa_cho_cb.p_collision_rx_ndef_msg)
+    {
+        nfa_mem_co_free (nfa_cho_cb.p_collision_rx_ndef_msg);
+        nfa_cho_cb.p_collision_rx_ndef_msg = NULL;
+    }
+    nfa_cho_cb.collision_rx_ndef_buf_size = 0;
+    nfa_cho_cb.collision_rx_ndef_cur_size = 0;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_proc_api_dereg
+**
+** Description      Deregister handover server, client and NDEF type handlers
+**
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfa_cho_proc_api_dereg (void)
+{
+    CHO_TRACE_DEBUG0 ("nfa_cho_proc_api_dereg ()");
+
+    nfa_sys_stop_timer (&nfa_cho_cb.timer);
+    nfa_cho_free_ndef_buffers ();
+
+    if (nfa_cho_cb.hs_ndef_type_handle != NFA_HANDLE_INVALID)
+    {
+        NFA_DeregisterNDefTypeHandler (nfa_cho_cb.hs_ndef_type_handle);
+        nfa_cho_cb.hs_ndef_type_handle = NFA_HANDLE_INVALID;
+    }
+
+    if (nfa_cho_cb.bt_ndef_type_handle != NFA_HANDLE_INVALID)
+    {
+        NFA_DeregisterNDefTypeHandler (nfa_cho_cb.bt_ndef_type_handle);
+        nfa_cho_cb.bt_ndef_type_handle = NFA_HANDLE_INVALID;
+    }
+
+    if (nfa_cho_cb.wifi_ndef_type_handle != NFA_HANDLE_INVALID)
+    {
+        NFA_DeregisterNDefTypeHandler (nfa_cho_cb.wifi_ndef_type_handle);
+        nfa_cho_cb.wifi_ndef_type_handle = NFA_HANDLE_INVALID;
+    }
+
+    /* data link connections are closed by LLCP */
+    if (nfa_cho_cb.server_sap != LLCP_INVALID_SAP)
+    {
+        LLCP_Deregister (nfa_cho_cb.server_sap);
+        nfa_cho_cb.server_sap = LLCP_INVALID_SAP;
+
+        nfa_p2p_disable_listening (NFA_ID_CHO, FALSE);
+    }
+
+    if (nfa_cho_cb.client_sap != LLCP_INVALID_SAP)
+    {
+        LLCP_Deregister (nfa_cho_cb.client_sap);
+        nfa_cho_cb.client_sap = LLCP_INVALID_SAP;
+    }
+
+    nfa_cho_cb.flags     = 0;
+    nfa_cho_cb.congested = FALSE;
+    nfa_cho_cb.p_cback   = NULL;
+    nfa_cho_cb.state     = NFA_CHO_ST_DISABLED;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_create_connection
+**
+** Description      Create data link connection to handover server on peer
+**
+**
+** Returns          NFA_STATUS_OK if connection request is sent
+**
+*******************************************************************************/
+tNFA_STATUS nfa_cho_create_connection (void)
+{
+    tLLCP_CONNECTION_PARAMS params;
+
+    CHO_TRACE_DEBUG0 ("nfa_cho_create_connection ()");
+
+    params.miu = NFA_CHO_MIU;
+    params.rw  = NFA_CHO_RW;
+    BCM_STRNCPY_S (params.sn, sizeof (params.sn), NFA_CHO_SERVICE_NAME, LLCP_MAX_SN_LEN);
+    params.sn[LLCP_MAX_SN_LEN] = 0;
+
+    if (LLCP_ConnectReq (nfa_cho_cb.client_sap, LLCP_SAP_SDP, &params) == LLCP_STATUS_SUCCESS)
+    {
+        /* remote SAP is updated when connection is confirmed */
+        nfa_cho_cb.local_sap  = nfa_cho_cb.client_sap;
+        nfa_cho_cb.remote_sap = LLCP_SAP_SDP;
+        return NFA_STATUS_OK;
+    }
+
+    return NFA_STATUS_FAILED;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_process_disconnection
+**
+** Description      Close data link connections if any, release buffers and
+**                  notify application
+**
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfa_cho_process_disconnection (tNFA_CHO_DISC_REASON disc_reason)
+{
+    tNFA_CHO_EVT_DATA evt_data;
+
+    CHO_TRACE_DEBUG1 ("nfa_cho_process_disconnection (): disc_reason:%d", disc_reason);
+
+    nfa_sys_stop_timer (&nfa_cho_cb.timer);
+
+    if (disc_reason != NFA_CHO_DISC_REASON_LINK_DEACTIVATED)
+    {
+        /* peer has already closed data link if requested */
+        if (  (nfa_cho_cb.state == NFA_CHO_ST_CONNECTED)
+            &&(disc_reason != NFA_CHO_DISC_REASON_PEER_REQUEST)
+            &&(disc_reason != NFA_CHO_DISC_REASON_CONNECTION_FAIL)  )
+        {
+            LLCP_DisconnectReq (nfa_cho_cb.local_sap, nfa_cho_cb.remote_sap, TRUE);
+        }
+
+        if (nfa_cho_cb.flags & NFA_CHO_FLAGS_CONN_COLLISION)
+        {
+            LLCP_DisconnectReq (nfa_cho_cb.collision_local_sap, nfa_cho_cb.collision_remote_sap, TRUE);
+        }
+    }
+
+    nfa_cho_cb.flags      &= ~NFA_CHO_FLAGS_CONN_COLLISION;
+    nfa_cho_cb.congested   = FALSE;
+    nfa_cho_cb.disc_reason = disc_reason;
+    nfa_cho_cb.state       = NFA_CHO_ST_IDLE;
+
+    nfa_cho_free_ndef_buffers ();
+
+    evt_data.disconnected.reason = disc_reason;
+    nfa_cho_cb.p_cback (NFA_CHO_DISCONNECTED_EVT, &evt_data);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_notify_tx_fail_evt
+**
+** Description      Notify application of NFA_CHO_TX_FAIL_EVT
+**
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfa_cho_notify_tx_fail_evt (tNFA_STATUS status)
+{
+    tNFA_CHO_EVT_DATA evt_data;
+
+    CHO_TRACE_DEBUG1 ("nfa_cho_notify_tx_fail_evt (): status:0x%X", status);
+
+    evt_data.status = status;
+    nfa_cho_cb.p_cback (NFA_CHO_TX_FAIL_EVT, &evt_data);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_get_tx_miu
+**
+** Description      Get MIU for sending segments of handover message, limited
+**                  by the size of buffer in LLCP pool
+**
+** Returns          MIU
+**
+*******************************************************************************/
+static UINT16 nfa_cho_get_tx_miu (void)
+{
+    UINT16 buff_size;
+
+    buff_size = GKI_get_pool_bufsize (LLCP_POOL_ID) - BT_HDR_SIZE - LLCP_MIN_OFFSET;
+
+    return ((nfa_cho_cb.remote_miu < buff_size) ? nfa_cho_cb.remote_miu : buff_size);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_send_handover_msg
+**
+** Description      Send segments of handover message until all is sent or
+**                  data link is congested. Sending is resumed when data link
+**                  gets out of congestion.
+**
+** Returns          NFA_STATUS_OK if success
+**
+*******************************************************************************/
+tNFA_STATUS nfa_cho_send_handover_msg (void)
+{
+    BT_HDR      *p_msg;
+    UINT16       tx_miu;
+    UINT32       length;
+    tLLCP_STATUS status;
+
+    CHO_TRACE_DEBUG2 ("nfa_cho_send_handover_msg (): sent:%d/%d",
+                      nfa_cho_cb.tx_ndef_sent_size, nfa_cho_cb.tx_ndef_cur_size);
+
+    tx_miu = nfa_cho_get_tx_miu ();
+
+    while (  (!nfa_cho_cb.congested)
+           &&(nfa_cho_cb.tx_ndef_sent_size < nfa_cho_cb.tx_ndef_cur_size)  )
+    {
+        if ((p_msg = (BT_HDR *) GKI_getpoolbuf (LLCP_POOL_ID)) == NULL)
+        {
+            CHO_TRACE_ERROR0 ("nfa_cho_send_handover_msg (): Out of buffer");
+            return NFA_STATUS_NO_BUFFERS;
+        }
+
+        length = nfa_cho_cb.tx_ndef_cur_size - nfa_cho_cb.tx_ndef_sent_size;
+        if (length > tx_miu)
+            length = tx_miu;
+
+        p_msg->offset = LLCP_MIN_OFFSET;
+        p_msg->len    = (UINT16) length;
+        memcpy ((UINT8 *) (p_msg + 1) + p_msg->offset,
+                nfa_cho_cb.p_tx_ndef_msg + nfa_cho_cb.tx_ndef_sent_size, length);
+
+        status = LLCP_SendData (nfa_cho_cb.local_sap, nfa_cho_cb.remote_sap, p_msg);
+
+        if (status == LLCP_STATUS_FAIL)
+        {
+            CHO_TRACE_ERROR0 ("nfa_cho_send_handover_msg (): LLCP_SendData () failed");
+            return NFA_STATUS_FAILED;
+        }
+        else if (status == LLCP_STATUS_CONGESTED)
+        {
+            nfa_cho_cb.congested = TRUE;
+        }
+
+        nfa_cho_cb.tx_ndef_sent_size += length;
+    }
+
+    return NFA_STATUS_OK;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_get_rx_buf
+**
+** Description      Get rx buffer of data link connection. Collision connection
+**                  has its own buffer, so that a message on it is not mixed
+**                  with a message on local connection.
+**
+** Returns          None
+**
+*******************************************************************************/
+static void nfa_cho_get_rx_buf (UINT8 local_sap, UINT8 remote_sap,
+                                UINT8 ***ppp_msg, UINT32 **pp_buf_size, UINT32 **pp_cur_size)
+{
+    if (  (nfa_cho_cb.flags & NFA_CHO_FLAGS_CONN_COLLISION)
+        &&(local_sap == nfa_cho_cb.collision_local_sap)
+        &&(remote_sap == nfa_cho_cb.collision_remote_sap)  )
+    {
+        *ppp_msg     = &nfa_cho_cb.p_collision_rx_ndef_msg;
+        *pp_buf_size = &nfa_cho_cb.collision_rx_ndef_buf_size;
+        *pp_cur_size = &nfa_cho_cb.collision_rx_ndef_cur_size;
+    }
+    else
+    {
+        *ppp_msg     = &nfa_cho_cb.p_rx_ndef_msg;
+        *pp_buf_size = &nfa_cho_cb.rx_ndef_buf_size;
+        *pp_cur_size = &nfa_cho_cb.rx_ndef_cur_size;
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_read_ndef_msg
+**
+** Description      Read received data into rx buffer of the data link
+**                  connection, which grows as needed
+**
+** Returns          NFA_CHO_RX_NDEF_COMPLETE if complete NDEF message is received
+**                  NFA_CHO_RX_NDEF_INCOMPLTE if more data is expected
+**                  NFA_CHO_RX_NDEF_TEMP_MEM if failed to allocate buffer
+**                  NFA_CHO_RX_NDEF_INVALID if invalid NDEF message
+**
+*******************************************************************************/
+tNFA_CHO_RX_NDEF_STATUS nfa_cho_read_ndef_msg (UINT8 local_sap, UINT8 remote_sap)
+{
+    UINT8      **pp_msg, *p_new_buf;
+    UINT32      *p_buf_size, *p_cur_size;
+    UINT32       new_size, length;
+    BOOLEAN      more;
+    tNDEF_STATUS ndef_status;
+
+    nfa_cho_get_rx_buf (local_sap, remote_sap, &pp_msg, &p_buf_size, &p_cur_size);
+
+    do
+    {
+        /* make room for at least one I PDU */
+        if (*p_buf_size - *p_cur_size < NFA_CHO_MIU)
+        {
+            new_size = *p_cur_size + NFA_CHO_MIU;
+            if (new_size < 2 * *p_buf_size)
+                new_size = 2 * *p_buf_size;
+
+            if ((p_new_buf = (UINT8 *) nfa_mem_co_alloc (new_size)) == NULL)
+            {
+                CHO_TRACE_ERROR1 ("nfa_cho_read_ndef_msg (): Failed to allocate %d bytes", new_size);
+
+                LLCP_FlushDataLinkRxData (local_sap, remote_sap);
+                *p_cur_size = 0;
+                return NFA_CHO_RX_NDEF_TEMP_MEM;
+            }
+
+            if (*pp_msg)
+            {
+                memcpy (p_new_buf, *pp_msg, *p_cur_size);
+                nfa_mem_co_free (*pp_msg);
+            }
+
+            *pp_msg     = p_new_buf;
+            *p_buf_size = new_size;
+        }
+
+        more = LLCP_ReadDataLinkData (local_sap, remote_sap,
+                                      *p_buf_size - *p_cur_size,
+                                      &length,
+                                      *pp_msg + *p_cur_size);
+
+        *p_cur_size += length;
+
+    } while (more);
+
+    if (*p_cur_size == 0)
+        return NFA_CHO_RX_NDEF_INCOMPLTE;
+
+    ndef_status = NDEF_MsgValidate (*pp_msg, *p_cur_size, FALSE);
+
+    if (ndef_status == NDEF_OK)
+    {
+        return NFA_CHO_RX_NDEF_COMPLETE;
+    }
+    else if (  (ndef_status == NDEF_MSG_TOO_SHORT)
+             ||(ndef_status == NDEF_MSG_NO_MSG_END)
+             ||(ndef_status == NDEF_MSG_LENGTH_MISMATCH)  )
+    {
+        /* the last record is not received yet */
+        return NFA_CHO_RX_NDEF_INCOMPLTE;
+    }
+    else
+    {
+        CHO_TRACE_ERROR1 ("nfa_cho_read_ndef_msg (): Invalid NDEF message (0x%X)", ndef_status);
+        return NFA_CHO_RX_NDEF_INVALID;
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_reassemble_ho_msg
+**
+** Description      Reassemble segmented handover message.
+**                  Start timer to wait for the next segment if incomplete.
+**
+** Returns          tNFA_CHO_RX_NDEF_STATUS
+**
+*******************************************************************************/
+tNFA_CHO_RX_NDEF_STATUS nfa_cho_reassemble_ho_msg (UINT8 local_sap, UINT8 remote_sap)
+{
+    tNFA_CHO_RX_NDEF_STATUS rx_status;
+    UINT8  **pp_msg;
+    UINT32  *p_buf_size, *p_cur_size;
+
+    nfa_cho_get_rx_buf (local_sap, remote_sap, &pp_msg, &p_buf_size, &p_cur_size);
+
+    rx_status = nfa_cho_read_ndef_msg (local_sap, remote_sap);
+
+    CHO_TRACE_DEBUG2 ("nfa_cho_reassemble_ho_msg (): rx_status:%d, rx_size:%d",
+                      rx_status, *p_cur_size);
+
+    if (rx_status == NFA_CHO_RX_NDEF_INCOMPLTE)
+    {
+        nfa_sys_start_timer (&nfa_cho_cb.timer, NFA_CHO_TIMEOUT_EVT, NFA_CHO_TIMEOUT_SEGMENTED_HR);
+    }
+    else
+    {
+        nfa_sys_stop_timer (&nfa_cho_cb.timer);
+
+        if (rx_status != NFA_CHO_RX_NDEF_COMPLETE)
+            *p_cur_size = 0;
+    }
+
+    return rx_status;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_get_local_version
+**
+** Description      Get handover version to send
+**
+**
+** Returns          version
+**
+*******************************************************************************/
+static UINT8 nfa_cho_get_local_version (void)
+{
+#if (defined (NFA_CHO_TEST_INCLUDED) && (NFA_CHO_TEST_INCLUDED == TRUE))
+    if (nfa_cho_cb.test_enabled & NFA_CHO_TEST_VERSION)
+        return nfa_cho_cb.test_version;
+#endif
+
+    return NFA_CHO_VERSION;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_get_random_number
+**
+** Description      Get random number for collision resolution record
+**
+**
+** Returns          random number
+**
+*******************************************************************************/
+static UINT16 nfa_cho_get_random_number (void)
+{
+    UINT32 seed;
+
+#if (defined (NFA_CHO_TEST_INCLUDED) && (NFA_CHO_TEST_INCLUDED == TRUE))
+    if (nfa_cho_cb.test_enabled & NFA_CHO_TEST_RANDOM)
+        return nfa_cho_cb.test_random_number;
+#endif
+
+    /* mix tick count with previous number, so retry after tie gets a new one */
+    seed = GKI_get_tick_count () + (UINT32) nfa_cho_cb.tx_random_number * 1103515245 + 12345;
+
+    return (UINT16) (seed ^ (seed >> 16));
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_get_ref_id
+**
+** Description      Get payload ID of record as reference string
+**
+**
+** Returns          FALSE if no payload ID or too long
+**
+*******************************************************************************/
+static BOOLEAN nfa_cho_get_ref_id (UINT8 *p_rec, char *p_ref_str)
+{
+    UINT8 *p_id, id_len;
+
+    p_id = NDEF_RecGetId (p_rec, &id_len);
+
+    if ((id_len == 0) || (id_len > NFA_CHO_MAX_REF_NAME_LEN))
+    {
+        CHO_TRACE_ERROR1 ("nfa_cho_get_ref_id (): Invalid payload ID length (%d)", id_len);
+        return FALSE;
+    }
+
+    memcpy (p_ref_str, p_id, id_len);
+    p_ref_str[id_len] = 0;
+
+    return TRUE;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_add_ac_records
+**
+** Description      Add "ac" record for each carrier configuration record in
+**                  NDEF, which is followed by its auxiliary data records
+**
+** Returns          NFA_STATUS_OK if success
+**
+*******************************************************************************/
+static tNFA_STATUS nfa_cho_add_ac_records (UINT8 *p_msg, UINT32 max_size, UINT32 *p_cur_size,
+                                           UINT8 num_ac_info, tNFA_CHO_AC_INFO *p_ac_info,
+                                           UINT8 *p_ndef, UINT32 ndef_len)
+{
+    char   carrier_ref[NFA_CHO_MAX_REF_NAME_LEN + 1];
+    char   aux_ref[NFA_CHO_MAX_AUX_DATA_COUNT][NFA_CHO_MAX_REF_NAME_LEN + 1];
+    char  *p_aux_ref[NFA_CHO_MAX_AUX_DATA_COUNT];
+    UINT8 *p_rec, xx, yy;
+
+    p_rec = (ndef_len) ? p_ndef : NULL;
+
+    for (xx = 0; xx < num_ac_info; xx++)
+    {
+        if (  (p_rec == NULL)
+            ||(p_ac_info[xx].num_aux_data > NFA_CHO_MAX_AUX_DATA_COUNT)
+            ||(!nfa_cho_get_ref_id (p_rec, carrier_ref))  )
+        {
+            return NFA_STATUS_FAILED;
+        }
+        p_rec = NDEF_MsgGetNextRec (p_rec);
+
+        for (yy = 0; yy < p_ac_info[xx].num_aux_data; yy++)
+        {
+            if (  (p_rec == NULL)
+                ||(!nfa_cho_get_ref_id (p_rec, aux_ref[yy]))  )
+            {
+                return NFA_STATUS_FAILED;
+            }
+            p_aux_ref[yy] = aux_ref[yy];
+            p_rec = NDEF_MsgGetNextRec (p_rec);
+        }
+
+        if (NDEF_MsgAddWktAc (p_msg, max_size, p_cur_size,
+                              p_ac_info[xx].cps, carrier_ref,
+                              p_ac_info[xx].num_aux_data, p_aux_ref) != NDEF_OK)
+        {
+            return NFA_STATUS_FAILED;
+        }
+    }
+
+    return NFA_STATUS_OK;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_build_and_send_ho_msg
+**
+** Description      Build Hr or Hs message with embedded message and carrier
+**                  configuration records, and start sending it
+**
+** Returns          NFA_STATUS_OK if success
+**
+*******************************************************************************/
+static tNFA_STATUS nfa_cho_build_and_send_ho_msg (BOOLEAN is_hr,
+                                                  UINT8 *p_embedded, UINT32 embedded_len,
+                                                  UINT8 *p_ndef, UINT32 ndef_len)
+{
+    UINT32       max_size, cur_size = 0;
+    tNDEF_STATUS status;
+
+    /* free previous message, which was kept after sending to resend it on collision */
+    if (nfa_cho_cb.p_tx_ndef_msg)
+    {
+        nfa_mem_co_free (nfa_cho_cb.p_tx_ndef_msg);
+        nfa_cho_cb.p_tx_ndef_msg = NULL;
+    }
+    nfa_cho_cb.tx_ndef_cur_size  = 0;
+    nfa_cho_cb.tx_ndef_sent_size = 0;
+
+    max_size = NFA_CHO_HO_REC_MAX_HDR_SIZE + embedded_len + ndef_len;
+
+    if ((nfa_cho_cb.p_tx_ndef_msg = (UINT8 *) nfa_mem_co_alloc (max_size)) == NULL)
+    {
+        CHO_TRACE_ERROR1 ("nfa_cho_build_and_send_ho_msg (): Failed to allocate %d bytes", max_size);
+        return NFA_STATUS_NO_BUFFERS;
+    }
+
+    if (is_hr)
+        status = NDEF_MsgCreateWktHr (nfa_cho_cb.p_tx_ndef_msg, max_size, &cur_size, nfa_cho_get_local_version ());
+    else
+        status = NDEF_MsgCreateWktHs (nfa_cho_cb.p_tx_ndef_msg, max_size, &cur_size, nfa_cho_get_local_version ());
+
+    /* embedded message follows version in payload of Hr/Hs record */
+    if ((status == NDEF_OK) && (embedded_len))
+    {
+        status = NDEF_MsgAppendPayload (nfa_cho_cb.p_tx_ndef_msg, max_size, &cur_size,
+                                        nfa_cho_cb.p_tx_ndef_msg, p_embedded, embedded_len);
+    }
+
+    if ((status == NDEF_OK) && (ndef_len))
+    {
+        status = NDEF_MsgAppendRec (nfa_cho_cb.p_tx_ndef_msg, max_size, &cur_size, p_ndef, ndef_len);
+    }
+
+    if (status != NDEF_OK)
+    {
+        CHO_TRACE_ERROR1 ("nfa_cho_build_and_send_ho_msg (): Failed to build message (0x%X)", status);
+
+        nfa_mem_co_free (nfa_cho_cb.p_tx_ndef_msg);
+        nfa_cho_cb.p_tx_ndef_msg = NULL;
+        return NFA_STATUS_FAILED;
+    }
+
+    nfa_cho_cb.tx_ndef_cur_size = cur_size;
+
+    return nfa_cho_send_handover_msg ();
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_send_hr
+**
+** Description      Send Handover Request message with collision resolution
+**                  record and alternative carrier records
+**
+** Returns          NFA_STATUS_OK if success
+**
+*******************************************************************************/
+tNFA_STATUS nfa_cho_send_hr (tNFA_CHO_API_SEND_HR *p_api_send_hr)
+{
+    UINT8  embedded[NFA_CHO_EMBEDDED_MSG_MAX_SIZE];
+    UINT32 embedded_len = 0;
+
+    CHO_TRACE_DEBUG1 ("nfa_cho_send_hr (): num_ac_info:%d", p_api_send_hr->num_ac_info);
+
+    nfa_cho_cb.tx_random_number = nfa_cho_get_random_number ();
+
+    if (  (NDEF_MsgAddWktCr (embedded, sizeof (embedded), &embedded_len,
+                             nfa_cho_cb.tx_random_number) != NDEF_OK)
+        ||(nfa_cho_add_ac_records (embedded, sizeof (embedded), &embedded_len,
+                                   p_api_send_hr->num_ac_info, p_api_send_hr->p_ac_info,
+                                   p_api_send_hr->p_ndef, p_api_send_hr->cur_ndef_size) != NFA_STATUS_OK)  )
+    {
+        return NFA_STATUS_FAILED;
+    }
+
+    return nfa_cho_build_and_send_ho_msg (TRUE, embedded, embedded_len,
+                                          p_api_send_hr->p_ndef, p_api_send_hr->cur_ndef_size);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_send_hs
+**
+** Description      Send Handover Select message with alternative carrier
+**                  records. No "ac" record means no carrier is selected.
+**
+** Returns          NFA_STATUS_OK if success
+**
+*******************************************************************************/
+tNFA_STATUS nfa_cho_send_hs (tNFA_CHO_API_SEND_HS *p_api_select)
+{
+    UINT8  embedded[NFA_CHO_EMBEDDED_MSG_MAX_SIZE];
+    UINT32 embedded_len = 0;
+
+    CHO_TRACE_DEBUG1 ("nfa_cho_send_hs (): num_ac_info:%d", p_api_select->num_ac_info);
+
+    if (nfa_cho_add_ac_records (embedded, sizeof (embedded), &embedded_len,
+                                p_api_select->num_ac_info, p_api_select->p_ac_info,
+                                p_api_select->p_ndef, p_api_select->cur_ndef_size) != NFA_STATUS_OK)
+    {
+        return NFA_STATUS_FAILED;
+    }
+
+    return nfa_cho_build_and_send_ho_msg (FALSE, embedded, embedded_len,
+                                          p_api_select->p_ndef, p_api_select->cur_ndef_size);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_send_hs_error
+**
+** Description      Send Handover Select message with error record
+**
+**
+** Returns          NFA_STATUS_OK if success
+**
+*******************************************************************************/
+tNFA_STATUS nfa_cho_send_hs_error (UINT8 error_reason, UINT32 error_data)
+{
+    UINT8  embedded[NFA_CHO_EMBEDDED_MSG_MAX_SIZE];
+    UINT32 embedded_len = 0;
+
+    CHO_TRACE_DEBUG2 ("nfa_cho_send_hs_error (): error_reason:0x%X, error_data:0x%X",
+                      error_reason, error_data);
+
+    /* only permanent memory constraint has 4 bytes of error data */
+    if ((error_reason != NFA_CHO_ERROR_PERM_MEM) && (error_data > 0xFF))
+        error_data = 0xFF;
+
+    if (NDEF_MsgAddWktErr (embedded, sizeof (embedded), &embedded_len,
+                           error_reason, error_data) != NDEF_OK)
+    {
+        return NFA_STATUS_FAILED;
+    }
+
+    return nfa_cho_build_and_send_ho_msg (FALSE, embedded, embedded_len, NULL, 0);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_get_embedded_msg
+**
+** Description      Check version of Hr/Hs record and get message embedded in
+**                  its payload
+**
+** Returns          FALSE if major version is different or invalid message
+**
+*******************************************************************************/
+static BOOLEAN nfa_cho_get_embedded_msg (UINT8 *p_ho_rec, UINT8 **pp_embedded, UINT32 *p_embedded_len)
+{
+    UINT8  *p_payload;
+    UINT32  payload_len;
+
+    p_payload = NDEF_RecGetPayload (p_ho_rec, &payload_len);
+
+    if ((p_payload == NULL) || (payload_len == 0))
+    {
+        CHO_TRACE_ERROR0 ("nfa_cho_get_embedded_msg (): No version");
+        return FALSE;
+    }
+
+    if (NFA_CHO_GET_MAJOR_VERSION (*p_payload) != NFA_CHO_GET_MAJOR_VERSION (NFA_CHO_VERSION))
+    {
+        CHO_TRACE_ERROR1 ("nfa_cho_get_embedded_msg (): Unsupported version (0x%02X)", *p_payload);
+        return FALSE;
+    }
+
+    *pp_embedded    = p_payload + 1;
+    *p_embedded_len = payload_len - 1;
+
+    if (  (*p_embedded_len)
+        &&(NDEF_MsgValidate (*pp_embedded, *p_embedded_len, FALSE) != NDEF_OK)  )
+    {
+        CHO_TRACE_ERROR0 ("nfa_cho_get_embedded_msg (): Invalid embedded message");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_parse_ref_id
+**
+** Description      Parse length and reference string in "ac" record payload
+**
+**
+** Returns          pointer after reference, NULL if invalid
+**
+*******************************************************************************/
+static UINT8 *nfa_cho_parse_ref_id (UINT8 *p, UINT8 *p_end, tNFA_CHO_REF_ID *p_ref)
+{
+    if (p >= p_end)
+        return NULL;
+
+    p_ref->ref_len = *p++;
+
+    if (  (p_ref->ref_len > NFA_CHO_MAX_REF_NAME_LEN)
+        ||(p + p_ref->ref_len > p_end)  )
+    {
+        return NULL;
+    }
+
+    memcpy (p_ref->ref_name, p, p_ref->ref_len);
+
+    return (p + p_ref->ref_len);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_parse_ac_records
+**
+** Description      Parse "ac" records in embedded message of Hr/Hs
+**
+**
+** Returns          NFA_STATUS_OK if success
+**
+*******************************************************************************/
+static tNFA_STATUS nfa_cho_parse_ac_records (UINT8 *p_embedded, UINT8 *p_num_ac_rec,
+                                             tNFA_CHO_AC_REC *p_ac_rec)
+{
+    UINT8  *p_rec, *p, *p_end, xx;
+    UINT32  payload_len;
+
+    *p_num_ac_rec = 0;
+
+    p_rec = NDEF_MsgGetFirstRecByType (p_embedded, NDEF_TNF_WKT, ac_rec_type, AC_REC_TYPE_LEN);
+
+    while ((p_rec) && (*p_num_ac_rec < NFA_CHO_MAX_AC_INFO))
+    {
+        p = NDEF_RecGetPayload (p_rec, &payload_len);
+
+        if ((p == NULL) || (payload_len < 3))
+            return NFA_STATUS_FAILED;
+
+        p_end = p + payload_len;
+
+        p_ac_rec->cps = (*p++) & 0x03;
+
+        if ((p = nfa_cho_parse_ref_id (p, p_end, &p_ac_rec->carrier_data_ref)) == NULL)
+            return NFA_STATUS_FAILED;
+
+        if (p >= p_end)
+            return NFA_STATUS_FAILED;
+
+        p_ac_rec->aux_data_ref_count = *p++;
+
+        if (p_ac_rec->aux_data_ref_count > NFA_CHO_MAX_AUX_DATA_COUNT)
+        {
+            CHO_TRACE_ERROR1 ("nfa_cho_parse_ac_records (): Too many aux data (%d)",
+                              p_ac_rec->aux_data_ref_count);
+            return NFA_STATUS_FAILED;
+        }
+
+        for (xx = 0; xx < p_ac_rec->aux_data_ref_count; xx++)
+        {
+            if ((p = nfa_cho_parse_ref_id (p, p_end, &p_ac_rec->aux_data_ref[xx])) == NULL)
+                return NFA_STATUS_FAILED;
+        }
+
+        (*p_num_ac_rec)++;
+        p_ac_rec++;
+
+        p_rec = NDEF_MsgGetNextRecByType (p_rec, NDEF_TNF_WKT, ac_rec_type, AC_REC_TYPE_LEN);
+    }
+
+    return NFA_STATUS_OK;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_proc_hr
+**
+** Description      Notify application of alternative carriers in Handover
+**                  Request message with NFA_CHO_REQUEST_EVT
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfa_cho_proc_hr (UINT32 length, UINT8 *p_ndef_msg)
+{
+    tNFA_CHO_EVT_DATA evt_data;
+    UINT8  *p_embedded, *p_next_rec;
+    UINT32  embedded_len;
+
+    CHO_TRACE_DEBUG1 ("nfa_cho_proc_hr (): length:%d", length);
+
+    memset (&evt_data, 0, sizeof (tNFA_CHO_EVT_DATA));
+    evt_data.request.status = NFA_STATUS_FAILED;
+
+    if (nfa_cho_get_embedded_msg (p_ndef_msg, &p_embedded, &embedded_len))
+    {
+        if (embedded_len)
+        {
+            evt_data.request.status = nfa_cho_parse_ac_records (p_embedded,
+                                                                &evt_data.request.num_ac_rec,
+                                                                evt_data.request.ac_rec);
+        }
+        else
+        {
+            evt_data.request.status = NFA_STATUS_OK;
+        }
+    }
+
+    /* carrier configuration records follow Hr record */
+    if ((p_next_rec = NDEF_MsgGetNextRec (p_ndef_msg)) != NULL)
+    {
+        evt_data.request.p_ref_ndef   = p_next_rec;
+        evt_data.request.ref_ndef_len = length - (UINT32) (p_next_rec - p_ndef_msg);
+    }
+
+    nfa_cho_cb.p_cback (NFA_CHO_REQUEST_EVT, &evt_data);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_proc_hs
+**
+** Description      Notify application of selected carriers in Handover Select
+**                  message with NFA_CHO_SELECT_EVT, or error record with
+**                  NFA_CHO_SEL_ERR_EVT
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfa_cho_proc_hs (UINT32 length, UINT8 *p_ndef_msg)
+{
+    tNFA_CHO_EVT_DATA evt_data;
+    UINT8  *p_embedded, *p_next_rec, *p_err_rec, *p;
+    UINT32  embedded_len, payload_len;
+
+    CHO_TRACE_DEBUG1 ("nfa_cho_proc_hs (): length:%d", length);
+
+    memset (&evt_data, 0, sizeof (tNFA_CHO_EVT_DATA));
+    evt_data.select.status = NFA_STATUS_FAILED;
+
+    if (nfa_cho_get_embedded_msg (p_ndef_msg, &p_embedded, &embedded_len))
+    {
+        if (embedded_len)
+        {
+            p_err_rec = NDEF_MsgGetFirstRecByType (p_embedded, NDEF_TNF_WKT, err_rec_type, ERR_REC_TYPE_LEN);
+
+            if (p_err_rec)
+            {
+                p = NDEF_RecGetPayload (p_err_rec, &payload_len);
+
+                if ((p) && (payload_len >= 2))
+                {
+                    BE_STREAM_TO_UINT8 (evt_data.sel_err.error_reason, p);
+
+                    if ((evt_data.sel_err.error_reason == NFA_CHO_ERROR_PERM_MEM) && (payload_len >= 5))
+                    {
+                        BE_STREAM_TO_UINT32 (evt_data.sel_err.error_data, p);
+                    }
+                    else
+                    {
+                        BE_STREAM_TO_UINT8 (evt_data.sel_err.error_data, p);
+                    }
+
+                    nfa_cho_cb.p_cback (NFA_CHO_SEL_ERR_EVT, &evt_data);
+                    return;
+                }
+            }
+            else
+            {
+                evt_data.select.status = nfa_cho_parse_ac_records (p_embedded,
+                                                                   &evt_data.select.num_ac_rec,
+                                                                   evt_data.select.ac_rec);
+            }
+        }
+        else
+        {
+            /* no alternative carrier is selected */
+            evt_data.select.status = NFA_STATUS_OK;
+        }
+    }
+
+    if (evt_data.select.status == NFA_STATUS_OK)
+    {
+        /* carrier configuration records follow Hs record */
+        if ((p_next_rec = NDEF_MsgGetNextRec (p_ndef_msg)) != NULL)
+        {
+            evt_data.select.p_ref_ndef   = p_next_rec;
+            evt_data.select.ref_ndef_len = length - (UINT32) (p_next_rec - p_ndef_msg);
+        }
+    }
+    else
+    {
+        evt_data.select.num_ac_rec = 0;
+    }
+
+    nfa_cho_cb.p_cback (NFA_CHO_SELECT_EVT, &evt_data);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_proc_simplified_format
+**
+** Description      Notify application of BT OOB or WiFi record without Hs
+**                  record with NFA_CHO_SELECT_EVT
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfa_cho_proc_simplified_format (UINT32 length, UINT8 *p_ndef_msg)
+{
+    tNFA_CHO_EVT_DATA evt_data;
+    UINT8 *p_id, id_len;
+
+    CHO_TRACE_DEBUG1 ("nfa_cho_proc_simplified_format (): length:%d", length);
+
+    memset (&evt_data, 0, sizeof (tNFA_CHO_EVT_DATA));
+
+    evt_data.select.status         = NFA_STATUS_OK;
+    evt_data.select.num_ac_rec     = 1;
+    evt_data.select.ac_rec[0].cps  = NFA_CHO_CPS_UNKNOWN;
+
+    /* carrier data reference is payload ID of record, if any */
+    p_id = NDEF_RecGetId (p_ndef_msg, &id_len);
+    if ((id_len) && (id_len <= NFA_CHO_MAX_REF_NAME_LEN))
+    {
+        evt_data.select.ac_rec[0].carrier_data_ref.ref_len = id_len;
+        memcpy (evt_data.select.ac_rec[0].carrier_data_ref.ref_name, p_id, id_len);
+    }
+
+    evt_data.select.p_ref_ndef   = p_ndef_msg;
+    evt_data.select.ref_ndef_len = length;
+
+    nfa_cho_cb.p_cback (NFA_CHO_SELECT_EVT, &evt_data);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_get_msg_type
+**
+** Description      Get handover message type from the first record
+**
+**
+** Returns          tNFA_CHO_MSG_TYPE
+**
+*******************************************************************************/
+tNFA_CHO_MSG_TYPE nfa_cho_get_msg_type (UINT32 length, UINT8 *p_ndef_msg)
+{
+    UINT8 *p_type, tnf, type_len;
+
+    if (length < 3)
+        return NFA_CHO_MSG_UNKNOWN;
+
+    p_type = NDEF_RecGetType (p_ndef_msg, &tnf, &type_len);
+
+    if (tnf == NDEF_TNF_WKT)
+    {
+        if ((type_len == HR_REC_TYPE_LEN) && (!memcmp (p_type, hr_rec_type, HR_REC_TYPE_LEN)))
+            return NFA_CHO_MSG_HR;
+
+        if ((type_len == HS_REC_TYPE_LEN) && (!memcmp (p_type, hs_rec_type, HS_REC_TYPE_LEN)))
+            return NFA_CHO_MSG_HS;
+    }
+    else if (tnf == NDEF_TNF_MEDIA)
+    {
+        if ((type_len == BT_OOB_REC_TYPE_LEN) && (!memcmp (p_type, p_bt_oob_rec_type, BT_OOB_REC_TYPE_LEN)))
+            return NFA_CHO_MSG_BT_OOB;
+
+        if ((type_len == WIFI_WSC_REC_TYPE_LEN) && (!memcmp (p_type, p_wifi_wsc_rec_type, WIFI_WSC_REC_TYPE_LEN)))
+            return NFA_CHO_MSG_WIFI;
+    }
+
+    return NFA_CHO_MSG_UNKNOWN;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_get_local_device_role
+**
+** Description      Resolve handover request collision with random number in
+**                  received Hr and the one sent in local Hr.
+**                  If the least significant bits are the same, the device
+**                  with the bigger number becomes Handover Requester.
+**                  Otherwise, the device with the smaller number does.
+**
+** Returns          NFA_CHO_ROLE_UNDECIDED if random numbers are the same
+**
+*******************************************************************************/
+tNFA_CHO_ROLE_TYPE nfa_cho_get_local_device_role (UINT32 length, UINT8 *p_ndef_msg)
+{
+    UINT8  *p_embedded, *p_cr_rec, *p;
+    UINT32  embedded_len, payload_len;
+    UINT16  rx_random_number, tx_random_number = nfa_cho_cb.tx_random_number;
+
+    p_cr_rec = NULL;
+
+    if (  (nfa_cho_get_embedded_msg (p_ndef_msg, &p_embedded, &embedded_len))
+        &&(embedded_len)  )
+    {
+        p_cr_rec = NDEF_MsgGetFirstRecByType (p_embedded, NDEF_TNF_WKT, cr_rec_type, CR_REC_TYPE_LEN);
+    }
+
+    if (  (p_cr_rec == NULL)
+        ||((p = NDEF_RecGetPayload (p_cr_rec, &payload_len)) == NULL)
+        ||(payload_len != 2)  )
+    {
+        /* peer cannot resolve collision, so local device yields */
+        CHO_TRACE_ERROR0 ("nfa_cho_get_local_device_role (): No collision resolution record");
+        return NFA_CHO_ROLE_SELECTOR;
+    }
+
+    BE_STREAM_TO_UINT16 (rx_random_number, p);
+
+    CHO_TRACE_DEBUG2 ("nfa_cho_get_local_device_role (): tx_random:0x%04X, rx_random:0x%04X",
+                      tx_random_number, rx_random_number);
+
+    if (rx_random_number == tx_random_number)
+    {
+        return NFA_CHO_ROLE_UNDECIDED;
+    }
+    else if ((rx_random_number & 0x0001) == (tx_random_number & 0x0001))
+    {
+        return ((tx_random_number > rx_random_number) ? NFA_CHO_ROLE_REQUESTER : NFA_CHO_ROLE_SELECTOR);
+    }
+    else
+    {
+        return ((tx_random_number < rx_random_number) ? NFA_CHO_ROLE_REQUESTER : NFA_CHO_ROLE_SELECTOR);
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_cho_update_random_number
+**
+** Description      Replace random number in collision resolution record of
+**                  Hr message to send again
+**
+** Returns          NFA_STATUS_OK if success
+**
+*******************************************************************************/
+tNFA_STATUS nfa_cho_update_random_number (UINT8 *p_ndef_msg)
+{
+    UINT8  *p_embedded, *p_cr_rec, *p;
+    UINT32  embedded_len, payload_len;
+
+    if (  (p_ndef_msg == NULL)
+        ||(!nfa_cho_get_embedded_msg (p_ndef_msg, &p_embedded, &embedded_len))
+        ||(embedded_len == 0)
+        ||((p_cr_rec = NDEF_MsgGetFirstRecByType (p_embedded, NDEF_TNF_WKT, cr_rec_type, CR_REC_TYPE_LEN)) == NULL)
+        ||((p = NDEF_RecGetPayload (p_cr_rec, &payload_len)) == NULL)
+        ||(payload_len != 2)  )
+    {
+        CHO_TRACE_ERROR0 ("nfa_cho_update_random_number (): No collision resolution record");
+        return NFA_STATUS_FAILED;
+    }
+
+    nfa_cho_cb.tx_random_number = nfa_cho_get_random_number ();
+
+    UINT16_TO_BE_STREAM (p, nfa_cho_cb.tx_random_number);
+
+    return NFA_STATUS_OK;
+}
+
+#endif /* (defined (NFA_CHO_INCLUDED) && (NFA_CHO_INCLUDED==TRUE)) */
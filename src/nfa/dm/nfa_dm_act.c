@@ -207,6 +207,7 @@ void nfa_dm_proc_nfcc_power_mode (UINT8 nfcc_power_mode)
             nfa_dm_cb.setcfg_pending_mask, nfa_dm_cb.setcfg_pending_num);
         nfa_dm_cb.setcfg_pending_mask = 0;
         nfa_dm_cb.setcfg_pending_num  = 0;
+        nfa_dm_cb.setcfg_batch_len    = 0;
 
         nfa_dm_set_init_nci_params ();
         nfa_dm_cb.flags &= ~NFA_DM_FLAGS_POWER_OFF_SLEEP;
@@ -451,6 +452,9 @@ BOOLEAN nfa_dm_enable (tNFA_DM_MSG *p_data)
         nfa_dm_cb.p_dm_cback    = p_data->enable.p_dm_cback;
         nfa_dm_cb.p_conn_cback  = p_data->enable.p_conn_cback;
 
+        /* Send batched config parameters ahead of any other NCI command */
+        NFC_SetCmdFlushCback (nfa_dm_flush_set_config);
+
         /* Enable NFC stack */
         NFC_Enable (nfa_dm_nfc_response_cback);
     }
@@ -542,6 +546,10 @@ void nfa_dm_disable_complete (void)
         /* Free all buffers for NDEF handlers */
         nfa_dm_ndef_dereg_all();
 
+        /* Config parameters batched from now on are not sent */
+        NFC_SetCmdFlushCback (NULL);
+        nfa_dm_cb.setcfg_batch_len = 0;
+
         /* Disable nfc core stack */
         NFC_Disable ();
     }
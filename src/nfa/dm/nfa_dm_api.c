@@ -713,6 +713,23 @@ tNFA_STATUS NFA_SetRfDiscoveryDuration (UINT16 discovery_period_ms)
     return (NFA_STATUS_FAILED);
 }
 
+/*******************************************************************************
+**
+** Function         NFA_GetDiscSchedStats
+**
+** Description      Get the statistics and the last decision of the adaptive
+**                  RF discovery scheduler (NFA_DM_DISC_ADAPTIVE in the config).
+**
+** Returns          void
+**
+*******************************************************************************/
+void NFA_GetDiscSchedStats (tNFA_DISC_SCHED_STATS *p_stats)
+{
+    NFA_TRACE_API0 ("NFA_GetDiscSchedStats ()");
+
+    memcpy (p_stats, &nfa_dm_cb.disc_cb.sched.stats, sizeof (tNFA_DISC_SCHED_STATS));
+}
+
 /*******************************************************************************
 **
 ** Function         NFA_Select
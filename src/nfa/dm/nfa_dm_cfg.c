@@ -123,6 +123,13 @@ const tNFA_HCI_CFG nfa_hci_cfg =
 tNFA_HCI_CFG *p_nfa_hci_cfg = (tNFA_HCI_CFG *) &nfa_hci_cfg;
 
 BOOLEAN nfa_poll_bail_out_mode = FALSE;
+
+/* adapt the RF discovery schedule to the technologies that activate */
+BOOLEAN nfa_dm_disc_adaptive = FALSE;
+
+/* RF discovery duration (ms) used until NFA_SetRfDiscoveryDuration () */
+UINT16 nfa_dm_disc_duration_cfg = NFA_DM_DISC_DURATION_POLL;
+
 const tNFA_PROPRIETARY_CFG nfa_proprietary_cfg =
 {
     0x80, /* NCI_PROTOCOL_18092_ACTIVE */
@@ -413,18 +413,18 @@ static tNFA_STATUS nfa_dm_set_rf_listen_mode_config (tNFA_DM_DISC_TECH_PROTO_MAS
 ** Returns          void
 **
 *******************************************************************************/
-static void nfa_dm_set_total_duration (void)
+static void nfa_dm_set_total_duration (UINT16 disc_duration)
 {
     UINT8 params[10], *p;
 
-    NFA_TRACE_DEBUG0 ("nfa_dm_set_total_duration ()");
+    NFA_TRACE_DEBUG1 ("nfa_dm_set_total_duration () %d ms", disc_duration);
 
     p = params;
 
     /* for total duration */
     UINT8_TO_STREAM (p, NFC_PMID_TOTAL_DURATION);
     UINT8_TO_STREAM (p, NCI_PARAM_LEN_TOTAL_DURATION);
-    UINT16_TO_STREAM (p, nfa_dm_cb.disc_cb.disc_duration);
+    UINT16_TO_STREAM (p, disc_duration);
 
     if (p > params)
     {
@@ -757,6 +757,196 @@ static tNFA_DM_DISC_TECH_PROTO_MASK nfa_dm_disc_get_disc_mask (tNFC_RF_TECH_N_MO
     return (disc_mask);
 }
 
+/*******************************************************************************
+**
+** Function         nfa_dm_disc_sched_tech
+**
+** Description      Map a poll discovery type or technology and mode to the
+**                  technology index of the discovery scheduler
+**
+** Returns          NFA_DM_DISC_SCHED_TECH_xxx, or NFA_DM_DISC_SCHED_NUM_TECH
+**                  for listen mode
+**
+*******************************************************************************/
+static UINT8 nfa_dm_disc_sched_tech (UINT8 disc_type)
+{
+    if (disc_type == NFC_DISCOVERY_TYPE_POLL_A)
+        return NFA_DM_DISC_SCHED_TECH_A;
+    else if (disc_type == NFC_DISCOVERY_TYPE_POLL_B)
+        return NFA_DM_DISC_SCHED_TECH_B;
+    else if (disc_type == NFC_DISCOVERY_TYPE_POLL_F)
+        return NFA_DM_DISC_SCHED_TECH_F;
+    else if (disc_type == NFC_DISCOVERY_TYPE_POLL_A_ACTIVE)
+        return NFA_DM_DISC_SCHED_TECH_A_ACTIVE;
+    else if (disc_type == NFC_DISCOVERY_TYPE_POLL_F_ACTIVE)
+        return NFA_DM_DISC_SCHED_TECH_F_ACTIVE;
+    else if (disc_type == NFC_DISCOVERY_TYPE_POLL_ISO15693)
+        return NFA_DM_DISC_SCHED_TECH_ISO15693;
+    else if (disc_type == NFC_DISCOVERY_TYPE_POLL_B_PRIME)
+        return NFA_DM_DISC_SCHED_TECH_B_PRIME;
+    else if (disc_type == NFC_DISCOVERY_TYPE_POLL_KOVIO)
+        return NFA_DM_DISC_SCHED_TECH_KOVIO;
+    else
+        return NFA_DM_DISC_SCHED_NUM_TECH;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_dm_disc_sched_activated
+**
+** Description      Add an activation to the history of the discovery scheduler.
+**                  The history is halved every NFA_DM_DISC_SCHED_WINDOW
+**                  activations so that it follows what the device sees lately.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_dm_disc_sched_activated (tNFC_RF_TECH_N_MODE tech_n_mode)
+{
+    tNFA_DM_DISC_SCHED *p_sched = &nfa_dm_cb.disc_cb.sched;
+    UINT32 elapsed_ms;
+    UINT8  tech, xx;
+
+    if (p_sched->total_score >= NFA_DM_DISC_SCHED_WINDOW)
+    {
+        p_sched->stats.listen_score /= 2;
+        p_sched->total_score = p_sched->stats.listen_score;
+        for (xx = 0; xx < NFA_DM_DISC_SCHED_NUM_TECH; xx++)
+        {
+            p_sched->stats.score[xx] /= 2;
+            p_sched->total_score    += p_sched->stats.score[xx];
+        }
+    }
+
+    p_sched->stats.num_activations++;
+    p_sched->total_score++;
+
+    if ((tech = nfa_dm_disc_sched_tech (tech_n_mode)) < NFA_DM_DISC_SCHED_NUM_TECH)
+    {
+        p_sched->stats.score[tech]++;
+    }
+    else
+    {
+        p_sched->stats.num_listen_activations++;
+        p_sched->stats.listen_score++;
+    }
+
+    if (p_sched->disc_start_ticks)
+    {
+        /* moving average over the last 8 activations */
+        elapsed_ms = GKI_TICKS_TO_MS (GKI_get_os_tick_count () - p_sched->disc_start_ticks);
+        if (p_sched->stats.activation_time == 0)
+            p_sched->stats.activation_time = elapsed_ms;
+        else
+            p_sched->stats.activation_time = (p_sched->stats.activation_time * 7 + elapsed_ms) / 8;
+        p_sched->disc_start_ticks = 0;
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_dm_disc_sched_adapt
+**
+** Description      Adapt the poll configurations and the total duration to the
+**                  technologies that activated recently, if enabled by
+**                  nfa_dm_disc_adaptive.
+**
+**                  Poll technologies are ordered by recent activations. A
+**                  technology that activated in less than 1 of 10 recent
+**                  poll activations is polled every 2nd discovery period,
+**                  and one that did not activate every
+**                  NFA_DM_DISC_SCHED_MAX_FREQ periods; every technology is
+**                  still polled. If no listen mode is configured, the total
+**                  duration is halved, down to NFA_DM_DISC_SCHED_MIN_DURATION,
+**                  to poll more often. With a listen mode configured the
+**                  duration is kept, as it is the time left for a reader to
+**                  activate the device.
+**
+** Returns          total duration to use
+**
+*******************************************************************************/
+static UINT16 nfa_dm_disc_sched_adapt (tNFC_DISCOVER_PARAMS disc_params[], UINT8 num_params)
+{
+    tNFA_DM_DISC_SCHED  *p_sched = &nfa_dm_cb.disc_cb.sched;
+    tNFC_DISCOVER_PARAMS poll_params[NFA_DM_MAX_DISC_PARAMS];
+    UINT8   poll_pos[NFA_DM_MAX_DISC_PARAMS];
+    UINT8   num_poll = 0, num_listen = 0, xx, yy, tech, freq;
+    UINT16  poll_score, disc_duration = nfa_dm_cb.disc_cb.disc_duration;
+    BOOLEAN adapt, adapted = FALSE;
+
+    poll_score = p_sched->total_score - p_sched->stats.listen_score;
+    adapt = (  (nfa_dm_disc_adaptive)
+             &&(!nfa_dm_cb.disc_cb.excl_disc_entry.in_use)
+             &&(poll_score >= NFA_DM_DISC_SCHED_MIN_SAMPLES)  );
+
+    memset (p_sched->stats.freq, 0, sizeof (p_sched->stats.freq));
+
+    for (xx = 0; xx < num_params; xx++)
+    {
+        if (disc_params[xx].type & 0x80)
+            num_listen++;
+
+        if ((tech = nfa_dm_disc_sched_tech (disc_params[xx].type)) >= NFA_DM_DISC_SCHED_NUM_TECH)
+            continue;
+
+        if (adapt)
+        {
+            if (p_sched->stats.score[tech] == 0)
+                freq = NFA_DM_DISC_SCHED_MAX_FREQ;
+            else if (p_sched->stats.score[tech] * 10 < poll_score)
+                freq = (NFA_DM_DISC_SCHED_MAX_FREQ < 2) ? NFA_DM_DISC_SCHED_MAX_FREQ : 2;
+            else
+                freq = 1;
+
+            if (freq > disc_params[xx].frequency)
+            {
+                disc_params[xx].frequency = freq;
+                adapted = TRUE;
+            }
+
+            /* insert by recent activations, after technologies with the same score */
+            for (yy = num_poll; yy > 0; yy--)
+            {
+                if (  p_sched->stats.score[nfa_dm_disc_sched_tech (poll_params[yy - 1].type)]
+                    >= p_sched->stats.score[tech]  )
+                    break;
+                poll_params[yy] = poll_params[yy - 1];
+                adapted = TRUE;
+            }
+            poll_params[yy] = disc_params[xx];
+            poll_pos[num_poll++] = xx;
+        }
+        p_sched->stats.freq[tech] = disc_params[xx].frequency;
+    }
+
+    /* put the sorted poll configurations back in the slots of the poll configurations */
+    for (xx = 0; xx < num_poll; xx++)
+        disc_params[poll_pos[xx]] = poll_params[xx];
+
+    if (  (adapt)
+        &&(num_listen == 0)
+        &&(disc_duration > NFA_DM_DISC_SCHED_MIN_DURATION)  )
+    {
+        disc_duration = (disc_duration / 2 > NFA_DM_DISC_SCHED_MIN_DURATION) ? disc_duration / 2
+                                                                              : NFA_DM_DISC_SCHED_MIN_DURATION;
+        adapted = TRUE;
+    }
+    p_sched->stats.disc_duration = disc_duration;
+
+    if (adapted)
+    {
+        p_sched->stats.num_adapted_starts++;
+        NFA_TRACE_DEBUG6 ("nfa_dm_disc_sched_adapt () A:%d/%d B:%d/%d F:%d/%d",
+                          p_sched->stats.score[NFA_DM_DISC_SCHED_TECH_A], p_sched->stats.freq[NFA_DM_DISC_SCHED_TECH_A],
+                          p_sched->stats.score[NFA_DM_DISC_SCHED_TECH_B], p_sched->stats.freq[NFA_DM_DISC_SCHED_TECH_B],
+                          p_sched->stats.score[NFA_DM_DISC_SCHED_TECH_F], p_sched->stats.freq[NFA_DM_DISC_SCHED_TECH_F]);
+        NFA_TRACE_DEBUG3 ("nfa_dm_disc_sched_adapt () listen:%d, duration:%d ms, avg activation:%d ms",
+                          p_sched->stats.listen_score, disc_duration, p_sched->stats.activation_time);
+    }
+
+    return disc_duration;
+}
+
 /*******************************************************************************
 **
 ** Function         nfa_dm_disc_discovery_cback
@@ -776,6 +966,8 @@ static void nfa_dm_disc_discovery_cback (tNFC_DISCOVER_EVT event, tNFC_DISCOVER
     {
     case NFC_START_DEVT:
         dm_disc_event = NFA_DM_RF_DISCOVER_RSP;
+        if (p_data->status == NFC_STATUS_OK)
+            nfa_dm_cb.disc_cb.sched.disc_start_ticks = GKI_get_os_tick_count ();
         break;
     case NFC_RESULT_DEVT:
         dm_disc_event = NFA_DM_RF_DISCOVER_NTF;
@@ -785,6 +977,7 @@ static void nfa_dm_disc_discovery_cback (tNFC_DISCOVER_EVT event, tNFC_DISCOVER
         break;
     case NFC_ACTIVATE_DEVT:
         dm_disc_event = NFA_DM_RF_INTF_ACTIVATED_NTF;
+        nfa_dm_disc_sched_activated (p_data->activate.rf_tech_param.mode);
         break;
     case NFC_DEACTIVATE_DEVT:
         if (p_data->deactivate.is_ntf)
@@ -795,6 +988,8 @@ static void nfa_dm_disc_discovery_cback (tNFC_DISCOVER_EVT event, tNFC_DISCOVER
                 NFC_SetReassemblyFlag (TRUE);
                 nfa_dm_cb.flags &= ~NFA_DM_FLAGS_RAW_FRAME;
             }
+            if (p_data->deactivate.type == NFC_DEACTIVATE_TYPE_DISCOVERY)
+                nfa_dm_cb.disc_cb.sched.disc_start_ticks = GKI_get_os_tick_count ();
         }
         else
             dm_disc_event = NFA_DM_RF_DEACTIVATE_RSP;
@@ -972,6 +1167,7 @@ void nfa_dm_start_rf_discover (void)
     tNFA_DM_DISC_TECH_PROTO_MASK dm_disc_mask = 0, poll_mask, listen_mask;
     UINT8                   config_params[10], *p;
     UINT8                   num_params, xx;
+    UINT16                  disc_duration;
 
     NFA_TRACE_DEBUG0 ("nfa_dm_start_rf_discover ()");
     /* Make sure that RF discovery was enabled, or some app has exclusive control */
@@ -1139,8 +1335,11 @@ void nfa_dm_start_rf_discover (void)
             nfa_dm_set_rf_listen_mode_config (dm_disc_mask);
         }
 
+        /* Favour the technologies that activate lately */
+        disc_duration = nfa_dm_disc_sched_adapt (disc_params, num_params);
+
         /* Set polling duty cycle */
-        nfa_dm_set_total_duration ();
+        nfa_dm_set_total_duration (disc_duration);
         nfa_dm_cb.disc_cb.dm_disc_mask = dm_disc_mask;
 
         NFC_DiscoveryStart (num_params, disc_params, nfa_dm_disc_discovery_cback);
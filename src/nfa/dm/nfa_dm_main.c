@@ -24,6 +24,7 @@
  ******************************************************************************/
 
 #include <string.h>
+#include <stddef.h>
 #include "nfa_api.h"
 #include "nfa_sys.h"
 #include "nfa_dm_int.h"
@@ -102,7 +103,7 @@ void nfa_dm_init (void)
     NFA_TRACE_DEBUG0 ("nfa_dm_init ()");
     memset (&nfa_dm_cb, 0, sizeof (tNFA_DM_CB));
     nfa_dm_cb.poll_disc_handle = NFA_HANDLE_INVALID;
-    nfa_dm_cb.disc_cb.disc_duration = NFA_DM_DISC_DURATION_POLL;
+    nfa_dm_cb.disc_cb.disc_duration = nfa_dm_disc_duration_cfg;
     nfa_dm_cb.nfcc_pwr_mode    = NFA_DM_PWR_MODE_FULL;
 
     /* register message handler on NFA SYS */
@@ -213,243 +214,349 @@ BOOLEAN nfa_dm_is_active (void)
     else
         return FALSE;
 }
+/* Parameters whose value is kept in nfa_dm_cb.params, so that a SET_CONFIG
+** is sent only if the value changes */
+#define NFA_DM_PARAM_FIXED_LEN      0xFFFF  /* len_offset of a fixed length parameter */
+#define NFA_DM_PARAM(type, field, max_len)                                          \
+        {type, 1, max_len, offsetof (tNFA_DM_PARAMS, field), NFA_DM_PARAM_FIXED_LEN}
+#define NFA_DM_PARAM_VAR(type, field, max_len)                                      \
+        {type, 1, max_len, offsetof (tNFA_DM_PARAMS, field), offsetof (tNFA_DM_PARAMS, field##_len)}
+
+typedef struct
+{
+    UINT8   type;           /* first parameter ID                               */
+    UINT8   num;            /* number of consecutive IDs stored one after other */
+    UINT8   max_len;        /* length of the value in tNFA_DM_PARAMS            */
+    UINT16  offset;         /* offset of the value in tNFA_DM_PARAMS            */
+    UINT16  len_offset;     /* offset of the current length, for variable length */
+} tNFA_DM_PARAM_DESC;
+
+static const tNFA_DM_PARAM_DESC nfa_dm_param_desc[] =
+{
+    /* Poll F Configuration */
+    NFA_DM_PARAM     (NFC_PMID_PF_RC,               pf_rc,              NCI_PARAM_LEN_PF_RC),
+    NFA_DM_PARAM     (NFC_PMID_TOTAL_DURATION,      total_duration,     NCI_PARAM_LEN_TOTAL_DURATION),
+
+    /* Listen A Configuration */
+    NFA_DM_PARAM_VAR (NFC_PMID_LA_BIT_FRAME_SDD,    la_bit_frame_sdd,   NCI_PARAM_LEN_LA_BIT_FRAME_SDD),
+    NFA_DM_PARAM_VAR (NFC_PMID_LA_PLATFORM_CONFIG,  la_platform_config, NCI_PARAM_LEN_LA_PLATFORM_CONFIG),
+    NFA_DM_PARAM_VAR (NFC_PMID_LA_SEL_INFO,         la_sel_info,        NCI_PARAM_LEN_LA_SEL_INFO),
+    NFA_DM_PARAM_VAR (NFC_PMID_LA_NFCID1,           la_nfcid1,          NCI_NFCID1_MAX_LEN),
+    NFA_DM_PARAM_VAR (NFC_PMID_LA_HIST_BY,          la_hist_by,         NCI_MAX_HIS_BYTES_LEN),
+
+    /* Listen B Configuration */
+    NFA_DM_PARAM_VAR (NFC_PMID_LB_SENSB_INFO,       lb_sensb_info,      NCI_PARAM_LEN_LB_SENSB_INFO),
+    NFA_DM_PARAM_VAR (NFC_PMID_LB_NFCID0,           lb_nfcid0,          NCI_PARAM_LEN_LB_NFCID0),
+    NFA_DM_PARAM_VAR (NFC_PMID_LB_APPDATA,          lb_appdata,         NCI_PARAM_LEN_LB_APPDATA),
+    NFA_DM_PARAM_VAR (NFC_PMID_LB_ADC_FO,           lb_adc_fo,          NCI_PARAM_LEN_LB_ADC_FO),
+    NFA_DM_PARAM_VAR (NFC_PMID_LB_H_INFO,           lb_h_info,          NCI_MAX_ATTRIB_LEN),
+
+    /* Listen F Configuration */
+    NFA_DM_PARAM_VAR (NFC_PMID_LF_PROTOCOL,         lf_protocol,        NCI_PARAM_LEN_LF_PROTOCOL),
+    NFA_DM_PARAM_VAR (NFC_PMID_LF_T3T_FLAGS2,       lf_t3t_flags2,      NCI_PARAM_LEN_LF_T3T_FLAGS2),
+    NFA_DM_PARAM     (NFC_PMID_LF_T3T_PMM,          lf_t3t_pmm,         NCI_PARAM_LEN_LF_T3T_PMM),
+    {NFC_PMID_LF_T3T_ID1, NFA_CE_LISTEN_INFO_MAX, NCI_PARAM_LEN_LF_T3T_ID,
+     offsetof (tNFA_DM_PARAMS, lf_t3t_id), NFA_DM_PARAM_FIXED_LEN},
+
+    /* ISO-DEP and NFC-DEP Configuration */
+    NFA_DM_PARAM     (NFC_PMID_FWI,                 fwi,                NCI_PARAM_LEN_FWI),
+    NFA_DM_PARAM     (NFC_PMID_WT,                  wt,                 NCI_PARAM_LEN_WT),
+    NFA_DM_PARAM_VAR (NFC_PMID_ATR_REQ_GEN_BYTES,   atr_req_gen_bytes,  NCI_MAX_GEN_BYTES_LEN),
+    NFA_DM_PARAM_VAR (NFC_PMID_ATR_RES_GEN_BYTES,   atr_res_gen_bytes,  NCI_MAX_GEN_BYTES_LEN)
+};
+
+#define NFA_DM_NUM_PARAM_DESC   (sizeof (nfa_dm_param_desc) / sizeof (tNFA_DM_PARAM_DESC))
+
 /*******************************************************************************
 **
-** Function         nfa_dm_check_set_config
+** Function         nfa_dm_check_param_update
+**
+** Description      Check if a config parameter needs to be sent to NFCC, and
+**                  remember the new value if it is stored
+**
+** Returns          TRUE if the parameter is to be sent
+**
+*******************************************************************************/
+static BOOLEAN nfa_dm_check_param_update (UINT8 type, UINT8 len, UINT8 *p_value)
+{
+    const tNFA_DM_PARAM_DESC *p_desc = nfa_dm_param_desc;
+    UINT8   *p_stored, *p_cur_len;
+    BOOLEAN update = FALSE;
+    UINT8   xx;
+
+    for (xx = 0; xx < NFA_DM_NUM_PARAM_DESC; xx++, p_desc++)
+    {
+        if ((UINT8) (type - p_desc->type) < p_desc->num)
+            break;
+    }
+
+    /* we don't store this config item */
+    if (xx == NFA_DM_NUM_PARAM_DESC)
+        return TRUE;
+
+    p_stored = (UINT8 *) &nfa_dm_cb.params + p_desc->offset + (type - p_desc->type) * p_desc->max_len;
+
+    if (len <= p_desc->max_len)
+    {
+        if (p_desc->len_offset != NFA_DM_PARAM_FIXED_LEN)
+        {
+            p_cur_len = (UINT8 *) &nfa_dm_cb.params + p_desc->len_offset;
+            if (*p_cur_len != len)
+            {
+                *p_cur_len = len;
+                update = TRUE;
+            }
+#ifndef NFCC_FORCE_CONFIG_UPDATE
+            else if (memcmp (p_value, p_stored, len))
+#endif
+            {
+                update = TRUE;
+            }
+        }
+        else if (len == p_desc->max_len)  /* fixed length */
+        {
+            if (memcmp (p_value, p_stored, len))
+            {
+                update = TRUE;
+            }
+        }
+    }
+
+    if (update)
+    {
+        memcpy (p_stored, p_value, len);
+    }
+    return update;
+}
+
+/*******************************************************************************
 **
-** Description      Update config parameters only if it's different from NFCC
+** Function         nfa_dm_forget_param
 **
+** Description      Invalidate the stored value of a config parameter that
+**                  could not be sent to NFCC, so the next update of it is
+**                  sent even if it has the same value
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_dm_forget_param (UINT8 type)
+{
+    const tNFA_DM_PARAM_DESC *p_desc = nfa_dm_param_desc;
+    UINT8   *p_stored;
+    UINT8   xx;
+
+    for (xx = 0; xx < NFA_DM_NUM_PARAM_DESC; xx++, p_desc++)
+    {
+        if ((UINT8) (type - p_desc->type) < p_desc->num)
+            break;
+    }
+
+    /* we don't store this config item */
+    if (xx == NFA_DM_NUM_PARAM_DESC)
+        return;
+
+    if (p_desc->len_offset != NFA_DM_PARAM_FIXED_LEN)
+    {
+        /* no valid value has this length */
+        *((UINT8 *) &nfa_dm_cb.params + p_desc->len_offset) = p_desc->max_len + 1;
+    }
+    else
+    {
+        /* the stored value is the one NFCC did not get, make it differ */
+        p_stored = (UINT8 *) &nfa_dm_cb.params + p_desc->offset + (type - p_desc->type) * p_desc->max_len;
+        p_stored[0] ^= 0xFF;
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_dm_send_set_config
+**
+** Description      Send SET_CONFIG and keep track of whether its response
+**                  is to be reported with NFA_DM_SET_CONFIG_EVT
 **
 ** Returns          tNFA_STATUS
 **
 *******************************************************************************/
-tNFA_STATUS nfa_dm_check_set_config (UINT8 tlv_list_len, UINT8 *p_tlv_list, BOOLEAN app_init)
+static tNFA_STATUS nfa_dm_send_set_config (UINT8 tlv_list_len, UINT8 *p_tlv_list, BOOLEAN app_init)
 {
-    UINT8 type, len, *p_value, *p_stored = NULL, max_len = 0;
-    UINT8 xx = 0, updated_len = 0, *p_cur_len;
-    BOOLEAN update;
     tNFC_STATUS nfc_status;
     UINT32 cur_bit;
 
-    NFA_TRACE_DEBUG0 ("nfa_dm_check_set_config ()");
-
     /* We only allow 32 pending SET_CONFIGs */
     if (nfa_dm_cb.setcfg_pending_num >= NFA_DM_SETCONFIG_PENDING_MAX)
     {
-        NFA_TRACE_ERROR0 ("nfa_dm_check_set_config () error: pending number of SET_CONFIG exceeded");
+        NFA_TRACE_ERROR0 ("nfa_dm_send_set_config () error: pending number of SET_CONFIG exceeded");
         return NFA_STATUS_FAILED;
     }
 
-    while (tlv_list_len - xx >= 2) /* at least type and len */
+    if ((nfc_status = NFC_SetConfig (tlv_list_len, p_tlv_list)) == NFC_STATUS_OK)
     {
-        update  = FALSE;
-        type    = *(p_tlv_list + xx);
-        len     = *(p_tlv_list + xx + 1);
-        p_value = p_tlv_list + xx + 2;
-        p_cur_len = NULL;
+        /* Keep track of whether we will need to notify NFA_DM_SET_CONFIG_EVT on NFC_SET_CONFIG_REVT */
+
+        /* Get the next available bit offset for this setconfig (based on how many SetConfigs are outstanding) */
+        cur_bit = (UINT32) (1 << nfa_dm_cb.setcfg_pending_num);
 
-        switch (type)
+        /* If setconfig is due to NFA_SetConfig: then set the bit (NFA_DM_SET_CONFIG_EVT needed on NFC_SET_CONFIG_REVT) */
+        if (app_init)
         {
-        /*
-        **  Poll F Configuration
-        */
-        case NFC_PMID_PF_RC:
-            p_stored = nfa_dm_cb.params.pf_rc;
-            max_len  = NCI_PARAM_LEN_PF_RC;
-            break;
-        case NFC_PMID_TOTAL_DURATION:
-            p_stored = nfa_dm_cb.params.total_duration;
-            max_len  = NCI_PARAM_LEN_TOTAL_DURATION;
-            break;
+            nfa_dm_cb.setcfg_pending_mask |= cur_bit;
+        }
+        /* Otherwise setconfig is internal: clear the bit (NFA_DM_SET_CONFIG_EVT not needed on NFC_SET_CONFIG_REVT) */
+        else
+        {
+            nfa_dm_cb.setcfg_pending_mask &= ~cur_bit;
+        }
 
-        /*
-        **  Listen A Configuration
-        */
-        case NFC_PMID_LA_BIT_FRAME_SDD:
-            p_stored  = nfa_dm_cb.params.la_bit_frame_sdd;
-            max_len   = NCI_PARAM_LEN_LA_BIT_FRAME_SDD;
-            p_cur_len = &nfa_dm_cb.params.la_bit_frame_sdd_len;
-            break;
-        case NFC_PMID_LA_PLATFORM_CONFIG:
-            p_stored  = nfa_dm_cb.params.la_platform_config;
-            max_len   = NCI_PARAM_LEN_LA_PLATFORM_CONFIG;
-            p_cur_len = &nfa_dm_cb.params.la_platform_config_len;
-            break;
-        case NFC_PMID_LA_SEL_INFO:
-            p_stored  = nfa_dm_cb.params.la_sel_info;
-            max_len   = NCI_PARAM_LEN_LA_SEL_INFO;
-            p_cur_len = &nfa_dm_cb.params.la_sel_info_len;
-            break;
-        case NFC_PMID_LA_NFCID1:
-            p_stored  = nfa_dm_cb.params.la_nfcid1;
-            max_len   = NCI_NFCID1_MAX_LEN;
-            p_cur_len = &nfa_dm_cb.params.la_nfcid1_len;
-            break;
-        case NFC_PMID_LA_HIST_BY:
-            p_stored  = nfa_dm_cb.params.la_hist_by;
-            max_len   = NCI_MAX_HIS_BYTES_LEN;
-            p_cur_len = &nfa_dm_cb.params.la_hist_by_len;
-            break;
+        /* Increment setcfg_pending counter */
+        nfa_dm_cb.setcfg_pending_num++;
+    }
+    return (nfc_status);
+}
 
-        /*
-        **  Listen B Configuration
-        */
-        case NFC_PMID_LB_SENSB_INFO:
-            p_stored  = nfa_dm_cb.params.lb_sensb_info;
-            max_len   = NCI_PARAM_LEN_LB_SENSB_INFO;
-            p_cur_len = &nfa_dm_cb.params.lb_sensb_info_len;
-            break;
-        case NFC_PMID_LB_NFCID0:
-            p_stored  = nfa_dm_cb.params.lb_nfcid0;
-            max_len   = NCI_PARAM_LEN_LB_NFCID0;
-            p_cur_len = &nfa_dm_cb.params.lb_nfcid0_len;
-            break;
-        case NFC_PMID_LB_APPDATA:
-            p_stored  = nfa_dm_cb.params.lb_appdata;
-            max_len   = NCI_PARAM_LEN_LB_APPDATA;
-            p_cur_len = &nfa_dm_cb.params.lb_appdata_len;
-            break;
-        case NFC_PMID_LB_ADC_FO:
-            p_stored  = nfa_dm_cb.params.lb_adc_fo;
-            max_len   = NCI_PARAM_LEN_LB_ADC_FO;
-            p_cur_len = &nfa_dm_cb.params.lb_adc_fo_len;
-            break;
-        case NFC_PMID_LB_H_INFO:
-            p_stored  = nfa_dm_cb.params.lb_h_info;
-            max_len   = NCI_MAX_ATTRIB_LEN;
-            p_cur_len = &nfa_dm_cb.params.lb_h_info_len;
-            break;
+/*******************************************************************************
+**
+** Function         nfa_dm_flush_set_config
+**
+** Description      Send the config parameters batched by nfa_dm_check_set_config
+**                  in one SET_CONFIG. Registered with NFC_SetCmdFlushCback, so
+**                  it is called before any other NCI command and at the end
+**                  of every event processed by NFC_TASK.
+**
+** Returns          void
+**
+*******************************************************************************/
+void nfa_dm_flush_set_config (void)
+{
+    UINT8 tlv_list_len = nfa_dm_cb.setcfg_batch_len;
 
-        /*
-        **  Listen F Configuration
-        */
-        case NFC_PMID_LF_PROTOCOL:
-            p_stored  = nfa_dm_cb.params.lf_protocol;
-            max_len   = NCI_PARAM_LEN_LF_PROTOCOL;
-            p_cur_len = &nfa_dm_cb.params.lf_protocol_len;
-            break;
-        case NFC_PMID_LF_T3T_FLAGS2:
-            p_stored  = nfa_dm_cb.params.lf_t3t_flags2;
-            max_len   = NCI_PARAM_LEN_LF_T3T_FLAGS2;
-            p_cur_len = &nfa_dm_cb.params.lf_t3t_flags2_len;
-            break;
-        case NFC_PMID_LF_T3T_PMM:
-            p_stored = nfa_dm_cb.params.lf_t3t_pmm;
-            max_len  = NCI_PARAM_LEN_LF_T3T_PMM;
-            break;
+    if (tlv_list_len == 0)
+        return;
 
-        /*
-        **  ISO-DEP and NFC-DEP Configuration
-        */
-        case NFC_PMID_FWI:
-            p_stored = nfa_dm_cb.params.fwi;
-            max_len  = NCI_PARAM_LEN_FWI;
-            break;
-        case NFC_PMID_WT:
-            p_stored = nfa_dm_cb.params.wt;
-            max_len  = NCI_PARAM_LEN_WT;
-            break;
-        case NFC_PMID_ATR_REQ_GEN_BYTES:
-            p_stored  = nfa_dm_cb.params.atr_req_gen_bytes;
-            max_len   = NCI_MAX_GEN_BYTES_LEN;
-            p_cur_len = &nfa_dm_cb.params.atr_req_gen_bytes_len;
-            break;
-        case NFC_PMID_ATR_RES_GEN_BYTES:
-            p_stored  = nfa_dm_cb.params.atr_res_gen_bytes;
-            max_len   = NCI_MAX_GEN_BYTES_LEN;
-            p_cur_len = &nfa_dm_cb.params.atr_res_gen_bytes_len;
-            break;
-        default:
-            /*
-            **  Listen F Configuration
-            */
-            if ((type >= NFC_PMID_LF_T3T_ID1) && (type < NFC_PMID_LF_T3T_ID1 + NFA_CE_LISTEN_INFO_MAX))
-            {
-                p_stored = nfa_dm_cb.params.lf_t3t_id[type - NFC_PMID_LF_T3T_ID1];
-                max_len  = NCI_PARAM_LEN_LF_T3T_ID;
-            }
-            else
-            {
-                /* we don't stored this config items */
-                update   = TRUE;
-                p_stored = NULL;
-            }
-            break;
-        }
+    NFA_TRACE_DEBUG1 ("nfa_dm_flush_set_config () %d bytes", tlv_list_len);
 
-        if ((p_stored)&&(len <= max_len))
+    /* sending SET_CONFIG calls this function again */
+    nfa_dm_cb.setcfg_batch_len = 0;
+    if (nfa_dm_send_set_config (tlv_list_len, nfa_dm_cb.setcfg_batch, FALSE) != NFA_STATUS_OK)
+    {
+        /* keep the batch, it is sent again by the next flush */
+        NFA_TRACE_WARNING0 ("nfa_dm_flush_set_config () SET_CONFIG not sent, batch kept");
+        nfa_dm_cb.setcfg_batch_len = tlv_list_len;
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_dm_batch_set_config
+**
+** Description      Add a config parameter TLV to the next SET_CONFIG. A value
+**                  still in the batch for the same parameter is replaced.
+**                  The batch is sent first if the TLV does not fit in the
+**                  largest control message the NFCC accepts.
+**
+** Returns          tNFA_STATUS
+**
+*******************************************************************************/
+static tNFA_STATUS nfa_dm_batch_set_config (UINT8 *p_tlv)
+{
+    UINT8  *p_batch = nfa_dm_cb.setcfg_batch;
+    UINT16 tlv_len = p_tlv[1] + 2, max_len, xx = 0, old_len;
+
+    while (xx < nfa_dm_cb.setcfg_batch_len)
+    {
+        old_len = p_batch[xx + 1] + 2;
+        if (p_batch[xx] == p_tlv[0])
         {
-            if (p_cur_len)
-            {
-                if (*p_cur_len != len)
-                {
-                    *p_cur_len = len;
-                    update = TRUE;
-                }
-#ifndef NFCC_FORCE_CONFIG_UPDATE
-                else if (memcmp (p_value, p_stored, len))
-#endif
-                {
-                    update = TRUE;
-                }
-            }
-            else if (len == max_len)  /* fixed length */
-            {
-                if (memcmp (p_value, p_stored, len))
-                {
-                    update = TRUE;
-                }
-            }
+            memmove (p_batch + xx, p_batch + xx + old_len, nfa_dm_cb.setcfg_batch_len - xx - old_len);
+            nfa_dm_cb.setcfg_batch_len -= old_len;
+            break;
         }
+        xx += old_len;
+    }
 
-        if (update)
-        {
-            /* we don't store this type */
-            if (p_stored)
-            {
-                memcpy (p_stored, p_value, len);
-            }
+    /* SET_CONFIG payload is the number of parameters and the TLVs */
+    max_len = NFC_GetMaxCtrlPayloadSize () - 1;
+    if (max_len > NFA_DM_SETCONFIG_BATCH_SIZE)
+        max_len = NFA_DM_SETCONFIG_BATCH_SIZE;
 
-            /* If need to change TLV in the original list. (Do not modify list if app_init) */
-            if ((updated_len != xx) && (!app_init))
+    if (nfa_dm_cb.setcfg_batch_len + tlv_len > max_len)
+    {
+        nfa_dm_flush_set_config ();
+
+        /* too long to batch or the batch could not be sent, send it as it is */
+        if (nfa_dm_cb.setcfg_batch_len + tlv_len > max_len)
+        {
+            if (nfa_dm_send_set_config ((UINT8) tlv_len, p_tlv, FALSE) != NFA_STATUS_OK)
             {
-                memcpy (p_tlv_list + updated_len, p_tlv_list + xx, (len + 2));
+                /* NFCC still has the previous value */
+                nfa_dm_forget_param (p_tlv[0]);
+                return NFA_STATUS_FAILED;
             }
-            updated_len += (len + 2);
+            return NFA_STATUS_OK;
         }
-        xx += len + 2;  /* move to next TLV */
     }
 
-    /* If any TVLs to update, or if the SetConfig was initiated by the application, then send the SET_CONFIG command */
-    if (updated_len || app_init)
+    memcpy (p_batch + nfa_dm_cb.setcfg_batch_len, p_tlv, tlv_len);
+    nfa_dm_cb.setcfg_batch_len += (UINT8) tlv_len;
+
+    return NFA_STATUS_OK;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_dm_check_set_config
+**
+** Description      Update config parameters only if it's different from NFCC.
+**                  Internal updates are batched and sent in one SET_CONFIG by
+**                  nfa_dm_flush_set_config; a SET_CONFIG of the application
+**                  is sent at once, after the batch.
+**
+** Returns          tNFA_STATUS
+**
+*******************************************************************************/
+tNFA_STATUS nfa_dm_check_set_config (UINT8 tlv_list_len, UINT8 *p_tlv_list, BOOLEAN app_init)
+{
+    UINT8 type, len, *p_value;
+    UINT8 xx = 0, updated_len = 0;
+    tNFA_STATUS status = NFA_STATUS_OK;
+
+    NFA_TRACE_DEBUG0 ("nfa_dm_check_set_config ()");
+
+    /* We only allow 32 pending SET_CONFIGs */
+    if (nfa_dm_cb.setcfg_pending_num >= NFA_DM_SETCONFIG_PENDING_MAX)
     {
-        if ((nfc_status = NFC_SetConfig (updated_len, p_tlv_list)) == NFC_STATUS_OK)
-        {
-            /* Keep track of whether we will need to notify NFA_DM_SET_CONFIG_EVT on NFC_SET_CONFIG_REVT */
+        NFA_TRACE_ERROR0 ("nfa_dm_check_set_config () error: pending number of SET_CONFIG exceeded");
+        return NFA_STATUS_FAILED;
+    }
 
-            /* Get the next available bit offset for this setconfig (based on how many SetConfigs are outstanding) */
-            cur_bit = (UINT32) (1 << nfa_dm_cb.setcfg_pending_num);
+    while (tlv_list_len - xx >= 2) /* at least type and len */
+    {
+        type    = *(p_tlv_list + xx);
+        len     = *(p_tlv_list + xx + 1);
+        p_value = p_tlv_list + xx + 2;
 
-            /* If setconfig is due to NFA_SetConfig: then set the bit (NFA_DM_SET_CONFIG_EVT needed on NFC_SET_CONFIG_REVT) */
-            if (app_init)
-            {
-                nfa_dm_cb.setcfg_pending_mask |= cur_bit;
-            }
-            /* Otherwise setconfig is internal: clear the bit (NFA_DM_SET_CONFIG_EVT not needed on NFC_SET_CONFIG_REVT) */
-            else
+        if (nfa_dm_check_param_update (type, len, p_value))
+        {
+            if (  (!app_init)
+                &&(nfa_dm_batch_set_config (p_tlv_list + xx) != NFA_STATUS_OK)  )
             {
-                nfa_dm_cb.setcfg_pending_mask &= ~cur_bit;
+                status = NFA_STATUS_FAILED;
             }
-
-            /* Increment setcfg_pending counter */
-            nfa_dm_cb.setcfg_pending_num++;
+            updated_len += (len + 2);
         }
-        return (nfc_status);
+        xx += len + 2;  /* move to next TLV */
+    }
 
+    /* If the SetConfig was initiated by the application, then send the SET_CONFIG command */
+    if (app_init)
+    {
+        nfa_dm_flush_set_config ();
+        return nfa_dm_send_set_config (updated_len, p_tlv_list, TRUE);
     }
     else
     {
-        return NFA_STATUS_OK;
+        return status;
     }
 }
 
@@ -232,6 +232,58 @@ static UINT16 nfa_ee_total_lmrt_size(void)
     return lmrt_size;
 }
 
+#if (NFA_EE_ROUT_PLANNER_INCLUDED == TRUE)
+/*******************************************************************************
+**
+** Function         nfa_ee_total_lmrt_mask_size
+**
+** Description      the listen mode routing table size for technology and
+**                  protocol based routing
+**
+** Returns          UINT16
+**
+*******************************************************************************/
+static UINT16 nfa_ee_total_lmrt_mask_size(void)
+{
+    int xx;
+    UINT16 lmrt_size = 0;
+    tNFA_EE_ECB          *p_cb;
+
+    lmrt_size += nfa_ee_cb.ecb[NFA_EE_CB_4_DH].size_mask;
+    p_cb = &nfa_ee_cb.ecb[0];
+    for (xx = 0; xx < nfa_ee_cb.cur_ee; xx++, p_cb++)
+    {
+        if (p_cb->ee_status == NFC_NFCEE_STATUS_ACTIVE)
+        {
+            lmrt_size += p_cb->size_mask;
+        }
+    }
+    return lmrt_size;
+}
+#endif
+
+/*******************************************************************************
+**
+** Function         nfa_ee_lmrt_fits
+**
+** Description      Check if the listen mode routing table still fits in NFCC
+**                  after add_size bytes of AID routing are added.
+**                  If the routing planner is included, the AID entries that
+**                  do not fit are folded when the table is sent to NFCC, so
+**                  only the technology and protocol based routing must fit.
+**
+** Returns          TRUE, if the routing table fits
+**
+*******************************************************************************/
+static BOOLEAN nfa_ee_lmrt_fits(UINT16 add_size)
+{
+#if (NFA_EE_ROUT_PLANNER_INCLUDED == TRUE)
+    return (nfa_ee_total_lmrt_mask_size() <= NFC_GetLmrtSize());
+#else
+    return ((nfa_ee_total_lmrt_size() + add_size) <= NFC_GetLmrtSize());
+#endif
+}
+
 /*******************************************************************************
 **
 ** Function         nfa_ee_conn_cback
@@ -551,7 +603,7 @@ void nfa_ee_api_set_tech_cfg(tNFA_EE_MSG *p_data)
     p_cb->tech_switch_off  = p_data->set_tech.technologies_switch_off;
     p_cb->tech_battery_off = p_data->set_tech.technologies_battery_off;
     nfa_ee_update_route_size(p_cb);
-    if (nfa_ee_total_lmrt_size() > NFC_GetLmrtSize())
+    if (!nfa_ee_lmrt_fits(0))
     {
         NFA_TRACE_ERROR0 ("nfa_ee_api_set_tech_cfg Exceed LMRT size");
         evt_data.status        = NFA_STATUS_BUFFER_FULL;
@@ -607,7 +659,7 @@ void nfa_ee_api_set_proto_cfg(tNFA_EE_MSG *p_data)
     p_cb->proto_switch_off      = p_data->set_proto.protocols_switch_off;
     p_cb->proto_battery_off     = p_data->set_proto.protocols_battery_off;
     nfa_ee_update_route_size(p_cb);
-    if (nfa_ee_total_lmrt_size() > NFC_GetLmrtSize())
+    if (!nfa_ee_lmrt_fits(0))
     {
         NFA_TRACE_ERROR0 ("nfa_ee_api_set_proto_cfg Exceed LMRT size");
         evt_data.status         = NFA_STATUS_BUFFER_FULL;
@@ -660,7 +712,7 @@ void nfa_ee_api_add_aid(tNFA_EE_MSG *p_data)
         {
             p_cb->aid_rt_info[entry]    |= NFA_EE_AE_ROUTE;
             new_size = nfa_ee_total_lmrt_size();
-            if (new_size > NFC_GetLmrtSize())
+            if (!nfa_ee_lmrt_fits(0))
             {
                 NFA_TRACE_ERROR1 ("Exceed LMRT size:%d (add ROUTE)", new_size);
                 evt_data.status             = NFA_STATUS_BUFFER_FULL;
@@ -693,7 +745,7 @@ void nfa_ee_api_add_aid(tNFA_EE_MSG *p_data)
         else if (p_cb->aid_entries < NFA_EE_MAX_AID_ENTRIES)
         {
             new_size = nfa_ee_total_lmrt_size() + 4 + p_add->aid_len; /* 4 = 1 (tag) + 1 (len) + 1(nfcee_id) + 1(power cfg) */
-            if (new_size > NFC_GetLmrtSize())
+            if (!nfa_ee_lmrt_fits((UINT16)(4 + p_add->aid_len)))
             {
                 NFA_TRACE_ERROR1 ("Exceed LMRT size:%d", new_size);
                 evt_data.status        = NFA_STATUS_BUFFER_FULL;
@@ -703,6 +755,10 @@ void nfa_ee_api_add_aid(tNFA_EE_MSG *p_data)
                 /* add AID */
                 p_cb->aid_pwr_cfg[p_cb->aid_entries]    = p_add->power_state;
                 p_cb->aid_rt_info[p_cb->aid_entries]    = NFA_EE_AE_ROUTE;
+#if (NFA_EE_ROUT_PLANNER_INCLUDED == TRUE)
+                p_cb->aid_hits[p_cb->aid_entries]       = 0;
+                p_cb->aid_prefix_len[p_cb->aid_entries] = 0;
+#endif
                 p       = p_cb->aid_cfg + len;
                 p_start = p;
                 *p++    = NFA_EE_AID_CFG_TAG_NAME;
@@ -778,6 +834,10 @@ void nfa_ee_api_remove_aid(tNFA_EE_MSG *p_data)
             GKI_shiftup (&p_cb->aid_len[entry], &p_cb->aid_len[entry + 1], rest_len);
             GKI_shiftup (&p_cb->aid_pwr_cfg[entry], &p_cb->aid_pwr_cfg[entry + 1], rest_len);
             GKI_shiftup (&p_cb->aid_rt_info[entry], &p_cb->aid_rt_info[entry + 1], rest_len);
+#if (NFA_EE_ROUT_PLANNER_INCLUDED == TRUE)
+            GKI_shiftup ((UINT8 *)&p_cb->aid_hits[entry], (UINT8 *)&p_cb->aid_hits[entry + 1], rest_len * sizeof (UINT16));
+            GKI_shiftup (&p_cb->aid_prefix_len[entry], &p_cb->aid_prefix_len[entry + 1], rest_len);
+#endif
         }
         /* else the last entry, just reduce the aid_entries by 1 */
         p_cb->aid_entries--;
@@ -809,7 +869,8 @@ void nfa_ee_api_lmrt_size(tNFA_EE_MSG *p_data)
     tNFA_EE_CBACK_DATA  evt_data = {0};
     UINT16 total_size = NFC_GetLmrtSize();
 
-    evt_data.size       = total_size - nfa_ee_total_lmrt_size();
+    if (nfa_ee_total_lmrt_size() < total_size)
+        evt_data.size   = total_size - nfa_ee_total_lmrt_size();
     NFA_TRACE_DEBUG2 ("nfa_ee_api_lmrt_size total size:%d remaining size:%d", total_size, evt_data.size);
 
     nfa_ee_report_event (NULL, NFA_EE_REMAINING_SIZE_EVT, &evt_data);
@@ -1692,6 +1753,10 @@ void nfa_ee_nci_action_ntf(tNFA_EE_MSG *p_data)
     evt_data.ee_handle  = (tNFA_HANDLE)p_cbk->nfcee_id | NFA_HANDLE_GROUP_EE;
     evt_data.trigger    = p_cbk->act_data.trigger;
     memcpy (&(evt_data.param), &(p_cbk->act_data.param), sizeof (tNFA_EE_ACTION_PARAM));
+#if (NFA_EE_ROUT_PLANNER_INCLUDED == TRUE)
+    if (evt_data.trigger == NFC_EE_TRIG_SELECT)
+        nfa_ee_aid_hit (evt_data.param.aid.len_aid, evt_data.param.aid.aid);
+#endif
     nfa_ee_report_event(NULL, NFA_EE_ACTION_EVT, (tNFA_EE_CBACK_DATA *)&evt_data);
 }
 
@@ -1931,6 +1996,7 @@ tNFA_STATUS nfa_ee_route_add_one_ecb(tNFA_EE_ECB *p_cb, int *p_max_len, BOOLEAN
     UINT8   max_tlv;
     UINT8   *p_start;
     UINT8   new_size;
+    UINT8   tag;
     tNFA_STATUS status = NFA_STATUS_OK;
 
     nfa_ee_check_set_routing (p_cb->size_mask, p_max_len, ps, p_cur_offset);
@@ -2010,14 +2076,24 @@ tNFA_STATUS nfa_ee_route_add_one_ecb(tNFA_EE_ECB *p_cb, int *p_max_len, BOOLEAN
         for (xx = 0; xx < p_cb->aid_entries; xx++)
         {
             p_start     = pp; /* rememebr the beginning of this AID routing entry, just in case we need to put it in next command */
-            /* add one AID entry */
-            if (p_cb->aid_rt_info[xx] & NFA_EE_AE_ROUTE)
+            /* add one AID entry, unless the routing planner folded it */
+            if (  (p_cb->aid_rt_info[xx] & NFA_EE_AE_ROUTE)
+                &&(!(p_cb->aid_rt_info[xx] & NFA_EE_AE_FOLDED))  )
             {
                 num_tlv++;
                 pa      = &p_cb->aid_cfg[start_offset];
                 pa ++; /* EMV tag */
                 len     = *pa++; /* aid_len */
-                *pp++   = NFC_ROUTE_TAG_AID;
+                tag     = NFC_ROUTE_TAG_AID;
+#if (NFA_EE_ROUT_PLANNER_INCLUDED == TRUE)
+                if (p_cb->aid_rt_info[xx] & NFA_EE_AE_PREFIX)
+                {
+                    /* this entry covers all the AIDs starting with its first prefix_len bytes */
+                    len     = p_cb->aid_prefix_len[xx];
+                    tag    |= NFC_ROUTE_QUAL_AID_PREFIX;
+                }
+#endif
+                *pp++   = tag;
                 *pp++   = len + 2;
                 *pp++   = p_cb->nfcee_id;
                 *pp++   = p_cb->aid_pwr_cfg[xx];
@@ -2216,6 +2292,339 @@ void nfa_ee_discv_timeout(tNFA_EE_MSG *p_data)
         (*nfa_ee_cb.p_enable_cback)(NFA_EE_DISC_STS_OFF);
 }
 
+#if (NFA_EE_ROUT_PLANNER_INCLUDED == TRUE)
+/* An AID entry considered by the routing planner.
+ * The AID entries folded into one prefix entry form a unit, led by the entry
+ * that is registered first. Only the leader installs an entry in the LMRT. */
+typedef struct
+{
+    tNFA_EE_ECB *p_cb;          /* the control block of this AID entry          */
+    UINT8       *p_aid;         /* the AID in aid_cfg[]                         */
+    UINT8       aid_len;        /* the length of the AID                        */
+    UINT8       entry;          /* the index of this AID entry in p_cb          */
+    UINT8       prefix_len;     /* leader only: the prefix length, 0 if exact   */
+    BOOLEAN     installed;      /* leader only: TRUE, if installed in the LMRT  */
+    UINT16      leader;         /* the index of the leader of this unit         */
+    UINT16      size;           /* leader only: the LMRT size of this unit      */
+    UINT32      hits;           /* leader only: the SELECT hits of this unit    */
+} tNFA_EE_PLAN_AID;
+
+/*******************************************************************************
+**
+** Function         nfa_ee_aid_hit
+**
+** Description      Count a SELECT command for the given AID. The routing
+**                  planner gives the most used AIDs priority in the LMRT.
+**
+** Returns          void
+**
+*******************************************************************************/
+void nfa_ee_aid_hit (UINT8 aid_len, UINT8 *p_aid)
+{
+    tNFA_EE_ECB *p_cb;
+    int         entry = 0;
+
+    p_cb = nfa_ee_find_aid_offset (aid_len, p_aid, NULL, &entry);
+    if ((p_cb) && (p_cb->aid_hits[entry] < 0xFFFF))
+    {
+        p_cb->aid_hits[entry]++;
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_ee_plan_add_ecb
+**
+** Description      Add the routed AID entries of the given control block to
+**                  the routing planner in the order of the LMRT.
+**
+** Returns          the number of the entries in p_aids
+**
+*******************************************************************************/
+static UINT16 nfa_ee_plan_add_ecb (tNFA_EE_ECB *p_cb, tNFA_EE_PLAN_AID *p_aids, UINT16 num)
+{
+    int     xx, start_offset = 0;
+    tNFA_EE_PLAN_AID *p_aid;
+
+    for (xx = 0; xx < p_cb->aid_entries; xx++)
+    {
+        if (p_cb->aid_rt_info[xx] & NFA_EE_AE_ROUTE)
+        {
+            p_aid = &p_aids[num];
+            p_aid->p_cb         = p_cb;
+            p_aid->aid_len      = p_cb->aid_cfg[start_offset + 1];
+            p_aid->p_aid        = &p_cb->aid_cfg[start_offset + 2];
+            p_aid->entry        = (UINT8)xx;
+            p_aid->prefix_len   = 0;
+            p_aid->installed    = FALSE;
+            p_aid->leader       = num;
+            /* 4 = 1 (tag) + 1 (len) + 1(nfcee_id) + 1(power cfg) */
+            p_aid->size         = 4 + p_aid->aid_len;
+            p_aid->hits         = p_cb->aid_hits[xx];
+            num++;
+        }
+        start_offset += p_cb->aid_len[xx];
+    }
+    return num;
+}
+
+#if (NFA_EE_AID_PREFIX_ROUTING == TRUE)
+/*******************************************************************************
+**
+** Function         nfa_ee_plan_aid_cmp
+**
+** Description      Order the AID entries by control block, power configuration
+**                  and AID, so the entries sharing a prefix are adjacent.
+**
+** Returns          <0, 0 or >0 like memcmp
+**
+*******************************************************************************/
+static int nfa_ee_plan_aid_cmp (tNFA_EE_PLAN_AID *p_a, tNFA_EE_PLAN_AID *p_b)
+{
+    int     cmp;
+
+    if (p_a->p_cb != p_b->p_cb)
+        return ((p_a->p_cb < p_b->p_cb) ? -1 : 1);
+    if (p_a->p_cb->aid_pwr_cfg[p_a->entry] != p_b->p_cb->aid_pwr_cfg[p_b->entry])
+        return (p_a->p_cb->aid_pwr_cfg[p_a->entry] - p_b->p_cb->aid_pwr_cfg[p_b->entry]);
+    cmp = memcmp (p_a->p_aid, p_b->p_aid, (p_a->aid_len < p_b->aid_len) ? p_a->aid_len : p_b->aid_len);
+    if (cmp == 0)
+        cmp = p_a->aid_len - p_b->aid_len;
+    return cmp;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_ee_plan_fold_prefix
+**
+** Description      Fold the AID entries of the same NFCEE/DH and power
+**                  configuration that share at least NFA_EE_AID_MIN_PREFIX_LEN
+**                  bytes into one prefix entry. A prefix is not used if it
+**                  also matches an AID routed somewhere else.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_ee_plan_fold_prefix (tNFA_EE_PLAN_AID *p_aids, UINT16 num, UINT16 *p_order)
+{
+    UINT16  xx, yy, zz, first, last, leader;
+    UINT8   lcp;
+    BOOLEAN conflict;
+    tNFA_EE_PLAN_AID *p_first, *p_last;
+
+    /* insertion sort; there are at most a few hundred AID entries */
+    for (xx = 0; xx < num; xx++)
+    {
+        for (yy = xx; (yy > 0) && (nfa_ee_plan_aid_cmp (&p_aids[p_order[yy - 1]], &p_aids[xx]) > 0); yy--)
+            p_order[yy] = p_order[yy - 1];
+        p_order[yy] = xx;
+    }
+
+    for (first = 0; first < num; first = last + 1)
+    {
+        /* find the run of entries sharing the minimum prefix */
+        p_first = &p_aids[p_order[first]];
+        for (last = first; last + 1 < num; last++)
+        {
+            p_last = &p_aids[p_order[last + 1]];
+            if (  (p_last->p_cb != p_first->p_cb)
+                ||(p_last->p_cb->aid_pwr_cfg[p_last->entry] != p_first->p_cb->aid_pwr_cfg[p_first->entry])
+                ||(p_first->aid_len < NFA_EE_AID_MIN_PREFIX_LEN)
+                ||(p_last->aid_len < NFA_EE_AID_MIN_PREFIX_LEN)
+                ||(memcmp (p_first->p_aid, p_last->p_aid, NFA_EE_AID_MIN_PREFIX_LEN) != 0)  )
+                break;
+        }
+        if (last == first)
+            continue;
+
+        /* the entries are sorted: the common prefix of the run is the one of its ends */
+        p_last = &p_aids[p_order[last]];
+        for (lcp = NFA_EE_AID_MIN_PREFIX_LEN; (lcp < p_first->aid_len) && (lcp < p_last->aid_len); lcp++)
+        {
+            if (p_first->p_aid[lcp] != p_last->p_aid[lcp])
+                break;
+        }
+
+        /* the prefix must not capture an AID that is routed differently */
+        conflict = FALSE;
+        for (zz = 0; (zz < num) && (!conflict); zz++)
+        {
+            if (  (p_aids[zz].aid_len >= lcp)
+                &&(memcmp (p_aids[zz].p_aid, p_first->p_aid, lcp) == 0)
+                &&(  (p_aids[zz].p_cb != p_first->p_cb)
+                   ||(p_aids[zz].p_cb->aid_pwr_cfg[p_aids[zz].entry] != p_first->p_cb->aid_pwr_cfg[p_first->entry]))  )
+            {
+                conflict = TRUE;
+            }
+        }
+        if (conflict)
+        {
+            NFA_TRACE_DEBUG1 ("nfa_ee_plan_fold_prefix: prefix conflict, %d entries not folded", last - first + 1);
+            continue;
+        }
+
+        /* the entry registered first leads the unit */
+        leader = p_order[first];
+        for (xx = first; xx <= last; xx++)
+        {
+            if (p_order[xx] < leader)
+                leader = p_order[xx];
+        }
+        p_aids[leader].prefix_len   = lcp;
+        p_aids[leader].size         = 4 + lcp;
+        p_aids[leader].hits         = 0;
+        for (xx = first; xx <= last; xx++)
+        {
+            p_aids[p_order[xx]].leader  = leader;
+            p_aids[leader].hits        += p_aids[p_order[xx]].p_cb->aid_hits[p_aids[p_order[xx]].entry];
+        }
+        nfa_ee_trace_aid ("nfa_ee_plan_fold_prefix", p_first->p_cb->nfcee_id, lcp, p_first->p_aid);
+    }
+}
+#endif
+
+/*******************************************************************************
+**
+** Function         nfa_ee_plan_lmrt
+**
+** Description      Plan the AID routing when the registered entries do not fit
+**                  in the listen mode routing table of NFCC.
+**                  The technology and protocol based routing is always kept.
+**                  The AIDs sharing a prefix are folded into prefix entries
+**                  (if NFCC supports it), then the most used AID entries are
+**                  installed while they fit. The rest is left to the default
+**                  route. The folded AIDs are reported in NFA_EE_ROUT_PLAN_EVT.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_ee_plan_lmrt (void)
+{
+    int                 xx;
+    UINT16              num = 0, yy, zz, leader;
+    UINT16              lmrt_size = NFC_GetLmrtSize();
+    UINT16              needed_size, budget, mask_size;
+    tNFA_EE_ECB         *p_cb;
+    tNFA_EE_PLAN_AID    *p_aids, *p_aid;
+    UINT16              *p_order;
+    tNFA_EE_FOLDED_AID  *p_folded;
+    tNFA_EE_CBACK_DATA  evt_data;
+
+    /* forget the previous plan */
+    p_cb = &nfa_ee_cb.ecb[0];
+    for (xx = 0; xx < NFA_EE_NUM_ECBS; xx++, p_cb++)
+    {
+        for (yy = 0; yy < p_cb->aid_entries; yy++)
+        {
+            p_cb->aid_rt_info[yy]      &= ~NFA_EE_AE_PLAN;
+            p_cb->aid_prefix_len[yy]    = 0;
+        }
+    }
+
+    needed_size = nfa_ee_total_lmrt_size();
+    if (needed_size <= lmrt_size)
+        return;
+
+    /* 5 = the NFC-DEP routing to DH added by nfa_ee_route_add_one_ecb */
+    mask_size = nfa_ee_total_lmrt_mask_size() + 5;
+    budget    = (mask_size < lmrt_size) ? (lmrt_size - mask_size) : 0;
+
+    p_aids = (tNFA_EE_PLAN_AID *) GKI_getbuf ((UINT16)(NFA_EE_NUM_ECBS * NFA_EE_MAX_AID_ENTRIES *
+                    (sizeof (tNFA_EE_PLAN_AID) + sizeof (tNFA_EE_FOLDED_AID) + sizeof (UINT16))));
+    if (p_aids == NULL)
+    {
+        NFA_TRACE_ERROR0 ("nfa_ee_plan_lmrt() no buffer to plan routing.");
+        return;
+    }
+    p_folded = (tNFA_EE_FOLDED_AID *)(p_aids + NFA_EE_NUM_ECBS * NFA_EE_MAX_AID_ENTRIES);
+    p_order  = (UINT16 *)(p_folded + NFA_EE_NUM_ECBS * NFA_EE_MAX_AID_ENTRIES);
+
+    /* DH first, then the active NFCEEs; the same order as nfa_ee_lmrt_to_nfcc */
+    num = nfa_ee_plan_add_ecb (&nfa_ee_cb.ecb[NFA_EE_CB_4_DH], p_aids, num);
+    p_cb = &nfa_ee_cb.ecb[0];
+    for (xx = 0; xx < nfa_ee_cb.cur_ee; xx++, p_cb++)
+    {
+        if (p_cb->ee_status == NFC_NFCEE_STATUS_ACTIVE)
+            num = nfa_ee_plan_add_ecb (p_cb, p_aids, num);
+    }
+
+#if (NFA_EE_AID_PREFIX_ROUTING == TRUE)
+    nfa_ee_plan_fold_prefix (p_aids, num, p_order);
+#endif
+
+    /* order the units by hits (most used first), then by size and registration order */
+    zz = 0;
+    for (yy = 0; yy < num; yy++)
+    {
+        if (p_aids[yy].leader != yy)
+            continue;
+        for (xx = zz; xx > 0; xx--)
+        {
+            p_aid = &p_aids[p_order[xx - 1]];
+            if (  (p_aid->hits > p_aids[yy].hits)
+                ||((p_aid->hits == p_aids[yy].hits) && (p_aid->size <= p_aids[yy].size))  )
+                break;
+            p_order[xx] = p_order[xx - 1];
+        }
+        p_order[xx] = yy;
+        zz++;
+    }
+
+    /* install the units while they fit */
+    evt_data.rout_plan.used_size = mask_size;
+    for (yy = 0; yy < zz; yy++)
+    {
+        p_aid = &p_aids[p_order[yy]];
+        if (p_aid->size <= budget)
+        {
+            p_aid->installed                = TRUE;
+            budget                         -= p_aid->size;
+            evt_data.rout_plan.used_size   += p_aid->size;
+        }
+    }
+
+    /* mark the AID entries and report the ones not installed as registered */
+    evt_data.rout_plan.lmrt_size    = lmrt_size;
+    evt_data.rout_plan.needed_size  = needed_size;
+    evt_data.rout_plan.num_folded   = 0;
+    evt_data.rout_plan.p_folded     = p_folded;
+    for (yy = 0; yy < num; yy++)
+    {
+        p_aid   = &p_aids[yy];
+        leader  = p_aid->leader;
+        p_cb    = p_aid->p_cb;
+        if ((leader == yy) && (p_aid->installed))
+        {
+            if (p_aid->prefix_len)
+            {
+                p_cb->aid_rt_info[p_aid->entry]     |= NFA_EE_AE_PREFIX;
+                p_cb->aid_prefix_len[p_aid->entry]   = p_aid->prefix_len;
+            }
+            continue;
+        }
+
+        p_cb->aid_rt_info[p_aid->entry]         |= NFA_EE_AE_FOLDED;
+        if (p_aids[leader].installed)
+            p_cb->aid_prefix_len[p_aid->entry]   = p_aids[leader].prefix_len;
+
+        if (evt_data.rout_plan.num_folded < 0xFF)
+        {
+            p_folded->ee_handle     = (tNFA_HANDLE)p_cb->nfcee_id | NFA_HANDLE_GROUP_EE;
+            p_folded->prefix_len    = p_cb->aid_prefix_len[p_aid->entry];
+            p_folded->aid_len       = p_aid->aid_len;
+            memcpy (p_folded->aid, p_aid->p_aid, p_aid->aid_len);
+            p_folded++;
+            evt_data.rout_plan.num_folded++;
+        }
+    }
+
+    NFA_TRACE_DEBUG4 ("nfa_ee_plan_lmrt lmrt_size:%d needed_size:%d used_size:%d num_folded:%d",
+        lmrt_size, needed_size, evt_data.rout_plan.used_size, evt_data.rout_plan.num_folded);
+    nfa_ee_report_event (NULL, NFA_EE_ROUT_PLAN_EVT, &evt_data);
+    GKI_freebuf (p_aids);
+}
+#endif
+
 /*******************************************************************************
 **
 ** Function         nfa_ee_lmrt_to_nfcc
@@ -2265,6 +2674,11 @@ void nfa_ee_lmrt_to_nfcc(tNFA_EE_MSG *p_data)
         more = FALSE;
     }
 
+#if (NFA_EE_ROUT_PLANNER_INCLUDED == TRUE)
+    /* fold the AID entries that do not fit in the routing table */
+    nfa_ee_plan_lmrt ();
+#endif
+
     /* add the routing for DH first */
     status  = NFA_STATUS_OK;
     max_len = NFC_GetLmrtSize();
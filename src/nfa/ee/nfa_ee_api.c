@@ -396,6 +396,11 @@ tNFA_STATUS NFA_EeSetDefaultProtoRouting(tNFA_HANDLE         ee_handle,
 ** Note:            NFA_EeUpdateNow() should be called after last NFA-EE function
 **                  to change the listen mode routing is called.
 **
+** Note:            If NFA_EE_ROUT_PLANNER_INCLUDED is TRUE, the AID entries
+**                  that do not fit in the listen mode routing table are
+**                  folded when the table is sent to NFCC and reported in
+**                  NFA_EE_ROUT_PLAN_EVT.
+**
 ** Returns          NFA_STATUS_OK if successfully initiated
 **                  NFA_STATUS_FAILED otherwise
 **                  NFA_STATUS_INVALID_PARAM If bad parameter
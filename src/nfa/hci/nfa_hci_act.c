@@ -1029,8 +1029,18 @@ static BOOLEAN nfa_hci_api_send_event (tNFA_HCI_EVENT_DATA *p_evt_data)
 
             if (p_pipe->pipe_state == NFA_HCI_PIPE_OPENED)
             {
-                status = nfa_hciu_send_msg (p_pipe->pipe_id, NFA_HCI_EVENT_TYPE, p_evt_data->send_evt.evt_code,
-                                            p_evt_data->send_evt.evt_len, p_evt_data->send_evt.p_evt_buf);
+                if (p_evt_data->send_evt.p_evt_msg != NULL)
+                {
+                    /* the buffer is consumed even on failure */
+                    status = nfa_hciu_send_msg_buf (p_pipe->pipe_id, NFA_HCI_EVENT_TYPE, p_evt_data->send_evt.evt_code,
+                                                    p_evt_data->send_evt.p_evt_msg);
+                    p_evt_data->send_evt.p_evt_msg = NULL;
+                }
+                else
+                {
+                    status = nfa_hciu_send_msg (p_pipe->pipe_id, NFA_HCI_EVENT_TYPE, p_evt_data->send_evt.evt_code,
+                                                p_evt_data->send_evt.evt_len, p_evt_data->send_evt.p_evt_buf);
+                }
 
                 if (status == NFA_STATUS_OK)
                 {
@@ -1084,6 +1094,13 @@ static BOOLEAN nfa_hci_api_send_event (tNFA_HCI_EVENT_DATA *p_evt_data)
         NFA_TRACE_WARNING1 ("nfa_hci_api_send_event pipe:%d not found", p_evt_data->send_evt.pipe);
     }
 
+    /* Event data not sent */
+    if (p_evt_data->send_evt.p_evt_msg != NULL)
+    {
+        GKI_freebuf (p_evt_data->send_evt.p_evt_msg);
+        p_evt_data->send_evt.p_evt_msg = NULL;
+    }
+
     evt_data.evt_sent.status = status;
 
     /* Send NFC_HCI_EVENT_SENT_EVT to notify status */
@@ -766,6 +766,7 @@ tNFA_STATUS NFA_HciSendEvent (tNFA_HANDLE  hci_handle,
         p_msg->evt_code     = evt_code;
         p_msg->evt_len      = evt_size;
         p_msg->p_evt_buf    = p_data;
+        p_msg->p_evt_msg    = NULL;
         p_msg->rsp_len      = rsp_size;
         p_msg->p_rsp_buf    = p_rsp_buf;
         p_msg->rsp_timeout  = rsp_timeout;
@@ -777,6 +778,73 @@ tNFA_STATUS NFA_HciSendEvent (tNFA_HANDLE  hci_handle,
     return (NFA_STATUS_FAILED);
 }
 
+/*******************************************************************************
+**
+** Function         NFA_HciSendEventBuf
+**
+** Description      This function is called to send any event on a pipe created
+**                  by the application, same as NFA_HciSendEvent but the event
+**                  data is given in a GKI buffer starting at p_evt_msg->offset,
+**                  which must be at least NFA_HCI_MIN_OFFSET.
+**                  The HCP headers are written in front of the data, so an
+**                  event fitting in one HCP packet is sent without copy.
+**                  The buffer is owned by NFA after this call, even if an
+**                  error occurs.
+**
+** Returns          NFA_STATUS_OK if successfully initiated
+**                  NFA_STATUS_FAILED otherwise
+**
+*******************************************************************************/
+tNFA_STATUS NFA_HciSendEventBuf (tNFA_HANDLE  hci_handle,
+                                 UINT8        pipe,
+                                 UINT8        evt_code,
+                                 BT_HDR       *p_evt_msg,
+                                 UINT16       rsp_size,
+                                 UINT8        *p_rsp_buf,
+                                 UINT16       rsp_timeout)
+{
+    tNFA_HCI_API_SEND_EVENT_EVT *p_msg;
+
+    NFA_TRACE_API3 ("NFA_HciSendEventBuf(): hci_handle:0x%04x, pipe:0x%02x  Code: 0x%02x", hci_handle, pipe, evt_code);
+
+    if (p_evt_msg == NULL)
+    {
+        NFA_TRACE_API0 ("NFA_HciSendEventBuf (): No event buffer");
+        return (NFA_STATUS_FAILED);
+    }
+
+    if (  ((NFA_HANDLE_GROUP_MASK & hci_handle) != NFA_HANDLE_GROUP_HCI)
+        ||(pipe < NFA_HCI_FIRST_DYNAMIC_PIPE)
+        ||(rsp_size && (p_rsp_buf == NULL))  )
+    {
+        NFA_TRACE_API3 ("NFA_HciSendEventBuf (): Invalid hci_handle:0x%04x pipe:0x%02x or rsp_size:%u", hci_handle, pipe, rsp_size);
+        GKI_freebuf (p_evt_msg);
+        return (NFA_STATUS_FAILED);
+    }
+
+    /* Request HCI to post event data on a particular pipe */
+    if (  (nfa_hci_cb.hci_state != NFA_HCI_STATE_DISABLED)
+        &&((p_msg = (tNFA_HCI_API_SEND_EVENT_EVT *) GKI_getbuf (sizeof (tNFA_HCI_API_SEND_EVENT_EVT))) != NULL) )
+    {
+        p_msg->hdr.event    = NFA_HCI_API_SEND_EVENT_EVT;
+        p_msg->hci_handle   = hci_handle;
+        p_msg->pipe         = pipe;
+        p_msg->evt_code     = evt_code;
+        p_msg->evt_len      = p_evt_msg->len;
+        p_msg->p_evt_buf    = NULL;
+        p_msg->p_evt_msg    = p_evt_msg;
+        p_msg->rsp_len      = rsp_size;
+        p_msg->p_rsp_buf    = p_rsp_buf;
+        p_msg->rsp_timeout  = rsp_timeout;
+
+        nfa_sys_sendmsg (p_msg);
+        return (NFA_STATUS_OK);
+    }
+
+    GKI_freebuf (p_evt_msg);
+    return (NFA_STATUS_FAILED);
+}
+
 /*******************************************************************************
 **
 ** Function         NFA_HciClosePipe
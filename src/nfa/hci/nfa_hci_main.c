@@ -65,6 +65,7 @@ static void nfa_hci_conn_cback (UINT8 conn_id, tNFC_CONN_EVT event, tNFC_CONN *p
 static void nfa_hci_set_receive_buf (UINT8 pipe);
 static void nfa_hci_assemble_msg (UINT8 *p_data, UINT16 data_len);
 static void nfa_hci_handle_nv_read (UINT8 block, tNFA_STATUS status);
+static void nfa_hci_flush_api_q (BUFFER_Q *p_q);
 
 /*****************************************************************************
 **  Constants
@@ -406,6 +407,7 @@ void nfa_hci_restore_default_config (UINT8 *p_session_id)
 {
     memset (&nfa_hci_cb.cfg, 0, sizeof (nfa_hci_cb.cfg));
     memcpy (nfa_hci_cb.cfg.admin_gate.session_id, p_session_id, NFA_HCI_SESSION_ID_LEN);
+    nfa_hciu_build_maps ();
     nfa_hci_cb.nv_write_needed = TRUE;
 }
 
@@ -643,10 +645,38 @@ static void nfa_hci_sys_disable (void)
     }
 
     nfa_hci_cb.hci_state = NFA_HCI_STATE_DISABLED;
+    nfa_hci_flush_api_q (&nfa_hci_cb.hci_api_q);
+    nfa_hci_flush_api_q (&nfa_hci_cb.hci_host_reset_api_q);
     /* deregister message handler on NFA SYS */
     nfa_sys_deregister (NFA_ID_HCI);
 }
 
+/*******************************************************************************
+**
+** Function         nfa_hci_flush_api_q
+**
+** Description      Free the API requests left in a queue when NFA HCI is
+**                  disabled, with the event data buffer NFA_HciSendEventBuf
+**                  gave to NFA
+**
+** Returns          None
+**
+*******************************************************************************/
+static void nfa_hci_flush_api_q (BUFFER_Q *p_q)
+{
+    tNFA_HCI_EVENT_DATA *p_evt_data;
+
+    while ((p_evt_data = (tNFA_HCI_EVENT_DATA *) GKI_dequeue (p_q)) != NULL)
+    {
+        if (  (p_evt_data->hdr.event == NFA_HCI_API_SEND_EVENT_EVT)
+            &&(p_evt_data->send_evt.p_evt_msg != NULL)  )
+        {
+            GKI_freebuf (p_evt_data->send_evt.p_evt_msg);
+        }
+        GKI_freebuf (p_evt_data);
+    }
+}
+
 /*******************************************************************************
 **
 ** Function         nfa_hci_conn_cback
@@ -693,6 +723,8 @@ static void nfa_hci_conn_cback (UINT8 conn_id, tNFC_CONN_EVT event, tNFC_CONN *p
     {
         nfa_hci_cb.conn_id   = 0;
         nfa_hci_cb.hci_state = NFA_HCI_STATE_DISABLED;
+        nfa_hci_flush_api_q (&nfa_hci_cb.hci_api_q);
+        nfa_hci_flush_api_q (&nfa_hci_cb.hci_host_reset_api_q);
         /* deregister message handler on NFA SYS */
         nfa_sys_deregister (NFA_ID_HCI);
     }
@@ -742,8 +774,14 @@ static void nfa_hci_conn_cback (UINT8 conn_id, tNFC_CONN_EVT event, tNFC_CONN *p
             if ((pipe >= NFA_HCI_FIRST_DYNAMIC_PIPE) && (nfa_hci_cb.type == NFA_HCI_EVENT_TYPE))
             {
                 nfa_hci_set_receive_buf (pipe);
-                nfa_hci_assemble_msg (p, pkt_len);
-                p = nfa_hci_cb.p_msg_data;
+
+                /* Copy only into the response buffer of the application, */
+                /* otherwise the event is handled in the received buffer  */
+                if (nfa_hci_cb.p_msg_data != nfa_hci_cb.msg_data)
+                {
+                    nfa_hci_assemble_msg (p, pkt_len);
+                    p = nfa_hci_cb.p_msg_data;
+                }
             }
         }
     }
@@ -870,6 +908,11 @@ void nfa_hci_handle_nv_read (UINT8 block, tNFA_STATUS status)
             memcpy (session_id, (UINT8 *)&os_tick, (NFA_HCI_SESSION_ID_LEN / 2));
             nfa_hci_restore_default_config (session_id);
         }
+        else
+        {
+            /* Index the gates and pipes restored from NV */
+            nfa_hciu_build_maps ();
+        }
         nfa_hci_startup ();
     }
 }
@@ -37,6 +37,46 @@
 static void handle_debug_loopback (BT_HDR *p_buf, UINT8 pipe, UINT8 type, UINT8 instruction);
 BOOLEAN HCI_LOOPBACK_DEBUG = FALSE;
 
+/*******************************************************************************
+**
+** Function         nfa_hciu_build_maps
+**
+** Description      Rebuild the pipe id and gate id lookup maps from the
+**                  control blocks, after they were restored from NV or reset.
+**                  Pipes on an allocated gate are also added to the pipe list
+**                  of the gate.
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfa_hciu_build_maps (void)
+{
+    tNFA_HCI_DYN_GATE   *pg;
+    tNFA_HCI_DYN_PIPE   *pp;
+    int                 xx;
+
+    memset (nfa_hci_cb.pipe_map, 0, sizeof (nfa_hci_cb.pipe_map));
+    memset (nfa_hci_cb.gate_map, 0, sizeof (nfa_hci_cb.gate_map));
+
+    for (xx = 0, pg = nfa_hci_cb.cfg.dyn_gates; xx < NFA_HCI_MAX_GATE_CB; xx++, pg++)
+    {
+        if (pg->gate_id != 0)
+            nfa_hci_cb.gate_map[pg->gate_id] = (UINT8) (xx + 1);
+    }
+
+    for (xx = 0, pp = nfa_hci_cb.cfg.dyn_pipes; xx < NFA_HCI_MAX_PIPE_CB; xx++, pp++)
+    {
+        if ((pp->pipe_id != 0) && (pp->pipe_id <= NFA_HCI_MAX_PIPE_ID))
+        {
+            nfa_hci_cb.pipe_map[pp->pipe_id] = (UINT8) (xx + 1);
+
+            if (  (pp->local_gate != NFA_HCI_IDENTITY_MANAGEMENT_GATE)
+                &&((pg = nfa_hciu_find_gate_by_gid (pp->local_gate)) != NULL)  )
+                pg->pipe_inx_mask |= (UINT32) (1 << xx);
+        }
+    }
+}
+
 /*******************************************************************************
 **
 ** Function         nfa_hciu_find_pipe_by_pid
@@ -48,18 +88,15 @@ BOOLEAN HCI_LOOPBACK_DEBUG = FALSE;
 *******************************************************************************/
 tNFA_HCI_DYN_PIPE *nfa_hciu_find_pipe_by_pid (UINT8 pipe_id)
 {
-    tNFA_HCI_DYN_PIPE   *pp = nfa_hci_cb.cfg.dyn_pipes;
-    int                 xx  = 0;
+    UINT8   inx;
 
-    /* Loop through looking for a match */
-    for ( ; xx < NFA_HCI_MAX_PIPE_CB; xx++, pp++)
-    {
-        if (pp->pipe_id == pipe_id)
-            return (pp);
-    }
+    if ((pipe_id == 0) || (pipe_id > NFA_HCI_MAX_PIPE_ID))
+        return (NULL);
 
-    /* If here, not found */
-    return (NULL);
+    if ((inx = nfa_hci_cb.pipe_map[pipe_id]) == 0)
+        return (NULL);
+
+    return (&nfa_hci_cb.cfg.dyn_pipes[inx - 1]);
 }
 
 /*******************************************************************************
@@ -73,16 +110,12 @@ tNFA_HCI_DYN_PIPE *nfa_hciu_find_pipe_by_pid (UINT8 pipe_id)
 *******************************************************************************/
 tNFA_HCI_DYN_GATE *nfa_hciu_find_gate_by_gid (UINT8 gate_id)
 {
-    tNFA_HCI_DYN_GATE *pg = nfa_hci_cb.cfg.dyn_gates;
-    int               xx  = 0;
+    UINT8   inx;
 
-    for ( ; xx < NFA_HCI_MAX_GATE_CB; xx++, pg++)
-    {
-        if (pg->gate_id == gate_id)
-            return (pg);
-    }
+    if ((gate_id == 0) || ((inx = nfa_hci_cb.gate_map[gate_id]) == 0))
+        return (NULL);
 
-    return (NULL);
+    return (&nfa_hci_cb.cfg.dyn_gates[inx - 1]);
 }
 
 /*******************************************************************************
@@ -144,17 +177,12 @@ tNFA_HCI_DYN_GATE *nfa_hciu_find_gate_with_nopipes_by_owner (tNFA_HANDLE app_han
 *******************************************************************************/
 UINT8 nfa_hciu_count_pipes_on_gate (tNFA_HCI_DYN_GATE *p_gate)
 {
-    int               xx    = 0;
-    UINT32            mask  = 1;
+    UINT32            mask  = p_gate->pipe_inx_mask;
     UINT8             count = 0;
 
-    for ( ; xx < NFA_HCI_MAX_PIPE_CB; xx++)
-    {
-        if ( p_gate->pipe_inx_mask & mask )
-            count++;
-
-        mask = mask << 1;
-    }
+    /* Clear the lowest bit set until no pipe is left */
+    for ( ; mask != 0; mask &= mask - 1)
+        count++;
 
     return (count);
 }
@@ -171,17 +199,14 @@ UINT8 nfa_hciu_count_pipes_on_gate (tNFA_HCI_DYN_GATE *p_gate)
 UINT8 nfa_hciu_count_open_pipes_on_gate (tNFA_HCI_DYN_GATE *p_gate)
 {
     tNFA_HCI_DYN_PIPE *pp   = nfa_hci_cb.cfg.dyn_pipes;
-    int               xx    = 0;
-    UINT32            mask  = 1;
+    UINT32            mask  = p_gate->pipe_inx_mask;
     UINT8             count = 0;
 
-    for ( ; xx < NFA_HCI_MAX_PIPE_CB; xx++, pp++)
+    for ( ; mask != 0; mask >>= 1, pp++)
     {
         /* For each pipe on this gate, check if it is open */
-        if ((p_gate->pipe_inx_mask & mask) && (pp->pipe_state == NFA_HCI_PIPE_OPENED))
+        if ((mask & 1) && (pp->pipe_state == NFA_HCI_PIPE_OPENED))
             count++;
-
-        mask = mask << 1;
     }
 
     return (count);
@@ -290,6 +315,7 @@ tNFA_HCI_DYN_GATE *nfa_hciu_alloc_gate (UINT8 gate_id, tNFA_HANDLE app_handle)
             pg->gate_id       = gate_id;
             pg->gate_owner    = app_handle;
             pg->pipe_inx_mask = 0;
+            nfa_hci_cb.gate_map[gate_id] = (UINT8) (xx + 1);
 
             NFA_TRACE_DEBUG2 ("nfa_hciu_alloc_gate id:%d  app_handle: 0x%04x", gate_id, app_handle);
 
@@ -303,6 +329,55 @@ tNFA_HCI_DYN_GATE *nfa_hciu_alloc_gate (UINT8 gate_id, tNFA_HANDLE app_handle)
     return (NULL);
 }
 
+/*******************************************************************************
+**
+** Function         nfa_hciu_send_segment
+**
+** Description      This function sends one HCP packet, the HCP header is
+**                  already in the buffer
+**
+** Returns          status
+**
+*******************************************************************************/
+static tNFA_STATUS nfa_hciu_send_segment (BT_HDR *p_buf, UINT8 pipe_id, UINT8 type, UINT8 instruction, UINT16 data_len)
+{
+#if (BT_TRACE_PROTOCOL == TRUE)
+    DispHcp (((UINT8 *) (p_buf + 1) + p_buf->offset), p_buf->len, FALSE, (BOOLEAN) ((p_buf->len - data_len) == 2));
+#endif
+
+    if (HCI_LOOPBACK_DEBUG)
+    {
+        handle_debug_loopback (p_buf, pipe_id, type, instruction);
+        return NFA_STATUS_OK;
+    }
+
+    return NFC_SendData (nfa_hci_cb.conn_id, p_buf);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_hciu_msg_sent
+**
+** Description      This function starts waiting for the response to the
+**                  command just sent
+**
+** Returns          None
+**
+*******************************************************************************/
+static void nfa_hciu_msg_sent (UINT8 type, UINT8 instruction)
+{
+    /* Start timer if response to wait for a particular time for the response  */
+    if (type == NFA_HCI_COMMAND_TYPE)
+    {
+        nfa_hci_cb.cmd_sent = instruction;
+
+        if (nfa_hci_cb.hci_state == NFA_HCI_STATE_IDLE)
+            nfa_hci_cb.hci_state = NFA_HCI_STATE_WAIT_RSP;
+
+        nfa_sys_start_timer (&nfa_hci_cb.timer, NFA_HCI_RSP_TIMEOUT_EVT, p_nfa_hci_cfg->hcp_response_timeout);
+    }
+}
+
 /*******************************************************************************
 **
 ** Function         nfa_hciu_send_msg
@@ -377,14 +452,7 @@ tNFA_STATUS nfa_hciu_send_msg (UINT8 pipe_id, UINT8 type, UINT8 instruction, UIN
                     p_msg      += data_len;
             }
 
-#if (BT_TRACE_PROTOCOL == TRUE)
-            DispHcp (((UINT8 *) (p_buf + 1) + p_buf->offset), p_buf->len, FALSE, (BOOLEAN) ((p_buf->len - data_len) == 2));
-#endif
-
-            if (HCI_LOOPBACK_DEBUG)
-                handle_debug_loopback (p_buf, pipe_id, type, instruction);
-            else
-                status = NFC_SendData (nfa_hci_cb.conn_id, p_buf);
+            status = nfa_hciu_send_segment (p_buf, pipe_id, type, instruction, data_len);
         }
         else
         {
@@ -394,17 +462,94 @@ tNFA_STATUS nfa_hciu_send_msg (UINT8 pipe_id, UINT8 type, UINT8 instruction, UIN
         }
     }
 
-    /* Start timer if response to wait for a particular time for the response  */
-    if (type == NFA_HCI_COMMAND_TYPE)
+    nfa_hciu_msg_sent (type, instruction);
+
+    return status;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_hciu_send_msg_buf
+**
+** Description      This function will fragment the packet in the given GKI
+**                  buffer, if necessary and send it on the given pipe.
+**
+**                  p_msg->offset must be at least NFA_HCI_MIN_OFFSET. The
+**                  last (or only) segment is sent in p_msg itself with its
+**                  HCP header written in front of the data, so that a message
+**                  fitting in one HCP packet is never copied. Leading
+**                  segments are copied, as NCI needs one buffer per packet.
+**                  p_msg is always consumed.
+**
+** Returns          status
+**
+*******************************************************************************/
+tNFA_STATUS nfa_hciu_send_msg_buf (UINT8 pipe_id, UINT8 type, UINT8 instruction, BT_HDR *p_msg)
+{
+    BT_HDR          *p_buf;
+    UINT8           *p_data;
+    UINT16          hdr_len = 2;
+    UINT16          data_len;
+    tNFA_STATUS     status = NFA_STATUS_OK;
+    UINT16          max_seg_hcp_pkt_size = nfa_hci_cb.buff_size;
+
+    NFA_TRACE_DEBUG4 ("nfa_hciu_send_msg_buf pipe_id:%d   Type: %u  Inst: %u  len: %d",
+                      pipe_id, type, instruction, p_msg->len);
+
+    if (p_msg->offset < NFA_HCI_MIN_OFFSET)
     {
-        nfa_hci_cb.cmd_sent = instruction;
+        /* No room for the headers, fall back to copying */
+        NFA_TRACE_WARNING1 ("nfa_hciu_send_msg_buf offset:%d too small", p_msg->offset);
+        status = nfa_hciu_send_msg (pipe_id, type, instruction, p_msg->len, (UINT8 *) (p_msg + 1) + p_msg->offset);
+        GKI_freebuf (p_msg);
+        return status;
+    }
 
-        if (nfa_hci_cb.hci_state == NFA_HCI_STATE_IDLE)
-            nfa_hci_cb.hci_state = NFA_HCI_STATE_WAIT_RSP;
+    if (instruction == NFA_HCI_ANY_GET_PARAMETER)
+        nfa_hci_cb.param_in_use = *((UINT8 *) (p_msg + 1) + p_msg->offset);
 
-        nfa_sys_start_timer (&nfa_hci_cb.timer, NFA_HCI_RSP_TIMEOUT_EVT, p_nfa_hci_cfg->hcp_response_timeout);
+    while (p_msg->len > max_seg_hcp_pkt_size - hdr_len)
+    {
+        if ((p_buf = (BT_HDR *) GKI_getpoolbuf (NFC_RW_POOL_ID)) == NULL)
+        {
+            NFA_TRACE_ERROR0 ("nfa_hciu_send_msg_buf no buffers");
+            GKI_freebuf (p_msg);
+            return NFA_STATUS_NO_BUFFERS;
+        }
+
+        data_len      = max_seg_hcp_pkt_size - hdr_len;
+        p_buf->offset = NCI_MSG_OFFSET_SIZE + NCI_DATA_HDR_SIZE;
+        p_buf->len    = hdr_len + data_len;
+        p_data        = (UINT8 *) (p_buf + 1) + p_buf->offset;
+
+        *p_data++ = (NFA_HCI_MESSAGE_FRAGMENTATION << 7) | (pipe_id & 0x7F);
+
+        /* Message header only goes in the first segment */
+        if (hdr_len == 2)
+            *p_data++ = (type << 6) | instruction;
+
+        memcpy (p_data, (UINT8 *) (p_msg + 1) + p_msg->offset, data_len);
+        p_msg->offset += data_len;
+        p_msg->len    -= data_len;
+
+        status = nfa_hciu_send_segment (p_buf, pipe_id, type, instruction, data_len);
+        hdr_len = 1;
     }
 
+    /* The HCP header of the last segment overwrites data already copied or the headroom */
+    data_len       = p_msg->len;
+    p_msg->offset -= hdr_len;
+    p_msg->len    += hdr_len;
+    p_data         = (UINT8 *) (p_msg + 1) + p_msg->offset;
+
+    *p_data++ = (NFA_HCI_NO_MESSAGE_FRAGMENTATION << 7) | (pipe_id & 0x7F);
+    if (hdr_len == 2)
+        *p_data = (type << 6) | instruction;
+
+    status = nfa_hciu_send_segment (p_msg, pipe_id, type, instruction, data_len);
+
+    nfa_hciu_msg_sent (type, instruction);
+
     return status;
 }
 
@@ -460,6 +605,12 @@ tNFA_HCI_DYN_PIPE *nfa_hciu_alloc_pipe (UINT8 pipe_id)
         nfa_hciu_release_pipe (pipe_id);
     }
 
+    if ((pipe_id == 0) || (pipe_id > NFA_HCI_MAX_PIPE_ID))
+    {
+        NFA_TRACE_ERROR1 ("nfa_hciu_alloc_pipe:%d, invalid pipe id", pipe_id);
+        return (NULL);
+    }
+
     /* Look for a free pipe control block */
     for (xx = 0, pp = nfa_hci_cb.cfg.dyn_pipes ; xx < NFA_HCI_MAX_PIPE_CB; xx++, pp++)
     {
@@ -467,6 +618,7 @@ tNFA_HCI_DYN_PIPE *nfa_hciu_alloc_pipe (UINT8 pipe_id)
         {
             NFA_TRACE_DEBUG2 ("nfa_hciu_alloc_pipe:%d, index:%d", pipe_id, xx);
             pp->pipe_id = pipe_id;
+            nfa_hci_cb.pipe_map[pipe_id] = (UINT8) (xx + 1);
 
             nfa_hci_cb.nv_write_needed = TRUE;
             return (pp);
@@ -495,6 +647,7 @@ void nfa_hciu_release_gate (UINT8 gate_id)
         NFA_TRACE_DEBUG3 ("nfa_hciu_release_gate () ID: %d  owner: 0x%04x  pipe_inx_mask: 0x%04x",
                           gate_id, p_gate->gate_owner, p_gate->pipe_inx_mask);
 
+        nfa_hci_cb.gate_map[gate_id] = 0;
         p_gate->gate_id       = 0;
         p_gate->gate_owner    = 0;
         p_gate->pipe_inx_mask = 0;
@@ -564,6 +717,7 @@ tNFA_HCI_RESPONSE nfa_hciu_add_pipe_to_gate (UINT8 pipe_id,   UINT8 local_gate,
 *******************************************************************************/
 tNFA_HCI_RESPONSE nfa_hciu_add_pipe_to_static_gate (UINT8 local_gate, UINT8 pipe_id, UINT8 dest_host, UINT8 dest_gate)
 {
+    tNFA_HCI_DYN_GATE   *p_gate;
     tNFA_HCI_DYN_PIPE   *p_pipe;
     UINT8               pipe_index;
 
@@ -581,11 +735,16 @@ tNFA_HCI_RESPONSE nfa_hciu_add_pipe_to_static_gate (UINT8 local_gate, UINT8 pipe
 
         /* If this is the ID gate, save the pipe index in the ID gate info     */
         /* block. Note that for loopback, it is enough to just create the pipe */
+        pipe_index = (UINT8) (p_pipe - nfa_hci_cb.cfg.dyn_pipes);
         if (local_gate == NFA_HCI_IDENTITY_MANAGEMENT_GATE)
         {
-            pipe_index = (UINT8) (p_pipe - nfa_hci_cb.cfg.dyn_pipes);
             nfa_hci_cb.cfg.id_mgmt_gate.pipe_inx_mask  |= (UINT32) (1 << pipe_index);
         }
+        else if ((p_gate = nfa_hciu_find_gate_by_gid (local_gate)) != NULL)
+        {
+            /* Keep the pipe list of the gate complete */
+            p_gate->pipe_inx_mask |= (UINT32) (1 << pipe_index);
+        }
         return NFA_HCI_ANY_OK;
     }
 
@@ -708,19 +867,20 @@ tNFA_HCI_DYN_PIPE *nfa_hciu_find_pipe_on_gate (UINT8 gate_id)
 {
     tNFA_HCI_DYN_GATE   *pg;
     tNFA_HCI_DYN_PIPE   *pp;
-    int                 xx;
+    UINT32              mask;
 
     NFA_TRACE_DEBUG1 ("nfa_hciu_find_pipe_on_gate () Gate:0x%x", gate_id);
 
-    /* Loop through all pipes looking for the owner */
-    for (xx = 0, pp = nfa_hci_cb.cfg.dyn_pipes; xx < NFA_HCI_MAX_PIPE_CB; xx++, pp++)
+    if ((pg = nfa_hciu_find_gate_by_gid (gate_id)) == NULL)
+        return (NULL);
+
+    /* Loop through the pipes of the gate */
+    for (mask = pg->pipe_inx_mask, pp = nfa_hci_cb.cfg.dyn_pipes; mask != 0; mask >>= 1, pp++)
     {
-        if (pp->pipe_id != 0)
-        {
-            if (  ((pg = nfa_hciu_find_gate_by_gid (pp->local_gate)) != NULL)
-                &&(pg->gate_id == gate_id) )
-                return (pp);
-        }
+        if (  (mask & 1)
+            &&(pp->pipe_id != 0)
+            &&(pp->local_gate == gate_id)  )
+            return (pp);
     }
 
     /* If here, not found */
@@ -809,22 +969,22 @@ tNFA_HCI_DYN_PIPE *nfa_hciu_find_active_pipe_on_gate (UINT8 gate_id)
 {
     tNFA_HCI_DYN_GATE   *pg;
     tNFA_HCI_DYN_PIPE   *pp;
-    int                 xx;
+    UINT32              mask;
 
     NFA_TRACE_DEBUG1 ("nfa_hciu_find_active_pipe_on_gate () Gate:0x%x", gate_id);
 
-    /* Loop through all pipes looking for the owner */
-    for (xx = 0, pp = nfa_hci_cb.cfg.dyn_pipes; xx < NFA_HCI_MAX_PIPE_CB; xx++, pp++)
+    if ((pg = nfa_hciu_find_gate_by_gid (gate_id)) == NULL)
+        return (NULL);
+
+    /* Loop through the pipes of the gate */
+    for (mask = pg->pipe_inx_mask, pp = nfa_hci_cb.cfg.dyn_pipes; mask != 0; mask >>= 1, pp++)
     {
-        if (  (pp->pipe_id != 0)
+        if (  (mask & 1)
             &&(pp->pipe_id >= NFA_HCI_FIRST_DYNAMIC_PIPE)
             &&(pp->pipe_id <= NFA_HCI_LAST_DYNAMIC_PIPE)
+            &&(pp->local_gate == gate_id)
             &&(nfa_hciu_is_active_host (pp->dest_host))  )
-        {
-            if (  ((pg = nfa_hciu_find_gate_by_gid (pp->local_gate)) != NULL)
-                &&(pg->gate_id == gate_id) )
-                return (pp);
-        }
+            return (pp);
     }
 
     /* If here, not found */
@@ -871,6 +1031,7 @@ tNFA_HCI_RESPONSE nfa_hciu_release_pipe (UINT8 pipe_id)
         {
             /* Mark the pipe control block as free */
             p_pipe->pipe_id = 0;
+            nfa_hci_cb.pipe_map[pipe_id] = 0;
             return (NFA_HCI_ANY_E_NOK);
         }
 
@@ -880,6 +1041,7 @@ tNFA_HCI_RESPONSE nfa_hciu_release_pipe (UINT8 pipe_id)
 
     /* Reset pipe control block */
     memset (p_pipe,0,sizeof (tNFA_HCI_DYN_PIPE));
+    nfa_hci_cb.pipe_map[pipe_id] = 0;
     nfa_hci_cb.nv_write_needed = TRUE;
     return NFA_HCI_ANY_OK;
 }
@@ -502,6 +502,33 @@ typedef struct
     UINT8   pfa;    /* Frequency for NFC Technology F active mode   */
 } tNFA_DM_DISC_FREQ_CFG;
 
+/* poll technologies tracked by the adaptive RF discovery scheduler */
+enum
+{
+    NFA_DM_DISC_SCHED_TECH_A,           /* NFC Technology A                 */
+    NFA_DM_DISC_SCHED_TECH_B,           /* NFC Technology B                 */
+    NFA_DM_DISC_SCHED_TECH_F,           /* NFC Technology F                 */
+    NFA_DM_DISC_SCHED_TECH_ISO15693,    /* Proprietary Technology/15693     */
+    NFA_DM_DISC_SCHED_TECH_B_PRIME,     /* Proprietary Technology/B-Prime   */
+    NFA_DM_DISC_SCHED_TECH_KOVIO,       /* Proprietary Technology/Kovio     */
+    NFA_DM_DISC_SCHED_TECH_A_ACTIVE,    /* NFC Technology A active mode     */
+    NFA_DM_DISC_SCHED_TECH_F_ACTIVE,    /* NFC Technology F active mode     */
+    NFA_DM_DISC_SCHED_NUM_TECH
+};
+
+/* Statistics of the adaptive RF discovery scheduler (NFA_GetDiscSchedStats) */
+typedef struct
+{
+    UINT32  num_activations;            /* activations seen since NFA was enabled               */
+    UINT32  num_listen_activations;     /* activations in listen mode                           */
+    UINT32  num_adapted_starts;         /* RF discovery started with an adapted schedule        */
+    UINT32  activation_time;            /* average time from discovery start to activation (ms) */
+    UINT16  score[NFA_DM_DISC_SCHED_NUM_TECH]; /* recent activations per poll technology        */
+    UINT16  listen_score;               /* recent activations in listen mode                    */
+    UINT8   freq[NFA_DM_DISC_SCHED_NUM_TECH];  /* poll frequency used, 0 if not polled          */
+    UINT16  disc_duration;              /* total duration used (ms)                             */
+} tNFA_DISC_SCHED_STATS;
+
 /* definitions for tNFA_DM_CFG.presence_check_option */
 #define NFA_DM_PCO_ISO_SLEEP_WAKE       0x01 /* if NDEF is not supported by the tag, use sleep/wake(last interface) */
 #define NFA_DM_PCO_EMPTY_I_BLOCK        0x02 /* NFA_SendRawFrame() has been used, use empty I block for presence check
@@ -1019,6 +1046,18 @@ NFC_API extern tNFA_STATUS NFA_StopRfDiscovery (void);
 *******************************************************************************/
 NFC_API extern tNFA_STATUS NFA_SetRfDiscoveryDuration (UINT16 discovery_period_ms);
 
+/*******************************************************************************
+**
+** Function         NFA_GetDiscSchedStats
+**
+** Description      Get the statistics and the last decision of the adaptive
+**                  RF discovery scheduler (NFA_DM_DISC_ADAPTIVE in the config).
+**
+** Returns          void
+**
+*******************************************************************************/
+NFC_API extern void NFA_GetDiscSchedStats (tNFA_DISC_SCHED_STATS *p_stats);
+
 /*******************************************************************************
 **
 ** Function         NFA_Select
@@ -180,6 +180,32 @@ NFC_API extern tNFA_STATUS NFA_CeRegisterAidOnDH (UINT8           aid[NFC_MAX_AI
                                                   UINT8           aid_len,
                                                   tNFA_CONN_CBACK *p_conn_cback);
 
+/*******************************************************************************
+**
+** Function         NFA_CeRegisterAidPrefixOnDH
+**
+** Description      Register listening callback for the ISODEP AIDs starting
+**                  with the specified prefix
+**
+**                  The NFA_CE_REGISTERED_EVT reports the status of the
+**                  operation.
+**
+**                  An AID registered with NFA_CeRegisterAidOnDH or a longer
+**                  prefix has priority. The registration is removed with
+**                  NFA_CeDeregisterAidOnDH.
+**
+** Note:            If RF discovery is started, NFA_StopRfDiscovery()/NFA_RF_DISCOVERY_STOPPED_EVT
+**                  should happen before calling this function
+**
+** Returns:
+**                  NFA_STATUS_OK, if command accepted
+**                  NFA_STATUS_FAILED: otherwise
+**
+*******************************************************************************/
+NFC_API extern tNFA_STATUS NFA_CeRegisterAidPrefixOnDH (UINT8           aid[NFC_MAX_AID_LEN],
+                                                        UINT8           aid_len,
+                                                        tNFA_CONN_CBACK *p_conn_cback);
+
 /*******************************************************************************
 **
 ** Function         NFA_CeDeregisterAidOnDH
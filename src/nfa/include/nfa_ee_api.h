@@ -56,7 +56,8 @@ enum
     NFA_EE_DISCOVER_REQ_EVT,    /* NFCEE Discover Request Notification                   */
     NFA_EE_ROUT_ERR_EVT,        /* Error - exceed NFCC CE Routing size                   */
     NFA_EE_NO_MEM_ERR_EVT,      /* Error - out of GKI buffers                            */
-    NFA_EE_NO_CB_ERR_EVT        /* Error - Can not find control block or wrong state     */
+    NFA_EE_NO_CB_ERR_EVT,       /* Error - Can not find control block or wrong state     */
+    NFA_EE_ROUT_PLAN_EVT        /* AID entries folded to fit NFCC CE Routing size        */
 };
 typedef UINT8 tNFA_EE_EVT;
 
@@ -184,6 +185,26 @@ typedef struct
     UINT8       *p_buf;     /* Data buffer       */
 } tNFA_EE_DATA;
 
+/* An AID entry that is not installed as registered in the routing table */
+typedef struct
+{
+    tNFA_HANDLE         ee_handle;              /* Handle of NFCEE or DH the AID is registered for  */
+    UINT8               prefix_len;             /* length of the prefix entry covering this AID;
+                                                   0, if the AID is left to the default route       */
+    UINT8               aid_len;                /* length of the AID                                */
+    UINT8               aid[NFA_MAX_AID_LEN];   /* the AID                                          */
+} tNFA_EE_FOLDED_AID;
+
+/* Data for NFA_EE_ROUT_PLAN_EVT */
+typedef struct
+{
+    UINT16              lmrt_size;              /* the size of the Listen Mode Routing Table        */
+    UINT16              needed_size;            /* the size needed by all the registered entries    */
+    UINT16              used_size;              /* the size used by the planned routing table       */
+    UINT8               num_folded;             /* number of entries in p_folded                    */
+    tNFA_EE_FOLDED_AID  *p_folded;              /* the folded AIDs (valid during the callback only) */
+} tNFA_EE_ROUT_PLAN;
+
 /* Union of all EE callback structures */
 typedef union
 {
@@ -203,6 +224,7 @@ typedef union
     tNFA_EE_MODE_SET        mode_set;
     tNFA_EE_INFO            new_ee;
     tNFA_EE_DISCOVER_REQ    discover_req;
+    tNFA_EE_ROUT_PLAN       rout_plan;
 } tNFA_EE_CBACK_DATA;
 
 
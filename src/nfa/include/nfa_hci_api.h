@@ -75,6 +75,9 @@ typedef UINT8 tNFA_HCI_EVT;
 #define NFA_MAX_HCI_EVENT_LEN                   300     /* Max HCI event length */
 #define NFA_MAX_HCI_DATA_LEN                    260     /* Max HCI data length */
 
+/* Minimum offset of the data in a GKI buffer given to NFA_HciSendEventBuf (NCI and HCP headers) */
+#define NFA_HCI_MIN_OFFSET                      (NCI_MSG_OFFSET_SIZE + NCI_DATA_HDR_SIZE + 2)
+
 /* NFA HCI PIPE states */
 #define NFA_HCI_PIPE_CLOSED                     0x00    /* Pipe is closed */
 #define NFA_HCI_PIPE_OPENED                     0x01    /* Pipe is opened */
@@ -549,6 +552,31 @@ NFC_API extern tNFA_STATUS NFA_HciSendEvent (tNFA_HANDLE hci_handle,
                                             UINT8        *p_rsp_buf,
                                             UINT16       rsp_timeout);
 
+/*******************************************************************************
+**
+** Function         NFA_HciSendEventBuf
+**
+** Description      This function is called to send any event on a pipe created
+**                  by the application, same as NFA_HciSendEvent but the event
+**                  data is given in a GKI buffer starting at p_evt_msg->offset,
+**                  which must be at least NFA_HCI_MIN_OFFSET.
+**                  The HCP headers are written in front of the data, so an
+**                  event fitting in one HCP packet is sent without copy.
+**                  The buffer is owned by NFA after this call, even if an
+**                  error occurs.
+**
+** Returns          NFA_STATUS_OK if successfully initiated
+**                  NFA_STATUS_FAILED otherwise
+**
+*******************************************************************************/
+NFC_API extern tNFA_STATUS NFA_HciSendEventBuf (tNFA_HANDLE hci_handle,
+                                               UINT8        pipe,
+                                               UINT8        evt_code,
+                                               BT_HDR       *p_evt_msg,
+                                               UINT16       rsp_size,
+                                               UINT8        *p_rsp_buf,
+                                               UINT16       rsp_timeout);
+
 /*******************************************************************************
 **
 ** Function         NFA_HciClosePipe
@@ -178,6 +178,13 @@ typedef union
 /* NFA P2P callback */
 typedef void (tNFA_P2P_CBACK)(tNFA_P2P_EVT event, tNFA_P2P_EVT_DATA *p_data);
 
+/* Data segment for NFA_P2pSendUIVec () and NFA_P2pSendDataVec () */
+typedef struct
+{
+    UINT8       *p_data;
+    UINT16      len;
+} tNFA_P2P_DATA_SEG;
+
 /*****************************************************************************
 **  External Function Declarations
 *****************************************************************************/
@@ -337,6 +344,38 @@ NFC_API extern tNFA_STATUS NFA_P2pConnectBySap (tNFA_HANDLE client_handle,
                                                 UINT16      miu,
                                                 UINT8       rw);
 
+/*******************************************************************************
+**
+** Function         NFA_P2pGetTxBuf
+**
+** Description      This function is called to get a buffer for data to send
+**                  with NFA_P2pSendUIBuf () or NFA_P2pSendDataBuf ().
+**
+**                  The data is written at (UINT8 *) (p_buf + 1) + p_buf->offset
+**                  and its length is set in p_buf->len. p_buf->offset must not
+**                  be decreased. The buffer is sent without copying.
+**
+**                  The buffer must be freed with NFA_P2pFreeTxBuf () if it is
+**                  not sent.
+**
+** Returns          Buffer, or NULL if out of buffers
+**                  *p_max_len is set to the maximum data length in buffer
+**
+*******************************************************************************/
+NFC_API extern BT_HDR *NFA_P2pGetTxBuf (UINT16 *p_max_len);
+
+/*******************************************************************************
+**
+** Function         NFA_P2pFreeTxBuf
+**
+** Description      This function is called to free a buffer from
+**                  NFA_P2pGetTxBuf () which was not sent.
+**
+** Returns          None
+**
+*******************************************************************************/
+NFC_API extern void NFA_P2pFreeTxBuf (BT_HDR *p_buf);
+
 /*******************************************************************************
 **
 ** Function         NFA_P2pSendUI
@@ -356,6 +395,48 @@ NFC_API extern tNFA_STATUS NFA_P2pSendUI (tNFA_HANDLE handle,
                                           UINT16      length,
                                           UINT8      *p_data);
 
+/*******************************************************************************
+**
+** Function         NFA_P2pSendUIVec
+**
+** Description      This function is called to send data in segments on
+**                  connectionless transport. The segments are sent as one
+**                  UI PDU.
+**
+** Returns          NFA_STATUS_OK if successfully initiated
+**                  NFA_STATUS_BAD_HANDLE if handle is not valid
+**                  NFA_STATUS_BAD_LENGTH if data length is more than remote link MIU
+**                  NFA_STATUS_CONGESTED  if congested
+**                  NFA_STATUS_FAILED otherwise
+**
+*******************************************************************************/
+NFC_API extern tNFA_STATUS NFA_P2pSendUIVec (tNFA_HANDLE        handle,
+                                             UINT8              dsap,
+                                             UINT8              num_segs,
+                                             tNFA_P2P_DATA_SEG *p_segs);
+
+/*******************************************************************************
+**
+** Function         NFA_P2pSendUIBuf
+**
+** Description      This function is called to send data in a buffer from
+**                  NFA_P2pGetTxBuf () on connectionless transport.
+**
+**                  NFA takes the buffer if NFA_STATUS_OK is returned.
+**                  Otherwise the caller keeps it, to send it again later or
+**                  to free it with NFA_P2pFreeTxBuf ().
+**
+** Returns          NFA_STATUS_OK if successfully initiated
+**                  NFA_STATUS_BAD_HANDLE if handle is not valid
+**                  NFA_STATUS_BAD_LENGTH if data length is more than remote link MIU
+**                  NFA_STATUS_CONGESTED  if congested
+**                  NFA_STATUS_FAILED otherwise
+**
+*******************************************************************************/
+NFC_API extern tNFA_STATUS NFA_P2pSendUIBuf (tNFA_HANDLE handle,
+                                             UINT8       dsap,
+                                             BT_HDR     *p_buf);
+
 /*******************************************************************************
 **
 ** Function         NFA_P2pReadUI
@@ -412,6 +493,46 @@ NFC_API extern tNFA_STATUS NFA_P2pSendData (tNFA_HANDLE conn_handle,
                                             UINT16      length,
                                             UINT8      *p_data);
 
+/*******************************************************************************
+**
+** Function         NFA_P2pSendDataVec
+**
+** Description      This function is called to send data in segments on
+**                  connection-oriented transport. The segments are sent as
+**                  one I PDU.
+**
+** Returns          NFA_STATUS_OK if successfully initiated
+**                  NFA_STATUS_BAD_HANDLE if handle is not valid
+**                  NFA_STATUS_BAD_LENGTH if data length is more than remote MIU
+**                  NFA_STATUS_CONGESTED  if congested
+**                  NFA_STATUS_FAILED otherwise
+**
+*******************************************************************************/
+NFC_API extern tNFA_STATUS NFA_P2pSendDataVec (tNFA_HANDLE        handle,
+                                               UINT8              num_segs,
+                                               tNFA_P2P_DATA_SEG *p_segs);
+
+/*******************************************************************************
+**
+** Function         NFA_P2pSendDataBuf
+**
+** Description      This function is called to send data in a buffer from
+**                  NFA_P2pGetTxBuf () on connection-oriented transport.
+**
+**                  NFA takes the buffer if NFA_STATUS_OK is returned.
+**                  Otherwise the caller keeps it, to send it again later or
+**                  to free it with NFA_P2pFreeTxBuf ().
+**
+** Returns          NFA_STATUS_OK if successfully initiated
+**                  NFA_STATUS_BAD_HANDLE if handle is not valid
+**                  NFA_STATUS_BAD_LENGTH if data length is more than remote MIU
+**                  NFA_STATUS_CONGESTED  if congested
+**                  NFA_STATUS_FAILED otherwise
+**
+*******************************************************************************/
+NFC_API extern tNFA_STATUS NFA_P2pSendDataBuf (tNFA_HANDLE handle,
+                                               BT_HDR     *p_buf);
+
 /*******************************************************************************
 **
 ** Function         NFA_P2pReadData
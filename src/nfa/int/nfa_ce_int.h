@@ -97,6 +97,7 @@ typedef struct
     /* For registering Type-4 */
     UINT8               aid[NFC_MAX_AID_LEN];   /* AID to listen for (For type-4 only)  */
     UINT8               aid_len;                /* AID length                           */
+    BOOLEAN             aid_prefix;             /* TRUE if aid is an AID prefix         */
 
     /* For registering UICC */
     tNFA_HANDLE             ee_handle;
@@ -126,7 +127,9 @@ typedef union
 ** LISTEN_INFO definitions
 *****************************************************************************/
 #define NFA_CE_LISTEN_INFO_IDX_NDEF     0                           /* Entry 0 is reserved for local NDEF tag */
-#define NFA_CE_LISTEN_INFO_IDX_INVALID  (NFA_CE_LISTEN_INFO_MAX)
+#define NFA_CE_LISTEN_INFO_IDX_AID      (NFA_CE_LISTEN_INFO_MAX)    /* First entry for T4T AID                */
+#define NFA_CE_LISTEN_INFO_NUM          (NFA_CE_LISTEN_INFO_MAX + NFA_CE_AID_LISTEN_INFO_MAX)
+#define NFA_CE_LISTEN_INFO_IDX_INVALID  (NFA_CE_LISTEN_INFO_NUM)
 
 
 /* Flags for listen request */
@@ -177,7 +180,7 @@ typedef struct
     tNFA_CONN_CBACK     *p_active_conn_cback;               /* Callback of activated CE */
 
     /* listen_info table (table of listen paramters and app callbacks) */
-    tNFA_CE_LISTEN_INFO listen_info[NFA_CE_LISTEN_INFO_MAX];/* listen info table                            */
+    tNFA_CE_LISTEN_INFO listen_info[NFA_CE_LISTEN_INFO_NUM];/* listen info table                            */
     UINT8               idx_cur_active;                     /* listen_info index for currently activated CE */
     UINT8               idx_wild_card;                      /* listen_info index for T4T wild card CE */
 
@@ -211,6 +214,7 @@ tNFA_STATUS nfa_ce_start_listening (void);
 void nfa_ce_remove_listen_info_entry (UINT8 listen_info_idx, BOOLEAN notify_app);
 void nfa_ce_sys_disable (void);
 void nfa_ce_free_scratch_buf (void);
+void nfa_ce_delete_rf_discover (UINT8 listen_info_idx);
 BOOLEAN nfa_ce_restart_listen_check (void);
 #endif /* NFA_DM_INT_H */
 
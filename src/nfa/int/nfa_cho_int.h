@@ -232,6 +232,10 @@ typedef struct
     UINT32              rx_ndef_buf_size;       /* allocate buffer size for rx NDEF msg */
     UINT32              rx_ndef_cur_size;       /* current rx size of NDEF message      */
 
+    UINT8              *p_collision_rx_ndef_msg;    /* rx NDEF msg on collision connection  */
+    UINT32              collision_rx_ndef_buf_size; /* allocate buffer size for it          */
+    UINT32              collision_rx_ndef_cur_size; /* current rx size of it                */
+
     tNFA_CHO_CBACK     *p_cback;                /* callback registered by application   */
 
     UINT8               trace_level;
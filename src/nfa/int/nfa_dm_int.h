@@ -370,6 +370,14 @@ enum {
 */
 #define NFA_DM_DISC_TIMEOUT_W4_DEACT_NTF            (NFC_DEACTIVATE_TIMEOUT*1000 + 6000)
 
+/* adaptive RF discovery scheduler */
+typedef struct
+{
+    tNFA_DISC_SCHED_STATS   stats;                  /* history and last decision, see NFA_GetDiscSchedStats */
+    UINT16                  total_score;            /* sum of stats.score[] and stats.listen_score      */
+    UINT32                  disc_start_ticks;       /* when discovery was started or resumed, 0 if not  */
+} tNFA_DM_DISC_SCHED;
+
 typedef struct
 {
     UINT16                  disc_duration;          /* Disc duration                                    */
@@ -398,6 +406,7 @@ typedef struct
     BOOLEAN                 deact_notify_pending;   /* TRUE if notify DEACTIVATED EVT while Stop rf discovery*/
     tNFA_DEACTIVATE_TYPE    pending_deact_type;     /* pending deactivate type                          */
 
+    tNFA_DM_DISC_SCHED      sched;                  /* adaptive RF discovery scheduler                  */
 } tNFA_DM_DISC_CB;
 
 /* NDEF Type Handler Definitions */
@@ -408,6 +417,9 @@ typedef struct
 /* Maximum number of pending SetConfigs */
 #define NFA_DM_SETCONFIG_PENDING_MAX            32
 
+/* Largest SET_CONFIG built from batched config parameters */
+#define NFA_DM_SETCONFIG_BATCH_SIZE             (NCI_MAX_CTRL_SIZE - 1)
+
 /* NFA_DM flags */
 #define NFA_DM_FLAGS_DM_IS_ACTIVE               0x00000001  /* DM is enabled                                                        */
 #define NFA_DM_FLAGS_EXCL_RF_ACTIVE             0x00000002  /* Exclusive RF mode is active                                          */
@@ -510,6 +522,8 @@ typedef struct
     /* SetConfig management */
     UINT32                      setcfg_pending_mask;    /* Mask of to indicate whether pending SET_CONFIGs require NFA_DM_SET_CONFIG_EVT. LSB=oldest pending */
     UINT8                       setcfg_pending_num;     /* Number of setconfigs pending */
+    UINT8                       setcfg_batch[NFA_DM_SETCONFIG_BATCH_SIZE]; /* TLVs for the next SET_CONFIG */
+    UINT8                       setcfg_batch_len;       /* length of TLVs in setcfg_batch */
 
     /* NFCC power mode */
     UINT8                       nfcc_pwr_mode;          /* NFA_DM_PWR_MODE_FULL or NFA_DM_PWR_MODE_OFF_SLEEP */
@@ -542,6 +556,8 @@ extern UINT8 nfa_ee_max_ee_cfg;
 extern tNCI_DISCOVER_MAPS *p_nfa_dm_interface_mapping;
 extern UINT8 nfa_dm_num_dm_interface_mapping;
 extern BOOLEAN nfa_poll_bail_out_mode;
+extern BOOLEAN nfa_dm_disc_adaptive;
+extern UINT16 nfa_dm_disc_duration_cfg;
 
 /* NFA device manager control block */
 #if NFA_DYNAMIC_MEMORY == FALSE
@@ -611,6 +627,7 @@ BOOLEAN nfa_dm_evt_hdlr (BT_HDR *p_msg);
 void nfa_dm_sys_enable (void);
 void nfa_dm_sys_disable (void);
 tNFA_STATUS nfa_dm_check_set_config (UINT8 tlv_list_len, UINT8 *p_tlv_list, BOOLEAN app_init);
+void nfa_dm_flush_set_config (void);
 
 void nfa_dm_conn_cback_event_notify (UINT8 event, tNFA_CONN_EVT_DATA *p_data);
 
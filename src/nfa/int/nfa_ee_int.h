@@ -78,6 +78,9 @@ enum
 typedef UINT16 tNFA_EE_INT_EVT;
 #define NFA_EE_AE_ROUTE             0x80        /* for listen mode routing table*/
 #define NFA_EE_AE_VS                0x40
+#define NFA_EE_AE_PREFIX            0x20        /* routing planner: installed as a prefix entry */
+#define NFA_EE_AE_FOLDED            0x10        /* routing planner: not installed in the LMRT   */
+#define NFA_EE_AE_PLAN              0x30        /* the flags set by the routing planner         */
 
 
 /* NFA EE Management state */
@@ -146,6 +149,10 @@ typedef struct
     UINT8                   aid_pwr_cfg[NFA_EE_MAX_AID_ENTRIES];/* power configuration of this AID entry */
     UINT8                   aid_rt_info[NFA_EE_MAX_AID_ENTRIES];/* route/vs info for this AID entry */
     UINT8                   aid_cfg[NFA_EE_MAX_AID_CFG_LEN];/* routing entries based on AID */
+#if (NFA_EE_ROUT_PLANNER_INCLUDED == TRUE)
+    UINT16                  aid_hits[NFA_EE_MAX_AID_ENTRIES];/* number of SELECT commands for this AID entry */
+    UINT8                   aid_prefix_len[NFA_EE_MAX_AID_ENTRIES];/* length of the prefix entry covering this AID entry */
+#endif
     UINT8                   aid_entries;        /* The number of AID entries in aid_cfg */
     UINT8                   nfcee_id;           /* ID for this NFCEE */
     UINT8                   ee_status;          /* The NFCEE status */
@@ -486,6 +493,9 @@ int nfa_ee_find_total_aid_len(tNFA_EE_ECB *p_cb, int start_entry);
 void nfa_ee_start_timer(void);
 void nfa_ee_reg_cback_enable_done (tNFA_EE_ENABLE_DONE_CBACK *p_cback);
 void nfa_ee_report_update_evt (void);
+#if (NFA_EE_ROUT_PLANNER_INCLUDED == TRUE)
+void nfa_ee_aid_hit (UINT8 aid_len, UINT8 *p_aid);
+#endif
 
 extern void nfa_ee_proc_hci_info_cback (void);
 void nfa_ee_check_disable (void);
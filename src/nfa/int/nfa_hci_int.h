@@ -65,6 +65,9 @@ typedef UINT8 tNFA_HCI_STATE;
 
 #define NFA_HCI_INVALID_INX             0xFF
 
+#define NFA_HCI_MAX_PIPE_ID             0x7F     /* Pipe identifiers are 7 bits */
+#define NFA_HCI_MAX_GATE_ID             0xFF     /* Gate identifiers are 8 bits */
+
 
 typedef UINT8 tNFA_HCI_COMMAND;
 typedef UINT8 tNFA_HCI_RESPONSE;
@@ -233,6 +236,7 @@ typedef struct
     UINT8               evt_code;
     UINT16              evt_len;
     UINT8               *p_evt_buf;
+    BT_HDR              *p_evt_msg;     /* event data in a GKI buffer (NFA_HciSendEventBuf) */
     UINT16              rsp_len;
     UINT8               *p_rsp_buf;
     UINT16              rsp_timeout;
@@ -404,6 +408,8 @@ typedef struct
     tNFA_HCI_CBACK                  *p_app_cback[NFA_HCI_MAX_APP_CB];   /* Callback functions registered by the applications */
     UINT16                          rsp_buf_size;                       /* Maximum size of APDU buffer */
     UINT8                           *p_rsp_buf;                         /* Buffer to hold response to sent event */
+    UINT8                           pipe_map[NFA_HCI_MAX_PIPE_ID + 1];  /* Pipe ID to index in cfg.dyn_pipes + 1, 0 if none */
+    UINT8                           gate_map[NFA_HCI_MAX_GATE_ID + 1];  /* Gate ID to index in cfg.dyn_gates + 1, 0 if none */
     struct                                                              /* Persistent information for Device Host */
     {
         char                        reg_app_names[NFA_HCI_MAX_APP_CB][NFA_MAX_HCI_APP_NAME_LEN + 1];
@@ -487,6 +493,7 @@ extern tNFA_HCI_RESPONSE   nfa_hciu_release_pipe (UINT8 pipe_id);
 extern void                nfa_hciu_release_gate (UINT8 gate);
 extern void                nfa_hciu_remove_all_pipes_from_host (UINT8 host);
 extern UINT8               nfa_hciu_get_allocated_gate_list (UINT8 *p_gate_list);
+extern void                nfa_hciu_build_maps (void);
 
 extern void                nfa_hciu_send_to_app (tNFA_HCI_EVT event, tNFA_HCI_EVT_DATA *p_evt, tNFA_HANDLE app_handle);
 extern void                nfa_hciu_send_to_all_apps (tNFA_HCI_EVT event, tNFA_HCI_EVT_DATA *p_evt);
@@ -500,6 +507,7 @@ extern tNFA_STATUS nfa_hciu_send_get_param_cmd (UINT8 pipe, UINT8 index);
 extern tNFA_STATUS nfa_hciu_send_create_pipe_cmd (UINT8 source_gate, UINT8 dest_host, UINT8 dest_gate);
 extern tNFA_STATUS nfa_hciu_send_set_param_cmd (UINT8 pipe, UINT8 index, UINT8 length, UINT8 *p_data);
 extern tNFA_STATUS nfa_hciu_send_msg (UINT8 pipe_id, UINT8 type, UINT8 instruction, UINT16 pkt_len, UINT8 *p_pkt);
+extern tNFA_STATUS nfa_hciu_send_msg_buf (UINT8 pipe_id, UINT8 type, UINT8 instruction, BT_HDR *p_msg);
 
 
 
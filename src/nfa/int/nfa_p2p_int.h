@@ -127,23 +127,26 @@ typedef struct
     UINT8               rw;
 } tNFA_P2P_API_CONNECT;
 
-/* data type for NFA_P2P_API_SEND_UI_EVT */
+/* data type for NFA_P2P_API_SEND_UI_EVT                              */
+/* The message is the LLCP buffer itself; the PDU is at hdr.offset    */
 typedef struct
 {
     BT_HDR              hdr;
     tNFA_HANDLE         handle;
     UINT8               dsap;
-    BT_HDR             *p_msg;
 } tNFA_P2P_API_SEND_UI;
 
-/* data type for NFA_P2P_API_SEND_DATA_EVT */
+/* data type for NFA_P2P_API_SEND_DATA_EVT                            */
+/* The message is the LLCP buffer itself; the PDU is at hdr.offset    */
 typedef struct
 {
     BT_HDR              hdr;
     tNFA_HANDLE         conn_handle;
-    BT_HDR             *p_msg;
 } tNFA_P2P_API_SEND_DATA;
 
+/* Offset of the PDU in a tx buffer: the message fields above, then LLCP headers */
+#define NFA_P2P_TX_BUF_OFFSET   (sizeof (tNFA_P2P_API_SEND_UI) - BT_HDR_SIZE + LLCP_MIN_OFFSET)
+
 /* data type for NFA_P2P_API_SET_LOCAL_BUSY_EVT */
 typedef struct
 {
@@ -36,6 +36,7 @@
 #define NFA_SNEP_HEADER_SIZE            6       /* SNEP header size          */
 #define NFA_SNEP_ACCEPT_LEN_SIZE        4       /* SNEP Acceptable Length size */
 #define NFA_SNEP_CLIENT_TIMEOUT         1000    /* ms, waiting for response  */
+#define NFA_SNEP_VERSION_MAJOR_MASK     0xF0    /* major version in SNEP version field */
 
 /* NFA SNEP events */
 enum
@@ -174,11 +175,13 @@ typedef union
 #define NFA_SNEP_FLAG_CONNECTED         0x08   /* data link connected            */
 #define NFA_SNEP_FLAG_W4_RESP_CONTINUE  0x10   /* Waiting for continue response  */
 #define NFA_SNEP_FLAG_W4_REQ_CONTINUE   0x20   /* Waiting for continue request   */
+#define NFA_SNEP_FLAG_W4_RESP           0x40   /* Waiting for response from peer (client) or application (server) */
+#define NFA_SNEP_FLAG_W4_TX_CMPL        0x80   /* Sending GET response (server)  */
 
 typedef struct
 {
     UINT8               local_sap;      /* local SAP of service */
-    UINT8               remote_sap;     /* local SAP of service */
+    UINT8               remote_sap;     /* remote SAP of data link */
     UINT8               flags;          /* internal flags       */
     tNFA_SNEP_CBACK    *p_cback;        /* callback for event   */
     TIMER_LIST_ENT      timer;          /* timer for client     */
@@ -190,6 +193,9 @@ typedef struct
     UINT8               tx_code;        /* transmitted code in request/response */
     UINT8               rx_code;        /* received code in request/response    */
 
+    UINT8               rx_hdr[NFA_SNEP_HEADER_SIZE + NFA_SNEP_ACCEPT_LEN_SIZE];
+    UINT8               rx_hdr_len;     /* received length of header             */
+
     UINT32              acceptable_length;
     UINT32              buff_length;    /* size of buffer for NDEF message   */
     UINT32              ndef_length;    /* length of NDEF message            */
@@ -267,7 +273,7 @@ BOOLEAN nfa_snep_stop_default_server (tNFA_SNEP_MSG *p_msg);
 */
 UINT8 nfa_snep_allocate_cb (void);
 void nfa_snep_deallocate_cb (UINT8 xx);
-void nfa_snep_send_msg (UINT8 opcode, UINT8 dlink);
+BOOLEAN nfa_snep_send_msg (UINT8 opcode, UINT8 dlink);
 
 void nfa_snep_llcp_cback (tLLCP_SAP_CBACK_DATA *p_data);
 void nfa_snep_proc_llcp_data_ind (tLLCP_SAP_CBACK_DATA  *p_data);
@@ -1016,7 +1016,7 @@ BOOLEAN nfa_p2p_create_data_link_connection (tNFA_P2P_MSG *p_msg)
 ** Description      Send UI PDU
 **
 **
-** Returns          TRUE to deallocate buffer
+** Returns          FALSE, the buffer is passed to LLCP
 **
 *******************************************************************************/
 BOOLEAN nfa_p2p_send_ui (tNFA_P2P_MSG *p_msg)
@@ -1036,9 +1036,10 @@ BOOLEAN nfa_p2p_send_ui (tNFA_P2P_MSG *p_msg)
     if (nfa_p2p_cb.total_pending_ui_pdu)
         nfa_p2p_cb.total_pending_ui_pdu--;
 
+    /* the message is the PDU buffer; LLCP takes it */
     status = LLCP_SendUI (local_sap,
                           p_msg->api_send_ui.dsap,
-                          p_msg->api_send_ui.p_msg);
+                          &p_msg->hdr);
 
     if (status == LLCP_STATUS_CONGESTED)
     {
@@ -1055,7 +1056,7 @@ BOOLEAN nfa_p2p_send_ui (tNFA_P2P_MSG *p_msg)
         }
     }
 
-    return TRUE;
+    return FALSE;
 }
 
 /*******************************************************************************
@@ -1065,7 +1066,7 @@ BOOLEAN nfa_p2p_send_ui (tNFA_P2P_MSG *p_msg)
 ** Description      Send I PDU
 **
 **
-** Returns          TRUE to deallocate buffer
+** Returns          FALSE, the buffer is passed to LLCP
 **
 *******************************************************************************/
 BOOLEAN nfa_p2p_send_data (tNFA_P2P_MSG *p_msg)
@@ -1086,9 +1087,10 @@ BOOLEAN nfa_p2p_send_data (tNFA_P2P_MSG *p_msg)
     if (nfa_p2p_cb.total_pending_i_pdu)
         nfa_p2p_cb.total_pending_i_pdu--;
 
+    /* the message is the PDU buffer; LLCP takes it */
     status = LLCP_SendData (nfa_p2p_cb.conn_cb[xx].local_sap,
                             nfa_p2p_cb.conn_cb[xx].remote_sap,
-                            p_msg->api_send_data.p_msg);
+                            &p_msg->hdr);
 
     if (status == LLCP_STATUS_CONGESTED)
     {
@@ -1105,7 +1107,7 @@ BOOLEAN nfa_p2p_send_data (tNFA_P2P_MSG *p_msg)
         }
     }
 
-    return TRUE;
+    return FALSE;
 }
 
 /*******************************************************************************
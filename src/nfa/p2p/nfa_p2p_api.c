@@ -35,6 +35,253 @@
 **  Constants
 *****************************************************************************/
 
+/*****************************************************************************
+**  Local functions
+*****************************************************************************/
+
+/*******************************************************************************
+**
+** Function         nfa_p2p_get_tx_buf
+**
+** Description      Allocate a buffer for a PDU to send. The PDU starts after
+**                  room for the NFA API message and LLCP headers, so the
+**                  buffer is sent to NFA and LLCP without copying.
+**
+** Returns          Buffer with empty PDU, or NULL if out of buffers
+**
+*******************************************************************************/
+static BT_HDR *nfa_p2p_get_tx_buf (void)
+{
+    BT_HDR *p_buf;
+
+    if ((p_buf = (BT_HDR *) GKI_getpoolbuf (LLCP_POOL_ID)) != NULL)
+    {
+        p_buf->offset         = NFA_P2P_TX_BUF_OFFSET;
+        p_buf->len            = 0;
+        p_buf->layer_specific = 0;
+    }
+
+    return (p_buf);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_p2p_gather_segs
+**
+** Description      Copy data segments into a tx buffer from nfa_p2p_get_tx_buf.
+**
+** Returns          FALSE if the segments do not fit in the buffer
+**
+*******************************************************************************/
+static BOOLEAN nfa_p2p_gather_segs (BT_HDR            *p_buf,
+                                    UINT8              num_segs,
+                                    tNFA_P2P_DATA_SEG *p_segs)
+{
+    UINT8  *p = (UINT8 *) (p_buf + 1) + p_buf->offset;
+    UINT16 max_len = GKI_get_buf_size (p_buf) - BT_HDR_SIZE - p_buf->offset;
+    UINT8  xx;
+
+    for (xx = 0; xx < num_segs; xx++)
+    {
+        if (p_segs[xx].len > max_len - p_buf->len)
+            return (FALSE);
+
+        memcpy (p + p_buf->len, p_segs[xx].p_data, p_segs[xx].len);
+        p_buf->len += p_segs[xx].len;
+    }
+
+    return (TRUE);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_p2p_segs_len
+**
+** Description      Add up the lengths of data segments.
+**
+** Returns          Total length, more than 0xFFFF if it does not fit in a PDU
+**
+*******************************************************************************/
+static UINT32 nfa_p2p_segs_len (UINT8              num_segs,
+                                tNFA_P2P_DATA_SEG *p_segs)
+{
+    UINT32 length = 0;
+    UINT8  xx;
+
+    for (xx = 0; xx < num_segs; xx++)
+        length += p_segs[xx].len;
+
+    return (length);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_p2p_check_send_ui
+**
+** Description      Check if a UI PDU can be sent on the logical link.
+**                  GKI_sched_lock () must be held.
+**
+** Returns          NFA_STATUS_OK if it can be sent
+**                  NFA_STATUS_BAD_HANDLE if handle is not valid
+**                  NFA_STATUS_BAD_LENGTH if data length is more than remote link MIU
+**                  NFA_STATUS_CONGESTED  if congested
+**
+*******************************************************************************/
+static tNFA_STATUS nfa_p2p_check_send_ui (tNFA_HANDLE handle,
+                                          UINT16      length)
+{
+    tNFA_HANDLE xx = handle & NFA_HANDLE_MASK;
+
+    if (  (xx >= NFA_P2P_NUM_SAP)
+        ||(nfa_p2p_cb.sap_cb[xx].p_cback == NULL))
+    {
+        P2P_TRACE_ERROR1 ("NFA_P2pSendUI (): Handle (0x%X) is not valid", handle);
+        return (NFA_STATUS_BAD_HANDLE);
+    }
+    else if (length > nfa_p2p_cb.remote_link_miu)
+    {
+        P2P_TRACE_ERROR3 ("NFA_P2pSendUI (): handle:0x%X, length(%d) must be less than remote link MIU(%d)",
+                           handle, length, nfa_p2p_cb.remote_link_miu);
+        return (NFA_STATUS_BAD_LENGTH);
+    }
+    else if (nfa_p2p_cb.sap_cb[xx].flags & NFA_P2P_SAP_FLAG_LLINK_CONGESTED)
+    {
+        P2P_TRACE_WARNING1 ("NFA_P2pSendUI (): handle:0x%X, logical data link is already congested",
+                             handle);
+        return (NFA_STATUS_CONGESTED);
+    }
+    else if (LLCP_IsLogicalLinkCongested ((UINT8)xx,
+                                          nfa_p2p_cb.sap_cb[xx].num_pending_ui_pdu,
+                                          nfa_p2p_cb.total_pending_ui_pdu,
+                                          nfa_p2p_cb.total_pending_i_pdu))
+    {
+        nfa_p2p_cb.sap_cb[xx].flags |= NFA_P2P_SAP_FLAG_LLINK_CONGESTED;
+
+        P2P_TRACE_WARNING1 ("NFA_P2pSendUI(): handle:0x%X, logical data link is congested",
+                             handle);
+        return (NFA_STATUS_CONGESTED);
+    }
+
+    return (NFA_STATUS_OK);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_p2p_post_send_ui
+**
+** Description      Send a tx buffer to NFA as NFA_P2P_API_SEND_UI_EVT.
+**                  GKI_sched_lock () must be held.
+**
+** Returns          None
+**
+*******************************************************************************/
+static void nfa_p2p_post_send_ui (tNFA_HANDLE handle,
+                                  UINT8       dsap,
+                                  BT_HDR     *p_buf)
+{
+    tNFA_P2P_API_SEND_UI *p_msg = (tNFA_P2P_API_SEND_UI *) p_buf;
+    tNFA_HANDLE           xx    = handle & NFA_HANDLE_MASK;
+
+    p_msg->hdr.event = NFA_P2P_API_SEND_UI_EVT;
+    p_msg->handle    = handle;
+    p_msg->dsap      = dsap;
+
+    /* increase number of tx UI PDU which is not processed by NFA for congestion control */
+    nfa_p2p_cb.sap_cb[xx].num_pending_ui_pdu++;
+    nfa_p2p_cb.total_pending_ui_pdu++;
+    nfa_sys_sendmsg (p_msg);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_p2p_check_send_data
+**
+** Description      Check if an I PDU can be sent on the data link connection.
+**                  GKI_sched_lock () must be held.
+**
+** Returns          NFA_STATUS_OK if it can be sent
+**                  NFA_STATUS_BAD_HANDLE if handle is not valid
+**                  NFA_STATUS_BAD_LENGTH if data length is more than remote MIU
+**                  NFA_STATUS_CONGESTED  if congested
+**                  NFA_STATUS_FAILED otherwise
+**
+*******************************************************************************/
+static tNFA_STATUS nfa_p2p_check_send_data (tNFA_HANDLE handle,
+                                            UINT16      length)
+{
+    tNFA_HANDLE xx;
+
+    xx = handle & NFA_HANDLE_MASK;
+    xx &= ~NFA_P2P_HANDLE_FLAG_CONN;
+
+    if (  (!(handle & NFA_P2P_HANDLE_FLAG_CONN))
+        ||(xx >= LLCP_MAX_DATA_LINK)
+        ||(nfa_p2p_cb.conn_cb[xx].flags == 0)  )
+    {
+        P2P_TRACE_ERROR1 ("NFA_P2pSendData (): Handle(0x%X) is not valid", handle);
+        return (NFA_STATUS_BAD_HANDLE);
+    }
+    else if (nfa_p2p_cb.conn_cb[xx].flags & NFA_P2P_CONN_FLAG_REMOTE_RW_ZERO)
+    {
+        P2P_TRACE_ERROR1 ("NFA_P2pSendData (): handle:0x%X, Remote set RW to 0 (flow off)", handle);
+        return (NFA_STATUS_FAILED);
+    }
+    else if (nfa_p2p_cb.conn_cb[xx].remote_miu < length)
+    {
+        P2P_TRACE_ERROR2 ("NFA_P2pSendData (): handle:0x%X, Data more than remote MIU(%d)",
+                           handle, nfa_p2p_cb.conn_cb[xx].remote_miu);
+        return (NFA_STATUS_BAD_LENGTH);
+    }
+    else if (nfa_p2p_cb.conn_cb[xx].flags & NFA_P2P_CONN_FLAG_CONGESTED)
+    {
+        P2P_TRACE_WARNING1 ("NFA_P2pSendData (): handle:0x%X, data link connection is already congested",
+                            handle);
+        return (NFA_STATUS_CONGESTED);
+    }
+    else if (LLCP_IsDataLinkCongested (nfa_p2p_cb.conn_cb[xx].local_sap,
+                                       nfa_p2p_cb.conn_cb[xx].remote_sap,
+                                       nfa_p2p_cb.conn_cb[xx].num_pending_i_pdu,
+                                       nfa_p2p_cb.total_pending_ui_pdu,
+                                       nfa_p2p_cb.total_pending_i_pdu))
+    {
+        nfa_p2p_cb.conn_cb[xx].flags |= NFA_P2P_CONN_FLAG_CONGESTED;
+
+        P2P_TRACE_WARNING1 ("NFA_P2pSendData (): handle:0x%X, data link connection is congested",
+                            handle);
+        return (NFA_STATUS_CONGESTED);
+    }
+
+    return (NFA_STATUS_OK);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_p2p_post_send_data
+**
+** Description      Send a tx buffer to NFA as NFA_P2P_API_SEND_DATA_EVT.
+**                  GKI_sched_lock () must be held.
+**
+** Returns          None
+**
+*******************************************************************************/
+static void nfa_p2p_post_send_data (tNFA_HANDLE handle,
+                                    BT_HDR     *p_buf)
+{
+    tNFA_P2P_API_SEND_DATA *p_msg = (tNFA_P2P_API_SEND_DATA *) p_buf;
+    tNFA_HANDLE             xx;
+
+    xx = handle & NFA_HANDLE_MASK;
+    xx &= ~NFA_P2P_HANDLE_FLAG_CONN;
+
+    p_msg->hdr.event   = NFA_P2P_API_SEND_DATA_EVT;
+    p_msg->conn_handle = handle;
+
+    /* increase number of tx I PDU which is not processed by NFA for congestion control */
+    nfa_p2p_cb.conn_cb[xx].num_pending_i_pdu++;
+    nfa_p2p_cb.total_pending_i_pdu++;
+    nfa_sys_sendmsg (p_msg);
+}
+
 /*******************************************************************************
 **
 ** Function         NFA_P2pRegisterServer
@@ -483,6 +730,64 @@ tNFA_STATUS NFA_P2pConnectBySap (tNFA_HANDLE client_handle,
     return (NFA_STATUS_FAILED);
 }
 
+/*******************************************************************************
+**
+** Function         NFA_P2pGetTxBuf
+**
+** Description      This function is called to get a buffer for data to send
+**                  with NFA_P2pSendUIBuf () or NFA_P2pSendDataBuf ().
+**
+**                  The data is written at (UINT8 *) (p_buf + 1) + p_buf->offset
+**                  and its length is set in p_buf->len. p_buf->offset must not
+**                  be decreased. The buffer is sent without copying.
+**
+**                  The buffer must be freed with NFA_P2pFreeTxBuf () if it is
+**                  not sent.
+**
+** Returns          Buffer, or NULL if out of buffers
+**                  *p_max_len is set to the maximum data length in buffer
+**
+*******************************************************************************/
+BT_HDR *NFA_P2pGetTxBuf (UINT16 *p_max_len)
+{
+    BT_HDR *p_buf;
+
+    P2P_TRACE_API0 ("NFA_P2pGetTxBuf ()");
+
+    if ((p_buf = nfa_p2p_get_tx_buf ()) != NULL)
+    {
+        if (p_max_len)
+            *p_max_len = GKI_get_buf_size (p_buf) - BT_HDR_SIZE - p_buf->offset;
+    }
+    else
+    {
+        P2P_TRACE_WARNING0 ("NFA_P2pGetTxBuf (): Out of buffer");
+
+        if (p_max_len)
+            *p_max_len = 0;
+    }
+
+    return (p_buf);
+}
+
+/*******************************************************************************
+**
+** Function         NFA_P2pFreeTxBuf
+**
+** Description      This function is called to free a buffer from
+**                  NFA_P2pGetTxBuf () which was not sent.
+**
+** Returns          None
+**
+*******************************************************************************/
+void NFA_P2pFreeTxBuf (BT_HDR *p_buf)
+{
+    P2P_TRACE_API0 ("NFA_P2pFreeTxBuf ()");
+
+    if (p_buf)
+        GKI_freebuf (p_buf);
+}
+
 /*******************************************************************************
 **
 ** Function         NFA_P2pSendUI
@@ -502,71 +807,69 @@ tNFA_STATUS NFA_P2pSendUI (tNFA_HANDLE handle,
                            UINT16      length,
                            UINT8      *p_data)
 {
-    tNFA_P2P_API_SEND_UI *p_msg;
-    tNFA_STATUS           ret_status = NFA_STATUS_FAILED;
-    tNFA_HANDLE           xx;
+    tNFA_P2P_DATA_SEG seg;
 
     P2P_TRACE_API3 ("NFA_P2pSendUI (): handle:0x%X, DSAP:0x%02X, length:%d", handle, dsap, length);
 
-    GKI_sched_lock ();
+    seg.p_data = p_data;
+    seg.len    = length;
 
-    xx = handle & NFA_HANDLE_MASK;
+    return (NFA_P2pSendUIVec (handle, dsap, 1, &seg));
+}
 
-    if (  (xx >= NFA_P2P_NUM_SAP)
-        ||(nfa_p2p_cb.sap_cb[xx].p_cback == NULL))
-    {
-        P2P_TRACE_ERROR1 ("NFA_P2pSendUI (): Handle (0x%X) is not valid", handle);
-        ret_status = NFA_STATUS_BAD_HANDLE;
-    }
-    else if (length > nfa_p2p_cb.remote_link_miu)
-    {
-        P2P_TRACE_ERROR3 ("NFA_P2pSendUI (): handle:0x%X, length(%d) must be less than remote link MIU(%d)",
-                           handle, length, nfa_p2p_cb.remote_link_miu);
-        ret_status = NFA_STATUS_BAD_LENGTH;
-    }
-    else if (nfa_p2p_cb.sap_cb[xx].flags & NFA_P2P_SAP_FLAG_LLINK_CONGESTED)
-    {
-        P2P_TRACE_WARNING1 ("NFA_P2pSendUI (): handle:0x%X, logical data link is already congested",
-                             handle);
-        ret_status = NFA_STATUS_CONGESTED;
-    }
-    else if (LLCP_IsLogicalLinkCongested ((UINT8)xx,
-                                          nfa_p2p_cb.sap_cb[xx].num_pending_ui_pdu,
-                                          nfa_p2p_cb.total_pending_ui_pdu,
-                                          nfa_p2p_cb.total_pending_i_pdu))
-    {
-        nfa_p2p_cb.sap_cb[xx].flags |= NFA_P2P_SAP_FLAG_LLINK_CONGESTED;
+/*******************************************************************************
+**
+** Function         NFA_P2pSendUIVec
+**
+** Description      This function is called to send data in segments on
+**                  connectionless transport. The segments are sent as one
+**                  UI PDU.
+**
+** Returns          NFA_STATUS_OK if successfully initiated
+**                  NFA_STATUS_BAD_HANDLE if handle is not valid
+**                  NFA_STATUS_BAD_LENGTH if data length is more than remote link MIU
+**                  NFA_STATUS_CONGESTED  if congested
+**                  NFA_STATUS_FAILED otherwise
+**
+*******************************************************************************/
+tNFA_STATUS NFA_P2pSendUIVec (tNFA_HANDLE        handle,
+                              UINT8              dsap,
+                              UINT8              num_segs,
+                              tNFA_P2P_DATA_SEG *p_segs)
+{
+    BT_HDR      *p_buf;
+    tNFA_STATUS ret_status;
+    UINT32      length;
 
-        P2P_TRACE_WARNING1 ("NFA_P2pSendUI(): handle:0x%X, logical data link is congested",
-                             handle);
-        ret_status = NFA_STATUS_CONGESTED;
-    }
-    else if ((p_msg = (tNFA_P2P_API_SEND_UI *) GKI_getbuf (sizeof(tNFA_P2P_API_SEND_UI))) != NULL)
-    {
-        p_msg->hdr.event = NFA_P2P_API_SEND_UI_EVT;
+    length = nfa_p2p_segs_len (num_segs, p_segs);
 
-        p_msg->handle  = handle;
-        p_msg->dsap    = dsap;
+    P2P_TRACE_API4 ("NFA_P2pSendUIVec (): handle:0x%X, DSAP:0x%02X, num_segs:%d, length:%d",
+                    handle, dsap, num_segs, (UINT16) length);
 
-        if ((p_msg->p_msg = (BT_HDR *) GKI_getpoolbuf (LLCP_POOL_ID)) != NULL)
-        {
-            p_msg->p_msg->len    = length;
-            p_msg->p_msg->offset = LLCP_MIN_OFFSET;
-            memcpy (((UINT8*) (p_msg->p_msg + 1) + p_msg->p_msg->offset), p_data, length);
+    if (length > 0xFFFF)
+    {
+        P2P_TRACE_ERROR1 ("NFA_P2pSendUIVec (): handle:0x%X, data too long", handle);
+        return (NFA_STATUS_BAD_LENGTH);
+    }
 
-            /* increase number of tx UI PDU which is not processed by NFA for congestion control */
-            nfa_p2p_cb.sap_cb[xx].num_pending_ui_pdu++;
-            nfa_p2p_cb.total_pending_ui_pdu++;
-            nfa_sys_sendmsg (p_msg);
+    GKI_sched_lock ();
 
-            ret_status = NFA_STATUS_OK;
+    if ((ret_status = nfa_p2p_check_send_ui (handle, (UINT16) length)) == NFA_STATUS_OK)
+    {
+        if ((p_buf = nfa_p2p_get_tx_buf ()) == NULL)
+        {
+            nfa_p2p_cb.sap_cb[handle & NFA_HANDLE_MASK].flags |= NFA_P2P_SAP_FLAG_LLINK_CONGESTED;
+            ret_status = NFA_STATUS_CONGESTED;
+        }
+        else if (!nfa_p2p_gather_segs (p_buf, num_segs, p_segs))
+        {
+            P2P_TRACE_ERROR1 ("NFA_P2pSendUIVec (): handle:0x%X, data does not fit in buffer", handle);
+            GKI_freebuf (p_buf);
+            ret_status = NFA_STATUS_BAD_LENGTH;
         }
         else
         {
-            GKI_freebuf (p_msg);
-
-            nfa_p2p_cb.sap_cb[xx].flags |= NFA_P2P_SAP_FLAG_LLINK_CONGESTED;
-            ret_status = NFA_STATUS_CONGESTED;
+            nfa_p2p_post_send_ui (handle, dsap, p_buf);
         }
     }
 
@@ -575,6 +878,49 @@ tNFA_STATUS NFA_P2pSendUI (tNFA_HANDLE handle,
     return (ret_status);
 }
 
+/*******************************************************************************
+**
+** Function         NFA_P2pSendUIBuf
+**
+** Description      This function is called to send data in a buffer from
+**                  NFA_P2pGetTxBuf () on connectionless transport.
+**
+**                  NFA takes the buffer if NFA_STATUS_OK is returned.
+**                  Otherwise the caller keeps it, to send it again later or
+**                  to free it with NFA_P2pFreeTxBuf ().
+**
+** Returns          NFA_STATUS_OK if successfully initiated
+**                  NFA_STATUS_BAD_HANDLE if handle is not valid
+**                  NFA_STATUS_BAD_LENGTH if data length is more than remote link MIU
+**                  NFA_STATUS_CONGESTED  if congested
+**                  NFA_STATUS_FAILED otherwise
+**
+*******************************************************************************/
+tNFA_STATUS NFA_P2pSendUIBuf (tNFA_HANDLE handle,
+                              UINT8       dsap,
+                              BT_HDR     *p_buf)
+{
+    tNFA_STATUS ret_status;
+
+    if (  (p_buf == NULL)
+        ||(p_buf->offset < NFA_P2P_TX_BUF_OFFSET)  )
+    {
+        P2P_TRACE_ERROR1 ("NFA_P2pSendUIBuf (): handle:0x%X, buffer is not from NFA_P2pGetTxBuf ()", handle);
+        return (NFA_STATUS_FAILED);
+    }
+
+    P2P_TRACE_API3 ("NFA_P2pSendUIBuf (): handle:0x%X, DSAP:0x%02X, length:%d", handle, dsap, p_buf->len);
+
+    GKI_sched_lock ();
+
+    if ((ret_status = nfa_p2p_check_send_ui (handle, p_buf->len)) == NFA_STATUS_OK)
+        nfa_p2p_post_send_ui (handle, dsap, p_buf);
+
+    GKI_sched_unlock ();
+
+    return (ret_status);
+}
+
 /*******************************************************************************
 **
 ** Function         NFA_P2pReadUI
@@ -688,77 +1034,72 @@ tNFA_STATUS NFA_P2pSendData (tNFA_HANDLE handle,
                              UINT16      length,
                              UINT8      *p_data)
 {
-    tNFA_P2P_API_SEND_DATA *p_msg;
-    tNFA_STATUS            ret_status = NFA_STATUS_FAILED;
-    tNFA_HANDLE            xx;
+    tNFA_P2P_DATA_SEG seg;
 
     P2P_TRACE_API2 ("NFA_P2pSendData (): handle:0x%X, length:%d", handle, length);
 
-    GKI_sched_lock ();
+    seg.p_data = p_data;
+    seg.len    = length;
 
-    xx = handle & NFA_HANDLE_MASK;
-    xx &= ~NFA_P2P_HANDLE_FLAG_CONN;
+    return (NFA_P2pSendDataVec (handle, 1, &seg));
+}
 
-    if (  (!(handle & NFA_P2P_HANDLE_FLAG_CONN))
-        ||(xx >= LLCP_MAX_DATA_LINK)
-        ||(nfa_p2p_cb.conn_cb[xx].flags == 0)  )
-    {
-        P2P_TRACE_ERROR1 ("NFA_P2pSendData (): Handle(0x%X) is not valid", handle);
-        ret_status = NFA_STATUS_BAD_HANDLE;
-    }
-    else if (nfa_p2p_cb.conn_cb[xx].flags & NFA_P2P_CONN_FLAG_REMOTE_RW_ZERO)
-    {
-        P2P_TRACE_ERROR1 ("NFA_P2pSendData (): handle:0x%X, Remote set RW to 0 (flow off)", handle);
-        ret_status = NFA_STATUS_FAILED;
-    }
-    else if (nfa_p2p_cb.conn_cb[xx].remote_miu < length)
-    {
-        P2P_TRACE_ERROR2 ("NFA_P2pSendData (): handle:0x%X, Data more than remote MIU(%d)",
-                           handle, nfa_p2p_cb.conn_cb[xx].remote_miu);
-        ret_status = NFA_STATUS_BAD_LENGTH;
-    }
-    else if (nfa_p2p_cb.conn_cb[xx].flags & NFA_P2P_CONN_FLAG_CONGESTED)
+/*******************************************************************************
+**
+** Function         NFA_P2pSendDataVec
+**
+** Description      This function is called to send data in segments on
+**                  connection-oriented transport. The segments are sent as
+**                  one I PDU.
+**
+** Returns          NFA_STATUS_OK if successfully initiated
+**                  NFA_STATUS_BAD_HANDLE if handle is not valid
+**                  NFA_STATUS_BAD_LENGTH if data length is more than remote MIU
+**                  NFA_STATUS_CONGESTED  if congested
+**                  NFA_STATUS_FAILED otherwise
+**
+*******************************************************************************/
+tNFA_STATUS NFA_P2pSendDataVec (tNFA_HANDLE        handle,
+                                UINT8              num_segs,
+                                tNFA_P2P_DATA_SEG *p_segs)
+{
+    BT_HDR      *p_buf;
+    tNFA_STATUS ret_status;
+    UINT32      length;
+    tNFA_HANDLE xx;
+
+    length = nfa_p2p_segs_len (num_segs, p_segs);
+
+    P2P_TRACE_API3 ("NFA_P2pSendDataVec (): handle:0x%X, num_segs:%d, length:%d",
+                    handle, num_segs, (UINT16) length);
+
+    if (length > 0xFFFF)
     {
-        P2P_TRACE_WARNING1 ("NFA_P2pSendData (): handle:0x%X, data link connection is already congested",
-                            handle);
-        ret_status = NFA_STATUS_CONGESTED;
+        P2P_TRACE_ERROR1 ("NFA_P2pSendDataVec (): handle:0x%X, data too long", handle);
+        return (NFA_STATUS_BAD_LENGTH);
     }
-    else if (LLCP_IsDataLinkCongested (nfa_p2p_cb.conn_cb[xx].local_sap,
-                                       nfa_p2p_cb.conn_cb[xx].remote_sap,
-                                       nfa_p2p_cb.conn_cb[xx].num_pending_i_pdu,
-                                       nfa_p2p_cb.total_pending_ui_pdu,
-                                       nfa_p2p_cb.total_pending_i_pdu))
-    {
-        nfa_p2p_cb.conn_cb[xx].flags |= NFA_P2P_CONN_FLAG_CONGESTED;
 
-        P2P_TRACE_WARNING1 ("NFA_P2pSendData (): handle:0x%X, data link connection is congested",
-                            handle);
-        ret_status = NFA_STATUS_CONGESTED;
-    }
-    else if ((p_msg = (tNFA_P2P_API_SEND_DATA *) GKI_getbuf (sizeof(tNFA_P2P_API_SEND_DATA))) != NULL)
-    {
-        p_msg->hdr.event = NFA_P2P_API_SEND_DATA_EVT;
+    GKI_sched_lock ();
 
-        p_msg->conn_handle  = handle;
+    if ((ret_status = nfa_p2p_check_send_data (handle, (UINT16) length)) == NFA_STATUS_OK)
+    {
+        xx = handle & NFA_HANDLE_MASK;
+        xx &= ~NFA_P2P_HANDLE_FLAG_CONN;
 
-        if ((p_msg->p_msg = (BT_HDR *) GKI_getpoolbuf (LLCP_POOL_ID)) != NULL)
+        if ((p_buf = nfa_p2p_get_tx_buf ()) == NULL)
         {
-            p_msg->p_msg->len    = length;
-            p_msg->p_msg->offset = LLCP_MIN_OFFSET;
-            memcpy (((UINT8*) (p_msg->p_msg + 1) + p_msg->p_msg->offset), p_data, length);
-
-            /* increase number of tx I PDU which is not processed by NFA for congestion control */
-            nfa_p2p_cb.conn_cb[xx].num_pending_i_pdu++;
-            nfa_p2p_cb.total_pending_i_pdu++;
-            nfa_sys_sendmsg (p_msg);
-
-            ret_status = NFA_STATUS_OK;
+            nfa_p2p_cb.conn_cb[xx].flags |= NFA_P2P_CONN_FLAG_CONGESTED;
+            ret_status = NFA_STATUS_CONGESTED;
+        }
+        else if (!nfa_p2p_gather_segs (p_buf, num_segs, p_segs))
+        {
+            P2P_TRACE_ERROR1 ("NFA_P2pSendDataVec (): handle:0x%X, data does not fit in buffer", handle);
+            GKI_freebuf (p_buf);
+            ret_status = NFA_STATUS_BAD_LENGTH;
         }
         else
         {
-            GKI_freebuf (p_msg);
-            nfa_p2p_cb.conn_cb[xx].flags |= NFA_P2P_CONN_FLAG_CONGESTED;
-            ret_status = NFA_STATUS_CONGESTED;
+            nfa_p2p_post_send_data (handle, p_buf);
         }
     }
 
@@ -767,6 +1108,48 @@ tNFA_STATUS NFA_P2pSendData (tNFA_HANDLE handle,
     return (ret_status);
 }
 
+/*******************************************************************************
+**
+** Function         NFA_P2pSendDataBuf
+**
+** Description      This function is called to send data in a buffer from
+**                  NFA_P2pGetTxBuf () on connection-oriented transport.
+**
+**                  NFA takes the buffer if NFA_STATUS_OK is returned.
+**                  Otherwise the caller keeps it, to send it again later or
+**                  to free it with NFA_P2pFreeTxBuf ().
+**
+** Returns          NFA_STATUS_OK if successfully initiated
+**                  NFA_STATUS_BAD_HANDLE if handle is not valid
+**                  NFA_STATUS_BAD_LENGTH if data length is more than remote MIU
+**                  NFA_STATUS_CONGESTED  if congested
+**                  NFA_STATUS_FAILED otherwise
+**
+*******************************************************************************/
+tNFA_STATUS NFA_P2pSendDataBuf (tNFA_HANDLE handle,
+                                BT_HDR     *p_buf)
+{
+    tNFA_STATUS ret_status;
+
+    if (  (p_buf == NULL)
+        ||(p_buf->offset < NFA_P2P_TX_BUF_OFFSET)  )
+    {
+        P2P_TRACE_ERROR1 ("NFA_P2pSendDataBuf (): handle:0x%X, buffer is not from NFA_P2pGetTxBuf ()", handle);
+        return (NFA_STATUS_FAILED);
+    }
+
+    P2P_TRACE_API2 ("NFA_P2pSendDataBuf (): handle:0x%X, length:%d", handle, p_buf->len);
+
+    GKI_sched_lock ();
+
+    if ((ret_status = nfa_p2p_check_send_data (handle, p_buf->len)) == NFA_STATUS_OK)
+        nfa_p2p_post_send_data (handle, p_buf);
+
+    GKI_sched_unlock ();
+
+    return (ret_status);
+}
+
 /*******************************************************************************
 **
 ** Function         NFA_P2pReadData
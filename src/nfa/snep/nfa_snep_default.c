@@ -0,0 +1,278 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2015 Broadcom Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  This is the implementation file for the NFA SNEP default server.
+ *
+ *  NDEF messages from PUT requests are passed to the NDEF handlers of NFA DM,
+ *  the same way as NDEF messages read from a tag.
+ *
+ ******************************************************************************/
+#include <string.h>
+#include "nfc_api.h"
+#include "nfa_sys.h"
+#include "nfa_sys_int.h"
+#include "llcp_api.h"
+#include "llcp_defs.h"
+#include "nfa_dm_int.h"
+#include "nfa_mem_co.h"
+#include "nfa_snep_api.h"
+#include "nfa_snep_int.h"
+
+#if (defined (NFA_SNEP_INCLUDED) && (NFA_SNEP_INCLUDED==TRUE))
+
+/*****************************************************************************
+**  Global Variables
+*****************************************************************************/
+
+/* system manager control block definition */
+#if NFA_DYNAMIC_MEMORY == FALSE
+tNFA_SNEP_DEFAULT_CB nfa_snep_default_cb;
+#endif
+
+/*****************************************************************************
+**  Static Functions
+*****************************************************************************/
+static void nfa_snep_default_service_cback (tNFA_SNEP_EVT event, tNFA_SNEP_EVT_DATA *p_eventData);
+
+/*****************************************************************************
+**  Constants
+*****************************************************************************/
+#define NFA_SNEP_DEFAULT_SERVER_SN      "urn:nfc:sn:snep"
+
+/*******************************************************************************
+**
+** Function         nfa_snep_default_init
+**
+** Description      Initialize NFA SNEP default server
+**
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfa_snep_default_init (void)
+{
+    UINT8 xx;
+
+    SNEP_TRACE_DEBUG0 ("nfa_snep_default_init ()");
+
+    nfa_snep_default_cb.server_handle = NFA_HANDLE_INVALID;
+
+    for (xx = 0; xx < NFA_SNEP_DEFAULT_MAX_CONN; xx++)
+    {
+        nfa_snep_default_cb.conn[xx].conn_handle = NFA_HANDLE_INVALID;
+        nfa_snep_default_cb.conn[xx].p_rx_ndef   = NULL;
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_default_find_conn
+**
+** Description      Find connection of default server
+**
+**
+** Returns          index of connection, NFA_SNEP_DEFAULT_MAX_CONN if not found
+**
+*******************************************************************************/
+static UINT8 nfa_snep_default_find_conn (tNFA_HANDLE conn_handle)
+{
+    UINT8 xx;
+
+    for (xx = 0; xx < NFA_SNEP_DEFAULT_MAX_CONN; xx++)
+    {
+        if (nfa_snep_default_cb.conn[xx].conn_handle == conn_handle)
+        {
+            return (xx);
+        }
+    }
+
+    return NFA_SNEP_DEFAULT_MAX_CONN;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_default_service_cback
+**
+** Description      Processing event for SNEP default server
+**
+**
+** Returns          None
+**
+*******************************************************************************/
+static void nfa_snep_default_service_cback (tNFA_SNEP_EVT event, tNFA_SNEP_EVT_DATA *p_eventData)
+{
+    tNFA_SNEP_MSG msg;
+    UINT8         xx;
+
+    SNEP_TRACE_DEBUG1 ("nfa_snep_default_service_cback () event:0x%X", event);
+
+    switch (event)
+    {
+    case NFA_SNEP_REG_EVT:
+        if (p_eventData->reg.status == NFA_STATUS_OK)
+        {
+            nfa_snep_default_cb.server_handle = p_eventData->reg.reg_handle;
+        }
+        else
+        {
+            SNEP_TRACE_ERROR0 ("Failed to register default server");
+        }
+        break;
+
+    case NFA_SNEP_CONNECTED_EVT:
+        xx = nfa_snep_default_find_conn (NFA_HANDLE_INVALID);
+
+        if (xx < NFA_SNEP_DEFAULT_MAX_CONN)
+        {
+            nfa_snep_default_cb.conn[xx].conn_handle = p_eventData->connect.conn_handle;
+        }
+        else
+        {
+            SNEP_TRACE_ERROR0 ("Too many connections for default server");
+
+            msg.api_disc.conn_handle = p_eventData->connect.conn_handle;
+            msg.api_disc.flush       = TRUE;
+            nfa_snep_disconnect (&msg);
+        }
+        break;
+
+    case NFA_SNEP_ALLOC_BUFF_EVT:
+        if (p_eventData->alloc.req_code == NFA_SNEP_REQ_CODE_GET)
+        {
+            /* default server doesn't support GET */
+            p_eventData->alloc.resp_code = NFA_SNEP_RESP_CODE_NOT_IMPLM;
+        }
+        else if (p_eventData->alloc.ndef_length > NFA_SNEP_DEFAULT_SERVER_MAX_NDEF_SIZE)
+        {
+            SNEP_TRACE_ERROR2 ("NDEF message length (%d) exceeds max size (%d)",
+                               p_eventData->alloc.ndef_length, NFA_SNEP_DEFAULT_SERVER_MAX_NDEF_SIZE);
+
+            p_eventData->alloc.resp_code = NFA_SNEP_RESP_CODE_EXCESS_DATA;
+        }
+        else if ((xx = nfa_snep_default_find_conn (p_eventData->alloc.conn_handle)) < NFA_SNEP_DEFAULT_MAX_CONN)
+        {
+            p_eventData->alloc.p_buff = (UINT8 *) nfa_mem_co_alloc (p_eventData->alloc.ndef_length);
+            nfa_snep_default_cb.conn[xx].p_rx_ndef = p_eventData->alloc.p_buff;
+        }
+        break;
+
+    case NFA_SNEP_PUT_REQ_EVT:
+        nfa_dm_ndef_handle_message (NFA_STATUS_OK,
+                                    p_eventData->put_req.p_ndef,
+                                    p_eventData->put_req.ndef_length);
+
+        nfa_mem_co_free (p_eventData->put_req.p_ndef);
+
+        xx = nfa_snep_default_find_conn (p_eventData->put_req.conn_handle);
+        if (xx < NFA_SNEP_DEFAULT_MAX_CONN)
+            nfa_snep_default_cb.conn[xx].p_rx_ndef = NULL;
+
+        msg.api_put_resp.conn_handle = p_eventData->put_req.conn_handle;
+        msg.api_put_resp.resp_code   = NFA_SNEP_RESP_CODE_SUCCESS;
+        nfa_snep_put_resp (&msg);
+        break;
+
+    case NFA_SNEP_FREE_BUFF_EVT:
+        nfa_mem_co_free (p_eventData->free.p_buff);
+
+        xx = nfa_snep_default_find_conn (p_eventData->free.conn_handle);
+        if (xx < NFA_SNEP_DEFAULT_MAX_CONN)
+            nfa_snep_default_cb.conn[xx].p_rx_ndef = NULL;
+        break;
+
+    case NFA_SNEP_DISC_EVT:
+        xx = nfa_snep_default_find_conn (p_eventData->disc.conn_handle);
+        if (xx < NFA_SNEP_DEFAULT_MAX_CONN)
+        {
+            nfa_snep_default_cb.conn[xx].conn_handle = NFA_HANDLE_INVALID;
+            nfa_snep_default_cb.conn[xx].p_rx_ndef   = NULL;
+        }
+        break;
+
+    default:
+        SNEP_TRACE_ERROR0 ("Unexpected event for default server");
+        break;
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_start_default_server
+**
+** Description      Launching SNEP default server
+**
+**
+** Returns          TRUE to deallocate message
+**
+*******************************************************************************/
+BOOLEAN nfa_snep_start_default_server (tNFA_SNEP_MSG *p_msg)
+{
+    tNFA_SNEP_MSG msg;
+
+    SNEP_TRACE_DEBUG0 ("nfa_snep_start_default_server ()");
+
+    if (nfa_snep_default_cb.server_handle == NFA_HANDLE_INVALID)
+    {
+        msg.api_reg_server.server_sap = NFA_SNEP_DEFAULT_SERVER_SAP;
+        BCM_STRNCPY_S (msg.api_reg_server.service_name, sizeof (msg.api_reg_server.service_name),
+                       NFA_SNEP_DEFAULT_SERVER_SN, LLCP_MAX_SN_LEN);
+        msg.api_reg_server.service_name[LLCP_MAX_SN_LEN] = 0;
+        msg.api_reg_server.p_cback = nfa_snep_default_service_cback;
+
+        /* NFA_SNEP_REG_EVT is returned synchronously */
+        nfa_snep_reg_server (&msg);
+    }
+
+    p_msg->api_start_default_server.p_cback (NFA_SNEP_DEFAULT_SERVER_STARTED_EVT, NULL);
+
+    return TRUE;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_stop_default_server
+**
+** Description      Stoppping SNEP default server
+**
+**
+** Returns          TRUE to deallocate message
+**
+*******************************************************************************/
+BOOLEAN nfa_snep_stop_default_server (tNFA_SNEP_MSG *p_msg)
+{
+    tNFA_SNEP_MSG msg;
+
+    SNEP_TRACE_DEBUG0 ("nfa_snep_stop_default_server ()");
+
+    if (nfa_snep_default_cb.server_handle != NFA_HANDLE_INVALID)
+    {
+        /* connections are closed and buffers are freed through callback */
+        msg.api_dereg.reg_handle = nfa_snep_default_cb.server_handle;
+        nfa_snep_dereg (&msg);
+
+        nfa_snep_default_init ();
+    }
+
+    p_msg->api_stop_default_server.p_cback (NFA_SNEP_DEFAULT_SERVER_STOPPED_EVT, NULL);
+
+    return TRUE;
+}
+
+#endif /* (defined (NFA_SNEP_INCLUDED) && (NFA_SNEP_INCLUDED==TRUE)) */
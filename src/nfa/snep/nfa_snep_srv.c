@@ -0,0 +1,1751 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2015 Broadcom Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  This is the implementation file for the NFA SNEP server and client.
+ *
+ *  SNEP messages are exchanged on LLCP data link connections. An outgoing
+ *  message is sent from the NDEF buffer of the application in fragments of
+ *  the data link MIU, and an incoming message is reassembled directly into
+ *  one NDEF buffer, so the application sees complete messages only.
+ *
+ ******************************************************************************/
+#include <string.h>
+#include "nfc_api.h"
+#include "nfa_sys.h"
+#include "nfa_sys_int.h"
+#include "llcp_api.h"
+#include "llcp_defs.h"
+#include "nfa_p2p_int.h"
+#include "nfa_snep_api.h"
+#include "nfa_snep_int.h"
+
+#if (defined (NFA_SNEP_INCLUDED) && (NFA_SNEP_INCLUDED==TRUE))
+
+/*****************************************************************************
+**  Global Variables
+*****************************************************************************/
+
+/*****************************************************************************
+**  Static Functions
+*****************************************************************************/
+static void nfa_snep_timer_cback (void *p_tle);
+static void nfa_snep_send_remaining (UINT8 dlink);
+static void nfa_snep_close_conn (UINT8 dlink);
+
+/*****************************************************************************
+**  Constants
+*****************************************************************************/
+
+/*******************************************************************************
+**
+** Function         nfa_snep_allocate_cb
+**
+** Description      Allocate server/client/data link connection control block
+**
+**
+** Returns          index of control block, NFA_SNEP_MAX_CONN if no resource
+**
+*******************************************************************************/
+UINT8 nfa_snep_allocate_cb (void)
+{
+    UINT8 xx;
+
+    for (xx = 0; xx < NFA_SNEP_MAX_CONN; xx++)
+    {
+        if (nfa_snep_cb.conn[xx].local_sap == LLCP_INVALID_SAP)
+        {
+            memset (&nfa_snep_cb.conn[xx], 0, sizeof (tNFA_SNEP_CONN));
+            nfa_snep_cb.conn[xx].remote_sap = LLCP_INVALID_SAP;
+            return (xx);
+        }
+    }
+
+    SNEP_TRACE_ERROR0 ("nfa_snep_allocate_cb (): No resource");
+
+    return NFA_SNEP_MAX_CONN;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_deallocate_cb
+**
+** Description      Deallocate server/client/data link connection control block.
+**                  A buffer given by server application for a request being
+**                  received is returned with NFA_SNEP_FREE_BUFF_EVT.
+**
+** Returns          void
+**
+*******************************************************************************/
+void nfa_snep_deallocate_cb (UINT8 xx)
+{
+    tNFA_SNEP_CONN     *p_conn;
+    tNFA_SNEP_CBACK    *p_cback;
+    tNFA_SNEP_EVT_DATA  evt_data;
+
+    if (xx >= NFA_SNEP_MAX_CONN)
+    {
+        SNEP_TRACE_ERROR1 ("nfa_snep_deallocate_cb (): Invalid index (%d)", xx);
+        return;
+    }
+
+    p_conn  = &nfa_snep_cb.conn[xx];
+    p_cback = p_conn->p_cback;
+
+    nfa_sys_stop_timer (&p_conn->timer);
+
+    evt_data.free.conn_handle = (NFA_HANDLE_GROUP_SNEP | xx);
+    evt_data.free.p_buff      = NULL;
+
+    if (  (p_conn->flags & NFA_SNEP_FLAG_SERVER)
+        &&(p_conn->rx_fragments)  )
+    {
+        evt_data.free.p_buff = p_conn->p_ndef_buff;
+    }
+
+    memset (p_conn, 0, sizeof (tNFA_SNEP_CONN));
+    p_conn->local_sap  = LLCP_INVALID_SAP;
+    p_conn->remote_sap = LLCP_INVALID_SAP;
+
+    if ((evt_data.free.p_buff) && (p_cback))
+    {
+        p_cback (NFA_SNEP_FREE_BUFF_EVT, &evt_data);
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_find_dlink
+**
+** Description      Find data link connection control block by local/remote SAP
+**
+**
+** Returns          index of control block, NFA_SNEP_MAX_CONN if not found
+**
+*******************************************************************************/
+static UINT8 nfa_snep_find_dlink (UINT8 local_sap, UINT8 remote_sap)
+{
+    UINT8 xx;
+
+    for (xx = 0; xx < NFA_SNEP_MAX_CONN; xx++)
+    {
+        if (  (nfa_snep_cb.conn[xx].flags & (NFA_SNEP_FLAG_CONNECTING|NFA_SNEP_FLAG_CONNECTED))
+            &&(nfa_snep_cb.conn[xx].local_sap  == local_sap)
+            &&(nfa_snep_cb.conn[xx].remote_sap == remote_sap)  )
+        {
+            return (xx);
+        }
+    }
+
+    return NFA_SNEP_MAX_CONN;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_find_reg
+**
+** Description      Find registered server or client control block by local SAP
+**
+**
+** Returns          index of control block, NFA_SNEP_MAX_CONN if not found
+**
+*******************************************************************************/
+static UINT8 nfa_snep_find_reg (UINT8 local_sap)
+{
+    UINT8 xx;
+
+    for (xx = 0; xx < NFA_SNEP_MAX_CONN; xx++)
+    {
+        if (  (nfa_snep_cb.conn[xx].local_sap == local_sap)
+            &&(  (nfa_snep_cb.conn[xx].flags & NFA_SNEP_FLAG_CLIENT)
+               ||(nfa_snep_cb.conn[xx].flags == NFA_SNEP_FLAG_SERVER)  )  )
+        {
+            return (xx);
+        }
+    }
+
+    return NFA_SNEP_MAX_CONN;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_close_conn
+**
+** Description      Clean up data link connection and notify NFA_SNEP_DISC_EVT.
+**                  Control block of server is deallocated, client goes back
+**                  to registered state.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_snep_close_conn (UINT8 dlink)
+{
+    tNFA_SNEP_CONN     *p_conn = &nfa_snep_cb.conn[dlink];
+    tNFA_SNEP_CBACK    *p_cback;
+    tNFA_SNEP_EVT_DATA  evt_data;
+    UINT8               local_sap;
+
+    SNEP_TRACE_DEBUG1 ("nfa_snep_close_conn (): dlink:%d", dlink);
+
+    p_cback = p_conn->p_cback;
+    evt_data.disc.conn_handle = (NFA_HANDLE_GROUP_SNEP | dlink);
+
+    if (p_conn->flags & NFA_SNEP_FLAG_SERVER)
+    {
+        nfa_snep_deallocate_cb (dlink);
+    }
+    else
+    {
+        /* buffers of client belong to application, keep registration */
+        nfa_sys_stop_timer (&p_conn->timer);
+
+        local_sap = p_conn->local_sap;
+        memset (p_conn, 0, sizeof (tNFA_SNEP_CONN));
+
+        p_conn->local_sap  = local_sap;
+        p_conn->remote_sap = LLCP_INVALID_SAP;
+        p_conn->flags      = NFA_SNEP_FLAG_CLIENT;
+        p_conn->p_cback    = p_cback;
+    }
+
+    if (p_cback)
+        p_cback (NFA_SNEP_DISC_EVT, &evt_data);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_abort_conn
+**
+** Description      Disconnect data link connection and clean up
+**
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_snep_abort_conn (UINT8 dlink)
+{
+    LLCP_DisconnectReq (nfa_snep_cb.conn[dlink].local_sap,
+                        nfa_snep_cb.conn[dlink].remote_sap, TRUE);
+    nfa_snep_close_conn (dlink);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_timer_cback
+**
+** Description      Process timeout of client waiting for response
+**
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_snep_timer_cback (void *p_tle)
+{
+    UINT8 dlink = (UINT8) ((TIMER_LIST_ENT *) p_tle)->param;
+
+    SNEP_TRACE_ERROR1 ("nfa_snep_timer_cback (): No response from server, dlink:%d", dlink);
+
+    /* application will get NFA_SNEP_DISC_EVT */
+    nfa_snep_abort_conn (dlink);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_start_timer
+**
+** Description      Start or restart timer for client waiting for response,
+**                  continue or remaining fragments of response from server
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_snep_start_timer (UINT8 dlink)
+{
+    tNFA_SNEP_CONN *p_conn = &nfa_snep_cb.conn[dlink];
+
+    p_conn->timer.p_cback = nfa_snep_timer_cback;
+    p_conn->timer.param   = (TIMER_PARAM_TYPE) dlink;
+
+    nfa_sys_start_timer (&p_conn->timer, 0, NFA_SNEP_CLIENT_TIMEOUT);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_get_tx_miu
+**
+** Description      Get MIU for sending SNEP fragments, limited by the size
+**                  of buffer in LLCP pool
+**
+** Returns          MIU
+**
+*******************************************************************************/
+static UINT16 nfa_snep_get_tx_miu (UINT16 remote_miu)
+{
+    UINT16 buff_size;
+
+    buff_size = GKI_get_pool_bufsize (LLCP_POOL_ID) - BT_HDR_SIZE - LLCP_MIN_OFFSET;
+
+    return ((remote_miu < buff_size) ? remote_miu : buff_size);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_proc_tx_done
+**
+** Description      All of request/response has been passed to LLCP.
+**                  Client starts timer for response from server.
+**                  Server asks LLCP to notify when GET response is sent.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_snep_proc_tx_done (UINT8 dlink)
+{
+    tNFA_SNEP_CONN *p_conn = &nfa_snep_cb.conn[dlink];
+
+    if (  (p_conn->flags & NFA_SNEP_FLAG_CLIENT)
+        &&(p_conn->flags & NFA_SNEP_FLAG_W4_RESP)  )
+    {
+        nfa_snep_start_timer (dlink);
+    }
+
+    if (p_conn->flags & NFA_SNEP_FLAG_W4_TX_CMPL)
+    {
+        LLCP_SetTxCompleteNtf (p_conn->local_sap, p_conn->remote_sap);
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_send_msg
+**
+** Description      Send SNEP request or response with the first fragment of
+**                  NDEF message, if any.
+**                  Client sends NDEF message with GET/PUT request, server
+**                  sends NDEF message with SUCCESS response.
+**
+** Returns          FALSE if failed to send
+**
+*******************************************************************************/
+BOOLEAN nfa_snep_send_msg (UINT8 opcode, UINT8 dlink)
+{
+    tNFA_SNEP_CONN *p_conn = &nfa_snep_cb.conn[dlink];
+    BT_HDR         *p_msg;
+    UINT8          *p, *p_start;
+    UINT32          length, data_len = 0;
+    BOOLEAN         with_ndef;
+    tLLCP_STATUS    status;
+
+    SNEP_TRACE_DEBUG2 ("nfa_snep_send_msg (): opcode:0x%02X, dlink:%d", opcode, dlink);
+
+    if (p_conn->flags & NFA_SNEP_FLAG_CLIENT)
+    {
+        with_ndef = ((opcode == NFA_SNEP_REQ_CODE_GET) || (opcode == NFA_SNEP_REQ_CODE_PUT));
+    }
+    else
+    {
+        with_ndef = (opcode == NFA_SNEP_RESP_CODE_SUCCESS);
+    }
+
+    if ((p_msg = (BT_HDR *) GKI_getpoolbuf (LLCP_POOL_ID)) == NULL)
+    {
+        SNEP_TRACE_ERROR0 ("nfa_snep_send_msg (): Out of buffer");
+        return FALSE;
+    }
+
+    p_msg->offset = LLCP_MIN_OFFSET;
+    p_start = p = (UINT8 *) (p_msg + 1) + p_msg->offset;
+
+    UINT8_TO_BE_STREAM (p, NFA_SNEP_VERSION);
+    UINT8_TO_BE_STREAM (p, opcode);
+
+    if (with_ndef)
+    {
+        length = p_conn->ndef_length;
+
+        if (opcode == NFA_SNEP_REQ_CODE_GET)
+        {
+            length += NFA_SNEP_ACCEPT_LEN_SIZE;
+            UINT32_TO_BE_STREAM (p, length);
+            UINT32_TO_BE_STREAM (p, p_conn->buff_length);
+        }
+        else
+        {
+            UINT32_TO_BE_STREAM (p, length);
+        }
+
+        /* put as much of NDEF message as data link MIU allows */
+        data_len = p_conn->tx_miu - (UINT16) (p - p_start);
+        if (data_len > p_conn->ndef_length)
+            data_len = p_conn->ndef_length;
+
+        if (data_len)
+            memcpy (p, p_conn->p_ndef_buff, data_len);
+
+        p += data_len;
+    }
+    else
+    {
+        UINT32_TO_BE_STREAM (p, 0);
+    }
+
+    p_msg->len = (UINT16) (p - p_start);
+
+    if (with_ndef)
+        p_conn->cur_length = data_len;
+
+    status = LLCP_SendData (p_conn->local_sap, p_conn->remote_sap, p_msg);
+
+    if (status == LLCP_STATUS_FAIL)
+    {
+        SNEP_TRACE_ERROR0 ("nfa_snep_send_msg (): LLCP_SendData () failed");
+        return FALSE;
+    }
+    else if (status == LLCP_STATUS_CONGESTED)
+    {
+        p_conn->congest = TRUE;
+    }
+
+    return TRUE;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_send_remaining
+**
+** Description      Send remaining fragments of NDEF message until data link
+**                  is congested.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_snep_send_remaining (UINT8 dlink)
+{
+    tNFA_SNEP_CONN *p_conn = &nfa_snep_cb.conn[dlink];
+    BT_HDR         *p_msg;
+    UINT32          data_len;
+    tLLCP_STATUS    status;
+
+    SNEP_TRACE_DEBUG3 ("nfa_snep_send_remaining (): dlink:%d, cur_length:%d, ndef_length:%d",
+                       dlink, p_conn->cur_length, p_conn->ndef_length);
+
+    while (  (p_conn->cur_length < p_conn->ndef_length)
+           &&(!p_conn->congest)  )
+    {
+        if ((p_msg = (BT_HDR *) GKI_getpoolbuf (LLCP_POOL_ID)) == NULL)
+        {
+            /* try again when LLCP has sent queued PDUs */
+            SNEP_TRACE_WARNING0 ("nfa_snep_send_remaining (): Out of buffer");
+            LLCP_SetTxCompleteNtf (p_conn->local_sap, p_conn->remote_sap);
+            return;
+        }
+
+        data_len = p_conn->ndef_length - p_conn->cur_length;
+        if (data_len > p_conn->tx_miu)
+            data_len = p_conn->tx_miu;
+
+        p_msg->offset = LLCP_MIN_OFFSET;
+        p_msg->len    = (UINT16) data_len;
+        memcpy ((UINT8 *) (p_msg + 1) + p_msg->offset,
+                p_conn->p_ndef_buff + p_conn->cur_length, data_len);
+
+        p_conn->cur_length += data_len;
+
+        status = LLCP_SendData (p_conn->local_sap, p_conn->remote_sap, p_msg);
+
+        if (status == LLCP_STATUS_FAIL)
+        {
+            /* data link is being disconnected */
+            SNEP_TRACE_ERROR0 ("nfa_snep_send_remaining (): LLCP_SendData () failed");
+            return;
+        }
+        else if (status == LLCP_STATUS_CONGESTED)
+        {
+            p_conn->congest = TRUE;
+        }
+    }
+
+    if (p_conn->cur_length >= p_conn->ndef_length)
+    {
+        nfa_snep_proc_tx_done (dlink);
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_send_first
+**
+** Description      Send request/response with the first fragment, and wait
+**                  for continue from peer if NDEF message doesn't fit.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_snep_send_first (UINT8 opcode, UINT8 dlink)
+{
+    tNFA_SNEP_CONN *p_conn = &nfa_snep_cb.conn[dlink];
+
+    if (!nfa_snep_send_msg (opcode, dlink))
+    {
+        /* application will get NFA_SNEP_DISC_EVT */
+        nfa_snep_abort_conn (dlink);
+        return;
+    }
+
+    if (p_conn->cur_length < p_conn->ndef_length)
+    {
+        if (p_conn->flags & NFA_SNEP_FLAG_CLIENT)
+        {
+            p_conn->flags |= NFA_SNEP_FLAG_W4_RESP_CONTINUE;
+            nfa_snep_start_timer (dlink);
+        }
+        else
+        {
+            p_conn->flags |= NFA_SNEP_FLAG_W4_REQ_CONTINUE;
+        }
+    }
+    else
+    {
+        nfa_snep_proc_tx_done (dlink);
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_notify_resp
+**
+** Description      Notify response from server to client application
+**
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_snep_notify_resp (UINT8 dlink, UINT8 resp_code)
+{
+    tNFA_SNEP_CONN     *p_conn = &nfa_snep_cb.conn[dlink];
+    tNFA_SNEP_EVT_DATA  evt_data;
+
+    SNEP_TRACE_DEBUG2 ("nfa_snep_notify_resp (): dlink:%d, resp_code:0x%02X", dlink, resp_code);
+
+    nfa_sys_stop_timer (&p_conn->timer);
+    p_conn->flags &= ~(NFA_SNEP_FLAG_W4_RESP|NFA_SNEP_FLAG_W4_RESP_CONTINUE);
+
+    if (p_conn->tx_code == NFA_SNEP_REQ_CODE_GET)
+    {
+        evt_data.get_resp.conn_handle = (NFA_HANDLE_GROUP_SNEP | dlink);
+        evt_data.get_resp.resp_code   = resp_code;
+        evt_data.get_resp.ndef_length = (resp_code == NFA_SNEP_RESP_CODE_SUCCESS) ? p_conn->ndef_length : 0;
+        evt_data.get_resp.p_ndef      = p_conn->p_ndef_buff;
+    }
+    else
+    {
+        evt_data.put_resp.conn_handle = (NFA_HANDLE_GROUP_SNEP | dlink);
+        evt_data.put_resp.resp_code   = resp_code;
+    }
+
+    p_conn->rx_code     = resp_code;
+    p_conn->p_ndef_buff = NULL;
+    p_conn->ndef_length = 0;
+    p_conn->cur_length  = 0;
+
+    p_conn->p_cback ((p_conn->tx_code == NFA_SNEP_REQ_CODE_GET) ? NFA_SNEP_GET_RESP_EVT : NFA_SNEP_PUT_RESP_EVT,
+                     &evt_data);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_proc_rx_complete
+**
+** Description      Complete NDEF message has been received in buffer
+**
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_snep_proc_rx_complete (UINT8 dlink)
+{
+    tNFA_SNEP_CONN     *p_conn = &nfa_snep_cb.conn[dlink];
+    tNFA_SNEP_EVT_DATA  evt_data;
+
+    SNEP_TRACE_DEBUG2 ("nfa_snep_proc_rx_complete (): dlink:%d, ndef_length:%d",
+                       dlink, p_conn->ndef_length);
+
+    p_conn->rx_fragments = FALSE;
+
+    if (p_conn->flags & NFA_SNEP_FLAG_CLIENT)
+    {
+        nfa_snep_notify_resp (dlink, NFA_SNEP_RESP_CODE_SUCCESS);
+        return;
+    }
+
+    /* buffer is handed over to server application until it responds */
+    p_conn->flags |= NFA_SNEP_FLAG_W4_RESP;
+
+    if (p_conn->rx_code == NFA_SNEP_REQ_CODE_GET)
+    {
+        evt_data.get_req.conn_handle       = (NFA_HANDLE_GROUP_SNEP | dlink);
+        evt_data.get_req.acceptable_length = p_conn->acceptable_length;
+        evt_data.get_req.ndef_length       = p_conn->ndef_length;
+        evt_data.get_req.p_ndef            = p_conn->p_ndef_buff;
+
+        p_conn->p_ndef_buff = NULL;
+        p_conn->p_cback (NFA_SNEP_GET_REQ_EVT, &evt_data);
+    }
+    else
+    {
+        evt_data.put_req.conn_handle = (NFA_HANDLE_GROUP_SNEP | dlink);
+        evt_data.put_req.ndef_length = p_conn->ndef_length;
+        evt_data.put_req.p_ndef      = p_conn->p_ndef_buff;
+
+        p_conn->p_ndef_buff = NULL;
+        p_conn->p_cback (NFA_SNEP_PUT_REQ_EVT, &evt_data);
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_proc_rx_request
+**
+** Description      Process header of request received by server
+**
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_snep_proc_rx_request (UINT8 dlink)
+{
+    tNFA_SNEP_CONN     *p_conn = &nfa_snep_cb.conn[dlink];
+    tNFA_SNEP_EVT_DATA  evt_data;
+    UINT8               version, opcode, *p;
+    UINT32              length, acceptable_length = 0;
+
+    p = p_conn->rx_hdr;
+    BE_STREAM_TO_UINT8 (version, p);
+    BE_STREAM_TO_UINT8 (opcode, p);
+    BE_STREAM_TO_UINT32 (length, p);
+
+    p_conn->rx_hdr_len = 0;
+
+    SNEP_TRACE_DEBUG4 ("nfa_snep_proc_rx_request (): dlink:%d, version:0x%02X, opcode:0x%02X, length:%d",
+                       dlink, version, opcode, length);
+
+    if ((version & NFA_SNEP_VERSION_MAJOR_MASK) != (NFA_SNEP_VERSION & NFA_SNEP_VERSION_MAJOR_MASK))
+    {
+        LLCP_FlushDataLinkRxData (p_conn->local_sap, p_conn->remote_sap);
+        if (!nfa_snep_send_msg (NFA_SNEP_RESP_CODE_UNSUPP_VER, dlink))
+            nfa_snep_abort_conn (dlink);
+        return;
+    }
+
+    /* client decides whether server sends remaining fragments of GET response */
+    if (p_conn->flags & NFA_SNEP_FLAG_W4_REQ_CONTINUE)
+    {
+        LLCP_FlushDataLinkRxData (p_conn->local_sap, p_conn->remote_sap);
+        p_conn->flags &= ~NFA_SNEP_FLAG_W4_REQ_CONTINUE;
+
+        if (opcode == NFA_SNEP_REQ_CODE_CONTINUE)
+        {
+            nfa_snep_send_remaining (dlink);
+        }
+        else
+        {
+            p_conn->cur_length = p_conn->ndef_length;
+            nfa_snep_proc_tx_done (dlink);
+        }
+        return;
+    }
+
+    if (p_conn->flags & (NFA_SNEP_FLAG_W4_RESP|NFA_SNEP_FLAG_W4_TX_CMPL))
+    {
+        SNEP_TRACE_ERROR0 ("nfa_snep_proc_rx_request (): Previous request is not completed");
+        LLCP_FlushDataLinkRxData (p_conn->local_sap, p_conn->remote_sap);
+        return;
+    }
+
+    switch (opcode)
+    {
+    case NFA_SNEP_REQ_CODE_GET:
+        if (length < NFA_SNEP_ACCEPT_LEN_SIZE)
+        {
+            LLCP_FlushDataLinkRxData (p_conn->local_sap, p_conn->remote_sap);
+            if (!nfa_snep_send_msg (NFA_SNEP_RESP_CODE_BAD_REQ, dlink))
+                nfa_snep_abort_conn (dlink);
+            return;
+        }
+        BE_STREAM_TO_UINT32 (acceptable_length, p);
+        length -= NFA_SNEP_ACCEPT_LEN_SIZE;
+        evt_data.alloc.resp_code = NFA_SNEP_RESP_CODE_NOT_FOUND;
+        break;
+
+    case NFA_SNEP_REQ_CODE_PUT:
+        evt_data.alloc.resp_code = NFA_SNEP_RESP_CODE_REJECT;
+        break;
+
+    default:
+        LLCP_FlushDataLinkRxData (p_conn->local_sap, p_conn->remote_sap);
+        if (  (opcode == NFA_SNEP_REQ_CODE_CONTINUE)
+            ||(opcode == NFA_SNEP_REQ_CODE_REJECT)  )
+        {
+            /* not expected while no response is being sent */
+            opcode = NFA_SNEP_RESP_CODE_BAD_REQ;
+        }
+        else
+        {
+            opcode = NFA_SNEP_RESP_CODE_NOT_IMPLM;
+        }
+        if (!nfa_snep_send_msg (opcode, dlink))
+            nfa_snep_abort_conn (dlink);
+        return;
+    }
+
+    /* ask server application for a buffer to reassemble NDEF message */
+    evt_data.alloc.conn_handle = (NFA_HANDLE_GROUP_SNEP | dlink);
+    evt_data.alloc.req_code    = opcode;
+    evt_data.alloc.ndef_length = length;
+    evt_data.alloc.p_buff      = NULL;
+
+    p_conn->p_cback (NFA_SNEP_ALLOC_BUFF_EVT, &evt_data);
+
+    if (evt_data.alloc.p_buff == NULL)
+    {
+        SNEP_TRACE_DEBUG1 ("nfa_snep_proc_rx_request (): No buffer, resp_code:0x%02X",
+                           evt_data.alloc.resp_code);
+
+        LLCP_FlushDataLinkRxData (p_conn->local_sap, p_conn->remote_sap);
+
+        if (evt_data.alloc.resp_code == NFA_SNEP_RESP_CODE_CONTINUE)
+            evt_data.alloc.resp_code = NFA_SNEP_RESP_CODE_REJECT;
+
+        p_conn->rx_code     = opcode;
+        p_conn->ndef_length = 0;
+        p_conn->p_ndef_buff = NULL;
+
+        if (!nfa_snep_send_msg (evt_data.alloc.resp_code, dlink))
+            nfa_snep_abort_conn (dlink);
+        return;
+    }
+
+    p_conn->rx_code           = opcode;
+    p_conn->acceptable_length = acceptable_length;
+    p_conn->buff_length       = length;
+    p_conn->ndef_length       = length;
+    p_conn->cur_length        = 0;
+    p_conn->p_ndef_buff       = evt_data.alloc.p_buff;
+
+    if (length == 0)
+        nfa_snep_proc_rx_complete (dlink);
+    else
+        p_conn->rx_fragments = TRUE;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_proc_rx_response
+**
+** Description      Process header of response received by client
+**
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_snep_proc_rx_response (UINT8 dlink)
+{
+    tNFA_SNEP_CONN *p_conn = &nfa_snep_cb.conn[dlink];
+    UINT8           version, opcode, *p;
+    UINT32          length;
+
+    p = p_conn->rx_hdr;
+    BE_STREAM_TO_UINT8 (version, p);
+    BE_STREAM_TO_UINT8 (opcode, p);
+    BE_STREAM_TO_UINT32 (length, p);
+
+    p_conn->rx_hdr_len = 0;
+
+    SNEP_TRACE_DEBUG4 ("nfa_snep_proc_rx_response (): dlink:%d, version:0x%02X, opcode:0x%02X, length:%d",
+                       dlink, version, opcode, length);
+
+    if (!(p_conn->flags & NFA_SNEP_FLAG_W4_RESP))
+    {
+        SNEP_TRACE_ERROR0 ("nfa_snep_proc_rx_response (): Unexpected response");
+        LLCP_FlushDataLinkRxData (p_conn->local_sap, p_conn->remote_sap);
+        return;
+    }
+
+    if ((version & NFA_SNEP_VERSION_MAJOR_MASK) != (NFA_SNEP_VERSION & NFA_SNEP_VERSION_MAJOR_MASK))
+    {
+        LLCP_FlushDataLinkRxData (p_conn->local_sap, p_conn->remote_sap);
+        nfa_snep_notify_resp (dlink, NFA_SNEP_RESP_CODE_UNSUPP_VER);
+        return;
+    }
+
+    if (p_conn->flags & NFA_SNEP_FLAG_W4_RESP_CONTINUE)
+    {
+        nfa_sys_stop_timer (&p_conn->timer);
+        p_conn->flags &= ~NFA_SNEP_FLAG_W4_RESP_CONTINUE;
+
+        if (opcode == NFA_SNEP_RESP_CODE_CONTINUE)
+        {
+            LLCP_FlushDataLinkRxData (p_conn->local_sap, p_conn->remote_sap);
+            nfa_snep_send_remaining (dlink);
+            return;
+        }
+        /* otherwise server doesn't want remaining fragments; this is final response */
+    }
+
+    if (  (p_conn->tx_code == NFA_SNEP_REQ_CODE_GET)
+        &&(opcode == NFA_SNEP_RESP_CODE_SUCCESS)  )
+    {
+        if (length > p_conn->buff_length)
+        {
+            SNEP_TRACE_ERROR2 ("nfa_snep_proc_rx_response (): length:%d exceeds acceptable length:%d",
+                               length, p_conn->buff_length);
+
+            /* ask server not to send remaining fragments */
+            if (LLCP_FlushDataLinkRxData (p_conn->local_sap, p_conn->remote_sap) < length)
+            {
+                if (!nfa_snep_send_msg (NFA_SNEP_REQ_CODE_REJECT, dlink))
+                {
+                    nfa_snep_abort_conn (dlink);
+                    return;
+                }
+            }
+
+            nfa_snep_notify_resp (dlink, NFA_SNEP_RESP_CODE_EXCESS_DATA);
+            return;
+        }
+
+        p_conn->ndef_length = length;
+        p_conn->cur_length  = 0;
+
+        if (length == 0)
+            nfa_snep_notify_resp (dlink, NFA_SNEP_RESP_CODE_SUCCESS);
+        else
+            p_conn->rx_fragments = TRUE;
+        return;
+    }
+
+    LLCP_FlushDataLinkRxData (p_conn->local_sap, p_conn->remote_sap);
+    nfa_snep_notify_resp (dlink, opcode);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_llcp_cback
+**
+** Description      Processing SAP callback events from LLCP
+**
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfa_snep_llcp_cback (tLLCP_SAP_CBACK_DATA *p_data)
+{
+    SNEP_TRACE_DEBUG2 ("nfa_snep_llcp_cback (): event:0x%02X, local_sap:0x%02X", p_data->hdr.event, p_data->hdr.local_sap);
+
+    switch (p_data->hdr.event)
+    {
+    case LLCP_SAP_EVT_DATA_IND:
+        nfa_snep_proc_llcp_data_ind (p_data);
+        break;
+
+    case LLCP_SAP_EVT_CONNECT_IND:
+        nfa_snep_proc_llcp_connect_ind (p_data);
+        break;
+
+    case LLCP_SAP_EVT_CONNECT_RESP:
+        nfa_snep_proc_llcp_connect_resp (p_data);
+        break;
+
+    case LLCP_SAP_EVT_DISCONNECT_IND:
+        nfa_snep_proc_llcp_disconnect_ind (p_data);
+        break;
+
+    case LLCP_SAP_EVT_DISCONNECT_RESP:
+        nfa_snep_proc_llcp_disconnect_resp (p_data);
+        break;
+
+    case LLCP_SAP_EVT_CONGEST:
+        nfa_snep_proc_llcp_congest (p_data);
+        break;
+
+    case LLCP_SAP_EVT_LINK_STATUS:
+        nfa_snep_proc_llcp_link_status (p_data);
+        break;
+
+    case LLCP_SAP_EVT_TX_COMPLETE:
+        nfa_snep_proc_llcp_tx_complete (p_data);
+        break;
+
+    default:
+        SNEP_TRACE_ERROR1 ("nfa_snep_llcp_cback (): Unknown event:0x%02X", p_data->hdr.event);
+        return;
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_proc_llcp_data_ind
+**
+** Description      Processing incoming data from LLCP.
+**                  Header is collected in control block, NDEF message is
+**                  read directly into the buffer for the whole message.
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfa_snep_proc_llcp_data_ind (tLLCP_SAP_CBACK_DATA *p_data)
+{
+    tNFA_SNEP_CONN *p_conn;
+    UINT8           dlink, hdr_size, *p;
+    UINT32          length;
+    BOOLEAN         more = TRUE, first_fragment = FALSE;
+
+    SNEP_TRACE_DEBUG0 ("nfa_snep_proc_llcp_data_ind ()");
+
+    if (p_data->data_ind.link_type != LLCP_LINK_TYPE_DATA_LINK_CONNECTION)
+    {
+        LLCP_FlushLogicalLinkRxData (p_data->data_ind.local_sap);
+        return;
+    }
+
+    dlink = nfa_snep_find_dlink (p_data->data_ind.local_sap, p_data->data_ind.remote_sap);
+
+    if (dlink >= NFA_SNEP_MAX_CONN)
+    {
+        SNEP_TRACE_ERROR0 ("nfa_snep_proc_llcp_data_ind (): Cannot find data link");
+        LLCP_FlushDataLinkRxData (p_data->data_ind.local_sap, p_data->data_ind.remote_sap);
+        return;
+    }
+
+    p_conn = &nfa_snep_cb.conn[dlink];
+
+    while (  (more)
+           &&(p_conn->flags & NFA_SNEP_FLAG_CONNECTED)  )
+    {
+        if (!p_conn->rx_fragments)
+        {
+            /* GET request from client has acceptable length after header */
+            hdr_size = NFA_SNEP_HEADER_SIZE;
+
+            if (  (p_conn->rx_hdr_len >= NFA_SNEP_HEADER_SIZE)
+                &&(p_conn->flags & NFA_SNEP_FLAG_SERVER)
+                &&(p_conn->rx_hdr[1] == NFA_SNEP_REQ_CODE_GET)  )
+            {
+                hdr_size += NFA_SNEP_ACCEPT_LEN_SIZE;
+            }
+
+            more = LLCP_ReadDataLinkData (p_conn->local_sap, p_conn->remote_sap,
+                                          hdr_size - p_conn->rx_hdr_len, &length,
+                                          p_conn->rx_hdr + p_conn->rx_hdr_len);
+            if (length == 0)
+                break;
+
+            p_conn->rx_hdr_len += (UINT8) length;
+
+            if (p_conn->rx_hdr_len < NFA_SNEP_HEADER_SIZE)
+                continue;
+
+            if (  (p_conn->rx_hdr_len < NFA_SNEP_HEADER_SIZE + NFA_SNEP_ACCEPT_LEN_SIZE)
+                &&(p_conn->flags & NFA_SNEP_FLAG_SERVER)
+                &&(p_conn->rx_hdr[1] == NFA_SNEP_REQ_CODE_GET)  )
+            {
+                p = &p_conn->rx_hdr[2];
+                BE_STREAM_TO_UINT32 (length, p);
+
+                /* read acceptable length unless request is malformed */
+                if (length >= NFA_SNEP_ACCEPT_LEN_SIZE)
+                    continue;
+            }
+
+            first_fragment = TRUE;
+
+            if (p_conn->flags & NFA_SNEP_FLAG_SERVER)
+                nfa_snep_proc_rx_request (dlink);
+            else
+                nfa_snep_proc_rx_response (dlink);
+        }
+        else
+        {
+            more = LLCP_ReadDataLinkData (p_conn->local_sap, p_conn->remote_sap,
+                                          p_conn->ndef_length - p_conn->cur_length, &length,
+                                          p_conn->p_ndef_buff + p_conn->cur_length);
+            if (length == 0)
+                break;
+
+            p_conn->cur_length += length;
+
+            if (p_conn->cur_length >= p_conn->ndef_length)
+            {
+                first_fragment = FALSE;
+                nfa_snep_proc_rx_complete (dlink);
+            }
+        }
+    }
+
+    /* ask peer for remaining fragments if message doesn't fit in the first fragment */
+    if (  (first_fragment)
+        &&(p_conn->rx_fragments)
+        &&(p_conn->flags & NFA_SNEP_FLAG_CONNECTED)  )
+    {
+        if (!nfa_snep_send_msg ((p_conn->flags & NFA_SNEP_FLAG_SERVER) ? NFA_SNEP_RESP_CODE_CONTINUE : NFA_SNEP_REQ_CODE_CONTINUE,
+                                dlink))
+        {
+            nfa_snep_abort_conn (dlink);
+            return;
+        }
+    }
+
+    /* client waits for the next fragment of response as long as for response */
+    if (  (p_conn->flags & NFA_SNEP_FLAG_CLIENT)
+        &&(p_conn->flags & NFA_SNEP_FLAG_W4_RESP)
+        &&(p_conn->rx_fragments)  )
+    {
+        nfa_snep_start_timer (dlink);
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_proc_llcp_connect_ind
+**
+** Description      Processing connection request from peer
+**
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfa_snep_proc_llcp_connect_ind (tLLCP_SAP_CBACK_DATA *p_data)
+{
+    tNFA_SNEP_EVT_DATA      evt_data;
+    tLLCP_CONNECTION_PARAMS params;
+    UINT8                   server, dlink;
+
+    SNEP_TRACE_DEBUG2 ("nfa_snep_proc_llcp_connect_ind (): server_sap:0x%02X, remote_sap:0x%02X",
+                       p_data->connect_ind.server_sap, p_data->connect_ind.remote_sap);
+
+    server = nfa_snep_find_reg (p_data->connect_ind.server_sap);
+
+    if (  (server >= NFA_SNEP_MAX_CONN)
+        ||(!(nfa_snep_cb.conn[server].flags & NFA_SNEP_FLAG_SERVER))  )
+    {
+        SNEP_TRACE_ERROR0 ("nfa_snep_proc_llcp_connect_ind (): Cannot find server");
+        LLCP_ConnectReject (p_data->connect_ind.local_sap, p_data->connect_ind.remote_sap,
+                            LLCP_SAP_DM_REASON_NO_SERVICE);
+        return;
+    }
+
+    dlink = nfa_snep_allocate_cb ();
+
+    if (dlink >= NFA_SNEP_MAX_CONN)
+    {
+        LLCP_ConnectReject (p_data->connect_ind.local_sap, p_data->connect_ind.remote_sap,
+                            LLCP_SAP_DM_REASON_TEMP_REJECT_THIS);
+        return;
+    }
+
+    nfa_snep_cb.conn[dlink].local_sap  = p_data->connect_ind.local_sap;
+    nfa_snep_cb.conn[dlink].remote_sap = p_data->connect_ind.remote_sap;
+    nfa_snep_cb.conn[dlink].flags      = NFA_SNEP_FLAG_SERVER|NFA_SNEP_FLAG_CONNECTED;
+    nfa_snep_cb.conn[dlink].p_cback    = nfa_snep_cb.conn[server].p_cback;
+    nfa_snep_cb.conn[dlink].tx_miu     = nfa_snep_get_tx_miu (p_data->connect_ind.miu);
+
+    params.miu   = NFA_SNEP_MIU;
+    params.rw    = NFA_SNEP_RW;
+    params.sn[0] = 0;
+
+    if (LLCP_ConnectCfm (p_data->connect_ind.local_sap, p_data->connect_ind.remote_sap, &params) != LLCP_STATUS_SUCCESS)
+    {
+        nfa_snep_deallocate_cb (dlink);
+        return;
+    }
+
+    evt_data.connect.reg_handle  = (NFA_HANDLE_GROUP_SNEP | server);
+    evt_data.connect.conn_handle = (NFA_HANDLE_GROUP_SNEP | dlink);
+
+    nfa_snep_cb.conn[dlink].p_cback (NFA_SNEP_CONNECTED_EVT, &evt_data);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_proc_llcp_connect_resp
+**
+** Description      Processing connection response from peer
+**
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfa_snep_proc_llcp_connect_resp (tLLCP_SAP_CBACK_DATA *p_data)
+{
+    tNFA_SNEP_CONN     *p_conn;
+    tNFA_SNEP_EVT_DATA  evt_data;
+    UINT8               dlink;
+
+    SNEP_TRACE_DEBUG2 ("nfa_snep_proc_llcp_connect_resp (): local_sap:0x%02X, remote_sap:0x%02X",
+                       p_data->connect_resp.local_sap, p_data->connect_resp.remote_sap);
+
+    dlink = nfa_snep_find_reg (p_data->connect_resp.local_sap);
+
+    if (  (dlink >= NFA_SNEP_MAX_CONN)
+        ||(!(nfa_snep_cb.conn[dlink].flags & NFA_SNEP_FLAG_CONNECTING))  )
+    {
+        SNEP_TRACE_ERROR0 ("nfa_snep_proc_llcp_connect_resp (): Cannot find client");
+        LLCP_DisconnectReq (p_data->connect_resp.local_sap, p_data->connect_resp.remote_sap, TRUE);
+        return;
+    }
+
+    p_conn = &nfa_snep_cb.conn[dlink];
+
+    p_conn->remote_sap = p_data->connect_resp.remote_sap;
+    p_conn->tx_miu     = nfa_snep_get_tx_miu (p_data->connect_resp.miu);
+    p_conn->flags      = NFA_SNEP_FLAG_CLIENT|NFA_SNEP_FLAG_CONNECTED;
+
+    evt_data.connect.reg_handle  = (NFA_HANDLE_GROUP_SNEP | dlink);
+    evt_data.connect.conn_handle = (NFA_HANDLE_GROUP_SNEP | dlink);
+
+    p_conn->p_cback (NFA_SNEP_CONNECTED_EVT, &evt_data);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_proc_llcp_disconnect_ind
+**
+** Description      Processing disconnection request from peer
+**
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfa_snep_proc_llcp_disconnect_ind (tLLCP_SAP_CBACK_DATA *p_data)
+{
+    UINT8 dlink;
+
+    SNEP_TRACE_DEBUG2 ("nfa_snep_proc_llcp_disconnect_ind (): local_sap:0x%02X, remote_sap:0x%02X",
+                       p_data->disconnect_ind.local_sap, p_data->disconnect_ind.remote_sap);
+
+    dlink = nfa_snep_find_dlink (p_data->disconnect_ind.local_sap, p_data->disconnect_ind.remote_sap);
+
+    if (dlink < NFA_SNEP_MAX_CONN)
+    {
+        nfa_snep_close_conn (dlink);
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_proc_llcp_disconnect_resp
+**
+** Description      Processing rejected connection or disconnection response
+**                  from peer
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfa_snep_proc_llcp_disconnect_resp (tLLCP_SAP_CBACK_DATA *p_data)
+{
+    UINT8 dlink;
+
+    SNEP_TRACE_DEBUG3 ("nfa_snep_proc_llcp_disconnect_resp (): local_sap:0x%02X, remote_sap:0x%02X, reason:0x%02X",
+                       p_data->disconnect_resp.local_sap, p_data->disconnect_resp.remote_sap,
+                       p_data->disconnect_resp.reason);
+
+    dlink = nfa_snep_find_dlink (p_data->disconnect_resp.local_sap, p_data->disconnect_resp.remote_sap);
+
+    if (dlink < NFA_SNEP_MAX_CONN)
+    {
+        nfa_snep_close_conn (dlink);
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_proc_llcp_congest
+**
+** Description      Processing congestion notification from LLCP.
+**                  Remaining fragments are sent when congestion is cleared.
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfa_snep_proc_llcp_congest (tLLCP_SAP_CBACK_DATA *p_data)
+{
+    tNFA_SNEP_CONN *p_conn;
+    UINT8           dlink;
+
+    SNEP_TRACE_DEBUG3 ("nfa_snep_proc_llcp_congest (): local_sap:0x%02X, remote_sap:0x%02X, is_congested:%d",
+                       p_data->congest.local_sap, p_data->congest.remote_sap,
+                       p_data->congest.is_congested);
+
+    if (p_data->congest.link_type != LLCP_LINK_TYPE_DATA_LINK_CONNECTION)
+        return;
+
+    dlink = nfa_snep_find_dlink (p_data->congest.local_sap, p_data->congest.remote_sap);
+
+    if (dlink >= NFA_SNEP_MAX_CONN)
+        return;
+
+    p_conn = &nfa_snep_cb.conn[dlink];
+    p_conn->congest = p_data->congest.is_congested;
+
+    if (  (!p_conn->congest)
+        &&(!p_conn->rx_fragments)
+        &&(p_conn->cur_length < p_conn->ndef_length)
+        &&(!(p_conn->flags & (NFA_SNEP_FLAG_W4_RESP_CONTINUE|NFA_SNEP_FLAG_W4_REQ_CONTINUE)))  )
+    {
+        nfa_snep_send_remaining (dlink);
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_proc_llcp_link_status
+**
+** Description      Processing LLCP link activation/deactivation
+**
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfa_snep_proc_llcp_link_status (tLLCP_SAP_CBACK_DATA *p_data)
+{
+    tNFA_SNEP_EVT_DATA  evt_data;
+    UINT8               xx, reg;
+
+    SNEP_TRACE_DEBUG2 ("nfa_snep_proc_llcp_link_status (): local_sap:0x%02X, is_activated:%d",
+                       p_data->link_status.local_sap, p_data->link_status.is_activated);
+
+    if (!p_data->link_status.is_activated)
+    {
+        /* clean up data link connections on this SAP */
+        for (xx = 0; xx < NFA_SNEP_MAX_CONN; xx++)
+        {
+            if (  (nfa_snep_cb.conn[xx].local_sap == p_data->link_status.local_sap)
+                &&(nfa_snep_cb.conn[xx].flags & (NFA_SNEP_FLAG_CONNECTING|NFA_SNEP_FLAG_CONNECTED))  )
+            {
+                nfa_snep_close_conn (xx);
+            }
+        }
+    }
+
+    reg = nfa_snep_find_reg (p_data->link_status.local_sap);
+
+    /* only client is notified */
+    if (  (reg < NFA_SNEP_MAX_CONN)
+        &&(nfa_snep_cb.conn[reg].flags & NFA_SNEP_FLAG_CLIENT)  )
+    {
+        evt_data.activated.client_handle = (NFA_HANDLE_GROUP_SNEP | reg);
+
+        nfa_snep_cb.conn[reg].p_cback ((p_data->link_status.is_activated) ? NFA_SNEP_ACTIVATED_EVT : NFA_SNEP_DEACTIVATED_EVT,
+                                       &evt_data);
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_proc_llcp_tx_complete
+**
+** Description      Processing tx complete notification from LLCP.
+**                  Resume sending if it was stopped for lack of buffer, or
+**                  notify server application that GET response is sent.
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfa_snep_proc_llcp_tx_complete (tLLCP_SAP_CBACK_DATA *p_data)
+{
+    tNFA_SNEP_CONN     *p_conn;
+    tNFA_SNEP_EVT_DATA  evt_data;
+    UINT8               dlink;
+
+    SNEP_TRACE_DEBUG2 ("nfa_snep_proc_llcp_tx_complete (): local_sap:0x%02X, remote_sap:0x%02X",
+                       p_data->tx_complete.local_sap, p_data->tx_complete.remote_sap);
+
+    dlink = nfa_snep_find_dlink (p_data->tx_complete.local_sap, p_data->tx_complete.remote_sap);
+
+    if (dlink >= NFA_SNEP_MAX_CONN)
+        return;
+
+    p_conn = &nfa_snep_cb.conn[dlink];
+
+    if (  (!p_conn->rx_fragments)
+        &&(p_conn->cur_length < p_conn->ndef_length)  )
+    {
+        if (!(p_conn->flags & (NFA_SNEP_FLAG_W4_RESP_CONTINUE|NFA_SNEP_FLAG_W4_REQ_CONTINUE)))
+        {
+            nfa_snep_send_remaining (dlink);
+        }
+    }
+    else if (p_conn->flags & NFA_SNEP_FLAG_W4_TX_CMPL)
+    {
+        p_conn->flags &= ~NFA_SNEP_FLAG_W4_TX_CMPL;
+
+        evt_data.get_resp_cmpl.conn_handle = (NFA_HANDLE_GROUP_SNEP | dlink);
+        evt_data.get_resp_cmpl.p_buff      = p_conn->p_ndef_buff;
+
+        p_conn->p_ndef_buff = NULL;
+        p_conn->ndef_length = 0;
+        p_conn->cur_length  = 0;
+
+        p_conn->p_cback (NFA_SNEP_GET_RESP_CMPL_EVT, &evt_data);
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_reg_server
+**
+** Description      Register SNEP server on LLCP and start listening
+**
+**
+** Returns          TRUE to deallocate message
+**
+*******************************************************************************/
+BOOLEAN nfa_snep_reg_server (tNFA_SNEP_MSG *p_msg)
+{
+    tNFA_SNEP_EVT_DATA  evt_data;
+    UINT8               server_sap, xx = NFA_SNEP_MAX_CONN;
+
+    SNEP_TRACE_DEBUG0 ("nfa_snep_reg_server ()");
+
+    server_sap = LLCP_RegisterServer (p_msg->api_reg_server.server_sap,
+                                      LLCP_LINK_TYPE_DATA_LINK_CONNECTION,
+                                      p_msg->api_reg_server.service_name,
+                                      nfa_snep_llcp_cback);
+
+    if (server_sap != LLCP_INVALID_SAP)
+    {
+        xx = nfa_snep_allocate_cb ();
+
+        if (xx >= NFA_SNEP_MAX_CONN)
+        {
+            LLCP_Deregister (server_sap);
+        }
+    }
+
+    BCM_STRNCPY_S (evt_data.reg.service_name, sizeof (evt_data.reg.service_name),
+                   p_msg->api_reg_server.service_name, LLCP_MAX_SN_LEN);
+    evt_data.reg.service_name[LLCP_MAX_SN_LEN] = 0;
+
+    if (xx >= NFA_SNEP_MAX_CONN)
+    {
+        SNEP_TRACE_ERROR0 ("nfa_snep_reg_server (): Failed to register server");
+
+        evt_data.reg.status     = NFA_STATUS_FAILED;
+        evt_data.reg.reg_handle = NFA_HANDLE_INVALID;
+
+        p_msg->api_reg_server.p_cback (NFA_SNEP_REG_EVT, &evt_data);
+        return TRUE;
+    }
+
+    nfa_snep_cb.conn[xx].local_sap = server_sap;
+    nfa_snep_cb.conn[xx].flags     = NFA_SNEP_FLAG_SERVER;
+    nfa_snep_cb.conn[xx].p_cback   = p_msg->api_reg_server.p_cback;
+
+    /* if need to update WKS in LLCP Gen bytes */
+    if (server_sap <= LLCP_UPPER_BOUND_WK_SAP)
+    {
+        nfa_p2p_enable_listening (NFA_ID_SNEP, TRUE);
+    }
+    else if (!nfa_snep_cb.listen_enabled)
+    {
+        nfa_p2p_enable_listening (NFA_ID_SNEP, FALSE);
+    }
+    nfa_snep_cb.listen_enabled = TRUE;
+
+    evt_data.reg.status     = NFA_STATUS_OK;
+    evt_data.reg.reg_handle = (NFA_HANDLE_GROUP_SNEP | xx);
+
+    nfa_snep_cb.conn[xx].p_cback (NFA_SNEP_REG_EVT, &evt_data);
+
+    return TRUE;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_reg_client
+**
+** Description      Register SNEP client on LLCP
+**
+**
+** Returns          TRUE to deallocate message
+**
+*******************************************************************************/
+BOOLEAN nfa_snep_reg_client (tNFA_SNEP_MSG *p_msg)
+{
+    tNFA_SNEP_EVT_DATA  evt_data;
+    UINT8               local_sap, xx = NFA_SNEP_MAX_CONN;
+
+    SNEP_TRACE_DEBUG0 ("nfa_snep_reg_client ()");
+
+    local_sap = LLCP_RegisterClient (LLCP_LINK_TYPE_DATA_LINK_CONNECTION, nfa_snep_llcp_cback);
+
+    if (local_sap != LLCP_INVALID_SAP)
+    {
+        xx = nfa_snep_allocate_cb ();
+
+        if (xx >= NFA_SNEP_MAX_CONN)
+        {
+            LLCP_Deregister (local_sap);
+        }
+    }
+
+    evt_data.reg.service_name[0] = 0;
+
+    if (xx >= NFA_SNEP_MAX_CONN)
+    {
+        SNEP_TRACE_ERROR0 ("nfa_snep_reg_client (): Failed to register client");
+
+        evt_data.reg.status     = NFA_STATUS_FAILED;
+        evt_data.reg.reg_handle = NFA_HANDLE_INVALID;
+
+        p_msg->api_reg_client.p_cback (NFA_SNEP_REG_EVT, &evt_data);
+        return TRUE;
+    }
+
+    nfa_snep_cb.conn[xx].local_sap = local_sap;
+    nfa_snep_cb.conn[xx].flags     = NFA_SNEP_FLAG_CLIENT;
+    nfa_snep_cb.conn[xx].p_cback   = p_msg->api_reg_client.p_cback;
+
+    evt_data.reg.status     = NFA_STATUS_OK;
+    evt_data.reg.reg_handle = (NFA_HANDLE_GROUP_SNEP | xx);
+
+    nfa_snep_cb.conn[xx].p_cback (NFA_SNEP_REG_EVT, &evt_data);
+
+    /* if LLCP is already activated */
+    if (nfa_p2p_cb.llcp_state == NFA_P2P_LLCP_STATE_ACTIVATED)
+    {
+        evt_data.activated.client_handle = (NFA_HANDLE_GROUP_SNEP | xx);
+
+        nfa_snep_cb.conn[xx].p_cback (NFA_SNEP_ACTIVATED_EVT, &evt_data);
+    }
+
+    return TRUE;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_dereg
+**
+** Description      Deregister SNEP server or client
+**
+**
+** Returns          TRUE to deallocate message
+**
+*******************************************************************************/
+BOOLEAN nfa_snep_dereg (tNFA_SNEP_MSG *p_msg)
+{
+    UINT8 xx, reg, local_sap;
+
+    SNEP_TRACE_DEBUG0 ("nfa_snep_dereg ()");
+
+    reg       = (UINT8) (p_msg->api_dereg.reg_handle & NFA_HANDLE_MASK);
+    local_sap = nfa_snep_cb.conn[reg].local_sap;
+
+    if (nfa_snep_cb.conn[reg].flags & NFA_SNEP_FLAG_SERVER)
+    {
+        /* disconnect data link connections of this server */
+        for (xx = 0; xx < NFA_SNEP_MAX_CONN; xx++)
+        {
+            if (  (xx != reg)
+                &&(nfa_snep_cb.conn[xx].local_sap == local_sap)
+                &&(nfa_snep_cb.conn[xx].flags & NFA_SNEP_FLAG_CONNECTED)  )
+            {
+                nfa_snep_abort_conn (xx);
+            }
+        }
+    }
+    else if (nfa_snep_cb.conn[reg].flags & (NFA_SNEP_FLAG_CONNECTING|NFA_SNEP_FLAG_CONNECTED))
+    {
+        nfa_snep_abort_conn (reg);
+    }
+
+    LLCP_Deregister (local_sap);
+    nfa_snep_deallocate_cb (reg);
+
+    if (nfa_snep_cb.listen_enabled)
+    {
+        /* check if this is the last server on NFA SNEP */
+        for (xx = 0; xx < NFA_SNEP_MAX_CONN; xx++)
+        {
+            if (nfa_snep_cb.conn[xx].flags == NFA_SNEP_FLAG_SERVER)
+            {
+                break;
+            }
+        }
+
+        if (xx >= NFA_SNEP_MAX_CONN)
+        {
+            nfa_snep_cb.listen_enabled = FALSE;
+
+            /* if need to update WKS in LLCP Gen bytes */
+            nfa_p2p_disable_listening (NFA_ID_SNEP, (BOOLEAN) (local_sap <= LLCP_UPPER_BOUND_WK_SAP));
+        }
+        /* if need to update WKS in LLCP Gen bytes */
+        else if (local_sap <= LLCP_UPPER_BOUND_WK_SAP)
+        {
+            nfa_p2p_enable_listening (NFA_ID_SNEP, TRUE);
+        }
+    }
+
+    return TRUE;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_connect
+**
+** Description      Create data link connection to SNEP server on peer
+**
+**
+** Returns          TRUE to deallocate message
+**
+*******************************************************************************/
+BOOLEAN nfa_snep_connect (tNFA_SNEP_MSG *p_msg)
+{
+    tNFA_SNEP_CONN         *p_conn;
+    tNFA_SNEP_EVT_DATA      evt_data;
+    tLLCP_CONNECTION_PARAMS params;
+    UINT8                   dlink;
+
+    SNEP_TRACE_DEBUG0 ("nfa_snep_connect ()");
+
+    dlink  = (UINT8) (p_msg->api_connect.client_handle & NFA_HANDLE_MASK);
+    p_conn = &nfa_snep_cb.conn[dlink];
+
+    params.miu = NFA_SNEP_MIU;
+    params.rw  = NFA_SNEP_RW;
+    BCM_STRNCPY_S (params.sn, sizeof (params.sn), p_msg->api_connect.service_name, LLCP_MAX_SN_LEN);
+    params.sn[LLCP_MAX_SN_LEN] = 0;
+
+    if (LLCP_ConnectReq (p_conn->local_sap, LLCP_SAP_SDP, &params) == LLCP_STATUS_SUCCESS)
+    {
+        /* remote SAP is updated when connection is confirmed */
+        p_conn->remote_sap = LLCP_SAP_SDP;
+        p_conn->flags     |= NFA_SNEP_FLAG_CONNECTING;
+    }
+    else
+    {
+        evt_data.disc.conn_handle = p_msg->api_connect.client_handle;
+        p_conn->p_cback (NFA_SNEP_DISC_EVT, &evt_data);
+    }
+
+    return TRUE;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_get_req
+**
+** Description      Send GET request from client
+**
+**
+** Returns          TRUE to deallocate message
+**
+*******************************************************************************/
+BOOLEAN nfa_snep_get_req (tNFA_SNEP_MSG *p_msg)
+{
+    tNFA_SNEP_CONN *p_conn;
+    UINT8           dlink;
+
+    SNEP_TRACE_DEBUG0 ("nfa_snep_get_req ()");
+
+    dlink  = (UINT8) (p_msg->api_get_req.conn_handle & NFA_HANDLE_MASK);
+    p_conn = &nfa_snep_cb.conn[dlink];
+
+    if (  ((p_conn->flags & (NFA_SNEP_FLAG_CLIENT|NFA_SNEP_FLAG_CONNECTED)) != (NFA_SNEP_FLAG_CLIENT|NFA_SNEP_FLAG_CONNECTED))
+        ||(p_conn->flags & NFA_SNEP_FLAG_W4_RESP)  )
+    {
+        SNEP_TRACE_ERROR1 ("nfa_snep_get_req (): Not ready, flags:0x%02X", p_conn->flags);
+        return TRUE;
+    }
+
+    p_conn->buff_length = p_msg->api_get_req.buff_length;
+    p_conn->ndef_length = p_msg->api_get_req.ndef_length;
+    p_conn->p_ndef_buff = p_msg->api_get_req.p_ndef_buff;
+    p_conn->tx_code     = NFA_SNEP_REQ_CODE_GET;
+    p_conn->flags      |= NFA_SNEP_FLAG_W4_RESP;
+
+    nfa_snep_send_first (NFA_SNEP_REQ_CODE_GET, dlink);
+
+    return TRUE;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_put_req
+**
+** Description      Send PUT request from client
+**
+**
+** Returns          TRUE to deallocate message
+**
+*******************************************************************************/
+BOOLEAN nfa_snep_put_req (tNFA_SNEP_MSG *p_msg)
+{
+    tNFA_SNEP_CONN *p_conn;
+    UINT8           dlink;
+
+    SNEP_TRACE_DEBUG0 ("nfa_snep_put_req ()");
+
+    dlink  = (UINT8) (p_msg->api_put_req.conn_handle & NFA_HANDLE_MASK);
+    p_conn = &nfa_snep_cb.conn[dlink];
+
+    if (  ((p_conn->flags & (NFA_SNEP_FLAG_CLIENT|NFA_SNEP_FLAG_CONNECTED)) != (NFA_SNEP_FLAG_CLIENT|NFA_SNEP_FLAG_CONNECTED))
+        ||(p_conn->flags & NFA_SNEP_FLAG_W4_RESP)  )
+    {
+        SNEP_TRACE_ERROR1 ("nfa_snep_put_req (): Not ready, flags:0x%02X", p_conn->flags);
+        return TRUE;
+    }
+
+    p_conn->buff_length = p_msg->api_put_req.ndef_length;
+    p_conn->ndef_length = p_msg->api_put_req.ndef_length;
+    p_conn->p_ndef_buff = p_msg->api_put_req.p_ndef_buff;
+    p_conn->tx_code     = NFA_SNEP_REQ_CODE_PUT;
+    p_conn->flags      |= NFA_SNEP_FLAG_W4_RESP;
+
+    nfa_snep_send_first (NFA_SNEP_REQ_CODE_PUT, dlink);
+
+    return TRUE;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_get_resp
+**
+** Description      Send response of GET request from server
+**
+**
+** Returns          TRUE to deallocate message
+**
+*******************************************************************************/
+BOOLEAN nfa_snep_get_resp (tNFA_SNEP_MSG *p_msg)
+{
+    tNFA_SNEP_CONN *p_conn;
+    UINT8           dlink, resp_code;
+
+    SNEP_TRACE_DEBUG0 ("nfa_snep_get_resp ()");
+
+    dlink  = (UINT8) (p_msg->api_get_resp.conn_handle & NFA_HANDLE_MASK);
+    p_conn = &nfa_snep_cb.conn[dlink];
+
+    if (  (!(p_conn->flags & NFA_SNEP_FLAG_CONNECTED))
+        ||(!(p_conn->flags & NFA_SNEP_FLAG_W4_RESP))
+        ||(p_conn->rx_code != NFA_SNEP_REQ_CODE_GET)  )
+    {
+        SNEP_TRACE_ERROR1 ("nfa_snep_get_resp (): No GET request, flags:0x%02X", p_conn->flags);
+        return TRUE;
+    }
+
+    p_conn->flags &= ~NFA_SNEP_FLAG_W4_RESP;
+
+    resp_code           = p_msg->api_get_resp.resp_code;
+    p_conn->tx_code     = resp_code;
+    p_conn->ndef_length = p_msg->api_get_resp.ndef_length;
+    p_conn->p_ndef_buff = p_msg->api_get_resp.p_ndef_buff;
+    p_conn->cur_length  = 0;
+
+    if (resp_code != NFA_SNEP_RESP_CODE_SUCCESS)
+    {
+        p_conn->ndef_length = 0;
+    }
+    else if (p_conn->ndef_length > p_conn->acceptable_length)
+    {
+        SNEP_TRACE_ERROR2 ("nfa_snep_get_resp (): ndef_length:%d exceeds acceptable length:%d",
+                           p_conn->ndef_length, p_conn->acceptable_length);
+        resp_code           = NFA_SNEP_RESP_CODE_EXCESS_DATA;
+        p_conn->ndef_length = 0;
+    }
+
+    /* application gets buffer back with NFA_SNEP_GET_RESP_CMPL_EVT */
+    p_conn->flags |= NFA_SNEP_FLAG_W4_TX_CMPL;
+
+    nfa_snep_send_first (resp_code, dlink);
+
+    return TRUE;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_put_resp
+**
+** Description      Send response of PUT request from server
+**
+**
+** Returns          TRUE to deallocate message
+**
+*******************************************************************************/
+BOOLEAN nfa_snep_put_resp (tNFA_SNEP_MSG *p_msg)
+{
+    tNFA_SNEP_CONN *p_conn;
+    UINT8           dlink;
+
+    SNEP_TRACE_DEBUG0 ("nfa_snep_put_resp ()");
+
+    dlink  = (UINT8) (p_msg->api_put_resp.conn_handle & NFA_HANDLE_MASK);
+    p_conn = &nfa_snep_cb.conn[dlink];
+
+    if (  (!(p_conn->flags & NFA_SNEP_FLAG_CONNECTED))
+        ||(!(p_conn->flags & NFA_SNEP_FLAG_W4_RESP))
+        ||(p_conn->rx_code != NFA_SNEP_REQ_CODE_PUT)  )
+    {
+        SNEP_TRACE_ERROR1 ("nfa_snep_put_resp (): No PUT request, flags:0x%02X", p_conn->flags);
+        return TRUE;
+    }
+
+    p_conn->flags      &= ~NFA_SNEP_FLAG_W4_RESP;
+    p_conn->ndef_length = 0;
+    p_conn->cur_length  = 0;
+    p_conn->p_ndef_buff = NULL;
+    p_conn->tx_code     = p_msg->api_put_resp.resp_code;
+
+    nfa_snep_send_first (p_msg->api_put_resp.resp_code, dlink);
+
+    return TRUE;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_snep_disconnect
+**
+** Description      Disconnect data link connection
+**
+**
+** Returns          TRUE to deallocate message
+**
+*******************************************************************************/
+BOOLEAN nfa_snep_disconnect (tNFA_SNEP_MSG *p_msg)
+{
+    tNFA_SNEP_CONN *p_conn;
+    UINT8           dlink;
+
+    SNEP_TRACE_DEBUG0 ("nfa_snep_disconnect ()");
+
+    dlink  = (UINT8) (p_msg->api_disc.conn_handle & NFA_HANDLE_MASK);
+    p_conn = &nfa_snep_cb.conn[dlink];
+
+    if (p_conn->flags & (NFA_SNEP_FLAG_CONNECTING|NFA_SNEP_FLAG_CONNECTED))
+    {
+        LLCP_DisconnectReq (p_conn->local_sap, p_conn->remote_sap, p_msg->api_disc.flush);
+        nfa_snep_close_conn (dlink);
+    }
+
+    return TRUE;
+}
+
+#endif /* (defined (NFA_SNEP_INCLUDED) && (NFA_SNEP_INCLUDED==TRUE)) */
@@ -28,6 +28,9 @@
 #include "nfa_sys_int.h"
 #include "nfa_sys_ptim.h"
 #include "nfa_dm_int.h"
+#if (NFC_METRICS_INCLUDED == TRUE)
+#include "NfcMetrics.h"
+#endif
 
 /* protocol timer update period, in milliseconds */
 #ifndef NFA_SYS_TIMER_PERIOD
@@ -90,6 +93,11 @@ void nfa_sys_event (BT_HDR *p_msg)
         NFA_TRACE_WARNING1 ("NFA got unregistered event id %d", id);
     }
 
+#if (NFC_METRICS_INCLUDED == TRUE)
+    /* only the address is used; the handler may have freed the message */
+    nfcMetricsStop (NFC_METRIC_NFA_MSG, p_msg, 0);
+#endif
+
     if (freebuf)
     {
         GKI_freebuf (p_msg);
@@ -357,6 +365,9 @@ void nfa_sys_notify_nfcc_power_mode (UINT8 nfcc_power_mode)
 *******************************************************************************/
 void nfa_sys_sendmsg (void *p_msg)
 {
+#if (NFC_METRICS_INCLUDED == TRUE)
+    nfcMetricsStart (p_msg);
+#endif
     GKI_send_msg (NFC_TASK, p_nfa_sys_cfg->mbox, p_msg);
 }
 
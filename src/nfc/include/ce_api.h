@@ -87,7 +87,17 @@ typedef void (tCE_CBACK) (tCE_EVENT event, tCE_DATA *p_data);
 /* T4T definitions */
 typedef UINT8 tCE_T4T_AID_HANDLE;           /* Handle for AID registration  */
 #define CE_T4T_AID_HANDLE_INVALID   0xFF    /* Invalid tCE_T4T_AID_HANDLE               */
-#define CE_T4T_WILDCARD_AID_HANDLE  (CE_T4T_MAX_REG_AID)    /* reserved handle for wildcard aid */
+#define CE_T4T_WILDCARD_AID_HANDLE  0xFE    /* reserved handle for wildcard aid         */
+#define CE_T4T_MAX_REG_AID_LIMIT    0xFD    /* max size of the registered AID table     */
+
+/* Matching of the AID in SELECT by name against a registered AID */
+#define CE_T4T_AID_MATCH_EXACT      0x00    /* the selected AID equals the registered AID           */
+#define CE_T4T_AID_MATCH_PREFIX     0x01    /* the selected AID starts with the registered AID      */
+typedef UINT8 tCE_T4T_AID_MATCH;
+
+/* Size of the registered AID table, CE_T4T_MAX_REG_AID by default.
+** May be changed before the first AID is registered. */
+NFC_API extern UINT8 ce_t4t_max_reg_aid_cfg;
 
 /*******************************************************************************
 **
@@ -183,6 +193,26 @@ NFC_API extern tCE_T4T_AID_HANDLE CE_T4tRegisterAID (UINT8      aid_len,
                                                      UINT8      *p_aid,
                                                      tCE_CBACK  *p_cback);
 
+/*******************************************************************************
+**
+** Function         CE_T4tRegisterPrefixAID
+**
+** Description      Register AID prefix in CE T4T. Any AID starting with the
+**                  prefix is forwarded to p_cback, unless it is registered
+**                  with CE_T4tRegisterAID or a longer prefix.
+**
+**                  aid_len: length of AID prefix (up to NFC_MAX_AID_LEN)
+**                  p_aid:   AID prefix
+**                  p_cback: Raw frame will be forwarded with CE_RAW_FRAME_EVT
+**
+** Returns          tCE_T4T_AID_HANDLE if successful,
+**                  CE_T4T_AID_HANDLE_INVALID otherwisse
+**
+*******************************************************************************/
+NFC_API extern tCE_T4T_AID_HANDLE CE_T4tRegisterPrefixAID (UINT8      aid_len,
+                                                           UINT8      *p_aid,
+                                                           tCE_CBACK  *p_cback);
+
 /*******************************************************************************
 **
 ** Function         CE_T4tDeregisterAID
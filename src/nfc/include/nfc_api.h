@@ -139,6 +139,7 @@ typedef UINT8 tNFC_STATUS;
 #define NFC_ROUTE_TAG_TECH           NCI_ROUTE_TAG_TECH      /* Technology based routing  */
 #define NFC_ROUTE_TAG_PROTO          NCI_ROUTE_TAG_PROTO     /* Protocol based routing  */
 #define NFC_ROUTE_TAG_AID            NCI_ROUTE_TAG_AID       /* AID routing */
+#define NFC_ROUTE_QUAL_AID_PREFIX    NCI_ROUTE_QUAL_AID_PREFIX /* AID routing by prefix */
 #define NFC_ROUTE_TLV_ENTRY_SIZE     4 /* tag, len, 2 byte value for technology/protocol based routing */
 
 /* For routing */
@@ -829,6 +830,9 @@ typedef void (tNFC_CONN_CBACK) (UINT8 conn_id, tNFC_CONN_EVT event, tNFC_CONN *p
 **************************************/
 typedef void (tNFC_STATUS_CBACK) (tNFC_STATUS status);
 
+/* Callback to send the commands an upper layer batched, see NFC_SetCmdFlushCback */
+typedef void (tNFC_CMD_FLUSH_CBACK) (void);
+
 /*****************************************************************************
 **  EXTERNAL FUNCTION DECLARATIONS
 *****************************************************************************/
@@ -1095,6 +1099,36 @@ NFC_API extern void NFC_SetStaticRfCback(tNFC_CONN_CBACK    *p_cback);
 *******************************************************************************/
 NFC_API extern void NFC_SetReassemblyFlag (BOOLEAN    reassembly);
 
+/*******************************************************************************
+**
+** Function         NFC_SetCmdFlushCback
+**
+** Description      This function is called to register the function that
+**                  sends the commands an upper layer holds back to batch them.
+**                  It is called before any other command is sent, so that the
+**                  command order is kept, and at the end of every event
+**                  processed by NFC_TASK.
+**
+** Parameters       p_cback - the flush function, NULL to deregister
+**
+** Returns          Nothing
+**
+*******************************************************************************/
+NFC_API extern void NFC_SetCmdFlushCback (tNFC_CMD_FLUSH_CBACK *p_cback);
+
+/*******************************************************************************
+**
+** Function         NFC_GetMaxCtrlPayloadSize
+**
+** Description      This function is called to get the largest NCI control
+**                  message payload the NFCC accepts, as reported in
+**                  CORE_INIT_RSP.
+**
+** Returns          Max Control Packet Payload Size
+**
+*******************************************************************************/
+NFC_API extern UINT8 NFC_GetMaxCtrlPayloadSize (void);
+
 /*******************************************************************************
 **
 ** Function         NFC_SendData
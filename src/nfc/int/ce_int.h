@@ -57,6 +57,10 @@ typedef struct {
     UINT8           scratch_writef;
     UINT32          scratch_ln;
     UINT8           *p_scratch_buf; /* Scratch buffer for WRITE/readback */
+
+    /* Precomputed for CHECK */
+    UINT8           *p_check_buf;   /* NDEF data blocks returned by CHECK (p_buf or p_scratch_buf) */
+    UINT8           attr_block[T3T_MSG_BLOCKSIZE];  /* NDEF attribute block returned by CHECK */
 } tCE_T3T_NDEF_INFO;
 
 /* Type 3 Tag current command processing */
@@ -75,6 +79,7 @@ typedef struct
     UINT16              system_code;
     UINT8               local_nfcid2[NCI_RF_F_UID_LEN];
     UINT8               local_pmm[NCI_T3T_PMM_LEN];
+    UINT8               check_rsp_hdr[1 + NCI_RF_F_UID_LEN];    /* CHECK response code and NFCID2 */
     tCE_T3T_NDEF_INFO   ndef_info;
     tCE_T3T_CUR_CMD     cur_cmd;
 } tCE_T3T_MEM;
@@ -84,6 +89,7 @@ typedef struct
 {
     UINT8               aid_len;
     UINT8               aid[NFC_MAX_AID_LEN];
+    tCE_T4T_AID_MATCH   match;
     tCE_CBACK          *p_cback;
 } tCE_T4T_REG_AID;      /* registered AID table */
 
@@ -107,7 +113,11 @@ typedef struct
     UINT8               status;
 
     tCE_CBACK          *p_wildcard_aid_cback;               /* registered wildcard AID callback */
-    tCE_T4T_REG_AID     reg_aid[CE_T4T_MAX_REG_AID];        /* registered AID table             */
+    tCE_T4T_REG_AID    *p_reg_aid;                          /* registered AID table (indexed by handle) */
+    UINT8              *p_sorted_aid;                       /* handles of registered AIDs sorted by AID */
+    UINT8               max_reg_aid;                        /* size of registered AID table     */
+    UINT8               num_reg_aid;                        /* number of registered AIDs        */
+    UINT8               num_prefix_aid;                     /* number of registered AID prefixes*/
     UINT8               selected_aid_idx;
 } tCE_T4T_MEM;
 
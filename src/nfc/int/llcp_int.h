@@ -80,6 +80,9 @@ typedef struct
     BOOLEAN             ll_served;              /* TRUE if last transmisstion was for UI        */
     UINT8               ll_idx;                 /* for scheduler of logical link connection     */
     UINT8               dl_idx;                 /* for scheduler of data link connection        */
+#if (NFC_METRICS_INCLUDED == TRUE)
+    UINT32              rx_time;                /* when the last PDU was received; 0 if answered */
+#endif
 
     TIMER_LIST_ENT      inact_timer;            /* inactivity timer                             */
     UINT16              inact_timeout;          /* inactivity timeout in ms                     */
@@ -124,6 +124,9 @@ typedef struct
     UINT8       buff_size;      /* the max buffer size for this connection.     .   */
     UINT8       num_buff;       /* num of buffers left to send on this connection   */
     UINT8       init_credits;   /* initial num of buffer credits                    */
+#if (NFC_METRICS_INCLUDED == TRUE)
+    UINT32      credit_wait;    /* when data started waiting for credit; 0 if not   */
+#endif
 } tNFC_CONN_CB;
 
 /* This data type is for NFC task to send a NCI VS command to NCIT task */
@@ -162,6 +165,7 @@ typedef struct
     tNFC_DISCOVER_CBACK *p_discv_cback;
     tNFC_RESPONSE_CBACK *p_resp_cback;
     tNFC_TEST_CBACK     *p_test_cback;
+    tNFC_CMD_FLUSH_CBACK *p_cmd_flush_cback;        /* sends the commands batched by upper layer */
     tNFC_VS_CBACK       *p_vs_cb[NFC_NUM_VS_CBACKS];/* Register for vendor specific events  */
 
 #if (NFC_RW_ONLY == FALSE)
@@ -196,6 +200,9 @@ typedef struct
     UINT8               nci_wait_rsp;       /* layer_specific for last NCI message */
 
     UINT8               nci_cmd_window;     /* Number of commands the controller can accecpt without waiting for response */
+#if (NFC_METRICS_INCLUDED == TRUE)
+    UINT32              nci_cmd_sent;       /* when the last NCI command was sent (NfcMetrics.h) */
+#endif
 
     BT_HDR              *p_nci_init_rsp;    /* holding INIT_RSP until receiving HAL_NFC_POST_INIT_CPLT_EVT */
     tHAL_NFC_ENTRY      *p_hal;
@@ -126,6 +126,12 @@ typedef struct
     UINT8               pend_retx_rsp;                  /* Number of pending rsps to retransmission on prev cmd */
 } tRW_T1T_PREV_CMD_RSP_INFO;
 
+typedef struct
+{
+    UINT8               opcode;                         /* T1T_CMD_RSEG or T1T_CMD_READ8                        */
+    UINT8               addr;                           /* Segment for RSEG, block number for READ8             */
+} tRW_T1T_READ_CMD;
+
 #if (defined (RW_NDEF_INCLUDED) && (RW_NDEF_INCLUDED == TRUE))
 #define T1T_BUFFER_SIZE             T1T_STATIC_SIZE     /* Buffer 0-E block, for easier tlv operation           */
 #else
@@ -174,6 +180,10 @@ typedef struct
     UINT8               lock_attr_seg;                      /* Tag segment for which lock attributes are prepared   */
     UINT8               attr[T1T_BLOCKS_PER_SEGMENT];       /* byte information - Reserved/lock/otp or data         */
     UINT8               lock_attr[T1T_BLOCKS_PER_SEGMENT];  /* byte information - read only or read write           */
+    UINT16              read_offset;                        /* Tag offset of the next byte to read for NDEF read    */
+    UINT8               num_read_cmds;                      /* Number of commands planned to read the NDEF message  */
+    UINT8               read_cmd_index;                     /* Index of the next planned NDEF read command          */
+    tRW_T1T_READ_CMD    read_cmd[T1T_MAX_SEGMENTS];         /* RSEG/READ8 commands planned to read NDEF message     */
 #endif
 } tRW_T1T_CB;
 
@@ -32,6 +32,9 @@
 #include "llcp_int.h"
 #include "llcp_defs.h"
 #include "nfc_int.h"
+#if (NFC_METRICS_INCLUDED == TRUE)
+#include "NfcMetrics.h"
+#endif
 
 const UINT16 llcp_link_rwt[15] =  /* RWT = (302us)*2**WT; 302us = 256*16/fc; fc = 13.56MHz */
 {
@@ -1703,6 +1706,15 @@ static void llcp_link_send_to_lower (BT_HDR *p_pdu)
 
     llcp_cb.lcb.symm_state = LLCP_LINK_SYMM_REMOTE_XMIT_NEXT;
 
+#if (NFC_METRICS_INCLUDED == TRUE)
+    /* latency is the turnaround from the PDU received before, if any */
+    if (llcp_cb.lcb.rx_time)
+        nfcMetricsRecord (NFC_METRIC_LLCP_PDU_TX, nfcMetricsNow () - llcp_cb.lcb.rx_time, p_pdu->len);
+    else
+        nfcMetricsCount (NFC_METRIC_LLCP_PDU_TX, p_pdu->len);
+    llcp_cb.lcb.rx_time = 0;
+#endif
+
     NFC_SendData (NFC_RF_CONN_ID, p_pdu);
 }
 
@@ -1721,6 +1733,10 @@ void llcp_link_connection_cback (UINT8 conn_id, tNFC_CONN_EVT event, tNFC_CONN *
     {
 #if (BT_TRACE_PROTOCOL == TRUE)
         DispLLCP ((BT_HDR *)p_data->data.p_data, TRUE);
+#endif
+#if (NFC_METRICS_INCLUDED == TRUE)
+        llcp_cb.lcb.rx_time = nfcMetricsNow () | 1;
+        nfcMetricsCount (NFC_METRIC_LLCP_PDU_RX, ((BT_HDR *) p_data->data.p_data)->len);
 #endif
         if (llcp_cb.lcb.link_state == LLCP_LINK_STATE_DEACTIVATED)
         {
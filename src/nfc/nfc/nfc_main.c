@@ -1085,6 +1085,42 @@ void NFC_SetReassemblyFlag (BOOLEAN    reassembly)
     nfc_cb.reassembly = reassembly;
 }
 
+/*******************************************************************************
+**
+** Function         NFC_SetCmdFlushCback
+**
+** Description      This function is called to register the function that
+**                  sends the commands an upper layer holds back to batch them.
+**                  It is called before any other command is sent, so that the
+**                  command order is kept, and at the end of every event
+**                  processed by NFC_TASK.
+**
+** Parameters       p_cback - the flush function, NULL to deregister
+**
+** Returns          Nothing
+**
+*******************************************************************************/
+void NFC_SetCmdFlushCback (tNFC_CMD_FLUSH_CBACK *p_cback)
+{
+    nfc_cb.p_cmd_flush_cback = p_cback;
+}
+
+/*******************************************************************************
+**
+** Function         NFC_GetMaxCtrlPayloadSize
+**
+** Description      This function is called to get the largest NCI control
+**                  message payload the NFCC accepts, as reported in
+**                  CORE_INIT_RSP.
+**
+** Returns          Max Control Packet Payload Size
+**
+*******************************************************************************/
+UINT8 NFC_GetMaxCtrlPayloadSize (void)
+{
+    return (nfc_cb.nci_ctrl_size);
+}
+
 /*******************************************************************************
 **
 ** Function         NFC_SendData
@@ -1317,6 +1353,10 @@ tNFC_STATUS NFC_PowerCycleNFCC (void)
 {
     NFC_TRACE_API0 ("NFC_PowerCycleNFCC ()");
 
+#ifdef DUMP_NCI_TRACE
+    DUMP_NCI_TRACE ();
+#endif
+
     if (nfc_cb.nfc_state == NFC_STATE_IDLE)
     {
         /* power cycle NFCC */
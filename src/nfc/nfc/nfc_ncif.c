@@ -39,6 +39,9 @@
 #include "rw_int.h"
 #include "hcidefs.h"
 #include "nfc_hal_api.h"
+#if (NFC_METRICS_INCLUDED == TRUE)
+#include "NfcMetrics.h"
+#endif
 
 #if (NFC_RW_ONLY == FALSE)
 static const UINT8 nfc_mpl_code_to_size[] =
@@ -105,6 +108,10 @@ void nfc_ncif_cmd_timeout (void)
         nfc_enabled (NFC_STATUS_FAILED, NULL);
     }
 
+#ifdef DUMP_NCI_TRACE
+    DUMP_NCI_TRACE ();
+#endif
+
     /* XXX maco since this failure is unrecoverable, abort the process */
     abort();
 }
@@ -243,6 +250,12 @@ UINT8 nfc_ncif_send_data (tNFC_CONN_CB *p_cb, BT_HDR *p_data)
         }
     }
 
+#if (NFC_METRICS_INCLUDED == TRUE)
+    /* data left in tx queue waits for credit from NFCC */
+    if ((p_data) && (p_cb->credit_wait == 0))
+        p_cb->credit_wait = nfcMetricsNow () | 1;
+#endif
+
     return (NCI_STATUS_OK);
 }
 
@@ -289,6 +302,9 @@ void nfc_ncif_check_cmd_queue (BT_HDR *p_buf)
             }
 
             /* send to HAL */
+#if (NFC_METRICS_INCLUDED == TRUE)
+            nfc_cb.nci_cmd_sent = nfcMetricsNow ();
+#endif
             HAL_WRITE(p_buf);
 
             /* Indicate command is pending */
@@ -349,6 +365,10 @@ void nfc_ncif_check_cmd_queue (BT_HDR *p_buf)
 *******************************************************************************/
 void nfc_ncif_send_cmd (BT_HDR *p_buf)
 {
+    /* commands batched by upper layer go first */
+    if (nfc_cb.p_cmd_flush_cback)
+        (*nfc_cb.p_cmd_flush_cback) ();
+
     /* post the p_buf to NCIT task */
     p_buf->event            = BT_EVT_TO_NFC_NCI;
     p_buf->layer_specific   = 0;
@@ -398,6 +418,9 @@ BOOLEAN nfc_ncif_process_event (BT_HDR *p_msg)
             NFC_TRACE_ERROR2 ("nfc_ncif_process_event unexpected rsp: gid:0x%x, oid:0x%x", gid, oid);
             return TRUE;
         }
+#if (NFC_METRICS_INCLUDED == TRUE)
+        nfcMetricsRecord (NFC_METRIC_NCI_CMD_RSP, nfcMetricsNow () - nfc_cb.nci_cmd_sent, p_msg->len);
+#endif
 
         switch (gid)
         {
@@ -604,6 +627,13 @@ void nfc_ncif_proc_credits(UINT8 *p, UINT16 plen)
         if (p_cb && p_cb->num_buff != NFC_CONN_NO_FC)
         {
             p_cb->num_buff += (*p);
+#if (NFC_METRICS_INCLUDED == TRUE)
+            if (p_cb->credit_wait)
+            {
+                nfcMetricsRecord (NFC_METRIC_DATA_CREDIT_WAIT, nfcMetricsNow () - p_cb->credit_wait, 0);
+                p_cb->credit_wait = 0;
+            }
+#endif
 #if (BT_USE_TRACES == TRUE)
             if (p_cb->num_buff > p_cb->init_credits)
             {
@@ -985,6 +1015,9 @@ void nfc_ncif_proc_activate (UINT8 *p, UINT8 len)
     p_cb->buff_size     = buff_size;
     p_cb->num_buff      = num_buff;
     p_cb->init_credits  = num_buff;
+#if (NFC_METRICS_INCLUDED == TRUE)
+    p_cb->credit_wait   = 0;
+#endif
 
     if (nfc_cb.p_discv_cback)
     {
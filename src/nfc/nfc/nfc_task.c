@@ -453,6 +453,9 @@ UINT32 nfc_task (UINT32 param)
         }
 #endif
 
+        /* send the commands batched while processing the events */
+        if (nfc_cb.p_cmd_flush_cback)
+            (*nfc_cb.p_cmd_flush_cback) ();
     }
 
 
@@ -178,6 +178,9 @@ void nfc_free_conn_cb (tNFC_CONN_CB *p_cb)
     nfc_cb.conn_id[p_cb->conn_id]   = 0;
     p_cb->p_cback                   = NULL;
     p_cb->conn_id                   = NFC_ILLEGAL_CONN_ID;
+#if (NFC_METRICS_INCLUDED == TRUE)
+    p_cb->credit_wait               = 0;
+#endif
 }
 
 /*******************************************************************************
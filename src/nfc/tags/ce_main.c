@@ -37,6 +37,8 @@
 
 tCE_CB  ce_cb;
 
+UINT8   ce_t4t_max_reg_aid_cfg = CE_T4T_MAX_REG_AID;
+
 /*******************************************************************************
 *******************************************************************************/
 void ce_init (void)
@@ -86,6 +86,59 @@ void ce_t3t_init (void)
     ce_cb.mem.t3t.ndef_info.nbw = CE_T3T_DEFAULT_UPDATE_MAXBLOCKS;
 }
 
+/*******************************************************************************
+**
+** Function         ce_t3t_build_attr_block
+**
+** Description      Build the NDEF attribute block returned by CHECK, and
+**                  select the buffer the NDEF data blocks are read from.
+**                  Called whenever one of the NDEF attributes changes.
+**                  The NDEF data blocks are contiguous in p_check_buf, so
+**                  block n (n > 0) is at p_check_buf + (n - 1) * 16 and no
+**                  table of block addresses is kept.
+**
+** Returns          none
+**
+*******************************************************************************/
+static void ce_t3t_build_attr_block (tCE_T3T_MEM *p_cb)
+{
+    UINT8   *p = p_cb->ndef_info.attr_block;
+    UINT8   ndef_writef;
+    UINT32  ndef_len;
+    UINT16  checksum = 0;
+    UINT8   i;
+
+    /* For rw ndef, use scratch buffer (in case reader/writer had previously updated NDEF) */
+    if ((p_cb->ndef_info.rwflag == T3T_MSG_NDEF_RWFLAG_RW) && (p_cb->ndef_info.p_scratch_buf))
+    {
+        ndef_writef = p_cb->ndef_info.scratch_writef;
+        ndef_len    = p_cb->ndef_info.scratch_ln;
+        p_cb->ndef_info.p_check_buf = p_cb->ndef_info.p_scratch_buf;
+    }
+    else
+    {
+        ndef_writef = p_cb->ndef_info.writef;
+        ndef_len    = p_cb->ndef_info.ln;
+        p_cb->ndef_info.p_check_buf = p_cb->ndef_info.p_buf;
+    }
+
+    UINT8_TO_STREAM (p, p_cb->ndef_info.version);
+    UINT8_TO_STREAM (p, p_cb->ndef_info.nbr);
+    UINT8_TO_STREAM (p, p_cb->ndef_info.nbw);
+    UINT16_TO_BE_STREAM (p, p_cb->ndef_info.nmaxb);
+    UINT32_TO_STREAM (p, 0);
+    UINT8_TO_STREAM (p, ndef_writef);
+    UINT8_TO_STREAM (p, p_cb->ndef_info.rwflag);
+    UINT8_TO_STREAM (p, (ndef_len >> 16 & 0xFF));
+    UINT16_TO_BE_STREAM (p, (ndef_len & 0xFFFF));
+
+    for (i = 0; i < T3T_MSG_NDEF_ATTR_INFO_SIZE; i++)
+    {
+        checksum += p_cb->ndef_info.attr_block[i];
+    }
+    UINT16_TO_BE_STREAM (p, checksum);
+}
+
 /*******************************************************************************
 **
 ** Function         ce_t3t_send_to_lower
@@ -313,6 +366,7 @@ void ce_t3t_handle_update_cmd (tCE_CB *p_ce_cb, BT_HDR *p_cmd_msg)
                     /* Update NDEF attribute block (only allowed to update current length and writef fields) */
                     p_cb->ndef_info.scratch_ln      = ndef_info.ln;
                     p_cb->ndef_info.scratch_writef  = ndef_info.writef;
+                    ce_t3t_build_attr_block (p_cb);
 
                     /* If writef=0 indicates completion of NDEF update */
                     if (ndef_info.writef == 0)
@@ -410,22 +464,20 @@ void ce_t3t_handle_check_cmd (tCE_CB *p_ce_cb, BT_HDR *p_cmd_msg)
     tCE_T3T_MEM *p_cb = &p_ce_cb->mem.t3t;
     BT_HDR *p_rsp_msg;
     UINT8 *p_rsp_start;
-    UINT8 *p_dst, *p_temp, *p_status;
+    UINT8 *p_dst, *p_status;
     UINT8 *p_src = p_cb->cur_cmd.p_block_list_start;
+    UINT8 *p_run = NULL;
+    UINT16 run_len = 0;
     UINT8 i, bl0;
-    UINT8 ndef_writef;
-    UINT32 ndef_len;
-    UINT16 block_number, service_code, checksum;
+    UINT16 ndef_sc_mask = 0;
+    UINT16 block_number, next_block_number = 0, service_code;
 
     if ((p_rsp_msg = ce_t3t_get_rsp_buf ()) != NULL)
     {
         p_dst = p_rsp_start = (UINT8 *) (p_rsp_msg+1) + p_rsp_msg->offset;
 
-        /* Response Code */
-        UINT8_TO_STREAM (p_dst, T3T_MSG_OPC_CHECK_RSP);
-
-        /* Manufacturer ID */
-        ARRAY_TO_STREAM (p_dst, p_cb->local_nfcid2, NCI_RF_F_UID_LEN);
+        /* Response Code and Manufacturer ID */
+        ARRAY_TO_STREAM (p_dst, p_cb->check_rsp_hdr, sizeof (p_cb->check_rsp_hdr));
 
         /* Save pointer to start of status field */
         p_status = p_dst;
@@ -435,6 +487,14 @@ void ce_t3t_handle_check_cmd (tCE_CB *p_ce_cb, BT_HDR *p_cmd_msg)
         UINT8_TO_STREAM (p_dst, T3T_MSG_RSP_STATUS_OK);
         UINT8_TO_STREAM (p_dst, p_cb->cur_cmd.num_blocks);
 
+        /* Find the entries of the service code list that are NDEF */
+        for (i = 0; i < p_cb->cur_cmd.num_services; i++)
+        {
+            service_code = p_cb->cur_cmd.service_code_list[i];
+            if ((service_code == T3T_MSG_NDEF_SC_RO) || (service_code == T3T_MSG_NDEF_SC_RW))
+                ndef_sc_mask |= (UINT16) (1 << i);
+        }
+
         for (i = 0; i < p_cb->cur_cmd.num_blocks; i++)
         {
             /* Read byte0 of block list */
@@ -449,96 +509,75 @@ void ce_t3t_handle_check_cmd (tCE_CB *p_ce_cb, BT_HDR *p_cmd_msg)
                 STREAM_TO_UINT16 (block_number, p_src);
             }
 
-            /* Read the block from memory */
-            service_code = p_cb->cur_cmd.service_code_list[bl0 & T3T_MSG_SERVICE_LIST_MASK];
-
             /* Check for NDEF */
-            if ((service_code == T3T_MSG_NDEF_SC_RO) || (service_code == T3T_MSG_NDEF_SC_RW))
+            if (!(ndef_sc_mask & (1 << (bl0 & T3T_MSG_SERVICE_LIST_MASK))))
             {
-                /* Verify Nbr (NDEF only) */
-                if (p_cb->cur_cmd.num_blocks > p_cb->ndef_info.nbr)
-                {
-                    /* Error: invalid number of blocks to check */
-                    CE_TRACE_ERROR2 ("CE: Requested too many blocks to check (requested: %i, max: %i)", p_cb->cur_cmd.num_blocks, p_cb->ndef_info.nbr);
-
-                    p_dst = p_status;
-                    UINT8_TO_STREAM (p_dst, T3T_MSG_RSP_STATUS_ERROR);
-                    UINT8_TO_STREAM (p_dst, T3T_MSG_RSP_STATUS2_ERROR_MEMORY);
-                    break;
-                }
-                else if (block_number == 0)
-                {
-                    /* Special caes: NDEF block0 is the ndef attribute block */
-                    p_temp = p_dst;
-
-                    /* For rw ndef, use scratch buffer's attributes (in case reader/writer had previously updated NDEF) */
-                    if ((p_cb->ndef_info.rwflag == T3T_MSG_NDEF_RWFLAG_RW) && (p_cb->ndef_info.p_scratch_buf))
-                    {
-                        ndef_writef = p_cb->ndef_info.scratch_writef;
-                        ndef_len    = p_cb->ndef_info.scratch_ln;
-                    }
-                    else
-                    {
-                        ndef_writef = p_cb->ndef_info.writef;
-                        ndef_len    = p_cb->ndef_info.ln;
-                    }
+                /* Error: invalid service code */
+                CE_TRACE_ERROR1 ("CE: Requested invalid service code: 0x%04x.", p_cb->cur_cmd.service_code_list[bl0 & T3T_MSG_SERVICE_LIST_MASK]);
 
-                    UINT8_TO_STREAM (p_dst, p_cb->ndef_info.version);
-                    UINT8_TO_STREAM (p_dst, p_cb->ndef_info.nbr);
-                    UINT8_TO_STREAM (p_dst, p_cb->ndef_info.nbw);
-                    UINT16_TO_BE_STREAM (p_dst, p_cb->ndef_info.nmaxb);
-                    UINT32_TO_STREAM (p_dst, 0);
-                    UINT8_TO_STREAM (p_dst, ndef_writef);
-                    UINT8_TO_STREAM (p_dst, p_cb->ndef_info.rwflag);
-                    UINT8_TO_STREAM (p_dst, (ndef_len >> 16 & 0xFF));
-                    UINT16_TO_BE_STREAM (p_dst, (ndef_len & 0xFFFF));
-
-                    checksum = 0;
-                    for (i = 0; i < T3T_MSG_NDEF_ATTR_INFO_SIZE; i++)
-                    {
-                        checksum+=p_temp[i];
-                    }
-                    UINT16_TO_BE_STREAM (p_dst, checksum);
-                }
-                else
-                {
-                    /* Verify that block_number is within NDEF memory */
-                    if (block_number > p_cb->ndef_info.nmaxb)
-                    {
-                        /* Invalid block number */
-                        p_dst = p_status;
+                p_dst = p_status;
+                UINT8_TO_STREAM (p_dst, T3T_MSG_RSP_STATUS_ERROR);
+                UINT8_TO_STREAM (p_dst, T3T_MSG_RSP_STATUS2_ERROR_MEMORY);
+                break;
+            }
 
-                        CE_TRACE_ERROR1 ("CE: Requested block number to check %i.", block_number);
+            /* Verify Nbr (NDEF only) */
+            if (p_cb->cur_cmd.num_blocks > p_cb->ndef_info.nbr)
+            {
+                /* Error: invalid number of blocks to check */
+                CE_TRACE_ERROR2 ("CE: Requested too many blocks to check (requested: %i, max: %i)", p_cb->cur_cmd.num_blocks, p_cb->ndef_info.nbr);
 
-                        /* Error: invalid number of blocks to check */
-                        UINT8_TO_STREAM (p_dst, T3T_MSG_RSP_STATUS_ERROR);
-                        UINT8_TO_STREAM (p_dst, T3T_MSG_RSP_STATUS2_ERROR_MEMORY);
-                        break;
-                    }
-                    else
-                    {
-                        /* If card is RW, then read from the scratch buffer (so reader/write can read back what it had just written */
-                        if ((p_cb->ndef_info.rwflag == T3T_MSG_NDEF_RWFLAG_RW) && (p_cb->ndef_info.p_scratch_buf))
-                        {
-                            ARRAY_TO_STREAM (p_dst, (&p_cb->ndef_info.p_scratch_buf[(block_number-1) * T3T_MSG_BLOCKSIZE]), T3T_MSG_BLOCKSIZE);
-                        }
-                        else
-                        {
-                            ARRAY_TO_STREAM (p_dst, (&p_cb->ndef_info.p_buf[(block_number-1) * T3T_MSG_BLOCKSIZE]), T3T_MSG_BLOCKSIZE);
-                        }
-                    }
-                }
+                p_dst = p_status;
+                UINT8_TO_STREAM (p_dst, T3T_MSG_RSP_STATUS_ERROR);
+                UINT8_TO_STREAM (p_dst, T3T_MSG_RSP_STATUS2_ERROR_MEMORY);
+                break;
             }
-            else
-            {
-                /* Error: invalid service code */
-                CE_TRACE_ERROR1 ("CE: Requested invalid service code: 0x%04x.", service_code);
 
+            /* Verify that block_number is within NDEF memory */
+            if (block_number > p_cb->ndef_info.nmaxb)
+            {
+                /* Invalid block number */
                 p_dst = p_status;
+
+                CE_TRACE_ERROR1 ("CE: Requested block number to check %i.", block_number);
+
+                /* Error: invalid number of blocks to check */
                 UINT8_TO_STREAM (p_dst, T3T_MSG_RSP_STATUS_ERROR);
                 UINT8_TO_STREAM (p_dst, T3T_MSG_RSP_STATUS2_ERROR_MEMORY);
                 break;
             }
+
+            /* Consecutive data blocks are copied at once */
+            if ((run_len != 0) && (block_number != 0) && (block_number == next_block_number))
+            {
+                run_len += T3T_MSG_BLOCKSIZE;
+                next_block_number++;
+                continue;
+            }
+
+            if (run_len != 0)
+            {
+                ARRAY_TO_STREAM (p_dst, p_run, run_len);
+                run_len = 0;
+            }
+
+            if (block_number == 0)
+            {
+                /* Special caes: NDEF block0 is the ndef attribute block */
+                ARRAY_TO_STREAM (p_dst, p_cb->ndef_info.attr_block, T3T_MSG_BLOCKSIZE);
+            }
+            else
+            {
+                /* If card is RW, then read from the scratch buffer (so reader/write can read back what it had just written */
+                p_run             = &p_cb->ndef_info.p_check_buf[(block_number-1) * T3T_MSG_BLOCKSIZE];
+                run_len           = T3T_MSG_BLOCKSIZE;
+                next_block_number = block_number + 1;
+            }
+        }
+
+        if ((i == p_cb->cur_cmd.num_blocks) && (run_len != 0))
+        {
+            ARRAY_TO_STREAM (p_dst, p_run, run_len);
         }
 
         p_rsp_msg->len = (UINT16) (p_dst - p_rsp_start);
@@ -905,6 +944,10 @@ tNFC_STATUS ce_select_t3t (UINT16 system_code, UINT8 nfcid2[NCI_RF_F_UID_LEN])
     p_cb->system_code = system_code;
     memcpy (p_cb->local_nfcid2, nfcid2, NCI_RF_F_UID_LEN);
 
+    /* CHECK response starts with the response code and the NFCID2 */
+    p_cb->check_rsp_hdr[0] = T3T_MSG_OPC_CHECK_RSP;
+    memcpy (&p_cb->check_rsp_hdr[1], nfcid2, NCI_RF_F_UID_LEN);
+
     NFC_SetStaticRfCback (ce_t3t_conn_cback);
     return NFC_STATUS_OK;
 }
@@ -960,6 +1003,8 @@ tNFC_STATUS CE_T3tSetLocalNDEFMsg (BOOLEAN read_only,
             p_cb->ndef_info.scratch_writef  = T3T_MSG_NDEF_WRITEF_OFF;
             memcpy (p_scratch_buf, p_buf, p_cb->ndef_info.ln);
         }
+
+        ce_t3t_build_attr_block (p_cb);
     }
 
     return (NFC_STATUS_OK);
@@ -990,6 +1035,7 @@ tNFC_STATUS CE_T3tSetLocalNDefParams (UINT8 nbr, UINT8 nbw)
 
     p_cb->ndef_info.nbr = nbr;
     p_cb->ndef_info.nbw = nbw;
+    ce_t3t_build_attr_block (p_cb);
 
     return NFC_STATUS_OK;
 }
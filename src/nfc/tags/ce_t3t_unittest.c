@@ -0,0 +1,517 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2015 Broadcom Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  Host test and benchmark of the CE Type 3 Tag CHECK command.
+ *
+ *  ce_t3t.c is built into this file. CHECK commands are passed to
+ *  ce_t3t_data_cback as NFCC would, and the response given to
+ *  NFC_SendData() is compared with a response built block by block from
+ *  the NDEF attributes, the way CHECK was handled before the attribute
+ *  block and the response header were precomputed.
+ *
+ *  Checks:
+ *  - CHECK of the attribute block, of runs of data blocks, of blocks out
+ *    of order, and of the most blocks a CHECK may ask for
+ *  - a reader reads back an UPDATE from the scratch buffer
+ *  - too many blocks, a block past the NDEF memory, and a non NDEF
+ *    service are answered with an error
+ *
+ *  Reports the time ce_t3t_handle_check_cmd takes for a CHECK of
+ *  T3T_MSG_NUM_BLOCKS_CHECK_MAX blocks, with and without block 0, and the
+ *  time the handler took before, kept here as test_old_handle_check_cmd.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <time.h>
+
+#include "ce_t3t.c"
+
+#define TEST_NDEF_MAX       (64 * T3T_MSG_BLOCKSIZE)
+#define TEST_NDEF_LEN       700
+#define TEST_CHECK_ROUNDS   20000
+
+static int      test_failures;
+static UINT8    test_ndef[TEST_NDEF_MAX];
+static UINT8    test_scratch[TEST_NDEF_MAX];
+static UINT8    test_nfcid2[NCI_RF_F_UID_LEN] = {0x02, 0xFE, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+static UINT8    test_rsp[T3T_MSG_BLOCKSIZE * T3T_MSG_NUM_BLOCKS_CHECK_MAX + 32];
+static UINT16   test_rsp_len;
+static BT_HDR   *test_p_pool_buf;
+
+#define TEST_CHECK(cond) \
+    do { if (!(cond)) { printf ("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); test_failures++; } } while (0)
+
+/* stubs of the symbols ce_t3t.c needs from the rest of the stack */
+tCE_CB  ce_cb;
+void   *GKI_getpoolbuf (UINT8 pool_id) { return test_p_pool_buf; }
+void    GKI_freebuf (void *p_buf) {}
+void    NFC_SetStaticRfCback (tNFC_CONN_CBACK *p_cback) {}
+void    DispT3TagMessage (BT_HDR *p_msg, BOOLEAN is_rx) {}
+void    LogMsg_0 (UINT32 trace_set_mask, const char *p_str) {}
+void    LogMsg_1 (UINT32 trace_set_mask, const char *fmt_str, UINT32 p1) {}
+void    LogMsg_2 (UINT32 trace_set_mask, const char *fmt_str, UINT32 p1, UINT32 p2) {}
+void    LogMsg_3 (UINT32 trace_set_mask, const char *fmt_str, UINT32 p1, UINT32 p2, UINT32 p3) {}
+static void test_ce_cback (tCE_EVENT event, tCE_DATA *p_ce_data) {}
+
+/*******************************************************************************
+**
+** Function         NFC_SendData
+**
+** Description      Keep the response sent to the reader
+**
+*******************************************************************************/
+tNFC_STATUS NFC_SendData (UINT8 conn_id, BT_HDR *p_data)
+{
+    test_rsp_len = p_data->len;
+    if (test_rsp_len > sizeof (test_rsp))
+        test_rsp_len = sizeof (test_rsp);
+    memcpy (test_rsp, (UINT8 *) (p_data + 1) + p_data->offset, test_rsp_len);
+    return NFC_STATUS_OK;
+}
+
+/*******************************************************************************
+**
+** Function         test_now_ns
+**
+*******************************************************************************/
+static long long test_now_ns (void)
+{
+    struct timespec now;
+
+    clock_gettime (CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/*******************************************************************************
+**
+** Function         test_build_cmd
+**
+** Description      Build a CHECK or UPDATE command for blocks of one service
+**
+** Returns          command length
+**
+*******************************************************************************/
+static UINT16 test_build_cmd (UINT8 *p_cmd, UINT8 opcode, UINT16 service_code,
+                              const UINT16 *p_blocks, UINT8 num_blocks, const UINT8 *p_data)
+{
+    UINT8 *p = p_cmd + 1;
+    UINT8 xx;
+
+    UINT8_TO_STREAM (p, opcode);
+    ARRAY_TO_STREAM (p, test_nfcid2, NCI_RF_F_UID_LEN);
+    UINT8_TO_STREAM (p, 1);
+    UINT16_TO_STREAM (p, service_code);
+    UINT8_TO_STREAM (p, num_blocks);
+    for (xx = 0; xx < num_blocks; xx++)
+    {
+        if (p_blocks[xx] <= 0xFF)
+        {
+            UINT8_TO_STREAM (p, T3T_MSG_MASK_TWO_BYTE_BLOCK_DESC_FORMAT);
+            UINT8_TO_STREAM (p, p_blocks[xx]);
+        }
+        else
+        {
+            UINT8_TO_STREAM (p, 0);
+            UINT16_TO_STREAM (p, p_blocks[xx]);
+        }
+    }
+    if (p_data)
+        ARRAY_TO_STREAM (p, p_data, num_blocks * T3T_MSG_BLOCKSIZE);
+
+    p_cmd[0] = (UINT8) (p - p_cmd);
+    return (UINT16) (p - p_cmd);
+}
+
+/*******************************************************************************
+**
+** Function         test_send_cmd
+**
+** Description      Pass a command to CE as NFCC would
+**
+*******************************************************************************/
+static void test_send_cmd (BT_HDR *p_msg, const UINT8 *p_cmd, UINT16 len)
+{
+    tNFC_DATA_CEVT data;
+
+    p_msg->offset = NCI_MSG_OFFSET_SIZE + NCI_DATA_HDR_SIZE;
+    p_msg->len    = len;
+    memcpy ((UINT8 *) (p_msg + 1) + p_msg->offset, p_cmd, len);
+
+    data.status = NFC_STATUS_OK;
+    data.p_data = p_msg;
+    test_rsp_len = 0;
+    ce_t3t_data_cback (NFC_RF_CONN_ID, &data);
+}
+
+/*******************************************************************************
+**
+** Function         test_ref_check_rsp
+**
+** Description      Build the CHECK response block by block: the attribute
+**                  block and its checksum are built for block 0, each data
+**                  block is copied on its own
+**
+** Returns          response length
+**
+*******************************************************************************/
+static UINT16 test_ref_check_rsp (UINT8 *p_rsp, const UINT16 *p_blocks, UINT8 num_blocks,
+                                  const UINT8 *p_data, UINT32 ndef_len, UINT8 writef)
+{
+    tCE_T3T_NDEF_INFO *p_info = &ce_cb.mem.t3t.ndef_info;
+    UINT8   *p = p_rsp + 1, *p_attr;
+    const UINT8 *p_block;
+    UINT16  checksum;
+    UINT8   xx, yy;
+
+    UINT8_TO_STREAM (p, T3T_MSG_OPC_CHECK_RSP);
+    ARRAY_TO_STREAM (p, test_nfcid2, NCI_RF_F_UID_LEN);
+    UINT8_TO_STREAM (p, T3T_MSG_RSP_STATUS_OK);
+    UINT8_TO_STREAM (p, T3T_MSG_RSP_STATUS_OK);
+    UINT8_TO_STREAM (p, num_blocks);
+
+    for (xx = 0; xx < num_blocks; xx++)
+    {
+        if (p_blocks[xx] == 0)
+        {
+            p_attr = p;
+            UINT8_TO_STREAM (p, p_info->version);
+            UINT8_TO_STREAM (p, p_info->nbr);
+            UINT8_TO_STREAM (p, p_info->nbw);
+            UINT16_TO_BE_STREAM (p, p_info->nmaxb);
+            UINT32_TO_STREAM (p, 0);
+            UINT8_TO_STREAM (p, writef);
+            UINT8_TO_STREAM (p, p_info->rwflag);
+            UINT8_TO_STREAM (p, (ndef_len >> 16 & 0xFF));
+            UINT16_TO_BE_STREAM (p, (ndef_len & 0xFFFF));
+            for (checksum = 0, yy = 0; yy < T3T_MSG_NDEF_ATTR_INFO_SIZE; yy++)
+                checksum += p_attr[yy];
+            UINT16_TO_BE_STREAM (p, checksum);
+        }
+        else
+        {
+            p_block = &p_data[(p_blocks[xx] - 1) * T3T_MSG_BLOCKSIZE];
+            ARRAY_TO_STREAM (p, p_block, T3T_MSG_BLOCKSIZE);
+        }
+    }
+
+    p_rsp[0] = (UINT8) (p - p_rsp);
+    return (UINT16) (p - p_rsp);
+}
+
+/*******************************************************************************
+**
+** Function         test_old_handle_check_cmd
+**
+** Description      ce_t3t_handle_check_cmd as it was before the attribute
+**                  block and the response header were precomputed. The
+**                  checksum loop has its own index, the old one reused i
+**                  and cut a CHECK with block 0 short.
+**
+** Returns          Nothing
+**
+*******************************************************************************/
+static void test_old_handle_check_cmd (tCE_CB *p_ce_cb, BT_HDR *p_cmd_msg)
+{
+    tCE_T3T_MEM *p_cb = &p_ce_cb->mem.t3t;
+    BT_HDR *p_rsp_msg;
+    UINT8 *p_rsp_start;
+    UINT8 *p_dst, *p_temp, *p_status;
+    UINT8 *p_src = p_cb->cur_cmd.p_block_list_start;
+    UINT8 i, j, bl0;
+    UINT8 ndef_writef;
+    UINT32 ndef_len;
+    UINT16 block_number, service_code, checksum;
+
+    if ((p_rsp_msg = ce_t3t_get_rsp_buf ()) != NULL)
+    {
+        p_dst = p_rsp_start = (UINT8 *) (p_rsp_msg+1) + p_rsp_msg->offset;
+
+        /* Response Code */
+        UINT8_TO_STREAM (p_dst, T3T_MSG_OPC_CHECK_RSP);
+
+        /* Manufacturer ID */
+        ARRAY_TO_STREAM (p_dst, p_cb->local_nfcid2, NCI_RF_F_UID_LEN);
+
+        /* Save pointer to start of status field */
+        p_status = p_dst;
+
+        /* Status1 and Status2 (assume success initially */
+        UINT8_TO_STREAM (p_dst, T3T_MSG_RSP_STATUS_OK);
+        UINT8_TO_STREAM (p_dst, T3T_MSG_RSP_STATUS_OK);
+        UINT8_TO_STREAM (p_dst, p_cb->cur_cmd.num_blocks);
+
+        for (i = 0; i < p_cb->cur_cmd.num_blocks; i++)
+        {
+            /* Read byte0 of block list */
+            STREAM_TO_UINT8 (bl0, p_src);
+
+            if (bl0 & T3T_MSG_MASK_TWO_BYTE_BLOCK_DESC_FORMAT)
+            {
+                STREAM_TO_UINT8 (block_number, p_src);
+            }
+            else
+            {
+                STREAM_TO_UINT16 (block_number, p_src);
+            }
+
+            /* Read the block from memory */
+            service_code = p_cb->cur_cmd.service_code_list[bl0 & T3T_MSG_SERVICE_LIST_MASK];
+
+            /* Check for NDEF */
+            if ((service_code == T3T_MSG_NDEF_SC_RO) || (service_code == T3T_MSG_NDEF_SC_RW))
+            {
+                /* Verify Nbr (NDEF only) */
+                if (p_cb->cur_cmd.num_blocks > p_cb->ndef_info.nbr)
+                {
+                    /* Error: invalid number of blocks to check */
+                    CE_TRACE_ERROR2 ("CE: Requested too many blocks to check (requested: %i, max: %i)", p_cb->cur_cmd.num_blocks, p_cb->ndef_info.nbr);
+
+                    p_dst = p_status;
+                    UINT8_TO_STREAM (p_dst, T3T_MSG_RSP_STATUS_ERROR);
+                    UINT8_TO_STREAM (p_dst, T3T_MSG_RSP_STATUS2_ERROR_MEMORY);
+                    break;
+                }
+                else if (block_number == 0)
+                {
+                    /* Special caes: NDEF block0 is the ndef attribute block */
+                    p_temp = p_dst;
+
+                    /* For rw ndef, use scratch buffer's attributes (in case reader/writer had previously updated NDEF) */
+                    if ((p_cb->ndef_info.rwflag == T3T_MSG_NDEF_RWFLAG_RW) && (p_cb->ndef_info.p_scratch_buf))
+                    {
+                        ndef_writef = p_cb->ndef_info.scratch_writef;
+                        ndef_len    = p_cb->ndef_info.scratch_ln;
+                    }
+                    else
+                    {
+                        ndef_writef = p_cb->ndef_info.writef;
+                        ndef_len    = p_cb->ndef_info.ln;
+                    }
+
+                    UINT8_TO_STREAM (p_dst, p_cb->ndef_info.version);
+                    UINT8_TO_STREAM (p_dst, p_cb->ndef_info.nbr);
+                    UINT8_TO_STREAM (p_dst, p_cb->ndef_info.nbw);
+                    UINT16_TO_BE_STREAM (p_dst, p_cb->ndef_info.nmaxb);
+                    UINT32_TO_STREAM (p_dst, 0);
+                    UINT8_TO_STREAM (p_dst, ndef_writef);
+                    UINT8_TO_STREAM (p_dst, p_cb->ndef_info.rwflag);
+                    UINT8_TO_STREAM (p_dst, (ndef_len >> 16 & 0xFF));
+                    UINT16_TO_BE_STREAM (p_dst, (ndef_len & 0xFFFF));
+
+                    checksum = 0;
+                    for (j = 0; j < T3T_MSG_NDEF_ATTR_INFO_SIZE; j++)
+                    {
+                        checksum+=p_temp[j];
+                    }
+                    UINT16_TO_BE_STREAM (p_dst, checksum);
+                }
+                else
+                {
+                    /* Verify that block_number is within NDEF memory */
+                    if (block_number > p_cb->ndef_info.nmaxb)
+                    {
+                        /* Invalid block number */
+                        p_dst = p_status;
+
+                        CE_TRACE_ERROR1 ("CE: Requested block number to check %i.", block_number);
+
+                        /* Error: invalid number of blocks to check */
+                        UINT8_TO_STREAM (p_dst, T3T_MSG_RSP_STATUS_ERROR);
+                        UINT8_TO_STREAM (p_dst, T3T_MSG_RSP_STATUS2_ERROR_MEMORY);
+                        break;
+                    }
+                    else
+                    {
+                        /* If card is RW, then read from the scratch buffer (so reader/write can read back what it had just written */
+                        if ((p_cb->ndef_info.rwflag == T3T_MSG_NDEF_RWFLAG_RW) && (p_cb->ndef_info.p_scratch_buf))
+                        {
+                            ARRAY_TO_STREAM (p_dst, (&p_cb->ndef_info.p_scratch_buf[(block_number-1) * T3T_MSG_BLOCKSIZE]), T3T_MSG_BLOCKSIZE);
+                        }
+                        else
+                        {
+                            ARRAY_TO_STREAM (p_dst, (&p_cb->ndef_info.p_buf[(block_number-1) * T3T_MSG_BLOCKSIZE]), T3T_MSG_BLOCKSIZE);
+                        }
+                    }
+                }
+            }
+            else
+            {
+                /* Error: invalid service code */
+                CE_TRACE_ERROR1 ("CE: Requested invalid service code: 0x%04x.", service_code);
+
+                p_dst = p_status;
+                UINT8_TO_STREAM (p_dst, T3T_MSG_RSP_STATUS_ERROR);
+                UINT8_TO_STREAM (p_dst, T3T_MSG_RSP_STATUS2_ERROR_MEMORY);
+                break;
+            }
+        }
+
+        p_rsp_msg->len = (UINT16) (p_dst - p_rsp_start);
+        ce_t3t_send_to_lower (p_rsp_msg);
+    }
+    else
+    {
+        CE_TRACE_ERROR0 ("CE: Unable to allocat buffer for response message");
+    }
+
+    GKI_freebuf (p_cmd_msg);
+}
+
+/*******************************************************************************
+**
+** Function         test_check
+**
+** Description      Send a CHECK and compare the response with the reference
+**
+*******************************************************************************/
+static void test_check (BT_HDR *p_msg, const UINT16 *p_blocks, UINT8 num_blocks,
+                        const UINT8 *p_data, UINT32 ndef_len, UINT8 writef)
+{
+    UINT8   cmd[64], ref[sizeof (test_rsp)];
+    UINT16  len, ref_len;
+
+    len = test_build_cmd (cmd, T3T_MSG_OPC_CHECK_CMD, T3T_MSG_NDEF_SC_RO, p_blocks, num_blocks, NULL);
+    test_send_cmd (p_msg, cmd, len);
+
+    ref_len = test_ref_check_rsp (ref, p_blocks, num_blocks, p_data, ndef_len, writef);
+    TEST_CHECK (test_rsp_len == ref_len);
+    TEST_CHECK (memcmp (test_rsp, ref, ref_len) == 0);
+}
+
+/*******************************************************************************
+**
+** Function         test_check_error
+**
+** Description      Send a CHECK that must be answered with an error
+**
+*******************************************************************************/
+static void test_check_error (BT_HDR *p_msg, UINT16 service_code, const UINT16 *p_blocks, UINT8 num_blocks)
+{
+    UINT8   cmd[64];
+    UINT16  len;
+
+    len = test_build_cmd (cmd, T3T_MSG_OPC_CHECK_CMD, service_code, p_blocks, num_blocks, NULL);
+    test_send_cmd (p_msg, cmd, len);
+
+    /* SoD, response code, NFCID2, status1 */
+    TEST_CHECK (test_rsp_len >= 2 + NCI_RF_F_UID_LEN + 2);
+    TEST_CHECK (test_rsp[1] == T3T_MSG_OPC_CHECK_RSP);
+    TEST_CHECK (test_rsp[2 + NCI_RF_F_UID_LEN] == T3T_MSG_RSP_STATUS_ERROR);
+}
+
+int main (void)
+{
+    static UINT8 pool_buf[sizeof (BT_HDR) + 512];
+    static UINT8 msg_buf[sizeof (BT_HDR) + 512];
+    BT_HDR  *p_msg = (BT_HDR *) msg_buf;
+    UINT16  blocks[T3T_MSG_NUM_BLOCKS_CHECK_MAX + 1];
+    UINT8   cmd[256], ref[sizeof (test_rsp)], data[2 * T3T_MSG_BLOCKSIZE];
+    UINT16  len, ref_len;
+    long long start, new_ns, old_ns;
+    int     xx, yy;
+
+    test_p_pool_buf = (BT_HDR *) pool_buf;
+    for (xx = 0; xx < TEST_NDEF_MAX; xx++)
+        test_ndef[xx] = (UINT8) (xx * 7 + 3);
+
+    ce_cb.p_cback = test_ce_cback;
+    ce_t3t_init ();
+    ce_select_t3t (T3T_SYSTEM_CODE_NDEF, test_nfcid2);
+    TEST_CHECK (CE_T3tSetLocalNDEFMsg (FALSE, TEST_NDEF_MAX, TEST_NDEF_LEN, test_ndef, test_scratch) == NFC_STATUS_OK);
+    TEST_CHECK (CE_T3tSetLocalNDefParams (T3T_MSG_NUM_BLOCKS_CHECK_MAX, 4) == NFC_STATUS_OK);
+
+    /* attribute block alone, then with the first data blocks */
+    blocks[0] = 0;
+    test_check (p_msg, blocks, 1, test_scratch, TEST_NDEF_LEN, T3T_MSG_NDEF_WRITEF_OFF);
+    for (xx = 0; xx < 5; xx++)
+        blocks[xx] = (UINT16) xx;
+    test_check (p_msg, blocks, 5, test_scratch, TEST_NDEF_LEN, T3T_MSG_NDEF_WRITEF_OFF);
+
+    /* runs broken by gaps, block 0 and blocks out of order */
+    blocks[0] = 3; blocks[1] = 4; blocks[2] = 0; blocks[3] = 1; blocks[4] = 9; blocks[5] = 10;
+    blocks[6] = 12; blocks[7] = 11; blocks[8] = 11; blocks[9] = 64;
+    test_check (p_msg, blocks, 10, test_scratch, TEST_NDEF_LEN, T3T_MSG_NDEF_WRITEF_OFF);
+
+    /* most blocks a CHECK may ask for */
+    for (xx = 0; xx < T3T_MSG_NUM_BLOCKS_CHECK_MAX; xx++)
+        blocks[xx] = (UINT16) (xx + 20);
+    test_check (p_msg, blocks, T3T_MSG_NUM_BLOCKS_CHECK_MAX, test_scratch, TEST_NDEF_LEN, T3T_MSG_NDEF_WRITEF_OFF);
+
+    /* UPDATE of the attribute block and one data block is read back */
+    memset (data, 0, sizeof (data));
+    data[0]  = 0x10;                            /* version */
+    data[9]  = T3T_MSG_NDEF_WRITEF_ON;
+    data[12] = 0x01;                            /* length 0x000123 */
+    data[13] = 0x23;
+    for (xx = 0, len = 0; xx < T3T_MSG_NDEF_ATTR_INFO_SIZE; xx++)
+        len += data[xx];
+    data[T3T_MSG_NDEF_ATTR_INFO_SIZE]     = (UINT8) (len >> 8);
+    data[T3T_MSG_NDEF_ATTR_INFO_SIZE + 1] = (UINT8) len;
+    memset (&data[T3T_MSG_BLOCKSIZE], 0xA5, T3T_MSG_BLOCKSIZE);
+    blocks[0] = 0;
+    blocks[1] = 2;
+    len = test_build_cmd (cmd, T3T_MSG_OPC_UPDATE_CMD, T3T_MSG_NDEF_SC_RW, blocks, 2, data);
+    test_send_cmd (p_msg, cmd, len);
+    TEST_CHECK (test_rsp_len > 2 + NCI_RF_F_UID_LEN && test_rsp[2 + NCI_RF_F_UID_LEN] == T3T_MSG_RSP_STATUS_OK);
+    blocks[2] = 1;
+    test_check (p_msg, blocks, 3, test_scratch, 0x123, T3T_MSG_NDEF_WRITEF_ON);
+    TEST_CHECK (memcmp (&test_scratch[T3T_MSG_BLOCKSIZE], &data[T3T_MSG_BLOCKSIZE], T3T_MSG_BLOCKSIZE) == 0);
+
+    /* errors */
+    for (xx = 0; xx <= T3T_MSG_NUM_BLOCKS_CHECK_MAX; xx++)
+        blocks[xx] = (UINT16) (xx + 1);
+    test_check_error (p_msg, T3T_MSG_NDEF_SC_RO, blocks, T3T_MSG_NUM_BLOCKS_CHECK_MAX + 1);
+    blocks[0] = 65;
+    test_check_error (p_msg, T3T_MSG_NDEF_SC_RO, blocks, 1);
+    blocks[0] = 1;
+    test_check_error (p_msg, 0x1009, blocks, 1);
+
+    /* time a CHECK of the most blocks, with and without the attribute block */
+    for (yy = 0; yy < 2; yy++)
+    {
+        for (xx = 0; xx < T3T_MSG_NUM_BLOCKS_CHECK_MAX; xx++)
+            blocks[xx] = (UINT16) (xx + 1 - yy);
+        len = test_build_cmd (cmd, T3T_MSG_OPC_CHECK_CMD, T3T_MSG_NDEF_SC_RO, blocks, T3T_MSG_NUM_BLOCKS_CHECK_MAX, NULL);
+        test_send_cmd (p_msg, cmd, len);
+
+        test_old_handle_check_cmd (&ce_cb, p_msg);
+        memcpy (ref, test_rsp, test_rsp_len);
+        ref_len = test_rsp_len;
+        ce_t3t_handle_check_cmd (&ce_cb, p_msg);
+        TEST_CHECK (test_rsp_len == ref_len);
+        TEST_CHECK (memcmp (test_rsp, ref, ref_len) == 0);
+
+        start = test_now_ns ();
+        for (xx = 0; xx < TEST_CHECK_ROUNDS; xx++)
+            ce_t3t_handle_check_cmd (&ce_cb, p_msg);
+        new_ns = test_now_ns () - start;
+
+        start = test_now_ns ();
+        for (xx = 0; xx < TEST_CHECK_ROUNDS; xx++)
+            test_old_handle_check_cmd (&ce_cb, p_msg);
+        old_ns = test_now_ns () - start;
+
+        printf ("CHECK of %d blocks%s: %lld ns, before: %lld ns\n", T3T_MSG_NUM_BLOCKS_CHECK_MAX,
+                yy ? " with block 0" : "", new_ns / TEST_CHECK_ROUNDS, old_ns / TEST_CHECK_ROUNDS);
+    }
+
+    printf ("%s\n", test_failures ? "FAILED" : "PASSED");
+    return test_failures ? 1 : 0;
+}
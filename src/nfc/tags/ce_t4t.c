@@ -409,6 +409,96 @@ static BOOLEAN ce_t4t_process_select_file_cmd (UINT8 *p_cmd)
     return FALSE;
 }
 
+/*******************************************************************************
+**
+** Function         ce_t4t_cmp_aid
+**
+** Description      Order the registered AIDs by AID, length and match type
+**
+** Returns          <0, 0 or >0 like memcmp
+**
+*******************************************************************************/
+static int ce_t4t_cmp_aid (tCE_T4T_REG_AID *p_reg_aid, UINT8 aid_len, UINT8 *p_aid, tCE_T4T_AID_MATCH match)
+{
+    int cmp;
+
+    cmp = memcmp (p_reg_aid->aid, p_aid, (p_reg_aid->aid_len < aid_len) ? p_reg_aid->aid_len : aid_len);
+    if (cmp == 0)
+        cmp = p_reg_aid->aid_len - aid_len;
+    if (cmp == 0)
+        cmp = p_reg_aid->match - match;
+    return cmp;
+}
+
+/*******************************************************************************
+**
+** Function         ce_t4t_search_aid
+**
+** Description      Binary search of the given AID in the sorted handles of
+**                  the registered AIDs
+**
+** Returns          the position of the first registered AID not less than
+**                  the given one. *p_found is TRUE if it is the given AID.
+**
+*******************************************************************************/
+static UINT8 ce_t4t_search_aid (UINT8 aid_len, UINT8 *p_aid, tCE_T4T_AID_MATCH match, BOOLEAN *p_found)
+{
+    tCE_T4T_MEM *p_t4t = &ce_cb.mem.t4t;
+    int         low = 0, high = p_t4t->num_reg_aid, mid, cmp;
+
+    *p_found = FALSE;
+    while (low < high)
+    {
+        mid = (low + high) / 2;
+        cmp = ce_t4t_cmp_aid (&p_t4t->p_reg_aid[p_t4t->p_sorted_aid[mid]], aid_len, p_aid, match);
+        if (cmp < 0)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            if (cmp == 0)
+                *p_found = TRUE;
+            high = mid;
+        }
+    }
+    return (UINT8) low;
+}
+
+/*******************************************************************************
+**
+** Function         ce_t4t_find_aid
+**
+** Description      Find the registered AID for the AID in SELECT by name.
+**                  The exact AID has priority, then the longest prefix.
+**
+** Returns          tCE_T4T_AID_HANDLE if found,
+**                  CE_T4T_AID_HANDLE_INVALID otherwise
+**
+*******************************************************************************/
+static tCE_T4T_AID_HANDLE ce_t4t_find_aid (UINT8 aid_len, UINT8 *p_aid)
+{
+    tCE_T4T_MEM *p_t4t = &ce_cb.mem.t4t;
+    UINT8       pos, len;
+    BOOLEAN     found;
+
+    pos = ce_t4t_search_aid (aid_len, p_aid, CE_T4T_AID_MATCH_EXACT, &found);
+    if (found)
+        return p_t4t->p_sorted_aid[pos];
+
+    /* at most NFC_MAX_AID_LEN searches, whatever the number of registered AIDs */
+    if (p_t4t->num_prefix_aid)
+    {
+        for (len = aid_len; len > 0; len--)
+        {
+            pos = ce_t4t_search_aid (len, p_aid, CE_T4T_AID_MATCH_PREFIX, &found);
+            if (found)
+                return p_t4t->p_sorted_aid[pos];
+        }
+    }
+    return CE_T4T_AID_HANDLE_INVALID;
+}
+
 /*******************************************************************************
 **
 ** Function         ce_t4t_process_select_app_cmd
@@ -423,7 +513,6 @@ static void ce_t4t_process_select_app_cmd (UINT8 *p_cmd, BT_HDR *p_c_apdu)
     UINT8    data_len;
     UINT16   status_words = 0x0000; /* invalid status words */
     tCE_DATA ce_data;
-    UINT8    xx;
 
     CE_TRACE_DEBUG0 ("ce_t4t_process_select_app_cmd ()");
 
@@ -459,20 +548,10 @@ static void ce_t4t_process_select_app_cmd (UINT8 *p_cmd, BT_HDR *p_c_apdu)
     ** if found, use callback of the application
     ** otherwise, return error and maintain the same status
     */
-    ce_cb.mem.t4t.selected_aid_idx = CE_T4T_MAX_REG_AID;
-    for (xx = 0; xx < CE_T4T_MAX_REG_AID; xx++)
-    {
-        if (  (ce_cb.mem.t4t.reg_aid[xx].aid_len > 0)
-            &&(ce_cb.mem.t4t.reg_aid[xx].aid_len == data_len)
-            &&(!(memcmp(ce_cb.mem.t4t.reg_aid[xx].aid, p_cmd, data_len)))  )
-        {
-            ce_cb.mem.t4t.selected_aid_idx = xx;
-            break;
-        }
-    }
+    ce_cb.mem.t4t.selected_aid_idx = ce_t4t_find_aid (data_len, p_cmd);
 
     /* if found matched AID */
-    if (ce_cb.mem.t4t.selected_aid_idx < CE_T4T_MAX_REG_AID)
+    if (ce_cb.mem.t4t.selected_aid_idx < ce_cb.mem.t4t.max_reg_aid)
     {
         ce_cb.mem.t4t.status &= ~ (CE_T4T_STATUS_CC_FILE_SELECTED);
         ce_cb.mem.t4t.status &= ~ (CE_T4T_STATUS_NDEF_SELECTED);
@@ -481,10 +560,10 @@ static void ce_t4t_process_select_app_cmd (UINT8 *p_cmd, BT_HDR *p_c_apdu)
         ce_cb.mem.t4t.status |= CE_T4T_STATUS_REG_AID_SELECTED;
 
         CE_TRACE_DEBUG4 ("ce_t4t_process_select_app_cmd (): Registered AID[%02X%02X%02X%02X...] is selected",
-                         ce_cb.mem.t4t.reg_aid[ce_cb.mem.t4t.selected_aid_idx].aid[0],
-                         ce_cb.mem.t4t.reg_aid[ce_cb.mem.t4t.selected_aid_idx].aid[1],
-                         ce_cb.mem.t4t.reg_aid[ce_cb.mem.t4t.selected_aid_idx].aid[2],
-                         ce_cb.mem.t4t.reg_aid[ce_cb.mem.t4t.selected_aid_idx].aid[3]);
+                         ce_cb.mem.t4t.p_reg_aid[ce_cb.mem.t4t.selected_aid_idx].aid[0],
+                         ce_cb.mem.t4t.p_reg_aid[ce_cb.mem.t4t.selected_aid_idx].aid[1],
+                         ce_cb.mem.t4t.p_reg_aid[ce_cb.mem.t4t.selected_aid_idx].aid[2],
+                         ce_cb.mem.t4t.p_reg_aid[ce_cb.mem.t4t.selected_aid_idx].aid[3]);
 
         ce_data.raw_frame.status = NFC_STATUS_OK;
         ce_data.raw_frame.p_data = p_c_apdu;
@@ -492,7 +571,7 @@ static void ce_t4t_process_select_app_cmd (UINT8 *p_cmd, BT_HDR *p_c_apdu)
 
         p_c_apdu = NULL;
 
-        (*(ce_cb.mem.t4t.reg_aid[ce_cb.mem.t4t.selected_aid_idx].p_cback)) (CE_T4T_RAW_FRAME_EVT, &ce_data);
+        (*(ce_cb.mem.t4t.p_reg_aid[ce_cb.mem.t4t.selected_aid_idx].p_cback)) (CE_T4T_RAW_FRAME_EVT, &ce_data);
     }
     else if (  (data_len == T4T_V20_NDEF_TAG_AID_LEN)
              &&(!memcmp(p_cmd, t4t_v20_ndef_tag_aid, data_len - 1))
@@ -688,14 +767,14 @@ static void ce_t4t_data_cback (UINT8 conn_id, tNFC_CONN_EVT event, tNFC_CONN *p_
         CE_TRACE_DEBUG0 ("CET4T: Forward raw frame to registered AID");
 
         /* forward raw frame to upper layer */
-        if (ce_cb.mem.t4t.selected_aid_idx < CE_T4T_MAX_REG_AID)
+        if (ce_cb.mem.t4t.selected_aid_idx < ce_cb.mem.t4t.max_reg_aid)
         {
             ce_data.raw_frame.status = p_data->data.status;
             ce_data.raw_frame.p_data = p_c_apdu;
             ce_data.raw_frame.aid_handle = ce_cb.mem.t4t.selected_aid_idx;
             p_c_apdu = NULL;
 
-            (*(ce_cb.mem.t4t.reg_aid[ce_cb.mem.t4t.selected_aid_idx].p_cback)) (CE_T4T_RAW_FRAME_EVT, &ce_data);
+            (*(ce_cb.mem.t4t.p_reg_aid[ce_cb.mem.t4t.selected_aid_idx].p_cback)) (CE_T4T_RAW_FRAME_EVT, &ce_data);
         }
         else
         {
@@ -960,6 +1039,93 @@ tNFC_STATUS CE_T4tSetLocalNDEFMsg (BOOLEAN    read_only,
     return NFC_STATUS_OK;
 }
 
+/*******************************************************************************
+**
+** Function         ce_t4t_register_aid
+**
+** Description      Add AID in the registered AID table. The table is
+**                  allocated with ce_t4t_max_reg_aid_cfg entries when the
+**                  first AID is registered.
+**
+** Returns          tCE_T4T_AID_HANDLE if successful,
+**                  CE_T4T_AID_HANDLE_INVALID otherwisse
+**
+*******************************************************************************/
+static tCE_T4T_AID_HANDLE ce_t4t_register_aid (UINT8 aid_len, UINT8 *p_aid, tCE_T4T_AID_MATCH match, tCE_CBACK *p_cback)
+{
+    tCE_T4T_MEM *p_t4t = &ce_cb.mem.t4t;
+    UINT8       xx, pos, max_reg_aid;
+    BOOLEAN     found;
+
+    if (aid_len > NFC_MAX_AID_LEN)
+    {
+        CE_TRACE_ERROR1 ("CE_T4tRegisterAID (): AID is up to %d bytes", NFC_MAX_AID_LEN);
+        return CE_T4T_AID_HANDLE_INVALID;
+    }
+
+    if (p_cback == NULL)
+    {
+        CE_TRACE_ERROR0 ("CE_T4tRegisterAID (): callback must be provided");
+        return CE_T4T_AID_HANDLE_INVALID;
+    }
+
+    if (p_t4t->p_reg_aid == NULL)
+    {
+        max_reg_aid = ce_t4t_max_reg_aid_cfg;
+        if ((max_reg_aid == 0) || (max_reg_aid > CE_T4T_MAX_REG_AID_LIMIT))
+            max_reg_aid = CE_T4T_MAX_REG_AID_LIMIT;
+
+        /* the table is followed by the sorted handles */
+        p_t4t->p_reg_aid = (tCE_T4T_REG_AID *) GKI_getbuf ((UINT16) (max_reg_aid * (sizeof (tCE_T4T_REG_AID) + 1)));
+        if (p_t4t->p_reg_aid == NULL)
+        {
+            CE_TRACE_ERROR0 ("CE_T4tRegisterAID (): No buffer for AID table");
+            return CE_T4T_AID_HANDLE_INVALID;
+        }
+        memset (p_t4t->p_reg_aid, 0, max_reg_aid * (sizeof (tCE_T4T_REG_AID) + 1));
+        p_t4t->p_sorted_aid     = (UINT8 *) (p_t4t->p_reg_aid + max_reg_aid);
+        p_t4t->max_reg_aid      = max_reg_aid;
+        p_t4t->num_reg_aid      = 0;
+        p_t4t->num_prefix_aid   = 0;
+    }
+
+    pos = ce_t4t_search_aid (aid_len, p_aid, match, &found);
+    if (found)
+    {
+        CE_TRACE_ERROR0 ("CE_T4tRegisterAID (): already registered");
+        return CE_T4T_AID_HANDLE_INVALID;
+    }
+
+    if (p_t4t->num_reg_aid >= p_t4t->max_reg_aid)
+    {
+        CE_TRACE_ERROR0 ("CE_T4tRegisterAID (): No resource");
+        return CE_T4T_AID_HANDLE_INVALID;
+    }
+
+    for (xx = 0; xx < p_t4t->max_reg_aid; xx++)
+    {
+        if (p_t4t->p_reg_aid[xx].aid_len == 0)
+        {
+            p_t4t->p_reg_aid[xx].aid_len = aid_len;
+            p_t4t->p_reg_aid[xx].match   = match;
+            p_t4t->p_reg_aid[xx].p_cback = p_cback;
+            memcpy (p_t4t->p_reg_aid[xx].aid, p_aid, aid_len);
+            break;
+        }
+    }
+
+    /* keep the handles sorted by AID */
+    memmove (&p_t4t->p_sorted_aid[pos + 1], &p_t4t->p_sorted_aid[pos], p_t4t->num_reg_aid - pos);
+    p_t4t->p_sorted_aid[pos] = xx;
+    p_t4t->num_reg_aid++;
+    if (match == CE_T4T_AID_MATCH_PREFIX)
+        p_t4t->num_prefix_aid++;
+
+    CE_TRACE_DEBUG1 ("CE_T4tRegisterAID (): handle 0x%02x registered", xx);
+
+    return (xx);
+}
+
 /*******************************************************************************
 **
 ** Function         CE_T4tRegisterAID
@@ -977,7 +1143,6 @@ tNFC_STATUS CE_T4tSetLocalNDEFMsg (BOOLEAN    read_only,
 tCE_T4T_AID_HANDLE CE_T4tRegisterAID (UINT8 aid_len, UINT8 *p_aid, tCE_CBACK *p_cback)
 {
     tCE_T4T_MEM *p_t4t = &ce_cb.mem.t4t;
-    UINT8       xx;
 
     /* Handle registering callback for wildcard AID (all AIDs) */
     if (aid_len == 0)
@@ -1000,50 +1165,38 @@ tCE_T4T_AID_HANDLE CE_T4tRegisterAID (UINT8 aid_len, UINT8 *p_aid, tCE_CBACK *p_
     CE_TRACE_API5 ("CE_T4tRegisterAID () AID [%02X%02X%02X%02X...], %d bytes",
                    *p_aid, *(p_aid+1), *(p_aid+2), *(p_aid+3), aid_len);
 
-    if (aid_len > NFC_MAX_AID_LEN)
-    {
-        CE_TRACE_ERROR1 ("CE_T4tRegisterAID (): AID is up to %d bytes", NFC_MAX_AID_LEN);
-        return CE_T4T_AID_HANDLE_INVALID;
-    }
+    return ce_t4t_register_aid (aid_len, p_aid, CE_T4T_AID_MATCH_EXACT, p_cback);
+}
 
-    if (p_cback == NULL)
+/*******************************************************************************
+**
+** Function         CE_T4tRegisterPrefixAID
+**
+** Description      Register AID prefix in CE T4T. Any AID starting with the
+**                  prefix is forwarded to p_cback, unless it is registered
+**                  with CE_T4tRegisterAID or a longer prefix.
+**
+**                  aid_len: length of AID prefix (up to NFC_MAX_AID_LEN)
+**                  p_aid:   AID prefix
+**                  p_cback: Raw frame will be forwarded with CE_RAW_FRAME_EVT
+**
+** Returns          tCE_T4T_AID_HANDLE if successful,
+**                  CE_T4T_AID_HANDLE_INVALID otherwisse
+**
+*******************************************************************************/
+tCE_T4T_AID_HANDLE CE_T4tRegisterPrefixAID (UINT8 aid_len, UINT8 *p_aid, tCE_CBACK *p_cback)
+{
+    if (aid_len == 0)
     {
-        CE_TRACE_ERROR0 ("CE_T4tRegisterAID (): callback must be provided");
+        /* use CE_T4tRegisterAID for the wildcard AID */
+        CE_TRACE_ERROR0 ("CE_T4tRegisterPrefixAID (): empty prefix");
         return CE_T4T_AID_HANDLE_INVALID;
     }
 
-    for (xx = 0; xx < CE_T4T_MAX_REG_AID; xx++)
-    {
-        if (  (p_t4t->reg_aid[xx].aid_len == aid_len)
-            &&(!(memcmp(p_t4t->reg_aid[xx].aid, p_aid, aid_len)))  )
-        {
-            CE_TRACE_ERROR0 ("CE_T4tRegisterAID (): already registered");
-            return CE_T4T_AID_HANDLE_INVALID;
-        }
-    }
-
-    for (xx = 0; xx < CE_T4T_MAX_REG_AID; xx++)
-    {
-        if (p_t4t->reg_aid[xx].aid_len == 0)
-        {
-            p_t4t->reg_aid[xx].aid_len = aid_len;
-            p_t4t->reg_aid[xx].p_cback = p_cback;
-            memcpy (p_t4t->reg_aid[xx].aid, p_aid, aid_len);
-            break;
-        }
-    }
-
-    if (xx >= CE_T4T_MAX_REG_AID)
-    {
-        CE_TRACE_ERROR0 ("CE_T4tRegisterAID (): No resource");
-        return CE_T4T_AID_HANDLE_INVALID;
-    }
-    else
-    {
-        CE_TRACE_DEBUG1 ("CE_T4tRegisterAID (): handle 0x%02x registered", xx);
-    }
+    CE_TRACE_API5 ("CE_T4tRegisterPrefixAID () AID [%02X%02X%02X%02X...], %d bytes",
+                   *p_aid, *(p_aid+1), *(p_aid+2), *(p_aid+3), aid_len);
 
-    return (xx);
+    return ce_t4t_register_aid (aid_len, p_aid, CE_T4T_AID_MATCH_PREFIX, p_cback);
 }
 
 /*******************************************************************************
@@ -1057,7 +1210,10 @@ tCE_T4T_AID_HANDLE CE_T4tRegisterAID (UINT8 aid_len, UINT8 *p_aid, tCE_CBACK *p_
 *******************************************************************************/
 NFC_API extern void CE_T4tDeregisterAID (tCE_T4T_AID_HANDLE aid_handle)
 {
-    tCE_T4T_MEM *p_t4t = &ce_cb.mem.t4t;
+    tCE_T4T_MEM     *p_t4t = &ce_cb.mem.t4t;
+    tCE_T4T_REG_AID *p_reg_aid;
+    UINT8           pos;
+    BOOLEAN         found;
 
     CE_TRACE_API1 ("CE_T4tDeregisterAID () handle 0x%02x", aid_handle);
 
@@ -1076,14 +1232,32 @@ NFC_API extern void CE_T4tDeregisterAID (tCE_T4T_AID_HANDLE aid_handle)
     }
 
     /* Deregister AID */
-    if ((aid_handle >= CE_T4T_MAX_REG_AID) || (p_t4t->reg_aid[aid_handle].aid_len==0))
+    if ((aid_handle >= p_t4t->max_reg_aid) || (p_t4t->p_reg_aid[aid_handle].aid_len==0))
     {
         CE_TRACE_ERROR0 ("CE_T4tDeregisterAID (): Invalid handle");
     }
     else
     {
-        p_t4t->reg_aid[aid_handle].aid_len = 0;
-        p_t4t->reg_aid[aid_handle].p_cback = NULL;
+        p_reg_aid = &p_t4t->p_reg_aid[aid_handle];
+        pos = ce_t4t_search_aid (p_reg_aid->aid_len, p_reg_aid->aid, p_reg_aid->match, &found);
+        if (found)
+        {
+            memmove (&p_t4t->p_sorted_aid[pos], &p_t4t->p_sorted_aid[pos + 1], p_t4t->num_reg_aid - pos - 1);
+            p_t4t->num_reg_aid--;
+            if (p_reg_aid->match == CE_T4T_AID_MATCH_PREFIX)
+                p_t4t->num_prefix_aid--;
+        }
+        p_reg_aid->aid_len = 0;
+        p_reg_aid->p_cback = NULL;
+
+        /* Free the table with the last AID, it is allocated again on next registration */
+        if (p_t4t->num_reg_aid == 0)
+        {
+            GKI_freebuf (p_t4t->p_reg_aid);
+            p_t4t->p_reg_aid        = NULL;
+            p_t4t->p_sorted_aid     = NULL;
+            p_t4t->max_reg_aid      = 0;
+        }
     }
 }
 
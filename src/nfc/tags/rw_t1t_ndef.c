@@ -45,6 +45,9 @@ static tNFC_STATUS rw_t1t_handle_tlv_detect_rsp (UINT8 *p_data);
 static tNFC_STATUS rw_t1t_handle_ndef_read_rsp (UINT8 *p_data);
 static tNFC_STATUS rw_t1t_handle_ndef_write_rsp (UINT8 *p_data);
 static tNFC_STATUS rw_t1t_handle_ndef_rall_rsp (void);
+static void rw_t1t_copy_ndef_bytes (UINT8 *p_data, UINT16 start, UINT16 len);
+static tNFC_STATUS rw_t1t_plan_ndef_read (void);
+static tNFC_STATUS rw_t1t_send_ndef_read_cmd (void);
 static tNFC_STATUS rw_t1t_ndef_write_first_block (void);
 static tNFC_STATUS rw_t1t_next_ndef_write_block (void);
 static tNFC_STATUS rw_t1t_send_ndef_byte (UINT8 data, UINT8 block, UINT8 index, UINT8 msg_len);
@@ -1242,53 +1245,19 @@ static tNFC_STATUS rw_t1t_handle_ndef_rall_rsp (void)
 {
     tRW_T1T_CB  *p_t1t  = &rw_cb.tcb.t1t;
     tNFC_STATUS status  = NFC_STATUS_CONTINUE;
-    UINT8       count;
-    UINT8       adds;
 
-    count               = (UINT8) p_t1t->ndef_msg_offset;
     p_t1t->work_offset  = 0;
-    p_t1t->segment      = 0;
+    p_t1t->read_offset  = p_t1t->ndef_msg_offset;
+
+    rw_t1t_copy_ndef_bytes (p_t1t->mem, 0, T1T_STATIC_SIZE);
 
-    while (count < T1T_STATIC_SIZE && p_t1t->work_offset < p_t1t->ndef_msg_len)
-    {
-        if (rw_t1t_is_lock_reserved_otp_byte (count) == FALSE)
-        {
-            p_t1t->p_ndef_buffer[p_t1t->work_offset] = p_t1t->mem[count];
-            p_t1t->work_offset++;
-        }
-        count++;
-    }
     if (p_t1t->work_offset != p_t1t->ndef_msg_len)
     {
         if ((p_t1t->hr[0] & 0x0F) != 1)
         {
-            if (p_t1t->work_offset == 0)
-                return NFC_STATUS_FAILED;
-
-            else
-            {
-                p_t1t->block_read   = T1T_STATIC_BLOCKS + 1;
-                p_t1t->segment++;
-            }
-            if (p_t1t->ndef_msg_len - p_t1t->work_offset <= 8)
-            {
-                if ((status = rw_t1t_send_dyn_cmd (T1T_CMD_READ8, p_t1t->block_read, NULL)) == NFC_STATUS_OK)
-                {
-                    p_t1t->tlv_detect  = TAG_NDEF_TLV;
-                    p_t1t->state    = RW_T1T_STATE_READ_NDEF;
-                    status          = NFC_STATUS_CONTINUE;
-                }
-            }
-            else
-            {
-                /* send RSEG command */
-                RW_T1T_BLD_ADDS ((adds), (p_t1t->segment));
-                if ((status = rw_t1t_send_dyn_cmd (T1T_CMD_RSEG, adds, NULL)) == NFC_STATUS_OK)
-                {
-                    p_t1t->state    = RW_T1T_STATE_READ_NDEF;
-                    status          = NFC_STATUS_CONTINUE;
-                }
-            }
+            /* Read rest of the NDEF message from the dynamic memory */
+            if ((status = rw_t1t_plan_ndef_read ()) == NFC_STATUS_OK)
+                status = rw_t1t_send_ndef_read_cmd ();
         }
         else
         {
@@ -1319,88 +1288,193 @@ static tNFC_STATUS rw_t1t_handle_ndef_read_rsp (UINT8 *p_data)
 {
     tNFC_STATUS         ndef_status = NFC_STATUS_CONTINUE;
     tRW_T1T_CB          *p_t1t      = &rw_cb.tcb.t1t;
-    UINT8               index;
-    UINT8               adds;
     tT1T_CMD_RSP_INFO   *p_cmd_rsp_info = (tT1T_CMD_RSP_INFO *) rw_cb.tcb.t1t.p_cmd_rsp_info;
 
     /* The Response received could be for Read8 or Read Segment command */
     switch(p_cmd_rsp_info->opcode)
     {
     case T1T_CMD_READ8:
-        if (p_t1t->work_offset == 0)
-        {
-            index = p_t1t->ndef_msg_offset % T1T_BLOCK_SIZE;
-        }
-        else
+        rw_t1t_copy_ndef_bytes (p_data, (UINT16) (p_t1t->block_read * T1T_BLOCK_SIZE), T1T_BLOCK_SIZE);
+        break;
+
+    case T1T_CMD_RSEG:
+        rw_t1t_copy_ndef_bytes (p_data, (UINT16) (p_t1t->segment * T1T_SEGMENT_SIZE), T1T_SEGMENT_SIZE);
+        break;
+
+    default:
+        break;
+    }
+    if (p_t1t->work_offset < p_t1t->ndef_msg_len)
+    {
+        /* Send the next planned command back to back */
+        ndef_status = rw_t1t_send_ndef_read_cmd ();
+    }
+    else
+    {
+        ndef_status = NFC_STATUS_OK;
+    }
+    return ndef_status;
+}
+
+/*******************************************************************************
+**
+** Function         rw_t1t_copy_ndef_bytes
+**
+** Description      This function copies NDEF bytes from the tag data read
+**                  by RALL/RSEG/READ8 to the NDEF buffer, skipping the
+**                  lock/reserved/otp bytes and bytes already copied
+**
+** Parameters:      p_data, tag data read starting at tag offset 'start'
+**                  start, tag offset of the first byte in p_data
+**                  len, number of bytes in p_data
+**
+** Returns          None
+**
+*******************************************************************************/
+static void rw_t1t_copy_ndef_bytes (UINT8 *p_data, UINT16 start, UINT16 len)
+{
+    tRW_T1T_CB  *p_t1t  = &rw_cb.tcb.t1t;
+    UINT16      index   = 0;
+
+    if (p_t1t->read_offset > start)
+        index = p_t1t->read_offset - start;
+
+    p_t1t->segment = (UINT8) (start / T1T_SEGMENT_SIZE);
+
+    while (index < len && p_t1t->work_offset < p_t1t->ndef_msg_len)
+    {
+        if (rw_t1t_is_lock_reserved_otp_byte ((UINT16) (start + index)) == FALSE)
         {
-            index = 0;
+            p_t1t->p_ndef_buffer[p_t1t->work_offset] = p_data[index];
+            p_t1t->work_offset++;
         }
-        p_t1t->segment = (p_t1t->block_read * T1T_BLOCK_SIZE)/T1T_SEGMENT_SIZE;
-        while (index < T1T_BLOCK_SIZE && p_t1t->work_offset < p_t1t->ndef_msg_len)
+        index++;
+    }
+    if (start + index > p_t1t->read_offset)
+        p_t1t->read_offset = start + index;
+}
+
+/*******************************************************************************
+**
+** Function         rw_t1t_plan_ndef_read
+**
+** Description      This function prepares the list of commands to read the
+**                  rest of the NDEF message, starting from p_t1t->read_offset.
+**                  Blocks holding only lock/reserved/otp bytes are skipped.
+**                  A segment with a single block to read is read using READ8
+**                  and a segment with more blocks to read is read using RSEG,
+**                  so at most one command is sent per segment
+**
+** Returns          NFC_STATUS_OK, if the NDEF message fits in the tag
+**                  NFC_STATUS_FAILED, otherwise
+**
+*******************************************************************************/
+static tNFC_STATUS rw_t1t_plan_ndef_read (void)
+{
+    tRW_T1T_CB          *p_t1t      = &rw_cb.tcb.t1t;
+    tRW_T1T_READ_CMD    *p_cmd      = NULL;
+    UINT16              tag_size    = (p_t1t->mem[T1T_CC_TMS_BYTE] + 1) * T1T_BLOCK_SIZE;
+    UINT16              remaining   = p_t1t->ndef_msg_len - p_t1t->work_offset;
+    UINT16              offset      = p_t1t->read_offset;
+    UINT16              block_end;
+    UINT8               block;
+    BOOLEAN             b_ndef_bytes;
+
+    p_t1t->num_read_cmds    = 0;
+    p_t1t->read_cmd_index   = 0;
+
+    while (remaining > 0 && offset < tag_size)
+    {
+        block           = (UINT8) (offset / T1T_BLOCK_SIZE);
+        block_end       = (block + 1) * T1T_BLOCK_SIZE;
+        p_t1t->segment  = block / T1T_BLOCKS_PER_SEGMENT;
+        b_ndef_bytes    = FALSE;
+
+        /* Find if the block holds any of the remaining NDEF bytes */
+        while (offset < block_end && remaining > 0)
         {
-            if (rw_t1t_is_lock_reserved_otp_byte ((UINT16) ((p_t1t->block_read * T1T_BLOCK_SIZE) + index)) == FALSE)
+            if (rw_t1t_is_lock_reserved_otp_byte (offset) == FALSE)
             {
-                p_t1t->p_ndef_buffer[p_t1t->work_offset] = p_data[index];
-                p_t1t->work_offset++;
+                b_ndef_bytes = TRUE;
+                remaining--;
             }
-            index++;
+            offset++;
         }
-        break;
+        offset = block_end;
 
-    case T1T_CMD_RSEG:
-        if (p_t1t->work_offset == 0)
+        if (b_ndef_bytes == FALSE)
+            continue;
+
+        if (  (p_cmd != NULL)
+            &&(p_cmd->opcode == T1T_CMD_READ8)
+            &&(p_cmd->addr / T1T_BLOCKS_PER_SEGMENT == p_t1t->segment)  )
         {
-            index = p_t1t->ndef_msg_offset % T1T_SEGMENT_SIZE;
+            /* Another block in the same segment, read the whole segment */
+            p_cmd->opcode   = T1T_CMD_RSEG;
+            p_cmd->addr     = p_t1t->segment;
         }
-        else
+        else if (  (p_cmd == NULL)
+                 ||(p_cmd->opcode != T1T_CMD_RSEG)
+                 ||(p_cmd->addr != p_t1t->segment)  )
         {
-            index = 0;
+            p_cmd           = &p_t1t->read_cmd[p_t1t->num_read_cmds++];
+            p_cmd->opcode   = T1T_CMD_READ8;
+            p_cmd->addr     = block;
         }
-        p_t1t->block_read = ((p_t1t->segment + 1) * T1T_BLOCKS_PER_SEGMENT) - 1;
+    }
 
-        while (index < T1T_SEGMENT_SIZE && p_t1t->work_offset < p_t1t->ndef_msg_len)
-        {
-            if (rw_t1t_is_lock_reserved_otp_byte ((UINT16) (index)) == FALSE)
-            {
-                p_t1t->p_ndef_buffer[p_t1t->work_offset] = p_data[index];
-                p_t1t->work_offset++;
-            }
-            index++;
-        }
-        break;
+    if (remaining > 0)
+    {
+        RW_TRACE_ERROR1 ("rw_t1t_plan_ndef_read - NDEF len: %u exceeds tag size", p_t1t->ndef_msg_len);
+        return NFC_STATUS_FAILED;
+    }
 
-    default:
-        break;
+    RW_TRACE_DEBUG2 ("rw_t1t_plan_ndef_read - %u commands to read %u bytes", p_t1t->num_read_cmds, p_t1t->ndef_msg_len - p_t1t->work_offset);
+    return NFC_STATUS_OK;
+}
+
+/*******************************************************************************
+**
+** Function         rw_t1t_send_ndef_read_cmd
+**
+** Description      This function sends the next command planned by
+**                  rw_t1t_plan_ndef_read to read the NDEF message
+**
+** Returns          NFC_STATUS_CONTINUE, if the command is sent
+**                  NFC_STATUS_FAILED, otherwise
+**
+*******************************************************************************/
+static tNFC_STATUS rw_t1t_send_ndef_read_cmd (void)
+{
+    tRW_T1T_CB          *p_t1t  = &rw_cb.tcb.t1t;
+    tRW_T1T_READ_CMD    *p_cmd;
+    tNFC_STATUS         status;
+    UINT8               adds;
+
+    if (p_t1t->read_cmd_index >= p_t1t->num_read_cmds)
+    {
+        RW_TRACE_ERROR1 ("rw_t1t_send_ndef_read_cmd - NDEF read incomplete, read %u bytes", p_t1t->work_offset);
+        return NFC_STATUS_FAILED;
     }
-    if (p_t1t->work_offset < p_t1t->ndef_msg_len)
+    p_cmd = &p_t1t->read_cmd[p_t1t->read_cmd_index++];
+
+    if (p_cmd->opcode == T1T_CMD_RSEG)
     {
-        if ((p_t1t->hr[0] & 0x0F) != 1)
-        {
-            if ((p_t1t->ndef_msg_len - p_t1t->work_offset) <= T1T_BLOCK_SIZE)
-            {
-                p_t1t->block_read++;
-                if ((ndef_status = rw_t1t_send_dyn_cmd (T1T_CMD_READ8, (UINT8) (p_t1t->block_read), NULL)) == NFC_STATUS_OK)
-                {
-                    ndef_status  = NFC_STATUS_CONTINUE;
-                }
-            }
-            else
-            {
-                p_t1t->segment++;
-                /* send RSEG command */
-                RW_T1T_BLD_ADDS ((adds), (p_t1t->segment));
-                if ((ndef_status = rw_t1t_send_dyn_cmd (T1T_CMD_RSEG, adds, NULL)) == NFC_STATUS_OK)
-                {
-                    ndef_status  = NFC_STATUS_CONTINUE;
-                }
-            }
-        }
+        p_t1t->segment = p_cmd->addr;
+        RW_T1T_BLD_ADDS ((adds), (p_t1t->segment));
+        status = rw_t1t_send_dyn_cmd (T1T_CMD_RSEG, adds, NULL);
     }
     else
     {
-        ndef_status = NFC_STATUS_OK;
+        p_t1t->block_read   = p_cmd->addr;
+        p_t1t->segment      = p_cmd->addr / T1T_BLOCKS_PER_SEGMENT;
+        status = rw_t1t_send_dyn_cmd (T1T_CMD_READ8, p_t1t->block_read, NULL);
     }
-    return ndef_status;
+
+    if (status == NFC_STATUS_OK)
+        status = NFC_STATUS_CONTINUE;
+
+    return status;
 }
 
 /*******************************************************************************
@@ -2499,7 +2573,6 @@ tNFC_STATUS RW_T1tReadNDef (UINT8 *p_buffer, UINT16 buf_len)
     tNFC_STATUS     status = NFC_STATUS_FAILED;
     tRW_T1T_CB      *p_t1t = &rw_cb.tcb.t1t;
     BOOLEAN         b_notify;
-    UINT8           adds;
     const tT1T_CMD_RSP_INFO *p_cmd_rsp_info_rall = t1t_cmd_to_rsp_info (T1T_CMD_RALL);
     const tT1T_CMD_RSP_INFO *p_cmd_rsp_info_rseg = t1t_cmd_to_rsp_info (T1T_CMD_RSEG);
 
@@ -2561,11 +2634,15 @@ tNFC_STATUS RW_T1tReadNDef (UINT8 *p_buffer, UINT16 buf_len)
     {
         p_t1t->segment      = 0;
         p_t1t->work_offset  = 0;
+        p_t1t->read_offset  = p_t1t->ndef_msg_offset;
         if ((p_t1t->hr[0] & 0x0F) != 1)
         {
-            /* send RSEG command */
-            RW_T1T_BLD_ADDS ((adds), (p_t1t->segment));
-            status = rw_t1t_send_dyn_cmd (T1T_CMD_RSEG, adds, NULL);
+            /* read NDEF message using planned RSEG/READ8 commands */
+            if ((status = rw_t1t_plan_ndef_read ()) == NFC_STATUS_OK)
+            {
+                if ((status = rw_t1t_send_ndef_read_cmd ()) == NFC_STATUS_CONTINUE)
+                    status = NFC_STATUS_OK;
+            }
         }
         else
         {
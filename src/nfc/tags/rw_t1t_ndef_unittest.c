@@ -0,0 +1,275 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2015 Broadcom Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  Host test of the NDEF read of a dynamic memory Type 1 Tag.
+ *
+ *  rw_t1t_ndef.c is built into this file. RW_T1tReadNDef() is run against
+ *  a simulated 512 byte Topaz tag: every RSEG or READ8 the reader sends is
+ *  logged and answered from the tag memory, until the read completes.
+ *
+ *  Each case gives the NDEF message offset and length, the reserved areas
+ *  of the memory control TLVs, and whether segment 0 is cached. It checks
+ *  - the commands sent, in order
+ *  - the NDEF message read, against the data bytes of the tag
+ *  - an NDEF message longer than the tag fails before any command is sent
+ *
+ *  The commands the read sent before it was planned up front are kept in
+ *  each case and printed with the commands sent now.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include "rw_t1t_ndef.c"
+
+#define TEST_TAG_SIZE       512
+#define TEST_MAX_RES        2
+#define TEST_LOG_SIZE       128
+
+typedef struct
+{
+    UINT16      offset;
+    UINT8       num_bytes;
+} tTEST_RES;
+
+typedef struct
+{
+    const char  *p_name;
+    UINT16      ndef_offset;
+    UINT16      ndef_len;
+    BOOLEAN     b_seg0_cached;
+    UINT8       num_res;
+    tTEST_RES   res[TEST_MAX_RES];
+    tNFC_STATUS status;
+    const char  *p_cmds;                /* commands sent */
+    const char  *p_cmds_before;         /* commands sent before the read was planned */
+} tTEST_CASE;
+
+static const tTEST_CASE test_cases[] =
+{
+    {"small, in static area",           14,  80, TRUE,  0, {{0}},                       NFC_STATUS_OK,     "",                        ""},
+    {"tail of 6 bytes in seg 1",        14, 110, TRUE,  0, {{0}},                       NFC_STATUS_OK,     "RSEG1 ",                  "RSEG1 "},
+    {"full topaz 512",                  16, 400, TRUE,  0, {{0}},                       NFC_STATUS_OK,     "RSEG1 RSEG2 RSEG3 ",      "RSEG1 RSEG2 RSEG3 "},
+    {"full topaz 512, not cached",      16, 400, FALSE, 0, {{0}},                       NFC_STATUS_OK,     "RSEG0 RSEG1 RSEG2 RSEG3 ","RSEG0 RSEG1 RSEG2 RSEG3 "},
+    {"seg 2 mostly reserved",           16, 240, TRUE,  1, {{0x100, 120}},              NFC_STATUS_OK,     "RSEG1 READ8_47 RSEG3 ",   "RSEG1 RSEG2 RSEG3 "},
+    {"reserved bytes at seg 3 start",   16, 230, TRUE,  1, {{0x180, 4}},                NFC_STATUS_OK,     "RSEG1 RSEG2 ",            "RSEG1 RSEG2 "},
+    {"tail crosses reserved block",     16, 215, TRUE,  1, {{0x80 + 8 * 15, 8}},        NFC_STATUS_OK,     "RSEG1 READ8_32 ",         "RSEG1 READ8_32 "},
+    {"seg 1 one data block",            16, 110, TRUE,  2, {{0x80, 64}, {0xC8, 56}},    NFC_STATUS_OK,     "READ8_24 RSEG2 ",         "RSEG1 RSEG2 "},
+    {"6 byte tail after 4 reserved",    14,  96, TRUE,  1, {{0x80, 4}},                 NFC_STATUS_OK,     "RSEG1 ",                  "READ8_16 READ8_17 "},
+    {"2 bytes in one block, no cache",  14,   2, FALSE, 0, {{0}},                       NFC_STATUS_OK,     "READ8_1 ",                "RSEG0 "},
+    {"seg 2 mostly reserved, too long", 16, 380, TRUE,  1, {{0x100, 120}},              NFC_STATUS_FAILED, "",                        "RSEG1 RSEG2 RSEG3 RSEG4 "},
+    {"too long for tag",                16, 500, TRUE,  0, {{0}},                       NFC_STATUS_FAILED, "",                        "RSEG1 RSEG2 RSEG3 RSEG4 "},
+};
+
+static int          test_failures;
+static UINT8        test_tag[TEST_TAG_SIZE];
+static char         test_log[TEST_LOG_SIZE];
+static UINT8        test_pend_opcode;
+static UINT8        test_pend_addr;
+static BOOLEAN      test_pending;
+static BOOLEAN      test_done;
+static tNFC_STATUS  test_status;
+
+#define TEST_CHECK(cond) \
+    do { if (!(cond)) { printf ("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); test_failures++; } } while (0)
+
+/* stubs of the symbols rw_t1t_ndef.c needs from the rest of the stack */
+tRW_CB  rw_cb;
+void    rw_t1t_handle_op_complete (void) { rw_cb.tcb.t1t.state = RW_T1T_STATE_IDLE; }
+void    rw_t1t_process_timeout (TIMER_LIST_ENT *p_tle) {}
+tNFC_STATUS rw_t1t_select (UINT8 hr[T1T_HR_LEN], UINT8 uid[T1T_CMD_UID_LEN]) { return NFC_STATUS_OK; }
+void    LogMsg_0 (UINT32 trace_set_mask, const char *p_str) {}
+void    LogMsg_1 (UINT32 trace_set_mask, const char *fmt_str, UINT32 p1) {}
+void    LogMsg_2 (UINT32 trace_set_mask, const char *fmt_str, UINT32 p1, UINT32 p2) {}
+void    LogMsg_3 (UINT32 trace_set_mask, const char *fmt_str, UINT32 p1, UINT32 p2, UINT32 p3) {}
+void    LogMsg_4 (UINT32 trace_set_mask, const char *fmt_str, UINT32 p1, UINT32 p2, UINT32 p3, UINT32 p4) {}
+
+/*******************************************************************************
+**
+** Function         rw_t1t_send_dyn_cmd
+**
+** Description      Log an RSEG or READ8 and keep it for the tag to answer
+**
+*******************************************************************************/
+tNFC_STATUS rw_t1t_send_dyn_cmd (UINT8 opcode, UINT8 add, UINT8 *p_dat)
+{
+    size_t len = strlen (test_log);
+
+    rw_cb.tcb.t1t.p_cmd_rsp_info = (tT1T_CMD_RSP_INFO *) t1t_cmd_to_rsp_info (opcode);
+    rw_cb.tcb.t1t.addr = add;
+
+    if (opcode == T1T_CMD_RSEG)
+        snprintf (test_log + len, sizeof (test_log) - len, "RSEG%u ", add >> 4);
+    else if (opcode == T1T_CMD_READ8)
+        snprintf (test_log + len, sizeof (test_log) - len, "READ8_%u ", add);
+    else
+        snprintf (test_log + len, sizeof (test_log) - len, "OP%02X ", opcode);
+
+    test_pend_opcode = opcode;
+    test_pend_addr   = add;
+    test_pending     = TRUE;
+    return NFC_STATUS_OK;
+}
+
+/*******************************************************************************
+**
+** Function         rw_t1t_send_static_cmd
+**
+** Description      Log a static memory command, which the NDEF read of a
+**                  dynamic memory tag must not send
+**
+*******************************************************************************/
+tNFC_STATUS rw_t1t_send_static_cmd (UINT8 opcode, UINT8 add, UINT8 dat)
+{
+    size_t len = strlen (test_log);
+
+    snprintf (test_log + len, sizeof (test_log) - len, "OP%02X ", opcode);
+    return NFC_STATUS_FAILED;
+}
+
+/*******************************************************************************
+**
+** Function         test_cback
+**
+*******************************************************************************/
+static void test_cback (tRW_EVENT event, tRW_DATA *p_rw_data)
+{
+    if (event == RW_T1T_NDEF_READ_EVT)
+    {
+        test_done   = TRUE;
+        test_status = p_rw_data->data.status;
+    }
+}
+
+/*******************************************************************************
+**
+** Function         test_is_reserved
+**
+** Description      Check if a byte of the tag is not NDEF data: header,
+**                  static lock/reserved bytes, or a reserved area of a case
+**
+*******************************************************************************/
+static BOOLEAN test_is_reserved (const tTEST_CASE *p_case, UINT16 offset)
+{
+    UINT8 xx;
+
+    if ((offset < T1T_UID_LEN + 1) || ((offset >= 0x68) && (offset < 0x80)))
+        return TRUE;
+
+    for (xx = 0; xx < p_case->num_res; xx++)
+    {
+        if ((offset >= p_case->res[xx].offset) && (offset < p_case->res[xx].offset + p_case->res[xx].num_bytes))
+            return TRUE;
+    }
+    return FALSE;
+}
+
+/*******************************************************************************
+**
+** Function         test_run
+**
+** Description      Read the NDEF message of a case from the simulated tag
+**
+*******************************************************************************/
+static void test_run (const tTEST_CASE *p_case)
+{
+    tRW_T1T_CB  *p_t1t = &rw_cb.tcb.t1t;
+    static UINT8 ndef[TEST_TAG_SIZE], expected[TEST_TAG_SIZE];
+    UINT8       rsp[1 + T1T_SEGMENT_SIZE];
+    UINT16      offset, len = 0;
+    BOOLEAN     notify;
+    tNFC_STATUS status;
+    int         xx;
+
+    memset (&rw_cb, 0, sizeof (rw_cb));
+    rw_cb.p_cback = test_cback;
+    for (xx = 0; xx < TEST_TAG_SIZE; xx++)
+        test_tag[xx] = (UINT8) (xx * 7 + 3);
+    test_tag[T1T_CC_TMS_BYTE] = 0x3F;
+
+    p_t1t->hr[0] = 0x12;
+    memcpy (p_t1t->mem, test_tag, T1T_SEGMENT_SIZE);
+    p_t1t->tag_attribute   = RW_T1_TAG_ATTRB_READ_WRITE;
+    p_t1t->ndef_msg_offset = p_case->ndef_offset;
+    p_t1t->ndef_msg_len    = p_case->ndef_len;
+    p_t1t->num_mem_tlvs    = p_case->num_res;
+    for (xx = 0; xx < p_case->num_res; xx++)
+    {
+        p_t1t->mem_tlv[xx].offset    = p_case->res[xx].offset;
+        p_t1t->mem_tlv[xx].num_bytes = p_case->res[xx].num_bytes;
+    }
+    p_t1t->attr_seg = 0xFF;
+    p_t1t->segment  = 0;
+    p_t1t->b_rseg   = p_case->b_seg0_cached;
+    p_t1t->state    = RW_T1T_STATE_IDLE;
+
+    for (offset = p_case->ndef_offset; (len < p_case->ndef_len) && (offset < TEST_TAG_SIZE); offset++)
+    {
+        if (!test_is_reserved (p_case, offset))
+            expected[len++] = test_tag[offset];
+    }
+
+    test_log[0]  = 0;
+    test_pending = FALSE;
+    test_done    = FALSE;
+    memset (ndef, 0, sizeof (ndef));
+
+    status = RW_T1tReadNDef (ndef, sizeof (ndef));
+    while (test_pending && !test_done)
+    {
+        /* the tag answers with the address of the command, then the data */
+        test_pending = FALSE;
+        rsp[0] = test_pend_addr;
+        if (test_pend_opcode == T1T_CMD_RSEG)
+            memcpy (rsp + 1, test_tag + (test_pend_addr >> 4) * T1T_SEGMENT_SIZE, T1T_SEGMENT_SIZE);
+        else
+            memcpy (rsp + 1, test_tag + test_pend_addr * T1T_BLOCK_SIZE, T1T_BLOCK_SIZE);
+
+        rw_t1t_handle_rsp (p_t1t->p_cmd_rsp_info, &notify, rsp, &status);
+        if (notify)
+        {
+            test_done   = TRUE;
+            test_status = status;
+        }
+    }
+    if (!test_done)
+        test_status = status;
+
+    printf ("%-34s now: %-26s before: %s\n", p_case->p_name, test_log, p_case->p_cmds_before);
+
+    TEST_CHECK (strcmp (test_log, p_case->p_cmds) == 0);
+    TEST_CHECK ((test_status == NFC_STATUS_OK) == (p_case->status == NFC_STATUS_OK));
+    if (p_case->status == NFC_STATUS_OK)
+    {
+        TEST_CHECK (len == p_case->ndef_len);
+        TEST_CHECK (memcmp (ndef, expected, p_case->ndef_len) == 0);
+    }
+}
+
+int main (void)
+{
+    size_t xx;
+
+    for (xx = 0; xx < sizeof (test_cases) / sizeof (test_cases[0]); xx++)
+        test_run (&test_cases[xx]);
+
+    printf ("%s\n", test_failures ? "FAILED" : "PASSED");
+    return test_failures ? 1 : 0;
+}
@@ -0,0 +1,11 @@
+######################################
+# Build host tool nci_trace_decode, which prints the binary NCI trace dumped
+# by the stack and the HAL (see NCI_TRACE_RING in libnfc-brcm.conf).
+
+LOCAL_PATH:= $(call my-dir)
+include $(CLEAR_VARS)
+LOCAL_MODULE := nci_trace_decode
+LOCAL_MODULE_TAGS := optional
+LOCAL_SRC_FILES := nci_trace_decode.c
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/../../src/include
+include $(BUILD_HOST_EXECUTABLE)
@@ -0,0 +1,181 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2015 Broadcom Corporation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  Offline decoder for the binary NCI trace dump (nci_trace_*.bin).
+ *
+ *  Usage: nci_trace_decode <dump file> [<dump file> ...]
+ *
+ *  The packets of all files are merged, sorted by time and printed one per
+ *  line with the NCI header decoded and the payload in hex.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nci_trace_file.h"
+
+typedef struct
+{
+    tNCI_TRACE_FILE_REC hdr;
+    uint8_t             *p_data;
+} tNCI_TRACE_PKT;
+
+static tNCI_TRACE_PKT *p_pkts = NULL;
+static size_t num_pkts = 0;
+static size_t max_pkts = 0;
+
+static const char *mt_name[] = {"DATA", "CMD ", "RSP ", "NTF ", "MT4 ", "MT5 ", "MT6 ", "MT7 "};
+
+/*******************************************************************************
+**
+** Function         read_dump
+**
+** Description      Append the packets of a dump file to the packet list
+**
+** Returns          0 if ok, -1 if the file is not a valid dump
+**
+*******************************************************************************/
+static int read_dump (const char *p_name)
+{
+    tNCI_TRACE_FILE_HDR hdr;
+    tNCI_TRACE_PKT      *p_pkt;
+    FILE                *fp;
+    uint32_t            i;
+
+    if ((fp = fopen (p_name, "rb")) == NULL)
+    {
+        fprintf (stderr, "%s: cannot open\n", p_name);
+        return -1;
+    }
+
+    if (  (fread (&hdr, sizeof (hdr), 1, fp) != 1)
+        ||(memcmp (hdr.magic, NCI_TRACE_FILE_MAGIC, NCI_TRACE_FILE_MAGIC_LEN))
+        ||(hdr.version != NCI_TRACE_FILE_VERSION)  )
+    {
+        fprintf (stderr, "%s: not an NCI trace dump\n", p_name);
+        fclose (fp);
+        return -1;
+    }
+
+    for (i = 0; i < hdr.num_records; i++)
+    {
+        if (num_pkts == max_pkts)
+        {
+            max_pkts = max_pkts ? max_pkts * 2 : 256;
+            p_pkts   = (tNCI_TRACE_PKT *) realloc (p_pkts, max_pkts * sizeof (tNCI_TRACE_PKT));
+            if (p_pkts == NULL)
+            {
+                fprintf (stderr, "out of memory\n");
+                exit (1);
+            }
+        }
+
+        p_pkt = &p_pkts[num_pkts];
+        if (fread (&p_pkt->hdr, sizeof (p_pkt->hdr), 1, fp) != 1)
+            break;
+        if ((p_pkt->p_data = (uint8_t *) malloc (p_pkt->hdr.len + 1)) == NULL)
+            break;
+        if (fread (p_pkt->p_data, 1, p_pkt->hdr.len, fp) != p_pkt->hdr.len)
+        {
+            free (p_pkt->p_data);
+            break;
+        }
+        num_pkts++;
+    }
+
+    if (i != hdr.num_records)
+        fprintf (stderr, "%s: truncated, %u of %u packets read\n", p_name, i, hdr.num_records);
+
+    fclose (fp);
+    return 0;
+}
+
+static int cmp_pkt (const void *p_a, const void *p_b)
+{
+    const tNCI_TRACE_PKT *p_pa = (const tNCI_TRACE_PKT *) p_a;
+    const tNCI_TRACE_PKT *p_pb = (const tNCI_TRACE_PKT *) p_b;
+
+    if (p_pa->hdr.timestamp != p_pb->hdr.timestamp)
+        return (p_pa->hdr.timestamp < p_pb->hdr.timestamp) ? -1 : 1;
+    return 0;
+}
+
+/*******************************************************************************
+**
+** Function         print_pkt
+**
+** Description      Print one packet: time, thread, direction, NCI header and
+**                  payload
+**
+** Returns          void
+**
+*******************************************************************************/
+static void print_pkt (const tNCI_TRACE_PKT *p_pkt)
+{
+    const uint8_t *p = p_pkt->p_data;
+    uint16_t      len = p_pkt->hdr.len;
+    uint16_t      i;
+    uint8_t       mt;
+
+    printf ("%6llu.%06llu %5u %s ",
+            (unsigned long long) (p_pkt->hdr.timestamp / 1000000),
+            (unsigned long long) (p_pkt->hdr.timestamp % 1000000),
+            p_pkt->hdr.tid, p_pkt->hdr.is_recv ? "R" : "X");
+
+    if (len >= 3)
+    {
+        mt = (p[0] >> 5) & 0x07;
+        if (mt == 0)
+            printf ("%s conn=%u pbf=%u len=%-3u:", mt_name[mt], p[0] & 0x0F, (p[0] >> 4) & 0x01, p[2]);
+        else
+            printf ("%s gid=0x%X oid=0x%02X pbf=%u len=%-3u:", mt_name[mt], p[0] & 0x0F, p[1] & 0x3F, (p[0] >> 4) & 0x01, p[2]);
+        p   += 3;
+        len -= 3;
+    }
+
+    for (i = 0; i < len; i++)
+        printf (" %02X", p[i]);
+    printf ("\n");
+}
+
+int main (int argc, char **argv)
+{
+    size_t i;
+    int    n;
+
+    if (argc < 2)
+    {
+        fprintf (stderr, "usage: %s <dump file> [<dump file> ...]\n", argv[0]);
+        return 1;
+    }
+
+    for (n = 1; n < argc; n++)
+        read_dump (argv[n]);
+
+    qsort (p_pkts, num_pkts, sizeof (tNCI_TRACE_PKT), cmp_pkt);
+
+    for (i = 0; i < num_pkts; i++)
+    {
+        print_pkt (&p_pkts[i]);
+        free (p_pkts[i].p_data);
+    }
+    free (p_pkts);
+    return 0;
+}